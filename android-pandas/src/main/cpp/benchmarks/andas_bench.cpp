@@ -0,0 +1,534 @@
+// 原生内核基准（主机构建，不依赖 JNI）
+//
+// 用法:
+//   andas_bench [--filter sum,groupby] [--sizes 10000,1000000] [--nan 0,0.1] [--threads 1,8]
+//               [--simd scalar,avx2] [--min-time 0.2] [--repetitions 15]
+//               [--json out.json] [--baseline base.json] [--threshold 0.1]
+//   andas_bench --compare base.json current.json [--threshold 0.1]
+//   andas_bench --smoke --json out.json      (ctest 使用：小数据、少量重复)
+//
+// 返回值：0 成功，1 有用例相对基线回退，2 参数或文件错误
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_harness.h"
+#include "corr_engine.h"
+#include "csv_reader.h"
+#include "dedup_engine.h"
+#include "index_engine.h"
+#include "filter_engine.h"
+#include "groupby_engine.h"
+#include "join_engine.h"
+#include "math_kernels.h"
+#include "moments.h"
+#include "pipeline_engine.h"
+#include "rolling_engine.h"
+#include "sampling.h"
+#include "simd_kernels.h"
+#include "sketches.h"
+#include "sort_engine.h"
+#include "spill_engine.h"
+#include "thread_pool.h"
+
+using namespace andas;
+using namespace andas::bench;
+
+namespace {
+
+constexpr int64_t kGroupCount = 1024;
+constexpr uint64_t kSeed = 20240601;
+
+// 一组 (行数, 缺失比例) 的输入数据，所有内核共用，生成时间不计入测量
+struct Dataset {
+    int64_t n = 0;
+    std::vector<double> values;        // [0, 1) 均匀分布，按比例替换为 NaN
+    std::vector<int64_t> groupKeys;    // kGroupCount 个键，缺失为 kNullGroupKey
+    std::vector<int64_t> rightKeys;    // n / 4 个互不相同的键，用于连接
+    std::vector<uint64_t> mask;        // values > 0.5 的位图
+    std::string csv;                   // id,value,name 三列
+};
+
+Dataset makeDataset(int64_t n, double nanFraction) {
+    Dataset d;
+    d.n = n;
+    Xoshiro256 rng(deriveSeed(kSeed, static_cast<uint64_t>(n)));
+    d.values.resize(static_cast<size_t>(n));
+    d.groupKeys.resize(static_cast<size_t>(n));
+    const int64_t rightRows = std::max<int64_t>(1, n / 4);
+    for (int64_t i = 0; i < n; i++) {
+        const bool missing = rng.uniform() < nanFraction;
+        d.values[i] = missing ? NAN : rng.uniform();
+        d.groupKeys[i] = missing ? kNullGroupKey : static_cast<int64_t>(rng.below(kGroupCount));
+    }
+    for (int64_t key : sampleIndices(rightRows, rightRows, kSeed)) d.rightKeys.push_back(key);
+
+    d.mask.assign(static_cast<size_t>((n + 63) / 64), 0);
+    compareToBitmask(d.values.data(), 0.5, simd::CompareOp::GT, d.mask.data(), n);
+
+    std::ostringstream csv;
+    csv << "id,value,name\n";
+    for (int64_t i = 0; i < n; i++) {
+        csv << i << ',';
+        if (!std::isnan(d.values[i])) csv << d.values[i];
+        csv << ",k" << (d.groupKeys[i] == kNullGroupKey ? 0 : d.groupKeys[i] % 100) << '\n';
+    }
+    d.csv = csv.str();
+    return d;
+}
+
+// 每个内核按数据集生成一次计时迭代；闭包持有的临时缓冲区在计时外分配
+struct Kernel {
+    const char* name;
+    std::function<Workload(const Dataset&)> make;
+};
+
+std::vector<Kernel> kernels() {
+    return {
+        {"sum", [](const Dataset& d) {
+            return Workload{d.n, d.n * 8, [&d] { keep(andas::sum(d.values.data(), d.n)); }};
+        }},
+        {"describe", [](const Dataset& d) {
+            return Workload{d.n, d.n * 8, [&d] {
+                keep(computeMoments(d.values.data(), d.n, MomentOrder::SHAPE));
+            }};
+        }},
+        {"argsort", [](const Dataset& d) {
+            auto out = std::make_shared<std::vector<int32_t>>(static_cast<size_t>(d.n));
+            return Workload{d.n, d.n * 12, [&d, out] {
+                argsort(d.values.data(), out->data(), d.n);
+                keep(out->data());
+            }};
+        }},
+        {"top_k", [](const Dataset& d) {
+            return Workload{d.n, d.n * 8, [&d] {
+                keep(topK(SortKey{SortKeyType::FLOAT64, d.values.data(), true, false}, d.n, 100));
+            }};
+        }},
+        {"groupby", [](const Dataset& d) {
+            return Workload{d.n, d.n * 16, [&d] {
+                const int64_t* keys[1] = {d.groupKeys.data()};
+                const double* values[1] = {d.values.data()};
+                const AggSpec specs[2] = {{0, AggOp::SUM}, {0, AggOp::MEAN}};
+                keep(groupByAggregate(keys, 1, values, 1, specs, 2, d.n));
+            }};
+        }},
+        {"merge_indices", [](const Dataset& d) {
+            const int64_t rightRows = static_cast<int64_t>(d.rightKeys.size());
+            return Workload{d.n + rightRows, (d.n + rightRows) * 8, [&d, rightRows] {
+                // 左表用分组键：每个非缺失的左行恰好匹配一个右行
+                const int64_t* left[1] = {d.groupKeys.data()};
+                const int64_t* right[1] = {d.rightKeys.data()};
+                keep(hashJoin(left, d.n, right, rightRows, 1, JoinType::INNER));
+            }};
+        }},
+        {"compare_mask", [](const Dataset& d) {
+            auto bits = std::make_shared<std::vector<uint64_t>>(d.mask.size());
+            return Workload{d.n, d.n * 8, [&d, bits] {
+                compareToBitmask(d.values.data(), 0.5, simd::CompareOp::GT, bits->data(), d.n);
+                keep(bits->data());
+            }};
+        }},
+        {"where", [](const Dataset& d) {
+            return Workload{d.n, static_cast<int64_t>(d.mask.size()) * 8, [&d] {
+                keep(selectedRows(d.mask.data(), d.n));
+            }};
+        }},
+        {"rolling_mean", [](const Dataset& d) {
+            auto out = std::make_shared<std::vector<double>>(static_cast<size_t>(d.n));
+            return Workload{d.n, d.n * 16, [&d, out] {
+                rolling(d.values.data(), d.n, RollingOp::MEAN, RollingWindow{64, 1, false, false}, 0, d.n,
+                        out->data());
+                keep(out->data());
+            }};
+        }},
+        {"corr_matrix", [](const Dataset& d) {
+            // 同一数组错开的 8 个视图作为 8 列，相邻列高度相关但不相同
+            constexpr int32_t k = 8;
+            const int64_t rows = std::max<int64_t>(0, d.n - (k - 1));
+            auto out = std::make_shared<std::vector<double>>(static_cast<size_t>(k * k));
+            return Workload{rows * k, rows * k * 8, [&d, rows, out] {
+                const double* columns[k];
+                for (int32_t c = 0; c < k; c++) columns[c] = d.values.data() + c;
+                correlationMatrix(columns, k, rows, CorrMethod::PEARSON, 1, out->data());
+                keep(out->data());
+            }};
+        }},
+        {"expr_eval", [](const Dataset& d) {
+            // log(x + 1) * 2 + exp(-x) * sin(x)，一次遍历求值，超越函数走向量化内核
+            static const ExprInstruction kProgram[] = {
+                {ExprOp::COLUMN, 0}, {ExprOp::CONST, 0}, {ExprOp::ADD, 0}, {ExprOp::LOG, 0},
+                {ExprOp::CONST, 1}, {ExprOp::MUL, 0}, {ExprOp::COLUMN, 0}, {ExprOp::NEG, 0},
+                {ExprOp::EXP, 0}, {ExprOp::COLUMN, 0}, {ExprOp::SIN, 0}, {ExprOp::MUL, 0}, {ExprOp::ADD, 0},
+            };
+            static const double kConstants[] = {1.0, 2.0};
+            return Workload{d.n, d.n * 16, [&d] {
+                const ExprProgram program{kProgram, 13};
+                const double* inputs[] = {d.values.data()};
+                const PipelineSpec spec{inputs, 1, nullptr, &program, 1, kConstants, 2};
+                keep(runPipeline(spec, d.n).columns[0].data());
+            }};
+        }},
+        {"drop_duplicates", [](const Dataset& d) {
+            // (user, item, ts) 三列，后 1/4 的行重复前面的行，与点击日志去重的形态一致
+            const int64_t distinct = std::max<int64_t>(1, d.n - d.n / 4);
+            auto keys = std::make_shared<std::vector<std::vector<int64_t>>>(3, std::vector<int64_t>(static_cast<size_t>(d.n)));
+            for (int64_t i = 0; i < d.n; i++) {
+                const int64_t source = i < distinct ? i : (i * 7919) % distinct;
+                (*keys)[0][static_cast<size_t>(i)] = source % 100003;
+                (*keys)[1][static_cast<size_t>(i)] = source / 100003;
+                (*keys)[2][static_cast<size_t>(i)] = 1700000000000 + source * 13;
+            }
+            auto out = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(d.n));
+            return Workload{d.n, d.n * 24, [&d, keys, out] {
+                const int64_t* columns[3] = {(*keys)[0].data(), (*keys)[1].data(), (*keys)[2].data()};
+                duplicatedRows(columns, 3, d.n, DuplicateKeep::FIRST, out->data());
+                keep(out->data());
+            }};
+        }},
+        {"index_lookup", [](const Dataset& d) {
+            // 打乱的 int64 标签建一次索引，每次按标签批量查找全部行（按索引连接的探测侧）
+            auto labels = std::make_shared<std::vector<int64_t>>(static_cast<size_t>(d.n));
+            for (int64_t i = 0; i < d.n; i++) (*labels)[static_cast<size_t>(i)] = (i * 7919) % d.n * 31 + 1000000;
+            auto index = std::make_shared<HashIndex>(labels->data(), d.n);
+            auto out = std::make_shared<std::vector<int32_t>>(static_cast<size_t>(d.n));
+            return Workload{d.n, d.n * 8, [&d, labels, index, out] {
+                index->lookup(labels->data(), d.n, out->data());
+                keep(out->data());
+            }};
+        }},
+        {"external_sort", [](const Dataset& d) {
+            // 每行 8 字节内容（行号），预算 4MB：100 万行时写出 7 个有序段再归并
+            auto payload = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(d.n) * 8);
+            auto offsets = std::make_shared<std::vector<int32_t>>(static_cast<size_t>(d.n) + 1);
+            for (int64_t i = 0; i < d.n; i++) {
+                std::memcpy(payload->data() + i * 8, &i, 8);
+                (*offsets)[static_cast<size_t>(i)] = static_cast<int32_t>(i * 8);
+            }
+            (*offsets)[static_cast<size_t>(d.n)] = static_cast<int32_t>(d.n * 8);
+            return Workload{d.n, d.n * 16, [&d, payload, offsets] {
+                ExternalSorter sorter("/tmp", int64_t(4) << 20, false);
+                sorter.add(d.values.data(), payload->data(), offsets->data(), d.n);
+                sorter.finish();
+                std::vector<uint8_t> out;
+                std::vector<int32_t> outOffsets;
+                int64_t rows = 0;
+                while (int64_t count = sorter.next(int64_t(1) << 20, out, outOffsets)) rows += count;
+                keep(rows);
+            }};
+        }},
+        {"spill_groupby", [](const Dataset& d) {
+            // n / 4 个 8 字节的键，预算 1MB：100 万行时分组表溢写到分区文件后逐个分区合并
+            const int64_t groups = std::max<int64_t>(1, d.n / 4);
+            auto keys = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(d.n) * 8);
+            auto offsets = std::make_shared<std::vector<int32_t>>(static_cast<size_t>(d.n) + 1);
+            for (int64_t i = 0; i < d.n; i++) {
+                const int64_t key = (i * 7919) % groups;
+                std::memcpy(keys->data() + i * 8, &key, 8);
+                (*offsets)[static_cast<size_t>(i)] = static_cast<int32_t>(i * 8);
+            }
+            (*offsets)[static_cast<size_t>(d.n)] = static_cast<int32_t>(d.n * 8);
+            return Workload{d.n, d.n * 16, [&d, keys, offsets] {
+                SpillAggregator aggregator("/tmp", int64_t(1) << 20);
+                aggregator.add(keys->data(), offsets->data(), d.values.data(), d.n);
+                aggregator.finish();
+                SpillGroups out;
+                int64_t total = 0;
+                while (aggregator.next(out)) total += out.size();
+                keep(total);
+            }};
+        }},
+        {"quantile_sketch", [](const Dataset& d) {
+            return Workload{d.n, d.n * 8, [&d] { keep(buildQuantileSketch(d.values.data(), d.n, 200)); }};
+        }},
+        {"distinct_count", [](const Dataset& d) {
+            return Workload{d.n, d.n * 8, [&d] { keep(buildDistinctCounter(d.values.data(), d.n, 14)); }};
+        }},
+        {"csv_parse", [](const Dataset& d) {
+            return Workload{d.n, static_cast<int64_t>(d.csv.size()), [&d] {
+                CsvReader reader(std::unique_ptr<CsvSource>(
+                        new MemoryCsvSource(d.csv.data(), static_cast<int64_t>(d.csv.size()))), CsvOptions());
+                CsvBatch batch;
+                int64_t rows = 0;
+                while (reader.next(batch, 65536)) rows += batch.rows;
+                keep(rows);
+            }};
+        }},
+        {"csv_parse_prefetch", [](const Dataset& d) {
+            // 与 csv_parse 相同，输入经后台线程预读：衡量预读本身的开销（内存输入没有 I/O 可以重叠）
+            return Workload{d.n, static_cast<int64_t>(d.csv.size()), [&d] {
+                std::unique_ptr<CsvSource> inner(new MemoryCsvSource(d.csv.data(), static_cast<int64_t>(d.csv.size())));
+                CsvReader reader(std::unique_ptr<CsvSource>(new PrefetchCsvSource(std::move(inner), 1 << 20, 4)),
+                                 CsvOptions());
+                CsvBatch batch;
+                int64_t rows = 0;
+                while (reader.next(batch, 65536)) rows += batch.rows;
+                keep(rows);
+            }};
+        }},
+    };
+}
+
+// ==================== 参数 ====================
+
+struct Options {
+    std::vector<std::string> filters;
+    std::vector<int64_t> sizes = {10000, 1000000};
+    std::vector<double> nanFractions = {0.0, 0.1};
+    std::vector<int> threads;
+    std::vector<simd::Level> levels;
+    RunOptions run;
+    std::string jsonPath;
+    std::string baselinePath;
+    double threshold = 0.10;
+    std::vector<std::string> compare;
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::string item;
+    std::istringstream in(text);
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+bool parseLevel(const std::string& name, simd::Level* level) {
+    for (simd::Level l : {simd::Level::Scalar, simd::Level::SSE2, simd::Level::AVX2, simd::Level::NEON}) {
+        if (strcasecmp(name.c_str(), simd::levelName(l)) == 0) {
+            *level = l;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseArgs(int argc, char** argv, Options* options) {
+    const int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    options->threads = {1};
+    if (hardwareThreads > 1) options->threads.push_back(hardwareThreads);
+    options->levels = {simd::active().level};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        auto value = [&](std::string* out) {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "%s 缺少参数值\n", arg.c_str());
+                return false;
+            }
+            *out = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (arg == "--smoke") {
+            options->sizes = {4096};
+            options->nanFractions = {0.0, 0.1};
+            options->threads = {1, 2};
+            options->run.minRepetitions = 3;
+            options->run.maxRepetitions = 3;
+            options->run.minSeconds = 0.0;
+        } else if (arg == "--filter") {
+            if (!value(&v)) return false;
+            options->filters = splitList(v);
+        } else if (arg == "--sizes") {
+            if (!value(&v)) return false;
+            options->sizes.clear();
+            for (const std::string& s : splitList(v)) options->sizes.push_back(std::atoll(s.c_str()));
+        } else if (arg == "--nan") {
+            if (!value(&v)) return false;
+            options->nanFractions.clear();
+            for (const std::string& s : splitList(v)) options->nanFractions.push_back(std::atof(s.c_str()));
+        } else if (arg == "--threads") {
+            if (!value(&v)) return false;
+            options->threads.clear();
+            for (const std::string& s : splitList(v)) options->threads.push_back(std::max(1, std::atoi(s.c_str())));
+        } else if (arg == "--simd") {
+            if (!value(&v)) return false;
+            options->levels.clear();
+            for (const std::string& s : splitList(v)) {
+                simd::Level level;
+                if (!parseLevel(s, &level)) {
+                    std::fprintf(stderr, "未知的 SIMD 级别: %s\n", s.c_str());
+                    return false;
+                }
+                options->levels.push_back(level);
+            }
+        } else if (arg == "--min-time") {
+            if (!value(&v)) return false;
+            options->run.minSeconds = std::atof(v.c_str());
+        } else if (arg == "--repetitions") {
+            if (!value(&v)) return false;
+            options->run.minRepetitions = std::max(1LL, std::atoll(v.c_str()));
+            options->run.maxRepetitions = std::max(options->run.maxRepetitions, options->run.minRepetitions);
+        } else if (arg == "--json") {
+            if (!value(&options->jsonPath)) return false;
+        } else if (arg == "--baseline") {
+            if (!value(&options->baselinePath)) return false;
+        } else if (arg == "--threshold") {
+            if (!value(&v)) return false;
+            options->threshold = std::atof(v.c_str());
+        } else if (arg == "--compare") {
+            if (i + 2 >= argc) {
+                std::fprintf(stderr, "--compare 需要两个文件\n");
+                return false;
+            }
+            options->compare = {argv[i + 1], argv[i + 2]};
+            i += 2;
+        } else {
+            std::fprintf(stderr, "未知参数: %s\n", arg.c_str());
+            return false;
+        }
+    }
+    for (int64_t n : options->sizes) {
+        if (n <= 0 || n > INT32_MAX) {
+            std::fprintf(stderr, "行数必须在 (0, 2^31) 内: %lld\n", static_cast<long long>(n));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool selected(const Options& options, const std::string& kernel) {
+    if (options.filters.empty()) return true;
+    for (const std::string& f : options.filters) {
+        if (kernel.find(f) != std::string::npos) return true;
+    }
+    return false;
+}
+
+bool readFile(const std::string& path, std::string* out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    *out = buffer.str();
+    return true;
+}
+
+bool loadMedians(const std::string& path, std::map<std::string, double>* medians) {
+    std::string text;
+    std::string error;
+    if (!readFile(path, &text)) {
+        std::fprintf(stderr, "无法读取 %s\n", path.c_str());
+        return false;
+    }
+    if (!readMedians(text, medians, &error)) {
+        std::fprintf(stderr, "%s 格式错误: %s\n", path.c_str(), error.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string cpuModel() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 10, "model name") == 0 || line.compare(0, 9, "Processor") == 0) {
+            const size_t colon = line.find(':');
+            if (colon != std::string::npos) return line.substr(line.find_first_not_of(" \t", colon + 1));
+        }
+    }
+    return "unknown";
+}
+
+std::string formatNumber(double value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%g", value);
+    return buf;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, &options)) return 2;
+
+    if (!options.compare.empty()) {
+        std::map<std::string, double> baseline;
+        std::map<std::string, double> current;
+        if (!loadMedians(options.compare[0], &baseline) || !loadMedians(options.compare[1], &current)) return 2;
+        return compareMedians(baseline, current, options.threshold) > 0 ? 1 : 0;
+    }
+
+    // 先读基线，文件有问题时不必跑完全部用例才报错
+    std::map<std::string, double> baseline;
+    if (!options.baselinePath.empty() && !loadMedians(options.baselinePath, &baseline)) return 2;
+
+    HardwareCounters counters;
+    const simd::Level originalLevel = simd::active().level;
+    const std::vector<Kernel> all = kernels();
+    std::vector<Result> results;
+
+    std::printf("%-60s %12s %12s %10s %12s\n", "case", "median(us)", "p99(us)", "GB/s", "Mrows/s");
+    for (int64_t n : options.sizes) {
+        for (double nanFraction : options.nanFractions) {
+            const Dataset data = makeDataset(n, nanFraction);
+            for (const Kernel& kernel : all) {
+                if (!selected(options, kernel.name)) continue;
+                Workload workload = kernel.make(data);
+                for (simd::Level level : options.levels) {
+                    if (!simd::setLevel(level)) {
+                        std::fprintf(stderr, "当前 CPU 不支持 %s，跳过\n", simd::levelName(level));
+                        continue;
+                    }
+                    for (int threads : options.threads) {
+                        ThreadPool::instance().setThreadCount(threads);
+                        const std::vector<std::pair<std::string, std::string>> params = {
+                            {"n", std::to_string(n)},
+                            {"nan", formatNumber(nanFraction)},
+                            {"threads", std::to_string(threads)},
+                            {"simd", simd::levelName(level)},
+                        };
+                        // 计数器只统计调用线程，多线程时不可比较
+                        Result r = runCase(kernel.name, params, workload, options.run,
+                                           threads == 1 && counters.available() ? &counters : nullptr);
+                        std::printf("%-60s %12.1f %12.1f %10.2f %12.1f", r.name.c_str(), r.stats.medianNs / 1e3,
+                                    r.stats.p99Ns / 1e3, r.gigabytesPerSecond(), r.rowsPerSecond() / 1e6);
+                        if (r.counters.available && r.counters.cycles > 0) {
+                            std::printf("  IPC %.2f", r.counters.instructions / r.counters.cycles);
+                        }
+                        std::printf("\n");
+                        std::fflush(stdout);
+                        results.push_back(std::move(r));
+                    }
+                }
+            }
+        }
+    }
+    simd::setLevel(originalLevel);
+
+    if (!options.jsonPath.empty()) {
+        std::map<std::string, std::string> environment = {
+            {"cpu", cpuModel()},
+            {"hardware_threads", std::to_string(std::thread::hardware_concurrency())},
+            {"simd_detected", simd::levelName(simd::detectLevel())},
+            {"compiler", __VERSION__},
+            {"hardware_counters", counters.available() ? "true" : "false"},
+            {"timestamp", std::to_string(static_cast<long long>(std::time(nullptr)))},
+        };
+        std::ofstream out(options.jsonPath, std::ios::binary);
+        out << toJson(environment, results);
+        if (!out) {
+            std::fprintf(stderr, "无法写入 %s\n", options.jsonPath.c_str());
+            return 2;
+        }
+    }
+
+    if (!options.baselinePath.empty()) {
+        std::map<std::string, double> current;
+        for (const Result& r : results) current[r.name] = r.stats.medianNs;
+        return compareMedians(baseline, current, options.threshold) > 0 ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,427 @@
+#include "bench_harness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace andas {
+namespace bench {
+
+Stats summarize(std::vector<double> samplesNs) {
+    Stats stats;
+    if (samplesNs.empty()) return stats;
+    std::sort(samplesNs.begin(), samplesNs.end());
+    const size_t n = samplesNs.size();
+    stats.samples = static_cast<int64_t>(n);
+    stats.minNs = samplesNs.front();
+    stats.medianNs = n % 2 == 1 ? samplesNs[n / 2] : 0.5 * (samplesNs[n / 2 - 1] + samplesNs[n / 2]);
+    const size_t rank = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(n)));
+    stats.p99Ns = samplesNs[std::min(n, std::max<size_t>(rank, 1)) - 1];
+    double total = 0;
+    for (double s : samplesNs) total += s;
+    stats.meanNs = total / static_cast<double>(n);
+    return stats;
+}
+
+// ==================== 硬件计数器 ====================
+
+HardwareCounters::HardwareCounters() {
+    for (int& fd : fds_) fd = -1;
+#if defined(__linux__)
+    const uint64_t configs[kEvents] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+    for (int i = 0; i < kEvents; i++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds_[i] < 0) {
+            // 虚拟机或 perf_event_paranoid 限制下不可用，整体放弃
+            for (int j = 0; j < i; j++) close(fds_[j]);
+            for (int& fd : fds_) fd = -1;
+            return;
+        }
+    }
+    available_ = true;
+#endif
+}
+
+HardwareCounters::~HardwareCounters() {
+#if defined(__linux__)
+    for (int fd : fds_) {
+        if (fd >= 0) close(fd);
+    }
+#endif
+}
+
+void HardwareCounters::reset() {
+#if defined(__linux__)
+    if (!available_) return;
+    for (int fd : fds_) ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+#endif
+}
+
+void HardwareCounters::start() {
+#if defined(__linux__)
+    if (!available_) return;
+    for (int fd : fds_) ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+void HardwareCounters::stop() {
+#if defined(__linux__)
+    if (!available_) return;
+    for (int fd : fds_) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+}
+
+Counters HardwareCounters::read(int64_t iterations) const {
+    Counters counters;
+#if defined(__linux__)
+    if (!available_ || iterations <= 0) return counters;
+    double values[kEvents];
+    for (int i = 0; i < kEvents; i++) {
+        uint64_t value = 0;
+        if (::read(fds_[i], &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value))) return counters;
+        values[i] = static_cast<double>(value) / static_cast<double>(iterations);
+    }
+    counters.available = true;
+    counters.cycles = values[0];
+    counters.instructions = values[1];
+    counters.cacheMisses = values[2];
+    counters.branchMisses = values[3];
+#else
+    (void)iterations;
+#endif
+    return counters;
+}
+
+// ==================== 计时 ====================
+
+double Result::rowsPerSecond() const {
+    return stats.medianNs > 0 ? static_cast<double>(rows) * 1e9 / stats.medianNs : 0.0;
+}
+
+double Result::gigabytesPerSecond() const {
+    // 字节 / 纳秒 即 GB/s
+    return stats.medianNs > 0 ? static_cast<double>(bytes) / stats.medianNs : 0.0;
+}
+
+Result runCase(const std::string& kernel, const std::vector<std::pair<std::string, std::string>>& params,
+               Workload& workload, const RunOptions& options, HardwareCounters* counters) {
+    using Clock = std::chrono::steady_clock;
+    Result result;
+    result.kernel = kernel;
+    result.name = kernel;
+    for (const auto& p : params) {
+        result.name += "/" + p.first + "=" + p.second;
+        result.params[p.first] = p.second;
+    }
+    result.rows = workload.rows;
+    result.bytes = workload.bytes;
+
+    // 预热：触发页面分配、线程池启动和分支预测器学习
+    workload.run();
+
+    if (counters != nullptr) counters->reset();
+    std::vector<double> samples;
+    const Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.minSeconds));
+    while (static_cast<int64_t>(samples.size()) < options.maxRepetitions &&
+           (static_cast<int64_t>(samples.size()) < options.minRepetitions || Clock::now() < deadline)) {
+        if (counters != nullptr) counters->start();
+        const Clock::time_point begin = Clock::now();
+        workload.run();
+        const Clock::time_point end = Clock::now();
+        if (counters != nullptr) counters->stop();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - begin).count());
+    }
+    result.stats = summarize(std::move(samples));
+    if (counters != nullptr) result.counters = counters->read(result.stats.samples);
+    return result;
+}
+
+// ==================== JSON ====================
+
+namespace {
+
+std::string quote(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+std::string number(double value) {
+    if (!std::isfinite(value)) return "null";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.6g", value);
+    return buf;
+}
+
+// 只支持报告格式所需的 JSON 子集：对象、数组、字符串、数字、true/false/null
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& text) : s_(text) {}
+
+    bool fail(const std::string& message) {
+        if (error_.empty()) error_ = message + "（位置 " + std::to_string(pos_) + "）";
+        return false;
+    }
+
+    const std::string& error() const { return error_; }
+
+    void skipSpace() {
+        while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_]))) pos_++;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (pos_ < s_.size() && s_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c) {
+        skipSpace();
+        return pos_ < s_.size() && s_[pos_] == c;
+    }
+
+    bool readString(std::string* out) {
+        if (!consume('"')) return fail("应为字符串");
+        out->clear();
+        while (pos_ < s_.size() && s_[pos_] != '"') {
+            char c = s_[pos_++];
+            if (c == '\\') {
+                if (pos_ >= s_.size()) break;
+                char e = s_[pos_++];
+                switch (e) {
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    case 'r': c = '\r'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'u':
+                        // 报告中只会出现控制字符的转义
+                        if (pos_ + 4 > s_.size()) return fail("转义不完整");
+                        c = static_cast<char>(std::strtol(s_.substr(pos_, 4).c_str(), nullptr, 16));
+                        pos_ += 4;
+                        break;
+                    default: c = e;
+                }
+            }
+            *out += c;
+        }
+        if (!consume('"')) return fail("字符串未结束");
+        return true;
+    }
+
+    bool readNumber(double* out) {
+        skipSpace();
+        const char* begin = s_.c_str() + pos_;
+        char* end = nullptr;
+        *out = std::strtod(begin, &end);
+        if (end == begin) return fail("应为数字");
+        pos_ += static_cast<size_t>(end - begin);
+        return true;
+    }
+
+    bool skipValue() {
+        skipSpace();
+        if (pos_ >= s_.size()) return fail("意外的结尾");
+        const char c = s_[pos_];
+        if (c == '"') {
+            std::string ignored;
+            return readString(&ignored);
+        }
+        if (c == '{' || c == '[') {
+            const char close = c == '{' ? '}' : ']';
+            pos_++;
+            if (consume(close)) return true;
+            do {
+                if (c == '{') {
+                    std::string key;
+                    if (!readString(&key) || !consume(':')) return fail("对象格式错误");
+                }
+                if (!skipValue()) return false;
+            } while (consume(','));
+            return consume(close) || fail("括号不匹配");
+        }
+        for (const char* word : {"true", "false", "null"}) {
+            const size_t len = std::strlen(word);
+            if (s_.compare(pos_, len, word) == 0) {
+                pos_ += len;
+                return true;
+            }
+        }
+        double ignored;
+        return readNumber(&ignored);
+    }
+
+    // 遍历对象的各个键，回调负责读取对应的值
+    template <typename F>
+    bool readObject(F&& onKey) {
+        if (!consume('{')) return fail("应为对象");
+        if (consume('}')) return true;
+        do {
+            std::string key;
+            if (!readString(&key) || !consume(':')) return fail("对象格式错误");
+            if (!onKey(key)) return false;
+        } while (consume(','));
+        return consume('}') || fail("对象未结束");
+    }
+
+    template <typename F>
+    bool readArray(F&& onItem) {
+        if (!consume('[')) return fail("应为数组");
+        if (consume(']')) return true;
+        do {
+            if (!onItem()) return false;
+        } while (consume(','));
+        return consume(']') || fail("数组未结束");
+    }
+
+    bool atEnd() {
+        skipSpace();
+        return pos_ == s_.size();
+    }
+
+private:
+    const std::string& s_;
+    size_t pos_ = 0;
+    std::string error_;
+};
+
+} // namespace
+
+std::string toJson(const std::map<std::string, std::string>& environment, const std::vector<Result>& results) {
+    std::ostringstream out;
+    out << "{\n  \"environment\": {";
+    bool first = true;
+    for (const auto& e : environment) {
+        out << (first ? "\n" : ",\n") << "    " << quote(e.first) << ": " << quote(e.second);
+        first = false;
+    }
+    out << "\n  },\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << quote(r.name) << ", \"kernel\": " << quote(r.kernel);
+        out << ", \"params\": {";
+        bool firstParam = true;
+        for (const auto& p : r.params) {
+            out << (firstParam ? "" : ", ") << quote(p.first) << ": " << quote(p.second);
+            firstParam = false;
+        }
+        out << "}, \"rows\": " << r.rows << ", \"bytes\": " << r.bytes
+            << ", \"samples\": " << r.stats.samples
+            << ", \"min_ns\": " << number(r.stats.minNs)
+            << ", \"median_ns\": " << number(r.stats.medianNs)
+            << ", \"p99_ns\": " << number(r.stats.p99Ns)
+            << ", \"mean_ns\": " << number(r.stats.meanNs)
+            << ", \"rows_per_s\": " << number(r.rowsPerSecond())
+            << ", \"gb_per_s\": " << number(r.gigabytesPerSecond());
+        if (r.counters.available) {
+            out << ", \"counters\": {\"cycles\": " << number(r.counters.cycles)
+                << ", \"instructions\": " << number(r.counters.instructions)
+                << ", \"cache_misses\": " << number(r.counters.cacheMisses)
+                << ", \"branch_misses\": " << number(r.counters.branchMisses) << "}";
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
+
+bool readMedians(const std::string& json, std::map<std::string, double>* medians, std::string* error) {
+    JsonReader reader(json);
+    bool sawResults = false;
+    const bool ok = reader.readObject([&](const std::string& key) {
+        if (key != "results") return reader.skipValue();
+        sawResults = true;
+        return reader.readArray([&] {
+            std::string name;
+            double median = NAN;
+            const bool itemOk = reader.readObject([&](const std::string& field) {
+                if (field == "name") return reader.readString(&name);
+                if (field == "median_ns") return reader.readNumber(&median);
+                return reader.skipValue();
+            });
+            if (!itemOk) return false;
+            if (name.empty() || !std::isfinite(median)) return reader.fail("结果缺少 name 或 median_ns");
+            (*medians)[name] = median;
+            return true;
+        });
+    });
+    if (ok && !sawResults) reader.fail("缺少 results 字段");
+    if (!ok || !sawResults || !reader.atEnd()) {
+        if (error != nullptr) *error = reader.error().empty() ? "多余的内容" : reader.error();
+        return false;
+    }
+    return true;
+}
+
+int compareMedians(const std::map<std::string, double>& baseline, const std::map<std::string, double>& current,
+                   double threshold) {
+    int regressions = 0;
+    int compared = 0;
+    for (const auto& c : current) {
+        auto it = baseline.find(c.first);
+        if (it == baseline.end() || it->second <= 0) {
+            std::printf("  %-60s 无基线\n", c.first.c_str());
+            continue;
+        }
+        compared++;
+        const double change = c.second / it->second - 1.0;
+        const bool regressed = change > threshold;
+        if (regressed) regressions++;
+        std::printf("  %-60s %12.0f -> %12.0f ns  %+7.1f%%%s\n", c.first.c_str(), it->second, c.second,
+                    change * 100.0, regressed ? "  回退" : "");
+    }
+    // 基线中有、本次未运行的用例（如使用了 --filter）只计数，不逐个列出
+    int skipped = 0;
+    for (const auto& b : baseline) {
+        if (current.find(b.first) == current.end()) skipped++;
+    }
+    std::printf("比较 %d 个用例，阈值 %.1f%%，回退 %d 个，基线中另有 %d 个本次未运行\n", compared,
+                threshold * 100.0, regressions, skipped);
+    return regressions;
+}
+
+} // namespace bench
+} // namespace andas
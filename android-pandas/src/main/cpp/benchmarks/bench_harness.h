@@ -0,0 +1,107 @@
+#ifndef ANDAS_BENCH_HARNESS_H
+#define ANDAS_BENCH_HARNESS_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace andas {
+namespace bench {
+
+// 原生内核基准工具（主机构建）
+// - 每个用例先预热一次，再重复计时直到同时满足最少次数和最短总时长
+// - 统计中位数、p99、最小值和平均值，吞吐按中位数计算
+// - Linux 上通过 perf_event 读取硬件计数器（周期、指令、缓存未命中、分支预测失败），
+//   只统计调用线程，因此只在单线程用例上报告；内核不允许访问时省略
+// - 结果写成 JSON，可与保存的基线比较，中位数变慢超过阈值视为回退
+
+// 阻止编译器把结果当作无用计算消除
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Stats {
+    int64_t samples = 0;
+    double minNs = 0;
+    double medianNs = 0;
+    double p99Ns = 0;
+    double meanNs = 0;
+};
+
+// 对每次迭代的耗时（纳秒）做统计，p99 取最近秩
+Stats summarize(std::vector<double> samplesNs);
+
+struct Counters {
+    bool available = false;
+    double cycles = 0;          // 每次迭代的平均值
+    double instructions = 0;
+    double cacheMisses = 0;
+    double branchMisses = 0;
+};
+
+class HardwareCounters {
+public:
+    HardwareCounters();
+    ~HardwareCounters();
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    bool available() const { return available_; }
+    void reset();
+    void start();
+    void stop();
+    // 自上次 reset 以来的计数除以 iterations
+    Counters read(int64_t iterations) const;
+
+private:
+    static constexpr int kEvents = 4;
+    int fds_[kEvents];
+    bool available_ = false;
+};
+
+// 一次计时迭代处理的数据量，用于计算吞吐
+struct Workload {
+    int64_t rows = 0;
+    int64_t bytes = 0;
+    std::function<void()> run;
+};
+
+struct RunOptions {
+    int64_t minRepetitions = 15;
+    int64_t maxRepetitions = 1000;
+    double minSeconds = 0.2;
+};
+
+struct Result {
+    std::string name;     // kernel/参数=值/...，用作基线比较的键
+    std::string kernel;
+    std::map<std::string, std::string> params;
+    int64_t rows = 0;
+    int64_t bytes = 0;
+    Stats stats;
+    Counters counters;
+
+    double rowsPerSecond() const;
+    double gigabytesPerSecond() const;
+};
+
+Result runCase(const std::string& kernel, const std::vector<std::pair<std::string, std::string>>& params,
+               Workload& workload, const RunOptions& options, HardwareCounters* counters);
+
+// 完整报告：环境信息 + 各用例结果
+std::string toJson(const std::map<std::string, std::string>& environment, const std::vector<Result>& results);
+
+// 从 JSON 报告中读取各用例的中位数（纳秒），格式错误时返回 false 并写入 error
+bool readMedians(const std::string& json, std::map<std::string, double>* medians, std::string* error);
+
+// 按用例名比较中位数，打印变化，返回变慢超过 threshold（如 0.1 表示 10%）的用例数
+int compareMedians(const std::map<std::string, double>& baseline, const std::map<std::string, double>& current,
+                   double threshold);
+
+} // namespace bench
+} // namespace andas
+
+#endif //ANDAS_BENCH_HARNESS_H
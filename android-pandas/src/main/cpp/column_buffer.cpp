@@ -0,0 +1,20 @@
+#include "column_buffer.h"
+
+#include "memory_pool.h"
+
+namespace andas {
+
+static_assert(kColumnAlignment == 64, "缓冲区池按 64 字节对齐");
+
+void* alignedAlloc(size_t bytes) {
+    // 长度向上取整到对齐大小，空列也分配一个缓存行，保证地址非空
+    size_t rounded = (bytes + kColumnAlignment - 1) / kColumnAlignment * kColumnAlignment;
+    if (rounded == 0) rounded = kColumnAlignment;
+    return poolAlloc(rounded);
+}
+
+void alignedFree(void* ptr) {
+    poolFree(ptr);
+}
+
+} // namespace andas
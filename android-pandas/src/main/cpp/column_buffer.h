@@ -0,0 +1,19 @@
+#ifndef ANDAS_COLUMN_BUFFER_H
+#define ANDAS_COLUMN_BUFFER_H
+
+#include <cstddef>
+
+namespace andas {
+
+// 原生列缓冲区按缓存行对齐，便于SIMD加载且避免跨缓存行访问
+constexpr size_t kColumnAlignment = 64;
+
+// 分配按 kColumnAlignment 对齐的内存，从缓冲区池中复用并计入内存预算（见 memory_pool.h）
+// 超出预算或系统分配失败时抛出 MemoryLimitError
+void* alignedAlloc(size_t bytes);
+// 只接受 alignedAlloc 返回的地址，释放的块留在池中供之后的列复用
+void alignedFree(void* ptr);
+
+} // namespace andas
+
+#endif //ANDAS_COLUMN_BUFFER_H
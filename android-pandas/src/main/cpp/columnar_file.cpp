@@ -0,0 +1,399 @@
+#include "columnar_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "column_buffer.h"
+
+namespace andas {
+
+namespace {
+
+constexpr char kMagic[8] = {'A', 'N', 'D', 'A', 'S', 'C', 'O', 'L'};
+constexpr uint32_t kByteOrderMark = 0x01020304u;
+
+size_t elementSize(ColumnarType type) {
+    switch (type) {
+        case ColumnarType::BOOL: return 1;
+        case ColumnarType::INT32: return 4;
+        case ColumnarType::STRING: return 4;
+        case ColumnarType::INT64: return 8;
+        case ColumnarType::FLOAT64: return 8;
+    }
+    return 0;
+}
+
+} // namespace
+
+// ==================== 写入 ====================
+
+ColumnarWriter::ColumnarWriter(int fd, bool owned, int64_t rowCount, int64_t statsChunkRows)
+    : fd_(fd), owned_(owned), rows_(rowCount), statsChunkRows_(statsChunkRows) {
+    if (fd_ < 0) {
+        fail("无效的文件描述符");
+        return;
+    }
+    if (rows_ < 0) {
+        fail("行数不能为负数");
+        return;
+    }
+    // 占位文件头，finish 时回填；文件头不完整的文件不会被读取方接受
+    ColumnarFileHeader placeholder{};
+    append(&placeholder, sizeof(placeholder));
+}
+
+ColumnarWriter::~ColumnarWriter() {
+    if (owned_ && fd_ >= 0) ::close(fd_);
+}
+
+bool ColumnarWriter::fail(const std::string& message) {
+    if (error_.empty()) error_ = message;
+    return false;
+}
+
+bool ColumnarWriter::append(const void* data, uint64_t bytes) {
+    if (!error_.empty()) return false;
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        const size_t step = static_cast<size_t>(bytes < (1u << 30) ? bytes : (1u << 30));
+        ssize_t n = ::write(fd_, p, step);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return fail(std::string("写入失败: ") + std::strerror(errno));
+        }
+        p += n;
+        bytes -= static_cast<uint64_t>(n);
+        position_ += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool ColumnarWriter::appendAligned(const void* data, uint64_t bytes, uint64_t& offset) {
+    static const char zeros[kColumnAlignment] = {};
+    const uint64_t pad = (kColumnAlignment - position_ % kColumnAlignment) % kColumnAlignment;
+    if (pad > 0 && !append(zeros, pad)) return false;
+    offset = position_;
+    return append(data, bytes);
+}
+
+bool ColumnarWriter::begin(const std::string& name, ColumnarType type, ColumnarColumnMeta& meta) {
+    if (!error_.empty()) return false;
+    if (finished_) return fail("写入器已完成");
+    for (const std::string& existing : names_) {
+        if (existing == name) return fail("列名重复: " + name);
+    }
+    meta = ColumnarColumnMeta{};
+    meta.type = static_cast<int32_t>(type);
+    meta.nameBytes = static_cast<uint32_t>(name.size());
+    names_.push_back(name);
+    return true;
+}
+
+bool ColumnarWriter::appendValidity(const uint8_t* valid, ColumnarColumnMeta& meta) {
+    meta.nullCount = 0;
+    meta.validityOffset = 0;
+    if (valid == nullptr) return true;
+    std::vector<uint8_t> bitmap(static_cast<size_t>((rows_ + 7) / 8), 0);
+    for (int64_t i = 0; i < rows_; i++) {
+        if (valid[i]) {
+            bitmap[static_cast<size_t>(i >> 3)] |= static_cast<uint8_t>(1u << (i & 7));
+        } else {
+            meta.nullCount++;
+        }
+    }
+    if (meta.nullCount == 0) return true;
+    return appendAligned(bitmap.data(), bitmap.size(), meta.validityOffset);
+}
+
+template <typename T, typename S>
+bool ColumnarWriter::appendStats(const T* values, const uint8_t* valid, ColumnarColumnMeta& meta) {
+    if (statsChunkRows_ <= 0 || rows_ == 0) return true;
+    const int64_t count = rows_ / statsChunkRows_ + (rows_ % statsChunkRows_ != 0 ? 1 : 0);
+    std::vector<S> stats(static_cast<size_t>(count) * 2);
+    for (int64_t c = 0; c < count; c++) {
+        S lo = std::numeric_limits<S>::max();
+        S hi = std::numeric_limits<S>::lowest();
+        const int64_t end = std::min(rows_, (c + 1) * statsChunkRows_);
+        for (int64_t i = c * statsChunkRows_; i < end; i++) {
+            if (valid != nullptr && !valid[i]) continue;
+            const S v = static_cast<S>(values[i]);
+            if (v != v) continue;  // NaN
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+        }
+        stats[static_cast<size_t>(c) * 2] = lo;
+        stats[static_cast<size_t>(c) * 2 + 1] = hi;
+    }
+    meta.statsChunkRows = statsChunkRows_;
+    meta.statsCount = count;
+    return appendAligned(stats.data(), stats.size() * sizeof(S), meta.statsOffset);
+}
+
+bool ColumnarWriter::writeBool(const std::string& name, const uint8_t* values, const uint8_t* valid) {
+    ColumnarColumnMeta meta;
+    if (!begin(name, ColumnarType::BOOL, meta)) return false;
+    if (!appendValidity(valid, meta)) return false;
+    meta.valuesBytes = static_cast<uint64_t>(rows_);
+    if (!appendAligned(values, meta.valuesBytes, meta.valuesOffset)) return false;
+    metas_.push_back(meta);
+    return true;
+}
+
+bool ColumnarWriter::writeInt32(const std::string& name, const int32_t* values, const uint8_t* valid) {
+    ColumnarColumnMeta meta;
+    if (!begin(name, ColumnarType::INT32, meta)) return false;
+    if (!appendValidity(valid, meta)) return false;
+    meta.valuesBytes = static_cast<uint64_t>(rows_) * sizeof(int32_t);
+    if (!appendAligned(values, meta.valuesBytes, meta.valuesOffset)) return false;
+    if (!appendStats<int32_t, int64_t>(values, valid, meta)) return false;
+    metas_.push_back(meta);
+    return true;
+}
+
+bool ColumnarWriter::writeInt64(const std::string& name, const int64_t* values, const uint8_t* valid) {
+    ColumnarColumnMeta meta;
+    if (!begin(name, ColumnarType::INT64, meta)) return false;
+    if (!appendValidity(valid, meta)) return false;
+    meta.valuesBytes = static_cast<uint64_t>(rows_) * sizeof(int64_t);
+    if (!appendAligned(values, meta.valuesBytes, meta.valuesOffset)) return false;
+    if (!appendStats<int64_t, int64_t>(values, valid, meta)) return false;
+    metas_.push_back(meta);
+    return true;
+}
+
+bool ColumnarWriter::writeFloat64(const std::string& name, const double* values, const uint8_t* valid) {
+    ColumnarColumnMeta meta;
+    if (!begin(name, ColumnarType::FLOAT64, meta)) return false;
+    // NaN 与空值等价：位图和值保持一致，映射后的列可以直接按 NaN 判断空值
+    std::vector<uint8_t> mask;
+    std::vector<double> normalized;
+    for (int64_t i = 0; i < rows_; i++) {
+        const bool isNull = (valid != nullptr && !valid[i]) || std::isnan(values[i]);
+        if (!isNull) continue;
+        if (mask.empty()) {
+            mask.assign(static_cast<size_t>(rows_), 1);
+            normalized.assign(values, values + rows_);
+        }
+        mask[static_cast<size_t>(i)] = 0;
+        normalized[static_cast<size_t>(i)] = std::numeric_limits<double>::quiet_NaN();
+    }
+    const double* data = normalized.empty() ? values : normalized.data();
+    if (!appendValidity(mask.empty() ? nullptr : mask.data(), meta)) return false;
+    meta.valuesBytes = static_cast<uint64_t>(rows_) * sizeof(double);
+    if (!appendAligned(data, meta.valuesBytes, meta.valuesOffset)) return false;
+    if (!appendStats<double, double>(data, nullptr, meta)) return false;
+    metas_.push_back(meta);
+    return true;
+}
+
+bool ColumnarWriter::writeString(const std::string& name, const int32_t* codes, int64_t dictionarySize,
+                                 const int64_t* dictOffsets, const char* dictChars) {
+    ColumnarColumnMeta meta;
+    if (!begin(name, ColumnarType::STRING, meta)) return false;
+    if (dictionarySize < 0 || dictionarySize > std::numeric_limits<int32_t>::max()) {
+        return fail("字典大小无效: " + name);
+    }
+    if (dictOffsets[0] != 0) return fail("字典偏移必须从 0 开始: " + name);
+    for (int64_t k = 0; k < dictionarySize; k++) {
+        if (dictOffsets[k + 1] < dictOffsets[k]) return fail("字典偏移必须单调不减: " + name);
+    }
+    std::vector<uint8_t> mask(static_cast<size_t>(rows_));
+    for (int64_t i = 0; i < rows_; i++) {
+        if (codes[i] < -1 || codes[i] >= dictionarySize) return fail("字典下标越界: " + name);
+        mask[static_cast<size_t>(i)] = codes[i] >= 0 ? 1 : 0;
+    }
+    if (!appendValidity(mask.data(), meta)) return false;
+    meta.valuesBytes = static_cast<uint64_t>(rows_) * sizeof(int32_t);
+    if (!appendAligned(codes, meta.valuesBytes, meta.valuesOffset)) return false;
+    meta.dictionarySize = dictionarySize;
+    if (!appendAligned(dictOffsets, static_cast<uint64_t>(dictionarySize + 1) * sizeof(int64_t),
+                       meta.dictOffsetsOffset)) {
+        return false;
+    }
+    meta.dictCharsBytes = static_cast<uint64_t>(dictOffsets[dictionarySize]);
+    if (!appendAligned(dictChars, meta.dictCharsBytes, meta.dictCharsOffset)) return false;
+    metas_.push_back(meta);
+    return true;
+}
+
+bool ColumnarWriter::finish() {
+    if (!error_.empty()) return false;
+    if (finished_) return fail("写入器已完成");
+
+    // schema 区：列描述之后紧跟列名
+    std::vector<char> schema(metas_.size() * sizeof(ColumnarColumnMeta));
+    uint64_t nameOffset = schema.size();
+    for (size_t c = 0; c < metas_.size(); c++) {
+        metas_[c].nameOffset = nameOffset;
+        nameOffset += names_[c].size();
+    }
+    if (!metas_.empty()) std::memcpy(schema.data(), metas_.data(), schema.size());
+    for (const std::string& name : names_) schema.insert(schema.end(), name.begin(), name.end());
+
+    ColumnarFileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kColumnarVersion;
+    header.byteOrder = kByteOrderMark;
+    header.columnCount = static_cast<uint32_t>(metas_.size());
+    header.rowCount = rows_;
+    header.schemaBytes = schema.size();
+    if (!appendAligned(schema.data(), schema.size(), header.schemaOffset)) return false;
+
+    const char* p = reinterpret_cast<const char*>(&header);
+    size_t written = 0;
+    while (written < sizeof(header)) {
+        ssize_t n = ::pwrite(fd_, p + written, sizeof(header) - written, static_cast<off_t>(written));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return fail(std::string("写入文件头失败: ") + std::strerror(errno));
+        }
+        written += static_cast<size_t>(n);
+    }
+    finished_ = true;
+    return true;
+}
+
+// ==================== 读取 ====================
+
+std::unique_ptr<ColumnarFile> ColumnarFile::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "无法打开文件: " + path;
+        return nullptr;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(ColumnarFileHeader))) {
+        ::close(fd);
+        error = "不是有效的列式文件: " + path;
+        return nullptr;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    // 私有映射：页面按需从文件载入，写入只影响本进程的副本
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        error = std::string("映射文件失败: ") + std::strerror(errno);
+        return nullptr;
+    }
+    std::unique_ptr<ColumnarFile> file(new ColumnarFile());
+    file->base_ = base;
+    file->size_ = size;
+    if (!file->parse(error)) {
+        error += ": " + path;
+        return nullptr;
+    }
+    return file;
+}
+
+ColumnarFile::~ColumnarFile() {
+    if (base_ != nullptr) ::munmap(base_, size_);
+}
+
+bool ColumnarFile::parse(std::string& error) {
+    const char* base = static_cast<const char*>(base_);
+    const uint64_t size = size_;
+    // 区段必须完整落在文件内且按 64 字节对齐
+    auto inRange = [size](uint64_t offset, uint64_t bytes) {
+        return offset % kColumnAlignment == 0 && offset <= size && bytes <= size - offset;
+    };
+
+    ColumnarFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        error = "不是有效的列式文件";
+        return false;
+    }
+    if (header.byteOrder != kByteOrderMark) {
+        error = "列式文件的字节序与本机不一致";
+        return false;
+    }
+    if (header.version != kColumnarVersion) {
+        error = "不支持的列式文件版本 " + std::to_string(header.version);
+        return false;
+    }
+    const uint64_t metaBytes = static_cast<uint64_t>(header.columnCount) * sizeof(ColumnarColumnMeta);
+    if (header.rowCount < 0 || header.schemaOffset == 0 || !inRange(header.schemaOffset, header.schemaBytes) ||
+        metaBytes > header.schemaBytes) {
+        error = "列式文件已损坏（文件头）";
+        return false;
+    }
+    rows_ = header.rowCount;
+    const uint64_t rows = static_cast<uint64_t>(rows_);
+    const char* schema = base + header.schemaOffset;
+
+    columns_.resize(header.columnCount);
+    for (uint32_t c = 0; c < header.columnCount; c++) {
+        ColumnarColumnMeta meta;
+        std::memcpy(&meta, schema + c * sizeof(ColumnarColumnMeta), sizeof(meta));
+        ColumnarColumn& column = columns_[c];
+        auto corrupt = [&error, c]() {
+            error = "列式文件已损坏（第 " + std::to_string(c) + " 列）";
+            return false;
+        };
+
+        if (meta.nameOffset > header.schemaBytes || meta.nameBytes > header.schemaBytes - meta.nameOffset) {
+            return corrupt();
+        }
+        column.name.assign(schema + meta.nameOffset, meta.nameBytes);
+        if (meta.type < static_cast<int32_t>(ColumnarType::BOOL) || meta.type > static_cast<int32_t>(ColumnarType::STRING)) {
+            return corrupt();
+        }
+        column.type = static_cast<ColumnarType>(meta.type);
+
+        // 先限制行数再相乘，避免溢出
+        if (rows > size || meta.valuesBytes != rows * elementSize(column.type) ||
+            !inRange(meta.valuesOffset, meta.valuesBytes)) {
+            return corrupt();
+        }
+        column.values = base + meta.valuesOffset;
+        column.valuesBytes = meta.valuesBytes;
+
+        if (meta.nullCount < 0 || static_cast<uint64_t>(meta.nullCount) > rows) return corrupt();
+        column.nullCount = meta.nullCount;
+        if (meta.nullCount > 0) {
+            if (meta.validityOffset == 0 || !inRange(meta.validityOffset, (rows + 7) / 8)) return corrupt();
+            column.validity = reinterpret_cast<const uint8_t*>(base + meta.validityOffset);
+        }
+
+        if (column.type == ColumnarType::STRING) {
+            if (meta.dictionarySize < 0 || static_cast<uint64_t>(meta.dictionarySize) >= size / sizeof(int64_t) ||
+                !inRange(meta.dictOffsetsOffset, static_cast<uint64_t>(meta.dictionarySize + 1) * sizeof(int64_t)) ||
+                !inRange(meta.dictCharsOffset, meta.dictCharsBytes)) {
+                return corrupt();
+            }
+            const int64_t* offsets = reinterpret_cast<const int64_t*>(base + meta.dictOffsetsOffset);
+            if (offsets[0] != 0 || static_cast<uint64_t>(offsets[meta.dictionarySize]) != meta.dictCharsBytes) {
+                return corrupt();
+            }
+            for (int64_t k = 0; k < meta.dictionarySize; k++) {
+                if (offsets[k + 1] < offsets[k]) return corrupt();
+            }
+            column.dictionarySize = meta.dictionarySize;
+            column.dictOffsets = offsets;
+            column.dictChars = base + meta.dictCharsOffset;
+            column.dictCharsBytes = meta.dictCharsBytes;
+        }
+
+        if (meta.statsOffset != 0) {
+            const bool numeric = column.type == ColumnarType::INT32 || column.type == ColumnarType::INT64 ||
+                                 column.type == ColumnarType::FLOAT64;
+            if (!numeric || meta.statsChunkRows <= 0 ||
+                meta.statsCount != rows_ / meta.statsChunkRows + (rows_ % meta.statsChunkRows != 0 ? 1 : 0) ||
+                !inRange(meta.statsOffset, static_cast<uint64_t>(meta.statsCount) * 16)) {
+                return corrupt();
+            }
+            column.statsChunkRows = meta.statsChunkRows;
+            column.statsCount = meta.statsCount;
+            column.stats = base + meta.statsOffset;
+        }
+    }
+    return true;
+}
+
+} // namespace andas
@@ -0,0 +1,160 @@
+#ifndef ANDAS_COLUMNAR_FILE_H
+#define ANDAS_COLUMNAR_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace andas {
+
+// 二进制列式文件（不依赖JNI），用于 DataFrame 的快速保存和加载
+//
+// 布局（本机字节序，所有区段起点按 64 字节对齐）：
+//   [文件头 64B] [列0 的各区段] [列1 的各区段] ... [schema 区]
+// - 文件头：magic、版本、字节序标记、列数、行数、schema 区的偏移和长度
+// - 每列依次写出：有效位图（有空值时）、值、字典偏移和字典字符（仅字符串列）、分块统计（数值列）
+// - schema 区在所有列写完后追加，写入器因此可以逐列流式写出，最后回填文件头
+// 读取时映射整个文件，列数据直接指向映射内存，不做复制和解析
+
+// 列类型，编码与 CsvType 一致（没有 EMPTY）
+enum class ColumnarType : int32_t {
+    BOOL = 1,     // 每行一个字节
+    INT32 = 2,
+    INT64 = 3,
+    FLOAT64 = 4,  // 空值位置写入 NaN
+    STRING = 5,   // 字典编码：每行一个 int32 字典下标，空值为 -1
+};
+
+constexpr uint32_t kColumnarVersion = 1;
+constexpr int64_t kDefaultStatsChunkRows = 65536;
+
+// 文件头，位于文件起点
+struct ColumnarFileHeader {
+    char magic[8];          // "ANDASCOL"
+    uint32_t version;
+    uint32_t byteOrder;     // 0x01020304，按写入方字节序存储，读取方据此拒绝字节序不同的文件
+    uint32_t columnCount;
+    uint32_t reserved;
+    int64_t rowCount;
+    uint64_t schemaOffset;
+    uint64_t schemaBytes;
+    uint8_t padding[16];
+};
+static_assert(sizeof(ColumnarFileHeader) == 64, "文件头必须为 64 字节");
+
+// schema 区：columnCount 个定长列描述，之后是所有列名（UTF-8，不含结尾 0）
+// 偏移均相对文件起点，列名偏移相对 schema 区起点；偏移为 0 表示该区段不存在
+struct ColumnarColumnMeta {
+    int32_t type;
+    uint32_t nameBytes;
+    uint64_t nameOffset;
+    int64_t nullCount;
+    uint64_t validityOffset;
+    uint64_t valuesOffset;
+    uint64_t valuesBytes;
+    int64_t dictionarySize;
+    uint64_t dictOffsetsOffset;
+    uint64_t dictCharsOffset;
+    uint64_t dictCharsBytes;
+    int64_t statsChunkRows;
+    int64_t statsCount;
+    uint64_t statsOffset;
+};
+static_assert(sizeof(ColumnarColumnMeta) == 104, "列描述布局不能改变");
+
+// 分块统计：每块 statsChunkRows 行记录一对 (min, max)，不含空值和 NaN
+// INT32/INT64 列存为 int64，FLOAT64 列存为 double；整块都是空值时 min > max
+struct ColumnarColumn {
+    std::string name;
+    ColumnarType type = ColumnarType::FLOAT64;
+    int64_t nullCount = 0;
+    const uint8_t* validity = nullptr;   // 位图，1 表示有效；没有空值时为 nullptr
+    const void* values = nullptr;
+    uint64_t valuesBytes = 0;
+    int64_t dictionarySize = 0;
+    const int64_t* dictOffsets = nullptr;  // dictionarySize + 1 项，第 k 项为 [offsets[k], offsets[k+1])
+    const char* dictChars = nullptr;
+    uint64_t dictCharsBytes = 0;
+    int64_t statsChunkRows = 0;
+    int64_t statsCount = 0;
+    const void* stats = nullptr;         // statsCount 对 (min, max)，没有统计时为 nullptr
+};
+
+inline bool columnarIsValid(const uint8_t* validity, int64_t row) {
+    return validity == nullptr || ((validity[row >> 3] >> (row & 7)) & 1) != 0;
+}
+
+// 流式写入：构造时写占位文件头，每次 writeXxx 立即写出一整列，finish 写 schema 并回填文件头
+// 任一步失败后写入器不再可用，error() 给出原因
+class ColumnarWriter {
+public:
+    // statsChunkRows <= 0 时不写分块统计；owned 为 true 时析构关闭 fd
+    ColumnarWriter(int fd, bool owned, int64_t rowCount, int64_t statsChunkRows = kDefaultStatsChunkRows);
+    ~ColumnarWriter();
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    // values 均为 rowCount 项；valid 每行一个字节，0 表示空值，nullptr 表示没有空值
+    bool writeBool(const std::string& name, const uint8_t* values, const uint8_t* valid);
+    bool writeInt32(const std::string& name, const int32_t* values, const uint8_t* valid);
+    bool writeInt64(const std::string& name, const int64_t* values, const uint8_t* valid);
+    bool writeFloat64(const std::string& name, const double* values, const uint8_t* valid);
+
+    // 字典编码的字符串列：codes[i] 为字典下标，-1 表示空值
+    bool writeString(const std::string& name, const int32_t* codes, int64_t dictionarySize,
+                     const int64_t* dictOffsets, const char* dictChars);
+
+    bool finish();
+
+    const std::string& error() const { return error_; }
+
+private:
+    bool begin(const std::string& name, ColumnarType type, ColumnarColumnMeta& meta);
+    bool append(const void* data, uint64_t bytes);
+    bool appendAligned(const void* data, uint64_t bytes, uint64_t& offset);
+    bool appendValidity(const uint8_t* valid, ColumnarColumnMeta& meta);
+    template <typename T, typename S>
+    bool appendStats(const T* values, const uint8_t* valid, ColumnarColumnMeta& meta);
+    bool fail(const std::string& message);
+
+    int fd_;
+    bool owned_;
+    int64_t rows_;
+    int64_t statsChunkRows_;
+    uint64_t position_ = 0;
+    bool finished_ = false;
+    std::vector<ColumnarColumnMeta> metas_;
+    std::vector<std::string> names_;
+    std::string error_;
+};
+
+// 只读映射的列式文件，析构时解除映射，由其得到的所有指针随之失效
+// 映射为私有可写（写时复制），原地修改列数据不会写回文件
+class ColumnarFile {
+public:
+    // 失败返回 nullptr，原因写入 error
+    static std::unique_ptr<ColumnarFile> open(const std::string& path, std::string& error);
+    ~ColumnarFile();
+
+    ColumnarFile(const ColumnarFile&) = delete;
+    ColumnarFile& operator=(const ColumnarFile&) = delete;
+
+    int64_t rows() const { return rows_; }
+    const std::vector<ColumnarColumn>& columns() const { return columns_; }
+
+private:
+    ColumnarFile() = default;
+    bool parse(std::string& error);
+
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    int64_t rows_ = 0;
+    std::vector<ColumnarColumn> columns_;
+};
+
+} // namespace andas
+
+#endif //ANDAS_COLUMNAR_FILE_H
@@ -0,0 +1,542 @@
+#include "corr_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "memory_pool.h"
+#include "sort_engine.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+namespace {
+
+constexpr int kTile = 4;
+constexpr int64_t kBlockRows = 256;
+constexpr int64_t kSegmentRows = 1 << 16;
+constexpr int64_t kMaxSegments = 64;
+// 各段部分和占用的内存上限，列数很多时减少段数
+constexpr int64_t kSegmentBudgetBytes = int64_t{64} << 20;
+// 平移后的平方和相对抵消到这个比例以下时视为方差为 0
+constexpr double kZeroVariance = 1e-12;
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// count 个任务，work 为总工作量，数据量小时串行执行
+void runTasks(int64_t count, int64_t work, const std::function<void(int64_t)>& task) {
+    if (count <= 1 || detail::shouldRunSerial(work)) {
+        for (int64_t i = 0; i < count; i++) task(i);
+        return;
+    }
+    ThreadPool::instance().run(count, task);
+}
+
+inline double clampUnit(double r) {
+    return std::max(-1.0, std::min(1.0, r));
+}
+
+// 一对列在共同有效的行上的和（已减去各列的平移量）
+struct PairMoments {
+    double count;
+    double sumA;
+    double sumB;
+    double sqA;
+    double sqB;
+    double cross;
+};
+
+double correlationOf(const PairMoments& m, int64_t minPeriods) {
+    if (m.count < static_cast<double>(minPeriods)) return kNaN;
+    const double varA = m.sqA - m.sumA * m.sumA / m.count;
+    const double varB = m.sqB - m.sumB * m.sumB / m.count;
+    if (!(varA > m.sqA * kZeroVariance) || !(varB > m.sqB * kZeroVariance)) return kNaN;
+    return clampUnit((m.cross - m.sumA * m.sumB / m.count) / std::sqrt(varA * varB));
+}
+
+double covarianceOf(const PairMoments& m, int64_t minPeriods, int64_t ddof) {
+    if (m.count < static_cast<double>(minPeriods) || m.count <= static_cast<double>(ddof)) return kNaN;
+    return (m.cross - m.sumA * m.sumB / m.count) / (m.count - static_cast<double>(ddof));
+}
+
+// ==================== 分块乘积 ====================
+
+// 一个 4×4 列块对在若干行上的和；dense 时只用 cross
+struct TileSums {
+    double count[kTile][kTile];
+    double sumA[kTile][kTile];
+    double sumB[kTile][kTile];
+    double sqA[kTile][kTile];
+    double sqB[kTile][kTile];
+    double cross[kTile][kTile];
+};
+
+// 行 [lo, hi) 上的 Σ(a - sa)(b - sb)，累加器是局部变量，编译器可以放在寄存器中
+void denseTile(const double* const* a, const double* sa, const double* const* b, const double* sb,
+               int64_t lo, int64_t hi, TileSums& out) {
+    double cross[kTile][kTile] = {};
+    for (int64_t r = lo; r < hi; r++) {
+        double x[kTile];
+        double y[kTile];
+        for (int i = 0; i < kTile; i++) x[i] = a[i][r] - sa[i];
+        for (int j = 0; j < kTile; j++) y[j] = b[j][r] - sb[j];
+        for (int i = 0; i < kTile; i++) {
+            for (int j = 0; j < kTile; j++) cross[i][j] += x[i] * y[j];
+        }
+    }
+    for (int i = 0; i < kTile; i++) {
+        for (int j = 0; j < kTile; j++) out.cross[i][j] = cross[i][j];
+    }
+}
+
+// 块内 Σ a[i][r] * b[j][r]，16 个累加器可以全部放在寄存器中
+void productTile(const double* const* a, const double* const* b, int64_t len, double out[kTile][kTile]) {
+    double acc[kTile][kTile] = {};
+    for (int64_t r = 0; r < len; r++) {
+        double x[kTile];
+        double y[kTile];
+        for (int i = 0; i < kTile; i++) x[i] = a[i][r];
+        for (int j = 0; j < kTile; j++) y[j] = b[j][r];
+        for (int i = 0; i < kTile; i++) {
+            for (int j = 0; j < kTile; j++) acc[i][j] += x[i] * y[j];
+        }
+    }
+    for (int i = 0; i < kTile; i++) {
+        for (int j = 0; j < kTile; j++) out[i][j] = acc[i][j];
+    }
+}
+
+// 有缺失值时：块内各列已展开为 z（平移后的值，缺失为 0）、z² 与有效位 m（0/1），
+// 六个和都是这三种数组之间的乘积，例如 Σ z_a·m_b 即 a 在共同有效行上的和；
+// 分成六次乘积而不是一次累加六个量，避免累加器溢出寄存器
+struct MaskedColumns {
+    const double* z[kTile];
+    const double* zz[kTile];
+    const double* m[kTile];
+};
+
+void maskedTile(const MaskedColumns& a, const MaskedColumns& b, int64_t len, TileSums& out) {
+    productTile(a.m, b.m, len, out.count);
+    productTile(a.z, b.m, len, out.sumA);
+    productTile(a.m, b.z, len, out.sumB);
+    productTile(a.zz, b.m, len, out.sqA);
+    productTile(a.m, b.zz, len, out.sqB);
+    productTile(a.z, b.z, len, out.cross);
+}
+
+// 所有列对的和；列对 (a, b)（a <= b）存放在 a * k + b
+struct CorrSums {
+    int32_t k = 0;
+    int64_t n = 0;
+    bool dense = true;
+    std::vector<double> colSum;   // dense 时各列的 Σ(x - shift)
+    std::vector<double> count;
+    std::vector<double> sumA;
+    std::vector<double> sumB;
+    std::vector<double> sqA;
+    std::vector<double> sqB;
+    std::vector<double> cross;
+
+    CorrSums(int32_t columns, int64_t rows, bool denseInput) : k(columns), n(rows), dense(denseInput) {
+        const size_t size = static_cast<size_t>(k) * static_cast<size_t>(k);
+        cross.assign(size, 0.0);
+        if (!dense) {
+            count.assign(size, 0.0);
+            sumA.assign(size, 0.0);
+            sumB.assign(size, 0.0);
+            sqA.assign(size, 0.0);
+            sqB.assign(size, 0.0);
+        }
+    }
+
+    void add(const CorrSums& other) {
+        for (size_t i = 0; i < cross.size(); i++) cross[i] += other.cross[i];
+        if (dense) return;
+        for (size_t i = 0; i < count.size(); i++) {
+            count[i] += other.count[i];
+            sumA[i] += other.sumA[i];
+            sumB[i] += other.sumB[i];
+            sqA[i] += other.sqA[i];
+            sqB[i] += other.sqB[i];
+        }
+    }
+
+    PairMoments pair(int32_t a, int32_t b) const {
+        if (a > b) std::swap(a, b);
+        const size_t ab = static_cast<size_t>(a) * static_cast<size_t>(k) + static_cast<size_t>(b);
+        if (dense) {
+            const size_t aa = static_cast<size_t>(a) * static_cast<size_t>(k) + static_cast<size_t>(a);
+            const size_t bb = static_cast<size_t>(b) * static_cast<size_t>(k) + static_cast<size_t>(b);
+            return {static_cast<double>(n), colSum[static_cast<size_t>(a)], colSum[static_cast<size_t>(b)],
+                    cross[aa], cross[bb], cross[ab]};
+        }
+        return {count[ab], sumA[ab], sumB[ab], sqA[ab], sqB[ab], cross[ab]};
+    }
+};
+
+CorrSums pairSums(const double* const* columns, int32_t k, int64_t n) {
+    // 平移量取各列有效值的均值，使 Σx² 与 Σx 的差不会大幅抵消
+    std::vector<double> shifts(static_cast<size_t>(k), 0.0);
+    std::vector<double> colSum(static_cast<size_t>(k), 0.0);
+    std::vector<char> hasNull(static_cast<size_t>(k), 0);
+    runTasks(k, n * k, [&](int64_t c) {
+        const double* x = columns[c];
+        double sum = 0.0;
+        int64_t valid = 0;
+        for (int64_t r = 0; r < n; r++) {
+            if (!std::isnan(x[r])) {
+                sum += x[r];
+                valid++;
+            }
+        }
+        const double shift = valid > 0 ? sum / static_cast<double>(valid) : 0.0;
+        double shifted = 0.0;
+        for (int64_t r = 0; r < n; r++) {
+            if (!std::isnan(x[r])) shifted += x[r] - shift;
+        }
+        shifts[static_cast<size_t>(c)] = shift;
+        colSum[static_cast<size_t>(c)] = shifted;
+        hasNull[static_cast<size_t>(c)] = valid < n ? 1 : 0;
+    });
+    const bool dense = std::none_of(hasNull.begin(), hasNull.end(), [](char v) { return v != 0; });
+
+    const int64_t fields = dense ? 1 : 6;
+    const int64_t segmentBytes = std::max<int64_t>(1, static_cast<int64_t>(k) * k * 8 * fields);
+    int64_t segments = std::min<int64_t>(kMaxSegments, std::max<int64_t>(1, (n + kSegmentRows - 1) / kSegmentRows));
+    segments = std::max<int64_t>(1, std::min(segments, kSegmentBudgetBytes / segmentBytes));
+    const int64_t grain = std::max<int64_t>(1, (n + segments - 1) / segments);
+    const int32_t tiles = (k + kTile - 1) / kTile;
+
+    std::vector<CorrSums> partials;
+    partials.reserve(static_cast<size_t>(segments));
+    for (int64_t s = 0; s < segments; s++) partials.emplace_back(k, n, dense);
+
+    // 任务 = (段, 列块行 ti)：负责该段上 a 属于第 ti 块、b >= a 的所有列对，各任务写入的位置互不重叠
+    runTasks(segments * tiles, n * k, [&](int64_t task) {
+        const int64_t segment = task / tiles;
+        const int32_t ti = static_cast<int32_t>(task % tiles);
+        const int64_t lo = segment * grain;
+        const int64_t hi = std::min(n, lo + grain);
+        CorrSums& out = partials[static_cast<size_t>(segment)];
+
+        // 不满 4 列的块重复最后一列，多出的结果不写回
+        const int32_t a0 = ti * kTile;
+        const int32_t aw = std::min(kTile, k - a0);
+        const double* a[kTile];
+        double sa[kTile];
+        for (int i = 0; i < kTile; i++) {
+            const int32_t c = a0 + std::min(i, aw - 1);
+            a[i] = columns[c];
+            sa[i] = shifts[static_cast<size_t>(c)];
+        }
+        // 有缺失值时按块展开第 ti 块及之后的列，每列 z、z²、m 各 kBlockRows 个
+        const int32_t expanded = dense ? 0 : k - a0;
+        ScratchBuffer<double> buffer(static_cast<int64_t>(expanded) * 3 * kBlockRows);
+        // 不满 4 列的块同样重复最后一列
+        auto maskedColumns = [&](int32_t first, int32_t width) {
+            MaskedColumns out;
+            for (int i = 0; i < kTile; i++) {
+                const double* base = buffer.data() + static_cast<int64_t>(first + std::min(i, width - 1) - a0) * 3 * kBlockRows;
+                out.z[i] = base;
+                out.zz[i] = base + kBlockRows;
+                out.m[i] = base + 2 * kBlockRows;
+            }
+            return out;
+        };
+        const MaskedColumns ma = dense ? MaskedColumns{} : maskedColumns(a0, aw);
+
+        TileSums tile;
+        for (int64_t block = lo; block < hi; block += kBlockRows) {
+            const int64_t blockEnd = std::min(hi, block + kBlockRows);
+            const int64_t len = blockEnd - block;
+            for (int32_t e = 0; e < expanded; e++) {
+                const double* x = columns[a0 + e] + block;
+                const double shift = shifts[static_cast<size_t>(a0 + e)];
+                double* z = buffer.data() + static_cast<int64_t>(e) * 3 * kBlockRows;
+                double* zz = z + kBlockRows;
+                double* m = zz + kBlockRows;
+                for (int64_t r = 0; r < len; r++) {
+                    const bool valid = !std::isnan(x[r]);
+                    z[r] = valid ? x[r] - shift : 0.0;
+                    zz[r] = z[r] * z[r];
+                    m[r] = valid ? 1.0 : 0.0;
+                }
+            }
+            for (int32_t tj = ti; tj < tiles; tj++) {
+                const int32_t b0 = tj * kTile;
+                const int32_t bw = std::min(kTile, k - b0);
+                if (dense) {
+                    const double* b[kTile];
+                    double sb[kTile];
+                    for (int j = 0; j < kTile; j++) {
+                        const int32_t c = b0 + std::min(j, bw - 1);
+                        b[j] = columns[c];
+                        sb[j] = shifts[static_cast<size_t>(c)];
+                    }
+                    denseTile(a, sa, b, sb, block, blockEnd, tile);
+                } else {
+                    maskedTile(ma, maskedColumns(b0, bw), len, tile);
+                }
+                for (int i = 0; i < aw; i++) {
+                    for (int j = 0; j < bw; j++) {
+                        if (a0 + i > b0 + j) continue;
+                        const size_t ab = static_cast<size_t>(a0 + i) * static_cast<size_t>(k) +
+                                          static_cast<size_t>(b0 + j);
+                        out.cross[ab] += tile.cross[i][j];
+                        if (dense) continue;
+                        out.count[ab] += tile.count[i][j];
+                        out.sumA[ab] += tile.sumA[i][j];
+                        out.sumB[ab] += tile.sumB[i][j];
+                        out.sqA[ab] += tile.sqA[i][j];
+                        out.sqB[ab] += tile.sqB[i][j];
+                    }
+                }
+            }
+        }
+    });
+
+    CorrSums total = std::move(partials[0]);
+    for (size_t s = 1; s < partials.size(); s++) total.add(partials[s]);
+    total.colSum = std::move(colSum);
+    return total;
+}
+
+void pearsonMatrix(const double* const* columns, int32_t k, int64_t n, int64_t minPeriods, double* out) {
+    const CorrSums sums = pairSums(columns, k, n);
+    for (int32_t a = 0; a < k; a++) {
+        for (int32_t b = a; b < k; b++) {
+            double r = correlationOf(sums.pair(a, b), minPeriods);
+            if (a == b && !std::isnan(r)) r = 1.0;
+            out[static_cast<int64_t>(a) * k + b] = r;
+            out[static_cast<int64_t>(b) * k + a] = r;
+        }
+    }
+}
+
+// ==================== 秩相关 ====================
+
+// 平均秩（从 1 开始，相等的值取平均），NaN 的秩为 NaN
+void averageRanks(const double* x, int64_t n, double* out) {
+    ScratchBuffer<int32_t> order(n);
+    sortIndices(x, n, false, false, order.data());
+    int64_t i = 0;
+    while (i < n && !std::isnan(x[order[i]])) {
+        int64_t j = i;
+        while (j + 1 < n && x[order[j + 1]] == x[order[i]]) j++;
+        const double rank = static_cast<double>(i + j) / 2.0 + 1.0;
+        for (int64_t p = i; p <= j; p++) out[order[p]] = rank;
+        i = j + 1;
+    }
+    for (; i < n; i++) out[order[i]] = kNaN;
+}
+
+// 两列在共同有效的行上的值，返回行数
+int64_t gatherComplete(const double* x, const double* y, int64_t n, double* xs, double* ys) {
+    int64_t m = 0;
+    for (int64_t r = 0; r < n; r++) {
+        if (std::isnan(x[r]) || std::isnan(y[r])) continue;
+        xs[m] = x[r];
+        ys[m] = y[r];
+        m++;
+    }
+    return m;
+}
+
+// 两遍算法的 Pearson，输入没有缺失值
+double pearsonOf(const double* x, const double* y, int64_t m) {
+    double meanX = 0.0;
+    double meanY = 0.0;
+    for (int64_t i = 0; i < m; i++) {
+        meanX += x[i];
+        meanY += y[i];
+    }
+    meanX /= static_cast<double>(m);
+    meanY /= static_cast<double>(m);
+    PairMoments moments{static_cast<double>(m), 0.0, 0.0, 0.0, 0.0, 0.0};
+    for (int64_t i = 0; i < m; i++) {
+        const double dx = x[i] - meanX;
+        const double dy = y[i] - meanY;
+        moments.sumA += dx;
+        moments.sumB += dy;
+        moments.sqA += dx * dx;
+        moments.sqB += dy * dy;
+        moments.cross += dx * dy;
+    }
+    return correlationOf(moments, 1);
+}
+
+// 相等值组成的段中的对数 Σ t(t-1)/2，values 已按 order 排好序
+template <typename Value>
+int64_t tiedPairs(int64_t from, int64_t to, Value&& value) {
+    int64_t ties = 0;
+    int64_t i = from;
+    while (i < to) {
+        int64_t j = i;
+        while (j + 1 < to && value(j + 1) == value(i)) j++;
+        const int64_t t = j - i + 1;
+        ties += t * (t - 1) / 2;
+        i = j + 1;
+    }
+    return ties;
+}
+
+// 自底向上归并排序 v，返回逆序对（i < j 且 v[i] > v[j]）的个数
+int64_t sortCountingInversions(double* v, double* scratch, int64_t m) {
+    int64_t inversions = 0;
+    double* src = v;
+    double* dst = scratch;
+    for (int64_t width = 1; width < m; width *= 2) {
+        for (int64_t lo = 0; lo < m; lo += 2 * width) {
+            const int64_t mid = std::min(m, lo + width);
+            const int64_t hi = std::min(m, lo + 2 * width);
+            int64_t i = lo;
+            int64_t j = mid;
+            int64_t k = lo;
+            while (i < mid && j < hi) {
+                if (src[j] < src[i]) {
+                    inversions += mid - i;
+                    dst[k++] = src[j++];
+                } else {
+                    dst[k++] = src[i++];
+                }
+            }
+            while (i < mid) dst[k++] = src[i++];
+            while (j < hi) dst[k++] = src[j++];
+        }
+        std::swap(src, dst);
+    }
+    if (src != v) std::copy(src, src + m, v);
+    return inversions;
+}
+
+// Kendall tau-b，Knight 算法：按 (x, y) 排序后，y 的逆序对即不一致对
+double kendallOf(const double* x, const double* y, int64_t m) {
+    if (m < 2) return kNaN;
+    ScratchBuffer<int32_t> order(m);
+    const SortKey keys[2] = {{SortKeyType::FLOAT64, x, false, false}, {SortKeyType::FLOAT64, y, false, false}};
+    sortIndices(keys, 2, m, order.data());
+
+    // x 相同的对数，以及 x、y 都相同的对数（x 相同的段内 y 已有序）
+    int64_t tiedX = 0;
+    int64_t tiedXY = 0;
+    int64_t i = 0;
+    while (i < m) {
+        int64_t j = i;
+        while (j + 1 < m && x[order[j + 1]] == x[order[i]]) j++;
+        const int64_t t = j - i + 1;
+        tiedX += t * (t - 1) / 2;
+        tiedXY += tiedPairs(i, j + 1, [&](int64_t p) { return y[order[p]]; });
+        i = j + 1;
+    }
+
+    ScratchBuffer<double> ys(m);
+    ScratchBuffer<double> scratch(m);
+    for (int64_t p = 0; p < m; p++) ys[p] = y[order[p]];
+    const int64_t discordant = sortCountingInversions(ys.data(), scratch.data(), m);
+    const int64_t tiedY = tiedPairs(0, m, [&](int64_t p) { return ys[p]; });
+
+    const int64_t total = m * (m - 1) / 2;
+    const double denominator = std::sqrt(static_cast<double>(total - tiedX) * static_cast<double>(total - tiedY));
+    if (denominator == 0.0) return kNaN;
+    const double numerator = static_cast<double>(total - tiedX - tiedY + tiedXY) - 2.0 * static_cast<double>(discordant);
+    return clampUnit(numerator / denominator);
+}
+
+void spearmanMatrix(const double* const* columns, int32_t k, int64_t n, int64_t minPeriods, double* out) {
+    std::vector<double> ranks(static_cast<size_t>(k) * static_cast<size_t>(n));
+    std::vector<const double*> rankColumns(static_cast<size_t>(k));
+    std::vector<char> hasNull(static_cast<size_t>(k), 0);
+    for (int32_t c = 0; c < k; c++) {
+        double* r = ranks.data() + static_cast<int64_t>(c) * n;
+        averageRanks(columns[c], n, r);
+        rankColumns[static_cast<size_t>(c)] = r;
+        hasNull[static_cast<size_t>(c)] = std::any_of(columns[c], columns[c] + n, [](double v) { return std::isnan(v); });
+    }
+    pearsonMatrix(rankColumns.data(), k, n, minPeriods, out);
+
+    // 有缺失值的列对只在共同有效的行上比较，需要在这些行上重新求秩
+    std::vector<std::pair<int32_t, int32_t>> pairs;
+    for (int32_t a = 0; a < k; a++) {
+        for (int32_t b = a + 1; b < k; b++) {
+            if (hasNull[static_cast<size_t>(a)] || hasNull[static_cast<size_t>(b)]) pairs.emplace_back(a, b);
+        }
+    }
+    runTasks(static_cast<int64_t>(pairs.size()), n * static_cast<int64_t>(pairs.size()), [&](int64_t p) {
+        const int32_t a = pairs[static_cast<size_t>(p)].first;
+        const int32_t b = pairs[static_cast<size_t>(p)].second;
+        ScratchBuffer<double> xs(n);
+        ScratchBuffer<double> ys(n);
+        const int64_t m = gatherComplete(columns[a], columns[b], n, xs.data(), ys.data());
+        double r = kNaN;
+        if (m >= minPeriods && m > 0) {
+            ScratchBuffer<double> rx(m);
+            ScratchBuffer<double> ry(m);
+            averageRanks(xs.data(), m, rx.data());
+            averageRanks(ys.data(), m, ry.data());
+            r = pearsonOf(rx.data(), ry.data(), m);
+        }
+        out[static_cast<int64_t>(a) * k + b] = r;
+        out[static_cast<int64_t>(b) * k + a] = r;
+    });
+}
+
+void kendallMatrix(const double* const* columns, int32_t k, int64_t n, int64_t minPeriods, double* out) {
+    std::vector<std::pair<int32_t, int32_t>> pairs;
+    for (int32_t a = 0; a < k; a++) {
+        for (int32_t b = a; b < k; b++) pairs.emplace_back(a, b);
+    }
+    runTasks(static_cast<int64_t>(pairs.size()), n * static_cast<int64_t>(pairs.size()), [&](int64_t p) {
+        const int32_t a = pairs[static_cast<size_t>(p)].first;
+        const int32_t b = pairs[static_cast<size_t>(p)].second;
+        ScratchBuffer<double> xs(n);
+        ScratchBuffer<double> ys(n);
+        const int64_t m = gatherComplete(columns[a], columns[b], n, xs.data(), ys.data());
+        double r = kNaN;
+        if (m >= minPeriods && m > 0) {
+            // 对角线与 pandas 一致：有效值足够时为 1
+            r = a == b ? 1.0 : kendallOf(xs.data(), ys.data(), m);
+        }
+        out[static_cast<int64_t>(a) * k + b] = r;
+        out[static_cast<int64_t>(b) * k + a] = r;
+    });
+}
+
+} // namespace
+
+bool isValidCorrMethod(int32_t method) {
+    return method >= static_cast<int32_t>(CorrMethod::PEARSON) && method <= static_cast<int32_t>(CorrMethod::KENDALL);
+}
+
+void correlationMatrix(const double* const* columns, int32_t k, int64_t n, CorrMethod method,
+                       int64_t minPeriods, double* out) {
+    if (k <= 0) return;
+    minPeriods = std::max<int64_t>(1, minPeriods);
+    switch (method) {
+        case CorrMethod::PEARSON:
+            pearsonMatrix(columns, k, n, minPeriods, out);
+            break;
+        case CorrMethod::SPEARMAN:
+            spearmanMatrix(columns, k, n, minPeriods, out);
+            break;
+        case CorrMethod::KENDALL:
+            kendallMatrix(columns, k, n, minPeriods, out);
+            break;
+    }
+}
+
+void covarianceMatrix(const double* const* columns, int32_t k, int64_t n, int64_t minPeriods, int64_t ddof,
+                      double* out) {
+    if (k <= 0) return;
+    minPeriods = std::max<int64_t>(1, minPeriods);
+    const CorrSums sums = pairSums(columns, k, n);
+    for (int32_t a = 0; a < k; a++) {
+        for (int32_t b = a; b < k; b++) {
+            const double c = covarianceOf(sums.pair(a, b), minPeriods, ddof);
+            out[static_cast<int64_t>(a) * k + b] = c;
+            out[static_cast<int64_t>(b) * k + a] = c;
+        }
+    }
+}
+
+} // namespace andas
@@ -0,0 +1,37 @@
+#ifndef ANDAS_CORR_ENGINE_H
+#define ANDAS_CORR_ENGINE_H
+
+#include <cstdint>
+
+namespace andas {
+
+// 相关系数/协方差矩阵内核（不依赖JNI）
+// - 输入为 k 个长度为 n 的 double 列，NaN 为缺失值；每对列只使用两列都不缺失的行（pairwise complete）
+// - Pearson/协方差：各列先平移到自身均值附近，再按 4 列一组分块做 syrk 式乘积，
+//   一次遍历得到所有列对的有效行数、Σx、Σx²、Σxy；没有缺失值时只需要 Σxy。
+//   行按 256 行的块推进，一个列块在块内常驻 L1，另一侧的列块依次流过
+// - 行划分为固定的段（与线程数无关），任务为 (段, 列块行)，各段的部分和按段顺序合并，结果可复现
+// - Spearman：先用原生排序求各列的平均秩，对秩做 Pearson；有缺失值的列对在共同有效的行上重新求秩
+// - Kendall：tau-b，每对列用 Knight 的 O(n log n) 算法（按 (x, y) 排序后归并统计逆序对），列对之间并行
+// - 有效行数少于 minPeriods 或任一侧方差为 0 的列对结果为 NaN，与 pandas 一致
+
+// 方法编码，与 Kotlin 侧 CorrMethod.code 一致
+enum class CorrMethod : int32_t {
+    PEARSON = 0,
+    SPEARMAN = 1,
+    KENDALL = 2,
+};
+
+bool isValidCorrMethod(int32_t method);
+
+// 相关系数矩阵，out 为 k×k 行主序且对称；有效的对角线元素为 1
+void correlationMatrix(const double* const* columns, int32_t k, int64_t n, CorrMethod method,
+                       int64_t minPeriods, double* out);
+
+// 协方差矩阵（自由度 count - ddof），out 为 k×k 行主序且对称；有效行数 <= ddof 时为 NaN
+void covarianceMatrix(const double* const* columns, int32_t k, int64_t n, int64_t minPeriods, int64_t ddof,
+                      double* out);
+
+} // namespace andas
+
+#endif //ANDAS_CORR_ENGINE_H
@@ -0,0 +1,783 @@
+#include "csv_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <unistd.h>
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+CsvType joinCsvTypes(CsvType a, CsvType b) {
+    if (a == CsvType::EMPTY) return b;
+    if (b == CsvType::EMPTY) return a;
+    if (a == b) return a;
+    if (a == CsvType::BOOL || b == CsvType::BOOL) return CsvType::STRING;
+    return std::max(a, b);
+}
+
+namespace {
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+inline bool equalsIgnoreCase(const char* text, int64_t length, const char* word) {
+    const int64_t n = static_cast<int64_t>(std::strlen(word));
+    if (length != n) return false;
+    for (int64_t i = 0; i < n; i++) {
+        char c = text[i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (c != word[i]) return false;
+    }
+    return true;
+}
+
+// 返回 1 表示 true，0 表示 false，-1 表示不是布尔值
+inline int parseBool(const char* text, int64_t length) {
+    if (equalsIgnoreCase(text, length, "true") || equalsIgnoreCase(text, length, "yes")) return 1;
+    if (equalsIgnoreCase(text, length, "false") || equalsIgnoreCase(text, length, "no")) return 0;
+    return -1;
+}
+
+// 数值的词法结构：-?\d+(\.\d+)?([eE][+-]?\d+)?，返回 false 表示不符合
+struct NumberShape {
+    bool isInteger;
+};
+
+bool scanNumber(const char* text, int64_t length, NumberShape& shape) {
+    int64_t i = 0;
+    if (i < length && text[i] == '-') i++;
+    const int64_t intStart = i;
+    while (i < length && isDigit(text[i])) i++;
+    if (i == intStart) return false;
+    shape.isInteger = true;
+    if (i < length && text[i] == '.') {
+        const int64_t fracStart = ++i;
+        while (i < length && isDigit(text[i])) i++;
+        if (i == fracStart) return false;
+        shape.isInteger = false;
+    }
+    if (i < length && (text[i] == 'e' || text[i] == 'E')) {
+        i++;
+        if (i < length && (text[i] == '+' || text[i] == '-')) i++;
+        const int64_t expStart = i;
+        while (i < length && isDigit(text[i])) i++;
+        if (i == expStart) return false;
+        shape.isInteger = false;
+    }
+    return i == length;
+}
+
+// 10 的 0~22 次幂都能被 double 精确表示
+const double kPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+} // namespace
+
+bool parseCsvInt64(const char* text, int64_t length, int64_t& out) {
+    int64_t i = 0;
+    const bool negative = length > 0 && text[0] == '-';
+    if (negative) i++;
+    if (i == length) return false;
+    // 按负数累加，INT64_MIN 也能表示
+    int64_t value = 0;
+    for (; i < length; i++) {
+        if (!isDigit(text[i])) return false;
+        const int digit = text[i] - '0';
+        if (value < (INT64_MIN + digit) / 10) return false;
+        value = value * 10 - digit;
+    }
+    if (!negative) {
+        if (value == INT64_MIN) return false;
+        value = -value;
+    }
+    out = value;
+    return true;
+}
+
+bool parseCsvDouble(const char* text, int64_t length, double& out) {
+    NumberShape shape;
+    if (!scanNumber(text, length, shape)) return false;
+
+    // 快速路径（Clinger）：不超过 19 位有效数字、尾数不超过 2^53 且十进制指数在 ±22 以内时，
+    // 尾数和 10 的幂都是精确的 double，一次乘除即得到正确舍入的结果
+    int64_t i = 0;
+    const bool negative = text[0] == '-';
+    if (negative) i++;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int64_t exponent = 0;
+    bool exact = true;
+    for (; i < length && isDigit(text[i]); i++) {
+        const int d = text[i] - '0';
+        if (mantissa == 0 && d == 0) continue;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(d);
+            digits++;
+        } else {
+            exponent++;
+            exact = false;
+        }
+    }
+    if (i < length && text[i] == '.') {
+        for (i++; i < length && isDigit(text[i]); i++) {
+            const int d = text[i] - '0';
+            if (mantissa == 0 && d == 0) {
+                exponent--;
+                continue;
+            }
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(d);
+                digits++;
+                exponent--;
+            } else if (d != 0) {
+                exact = false;
+            }
+        }
+    }
+    if (i < length) {
+        i++;
+        bool expNegative = false;
+        if (text[i] == '+' || text[i] == '-') expNegative = text[i++] == '-';
+        int64_t e = 0;
+        for (; i < length; i++) {
+            if (e < 100000) e = e * 10 + (text[i] - '0');
+        }
+        exponent += expNegative ? -e : e;
+    }
+
+    if (mantissa == 0) {
+        out = negative ? -0.0 : 0.0;
+        return true;
+    }
+    if (exact && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        double value = static_cast<double>(mantissa);
+        value = exponent >= 0 ? value * kPow10[exponent] : value / kPow10[-exponent];
+        out = negative ? -value : value;
+        return true;
+    }
+
+    // 慢速路径交给 strtod，需要以 \0 结尾的副本
+    char local[64];
+    std::string heap;
+    const char* copy = local;
+    if (length < static_cast<int64_t>(sizeof(local))) {
+        std::memcpy(local, text, static_cast<size_t>(length));
+        local[length] = '\0';
+    } else {
+        heap.assign(text, static_cast<size_t>(length));
+        copy = heap.c_str();
+    }
+    out = std::strtod(copy, nullptr);
+    return true;
+}
+
+CsvType classifyCsvValue(const char* text, int64_t length) {
+    NumberShape shape;
+    if (scanNumber(text, length, shape)) {
+        if (!shape.isInteger) return CsvType::FLOAT64;
+        int64_t value;
+        // 超出 int64 的整数按浮点数处理，与 FLOAT64 列能接受它保持一致
+        if (!parseCsvInt64(text, length, value)) return CsvType::FLOAT64;
+        return (value >= INT32_MIN && value <= INT32_MAX) ? CsvType::INT32 : CsvType::INT64;
+    }
+    if (parseBool(text, length) >= 0) return CsvType::BOOL;
+    return CsvType::STRING;
+}
+
+FdCsvSource::FdCsvSource(int fd, bool owned) : fd_(fd), owned_(owned) {}
+
+FdCsvSource::~FdCsvSource() {
+    if (owned_ && fd_ >= 0) ::close(fd_);
+}
+
+int64_t FdCsvSource::read(char* buffer, int64_t capacity) {
+    for (;;) {
+        ssize_t n = ::read(fd_, buffer, static_cast<size_t>(capacity));
+        if (n < 0 && errno == EINTR) continue;
+        return static_cast<int64_t>(n);
+    }
+}
+
+MemoryCsvSource::MemoryCsvSource(const char* data, int64_t size) : data_(data), size_(size) {}
+
+int64_t MemoryCsvSource::read(char* buffer, int64_t capacity) {
+    const int64_t n = std::min(capacity, size_ - position_);
+    std::memcpy(buffer, data_ + position_, static_cast<size_t>(n));
+    position_ += n;
+    return n;
+}
+
+PrefetchCsvSource::PrefetchCsvSource(std::unique_ptr<CsvSource> inner, int64_t blockBytes, int32_t depth)
+    : inner_(std::move(inner)), blocks_(static_cast<size_t>(std::max<int32_t>(depth, 2))) {
+    for (Block& block : blocks_) {
+        block.data.resize(static_cast<size_t>(std::max<int64_t>(blockBytes, 64)));
+        free_.push_back(&block);
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+PrefetchCsvSource::~PrefetchCsvSource() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+void PrefetchCsvSource::run() {
+    for (;;) {
+        Block* block = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !free_.empty(); });
+            if (stopping_) break;
+            block = free_.front();
+            free_.pop_front();
+        }
+        // 读满一块再交出，减少与调用方的同步次数
+        block->size = 0;
+        const int64_t capacity = static_cast<int64_t>(block->data.size());
+        int64_t n = 0;
+        while (block->size < capacity) {
+            n = inner_->read(block->data.data() + block->size, capacity - block->size);
+            if (n <= 0) break;
+            block->size += n;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (block->size > 0) ready_.push_back(block);
+            if (n < 0) failed_ = true;
+            if (n <= 0) break;
+        }
+        cv_.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+    }
+    cv_.notify_all();
+}
+
+int64_t PrefetchCsvSource::read(char* buffer, int64_t capacity) {
+    if (current_ == nullptr || offset_ == current_->size) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (current_ != nullptr) {
+            free_.push_back(current_);
+            current_ = nullptr;
+            cv_.notify_all();
+        }
+        cv_.wait(lock, [this] { return done_ || !ready_.empty(); });
+        if (ready_.empty()) return failed_ ? -1 : 0;
+        current_ = ready_.front();
+        ready_.pop_front();
+        offset_ = 0;
+    }
+    const int64_t n = std::min(capacity, current_->size - offset_);
+    std::memcpy(buffer, current_->data.data() + offset_, static_cast<size_t>(n));
+    offset_ += n;
+    return n;
+}
+
+namespace {
+
+constexpr int64_t kMinChunkBytes = 64;
+// 行扫描每段的最小字节数，行解析每块的最小行数
+constexpr int64_t kScanGrain = 1 << 16;
+constexpr int64_t kParseGrain = 1024;
+
+int64_t chunkCountFor(int64_t n, int64_t minGrain) {
+    if (detail::shouldRunSerial(n)) return 1;
+    return detail::planChunks(n, ThreadPool::instance().threadCount(), minGrain).chunks;
+}
+
+inline int64_t chunkBegin(int64_t n, int64_t chunks, int64_t chunk) {
+    return n * chunk / chunks;
+}
+
+void runChunks(int64_t chunks, const std::function<void(int64_t)>& task) {
+    if (chunks == 1) {
+        task(0);
+    } else {
+        ThreadPool::instance().run(chunks, task);
+    }
+}
+
+// 逐个字段回调 fn(column, begin, end, quoted)，最多 limit 个字段，返回回调的字段数
+template <typename Fn>
+int32_t tokenizeRow(const simd::Kernels& kernels, const char* p, int64_t start, int64_t end,
+                    char delimiter, char quote, int32_t limit, Fn&& fn) {
+    int32_t column = 0;
+    int64_t fieldStart = start;
+    bool inQuote = false;
+    bool quoted = false;
+    int64_t pos = start;
+    while (column < limit) {
+        pos += kernels.findStructural(p + pos, end - pos, delimiter, quote);
+        if (pos >= end) break;
+        if (p[pos] == quote) {
+            inQuote = !inQuote;
+            quoted = true;
+        } else if (p[pos] == delimiter && !inQuote) {
+            fn(column++, fieldStart, pos, quoted);
+            fieldStart = pos + 1;
+            quoted = false;
+        }
+        pos++;
+    }
+    if (column < limit) fn(column++, fieldStart, end, quoted);
+    return column;
+}
+
+// 字段文本：去掉引号（引号内两个连续引号表示一个引号）和首尾空白，需要改写时使用 scratch
+inline void fieldText(const char* p, int64_t begin, int64_t end, bool quoted, const CsvOptions& options,
+                      std::string& scratch, const char*& text, int64_t& length) {
+    text = p + begin;
+    length = end - begin;
+    if (quoted) {
+        scratch.clear();
+        bool inQuote = false;
+        for (int64_t i = begin; i < end; i++) {
+            const char c = p[i];
+            if (c != options.quote) {
+                scratch.push_back(c);
+            } else if (inQuote && i + 1 < end && p[i + 1] == options.quote) {
+                scratch.push_back(c);
+                i++;
+            } else {
+                inQuote = !inQuote;
+            }
+        }
+        text = scratch.data();
+        length = static_cast<int64_t>(scratch.size());
+    }
+    if (options.trim) {
+        while (length > 0 && isSpace(text[0])) {
+            text++;
+            length--;
+        }
+        while (length > 0 && isSpace(text[length - 1])) length--;
+    }
+}
+
+inline bool isNullValue(const std::vector<std::string>& nullValues, const char* text, int64_t length) {
+    for (const std::string& null : nullValues) {
+        if (static_cast<int64_t>(null.size()) == length && std::memcmp(null.data(), text, static_cast<size_t>(length)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 按类型解析一个非空值写入第 row 行，值放不下该类型时返回 false
+inline bool storeValue(CsvColumn& column, int64_t row, const char* text, int64_t length) {
+    const size_t r = static_cast<size_t>(row);
+    switch (column.type) {
+        case CsvType::EMPTY:
+            return false;
+        case CsvType::BOOL: {
+            int b = parseBool(text, length);
+            if (b < 0) return false;
+            column.ints[r] = b;
+            return true;
+        }
+        case CsvType::INT32:
+        case CsvType::INT64: {
+            int64_t value;
+            if (!parseCsvInt64(text, length, value)) return false;
+            if (column.type == CsvType::INT32 && (value < INT32_MIN || value > INT32_MAX)) return false;
+            column.ints[r] = value;
+            return true;
+        }
+        case CsvType::FLOAT64:
+            return parseCsvDouble(text, length, column.doubles[r]);
+        case CsvType::STRING:
+            return true;  // 字符串由调用方写入块内缓冲
+    }
+    return false;
+}
+
+void prepareColumn(CsvColumn& column, CsvType type, int64_t rows) {
+    const size_t n = static_cast<size_t>(rows);
+    column = CsvColumn();
+    column.type = type;
+    column.valid.assign(n, 1);
+    switch (type) {
+        case CsvType::BOOL:
+        case CsvType::INT32:
+        case CsvType::INT64:
+            column.ints.assign(n, 0);
+            break;
+        case CsvType::FLOAT64:
+            column.doubles.assign(n, 0.0);
+            break;
+        case CsvType::STRING:
+            column.offsets.assign(n + 1, 0);
+            break;
+        case CsvType::EMPTY:
+            break;
+    }
+}
+
+} // namespace
+
+CsvReader::CsvReader(std::unique_ptr<CsvSource> source, CsvOptions options)
+    : source_(std::move(source)), options_(std::move(options)) {
+    options_.chunkBytes = std::max(options_.chunkBytes, kMinChunkBytes);
+    options_.skipLines = std::max<int64_t>(options_.skipLines, 0);
+    options_.sampleRows = std::max<int64_t>(options_.sampleRows, 0);
+    buffer_.resize(static_cast<size_t>(options_.chunkBytes));
+}
+
+// 把未消费的数据移到缓冲起点，再读满缓冲
+bool CsvReader::fill() {
+    if (begin_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, static_cast<size_t>(end_ - begin_));
+        end_ -= begin_;
+        consumedEnd_ -= begin_;
+        begin_ = 0;
+    }
+    while (!eof_ && end_ < static_cast<int64_t>(buffer_.size())) {
+        int64_t n = source_->read(buffer_.data() + end_, static_cast<int64_t>(buffer_.size()) - end_);
+        if (n < 0) {
+            error_ = "读取CSV数据失败";
+            return false;
+        }
+        if (n == 0) eof_ = true;
+        end_ += n;
+    }
+    return true;
+}
+
+// 从 begin_ 开始扫描出完整的行
+// 缓冲分段并行：每段记录换行位置及其段内引号奇偶，再用各段引号数的前缀奇偶确定
+// 每个换行是否在引号外。begin_ 总在行首（引号外），所以第一段的初始状态已知
+bool CsvReader::scanRows() {
+    rowStart_.clear();
+    rowEnd_.clear();
+    rowCursor_ = 0;
+    const simd::Kernels& kernels = simd::active();
+    const char quote = options_.quote;
+
+    for (;;) {
+        begin_ = consumedEnd_;
+        if (!fill()) return false;
+        const char* p = buffer_.data();
+        const int64_t length = end_ - begin_;
+
+        const int64_t chunks = chunkCountFor(length, kScanGrain);
+        std::vector<std::vector<int64_t>> newlines(static_cast<size_t>(chunks));
+        std::vector<uint8_t> quoteParity(static_cast<size_t>(chunks), 0);
+        std::function<void(int64_t)> scanTask = [&](int64_t chunk) {
+            const int64_t lo = begin_ + chunkBegin(length, chunks, chunk);
+            const int64_t hi = begin_ + chunkBegin(length, chunks, chunk + 1);
+            std::vector<int64_t>& local = newlines[static_cast<size_t>(chunk)];
+            uint8_t parity = 0;
+            for (int64_t pos = lo; pos < hi; pos++) {
+                pos += kernels.findStructural(p + pos, hi - pos, quote, quote);
+                if (pos >= hi) break;
+                if (p[pos] == quote) {
+                    parity ^= 1;
+                } else {
+                    local.push_back(pos * 2 + parity);
+                }
+            }
+            quoteParity[static_cast<size_t>(chunk)] = parity;
+        };
+        runChunks(chunks, scanTask);
+
+        int64_t rowBegin = begin_;
+        uint8_t running = 0;
+        auto addRow = [&](int64_t start, int64_t stop) {
+            if (stop > start && p[stop - 1] == '\r') stop--;
+            if (stop > start) {
+                rowStart_.push_back(start);
+                rowEnd_.push_back(stop);
+            }
+        };
+        for (int64_t c = 0; c < chunks; c++) {
+            for (int64_t encoded : newlines[static_cast<size_t>(c)]) {
+                if (((encoded & 1) ^ running) != 0) continue;
+                const int64_t pos = encoded >> 1;
+                addRow(rowBegin, pos);
+                rowBegin = pos + 1;
+            }
+            running ^= quoteParity[static_cast<size_t>(c)];
+        }
+        const bool foundTerminator = rowBegin > begin_;
+        if (eof_) {
+            addRow(rowBegin, end_);
+            rowBegin = end_;
+        }
+        consumedEnd_ = rowBegin;
+        if (!rowStart_.empty()) return true;
+        if (eof_) return false;
+        // 缓冲内没有完整的行（行比缓冲长）：扩大缓冲后继续读
+        if (!foundTerminator) buffer_.resize(buffer_.size() * 2);
+    }
+}
+
+bool CsvReader::readHeader() {
+    headerDone_ = true;
+    if (!fill()) return false;
+    // 跳过 UTF-8 BOM
+    if (end_ - begin_ >= 3 && std::memcmp(buffer_.data() + begin_, "\xEF\xBB\xBF", 3) == 0) begin_ += 3;
+
+    // 跳过的行按物理行计算，不考虑引号
+    for (int64_t skipped = 0; skipped < options_.skipLines;) {
+        const char* start = buffer_.data() + begin_;
+        const void* nl = std::memchr(start, '\n', static_cast<size_t>(end_ - begin_));
+        if (nl != nullptr) {
+            begin_ += static_cast<const char*>(nl) - start + 1;
+            skipped++;
+            continue;
+        }
+        begin_ = end_;
+        if (eof_) break;
+        if (!fill()) return false;
+    }
+    consumedEnd_ = begin_;
+    if (!scanRows()) return error_.empty();
+
+    const simd::Kernels& kernels = simd::active();
+    const char* p = buffer_.data();
+    std::vector<std::pair<int64_t, int64_t>> fields;
+    std::vector<uint8_t> quotedFields;
+    tokenizeRow(kernels, p, rowStart_[0], rowEnd_[0], options_.delimiter, options_.quote, INT32_MAX,
+                [&](int32_t, int64_t b, int64_t e, bool quoted) {
+                    fields.emplace_back(b, e);
+                    quotedFields.push_back(quoted ? 1 : 0);
+                });
+    std::string scratch;
+    for (size_t c = 0; c < fields.size(); c++) {
+        if (options_.header) {
+            const char* text;
+            int64_t length;
+            fieldText(p, fields[c].first, fields[c].second, quotedFields[c] != 0, options_, scratch, text, length);
+            names_.emplace_back(text, static_cast<size_t>(length));
+        } else {
+            names_.push_back("col" + std::to_string(c));
+        }
+    }
+    if (options_.header) rowCursor_++;
+    schema_.assign(names_.size(), options_.inferTypes ? CsvType::EMPTY : CsvType::STRING);
+
+    if (options_.columns.empty()) {
+        for (int32_t c = 0; c < static_cast<int32_t>(names_.size()); c++) projection_.push_back(c);
+    } else {
+        for (const std::string& name : options_.columns) {
+            const auto it = std::find(names_.begin(), names_.end(), name);
+            if (it == names_.end()) {
+                error_ = "CSV中不存在列: " + name;
+                return false;
+            }
+            const int32_t c = static_cast<int32_t>(it - names_.begin());
+            if (std::find(projection_.begin(), projection_.end(), c) != projection_.end()) {
+                error_ = "重复选择的列: " + name;
+                return false;
+            }
+            projection_.push_back(c);
+        }
+    }
+    parsed_ = projection_;
+    std::sort(parsed_.begin(), parsed_.end());
+    for (int32_t c : projection_) {
+        outputNames_.push_back(names_[static_cast<size_t>(c)]);
+        outputSchema_.push_back(schema_[static_cast<size_t>(c)]);
+    }
+    return true;
+}
+
+const std::vector<std::string>& CsvReader::columnNames() {
+    if (!headerDone_) readHeader();
+    return outputNames_;
+}
+
+bool CsvReader::next(CsvBatch& batch, int64_t maxRows) {
+    batch.rows = 0;
+    batch.columns.clear();
+    if (!headerDone_ && !readHeader()) return false;
+    if (!error_.empty() || projection_.empty() || maxRows <= 0) return false;
+    if (rowCursor_ >= static_cast<int64_t>(rowStart_.size()) && !scanRows()) return false;
+
+    const int64_t available = static_cast<int64_t>(rowStart_.size()) - rowCursor_;
+    const int64_t rows = std::min(available, maxRows);
+    parseBatch(rowCursor_, rows, batch);
+    rowCursor_ += rows;
+    return true;
+}
+
+// 解析 [firstRow, firstRow + rowCount) 行
+// 第一遍按当前类型解析所有列；有值放不下的列重新推断本批的类型后单独再解析一遍
+void CsvReader::parseBatch(int64_t firstRow, int64_t rowCount, CsvBatch& batch) {
+    const simd::Kernels& kernels = simd::active();
+    const char* p = buffer_.data();
+    const int64_t* starts = rowStart_.data() + firstRow;
+    const int64_t* ends = rowEnd_.data() + firstRow;
+    const int32_t columnCount = static_cast<int32_t>(names_.size());
+    const int64_t chunks = chunkCountFor(rowCount, kParseGrain);
+
+    // 对 columns 中的列逐行推断类型，结果与 schema_ 合并
+    auto inferTypes = [&](const std::vector<int32_t>& columns, int64_t rows) {
+        const int32_t limit = columns.back() + 1;
+        std::vector<int32_t> slot(static_cast<size_t>(columnCount), -1);
+        for (size_t s = 0; s < columns.size(); s++) slot[static_cast<size_t>(columns[s])] = static_cast<int32_t>(s);
+        const int64_t inferChunks = chunkCountFor(rows, kParseGrain);
+        std::vector<CsvType> types(static_cast<size_t>(inferChunks) * columns.size(), CsvType::EMPTY);
+        std::function<void(int64_t)> inferTask = [&](int64_t chunk) {
+            CsvType* local = types.data() + static_cast<size_t>(chunk) * columns.size();
+            std::string scratch;
+            auto visit = [&](int32_t c, int64_t b, int64_t e, bool quoted) {
+                const int32_t s = slot[static_cast<size_t>(c)];
+                if (s < 0 || local[s] == CsvType::STRING) return;
+                const char* text;
+                int64_t length;
+                fieldText(p, b, e, quoted, options_, scratch, text, length);
+                if (isNullValue(options_.nullValues, text, length)) return;
+                local[s] = joinCsvTypes(local[s], classifyCsvValue(text, length));
+            };
+            for (int64_t r = chunkBegin(rows, inferChunks, chunk); r < chunkBegin(rows, inferChunks, chunk + 1); r++) {
+                int32_t got = tokenizeRow(kernels, p, starts[r], ends[r], options_.delimiter, options_.quote, limit, visit);
+                for (int32_t c = got; c < limit; c++) visit(c, ends[r], ends[r], false);
+            }
+        };
+        runChunks(inferChunks, inferTask);
+        for (size_t s = 0; s < columns.size(); s++) {
+            CsvType& type = schema_[static_cast<size_t>(columns[s])];
+            for (int64_t c = 0; c < inferChunks; c++) type = joinCsvTypes(type, types[static_cast<size_t>(c) * columns.size() + s]);
+        }
+    };
+
+    // 按 schema_ 解析 columns 中的列，返回值放不下当前类型的列
+    auto parseColumns = [&](const std::vector<int32_t>& columns) {
+        const int32_t limit = columns.back() + 1;
+        const size_t S = columns.size();
+        std::vector<int32_t> slot(static_cast<size_t>(columnCount), -1);
+        for (size_t s = 0; s < S; s++) {
+            const int32_t c = columns[s];
+            slot[static_cast<size_t>(c)] = static_cast<int32_t>(s);
+            prepareColumn(batch.columns[static_cast<size_t>(c)], schema_[static_cast<size_t>(c)], rowCount);
+        }
+        std::vector<uint8_t> failed(static_cast<size_t>(chunks) * S, 0);
+        // 字符串先写入块内缓冲，解析完成后按块顺序拼接
+        std::vector<std::string> chars(static_cast<size_t>(chunks) * S);
+        std::function<void(int64_t)> parseTask = [&](int64_t chunk) {
+            uint8_t* localFailed = failed.data() + static_cast<size_t>(chunk) * S;
+            std::string* localChars = chars.data() + static_cast<size_t>(chunk) * S;
+            std::string scratch;
+            int64_t row = 0;
+            auto visit = [&](int32_t c, int64_t b, int64_t e, bool quoted) {
+                const int32_t s = slot[static_cast<size_t>(c)];
+                if (s < 0 || localFailed[s]) return;
+                CsvColumn& column = batch.columns[static_cast<size_t>(c)];
+                const char* text;
+                int64_t length;
+                fieldText(p, b, e, quoted, options_, scratch, text, length);
+                if (isNullValue(options_.nullValues, text, length)) {
+                    column.valid[static_cast<size_t>(row)] = 0;
+                    return;
+                }
+                if (column.type == CsvType::STRING) {
+                    localChars[s].append(text, static_cast<size_t>(length));
+                    column.offsets[static_cast<size_t>(row) + 1] = length;
+                } else if (!storeValue(column, row, text, length)) {
+                    localFailed[s] = 1;
+                }
+            };
+            for (row = chunkBegin(rowCount, chunks, chunk); row < chunkBegin(rowCount, chunks, chunk + 1); row++) {
+                int32_t got = tokenizeRow(kernels, p, starts[row], ends[row], options_.delimiter, options_.quote, limit, visit);
+                for (int32_t c = got; c < limit; c++) visit(c, ends[row], ends[row], false);
+            }
+        };
+        runChunks(chunks, parseTask);
+
+        std::vector<int32_t> widen;
+        for (size_t s = 0; s < S; s++) {
+            CsvColumn& column = batch.columns[static_cast<size_t>(columns[s])];
+            bool anyFailed = false;
+            for (int64_t c = 0; c < chunks; c++) anyFailed = anyFailed || failed[static_cast<size_t>(c) * S + s] != 0;
+            if (anyFailed) {
+                widen.push_back(columns[s]);
+                continue;
+            }
+            if (column.type == CsvType::STRING) {
+                // offsets[i + 1] 暂存第 i 行长度，前缀和得到偏移
+                for (int64_t r = 0; r < rowCount; r++) column.offsets[static_cast<size_t>(r) + 1] += column.offsets[static_cast<size_t>(r)];
+                column.chars.reserve(static_cast<size_t>(column.offsets.back()));
+                for (int64_t c = 0; c < chunks; c++) column.chars += chars[static_cast<size_t>(c) * S + s];
+            }
+            column.nullCount = static_cast<int64_t>(std::count(column.valid.begin(), column.valid.end(), 0));
+        }
+        return widen;
+    };
+
+    batch.rows = rowCount;
+    batch.columns.assign(static_cast<size_t>(columnCount), CsvColumn());
+
+    if (!sampled_) {
+        sampled_ = true;
+        if (options_.inferTypes) inferTypes(parsed_, std::min(rowCount, options_.sampleRows));
+    }
+    std::vector<int32_t> widen = parseColumns(parsed_);
+    if (!widen.empty()) {
+        // 提升后的类型能容纳本批所有值，第二遍不会再失败
+        inferTypes(widen, rowCount);
+        parseColumns(widen);
+    }
+
+    // 按输出顺序取出需要的列，未选择的列没有解析，保持为空
+    std::vector<CsvColumn> output(projection_.size());
+    for (size_t o = 0; o < projection_.size(); o++) {
+        const size_t c = static_cast<size_t>(projection_[o]);
+        output[o] = std::move(batch.columns[c]);
+        outputSchema_[o] = schema_[c];
+    }
+    batch.columns.swap(output);
+    if (options_.dictionaryEncode) encodeDictionaries(batch);
+}
+
+// 各 STRING 列的字符串编码进该列的字典；列之间互不相关，按列并行
+void CsvReader::encodeDictionaries(CsvBatch& batch) {
+    if (dictionaries_.size() != batch.columns.size()) dictionaries_.resize(batch.columns.size());
+    std::vector<size_t> targets;
+    for (size_t o = 0; o < batch.columns.size(); o++) {
+        if (batch.columns[o].type != CsvType::STRING) continue;
+        if (!dictionaries_[o]) dictionaries_[o].reset(new StringDictionary());
+        targets.push_back(o);
+    }
+    if (targets.empty()) return;
+    const int64_t rows = batch.rows;
+    std::function<void(int64_t)> encodeTask = [&](int64_t t) {
+        CsvColumn& column = batch.columns[targets[static_cast<size_t>(t)]];
+        StringDictionary& dictionary = *dictionaries_[targets[static_cast<size_t>(t)]];
+        column.dictionary = &dictionary;
+        column.dictionaryBase = dictionary.size();
+        column.codes.resize(static_cast<size_t>(rows));
+        encodeStrings(column.chars.data(), column.offsets.data(), column.nullCount > 0 ? column.valid.data() : nullptr,
+                      rows, dictionary, column.codes.data());
+        std::string().swap(column.chars);
+        std::vector<int64_t>().swap(column.offsets);
+    };
+    if (targets.size() == 1 || detail::shouldRunSerial(rows)) {
+        for (size_t t = 0; t < targets.size(); t++) encodeTask(static_cast<int64_t>(t));
+    } else {
+        runChunks(static_cast<int64_t>(targets.size()), encodeTask);
+    }
+}
+
+const StringDictionary* CsvReader::dictionary(int32_t column) const {
+    if (column < 0 || static_cast<size_t>(column) >= dictionaries_.size()) return nullptr;
+    return dictionaries_[static_cast<size_t>(column)].get();
+}
+
+} // namespace andas
@@ -0,0 +1,208 @@
+#ifndef ANDAS_CSV_READER_H
+#define ANDAS_CSV_READER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "string_dictionary.h"
+
+namespace andas {
+
+// 流式 CSV 读取器（不依赖JNI）
+// - 从文件描述符或内存按固定大小的块读取，内存占用只与块大小有关，与文件大小无关
+// - 行边界用 SIMD 扫描引号和换行，块内分段并行统计引号奇偶，引号内的换行不会切断行
+// - 字段直接解析进按列存放的定长缓冲，数值用快速路径解析，不经过字符串对象
+// - 类型先用前 sampleRows 行推断，之后遇到放不下的值时整列提升，提升只会变宽
+//
+// 语法与原 Kotlin 解析器保持一致：
+// - 引号内的分隔符和换行属于字段内容，引号内连续两个引号表示一个引号字符
+// - 行尾的 \r 会被去掉，空行跳过；字段数不足时补空字段，多出的字段忽略
+// - trim 只去掉 ASCII 空白；空值判断在去引号和 trim 之后进行
+
+// 列类型，按提升顺序排列，与 Kotlin 侧 CsvColumnType.code 保持一致
+enum class CsvType : int32_t {
+    EMPTY = 0,    // 目前只见过空值
+    BOOL = 1,     // true/false/yes/no，不区分大小写
+    INT32 = 2,    // -?\d+ 且在 int32 范围内
+    INT64 = 3,
+    FLOAT64 = 4,  // -?\d+(\.\d+)?([eE][+-]?\d+)?，超出 int64 的整数也归为此类
+    STRING = 5,
+};
+
+// 类型格上的合并：EMPTY 是单位元，数值类型取较宽者，BOOL 与数值合并为 STRING
+CsvType joinCsvTypes(CsvType a, CsvType b);
+
+// 单个值的最窄类型，text 已去引号和 trim，空值判断由调用方完成
+CsvType classifyCsvValue(const char* text, int64_t length);
+
+// 按 classifyCsvValue 的语法解析，不符合语法或溢出时返回 false
+bool parseCsvInt64(const char* text, int64_t length, int64_t& out);
+bool parseCsvDouble(const char* text, int64_t length, double& out);
+
+struct CsvOptions {
+    char delimiter = ',';
+    char quote = '"';
+    bool header = true;
+    int64_t skipLines = 0;       // 在表头之前跳过的物理行数
+    bool trim = true;
+    bool inferTypes = true;      // false 时所有列按字符串读取
+    std::vector<std::string> nullValues = {"", "null", "NULL", "NA", "N/A"};
+    int64_t sampleRows = 1000;   // 首批数据中用于预先推断类型的行数
+    int64_t chunkBytes = 4 << 20;
+    // 只读取这些列（按列名），按给出的顺序输出；为空时读取全部列
+    // 其余列只切分不解析，且只切分到所需的最后一列为止
+    std::vector<std::string> columns;
+    // STRING 列在解析时做字典编码：每个输出列一个字典，在整个读取过程中累积，各批的编号一致
+    bool dictionaryEncode = false;
+};
+
+// 字节输入源，read 返回读到的字节数，0 表示结束，小于 0 表示读取失败
+class CsvSource {
+public:
+    virtual ~CsvSource() = default;
+    virtual int64_t read(char* buffer, int64_t capacity) = 0;
+};
+
+// 从文件描述符读取，owned 为 true 时析构时关闭
+class FdCsvSource : public CsvSource {
+public:
+    FdCsvSource(int fd, bool owned);
+    ~FdCsvSource() override;
+    int64_t read(char* buffer, int64_t capacity) override;
+
+private:
+    int fd_;
+    bool owned_;
+};
+
+// 从调用方持有的内存读取，不拷贝数据
+class MemoryCsvSource : public CsvSource {
+public:
+    MemoryCsvSource(const char* data, int64_t size);
+    int64_t read(char* buffer, int64_t capacity) override;
+
+private:
+    const char* data_;
+    int64_t size_;
+    int64_t position_ = 0;
+};
+
+// 预读：后台线程从 inner 读入 depth 个 blockBytes 大小的块，read 从已读好的块中复制，
+// 磁盘读取与调用方的解析重叠进行
+// - 块在空闲、就绪两个队列之间循环使用，不再分配；就绪的块用完前后台线程阻塞（背压）
+// - inner 只在后台线程中使用，不能是绑定调用线程的源（如通过 JNI 回调的 InputStream）
+// - inner 读取失败时，之前读好的数据照常返回，之后 read 返回 -1
+class PrefetchCsvSource : public CsvSource {
+public:
+    PrefetchCsvSource(std::unique_ptr<CsvSource> inner, int64_t blockBytes, int32_t depth);
+    ~PrefetchCsvSource() override;
+    int64_t read(char* buffer, int64_t capacity) override;
+
+    PrefetchCsvSource(const PrefetchCsvSource&) = delete;
+    PrefetchCsvSource& operator=(const PrefetchCsvSource&) = delete;
+
+private:
+    struct Block {
+        std::vector<char> data;
+        int64_t size = 0;
+    };
+
+    void run();
+
+    std::unique_ptr<CsvSource> inner_;
+    std::vector<Block> blocks_;
+    std::deque<Block*> free_;
+    std::deque<Block*> ready_;
+    Block* current_ = nullptr;   // 调用方正在复制的块
+    int64_t offset_ = 0;
+    bool done_ = false;          // 后台线程已结束：输入读完、失败或被停止
+    bool failed_ = false;
+    bool stopping_ = false;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+// 一批行中的一列
+// - valid 每行一个字节，0 表示空值；空值位置的数值为 0，字符串为空串
+// - BOOL/INT32/INT64 存在 ints，FLOAT64 存在 doubles
+// - STRING 存在 chars 中，第 i 行为 [offsets[i], offsets[i+1])；EMPTY 列不存值
+// - 字典编码的 STRING 列（dictionary 非空）不保留 chars/offsets，codes 为每行的编号，空值为 -1；
+//   本批新加入字典的条目为 [dictionaryBase, dictionary->size())
+struct CsvColumn {
+    CsvType type = CsvType::EMPTY;
+    std::vector<uint8_t> valid;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<int64_t> offsets;
+    std::string chars;
+    std::vector<int32_t> codes;
+    const StringDictionary* dictionary = nullptr;
+    int32_t dictionaryBase = 0;
+    int64_t nullCount = 0;
+};
+
+struct CsvBatch {
+    int64_t rows = 0;
+    std::vector<CsvColumn> columns;
+};
+
+class CsvReader {
+public:
+    CsvReader(std::unique_ptr<CsvSource> source, CsvOptions options);
+
+    // 输出的列名，首次调用时读取表头；header 为 false 时按第一行的字段数生成 col0, col1...
+    // 指定了 CsvOptions::columns 时只包含这些列，不存在的列名使 error() 非空
+    const std::vector<std::string>& columnNames();
+
+    // 读取下一批，最多 maxRows 行；没有更多数据或出错时返回 false
+    // 批内每列的类型不窄于之前所有批次的类型，较早批次的类型可能比后来的窄
+    bool next(CsvBatch& batch, int64_t maxRows = INT64_MAX);
+
+    // 截至目前各输出列的类型
+    const std::vector<CsvType>& schema() const { return outputSchema_; }
+
+    // 第 column 个输出列的字典，未开启字典编码或该列还没有出现过 STRING 批次时为 nullptr
+    const StringDictionary* dictionary(int32_t column) const;
+
+    // 读取失败时的错误信息，成功时为空
+    const std::string& error() const { return error_; }
+
+private:
+    bool fill();
+    bool scanRows();
+    bool readHeader();
+    void parseBatch(int64_t firstRow, int64_t rowCount, CsvBatch& batch);
+    void encodeDictionaries(CsvBatch& batch);
+
+    std::unique_ptr<CsvSource> source_;
+    CsvOptions options_;
+    std::vector<char> buffer_;
+    int64_t begin_ = 0;          // 未消费数据的起点，总是位于行首
+    int64_t end_ = 0;
+    bool eof_ = false;
+    bool headerDone_ = false;
+    bool sampled_ = false;
+    // 最近一次扫描得到的行区间 [rowStart_[i], rowEnd_[i])，不含换行符
+    std::vector<int64_t> rowStart_;
+    std::vector<int64_t> rowEnd_;
+    int64_t rowCursor_ = 0;
+    int64_t consumedEnd_ = 0;    // 已扫描行之后的位置
+    std::vector<std::string> names_;     // 文件中的所有列
+    std::vector<CsvType> schema_;
+    std::vector<int32_t> projection_;    // 各输出列在文件中的下标
+    std::vector<int32_t> parsed_;        // projection_ 升序排列，即需要解析的列
+    std::vector<std::string> outputNames_;
+    std::vector<CsvType> outputSchema_;
+    std::vector<std::unique_ptr<StringDictionary>> dictionaries_;   // 按输出列
+    std::string error_;
+};
+
+} // namespace andas
+
+#endif //ANDAS_CSV_READER_H
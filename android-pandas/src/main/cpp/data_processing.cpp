@@ -3,93 +3,153 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
-#include <unordered_map>
 #include <string>
-#include <omp.h>
+#include <limits>
+#include <cstring>
+#include <functional>
+#include "thread_pool.h"
+#include "groupby_engine.h"
+#include "join_engine.h"
+#include "sort_engine.h"
+#include "filter_engine.h"
+#include "moments.h"
+#include "sketches.h"
+#include "sampling.h"
+#include "corr_engine.h"
+#include "dedup_engine.h"
+#include "index_engine.h"
+#include "spill_engine.h"
+#include "memory_pool.h"
+#include "jni_utils.h"
 
 #define LOG_TAG "AndasData"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#include "double_harsh.h"
 // 数据处理 优化实现
 
+namespace {
+
+// 按块收集满足 keep(i) 的元素 value(i)，输出顺序与输入一致：先并行统计每块的个数，按前缀和得到
+// 每块的写入位置后再并行写入，不需要每块的临时数组；结果在当前线程的临时分配区中，只在 sink(data, count) 内有效
+template <typename T, typename Keep, typename Value, typename Sink>
+void collectOrdered(int64_t length, Keep&& keep, Value&& value, Sink&& sink) {
+    const bool serial = andas::detail::shouldRunSerial(length);
+    andas::ThreadPool& pool = andas::ThreadPool::instance();
+    const andas::detail::ChunkPlan plan = serial ? andas::detail::ChunkPlan{length, 1}
+                                                 : andas::detail::planChunks(length, pool.threadCount(), 4096);
+    auto forEachChunk = [&](const std::function<void(int64_t)>& task) {
+        if (serial) {
+            task(0);
+        } else {
+            pool.run(plan.chunks, task);
+        }
+    };
+
+    andas::ScratchBuffer<int64_t> offsets(plan.chunks + 1);
+    offsets[0] = 0;
+    forEachChunk([&](int64_t chunk) {
+        const int64_t lo = chunk * plan.grain;
+        const int64_t hi = std::min(length, lo + plan.grain);
+        int64_t count = 0;
+        for (int64_t i = lo; i < hi; i++) {
+            if (keep(i)) count++;
+        }
+        offsets[chunk + 1] = count;
+    });
+    for (int64_t c = 0; c < plan.chunks; c++) offsets[c + 1] += offsets[c];
+
+    andas::ScratchBuffer<T> out(offsets[plan.chunks]);
+    forEachChunk([&](int64_t chunk) {
+        const int64_t lo = chunk * plan.grain;
+        const int64_t hi = std::min(length, lo + plan.grain);
+        int64_t pos = offsets[chunk];
+        for (int64_t i = lo; i < hi; i++) {
+            if (keep(i)) out[pos++] = value(i);
+        }
+    });
+    sink(out.data(), out.size());
+}
+
+// 空值的行号，在 sink(indices, count) 中使用
+template <typename Sink>
+void nullIndicesOf(const double* elements, int64_t length, Sink&& sink) {
+    collectOrdered<int>(length,
+        [&](int64_t i) { return std::isnan(elements[i]); },
+        [](int64_t i) { return static_cast<int>(i); },
+        sink);
+}
+
+void fillNull(const double* elements, double value, double* resultElements, int64_t length) {
+    andas::parallel_for(0, length, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) {
+            resultElements[i] = std::isnan(elements[i]) ? value : elements[i];
+        }
+    });
+}
+
+// 稳定排序，NaN 无论升降序都排在最后
+void sortIndicesOf(const double* elements, int* indices, int64_t length, bool descending) {
+    andas::sortIndices(elements, length, descending, false, indices);
+}
+
+// 统计描述: [count, mean, std, min, max]，std 为样本标准差 (ddof=1)，与 Series.std() 一致
+void describeOf(const double* elements, int64_t length, double out[5]) {
+    const andas::MomentAccumulator m = andas::computeMoments(elements, length, andas::MomentOrder::VARIANCE);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    out[0] = static_cast<double>(m.count);
+    out[1] = m.count > 0 ? m.mean : nan;
+    out[2] = m.stddev(1);
+    out[3] = m.count > 0 ? m.min : nan;
+    out[4] = m.count > 0 ? m.max : nan;
+}
+
+} // namespace
+
 extern "C" JNIEXPORT jintArray JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeData_findNullIndices(
     JNIEnv* env,
     jobject /* this */,
     jdoubleArray array
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeData.findNullIndices");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
-    
-    std::vector<int> nullIndices;
+    jdouble* elements = andas::getArrayElements(env, array);
     
     // 并行查找空值索引
-    #pragma omp parallel
-    {
-        std::vector<int> local_nullIndices;
-        
-        #pragma omp for nowait
-        for (int i = 0; i < length; i++) {
-            if (std::isnan(elements[i])) {
-                local_nullIndices.push_back(i);
-            }
-        }
-        
-        #pragma omp critical
-        {
-            nullIndices.insert(nullIndices.end(), 
-                               local_nullIndices.begin(), 
-                               local_nullIndices.end());
-        }
-    }
-    
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
+    jintArray result = nullptr;
+    nullIndicesOf(elements, length, [&](const int* nullIndices, int64_t count) {
+        result = env->NewIntArray(count);
+        andas::setArrayRegion(env, result, 0, count, nullIndices);
+    });
     
-    jintArray result = env->NewIntArray(nullIndices.size());
-    env->SetIntArrayRegion(result, 0, nullIndices.size(), nullIndices.data());
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
     
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
 
 extern "C" JNIEXPORT jdoubleArray JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeData_dropNullValues(
     JNIEnv* env,
     jobject /* this */,
     jdoubleArray array
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeData.dropNullValues");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
-    
-    std::vector<double> nonNullValues;
-    nonNullValues.reserve(length);
+    jdouble* elements = andas::getArrayElements(env, array);
     
     // 并行查找非空值
-    #pragma omp parallel
-    {
-        std::vector<double> local_nonNullValues;
-        
-        #pragma omp for nowait
-        for (int i = 0; i < length; i++) {
-            if (!std::isnan(elements[i])) {
-                local_nonNullValues.push_back(elements[i]);
-            }
-        }
-        
-        #pragma omp critical
-        {
-            nonNullValues.insert(nonNullValues.end(), 
-                                 local_nonNullValues.begin(), 
-                                 local_nonNullValues.end());
-        }
-    }
-    
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
+    jdoubleArray result = nullptr;
+    collectOrdered<double>(length,
+        [&](int64_t i) { return !std::isnan(elements[i]); },
+        [&](int64_t i) { return elements[i]; },
+        [&](const double* nonNullValues, int64_t count) {
+            result = env->NewDoubleArray(count);
+            andas::setArrayRegion(env, result, 0, count, nonNullValues);
+        });
     
-    jdoubleArray result = env->NewDoubleArray(nonNullValues.size());
-    env->SetDoubleArrayRegion(result, 0, nonNullValues.size(), nonNullValues.data());
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
     
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
 
 extern "C" JNIEXPORT jdoubleArray JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeData_fillNullWithConstant(
@@ -97,65 +157,172 @@ Java_cn_ac_oac_libs_andas_core_NativeData_fillNullWithConstant(
     jobject /* this */,
     jdoubleArray array,
     jdouble value
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeData.fillNullWithConstant");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
+    jdouble* elements = andas::getArrayElements(env, array);
     
     jdoubleArray result = env->NewDoubleArray(length);
-    jdouble* resultElements = env->GetDoubleArrayElements(result, nullptr);
+    jdouble* resultElements = andas::getArrayElements(env, result, true);
     
-    #pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        resultElements[i] = std::isnan(elements[i]) ? value : elements[i];
-    }
+    fillNull(elements, value, resultElements, length);
     
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(result, resultElements, 0);
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+    andas::releaseArrayElements(env, result, resultElements, 0);
     
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
 
-// 分组聚合优化
+// 分组聚合优化（旧接口，保留兼容）：分组编号作为键，结果装箱为 HashMap<String, Double>
 extern "C" JNIEXPORT jobject JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeData_groupBySum(
     JNIEnv* env,
     jobject /* this */,
     jdoubleArray values,
     jintArray groups
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeData.groupBySum");
     jsize length = env->GetArrayLength(values);
-    jdouble* valueElements = env->GetDoubleArrayElements(values, nullptr);
-    jint* groupElements = env->GetIntArrayElements(groups, nullptr);
-    
-    // 使用哈希表存储分组结果
-    std::unordered_map<int, double> groupSums;
-    
-    for (int i = 0; i < length; i++) {
-        int group = groupElements[i];
-        groupSums[group] += valueElements[i];
+    if (env->GetArrayLength(groups) != length) {
+        andas::throwIllegalArgument(env, "分组列与数值列长度不一致");
+        return nullptr;
     }
+    jdouble* valueElements = andas::getArrayElements(env, values);
+    jint* groupElements = andas::getArrayElements(env, groups);
+    
+    std::vector<int64_t> keys(groupElements, groupElements + length);
+    const int64_t* keyColumns[] = {keys.data()};
+    const double* valueColumns[] = {valueElements};
+    const andas::AggSpec spec = {0, andas::AggOp::SUM};
+    andas::GroupByOutput output = andas::groupByAggregate(keyColumns, 1, valueColumns, 1, &spec, 1, length);
     
-    env->ReleaseDoubleArrayElements(values, valueElements, JNI_ABORT);
-    env->ReleaseIntArrayElements(groups, groupElements, JNI_ABORT);
+    andas::releaseArrayElements(env, values, valueElements, JNI_ABORT);
+    andas::releaseArrayElements(env, groups, groupElements, JNI_ABORT);
     
-    // 创建返回结果
+    // 创建返回结果，类和方法只查找一次
     jclass mapClass = env->FindClass("java/util/HashMap");
-    jmethodID mapConstructor = env->GetMethodID(mapClass, "<init>", "()V");
+    jmethodID mapConstructor = env->GetMethodID(mapClass, "<init>", "(I)V");
     jmethodID putMethod = env->GetMethodID(mapClass, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+    jclass doubleClass = env->FindClass("java/lang/Double");
+    jmethodID valueOf = env->GetStaticMethodID(doubleClass, "valueOf", "(D)Ljava/lang/Double;");
     
-    jobject result = env->NewObject(mapClass, mapConstructor);
+    jobject result = env->NewObject(mapClass, mapConstructor, static_cast<jint>(output.groupCount * 2));
     
-    for (const auto& pair : groupSums) {
-        jstring key = env->NewStringUTF(std::to_string(pair.first).c_str());
-        jdouble value = pair.second;
-        jobject valueObj = env->NewObject(env->FindClass("java/lang/Double"), 
-                                         env->GetMethodID(env->FindClass("java/lang/Double"), "<init>", "(D)V"), 
-                                         value);
+    for (int64_t g = 0; g < output.groupCount; g++) {
+        jstring key = env->NewStringUTF(std::to_string(output.keys[0][g]).c_str());
+        jobject valueObj = env->CallStaticObjectMethod(doubleClass, valueOf, output.aggregates[0][g]);
         env->CallObjectMethod(result, putMethod, key, valueObj);
+        env->DeleteLocalRef(key);
+        env->DeleteLocalRef(valueObj);
     }
     
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 通用哈希分组聚合
+// keys: 分组键列（int64，Long.MIN_VALUE 表示缺失），values: 值列（NaN 表示缺失）
+// columns/ops: 每个聚合请求的值列下标和聚合类型
+// 返回 Object[]: [键列0, ..., 键列k-1, 每组行数 long[], 聚合结果0 double[], ...]
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_groupByAggregateArrays(
+    JNIEnv* env,
+    jobject /* this */,
+    jobjectArray keys,
+    jobjectArray values,
+    jintArray columns,
+    jintArray ops
+) try {
+    ANDAS_JNI_SCOPE("NativeData.groupByAggregateArrays");
+    const jsize keyCount = env->GetArrayLength(keys);
+    const jsize valueCount = env->GetArrayLength(values);
+    const jsize specCount = env->GetArrayLength(columns);
+    if (keyCount == 0) {
+        andas::throwIllegalArgument(env, "至少需要一个分组键列");
+        return nullptr;
+    }
+    if (env->GetArrayLength(ops) != specCount) {
+        andas::throwIllegalArgument(env, "聚合列与聚合类型数量不一致");
+        return nullptr;
+    }
+    
+    std::vector<jint> columnElements(specCount);
+    std::vector<jint> opElements(specCount);
+    andas::getArrayRegion(env, columns, 0, specCount, columnElements.data());
+    andas::getArrayRegion(env, ops, 0, specCount, opElements.data());
+    std::vector<andas::AggSpec> specs(specCount);
+    for (jsize s = 0; s < specCount; s++) {
+        if (columnElements[s] < 0 || columnElements[s] >= valueCount) {
+            andas::throwIllegalArgument(env, "聚合列下标越界");
+            return nullptr;
+        }
+        if (!andas::isValidAggOp(opElements[s])) {
+            andas::throwIllegalArgument(env, "不支持的聚合操作");
+            return nullptr;
+        }
+        specs[s] = {columnElements[s], static_cast<andas::AggOp>(opElements[s])};
+    }
+    
+    // 所有列长度必须一致
+    std::vector<jlongArray> keyArrays(keyCount);
+    std::vector<jdoubleArray> valueArrays(valueCount);
+    jsize length = -1;
+    bool consistent = true;
+    for (jsize c = 0; c < keyCount; c++) {
+        keyArrays[c] = static_cast<jlongArray>(env->GetObjectArrayElement(keys, c));
+        jsize len = keyArrays[c] == nullptr ? -1 : env->GetArrayLength(keyArrays[c]);
+        if (length < 0) length = len;
+        consistent &= (len >= 0 && len == length);
+    }
+    for (jsize c = 0; c < valueCount; c++) {
+        valueArrays[c] = static_cast<jdoubleArray>(env->GetObjectArrayElement(values, c));
+        jsize len = valueArrays[c] == nullptr ? -1 : env->GetArrayLength(valueArrays[c]);
+        consistent &= (len >= 0 && len == length);
+    }
+    if (!consistent) {
+        andas::throwIllegalArgument(env, "分组键列与值列长度不一致");
+        return nullptr;
+    }
+    
+    std::vector<jlong*> keyElements(keyCount);
+    std::vector<jdouble*> valueElements(valueCount);
+    for (jsize c = 0; c < keyCount; c++) keyElements[c] = andas::getArrayElements(env, keyArrays[c]);
+    for (jsize c = 0; c < valueCount; c++) valueElements[c] = andas::getArrayElements(env, valueArrays[c]);
+    
+    static_assert(sizeof(jlong) == sizeof(int64_t), "jlong 必须为 64 位");
+    std::vector<const int64_t*> keyColumns(keyCount);
+    std::vector<const double*> valueColumns(valueCount);
+    for (jsize c = 0; c < keyCount; c++) keyColumns[c] = reinterpret_cast<const int64_t*>(keyElements[c]);
+    for (jsize c = 0; c < valueCount; c++) valueColumns[c] = valueElements[c];
+    
+    andas::GroupByOutput output = andas::groupByAggregate(
+        keyColumns.data(), keyCount, valueColumns.data(), valueCount, specs.data(), specCount, length);
+    
+    for (jsize c = 0; c < keyCount; c++) andas::releaseArrayElements(env, keyArrays[c], keyElements[c], JNI_ABORT);
+    for (jsize c = 0; c < valueCount; c++) andas::releaseArrayElements(env, valueArrays[c], valueElements[c], JNI_ABORT);
+    
+    const jsize groups = static_cast<jsize>(output.groupCount);
+    jclass objectClass = env->FindClass("java/lang/Object");
+    jobjectArray result = env->NewObjectArray(keyCount + 1 + specCount, objectClass, nullptr);
+    jsize slot = 0;
+    for (jsize c = 0; c < keyCount; c++) {
+        jlongArray keyArray = env->NewLongArray(groups);
+        andas::setArrayRegion(env, keyArray, 0, groups, reinterpret_cast<const jlong*>(output.keys[c].data()));
+        env->SetObjectArrayElement(result, slot++, keyArray);
+        env->DeleteLocalRef(keyArray);
+    }
+    jlongArray sizeArray = env->NewLongArray(groups);
+    andas::setArrayRegion(env, sizeArray, 0, groups, reinterpret_cast<const jlong*>(output.sizes.data()));
+    env->SetObjectArrayElement(result, slot++, sizeArray);
+    env->DeleteLocalRef(sizeArray);
+    for (jsize s = 0; s < specCount; s++) {
+        jdoubleArray aggArray = env->NewDoubleArray(groups);
+        andas::setArrayRegion(env, aggArray, 0, groups, output.aggregates[s].data());
+        env->SetObjectArrayElement(result, slot++, aggArray);
+        env->DeleteLocalRef(aggArray);
+    }
+    
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
 
 // 数据排序优化
 extern "C" JNIEXPORT jintArray JNICALL
@@ -164,95 +331,275 @@ Java_cn_ac_oac_libs_andas_core_NativeData_sortIndices(
     jobject /* this */,
     jdoubleArray array,
     jboolean descending
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeData.sortIndices");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
+    jdouble* elements = andas::getArrayElements(env, array);
     
-    std::vector<int> indices(length);
-    #pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        indices[i] = i;
-    }
-    
-    if (descending) {
-        std::sort(indices.begin(), indices.end(),
-            [&](int a, int b) { return elements[a] > elements[b]; });
-    } else {
-        std::sort(indices.begin(), indices.end(),
-            [&](int a, int b) { return elements[a] < elements[b]; });
-    }
+    andas::ScratchBuffer<int> indices(length);
+    sortIndicesOf(elements, indices.data(), length, descending);
     
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
     
     jintArray result = env->NewIntArray(length);
-    env->SetIntArrayRegion(result, 0, length, indices.data());
+    andas::setArrayRegion(env, result, 0, length, indices.data());
     
     return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+namespace {
+
+// 固定一个排序键数组：double[] 或 long[]
+struct PinnedSortKey {
+    jarray array = nullptr;
+    void* elements = nullptr;
+    andas::SortKeyType type = andas::SortKeyType::FLOAT64;
+    jsize length = -1;
+};
+
+bool pinSortKey(JNIEnv* env, jobject array, PinnedSortKey& key) {
+    if (array == nullptr) return false;
+    jclass doubleArrayClass = env->FindClass("[D");
+    jclass longArrayClass = env->FindClass("[J");
+    static_assert(sizeof(jlong) == sizeof(int64_t), "jlong 必须为 64 位");
+    if (env->IsInstanceOf(array, doubleArrayClass)) {
+        key.array = static_cast<jarray>(array);
+        key.type = andas::SortKeyType::FLOAT64;
+        key.length = env->GetArrayLength(key.array);
+        key.elements = andas::getArrayElements(env, static_cast<jdoubleArray>(array));
+    } else if (env->IsInstanceOf(array, longArrayClass)) {
+        key.array = static_cast<jarray>(array);
+        key.type = andas::SortKeyType::INT64;
+        key.length = env->GetArrayLength(key.array);
+        key.elements = andas::getArrayElements(env, static_cast<jlongArray>(array));
+    }
+    env->DeleteLocalRef(doubleArrayClass);
+    env->DeleteLocalRef(longArrayClass);
+    return key.elements != nullptr;
+}
+
+void releaseSortKey(JNIEnv* env, PinnedSortKey& key) {
+    if (key.elements == nullptr) return;
+    if (key.type == andas::SortKeyType::FLOAT64) {
+        andas::releaseArrayElements(env, static_cast<jdoubleArray>(key.array), static_cast<jdouble*>(key.elements), JNI_ABORT);
+    } else {
+        andas::releaseArrayElements(env, static_cast<jlongArray>(key.array), static_cast<jlong*>(key.elements), JNI_ABORT);
+    }
+    key.elements = nullptr;
 }
 
+} // namespace
+
+// 多列稳定排序
+// keys: 每列为 double[]（NaN 为缺失值）或 long[]（Long.MIN_VALUE 为缺失值），长度必须一致
+// descending/nullsFirst: 每列的排序方向和缺失值位置
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_sortIndicesArrays(
+        JNIEnv* env,
+        jobject /* this */,
+        jobjectArray keys,
+        jbooleanArray descending,
+        jbooleanArray nullsFirst
+) try {
+    ANDAS_JNI_SCOPE("NativeData.sortIndicesArrays");
+    const jsize keyCount = env->GetArrayLength(keys);
+    if (keyCount == 0) {
+        andas::throwIllegalArgument(env, "至少需要一个排序键列");
+        return nullptr;
+    }
+    if (env->GetArrayLength(descending) != keyCount || env->GetArrayLength(nullsFirst) != keyCount) {
+        andas::throwIllegalArgument(env, "排序方向与排序键列数量不一致");
+        return nullptr;
+    }
+    std::vector<jboolean> descendingFlags(keyCount);
+    std::vector<jboolean> nullsFirstFlags(keyCount);
+    andas::getArrayRegion(env, descending, 0, keyCount, descendingFlags.data());
+    andas::getArrayRegion(env, nullsFirst, 0, keyCount, nullsFirstFlags.data());
+
+    std::vector<PinnedSortKey> pinned(keyCount);
+    jsize length = -1;
+    bool valid = true;
+    for (jsize c = 0; c < keyCount && valid; c++) {
+        jobject array = env->GetObjectArrayElement(keys, c);
+        valid = pinSortKey(env, array, pinned[c]);
+        if (valid) {
+            if (length < 0) length = pinned[c].length;
+            valid = pinned[c].length == length;
+        }
+    }
+    if (!valid) {
+        for (auto& key : pinned) releaseSortKey(env, key);
+        andas::throwIllegalArgument(env, "排序键列必须是长度一致的 DoubleArray 或 LongArray");
+        return nullptr;
+    }
+
+    std::vector<andas::SortKey> sortKeys(keyCount);
+    for (jsize c = 0; c < keyCount; c++) {
+        sortKeys[c] = {pinned[c].type, pinned[c].elements, descendingFlags[c] == JNI_TRUE, nullsFirstFlags[c] == JNI_TRUE};
+    }
+    andas::ScratchBuffer<int32_t> indices(length);
+    andas::sortIndices(sortKeys.data(), keyCount, length, indices.data());
+    for (auto& key : pinned) releaseSortKey(env, key);
+
+    jintArray result = env->NewIntArray(length);
+    andas::setArrayRegion(env, result, 0, length, indices.data());
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 部分排序：返回最大（largest）或最小的 k 个非缺失值的行号，按排序后的顺序，相等时行号小的在前
+// values: double[] 或 long[]，缺失值约定同 sortIndicesArrays
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_topKIndices(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject values,
+        jint k,
+        jboolean largest
+) try {
+    ANDAS_JNI_SCOPE("NativeData.topKIndices");
+    PinnedSortKey pinned;
+    if (!pinSortKey(env, values, pinned)) {
+        andas::throwIllegalArgument(env, "排序键列必须是 DoubleArray 或 LongArray");
+        return nullptr;
+    }
+    andas::SortKey key{pinned.type, pinned.elements, largest == JNI_TRUE, false};
+    std::vector<int32_t> rows = andas::topK(key, pinned.length, k);
+    releaseSortKey(env, pinned);
+
+    const jsize size = static_cast<jsize>(rows.size());
+    jintArray result = env->NewIntArray(size);
+    andas::setArrayRegion(env, result, 0, size, rows.data());
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+namespace {
+
+// 双精度键转为可精确比较的 int64：+0.0/-0.0 视为相同，所有 NaN 视为相同
+int64_t exactDoubleKey(double value) {
+    if (value == 0.0) value = 0.0;
+    if (std::isnan(value)) value = std::numeric_limits<double>::quiet_NaN();
+    int64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+} // namespace
+
 extern "C" JNIEXPORT jintArray JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeData_mergeIndices(
         JNIEnv* env,
         jobject /* this */,
         jdoubleArray left,
         jdoubleArray right
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeData.mergeIndices");
     jsize leftLength = env->GetArrayLength(left);
     jsize rightLength = env->GetArrayLength(right);
 
-    jdouble* leftElements = env->GetDoubleArrayElements(left, nullptr);
-    jdouble* rightElements = env->GetDoubleArrayElements(right, nullptr);
+    jdouble* leftElements = andas::getArrayElements(env, left);
+    jdouble* rightElements = andas::getArrayElements(env, right);
+
+    // 按精确相等匹配的内连接
+    andas::ScratchBuffer<int64_t> leftKeys(leftLength);
+    andas::ScratchBuffer<int64_t> rightKeys(rightLength);
+    andas::parallel_for(0, leftLength, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) leftKeys[i] = exactDoubleKey(leftElements[i]);
+    });
+    andas::parallel_for(0, rightLength, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) rightKeys[i] = exactDoubleKey(rightElements[i]);
+    });
 
-    // 使用自定义哈希和相等比较函数的哈希表
-    std::unordered_map<double, std::vector<int>, DoubleHash, DoubleEqual> rightValueMap;
+    andas::releaseArrayElements(env, left, leftElements, JNI_ABORT);
+    andas::releaseArrayElements(env, right, rightElements, JNI_ABORT);
 
-    // 构建右侧数组的值到索引列表的映射 - 并行化
-#pragma omp parallel for
-    for (int j = 0; j < rightLength; j++) {
-#pragma omp critical
-        {
-            rightValueMap[rightElements[j]].push_back(j);
+    const int64_t* leftColumns[] = {leftKeys.data()};
+    const int64_t* rightColumns[] = {rightKeys.data()};
+    andas::JoinOutput joined = andas::hashJoin(leftColumns, leftLength, rightColumns, rightLength, 1,
+                                               andas::JoinType::INNER);
+
+    // 成对输出：[leftIndex1, rightIndex1, leftIndex2, rightIndex2, ...]
+    const jsize pairs = static_cast<jsize>(joined.left.size());
+    jintArray result = env->NewIntArray(pairs * 2);
+    jint* resultElements = andas::getArrayElements(env, result, true);
+    andas::parallel_for(0, pairs, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) {
+            resultElements[2 * i] = joined.left[i];
+            resultElements[2 * i + 1] = joined.right[i];
         }
+    });
+    andas::releaseArrayElements(env, result, resultElements, 0);
+
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 通用哈希连接
+// leftKeys/rightKeys: 连接键列（int64，两侧使用相同的编码），type: JoinType 编码
+// 返回 int[][]: [左表行号, 右表行号]，-1 表示该侧没有对应行；semi/anti 的右表行号为空数组
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_joinIndicesArrays(
+        JNIEnv* env,
+        jobject /* this */,
+        jobjectArray leftKeys,
+        jobjectArray rightKeys,
+        jint type
+) try {
+    ANDAS_JNI_SCOPE("NativeData.joinIndicesArrays");
+    const jsize keyCount = env->GetArrayLength(leftKeys);
+    if (keyCount == 0 || env->GetArrayLength(rightKeys) != keyCount) {
+        andas::throwIllegalArgument(env, "左右两侧的连接键列数必须相同且至少为1");
+        return nullptr;
+    }
+    if (!andas::isValidJoinType(type)) {
+        andas::throwIllegalArgument(env, "不支持的连接类型");
+        return nullptr;
     }
 
-    // 预分配结果向量大小，减少内存重新分配
-    std::vector<int> mergedIndices;
-
-    // 并行处理左侧数组
-    #pragma omp parallel
-    {
-        std::vector<int> localMergedIndices;
-        localMergedIndices.reserve(leftLength); // 预估大小
-
-        #pragma omp for nowait
-        for (int i = 0; i < leftLength; i++) {
-            auto it = rightValueMap.find(leftElements[i]);
-            if (it != rightValueMap.end()) {
-                for (int rightIdx : it->second) {
-                    localMergedIndices.push_back(i);
-                    localMergedIndices.push_back(rightIdx);
-                }
-            }
+    std::vector<jlongArray> arrays(static_cast<size_t>(keyCount) * 2);
+    jsize lengths[2] = {-1, -1};
+    bool consistent = true;
+    for (int side = 0; side < 2; side++) {
+        jobjectArray keys = side == 0 ? leftKeys : rightKeys;
+        for (jsize c = 0; c < keyCount; c++) {
+            jlongArray array = static_cast<jlongArray>(env->GetObjectArrayElement(keys, c));
+            arrays[side * keyCount + c] = array;
+            jsize len = array == nullptr ? -1 : env->GetArrayLength(array);
+            if (lengths[side] < 0) lengths[side] = len;
+            consistent &= (len >= 0 && len == lengths[side]);
         }
+    }
+    if (!consistent) {
+        andas::throwIllegalArgument(env, "同一侧的连接键列长度不一致");
+        return nullptr;
+    }
 
-        // 合并本地结果到全局向量
-#pragma omp critical
-        {
-            mergedIndices.insert(mergedIndices.end(),
-                                 localMergedIndices.begin(),
-                                 localMergedIndices.end());
-        }
+    static_assert(sizeof(jlong) == sizeof(int64_t), "jlong 必须为 64 位");
+    std::vector<jlong*> elements(arrays.size());
+    std::vector<const int64_t*> columns(arrays.size());
+    for (size_t i = 0; i < arrays.size(); i++) {
+        elements[i] = andas::getArrayElements(env, arrays[i]);
+        columns[i] = reinterpret_cast<const int64_t*>(elements[i]);
     }
 
-    env->ReleaseDoubleArrayElements(left, leftElements, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(right, rightElements, JNI_ABORT);
+    andas::JoinOutput joined = andas::hashJoin(columns.data(), lengths[0], columns.data() + keyCount, lengths[1],
+                                               keyCount, static_cast<andas::JoinType>(type));
 
-    jintArray result = env->NewIntArray(mergedIndices.size());
-    env->SetIntArrayRegion(result, 0, mergedIndices.size(), mergedIndices.data());
+    for (size_t i = 0; i < arrays.size(); i++) {
+        andas::releaseArrayElements(env, arrays[i], elements[i], JNI_ABORT);
+    }
 
-    return result;
-}
+    jclass intArrayClass = env->FindClass("[I");
+    jobjectArray result = env->NewObjectArray(2, intArrayClass, nullptr);
+    const std::vector<int32_t>* sides[2] = {&joined.left, &joined.right};
+    for (int side = 0; side < 2; side++) {
+        const jsize size = static_cast<jsize>(sides[side]->size());
+        jintArray array = env->NewIntArray(size);
+        andas::setArrayRegion(env, array, 0, size, sides[side]->data());
+        env->SetObjectArrayElement(result, side, array);
+        env->DeleteLocalRef(array);
+    }
 
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
 
 
 // 布尔索引优化
@@ -261,40 +608,105 @@ Java_cn_ac_oac_libs_andas_core_NativeData_where(
     JNIEnv* env,
     jobject /* this */,
     jbooleanArray mask
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeData.where");
     jsize length = env->GetArrayLength(mask);
-    jboolean* maskElements = env->GetBooleanArrayElements(mask, nullptr);
-    
-    std::vector<int> indices;
-    indices.reserve(length);
+    jboolean* maskElements = andas::getArrayElements(env, mask);
     
     // 并行查找true值的索引
-    #pragma omp parallel
-    {
-        std::vector<int> local_indices;
-        
-        #pragma omp for nowait
-        for (int i = 0; i < length; i++) {
-            if (maskElements[i]) {
-                local_indices.push_back(i);
-            }
-        }
-        
-        #pragma omp critical
-        {
-            indices.insert(indices.end(), 
-                             local_indices.begin(), 
-                             local_indices.end());
-        }
-    }
-    
-    env->ReleaseBooleanArrayElements(mask, maskElements, JNI_ABORT);
+    jintArray result = nullptr;
+    collectOrdered<int>(length,
+        [&](int64_t i) { return maskElements[i] != JNI_FALSE; },
+        [](int64_t i) { return static_cast<int>(i); },
+        [&](const int* indices, int64_t count) {
+            result = env->NewIntArray(count);
+            andas::setArrayRegion(env, result, 0, count, indices);
+        });
     
-    jintArray result = env->NewIntArray(indices.size());
-    env->SetIntArrayRegion(result, 0, indices.size(), indices.data());
+    andas::releaseArrayElements(env, mask, maskElements, JNI_ABORT);
     
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 谓词筛选：按后缀指令序列求值选择位图，返回选中的行号（升序）
+// columns: 每列为 double[]（NaN 为缺失值）或 long[]（Long.MIN_VALUE 为缺失值），长度必须一致
+// program: 每条指令 4 个 int：op, column, arg, count，编码见 filter_engine.h
+// doubles/longs: 常量池，double 列读取 doubles，long 列读取 longs，两者长度相同
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_filterRowsArrays(
+        JNIEnv* env,
+        jobject /* this */,
+        jobjectArray columns,
+        jintArray program,
+        jdoubleArray doubles,
+        jlongArray longs
+) try {
+    ANDAS_JNI_SCOPE("NativeData.filterRowsArrays");
+    const jsize columnCount = env->GetArrayLength(columns);
+    const jsize programLength = env->GetArrayLength(program);
+    const jsize constantCount = env->GetArrayLength(doubles);
+    if (columnCount == 0 || programLength == 0 || programLength % 4 != 0) {
+        andas::throwIllegalArgument(env, "筛选条件为空或指令长度不是4的倍数");
+        return nullptr;
+    }
+    if (env->GetArrayLength(longs) != constantCount) {
+        andas::throwIllegalArgument(env, "筛选常量池长度不一致");
+        return nullptr;
+    }
+
+    std::vector<PinnedSortKey> pinned(columnCount);
+    jsize length = -1;
+    bool valid = true;
+    for (jsize c = 0; c < columnCount && valid; c++) {
+        jobject array = env->GetObjectArrayElement(columns, c);
+        valid = pinSortKey(env, array, pinned[c]);
+        if (valid) {
+            if (length < 0) length = pinned[c].length;
+            valid = pinned[c].length == length;
+        }
+    }
+    if (!valid) {
+        for (auto& column : pinned) releaseSortKey(env, column);
+        andas::throwIllegalArgument(env, "筛选列必须是长度一致的 DoubleArray 或 LongArray");
+        return nullptr;
+    }
+
+    std::vector<andas::FilterColumn> filterColumns(columnCount);
+    for (jsize c = 0; c < columnCount; c++) {
+        const auto type = pinned[c].type == andas::SortKeyType::FLOAT64
+                          ? andas::FilterColumnType::FLOAT64 : andas::FilterColumnType::INT64;
+        filterColumns[c] = {type, pinned[c].elements};
+    }
+    std::vector<jint> codes(programLength);
+    andas::getArrayRegion(env, program, 0, programLength, codes.data());
+    std::vector<andas::FilterInstruction> instructions(programLength / 4);
+    for (size_t i = 0; i < instructions.size(); i++) {
+        instructions[i] = {static_cast<andas::FilterOp>(codes[i * 4]), codes[i * 4 + 1], codes[i * 4 + 2], codes[i * 4 + 3]};
+    }
+    std::vector<double> doubleConstants(constantCount);
+    std::vector<int64_t> longConstants(constantCount);
+    andas::getArrayRegion(env, doubles, 0, constantCount, doubleConstants.data());
+    andas::getArrayRegion(env, longs, 0, constantCount, reinterpret_cast<jlong*>(longConstants.data()));
+
+    const andas::FilterProgram filter{filterColumns.data(), columnCount,
+                                      instructions.data(), static_cast<int32_t>(instructions.size()),
+                                      doubleConstants.data(), longConstants.data(), constantCount};
+    const char* error = andas::validateFilter(filter);
+    if (error != nullptr) {
+        for (auto& column : pinned) releaseSortKey(env, column);
+        andas::throwIllegalArgument(env, error);
+        return nullptr;
+    }
+    andas::ScratchBuffer<uint64_t> bits((length + 63) / 64);
+    andas::evaluateFilter(filter, length, bits.data());
+    for (auto& column : pinned) releaseSortKey(env, column);
+
+    std::vector<int32_t> rows = andas::selectedRows(bits.data(), length);
+    const jsize size = static_cast<jsize>(rows.size());
+    jintArray result = env->NewIntArray(size);
+    andas::setArrayRegion(env, result, 0, size, rows.data());
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
 
 // 数据统计优化
 extern "C" JNIEXPORT jdoubleArray JNICALL
@@ -302,110 +714,867 @@ Java_cn_ac_oac_libs_andas_core_NativeData_describe(
     JNIEnv* env,
     jobject /* this */,
     jdoubleArray array
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeData.describe");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
+    jdouble* elements = andas::getArrayElements(env, array);
     
     if (length == 0) {
         return env->NewDoubleArray(0);
     }
     
-    // 并行计算统计量
-    double sum = 0.0;
-    double min_val = std::numeric_limits<double>::max();
-    double max_val = std::numeric_limits<double>::lowest();
-    int count = 0;
-    
-    #pragma omp parallel
-    {
-        double local_sum = 0.0;
-        double local_min = std::numeric_limits<double>::max();
-        double local_max = std::numeric_limits<double>::lowest();
-        int local_count = 0;
-        
-        #pragma omp for nowait
-        for (int i = 0; i < length; i++) {
-            double val = elements[i];
-            if (!std::isnan(val)) {
-                local_sum += val;
-                local_count++;
-                if (val < local_min) local_min = val;
-                if (val > local_max) local_max = val;
-            }
-        }
-        
-        #pragma omp critical
-        {
-            sum += local_sum;
-            count += local_count;
-            if (local_min < min_val) min_val = local_min;
-            if (local_max > max_val) max_val = local_max;
-        }
-    }
+    jdouble resultElements[5];
+    describeOf(elements, length, resultElements);
     
-    double mean = count > 0 ? sum / count : 0.0;
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
     
-    // 并行计算方差
-    double variance = 0.0;
-    #pragma omp parallel for reduction(+:variance)
-    for (int i = 0; i < length; i++) {
-        double val = elements[i];
-        if (!std::isnan(val)) {
-            variance += (val - mean) * (val - mean);
-        }
+    // 返回: [count, mean, std, min, max]
+    jdoubleArray result = env->NewDoubleArray(5);
+    andas::setArrayRegion(env, result, 0, 5, resultElements);
+    
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// ==================== 随机采样 ====================
+
+namespace {
+
+jintArray toIntArray(JNIEnv* env, const std::vector<int32_t>& rows) {
+    const jsize size = static_cast<jsize>(rows.size());
+    jintArray result = env->NewIntArray(size);
+    andas::setArrayRegion(env, result, 0, size, rows.data());
+    return result;
+}
+
+} // namespace
+
+// 从 [0, n) 中不放回地取 k 个行号，按抽取顺序返回
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_sampleIndices(
+    JNIEnv* env,
+    jobject /* this */,
+    jint n,
+    jint k,
+    jlong seed
+) try {
+    ANDAS_JNI_SCOPE("NativeData.sampleIndices");
+    const std::vector<int64_t> picked = andas::sampleIndices(n, k, static_cast<uint64_t>(seed));
+    return toIntArray(env, std::vector<int32_t>(picked.begin(), picked.end()));
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 加权不放回采样，权重 <= 0 或 NaN 的行不会被选中
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_weightedSampleIndices(
+    JNIEnv* env,
+    jobject /* this */,
+    jdoubleArray weights,
+    jint k,
+    jlong seed
+) try {
+    ANDAS_JNI_SCOPE("NativeData.weightedSampleIndices");
+    const jsize length = env->GetArrayLength(weights);
+    jdouble* elements = andas::getArrayElements(env, weights);
+    const std::vector<int32_t> rows = andas::weightedSampleIndices(elements, length, k, static_cast<uint64_t>(seed));
+    andas::releaseArrayElements(env, weights, elements, JNI_ABORT);
+    return toIntArray(env, rows);
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 分层采样：keys 为分层键列（int64，Long.MIN_VALUE 表示缺失）
+// count >= 0 时每层取 count 行，否则按 fraction 取
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_stratifiedSampleIndices(
+    JNIEnv* env,
+    jobject /* this */,
+    jobjectArray keys,
+    jint count,
+    jdouble fraction,
+    jlong seed
+) try {
+    ANDAS_JNI_SCOPE("NativeData.stratifiedSampleIndices");
+    const jsize keyCount = env->GetArrayLength(keys);
+    if (keyCount == 0) {
+        andas::throwIllegalArgument(env, "至少需要一个分层键列");
+        return nullptr;
+    }
+    std::vector<jlongArray> keyArrays(keyCount);
+    jsize length = -1;
+    bool consistent = true;
+    for (jsize c = 0; c < keyCount; c++) {
+        keyArrays[c] = static_cast<jlongArray>(env->GetObjectArrayElement(keys, c));
+        jsize len = keyArrays[c] == nullptr ? -1 : env->GetArrayLength(keyArrays[c]);
+        if (length < 0) length = len;
+        consistent &= (len >= 0 && len == length);
+    }
+    if (!consistent) {
+        andas::throwIllegalArgument(env, "分层键列长度不一致");
+        return nullptr;
     }
-    variance = count > 1 ? variance / (count - 1) : 0.0;
-    double std = std::sqrt(variance);
+
+    static_assert(sizeof(jlong) == sizeof(int64_t), "jlong 必须为 64 位");
+    std::vector<jlong*> keyElements(keyCount);
+    std::vector<const int64_t*> keyColumns(keyCount);
+    for (jsize c = 0; c < keyCount; c++) {
+        keyElements[c] = andas::getArrayElements(env, keyArrays[c]);
+        keyColumns[c] = reinterpret_cast<const int64_t*>(keyElements[c]);
+    }
+    const std::vector<int32_t> rows = andas::stratifiedSampleIndices(
+        keyColumns.data(), keyCount, length, count, fraction, static_cast<uint64_t>(seed));
+    for (jsize c = 0; c < keyCount; c++) andas::releaseArrayElements(env, keyArrays[c], keyElements[c], JNI_ABORT);
+    return toIntArray(env, rows);
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// ==================== 原生列（DirectByteBuffer）版本 ====================
+
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_findNullIndicesColumn(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject buffer,
+    jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeData.findNullIndicesColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return nullptr;
     
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
+    jintArray result = nullptr;
+    nullIndicesOf(elements, length, [&](const int* nullIndices, int64_t count) {
+        result = env->NewIntArray(count);
+        andas::setArrayRegion(env, result, 0, count, nullIndices);
+    });
+    
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_fillNullColumn(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject buffer,
+    jobject out,
+    jint length,
+    jdouble value
+) try {
+    ANDAS_JNI_SCOPE("NativeData.fillNullColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    double* resultElements = andas::directBufferAddress<double>(env, out, length);
+    if (elements == nullptr || resultElements == nullptr) return;
+    fillNull(elements, value, resultElements, length);
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_sortIndicesColumn(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject buffer,
+    jint length,
+    jboolean descending
+) try {
+    ANDAS_JNI_SCOPE("NativeData.sortIndicesColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return nullptr;
+    
+    jintArray result = env->NewIntArray(length);
+    jint* indices = andas::getArrayElements(env, result, true);
+    sortIndicesOf(elements, indices, length, descending);
+    andas::releaseArrayElements(env, result, indices, 0);
+    
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_describeColumn(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject buffer,
+    jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeData.describeColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return nullptr;
+    if (length == 0) return env->NewDoubleArray(0);
+    
+    jdouble resultElements[5];
+    describeOf(elements, length, resultElements);
     
-    // 返回: [count, mean, std, min, max]
     jdoubleArray result = env->NewDoubleArray(5);
-    jdouble resultElements[5] = {static_cast<double>(count), mean, std, min_val, max_val};
-    env->SetDoubleArrayRegion(result, 0, 5, resultElements);
+    andas::setArrayRegion(env, result, 0, 5, resultElements);
     
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// ==================== 流式摘要 ====================
+// 每次调用构建一份摘要并返回打包结果，分批/分块的摘要在 Kotlin 侧合并
 
-// 数据采样优化
 extern "C" JNIEXPORT jdoubleArray JNICALL
-Java_cn_ac_oac_libs_andas_core_NativeData_sample(
+Java_cn_ac_oac_libs_andas_core_NativeData_quantileSketch(
     JNIEnv* env,
     jobject /* this */,
     jdoubleArray array,
-    jint sampleSize
-) {
-    jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
-    
-    if (sampleSize >= length) {
-        // 返回副本
-        jdoubleArray result = env->NewDoubleArray(length);
-        env->SetDoubleArrayRegion(result, 0, length, elements);
-        env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-        return result;
+    jint k
+) try {
+    ANDAS_JNI_SCOPE("NativeData.quantileSketch");
+    const jsize length = env->GetArrayLength(array);
+    jdouble* elements = andas::getArrayElements(env, array);
+    const andas::QuantileSketch sketch = andas::buildQuantileSketch(elements, length, k);
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+
+    const std::vector<double> packed = sketch.pack();
+    const jsize size = static_cast<jsize>(packed.size());
+    jdoubleArray result = env->NewDoubleArray(size);
+    andas::setArrayRegion(env, result, 0, size, packed.data());
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// values: double[]（NaN 为缺失值）或 long[]（Long.MIN_VALUE 为缺失值）
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_distinctSketchArray(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject values,
+    jint precision
+) try {
+    ANDAS_JNI_SCOPE("NativeData.distinctSketchArray");
+    PinnedSortKey pinned;
+    if (!pinSortKey(env, values, pinned)) {
+        andas::throwIllegalArgument(env, "去重计数的列必须是 DoubleArray 或 LongArray");
+        return nullptr;
     }
-    
-    // 简单的随机采样（线性同余生成器）
-    std::vector<int> indices(length);
-    #pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        indices[i] = i;
+    const andas::DistinctCounter counter = pinned.type == andas::SortKeyType::FLOAT64
+        ? andas::buildDistinctCounter(static_cast<const double*>(pinned.elements), pinned.length, precision)
+        : andas::buildDistinctCounter(static_cast<const int64_t*>(pinned.elements), pinned.length,
+                                      std::numeric_limits<int64_t>::min(), precision);
+    releaseSortKey(env, pinned);
+
+    const std::vector<uint8_t>& registers = counter.registers();
+    const jsize size = static_cast<jsize>(registers.size());
+    jbyteArray result = env->NewByteArray(size);
+    andas::setArrayRegion(env, result, 0, size, reinterpret_cast<const jbyte*>(registers.data()));
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// values 约定同 distinctSketchArray；double 值的键为去掉负零后的位模式
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_heavyHitterSketchArray(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject values,
+    jint capacity
+) try {
+    ANDAS_JNI_SCOPE("NativeData.heavyHitterSketchArray");
+    PinnedSortKey pinned;
+    if (!pinSortKey(env, values, pinned)) {
+        andas::throwIllegalArgument(env, "高频项统计的列必须是 DoubleArray 或 LongArray");
+        return nullptr;
     }
-    
-    // 洗牌算法
-    for (int i = length - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
-        std::swap(indices[i], indices[j]);
+    const andas::HeavyHitters sketch = pinned.type == andas::SortKeyType::FLOAT64
+        ? andas::buildHeavyHitters(static_cast<const double*>(pinned.elements), pinned.length, capacity)
+        : andas::buildHeavyHitters(static_cast<const int64_t*>(pinned.elements), pinned.length,
+                                   std::numeric_limits<int64_t>::min(), capacity);
+    releaseSortKey(env, pinned);
+
+    const std::vector<int64_t> packed = sketch.pack();
+    const jsize size = static_cast<jsize>(packed.size());
+    jlongArray result = env->NewLongArray(size);
+    andas::setArrayRegion(env, result, 0, size, reinterpret_cast<const jlong*>(packed.data()));
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// ==================== 相关系数与协方差矩阵 ====================
+
+namespace {
+
+// 固定 k 个等长的 double 列并调用 compute(列指针, 行数)，结果为 k×k 行主序矩阵；长度不一致时抛出异常并返回 nullptr
+template <typename Compute>
+jdoubleArray pairwiseMatrix(JNIEnv* env, jobjectArray columns, Compute&& compute) {
+    const jsize k = env->GetArrayLength(columns);
+    std::vector<jdoubleArray> arrays(k);
+    jsize length = -1;
+    bool consistent = true;
+    for (jsize c = 0; c < k; c++) {
+        arrays[c] = static_cast<jdoubleArray>(env->GetObjectArrayElement(columns, c));
+        const jsize len = arrays[c] == nullptr ? -1 : env->GetArrayLength(arrays[c]);
+        if (length < 0) length = len;
+        consistent &= (len >= 0 && len == length);
     }
-    
-    jdoubleArray result = env->NewDoubleArray(sampleSize);
-    for (int i = 0; i < sampleSize; i++) {
-        double value = elements[indices[i]];
-        env->SetDoubleArrayRegion(result, i, 1, &value);
+    if (!consistent) {
+        andas::throwIllegalArgument(env, "参与计算的列长度不一致");
+        return nullptr;
     }
-    
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-    
+
+    std::vector<jdouble*> elements(k);
+    std::vector<const double*> pointers(k);
+    for (jsize c = 0; c < k; c++) {
+        elements[c] = andas::getArrayElements(env, arrays[c]);
+        pointers[c] = elements[c];
+    }
+    std::vector<double> matrix(static_cast<size_t>(k) * static_cast<size_t>(k));
+    compute(pointers.data(), static_cast<int32_t>(k), static_cast<int64_t>(std::max<jsize>(length, 0)), matrix.data());
+    for (jsize c = 0; c < k; c++) andas::releaseArrayElements(env, arrays[c], elements[c], JNI_ABORT);
+
+    const jsize size = static_cast<jsize>(matrix.size());
+    jdoubleArray result = env->NewDoubleArray(size);
+    andas::setArrayRegion(env, result, 0, size, matrix.data());
+    return result;
+}
+
+} // namespace
+
+// columns: k 个等长的列（NaN 表示缺失），method: CorrMethod 编码
+// 返回 k×k 行主序的相关系数矩阵，每对列只使用两列都不缺失的行
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_correlationMatrix(
+    JNIEnv* env,
+    jobject /* this */,
+    jobjectArray columns,
+    jint method,
+    jint minPeriods
+) try {
+    ANDAS_JNI_SCOPE("NativeData.correlationMatrix");
+    if (!andas::isValidCorrMethod(method)) {
+        andas::throwIllegalArgument(env, "不支持的相关系数方法");
+        return nullptr;
+    }
+    return pairwiseMatrix(env, columns, [&](const double* const* pointers, int32_t k, int64_t n, double* out) {
+        andas::correlationMatrix(pointers, k, n, static_cast<andas::CorrMethod>(method), minPeriods, out);
+    });
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 协方差矩阵，自由度为共同有效行数 - ddof
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_covarianceMatrix(
+    JNIEnv* env,
+    jobject /* this */,
+    jobjectArray columns,
+    jint minPeriods,
+    jint ddof
+) try {
+    ANDAS_JNI_SCOPE("NativeData.covarianceMatrix");
+    return pairwiseMatrix(env, columns, [&](const double* const* pointers, int32_t k, int64_t n, double* out) {
+        andas::covarianceMatrix(pointers, k, n, minPeriods, ddof, out);
+    });
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// ==================== 多列去重 ====================
+
+namespace {
+
+// 固定一组等长的 int64 键列并调用 body(列指针, 行数)；长度不一致时抛出异常并返回 nullptr
+// expectedColumns >= 0 时还要求列数等于它
+template <typename Result, typename Body>
+Result withKeyColumns(JNIEnv* env, jobjectArray keys, jsize expectedColumns, Body&& body) {
+    const jsize keyCount = env->GetArrayLength(keys);
+    if (keyCount == 0 || (expectedColumns >= 0 && keyCount != expectedColumns)) {
+        andas::throwIllegalArgument(env, "去重键列数不正确");
+        return nullptr;
+    }
+    std::vector<jlongArray> keyArrays(keyCount);
+    jsize length = -1;
+    bool consistent = true;
+    for (jsize c = 0; c < keyCount; c++) {
+        keyArrays[c] = static_cast<jlongArray>(env->GetObjectArrayElement(keys, c));
+        jsize len = keyArrays[c] == nullptr ? -1 : env->GetArrayLength(keyArrays[c]);
+        if (length < 0) length = len;
+        consistent &= (len >= 0 && len == length);
+    }
+    if (!consistent) {
+        andas::throwIllegalArgument(env, "去重键列长度不一致");
+        return nullptr;
+    }
+
+    static_assert(sizeof(jlong) == sizeof(int64_t), "jlong 必须为 64 位");
+    std::vector<jlong*> keyElements(keyCount);
+    std::vector<const int64_t*> keyColumns(keyCount);
+    for (jsize c = 0; c < keyCount; c++) {
+        keyElements[c] = andas::getArrayElements(env, keyArrays[c]);
+        keyColumns[c] = reinterpret_cast<const int64_t*>(keyElements[c]);
+    }
+    Result result = body(keyColumns.data(), static_cast<int32_t>(keyCount), static_cast<int64_t>(length));
+    for (jsize c = 0; c < keyCount; c++) andas::releaseArrayElements(env, keyArrays[c], keyElements[c], JNI_ABORT);
+    return result;
+}
+
+andas::DistinctKeySet* distinctSetFrom(JNIEnv* env, jlong handle) {
+    andas::DistinctKeySet* set = reinterpret_cast<andas::DistinctKeySet*>(handle);
+    if (set == nullptr) andas::throwIllegalArgument(env, "去重集合已关闭");
+    return set;
+}
+
+} // namespace
+
+// keys: 去重键列（int64，空值也是普通的键值），sortByCount: 按出现次数降序
+// 返回 Object[]: [每个不同键首次出现的行号 int[], 出现次数 long[]]
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_uniqueRowsArrays(
+    JNIEnv* env,
+    jobject /* this */,
+    jobjectArray keys,
+    jboolean sortByCount
+) try {
+    ANDAS_JNI_SCOPE("NativeData.uniqueRowsArrays");
+    return withKeyColumns<jobjectArray>(env, keys, -1, [&](const int64_t* const* columns, int32_t keyCount, int64_t n) {
+        const andas::UniqueOutput unique = andas::uniqueRows(columns, keyCount, n, sortByCount == JNI_TRUE);
+        const jsize groups = static_cast<jsize>(unique.rows.size());
+        jclass objectClass = env->FindClass("java/lang/Object");
+        jobjectArray result = env->NewObjectArray(2, objectClass, nullptr);
+        jintArray rows = toIntArray(env, unique.rows);
+        env->SetObjectArrayElement(result, 0, rows);
+        env->DeleteLocalRef(rows);
+        jlongArray counts = env->NewLongArray(groups);
+        andas::setArrayRegion(env, counts, 0, groups, reinterpret_cast<const jlong*>(unique.counts.data()));
+        env->SetObjectArrayElement(result, 1, counts);
+        env->DeleteLocalRef(counts);
+        return result;
+    });
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 每行是否为重复行，keep: DuplicateKeep 编码
+extern "C" JNIEXPORT jbooleanArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_duplicatedRowsArrays(
+    JNIEnv* env,
+    jobject /* this */,
+    jobjectArray keys,
+    jint keep
+) try {
+    ANDAS_JNI_SCOPE("NativeData.duplicatedRowsArrays");
+    if (!andas::isValidDuplicateKeep(keep)) {
+        andas::throwIllegalArgument(env, "不支持的重复行保留方式");
+        return nullptr;
+    }
+    return withKeyColumns<jbooleanArray>(env, keys, -1, [&](const int64_t* const* columns, int32_t keyCount, int64_t n) {
+        static_assert(sizeof(jboolean) == sizeof(uint8_t), "jboolean 必须为 1 字节");
+        andas::ScratchBuffer<uint8_t> flags(n);
+        andas::duplicatedRows(columns, keyCount, n, static_cast<andas::DuplicateKeep>(keep), flags.data());
+        const jsize size = static_cast<jsize>(n);
+        jbooleanArray result = env->NewBooleanArray(size);
+        andas::setArrayRegion(env, result, 0, size, reinterpret_cast<const jboolean*>(flags.data()));
+        return result;
+    });
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 跨批次去重集合，返回句柄，用完须调用 distinctSetRelease
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_distinctSetCreate(
+    JNIEnv* env,
+    jobject /* this */,
+    jint keyColumns
+) try {
+    ANDAS_JNI_SCOPE("NativeData.distinctSetCreate");
+    if (keyColumns <= 0) {
+        andas::throwIllegalArgument(env, "至少需要一个去重键列");
+        return 0;
+    }
+    return reinterpret_cast<jlong>(new andas::DistinctKeySet(keyColumns));
+} ANDAS_JNI_CATCH(env, 0)
+
+// 插入一批键，返回此前没有出现过的行号（升序）
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_distinctSetInsert(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle,
+    jobjectArray keys
+) try {
+    ANDAS_JNI_SCOPE("NativeData.distinctSetInsert");
+    andas::DistinctKeySet* set = distinctSetFrom(env, handle);
+    if (set == nullptr) return nullptr;
+    return withKeyColumns<jintArray>(env, keys, set->keyColumns(), [&](const int64_t* const* columns, int32_t, int64_t n) {
+        return toIntArray(env, set->insert(columns, n));
+    });
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_distinctSetSize(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.distinctSetSize");
+    andas::DistinctKeySet* set = distinctSetFrom(env, handle);
+    return set == nullptr ? 0 : set->size();
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_distinctSetRelease(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.distinctSetRelease");
+    delete reinterpret_cast<andas::DistinctKeySet*>(handle);
+} ANDAS_JNI_CATCH(env)
+
+// ==================== 行索引 ====================
+
+namespace {
+
+andas::HashIndex* hashIndexFrom(JNIEnv* env, jlong handle) {
+    andas::HashIndex* index = reinterpret_cast<andas::HashIndex*>(handle);
+    if (index == nullptr) andas::throwIllegalArgument(env, "索引已释放");
+    return index;
+}
+
+} // namespace
+
+// 由标签键（int64，字符串标签为其哈希）建哈希索引，返回句柄，用完须调用 hashIndexRelease
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_hashIndexCreate(
+    JNIEnv* env,
+    jobject /* this */,
+    jlongArray keys
+) try {
+    ANDAS_JNI_SCOPE("NativeData.hashIndexCreate");
+    static_assert(sizeof(jlong) == sizeof(int64_t), "jlong 必须为 64 位");
+    const jsize length = env->GetArrayLength(keys);
+    jlong* elements = andas::getArrayElements(env, keys);
+    andas::HashIndex* index = new andas::HashIndex(reinterpret_cast<const int64_t*>(elements), length);
+    andas::releaseArrayElements(env, keys, elements, JNI_ABORT);
+    return reinterpret_cast<jlong>(index);
+} ANDAS_JNI_CATCH(env, 0)
+
+// 键第一次出现的位置，不存在时为 -1
+extern "C" JNIEXPORT jint JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_hashIndexFirst(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle,
+    jlong key
+) try {
+    ANDAS_JNI_SCOPE("NativeData.hashIndexFirst");
+    andas::HashIndex* index = hashIndexFrom(env, handle);
+    return index == nullptr ? -1 : index->first(key);
+} ANDAS_JNI_CATCH(env, -1)
+
+// 与 position 键相同的下一个位置，没有时为 -1
+extern "C" JNIEXPORT jint JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_hashIndexNext(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle,
+    jint position
+) try {
+    ANDAS_JNI_SCOPE("NativeData.hashIndexNext");
+    andas::HashIndex* index = hashIndexFrom(env, handle);
+    if (index == nullptr) return -1;
+    if (position < 0 || position >= index->size()) {
+        andas::throwIllegalArgument(env, "索引位置越界");
+        return -1;
+    }
+    return index->next(position);
+} ANDAS_JNI_CATCH(env, -1)
+
+// 批量查找每个探测键第一次出现的位置
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_hashIndexLookup(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle,
+    jlongArray probes
+) try {
+    ANDAS_JNI_SCOPE("NativeData.hashIndexLookup");
+    andas::HashIndex* index = hashIndexFrom(env, handle);
+    if (index == nullptr) return nullptr;
+    const jsize length = env->GetArrayLength(probes);
+    jlong* elements = andas::getArrayElements(env, probes);
+    andas::ScratchBuffer<int32_t> out(length);
+    index->lookup(reinterpret_cast<const int64_t*>(elements), length, out.data());
+    andas::releaseArrayElements(env, probes, elements, JNI_ABORT);
+    jintArray result = env->NewIntArray(length);
+    andas::setArrayRegion(env, result, 0, length, reinterpret_cast<const jint*>(out.data()));
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 每个位置的键第一次出现的位置
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_hashIndexFirstPositions(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.hashIndexFirstPositions");
+    andas::HashIndex* index = hashIndexFrom(env, handle);
+    if (index == nullptr) return nullptr;
+    const jsize length = static_cast<jsize>(index->size());
+    andas::ScratchBuffer<int32_t> out(length);
+    index->firstPositions(out.data());
+    jintArray result = env->NewIntArray(length);
+    andas::setArrayRegion(env, result, 0, length, reinterpret_cast<const jint*>(out.data()));
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_hashIndexIsUnique(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.hashIndexIsUnique");
+    andas::HashIndex* index = hashIndexFrom(env, handle);
+    return index != nullptr && index->unique() ? JNI_TRUE : JNI_FALSE;
+} ANDAS_JNI_CATCH(env, JNI_FALSE)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_hashIndexRelease(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.hashIndexRelease");
+    delete reinterpret_cast<andas::HashIndex*>(handle);
+} ANDAS_JNI_CATCH(env)
+
+// ==================== 外存排序与溢写分组 ====================
+
+namespace {
+
+std::string stringFrom(JNIEnv* env, jstring value) {
+    const char* chars = env->GetStringUTFChars(value, nullptr);
+    std::string result(chars);
+    env->ReleaseStringUTFChars(value, chars);
     return result;
 }
+
+template <typename T>
+T* spillHandleFrom(JNIEnv* env, jlong handle) {
+    T* object = reinterpret_cast<T*>(handle);
+    if (object == nullptr) andas::throwIllegalArgument(env, "外存排序或分组已关闭");
+    return object;
+}
+
+// 校验 n 条记录的 offsets（n + 1 个，单调不减，末尾不超过 bytes），不合法时抛出异常并返回 false
+bool checkOffsets(JNIEnv* env, const jint* offsets, jsize n, jsize bytes) {
+    bool valid = offsets[0] == 0 && offsets[n] <= bytes;
+    for (jsize i = 0; valid && i < n; i++) valid = offsets[i] <= offsets[i + 1];
+    if (!valid) andas::throwIllegalArgument(env, "记录偏移不合法");
+    return valid;
+}
+
+jbyteArray toByteArray(JNIEnv* env, const std::vector<uint8_t>& bytes) {
+    const jsize size = static_cast<jsize>(bytes.size());
+    jbyteArray result = env->NewByteArray(size);
+    andas::setArrayRegion(env, result, 0, size, reinterpret_cast<const jbyte*>(bytes.data()));
+    return result;
+}
+
+jlongArray toLongArray(JNIEnv* env, const std::vector<int64_t>& values) {
+    const jsize size = static_cast<jsize>(values.size());
+    jlongArray result = env->NewLongArray(size);
+    andas::setArrayRegion(env, result, 0, size, reinterpret_cast<const jlong*>(values.data()));
+    return result;
+}
+
+jdoubleArray toDoubleArray(JNIEnv* env, const std::vector<double>& values) {
+    const jsize size = static_cast<jsize>(values.size());
+    jdoubleArray result = env->NewDoubleArray(size);
+    andas::setArrayRegion(env, result, 0, size, values.data());
+    return result;
+}
+
+void setElement(JNIEnv* env, jobjectArray array, jsize index, jobject value) {
+    env->SetObjectArrayElement(array, index, value);
+    env->DeleteLocalRef(value);
+}
+
+} // namespace
+
+// 外存排序，临时文件写在 directory 下，返回句柄，用完须调用 externalSortRelease
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_externalSortCreate(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring directory,
+    jlong memoryBudget,
+    jboolean descending
+) try {
+    ANDAS_JNI_SCOPE("NativeData.externalSortCreate");
+    if (memoryBudget <= 0) {
+        andas::throwIllegalArgument(env, "内存预算必须大于0");
+        return 0;
+    }
+    return reinterpret_cast<jlong>(new andas::ExternalSorter(stringFrom(env, directory), memoryBudget, descending == JNI_TRUE));
+} ANDAS_JNI_CATCH(env, 0)
+
+// 追加一批记录：keys[i] 为排序键（NaN 为缺失值），内容为 payload[offsets[i], offsets[i + 1])
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_externalSortAdd(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle,
+    jdoubleArray keys,
+    jbyteArray payload,
+    jintArray offsets
+) try {
+    ANDAS_JNI_SCOPE("NativeData.externalSortAdd");
+    andas::ExternalSorter* sorter = spillHandleFrom<andas::ExternalSorter>(env, handle);
+    if (sorter == nullptr) return;
+    const jsize n = env->GetArrayLength(keys);
+    if (env->GetArrayLength(offsets) != n + 1) {
+        andas::throwIllegalArgument(env, "记录偏移的个数必须为记录数加一");
+        return;
+    }
+    jint* offsetElements = andas::getArrayElements(env, offsets);
+    if (!checkOffsets(env, offsetElements, n, env->GetArrayLength(payload))) {
+        andas::releaseArrayElements(env, offsets, offsetElements, JNI_ABORT);
+        return;
+    }
+    jdouble* keyElements = andas::getArrayElements(env, keys);
+    jbyte* payloadElements = andas::getArrayElements(env, payload);
+    sorter->add(keyElements, reinterpret_cast<const uint8_t*>(payloadElements), offsetElements, n);
+    andas::releaseArrayElements(env, payload, payloadElements, JNI_ABORT);
+    andas::releaseArrayElements(env, keys, keyElements, JNI_ABORT);
+    andas::releaseArrayElements(env, offsets, offsetElements, JNI_ABORT);
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_externalSortFinish(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.externalSortFinish");
+    andas::ExternalSorter* sorter = spillHandleFrom<andas::ExternalSorter>(env, handle);
+    if (sorter != nullptr) sorter->finish();
+} ANDAS_JNI_CATCH(env)
+
+// 按顺序取出内容累计约 maxBytes 的记录，返回 Object[]: [内容 byte[], 偏移 int[]]，全部取出后返回 null
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_externalSortNext(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle,
+    jint maxBytes
+) try {
+    ANDAS_JNI_SCOPE("NativeData.externalSortNext");
+    andas::ExternalSorter* sorter = spillHandleFrom<andas::ExternalSorter>(env, handle);
+    if (sorter == nullptr) return nullptr;
+    std::vector<uint8_t> payload;
+    std::vector<int32_t> offsets;
+    if (sorter->next(maxBytes, payload, offsets) == 0) return nullptr;
+    jobjectArray result = env->NewObjectArray(2, env->FindClass("java/lang/Object"), nullptr);
+    setElement(env, result, 0, toByteArray(env, payload));
+    setElement(env, result, 1, toIntArray(env, offsets));
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_externalSortSpilledBytes(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.externalSortSpilledBytes");
+    andas::ExternalSorter* sorter = spillHandleFrom<andas::ExternalSorter>(env, handle);
+    return sorter == nullptr ? 0 : sorter->spilledBytes();
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_externalSortRelease(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.externalSortRelease");
+    delete reinterpret_cast<andas::ExternalSorter*>(handle);
+} ANDAS_JNI_CATCH(env)
+
+// 溢写分组聚合，临时文件写在 directory 下，返回句柄，用完须调用 spillAggregateRelease
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_spillAggregateCreate(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring directory,
+    jlong memoryBudget
+) try {
+    ANDAS_JNI_SCOPE("NativeData.spillAggregateCreate");
+    if (memoryBudget <= 0) {
+        andas::throwIllegalArgument(env, "内存预算必须大于0");
+        return 0;
+    }
+    return reinterpret_cast<jlong>(new andas::SpillAggregator(stringFrom(env, directory), memoryBudget));
+} ANDAS_JNI_CATCH(env, 0)
+
+// 追加一批行：第 i 行的分组键为 keys[offsets[i], offsets[i + 1])，值为 values[i]；values 为 null 时只计行数
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_spillAggregateAdd(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle,
+    jbyteArray keys,
+    jintArray offsets,
+    jdoubleArray values
+) try {
+    ANDAS_JNI_SCOPE("NativeData.spillAggregateAdd");
+    andas::SpillAggregator* aggregator = spillHandleFrom<andas::SpillAggregator>(env, handle);
+    if (aggregator == nullptr) return;
+    const jsize n = env->GetArrayLength(offsets) - 1;
+    if (n < 0 || (values != nullptr && env->GetArrayLength(values) != n)) {
+        andas::throwIllegalArgument(env, "分组键与值的行数不一致");
+        return;
+    }
+    jint* offsetElements = andas::getArrayElements(env, offsets);
+    if (!checkOffsets(env, offsetElements, n, env->GetArrayLength(keys))) {
+        andas::releaseArrayElements(env, offsets, offsetElements, JNI_ABORT);
+        return;
+    }
+    jbyte* keyElements = andas::getArrayElements(env, keys);
+    jdouble* valueElements = values == nullptr ? nullptr : andas::getArrayElements(env, values);
+    aggregator->add(reinterpret_cast<const uint8_t*>(keyElements), offsetElements, valueElements, n);
+    if (valueElements != nullptr) andas::releaseArrayElements(env, values, valueElements, JNI_ABORT);
+    andas::releaseArrayElements(env, keys, keyElements, JNI_ABORT);
+    andas::releaseArrayElements(env, offsets, offsetElements, JNI_ABORT);
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_spillAggregateFinish(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.spillAggregateFinish");
+    andas::SpillAggregator* aggregator = spillHandleFrom<andas::SpillAggregator>(env, handle);
+    if (aggregator != nullptr) aggregator->finish();
+} ANDAS_JNI_CATCH(env)
+
+// 下一批分组的结果，返回 Object[]: [键 byte[], 键偏移 int[], 行数 long[], 非缺失值个数 long[], 和 double[],
+// 最小值 double[], 最大值 double[]]，全部取出后返回 null
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_spillAggregateNext(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.spillAggregateNext");
+    andas::SpillAggregator* aggregator = spillHandleFrom<andas::SpillAggregator>(env, handle);
+    if (aggregator == nullptr) return nullptr;
+    andas::SpillGroups groups;
+    if (!aggregator->next(groups)) return nullptr;
+    jobjectArray result = env->NewObjectArray(7, env->FindClass("java/lang/Object"), nullptr);
+    setElement(env, result, 0, toByteArray(env, groups.keys));
+    setElement(env, result, 1, toIntArray(env, groups.offsets));
+    setElement(env, result, 2, toLongArray(env, groups.rows));
+    setElement(env, result, 3, toLongArray(env, groups.counts));
+    setElement(env, result, 4, toDoubleArray(env, groups.sums));
+    setElement(env, result, 5, toDoubleArray(env, groups.mins));
+    setElement(env, result, 6, toDoubleArray(env, groups.maxs));
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_spillAggregateSpilledBytes(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.spillAggregateSpilledBytes");
+    andas::SpillAggregator* aggregator = spillHandleFrom<andas::SpillAggregator>(env, handle);
+    return aggregator == nullptr ? 0 : aggregator->spilledBytes();
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeData_spillAggregateRelease(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeData.spillAggregateRelease");
+    delete reinterpret_cast<andas::SpillAggregator*>(handle);
+} ANDAS_JNI_CATCH(env)
@@ -0,0 +1,343 @@
+#include "dedup_engine.h"
+
+#include <algorithm>
+#include <functional>
+#include "hash_utils.h"
+#include "memory_pool.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+bool isValidDuplicateKeep(int32_t keep) {
+    return keep >= static_cast<int32_t>(DuplicateKeep::FIRST) && keep <= static_cast<int32_t>(DuplicateKeep::NONE);
+}
+
+namespace {
+
+// 按哈希高位分区，各分区互不相交，可以独立（并行）建表；
+// 单线程时分区同样有用：每个分区的表小得多，能留在缓存中
+constexpr int kPartitionBits = 6;
+constexpr int64_t kPartitionMinRows = 65536;
+
+inline int partitionBitsFor(int64_t n) {
+    return n >= kPartitionMinRows ? kPartitionBits : 0;
+}
+
+// 开放寻址（线性探测）哈希表，槽位保存完整哈希和键编号，哈希不同时不必访问键
+// - ownsKeys 为 false 时只记录每个键首次出现的行号，比较时回到输入列读取，插入不需要复制键
+// - ownsKeys 为 true 时复制键本身，输入列可以在调用之后释放（跨批次的集合）
+class KeyTable {
+public:
+    KeyTable(int32_t keyColumns, bool ownsKeys)
+        : keyColumns_(keyColumns), ownsKeys_(ownsKeys), slots_(16, Slot{0, -1}) {}
+
+    int32_t size() const { return size_; }
+
+    // 查找第 row 行的键，不存在时插入；inserted 表示是否为新键
+    int32_t findOrInsert(const int64_t* const* keys, int64_t row, uint64_t hash, bool* inserted) {
+        size_t mask = slots_.size() - 1;
+        size_t pos = static_cast<size_t>(hash) & mask;
+        for (;;) {
+            const Slot& slot = slots_[pos];
+            if (slot.id < 0) break;
+            if (slot.hash == hash && keyEquals(slot.id, keys, row)) {
+                *inserted = false;
+                return slot.id;
+            }
+            pos = (pos + 1) & mask;
+        }
+        const int32_t id = size_++;
+        slots_[pos] = Slot{hash, id};
+        if (ownsKeys_) {
+            for (int32_t c = 0; c < keyColumns_; c++) stored_.push_back(keys[c][row]);
+        } else {
+            rows_.push_back(static_cast<int32_t>(row));
+        }
+        // 负载因子保持在 1/2 以下
+        if (static_cast<size_t>(size_) * 2 > slots_.size()) grow();
+        *inserted = true;
+        return id;
+    }
+
+private:
+    struct Slot {
+        uint64_t hash;
+        int32_t id;   // -1 表示空槽
+    };
+
+    bool keyEquals(int32_t id, const int64_t* const* keys, int64_t row) const {
+        if (ownsKeys_) {
+            const int64_t* stored = stored_.data() + static_cast<size_t>(id) * keyColumns_;
+            for (int32_t c = 0; c < keyColumns_; c++) {
+                if (stored[c] != keys[c][row]) return false;
+            }
+            return true;
+        }
+        const int64_t first = rows_[static_cast<size_t>(id)];
+        for (int32_t c = 0; c < keyColumns_; c++) {
+            if (keys[c][first] != keys[c][row]) return false;
+        }
+        return true;
+    }
+
+    void grow() {
+        std::vector<Slot> slots(slots_.size() * 2, Slot{0, -1});
+        size_t mask = slots.size() - 1;
+        for (const Slot& slot : slots_) {
+            if (slot.id < 0) continue;
+            size_t pos = static_cast<size_t>(slot.hash) & mask;
+            while (slots[pos].id >= 0) pos = (pos + 1) & mask;
+            slots[pos] = slot;
+        }
+        slots_.swap(slots);
+    }
+
+    int32_t keyColumns_;
+    bool ownsKeys_;
+    int32_t size_ = 0;
+    std::vector<Slot> slots_;
+    std::vector<int32_t> rows_;
+    std::vector<int64_t> stored_;
+};
+
+// 一个分区的行：rows 为 nullptr 时表示 0..count-1（不分区）
+struct RowSpan {
+    const int32_t* rows;
+    int64_t count;
+
+    int64_t at(int64_t j) const { return rows != nullptr ? rows[j] : j; }
+};
+
+// 按块执行 task(chunk)，串行时只有一块
+void forEachChunk(const detail::ChunkPlan& plan, bool serial, const std::function<void(int64_t)>& task) {
+    if (serial) {
+        for (int64_t c = 0; c < plan.chunks; c++) task(c);
+    } else {
+        ThreadPool::instance().run(plan.chunks, task);
+    }
+}
+
+// 计算每行的组合哈希并按高 bits 位分区，分区内保持行号升序，然后对每个分区调用 body(partition, span)
+// 各分区的 body 可能并行执行
+template <typename Body>
+void partitionRows(const int64_t* const* keys, int32_t keyColumns, int64_t n, int bits, bool serial,
+                   uint64_t* hashes, Body&& body) {
+    parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) hashes[i] = hashRow(keys, keyColumns, i);
+    });
+    const int64_t partitions = int64_t(1) << bits;
+    if (partitions == 1) {
+        body(0, RowSpan{nullptr, n});
+        return;
+    }
+
+    const detail::ChunkPlan plan = serial ? detail::ChunkPlan{std::max<int64_t>(n, 1), 1}
+                                          : detail::planChunks(n, ThreadPool::instance().threadCount(), 16384);
+    // 每块每分区的行数，按 (分区, 块) 的顺序求前缀和，得到每块在每个分区中的写入位置
+    ScratchBuffer<int64_t> cursor(plan.chunks * partitions);
+    std::fill(cursor.begin(), cursor.end(), 0);
+    forEachChunk(plan, serial, [&](int64_t chunk) {
+        const int64_t lo = chunk * plan.grain;
+        const int64_t hi = std::min(n, lo + plan.grain);
+        int64_t* counts = cursor.data() + chunk * partitions;
+        for (int64_t i = lo; i < hi; i++) counts[hashPartition(hashes[i], bits)]++;
+    });
+    ScratchBuffer<int64_t> offsets(partitions + 1);
+    int64_t total = 0;
+    for (int64_t p = 0; p < partitions; p++) {
+        offsets[p] = total;
+        for (int64_t c = 0; c < plan.chunks; c++) {
+            int64_t& slot = cursor[c * partitions + p];
+            const int64_t count = slot;
+            slot = total;
+            total += count;
+        }
+    }
+    offsets[partitions] = total;
+
+    ScratchBuffer<int32_t> rows(n);
+    forEachChunk(plan, serial, [&](int64_t chunk) {
+        const int64_t lo = chunk * plan.grain;
+        const int64_t hi = std::min(n, lo + plan.grain);
+        int64_t* next = cursor.data() + chunk * partitions;
+        for (int64_t i = lo; i < hi; i++) {
+            rows[next[hashPartition(hashes[i], bits)]++] = static_cast<int32_t>(i);
+        }
+    });
+
+    std::function<void(int64_t)> task = [&](int64_t p) {
+        body(p, RowSpan{rows.data() + offsets[p], offsets[p + 1] - offsets[p]});
+    };
+    if (serial) {
+        for (int64_t p = 0; p < partitions; p++) task(p);
+    } else {
+        ThreadPool::instance().run(partitions, task);
+    }
+}
+
+// 按行号升序收集 flags[i] != 0 的行
+std::vector<int32_t> collectFlagged(const uint8_t* flags, int64_t n) {
+    const bool serial = detail::shouldRunSerial(n);
+    const detail::ChunkPlan plan = serial ? detail::ChunkPlan{std::max<int64_t>(n, 1), 1}
+                                          : detail::planChunks(n, ThreadPool::instance().threadCount(), 16384);
+    ScratchBuffer<int64_t> offsets(plan.chunks + 1);
+    offsets[0] = 0;
+    forEachChunk(plan, serial, [&](int64_t chunk) {
+        const int64_t lo = chunk * plan.grain;
+        const int64_t hi = std::min(n, lo + plan.grain);
+        int64_t count = 0;
+        for (int64_t i = lo; i < hi; i++) count += flags[i] != 0;
+        offsets[chunk + 1] = count;
+    });
+    for (int64_t c = 0; c < plan.chunks; c++) offsets[c + 1] += offsets[c];
+
+    std::vector<int32_t> out(static_cast<size_t>(offsets[plan.chunks]));
+    forEachChunk(plan, serial, [&](int64_t chunk) {
+        const int64_t lo = chunk * plan.grain;
+        const int64_t hi = std::min(n, lo + plan.grain);
+        int64_t pos = offsets[chunk];
+        for (int64_t i = lo; i < hi; i++) {
+            if (flags[i] != 0) out[static_cast<size_t>(pos++)] = static_cast<int32_t>(i);
+        }
+    });
+    return out;
+}
+
+} // namespace
+
+UniqueOutput uniqueRows(const int64_t* const* keys, int32_t keyColumns, int64_t n, bool sortByCount) {
+    n = std::max<int64_t>(n, 0);
+    const bool serial = detail::shouldRunSerial(n);
+    // 每个键的次数记在它首次出现的行上，其余行为 0，之后按行号顺序收集即为首次出现的顺序
+    std::vector<int64_t> countAt(static_cast<size_t>(n), 0);
+    {
+        ScratchBuffer<uint64_t> hashes(n);
+        partitionRows(keys, keyColumns, n, partitionBitsFor(n), serial, hashes.data(),
+            [&](int64_t, RowSpan span) {
+                KeyTable table(keyColumns, false);
+                std::vector<int32_t> firstRows;
+                std::vector<int64_t> counts;
+                for (int64_t j = 0; j < span.count; j++) {
+                    const int64_t row = span.at(j);
+                    bool inserted;
+                    const int32_t id = table.findOrInsert(keys, row, hashes[row], &inserted);
+                    if (inserted) {
+                        firstRows.push_back(static_cast<int32_t>(row));
+                        counts.push_back(0);
+                    }
+                    counts[static_cast<size_t>(id)]++;
+                }
+                for (size_t id = 0; id < firstRows.size(); id++) {
+                    countAt[static_cast<size_t>(firstRows[id])] = counts[id];
+                }
+            });
+    }
+
+    std::vector<uint8_t> flags(static_cast<size_t>(n));
+    parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) flags[static_cast<size_t>(i)] = countAt[static_cast<size_t>(i)] != 0;
+    });
+    UniqueOutput out;
+    out.rows = collectFlagged(flags.data(), n);
+    out.counts.resize(out.rows.size());
+    for (size_t g = 0; g < out.rows.size(); g++) out.counts[g] = countAt[static_cast<size_t>(out.rows[g])];
+
+    if (sortByCount) {
+        struct Entry {
+            int64_t count;
+            int32_t row;
+        };
+        std::vector<Entry> entries(out.rows.size());
+        for (size_t g = 0; g < entries.size(); g++) entries[g] = {out.counts[g], out.rows[g]};
+        // 首次出现的行号互不相同，排序结果唯一
+        parallel_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.count != b.count ? a.count > b.count : a.row < b.row;
+        });
+        for (size_t g = 0; g < entries.size(); g++) {
+            out.counts[g] = entries[g].count;
+            out.rows[g] = entries[g].row;
+        }
+    }
+    return out;
+}
+
+void duplicatedRows(const int64_t* const* keys, int32_t keyColumns, int64_t n, DuplicateKeep keep, uint8_t* out) {
+    n = std::max<int64_t>(n, 0);
+    const bool serial = detail::shouldRunSerial(n);
+    ScratchBuffer<uint64_t> hashes(n);
+    partitionRows(keys, keyColumns, n, partitionBitsFor(n), serial, hashes.data(),
+        [&](int64_t, RowSpan span) {
+            KeyTable table(keyColumns, false);
+            if (keep == DuplicateKeep::FIRST) {
+                for (int64_t j = 0; j < span.count; j++) {
+                    const int64_t row = span.at(j);
+                    bool inserted;
+                    table.findOrInsert(keys, row, hashes[row], &inserted);
+                    out[row] = inserted ? 0 : 1;
+                }
+                return;
+            }
+            // last/none 需要先看完整个分区：记下每行的键编号，再按最后出现的行号或出现次数判断
+            std::vector<int32_t> ids(static_cast<size_t>(span.count));
+            std::vector<int64_t> last;
+            for (int64_t j = 0; j < span.count; j++) {
+                const int64_t row = span.at(j);
+                bool inserted;
+                const int32_t id = table.findOrInsert(keys, row, hashes[row], &inserted);
+                if (inserted) last.push_back(-1);
+                // 同一分区内行号升序，最后写入的就是最后出现的行
+                last[static_cast<size_t>(id)] = inserted || keep == DuplicateKeep::LAST ? row : -2;
+                ids[static_cast<size_t>(j)] = id;
+            }
+            for (int64_t j = 0; j < span.count; j++) {
+                const int64_t row = span.at(j);
+                const int64_t mark = last[static_cast<size_t>(ids[static_cast<size_t>(j)])];
+                out[row] = keep == DuplicateKeep::LAST ? (mark != row) : (mark == -2);
+            }
+        });
+}
+
+// ==================== DistinctKeySet ====================
+
+class DistinctKeySet::Partition {
+public:
+    explicit Partition(int32_t keyColumns) : table(keyColumns, true) {}
+    KeyTable table;
+};
+
+DistinctKeySet::DistinctKeySet(int32_t keyColumns) : keyColumns_(keyColumns) {
+    // 分区数固定，与每批的行数和线程数无关，这样各批的同一个键总是落在同一个分区
+    for (int64_t p = 0; p < (int64_t(1) << kPartitionBits); p++) {
+        partitions_.emplace_back(new Partition(keyColumns));
+    }
+}
+
+DistinctKeySet::~DistinctKeySet() = default;
+
+int64_t DistinctKeySet::size() const {
+    int64_t total = 0;
+    for (const auto& partition : partitions_) total += partition->table.size();
+    return total;
+}
+
+std::vector<int32_t> DistinctKeySet::insert(const int64_t* const* keys, int64_t n) {
+    n = std::max<int64_t>(n, 0);
+    const bool serial = detail::shouldRunSerial(n);
+    std::vector<uint8_t> fresh(static_cast<size_t>(n));
+    {
+        ScratchBuffer<uint64_t> hashes(n);
+        partitionRows(keys, keyColumns_, n, kPartitionBits, serial, hashes.data(),
+            [&](int64_t p, RowSpan span) {
+                KeyTable& table = partitions_[static_cast<size_t>(p)]->table;
+                for (int64_t j = 0; j < span.count; j++) {
+                    const int64_t row = span.at(j);
+                    bool inserted;
+                    table.findOrInsert(keys, row, hashes[row], &inserted);
+                    fresh[static_cast<size_t>(row)] = inserted ? 1 : 0;
+                }
+            });
+    }
+    return collectFlagged(fresh.data(), n);
+}
+
+} // namespace andas
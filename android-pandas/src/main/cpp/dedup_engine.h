@@ -0,0 +1,65 @@
+#ifndef ANDAS_DEDUP_ENGINE_H
+#define ANDAS_DEDUP_ENGINE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace andas {
+
+// 多列去重内核（不依赖JNI）
+// - 键为一个或多个 int64 列，字符串、double 等在上层编码后传入；与分组不同，缺失值也是一个普通的键值，
+//   空值与空值相等（与 pandas 的 duplicated/unique 一致）
+// - 先并行计算每行的组合哈希，按哈希高位把行分到互不相交的分区，各分区按行号顺序独立建开放寻址表，
+//   结果与线程数无关
+
+// 重复行保留哪一个，编码与 Kotlin 侧 DuplicateKeep.code 一致
+enum class DuplicateKeep : int32_t {
+    FIRST = 0,   // 第一次出现的不算重复
+    LAST = 1,    // 最后一次出现的不算重复
+    NONE = 2,    // 出现多次的全部算重复
+};
+
+bool isValidDuplicateKeep(int32_t keep);
+
+struct UniqueOutput {
+    // 每个不同键首次出现的行号
+    std::vector<int32_t> rows;
+    // 对应键出现的次数
+    std::vector<int64_t> counts;
+};
+
+// 不同的键，按首次出现的顺序；sortByCount 时按出现次数降序，次数相同的按首次出现的顺序（value_counts）
+UniqueOutput uniqueRows(const int64_t* const* keys, int32_t keyColumns, int64_t n, bool sortByCount);
+
+// out[i] = 1 表示第 i 行按 keep 规则是重复行
+void duplicatedRows(const int64_t* const* keys, int32_t keyColumns, int64_t n, DuplicateKeep keep, uint8_t* out);
+
+// 跨批次的去重集合：只保存出现过的键（每个不同键 keyColumns 个 int64 和一个哈希），
+// 内存与不同键的个数成正比，与批数和行宽无关；用于流式 drop_duplicates
+class DistinctKeySet {
+public:
+    explicit DistinctKeySet(int32_t keyColumns);
+    ~DistinctKeySet();
+
+    DistinctKeySet(const DistinctKeySet&) = delete;
+    DistinctKeySet& operator=(const DistinctKeySet&) = delete;
+
+    int32_t keyColumns() const { return keyColumns_; }
+
+    // 已保存的不同键个数
+    int64_t size() const;
+
+    // 插入一批键，返回此前各批和本批前面的行都没有出现过的行号（升序）
+    std::vector<int32_t> insert(const int64_t* const* keys, int64_t n);
+
+private:
+    class Partition;
+
+    int32_t keyColumns_;
+    std::vector<std::unique_ptr<Partition>> partitions_;
+};
+
+} // namespace andas
+
+#endif //ANDAS_DEDUP_ENGINE_H
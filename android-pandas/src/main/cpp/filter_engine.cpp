@@ -0,0 +1,374 @@
+#include "filter_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "memory_pool.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+namespace detail {
+
+struct PreparedFilter {
+    const FilterProgram& program;
+    std::vector<std::vector<double>> doubleSets;   // 每条指令一个，只有 IN_SET 非空
+    std::vector<std::vector<int64_t>> longSets;
+    int32_t maxDepth = 0;
+};
+
+} // namespace detail
+
+namespace {
+
+using detail::PreparedFilter;
+
+inline int64_t wordCount(int64_t n) {
+    return (n + 63) / 64;
+}
+
+// rows 行占用的最后一个字中有效位的掩码
+inline uint64_t tailMask(int64_t rows) {
+    const int64_t rem = rows % 64;
+    return rem == 0 ? ~uint64_t(0) : (uint64_t(1) << rem) - 1;
+}
+
+inline bool isLeaf(FilterOp op) {
+    return op != FilterOp::AND && op != FilterOp::OR && op != FilterOp::NOT;
+}
+
+// 逐行求值 test(i) 并打包成位图，第 i 行写入 bits[i / 64] 的第 i % 64 位
+template <typename Test>
+void packBits(int64_t rows, uint64_t* bits, Test test) {
+    for (int64_t base = 0; base < rows; base += 64) {
+        const int64_t count = std::min<int64_t>(64, rows - base);
+        uint64_t word = 0;
+        for (int64_t b = 0; b < count; b++) {
+            word |= static_cast<uint64_t>(test(base + b)) << b;
+        }
+        bits[base / 64] = word;
+    }
+}
+
+// IN_SET 的常量集合：小集合线性比较，大集合排序后二分查找
+template <typename T>
+bool contains(const std::vector<T>& set, T v) {
+    if (set.size() <= 8) {
+        for (T c : set) {
+            if (v == c) return true;
+        }
+        return false;
+    }
+    return std::binary_search(set.begin(), set.end(), v);
+}
+
+void prepare(PreparedFilter& prepared) {
+    const FilterProgram& program = prepared.program;
+    prepared.doubleSets.resize(program.instructionCount);
+    prepared.longSets.resize(program.instructionCount);
+    int32_t depth = 0;
+    for (int32_t i = 0; i < program.instructionCount; i++) {
+        const FilterInstruction& ins = program.instructions[i];
+        if (ins.op == FilterOp::IN_SET) {
+            if (program.columns[ins.column].type == FilterColumnType::FLOAT64) {
+                auto& set = prepared.doubleSets[i];
+                for (int32_t c = 0; c < ins.count; c++) {
+                    const double value = program.doubles[ins.arg + c];
+                    if (!std::isnan(value)) set.push_back(value);
+                }
+                std::sort(set.begin(), set.end());
+            } else {
+                auto& set = prepared.longSets[i];
+                for (int32_t c = 0; c < ins.count; c++) {
+                    const int64_t value = program.longs[ins.arg + c];
+                    if (value != kNullFilterKey) set.push_back(value);
+                }
+                std::sort(set.begin(), set.end());
+            }
+        }
+        depth += isLeaf(ins.op) ? 1 : (ins.op == FilterOp::NOT ? 0 : -1);
+        prepared.maxDepth = std::max(prepared.maxDepth, depth);
+    }
+}
+
+void evaluateDoubleLeaf(const PreparedFilter& prepared, int32_t index, const double* x, int64_t rows,
+                        uint64_t* bits, uint64_t* scratch) {
+    const FilterInstruction& ins = prepared.program.instructions[index];
+    const double* constants = prepared.program.doubles;
+    const simd::Kernels& k = simd::active();
+    switch (ins.op) {
+        case FilterOp::GT:
+        case FilterOp::GE:
+        case FilterOp::LT:
+        case FilterOp::LE:
+        case FilterOp::EQ:
+        case FilterOp::NE:
+            k.compareMask(x, rows, constants[ins.arg], static_cast<simd::CompareOp>(static_cast<int32_t>(ins.op)), bits);
+            break;
+        case FilterOp::BETWEEN: {
+            k.compareMask(x, rows, constants[ins.arg], simd::CompareOp::GE, bits);
+            k.compareMask(x, rows, constants[ins.arg + 1], simd::CompareOp::LE, scratch);
+            const int64_t words = wordCount(rows);
+            for (int64_t w = 0; w < words; w++) bits[w] &= scratch[w];
+            break;
+        }
+        case FilterOp::IN_SET: {
+            const std::vector<double>& set = prepared.doubleSets[index];
+            packBits(rows, bits, [&](int64_t i) { return !std::isnan(x[i]) && contains(set, x[i]); });
+            break;
+        }
+        case FilterOp::IS_NULL:
+            packBits(rows, bits, [&](int64_t i) { return std::isnan(x[i]); });
+            break;
+        case FilterOp::NOT_NULL:
+            packBits(rows, bits, [&](int64_t i) { return !std::isnan(x[i]); });
+            break;
+        default:
+            break;
+    }
+}
+
+void evaluateLongLeaf(const PreparedFilter& prepared, int32_t index, const int64_t* x, int64_t rows,
+                      uint64_t* bits) {
+    const FilterInstruction& ins = prepared.program.instructions[index];
+    const int64_t* constants = prepared.program.longs;
+    const int64_t c = ins.op == FilterOp::IN_SET || ins.op == FilterOp::IS_NULL || ins.op == FilterOp::NOT_NULL
+                      ? 0 : constants[ins.arg];
+    // 每种比较单独一个循环，便于编译器向量化
+    switch (ins.op) {
+        case FilterOp::GT:
+            packBits(rows, bits, [&](int64_t i) { return x[i] != kNullFilterKey && x[i] > c; });
+            break;
+        case FilterOp::GE:
+            packBits(rows, bits, [&](int64_t i) { return x[i] != kNullFilterKey && x[i] >= c; });
+            break;
+        case FilterOp::LT:
+            packBits(rows, bits, [&](int64_t i) { return x[i] != kNullFilterKey && x[i] < c; });
+            break;
+        case FilterOp::LE:
+            packBits(rows, bits, [&](int64_t i) { return x[i] != kNullFilterKey && x[i] <= c; });
+            break;
+        case FilterOp::EQ:
+            packBits(rows, bits, [&](int64_t i) { return x[i] != kNullFilterKey && x[i] == c; });
+            break;
+        case FilterOp::NE:
+            packBits(rows, bits, [&](int64_t i) { return x[i] == kNullFilterKey || x[i] != c; });
+            break;
+        case FilterOp::BETWEEN: {
+            const int64_t high = constants[ins.arg + 1];
+            packBits(rows, bits, [&](int64_t i) { return x[i] != kNullFilterKey && x[i] >= c && x[i] <= high; });
+            break;
+        }
+        case FilterOp::IN_SET: {
+            const std::vector<int64_t>& set = prepared.longSets[index];
+            packBits(rows, bits, [&](int64_t i) { return x[i] != kNullFilterKey && contains(set, x[i]); });
+            break;
+        }
+        case FilterOp::IS_NULL:
+            packBits(rows, bits, [&](int64_t i) { return x[i] == kNullFilterKey; });
+            break;
+        case FilterOp::NOT_NULL:
+            packBits(rows, bits, [&](int64_t i) { return x[i] != kNullFilterKey; });
+            break;
+        default:
+            break;
+    }
+}
+
+// 对 [begin, begin + rows) 行求值整个程序，结果写入 out；stack 至少 (maxDepth + 1) * kFilterBlockWords 个字
+void evaluateBlock(const PreparedFilter& prepared, int64_t begin, int64_t rows, uint64_t* stack, uint64_t* out) {
+    const FilterProgram& program = prepared.program;
+    const int64_t words = wordCount(rows);
+    uint64_t* scratch = stack + static_cast<int64_t>(prepared.maxDepth) * kFilterBlockWords;
+    int32_t depth = 0;
+    for (int32_t i = 0; i < program.instructionCount; i++) {
+        const FilterInstruction& ins = program.instructions[i];
+        if (ins.op == FilterOp::NOT) {
+            uint64_t* top = stack + (depth - 1) * kFilterBlockWords;
+            for (int64_t w = 0; w < words; w++) top[w] = ~top[w];
+            top[words - 1] &= tailMask(rows);
+            continue;
+        }
+        if (ins.op == FilterOp::AND || ins.op == FilterOp::OR) {
+            uint64_t* lhs = stack + (depth - 2) * kFilterBlockWords;
+            const uint64_t* rhs = stack + (depth - 1) * kFilterBlockWords;
+            if (ins.op == FilterOp::AND) {
+                for (int64_t w = 0; w < words; w++) lhs[w] &= rhs[w];
+            } else {
+                for (int64_t w = 0; w < words; w++) lhs[w] |= rhs[w];
+            }
+            depth--;
+            continue;
+        }
+        uint64_t* bits = stack + depth * kFilterBlockWords;
+        const FilterColumn& column = program.columns[ins.column];
+        if (column.type == FilterColumnType::FLOAT64) {
+            evaluateDoubleLeaf(prepared, i, static_cast<const double*>(column.values) + begin, rows, bits, scratch);
+        } else {
+            evaluateLongLeaf(prepared, i, static_cast<const int64_t*>(column.values) + begin, rows, bits);
+        }
+        depth++;
+    }
+    std::copy(stack, stack + words, out);
+}
+
+// 按字切分的并行计划，每段是 kFilterBlockWords 的整数倍
+struct WordPlan {
+    int64_t chunks;
+    int64_t grain;
+};
+
+WordPlan planWords(int64_t n) {
+    const int64_t words = wordCount(n);
+    const int64_t blocks = (words + kFilterBlockWords - 1) / kFilterBlockWords;
+    if (blocks <= 1 || detail::shouldRunSerial(n)) return {1, words};
+    const detail::ChunkPlan plan = detail::planChunks(blocks, ThreadPool::instance().threadCount(), 1);
+    return {plan.chunks, plan.grain * kFilterBlockWords};
+}
+
+// body(chunk, wordBegin, wordEnd)
+template <typename Body>
+void runWordChunks(const WordPlan& plan, int64_t words, Body&& body) {
+    if (plan.chunks == 1) {
+        body(0, 0, words);
+        return;
+    }
+    std::function<void(int64_t)> task = [&](int64_t chunk) {
+        const int64_t lo = chunk * plan.grain;
+        body(chunk, lo, std::min(words, lo + plan.grain));
+    };
+    ThreadPool::instance().run(plan.chunks, task);
+}
+
+} // namespace
+
+bool isValidFilterOp(int32_t op) {
+    return op >= static_cast<int32_t>(FilterOp::GT) && op <= static_cast<int32_t>(FilterOp::NOT);
+}
+
+const char* validateFilter(const FilterProgram& program) {
+    if (program.instructionCount <= 0) return "筛选条件为空";
+    int32_t depth = 0;
+    for (int32_t i = 0; i < program.instructionCount; i++) {
+        const FilterInstruction& ins = program.instructions[i];
+        if (!isValidFilterOp(static_cast<int32_t>(ins.op))) return "不支持的筛选操作";
+        if (ins.op == FilterOp::AND || ins.op == FilterOp::OR) {
+            if (depth < 2) return "筛选指令缺少操作数";
+            depth--;
+            continue;
+        }
+        if (ins.op == FilterOp::NOT) {
+            if (depth < 1) return "筛选指令缺少操作数";
+            continue;
+        }
+        if (ins.column < 0 || ins.column >= program.columnCount) return "筛选列下标越界";
+        const FilterColumn& column = program.columns[ins.column];
+        if (column.type != FilterColumnType::FLOAT64 && column.type != FilterColumnType::INT64) {
+            return "筛选列必须是 double 或 int64";
+        }
+        int64_t needed = 0;
+        switch (ins.op) {
+            case FilterOp::BETWEEN: needed = 2; break;
+            case FilterOp::IN_SET: needed = ins.count; break;
+            case FilterOp::IS_NULL:
+            case FilterOp::NOT_NULL: needed = 0; break;
+            default: needed = 1; break;
+        }
+        if (needed < 0 || (needed > 0 && (ins.arg < 0 || static_cast<int64_t>(ins.arg) + needed > program.constantCount))) {
+            return "筛选常量下标越界";
+        }
+        depth++;
+    }
+    return depth == 1 ? nullptr : "筛选指令没有组合成单个条件";
+}
+
+FilterBlockEvaluator::FilterBlockEvaluator(const FilterProgram& program)
+    : prepared_(new PreparedFilter{program, {}, {}, 0}) {
+    prepare(*prepared_);
+}
+
+FilterBlockEvaluator::~FilterBlockEvaluator() = default;
+
+int64_t FilterBlockEvaluator::stackWords() const {
+    return (prepared_->maxDepth + 1) * kFilterBlockWords;
+}
+
+void FilterBlockEvaluator::evaluate(int64_t begin, int64_t rows, uint64_t* stack, uint64_t* out) const {
+    evaluateBlock(*prepared_, begin, rows, stack, out);
+}
+
+void evaluateFilter(const FilterProgram& program, int64_t n, uint64_t* bits) {
+    if (n <= 0) return;
+    const FilterBlockEvaluator evaluator(program);
+    const int64_t words = wordCount(n);
+    const WordPlan plan = planWords(n);
+    runWordChunks(plan, words, [&](int64_t, int64_t wlo, int64_t whi) {
+        ScratchBuffer<uint64_t> stack(evaluator.stackWords());
+        for (int64_t w = wlo; w < whi; w += kFilterBlockWords) {
+            const int64_t begin = w * 64;
+            const int64_t rows = std::min(n - begin, kFilterBlockWords * 64);
+            evaluator.evaluate(begin, rows, stack.data(), bits + w);
+        }
+    });
+}
+
+std::vector<int32_t> selectedRows(const uint64_t* bits, int64_t n) {
+    const int64_t words = wordCount(n);
+    const WordPlan plan = planWords(n);
+    ScratchBuffer<int64_t> offsets(plan.chunks + 1);
+    std::fill(offsets.begin(), offsets.end(), 0);
+    runWordChunks(plan, words, [&](int64_t chunk, int64_t wlo, int64_t whi) {
+        int64_t count = 0;
+        for (int64_t w = wlo; w < whi; w++) count += __builtin_popcountll(bits[w]);
+        offsets[static_cast<size_t>(chunk) + 1] = count;
+    });
+    for (int64_t c = 1; c < offsets.size(); c++) offsets[c] += offsets[c - 1];
+
+    // 每段从自己的偏移写起，输出保持行号升序
+    std::vector<int32_t> rows(static_cast<size_t>(offsets[plan.chunks]));
+    runWordChunks(plan, words, [&](int64_t chunk, int64_t wlo, int64_t whi) {
+        int32_t* out = rows.data() + offsets[static_cast<size_t>(chunk)];
+        for (int64_t w = wlo; w < whi; w++) {
+            uint64_t word = bits[w];
+            while (word != 0) {
+                *out++ = static_cast<int32_t>(w * 64 + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    });
+    return rows;
+}
+
+int64_t countSelected(const uint64_t* bits, int64_t n) {
+    return parallel_reduce(0, wordCount(n), int64_t(0),
+        [&](int64_t lo, int64_t hi) {
+            int64_t count = 0;
+            for (int64_t w = lo; w < hi; w++) count += __builtin_popcountll(bits[w]);
+            return count;
+        },
+        [](int64_t a, int64_t b) { return a + b; });
+}
+
+void bitmapAnd(const uint64_t* a, const uint64_t* b, uint64_t* out, int64_t n) {
+    parallel_for(0, wordCount(n), [&](int64_t lo, int64_t hi) {
+        for (int64_t w = lo; w < hi; w++) out[w] = a[w] & b[w];
+    });
+}
+
+void bitmapOr(const uint64_t* a, const uint64_t* b, uint64_t* out, int64_t n) {
+    parallel_for(0, wordCount(n), [&](int64_t lo, int64_t hi) {
+        for (int64_t w = lo; w < hi; w++) out[w] = a[w] | b[w];
+    });
+}
+
+void bitmapNot(const uint64_t* a, uint64_t* out, int64_t n) {
+    const int64_t words = wordCount(n);
+    if (words == 0) return;
+    parallel_for(0, words, [&](int64_t lo, int64_t hi) {
+        for (int64_t w = lo; w < hi; w++) out[w] = ~a[w];
+    });
+    out[words - 1] &= tailMask(n);
+}
+
+} // namespace andas
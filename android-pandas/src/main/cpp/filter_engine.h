@@ -0,0 +1,115 @@
+#ifndef ANDAS_FILTER_ENGINE_H
+#define ANDAS_FILTER_ENGINE_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace andas {
+
+// 谓词筛选内核（不依赖JNI）
+// - 条件表达式按后缀（逆波兰）顺序编码为指令序列：叶子指令对一列求值压入一个选择位图，
+//   AND/OR/NOT 弹出操作数并压入结果
+// - 位图布局与 simd::Kernels::compareMask 一致：第 i 行对应 bits[i / 64] 的第 i % 64 位，末尾多余位为 0
+// - 按 kFilterBlockWords 个字（缓存大小）的块求值整个程序，各块在线程池上并行，中间位图不落到整列
+// - 缺失值（double 的 NaN、int64 的 kNullFilterKey）在比较、BETWEEN、IN_SET 中不被选中；
+//   NE 例外，与 pandas 一致，缺失值 != x 为 true
+// - 字符串等列在上层做保序字典编码后按 int64 传入
+
+constexpr int64_t kNullFilterKey = std::numeric_limits<int64_t>::min();
+
+// 每块的字数：4096 行，几个中间位图都能留在 L1
+constexpr int64_t kFilterBlockWords = 64;
+
+// 列类型编码，与 Kotlin 侧一致
+enum class FilterColumnType : int32_t {
+    FLOAT64 = 0,
+    INT64 = 1,
+};
+
+// 指令编码，与 Kotlin 侧 FilterOp.code 保持一致；比较部分与 simd::CompareOp 同序
+enum class FilterOp : int32_t {
+    GT = 0,
+    GE = 1,
+    LT = 2,
+    LE = 3,
+    EQ = 4,
+    NE = 5,
+    BETWEEN = 6,    // constants[arg] <= v <= constants[arg + 1]
+    IN_SET = 7,     // v 属于 constants[arg, arg + count)，count 可以为 0（不选中任何行）
+    IS_NULL = 8,
+    NOT_NULL = 9,
+    AND = 10,
+    OR = 11,
+    NOT = 12,       // 取反，缺失值也会被选中
+};
+
+struct FilterColumn {
+    FilterColumnType type;
+    const void* values;      // double* 或 int64_t*，长度为行数
+};
+
+struct FilterInstruction {
+    FilterOp op;
+    int32_t column;          // 叶子指令的列下标
+    int32_t arg;             // 常量起始下标
+    int32_t count;           // IN_SET 的常量个数
+};
+
+// 常量池：FLOAT64 列的叶子读取 doubles，INT64 列的叶子读取 longs，两者下标相同、长度为 constantCount
+struct FilterProgram {
+    const FilterColumn* columns;
+    int32_t columnCount;
+    const FilterInstruction* instructions;
+    int32_t instructionCount;
+    const double* doubles;
+    const int64_t* longs;
+    int32_t constantCount;
+};
+
+bool isValidFilterOp(int32_t op);
+
+// 检查列下标、常量范围和栈深度，程序必须恰好留下一个位图；不合法时返回说明，合法时返回 nullptr
+const char* validateFilter(const FilterProgram& program);
+
+// 对 n 行求值，bits 至少 (n + 63) / 64 个字；程序必须先通过 validateFilter
+void evaluateFilter(const FilterProgram& program, int64_t n, uint64_t* bits);
+
+namespace detail {
+struct PreparedFilter;
+} // namespace detail
+
+// 逐块求值的筛选器，供融合执行的流水线在每个数据块内直接求值，位图不落到整列
+// 构造时预处理一次（IN_SET 集合排序等），之后可以在多个线程间共享
+class FilterBlockEvaluator {
+public:
+    // 程序必须先通过 validateFilter，且在求值器析构前保持有效
+    explicit FilterBlockEvaluator(const FilterProgram& program);
+    ~FilterBlockEvaluator();
+    FilterBlockEvaluator(const FilterBlockEvaluator&) = delete;
+    FilterBlockEvaluator& operator=(const FilterBlockEvaluator&) = delete;
+
+    // evaluate 需要的临时空间字数，各线程自备
+    int64_t stackWords() const;
+
+    // 对 [begin, begin + rows) 行求值，rows 不超过 kFilterBlockWords * 64，结果写入 out 的前 (rows + 63) / 64 个字
+    void evaluate(int64_t begin, int64_t rows, uint64_t* stack, uint64_t* out) const;
+
+private:
+    std::unique_ptr<detail::PreparedFilter> prepared_;
+};
+
+// 按位图选中的行号，升序
+std::vector<int32_t> selectedRows(const uint64_t* bits, int64_t n);
+
+int64_t countSelected(const uint64_t* bits, int64_t n);
+
+// 整列位图运算，out 可以与输入相同；bitmapNot 清零末尾多余位
+void bitmapAnd(const uint64_t* a, const uint64_t* b, uint64_t* out, int64_t n);
+void bitmapOr(const uint64_t* a, const uint64_t* b, uint64_t* out, int64_t n);
+void bitmapNot(const uint64_t* a, uint64_t* out, int64_t n);
+
+} // namespace andas
+
+#endif //ANDAS_FILTER_ENGINE_H
@@ -0,0 +1,366 @@
+#include "groupby_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "hash_utils.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+bool isValidAggOp(int32_t op) {
+    return op >= static_cast<int32_t>(AggOp::SUM) && op <= static_cast<int32_t>(AggOp::LAST);
+}
+
+namespace {
+
+// 合并阶段按哈希高位分区，各分区互不相交，可以并行合并
+constexpr int kPartitionBits = 6;
+constexpr int64_t kPartitions = int64_t(1) << kPartitionBits;
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+inline int64_t partitionOf(uint64_t hash) {
+    return hashPartition(hash, kPartitionBits);
+}
+
+// 每个值列需要维护哪些统计量，由该列上的聚合请求决定
+struct ColumnNeeds {
+    bool sum = false;       // sum / mean
+    bool moments = false;   // var
+    bool extremes = false;  // min / max
+    bool ends = false;      // first / last
+};
+
+// 单个(分组, 值列)的累加状态
+struct ValueState {
+    int64_t count = 0;
+    double sum = 0.0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = INFINITY;
+    double max = -INFINITY;
+    double first = kNaN;
+    double last = kNaN;
+};
+
+inline void accumulateValue(ValueState& s, double v, const ColumnNeeds& need) {
+    if (std::isnan(v)) return;
+    s.count++;
+    if (need.sum) s.sum += v;
+    if (need.moments) {
+        // Welford 在线更新
+        double delta = v - s.mean;
+        s.mean += delta / static_cast<double>(s.count);
+        s.m2 += delta * (v - s.mean);
+    }
+    if (need.extremes) {
+        if (v < s.min) s.min = v;
+        if (v > s.max) s.max = v;
+    }
+    if (need.ends) {
+        if (s.count == 1) s.first = v;
+        s.last = v;
+    }
+}
+
+// 把 b 合并进 a，要求 b 覆盖的行全部位于 a 之后（first/last 依赖该顺序）
+inline void mergeValue(ValueState& a, const ValueState& b, const ColumnNeeds& need) {
+    if (b.count == 0) return;
+    if (a.count == 0) {
+        a = b;
+        return;
+    }
+    const double na = static_cast<double>(a.count);
+    const double nb = static_cast<double>(b.count);
+    const double total = na + nb;
+    if (need.sum) a.sum += b.sum;
+    if (need.moments) {
+        // Chan 等人的并行方差合并公式
+        double delta = b.mean - a.mean;
+        a.mean += delta * nb / total;
+        a.m2 += b.m2 + delta * delta * na * nb / total;
+    }
+    if (need.extremes) {
+        a.min = std::min(a.min, b.min);
+        a.max = std::max(a.max, b.max);
+    }
+    if (need.ends) a.last = b.last;
+    a.count += b.count;
+}
+
+double finalValue(const ValueState& s, AggOp op) {
+    switch (op) {
+        case AggOp::SUM:   return s.sum;
+        case AggOp::MEAN:  return s.count > 0 ? s.sum / static_cast<double>(s.count) : kNaN;
+        case AggOp::COUNT: return static_cast<double>(s.count);
+        case AggOp::MIN:   return s.count > 0 ? s.min : kNaN;
+        case AggOp::MAX:   return s.count > 0 ? s.max : kNaN;
+        case AggOp::VAR:   return s.count > 1 ? s.m2 / static_cast<double>(s.count - 1) : kNaN;
+        case AggOp::FIRST: return s.first;
+        case AggOp::LAST:  return s.last;
+    }
+    return kNaN;
+}
+
+// 开放寻址（线性探测）哈希表，槽位保存分组编号，分组数据按编号连续存放
+class GroupTable {
+public:
+    GroupTable(int32_t keyColumns, int32_t stateColumns)
+        : keyColumns_(keyColumns), stateColumns_(stateColumns), slots_(64, -1) {}
+
+    int32_t size() const { return static_cast<int32_t>(hashes.size()); }
+
+    const int64_t* key(int32_t group) const {
+        return keys.data() + static_cast<size_t>(group) * keyColumns_;
+    }
+
+    ValueState* states(int32_t group) {
+        return stateData.data() + static_cast<size_t>(group) * stateColumns_;
+    }
+
+    const ValueState* states(int32_t group) const {
+        return stateData.data() + static_cast<size_t>(group) * stateColumns_;
+    }
+
+    // 查找分组，不存在时插入，row 为该分组首次出现的行号
+    int32_t findOrInsert(const int64_t* k, uint64_t hash, int64_t row) {
+        size_t mask = slots_.size() - 1;
+        size_t pos = static_cast<size_t>(hash) & mask;
+        for (;;) {
+            int32_t group = slots_[pos];
+            if (group < 0) break;
+            if (hashes[static_cast<size_t>(group)] == hash && keyEquals(group, k)) return group;
+            pos = (pos + 1) & mask;
+        }
+        int32_t group = size();
+        slots_[pos] = group;
+        hashes.push_back(hash);
+        keys.insert(keys.end(), k, k + keyColumns_);
+        firstRows.push_back(row);
+        sizes.push_back(0);
+        stateData.resize(stateData.size() + static_cast<size_t>(stateColumns_));
+        // 负载因子保持在 1/2 以下
+        if (hashes.size() * 2 > slots_.size()) grow();
+        return group;
+    }
+
+    std::vector<uint64_t> hashes;
+    std::vector<int64_t> keys;
+    std::vector<int64_t> firstRows;
+    std::vector<int64_t> sizes;
+    std::vector<ValueState> stateData;
+
+private:
+    bool keyEquals(int32_t group, const int64_t* k) const {
+        const int64_t* stored = key(group);
+        for (int32_t c = 0; c < keyColumns_; c++) {
+            if (stored[c] != k[c]) return false;
+        }
+        return true;
+    }
+
+    void grow() {
+        std::vector<int32_t> slots(slots_.size() * 2, -1);
+        size_t mask = slots.size() - 1;
+        for (int32_t group = 0; group < size(); group++) {
+            size_t pos = static_cast<size_t>(hashes[static_cast<size_t>(group)]) & mask;
+            while (slots[pos] >= 0) pos = (pos + 1) & mask;
+            slots[pos] = group;
+        }
+        slots_.swap(slots);
+    }
+
+    int32_t keyColumns_;
+    int32_t stateColumns_;
+    std::vector<int32_t> slots_;
+};
+
+// 聚合计划：值列到状态列的映射，以及每个状态列需要的统计量
+struct Plan {
+    const int64_t* const* keys;
+    int32_t keyColumns;
+    std::vector<const double*> stateValues;   // 每个状态列对应的值列
+    std::vector<ColumnNeeds> needs;
+    std::vector<int32_t> specState;           // 每个聚合请求对应的状态列
+};
+
+Plan makePlan(const int64_t* const* keys, int32_t keyColumns,
+              const double* const* values, int32_t valueColumns,
+              const AggSpec* specs, int32_t specCount) {
+    Plan plan;
+    plan.keys = keys;
+    plan.keyColumns = keyColumns;
+    std::vector<int32_t> stateOfColumn(static_cast<size_t>(std::max(valueColumns, 0)), -1);
+    for (int32_t s = 0; s < specCount; s++) {
+        int32_t column = specs[s].column;
+        int32_t& state = stateOfColumn[static_cast<size_t>(column)];
+        if (state < 0) {
+            state = static_cast<int32_t>(plan.stateValues.size());
+            plan.stateValues.push_back(values[column]);
+            plan.needs.emplace_back();
+        }
+        ColumnNeeds& need = plan.needs[static_cast<size_t>(state)];
+        switch (specs[s].op) {
+            case AggOp::SUM:
+            case AggOp::MEAN:  need.sum = true; break;
+            case AggOp::VAR:   need.moments = true; break;
+            case AggOp::MIN:
+            case AggOp::MAX:   need.extremes = true; break;
+            case AggOp::FIRST:
+            case AggOp::LAST:  need.ends = true; break;
+            case AggOp::COUNT: break;
+        }
+        plan.specState.push_back(state);
+    }
+    return plan;
+}
+
+// 单次遍历 [lo, hi) 行，同时更新所有聚合状态
+void accumulateRows(const Plan& plan, GroupTable& table, int64_t lo, int64_t hi) {
+    const int32_t stateColumns = static_cast<int32_t>(plan.stateValues.size());
+    std::vector<int64_t> key(static_cast<size_t>(plan.keyColumns));
+    for (int64_t i = lo; i < hi; i++) {
+        bool missing = false;
+        for (int32_t c = 0; c < plan.keyColumns; c++) {
+            int64_t v = plan.keys[c][i];
+            missing |= (v == kNullGroupKey);
+            key[static_cast<size_t>(c)] = v;
+        }
+        if (missing) continue;
+        uint64_t hash = hashRow(plan.keys, plan.keyColumns, i);
+
+        int32_t group = table.findOrInsert(key.data(), hash, i);
+        table.sizes[static_cast<size_t>(group)]++;
+        ValueState* states = table.states(group);
+        for (int32_t s = 0; s < stateColumns; s++) {
+            accumulateValue(states[s], plan.stateValues[static_cast<size_t>(s)][i],
+                            plan.needs[static_cast<size_t>(s)]);
+        }
+    }
+}
+
+struct GroupRef {
+    int64_t firstRow;
+    int32_t table;
+    int32_t group;
+};
+
+GroupByOutput emit(const Plan& plan, const AggSpec* specs, int32_t specCount,
+                   const std::vector<GroupTable>& tables, const std::vector<GroupRef>& order) {
+    GroupByOutput out;
+    const int64_t groups = static_cast<int64_t>(order.size());
+    out.groupCount = groups;
+    out.keys.assign(static_cast<size_t>(plan.keyColumns), std::vector<int64_t>(static_cast<size_t>(groups)));
+    out.sizes.resize(static_cast<size_t>(groups));
+    out.aggregates.assign(static_cast<size_t>(specCount), std::vector<double>(static_cast<size_t>(groups)));
+
+    parallel_for(0, groups, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) {
+            const GroupRef& ref = order[static_cast<size_t>(i)];
+            const GroupTable& table = tables[static_cast<size_t>(ref.table)];
+            const int64_t* key = table.key(ref.group);
+            for (int32_t c = 0; c < plan.keyColumns; c++) {
+                out.keys[static_cast<size_t>(c)][static_cast<size_t>(i)] = key[c];
+            }
+            out.sizes[static_cast<size_t>(i)] = table.sizes[static_cast<size_t>(ref.group)];
+            const ValueState* states = table.states(ref.group);
+            for (int32_t s = 0; s < specCount; s++) {
+                out.aggregates[static_cast<size_t>(s)][static_cast<size_t>(i)] =
+                    finalValue(states[plan.specState[static_cast<size_t>(s)]], specs[s].op);
+            }
+        }
+    });
+    return out;
+}
+
+} // namespace
+
+GroupByOutput groupByAggregate(const int64_t* const* keys, int32_t keyColumns,
+                               const double* const* values, int32_t valueColumns,
+                               const AggSpec* specs, int32_t specCount, int64_t n) {
+    const Plan plan = makePlan(keys, keyColumns, values, valueColumns, specs, specCount);
+    const int32_t stateColumns = static_cast<int32_t>(plan.stateValues.size());
+    n = std::max<int64_t>(n, 0);
+
+    if (detail::shouldRunSerial(n)) {
+        std::vector<GroupTable> tables(1, GroupTable(keyColumns, stateColumns));
+        accumulateRows(plan, tables[0], 0, n);
+        std::vector<GroupRef> order(static_cast<size_t>(tables[0].size()));
+        for (int32_t g = 0; g < tables[0].size(); g++) {
+            order[static_cast<size_t>(g)] = {tables[0].firstRows[static_cast<size_t>(g)], 0, g};
+        }
+        return emit(plan, specs, specCount, tables, order);
+    }
+
+    ThreadPool& pool = ThreadPool::instance();
+    // 每个线程一个块：块越多，跨块重复出现的分组越多，合并开销越大
+    const int threads = pool.threadCount();
+    const detail::ChunkPlan chunkPlan = detail::planChunks(n, threads, std::max<int64_t>(4096, (n + threads - 1) / threads));
+    const size_t chunks = static_cast<size_t>(chunkPlan.chunks);
+
+    // 1. 各块构建独立的部分表，并把块内分组按哈希分区（分区内保持首次出现顺序）
+    std::vector<GroupTable> partials(chunks, GroupTable(keyColumns, stateColumns));
+    std::vector<std::vector<int32_t>> partitioned(chunks);
+    std::vector<std::vector<int64_t>> offsets(chunks);
+    std::function<void(int64_t)> buildTask = [&](int64_t chunk) {
+        int64_t lo = chunk * chunkPlan.grain;
+        int64_t hi = std::min(n, lo + chunkPlan.grain);
+        GroupTable& table = partials[static_cast<size_t>(chunk)];
+        accumulateRows(plan, table, lo, hi);
+
+        std::vector<int64_t>& offset = offsets[static_cast<size_t>(chunk)];
+        offset.assign(kPartitions + 1, 0);
+        for (uint64_t hash : table.hashes) offset[partitionOf(hash) + 1]++;
+        for (int64_t p = 0; p < kPartitions; p++) offset[p + 1] += offset[p];
+        std::vector<int64_t> cursor(offset.begin(), offset.end() - 1);
+        std::vector<int32_t>& groups = partitioned[static_cast<size_t>(chunk)];
+        groups.resize(static_cast<size_t>(table.size()));
+        for (int32_t g = 0; g < table.size(); g++) {
+            groups[static_cast<size_t>(cursor[partitionOf(table.hashes[static_cast<size_t>(g)])]++)] = g;
+        }
+    };
+    pool.run(chunkPlan.chunks, buildTask);
+
+    // 2. 各分区独立合并，块按行顺序依次并入，保证 first/last 语义
+    std::vector<GroupTable> merged(static_cast<size_t>(kPartitions), GroupTable(keyColumns, stateColumns));
+    std::function<void(int64_t)> mergeTask = [&](int64_t p) {
+        GroupTable& target = merged[static_cast<size_t>(p)];
+        for (size_t c = 0; c < chunks; c++) {
+            const GroupTable& source = partials[c];
+            const std::vector<int64_t>& offset = offsets[c];
+            for (int64_t j = offset[p]; j < offset[p + 1]; j++) {
+                int32_t g = partitioned[c][static_cast<size_t>(j)];
+                int32_t t = target.findOrInsert(source.key(g), source.hashes[static_cast<size_t>(g)],
+                                                source.firstRows[static_cast<size_t>(g)]);
+                target.sizes[static_cast<size_t>(t)] += source.sizes[static_cast<size_t>(g)];
+                ValueState* dst = target.states(t);
+                const ValueState* src = source.states(g);
+                for (int32_t s = 0; s < stateColumns; s++) {
+                    mergeValue(dst[s], src[s], plan.needs[static_cast<size_t>(s)]);
+                }
+            }
+        }
+    };
+    pool.run(kPartitions, mergeTask);
+    partials.clear();
+    partials.shrink_to_fit();
+
+    // 3. 按首次出现的行号恢复全局分组顺序
+    std::vector<GroupRef> order;
+    size_t total = 0;
+    for (const GroupTable& table : merged) total += static_cast<size_t>(table.size());
+    order.reserve(total);
+    for (int32_t p = 0; p < static_cast<int32_t>(kPartitions); p++) {
+        const GroupTable& table = merged[static_cast<size_t>(p)];
+        for (int32_t g = 0; g < table.size(); g++) {
+            order.push_back({table.firstRows[static_cast<size_t>(g)], p, g});
+        }
+    }
+    parallel_sort(order.begin(), order.end(),
+        [](const GroupRef& a, const GroupRef& b) { return a.firstRow < b.firstRow; });
+
+    return emit(plan, specs, specCount, merged, order);
+}
+
+} // namespace andas
@@ -0,0 +1,57 @@
+#ifndef ANDAS_GROUPBY_ENGINE_H
+#define ANDAS_GROUPBY_ENGINE_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace andas {
+
+// 哈希分组聚合内核（不依赖JNI）
+// - 分组键为一个或多个 int64 列；字符串等键在上层做字典编码后传入
+// - 键值为 kNullGroupKey 的行视为缺失，不参与分组（与 pandas dropna=True 一致）
+// - 值列为 double，NaN 视为缺失值，各聚合均跳过 NaN
+// - 各块使用独立的开放寻址哈希表一次遍历完成所有聚合，最后按块顺序合并
+// - 分组按首次出现的顺序输出，结果与线程数无关
+
+constexpr int64_t kNullGroupKey = std::numeric_limits<int64_t>::min();
+
+// 聚合类型编码，与 Kotlin 侧 AggOp.code 保持一致
+enum class AggOp : int32_t {
+    SUM = 0,     // 无有效值时为 0
+    MEAN = 1,    // 无有效值时为 NaN
+    COUNT = 2,   // 有效值个数
+    MIN = 3,
+    MAX = 4,
+    VAR = 5,     // 样本方差 (ddof=1)，有效值不足2个时为 NaN
+    FIRST = 6,   // 第一个有效值
+    LAST = 7,    // 最后一个有效值
+};
+
+bool isValidAggOp(int32_t op);
+
+// 一个聚合请求：对第 column 个值列做 op
+struct AggSpec {
+    int32_t column;
+    AggOp op;
+};
+
+struct GroupByOutput {
+    int64_t groupCount = 0;
+    // 每个键列一个数组，长度 groupCount
+    std::vector<std::vector<int64_t>> keys;
+    // 每组的行数（键完整的行，不论值是否缺失）
+    std::vector<int64_t> sizes;
+    // 每个聚合请求一个数组，长度 groupCount
+    std::vector<std::vector<double>> aggregates;
+};
+
+// keys: keyColumns 个长度为 n 的键列指针
+// values: valueColumns 个长度为 n 的值列指针
+GroupByOutput groupByAggregate(const int64_t* const* keys, int32_t keyColumns,
+                               const double* const* values, int32_t valueColumns,
+                               const AggSpec* specs, int32_t specCount, int64_t n);
+
+} // namespace andas
+
+#endif //ANDAS_GROUPBY_ENGINE_H
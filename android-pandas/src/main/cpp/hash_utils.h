@@ -0,0 +1,51 @@
+#ifndef ANDAS_HASH_UTILS_H
+#define ANDAS_HASH_UTILS_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace andas {
+
+// int64 键和字节串的哈希工具，分组、连接和字符串字典共用
+// 高位用于分区，低位用于表内寻址
+
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// 多列组合键的哈希：keys[c][row]，c < keyColumns
+inline uint64_t hashRow(const int64_t* const* keys, int32_t keyColumns, int64_t row) {
+    uint64_t hash = 0x9e3779b97f4a7c15ULL;
+    for (int32_t c = 0; c < keyColumns; c++) {
+        hash = mix64(hash ^ static_cast<uint64_t>(keys[c][row]));
+    }
+    return hash;
+}
+
+// 字节串的哈希：每 8 字节混合一次，尾部不足 8 字节补 0，长度参与初值
+inline uint64_t hashBytes(const char* data, int64_t length) {
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ static_cast<uint64_t>(length);
+    int64_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = mix64(hash ^ word);
+    }
+    uint64_t tail = 0;
+    if (i < length) std::memcpy(&tail, data + i, static_cast<size_t>(length - i));
+    return mix64(hash ^ tail);
+}
+
+// 取哈希高 bits 位作为分区号，bits 为 0 时只有一个分区
+inline int64_t hashPartition(uint64_t hash, int bits) {
+    return bits == 0 ? 0 : static_cast<int64_t>(hash >> (64 - bits));
+}
+
+} // namespace andas
+
+#endif //ANDAS_HASH_UTILS_H
@@ -0,0 +1,62 @@
+#include "index_engine.h"
+
+#include "hash_utils.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+namespace {
+
+// 槽数取不小于 2n 的 2 的幂，负载因子不超过 1/2
+size_t capacityFor(int64_t n) {
+    size_t capacity = 16;
+    while (capacity < static_cast<size_t>(n) * 2) capacity <<= 1;
+    return capacity;
+}
+
+} // namespace
+
+HashIndex::HashIndex(const int64_t* keys, int64_t n)
+    : slots_(capacityFor(n), Slot{0, -1, -1}), next_(static_cast<size_t>(n), -1) {
+    const size_t mask = slots_.size() - 1;
+    for (int64_t i = 0; i < n; i++) {
+        const int64_t key = keys[i];
+        size_t pos = static_cast<size_t>(mix64(static_cast<uint64_t>(key))) & mask;
+        while (slots_[pos].first >= 0 && slots_[pos].key != key) pos = (pos + 1) & mask;
+        Slot& slot = slots_[pos];
+        const int32_t position = static_cast<int32_t>(i);
+        if (slot.first < 0) {
+            slot = Slot{key, position, position};
+        } else {
+            // 按位置升序遍历，追加到链尾即保持升序
+            next_[static_cast<size_t>(slot.last)] = position;
+            slot.last = position;
+            unique_ = false;
+        }
+    }
+}
+
+int32_t HashIndex::first(int64_t key) const {
+    const size_t mask = slots_.size() - 1;
+    size_t pos = static_cast<size_t>(mix64(static_cast<uint64_t>(key))) & mask;
+    for (;;) {
+        const Slot& slot = slots_[pos];
+        if (slot.first < 0) return -1;
+        if (slot.key == key) return slot.first;
+        pos = (pos + 1) & mask;
+    }
+}
+
+void HashIndex::lookup(const int64_t* probes, int64_t m, int32_t* out) const {
+    parallel_for(0, m, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) out[i] = first(probes[i]);
+    });
+}
+
+void HashIndex::firstPositions(int32_t* out) const {
+    for (const Slot& slot : slots_) {
+        for (int32_t p = slot.first; p >= 0; p = next_[static_cast<size_t>(p)]) out[p] = slot.first;
+    }
+}
+
+} // namespace andas
@@ -0,0 +1,49 @@
+#ifndef ANDAS_INDEX_ENGINE_H
+#define ANDAS_INDEX_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace andas {
+
+// 行索引的哈希表（不依赖JNI）
+// - 键为 int64：Int 标签直接作为键，字符串标签由上层算出 64 位哈希后传入，上层负责核对标签本身
+// - 每个键记录第一次出现的位置，相同键的位置按升序串成链，重复标签的全部位置都能取到
+// - 建好后只读，查找可以并发进行
+class HashIndex {
+public:
+    HashIndex(const int64_t* keys, int64_t n);
+
+    int64_t size() const { return static_cast<int64_t>(next_.size()); }
+
+    // 没有重复的键
+    bool unique() const { return unique_; }
+
+    // 键第一次出现的位置，不存在时为 -1
+    int32_t first(int64_t key) const;
+
+    // 与 position 键相同的下一个位置，没有时为 -1
+    int32_t next(int32_t position) const { return next_[static_cast<size_t>(position)]; }
+
+    // 批量查找：out[i] = first(probes[i])，按块并行
+    void lookup(const int64_t* probes, int64_t m, int32_t* out) const;
+
+    // out[i] = 第 i 个位置的键第一次出现的位置，可作为分组编码
+    void firstPositions(int32_t* out) const;
+
+private:
+    struct Slot {
+        int64_t key;
+        int32_t first;   // -1 表示空槽
+        int32_t last;    // 链尾，建表时追加用
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<int32_t> next_;
+    bool unique_ = true;
+};
+
+} // namespace andas
+
+#endif //ANDAS_INDEX_ENGINE_H
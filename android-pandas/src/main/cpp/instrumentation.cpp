@@ -0,0 +1,372 @@
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+namespace andas {
+namespace stats {
+
+namespace {
+
+struct TraceEvent {
+    int32_t name;
+    int64_t start;
+    int64_t end;
+};
+
+// 线程私有状态：计数只由所属线程写入，快照线程只读
+struct ThreadState {
+    // 按名称编号懒分配，每个 kFieldCount 个计数
+    std::atomic<std::atomic<int64_t>*> counters[kMaxNames];
+    int32_t current = kUnscoped;
+    int64_t tid = 0;
+
+    std::mutex traceMutex;
+    std::vector<TraceEvent> events;
+    int64_t dropped = 0;
+    std::string threadName;
+
+    ThreadState() {
+        for (auto& c : counters) c.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~ThreadState() {
+        for (auto& c : counters) delete[] c.load(std::memory_order_relaxed);
+    }
+};
+
+struct RetiredTrace {
+    int64_t tid;
+    std::string threadName;
+    std::vector<TraceEvent> events;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::string> names = {"(unscoped)", "JNI.marshal"};
+    std::vector<ThreadState*> threads;
+    int64_t nextTid = 1;
+    // 已退出线程的计数之和，以及 reset 时记录的基线
+    std::vector<int64_t> retired = std::vector<int64_t>(static_cast<size_t>(kMaxNames) * kFieldCount, 0);
+    std::vector<int64_t> baseline = std::vector<int64_t>(static_cast<size_t>(kMaxNames) * kFieldCount, 0);
+    std::vector<RetiredTrace> retiredTraces;
+    int64_t traceDropped = 0;
+};
+
+Registry& registry() {
+    // 进程生命周期内常驻，线程在静态析构之后退出时仍可访问
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+std::atomic<bool> gEnabled{true};
+std::atomic<bool> gTracing{false};
+std::atomic<int64_t> gTraceEpoch{0};
+std::atomic<int64_t> gTraceCapacity{0};
+
+void retire(ThreadState* state) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (int32_t name = 0; name < kMaxNames; name++) {
+        const std::atomic<int64_t>* c = state->counters[name].load(std::memory_order_acquire);
+        if (c == nullptr) continue;
+        int64_t* out = &r.retired[static_cast<size_t>(name) * kFieldCount];
+        for (int32_t f = 0; f < kFieldCount; f++) out[f] += c[f].load(std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> traceLock(state->traceMutex);
+        if (!state->events.empty()) {
+            r.retiredTraces.push_back(RetiredTrace{state->tid, state->threadName, std::move(state->events)});
+        }
+        r.traceDropped += state->dropped;
+    }
+    r.threads.erase(std::remove(r.threads.begin(), r.threads.end(), state), r.threads.end());
+    delete state;
+}
+
+struct ThreadHolder {
+    ThreadState* state = nullptr;
+    ~ThreadHolder() {
+        if (state != nullptr) retire(state);
+    }
+};
+
+thread_local ThreadHolder tlsHolder;
+
+ThreadState& threadState() {
+    ThreadState* state = tlsHolder.state;
+    if (state == nullptr) {
+        state = new ThreadState();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        state->tid = r.nextTid++;
+        r.threads.push_back(state);
+        tlsHolder.state = state;
+    }
+    return *state;
+}
+
+std::atomic<int64_t>* countersFor(ThreadState& state, int32_t name) {
+    std::atomic<int64_t>* c = state.counters[name].load(std::memory_order_relaxed);
+    if (c == nullptr) {
+        c = new std::atomic<int64_t>[kFieldCount]();
+        state.counters[name].store(c, std::memory_order_release);
+    }
+    return c;
+}
+
+// 单写者计数：不需要原子读改写
+inline void bump(std::atomic<int64_t>& counter, int64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void pushEvent(ThreadState& state, int32_t name, int64_t start, int64_t end) {
+    std::lock_guard<std::mutex> lock(state.traceMutex);
+    if (static_cast<int64_t>(state.events.size()) >= gTraceCapacity.load(std::memory_order_relaxed)) {
+        state.dropped++;
+        return;
+    }
+    // 开始追踪之前进入的作用域从追踪起点算起
+    state.events.push_back(TraceEvent{name, std::max(start, gTraceEpoch.load(std::memory_order_relaxed)), end});
+}
+
+// 调用方持有 registry().mutex
+std::vector<int64_t> totalsLocked(Registry& r) {
+    std::vector<int64_t> totals = r.retired;
+    for (ThreadState* state : r.threads) {
+        for (int32_t name = 0; name < kMaxNames; name++) {
+            const std::atomic<int64_t>* c = state->counters[name].load(std::memory_order_acquire);
+            if (c == nullptr) continue;
+            int64_t* out = &totals[static_cast<size_t>(name) * kFieldCount];
+            for (int32_t f = 0; f < kFieldCount; f++) out[f] += c[f].load(std::memory_order_relaxed);
+        }
+    }
+    return totals;
+}
+
+void appendEscaped(std::string& out, const std::string& s) {
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+}
+
+void appendThreadName(std::string& out, bool& first, int64_t tid, const std::string& name) {
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lld,\"args\":{\"name\":\"",
+                  first ? "" : ",", static_cast<long long>(tid));
+    first = false;
+    out += buf;
+    if (name.empty()) {
+        out += "thread-" + std::to_string(tid);
+    } else {
+        appendEscaped(out, name);
+    }
+    out += "\"}}";
+}
+
+void appendEvents(std::string& out, bool& first, int64_t tid, const std::vector<TraceEvent>& events,
+                  const std::vector<std::string>& names, int64_t epoch) {
+    for (const TraceEvent& e : events) {
+        out += first ? "\n{\"name\":\"" : ",\n{\"name\":\"";
+        first = false;
+        appendEscaped(out, names[static_cast<size_t>(e.name)]);
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), "\",\"cat\":\"andas\",\"ph\":\"X\",\"pid\":1,\"tid\":%lld,\"ts\":%.3f,\"dur\":%.3f}",
+                      static_cast<long long>(tid), static_cast<double>(e.start - epoch) / 1e3,
+                      static_cast<double>(std::max<int64_t>(0, e.end - e.start)) / 1e3);
+        out += buf;
+    }
+}
+
+} // namespace
+
+int32_t registerName(const char* name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (size_t i = 0; i < r.names.size(); i++) {
+        if (r.names[i] == name) return static_cast<int32_t>(i);
+    }
+    if (static_cast<int32_t>(r.names.size()) >= kMaxNames) return kUnscoped;
+    r.names.emplace_back(name);
+    return static_cast<int32_t>(r.names.size() - 1);
+}
+
+std::vector<std::string> names() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.names;
+}
+
+bool enabled() {
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+void setEnabled(bool value) {
+    gEnabled.store(value, std::memory_order_relaxed);
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int32_t latencyBucket(int64_t ns) {
+    if (ns < 2) return 0;
+    const int32_t bucket = 63 - __builtin_clzll(static_cast<unsigned long long>(ns));
+    return std::min(bucket, kLatencyBuckets - 1);
+}
+
+std::vector<int64_t> snapshot() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<int64_t> totals = totalsLocked(r);
+    totals.resize(r.names.size() * kFieldCount);
+    for (size_t i = 0; i < totals.size(); i++) totals[i] -= r.baseline[i];
+    return totals;
+}
+
+void reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.baseline = totalsLocked(r);
+}
+
+void recordArray(int64_t bytes, bool copied, bool input) {
+    if (!enabled()) return;
+    ThreadState& state = threadState();
+    std::atomic<int64_t>* c = countersFor(state, state.current);
+    if (input) bump(c[BYTES_IN], bytes);
+    if (copied) {
+        bump(c[COPIED], 1);
+        bump(c[COPIED_BYTES], bytes);
+    } else {
+        bump(c[PINNED], 1);
+    }
+}
+
+void recordDirect(int64_t bytes) {
+    if (!enabled()) return;
+    ThreadState& state = threadState();
+    std::atomic<int64_t>* c = countersFor(state, state.current);
+    bump(c[BYTES_IN], bytes);
+    bump(c[DIRECT], 1);
+}
+
+void recordBytesOut(int64_t bytes, bool copied) {
+    if (!enabled()) return;
+    ThreadState& state = threadState();
+    std::atomic<int64_t>* c = countersFor(state, state.current);
+    bump(c[BYTES_OUT], bytes);
+    if (copied) {
+        bump(c[COPIED], 1);
+        bump(c[COPIED_BYTES], bytes);
+    }
+}
+
+void recordMarshal(int64_t startNs, int64_t endNs) {
+    ThreadState& state = threadState();
+    bump(countersFor(state, state.current)[MARSHAL_NS], endNs - startNs);
+    if (gTracing.load(std::memory_order_relaxed)) pushEvent(state, kMarshalSpan, startNs, endNs);
+}
+
+KernelScope::KernelScope(int32_t name) : name_(-1), previous_(kUnscoped), start_(0) {
+    if (!enabled()) return;
+    ThreadState& state = threadState();
+    name_ = name;
+    previous_ = state.current;
+    state.current = name;
+    start_ = nowNs();
+}
+
+KernelScope::~KernelScope() {
+    if (name_ < 0) return;
+    const int64_t end = nowNs();
+    const int64_t elapsed = end - start_;
+    ThreadState& state = threadState();
+    state.current = previous_;
+    std::atomic<int64_t>* c = countersFor(state, name_);
+    bump(c[CALLS], 1);
+    bump(c[TOTAL_NS], elapsed);
+    bump(c[LATENCY + latencyBucket(elapsed)], 1);
+    if (gTracing.load(std::memory_order_relaxed)) pushEvent(state, name_, start_, end);
+}
+
+TraceSpan::TraceSpan(int32_t name) : name_(-1), start_(0) {
+    if (!gTracing.load(std::memory_order_relaxed)) return;
+    name_ = name;
+    start_ = nowNs();
+}
+
+TraceSpan::~TraceSpan() {
+    if (name_ < 0) return;
+    const int64_t end = nowNs();
+    if (gTracing.load(std::memory_order_relaxed)) pushEvent(threadState(), name_, start_, end);
+}
+
+void setThreadName(const char* name) {
+    ThreadState& state = threadState();
+    std::lock_guard<std::mutex> lock(state.traceMutex);
+    state.threadName = name;
+}
+
+void startTrace(int64_t eventsPerThread) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    gTracing.store(false, std::memory_order_relaxed);
+    for (ThreadState* state : r.threads) {
+        std::lock_guard<std::mutex> traceLock(state->traceMutex);
+        state->events.clear();
+        state->dropped = 0;
+    }
+    r.retiredTraces.clear();
+    r.traceDropped = 0;
+    gTraceCapacity.store(std::max<int64_t>(0, eventsPerThread), std::memory_order_relaxed);
+    gTraceEpoch.store(nowNs(), std::memory_order_relaxed);
+    gTracing.store(true, std::memory_order_release);
+}
+
+bool tracing() {
+    return gTracing.load(std::memory_order_relaxed);
+}
+
+std::string stopTrace() {
+    gTracing.store(false, std::memory_order_release);
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const int64_t epoch = gTraceEpoch.load(std::memory_order_relaxed);
+
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    int64_t dropped = r.traceDropped;
+    for (const RetiredTrace& t : r.retiredTraces) {
+        appendThreadName(out, first, t.tid, t.threadName);
+        appendEvents(out, first, t.tid, t.events, r.names, epoch);
+    }
+    for (ThreadState* state : r.threads) {
+        std::lock_guard<std::mutex> traceLock(state->traceMutex);
+        if (state->events.empty() && state->dropped == 0) continue;
+        appendThreadName(out, first, state->tid, state->threadName);
+        appendEvents(out, first, state->tid, state->events, r.names, epoch);
+        dropped += state->dropped;
+        state->events.clear();
+        state->events.shrink_to_fit();
+        state->dropped = 0;
+    }
+    r.retiredTraces.clear();
+    r.traceDropped = 0;
+    out += "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":" + std::to_string(dropped) + "}}\n";
+    return out;
+}
+
+} // namespace stats
+} // namespace andas
@@ -0,0 +1,118 @@
+#ifndef ANDAS_INSTRUMENTATION_H
+#define ANDAS_INSTRUMENTATION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace andas {
+namespace stats {
+
+// 原生热路径埋点（不依赖JNI）
+// - 每个内核（JNI 入口）一组计数：调用次数、总耗时、JNI 数据转换耗时、输入/输出字节数、
+//   数组是固定(pin)还是拷贝、DirectByteBuffer 访问次数，以及按 2 的幂分桶的耗时直方图
+// - 计数写在线程私有的槽位里，只有所属线程写入，不需要原子读改写；快照时汇总所有线程，
+//   线程退出时把计数并入全局
+// - reset 只记录当时的快照作为基线，之后的快照减去基线，不修改其他线程的计数
+// - 可选的追踪：记录各作用域的起止时间，导出为 Chrome trace-event JSON
+//   （chrome://tracing 或 Perfetto 打开）；每个线程最多保留固定条数，多出的计入 dropped
+
+constexpr int32_t kMaxNames = 256;
+// 第 b 个桶为 [2^b, 2^(b+1)) 纳秒，第 0 个桶包含 0 和 1；最后一个桶包含更长的耗时
+constexpr int32_t kLatencyBuckets = 40;
+
+// 每个内核的计数字段，快照中按此顺序排列，与 Kotlin 侧 NativeStats 保持一致
+enum Field : int32_t {
+    CALLS = 0,
+    TOTAL_NS = 1,
+    MARSHAL_NS = 2,      // Java 数组的获取/释放/区域拷贝耗时，计算耗时 = TOTAL_NS - MARSHAL_NS
+    BYTES_IN = 3,        // 从 Java 侧读取的字节数
+    BYTES_OUT = 4,       // 写回 Java 侧的字节数
+    PINNED = 5,          // Get*ArrayElements 直接返回堆内地址的次数
+    COPIED = 6,          // 需要拷贝的次数（isCopy 为真，以及 Get/Set*ArrayRegion）
+    COPIED_BYTES = 7,
+    DIRECT = 8,          // DirectByteBuffer 零拷贝访问次数
+    LATENCY = 9,         // 之后 kLatencyBuckets 个字段为耗时直方图
+};
+constexpr int32_t kFieldCount = LATENCY + kLatencyBuckets;
+
+// 预留的名称编号
+constexpr int32_t kUnscoped = 0;     // 不在任何内核作用域内发生的数据转换
+constexpr int32_t kMarshalSpan = 1;  // 追踪中的数据转换区间
+
+// 注册名称并返回编号，同名返回同一编号；超过 kMaxNames 时返回 kUnscoped
+int32_t registerName(const char* name);
+std::vector<std::string> names();
+
+// 关闭后作用域和计数都不做任何事，默认开启
+bool enabled();
+void setEnabled(bool value);
+
+int64_t nowNs();
+int32_t latencyBucket(int64_t ns);
+
+// 自上次 reset 以来的计数，names().size() * kFieldCount 个值，编号 i 的内核从 i * kFieldCount 开始
+std::vector<int64_t> snapshot();
+void reset();
+
+// 计入当前线程最内层的内核作用域，不在作用域内时计入 kUnscoped
+// input 为 false 表示新建的输出数组，只统计固定/拷贝，不计入输入字节数
+void recordArray(int64_t bytes, bool copied, bool input = true);
+void recordDirect(int64_t bytes);
+void recordBytesOut(int64_t bytes, bool copied);
+void recordMarshal(int64_t startNs, int64_t endNs);
+
+// 内核作用域：析构时计入调用次数、耗时和直方图，可以嵌套
+class KernelScope {
+public:
+    explicit KernelScope(int32_t name);
+    ~KernelScope();
+    KernelScope(const KernelScope&) = delete;
+    KernelScope& operator=(const KernelScope&) = delete;
+
+private:
+    int32_t name_;
+    int32_t previous_;
+    int64_t start_;
+};
+
+// 数据转换计时：析构时计入当前内核的 MARSHAL_NS
+class MarshalTimer {
+public:
+    MarshalTimer() : start_(enabled() ? nowNs() : -1) {}
+    ~MarshalTimer() {
+        if (start_ >= 0) recordMarshal(start_, nowNs());
+    }
+    MarshalTimer(const MarshalTimer&) = delete;
+    MarshalTimer& operator=(const MarshalTimer&) = delete;
+
+private:
+    int64_t start_;
+};
+
+// 只在追踪开启时记录的区间，不影响计数
+class TraceSpan {
+public:
+    explicit TraceSpan(int32_t name);
+    ~TraceSpan();
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    int32_t name_;
+    int64_t start_;
+};
+
+// 当前线程在追踪中显示的名称
+void setThreadName(const char* name);
+
+// 开始追踪并清空之前的事件，eventsPerThread 为每个线程保留的最多事件数
+void startTrace(int64_t eventsPerThread);
+bool tracing();
+// 停止追踪，返回 Chrome trace-event JSON
+std::string stopTrace();
+
+} // namespace stats
+} // namespace andas
+
+#endif //ANDAS_INSTRUMENTATION_H
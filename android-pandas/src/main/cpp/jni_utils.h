@@ -0,0 +1,204 @@
+#ifndef ANDAS_JNI_UTILS_H
+#define ANDAS_JNI_UTILS_H
+
+#include <jni.h>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <exception>
+#include <vector>
+#include "instrumentation.h"
+
+namespace andas {
+
+// 抛出指定类型的 Java 异常，调用方随后应立即返回
+inline void throwJavaException(JNIEnv* env, const char* className, const char* message) {
+    jclass cls = env->FindClass(className);
+    if (cls != nullptr) env->ThrowNew(cls, message);
+}
+
+// 抛出 IllegalArgumentException，调用方随后应立即返回
+inline void throwIllegalArgument(JNIEnv* env, const char* message) {
+    throwJavaException(env, "java/lang/IllegalArgumentException", message);
+}
+
+// 获取 DirectByteBuffer 的数据地址，并校验容量至少能容纳 length 个 T
+// 校验失败时抛出异常并返回 nullptr
+template <typename T>
+T* directBufferAddress(JNIEnv* env, jobject buffer, int64_t length) {
+    if (buffer == nullptr || length < 0) {
+        throwIllegalArgument(env, "无效的原生列缓冲区");
+        return nullptr;
+    }
+    void* address = env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (address == nullptr || capacity < 0 ||
+        static_cast<uint64_t>(capacity) < static_cast<uint64_t>(length) * sizeof(T)) {
+        throwIllegalArgument(env, "原生列缓冲区不是DirectByteBuffer或容量不足");
+        return nullptr;
+    }
+    stats::recordDirect(length * static_cast<int64_t>(sizeof(T)));
+    return static_cast<T*>(address);
+}
+
+// JNI 入口的内核作用域，名称形如 "NativeData.groupByAggregate"，见 instrumentation.h
+#define ANDAS_JNI_SCOPE(name) \
+    static const int32_t andasScopeName = ::andas::stats::registerName(name); \
+    ::andas::stats::KernelScope andasScope(andasScopeName)
+
+// Java 基本类型数组的访问，按数组类型选择对应的 JNI 函数
+template <typename Array>
+struct JniArray;
+
+#define ANDAS_JNI_ARRAY(ArrayType, ElementType, Name)                                                  \
+    template <>                                                                                        \
+    struct JniArray<ArrayType> {                                                                       \
+        using Element = ElementType;                                                                   \
+        static Element* get(JNIEnv* env, ArrayType array, jboolean* isCopy) {                          \
+            return env->Get##Name##ArrayElements(array, isCopy);                                       \
+        }                                                                                              \
+        static void release(JNIEnv* env, ArrayType array, Element* elements, jint mode) {              \
+            env->Release##Name##ArrayElements(array, elements, mode);                                  \
+        }                                                                                              \
+        static void getRegion(JNIEnv* env, ArrayType array, jsize start, jsize length, Element* out) { \
+            env->Get##Name##ArrayRegion(array, start, length, out);                                    \
+        }                                                                                              \
+        static void setRegion(JNIEnv* env, ArrayType array, jsize start, jsize length,                 \
+                              const Element* in) {                                                     \
+            env->Set##Name##ArrayRegion(array, start, length, in);                                     \
+        }                                                                                              \
+    };
+
+ANDAS_JNI_ARRAY(jbooleanArray, jboolean, Boolean)
+ANDAS_JNI_ARRAY(jbyteArray, jbyte, Byte)
+ANDAS_JNI_ARRAY(jintArray, jint, Int)
+ANDAS_JNI_ARRAY(jlongArray, jlong, Long)
+ANDAS_JNI_ARRAY(jdoubleArray, jdouble, Double)
+
+#undef ANDAS_JNI_ARRAY
+
+namespace detail {
+
+// 当前线程通过 getArrayElements 取得、还未释放的数组；JNI 入口因原生异常提前退出时由 ANDAS_JNI_CATCH
+// 以 JNI_ABORT 释放，避免数组一直被固定或拷贝泄漏
+struct HeldArray {
+    jarray array;
+    void* elements;
+    void (*release)(JNIEnv*, jarray, void*, jint);
+};
+
+inline std::vector<HeldArray>& heldArrays() {
+    thread_local std::vector<HeldArray> held;
+    return held;
+}
+
+template <typename Array>
+void releaseHeld(JNIEnv* env, jarray array, void* elements, jint mode) {
+    JniArray<Array>::release(env, static_cast<Array>(array),
+                             static_cast<typename JniArray<Array>::Element*>(elements), mode);
+}
+
+inline void forgetHeld(const void* elements) {
+    std::vector<HeldArray>& held = heldArrays();
+    for (size_t i = held.size(); i-- > 0;) {
+        if (held[i].elements == elements) {
+            held.erase(held.begin() + static_cast<std::ptrdiff_t>(i));
+            return;
+        }
+    }
+}
+
+} // namespace detail
+
+// 以下包装与对应的 JNI 函数语义相同，另外把耗时、字节数以及数组是被固定还是被拷贝（isCopy）
+// 计入当前内核；关闭统计时只多一次标志检查
+
+// output 为 true 表示刚创建、只用于写出结果的数组，不计入输入字节数
+template <typename Array>
+typename JniArray<Array>::Element* getArrayElements(JNIEnv* env, Array array, bool output = false) {
+    stats::MarshalTimer timer;
+    jboolean isCopy = JNI_FALSE;
+    typename JniArray<Array>::Element* elements = JniArray<Array>::get(env, array, &isCopy);
+    if (elements == nullptr) return nullptr;
+    if (stats::enabled()) {
+        stats::recordArray(static_cast<int64_t>(env->GetArrayLength(array)) * sizeof(*elements), isCopy == JNI_TRUE,
+                           !output);
+    }
+    try {
+        detail::heldArrays().push_back(detail::HeldArray{array, elements, &detail::releaseHeld<Array>});
+    } catch (...) {
+        JniArray<Array>::release(env, array, elements, JNI_ABORT);
+        throw;
+    }
+    return elements;
+}
+
+// mode 不是 JNI_ABORT 时写回的数据计入输出字节数
+template <typename Array>
+void releaseArrayElements(JNIEnv* env, Array array, typename JniArray<Array>::Element* elements, jint mode) {
+    stats::MarshalTimer timer;
+    if (mode != JNI_ABORT && stats::enabled()) {
+        stats::recordBytesOut(static_cast<int64_t>(env->GetArrayLength(array)) * sizeof(*elements), false);
+    }
+    detail::forgetHeld(elements);
+    JniArray<Array>::release(env, array, elements, mode);
+}
+
+// 区域访问总是拷贝
+template <typename Array>
+void getArrayRegion(JNIEnv* env, Array array, jsize start, jsize length, typename JniArray<Array>::Element* out) {
+    stats::MarshalTimer timer;
+    JniArray<Array>::getRegion(env, array, start, length, out);
+    stats::recordArray(static_cast<int64_t>(length) * sizeof(*out), true);
+}
+
+template <typename Array>
+void setArrayRegion(JNIEnv* env, Array array, jsize start, jsize length,
+                    const typename JniArray<Array>::Element* in) {
+    stats::MarshalTimer timer;
+    JniArray<Array>::setRegion(env, array, start, length, in);
+    stats::recordBytesOut(static_cast<int64_t>(length) * sizeof(*in), true);
+}
+
+// GetPrimitiveArrayCritical 的包装，bytes 为调用方将要读取的字节数
+inline void* getPrimitiveArrayCritical(JNIEnv* env, jarray array, int64_t bytes) {
+    stats::MarshalTimer timer;
+    jboolean isCopy = JNI_FALSE;
+    void* elements = env->GetPrimitiveArrayCritical(array, &isCopy);
+    if (elements != nullptr) stats::recordArray(bytes, isCopy == JNI_TRUE);
+    return elements;
+}
+
+// 在 catch 中调用：释放当前线程仍持有的数组，把正在处理的原生异常转为 Java 异常
+// 内存不足（包括超出 NativeRuntime.setMemoryLimit 的预算）为 OutOfMemoryError，其他为 RuntimeException
+inline void rethrowAsJava(JNIEnv* env) {
+    std::vector<detail::HeldArray>& held = detail::heldArrays();
+    while (!held.empty()) {
+        const detail::HeldArray h = held.back();
+        held.pop_back();
+        h.release(env, h.array, h.elements, JNI_ABORT);
+    }
+    if (env->ExceptionCheck()) return;
+    try {
+        throw;
+    } catch (const std::bad_alloc& e) {
+        throwJavaException(env, "java/lang/OutOfMemoryError", e.what());
+    } catch (const std::exception& e) {
+        throwJavaException(env, "java/lang/RuntimeException", e.what());
+    } catch (...) {
+        throwJavaException(env, "java/lang/RuntimeException", "未知的原生异常");
+    }
+}
+
+// JNI 入口写成函数 try 块，原生异常转为 Java 异常后返回 fallback，而不是终止进程：
+//   Java_..._method(JNIEnv* env, ...) try { ... } ANDAS_JNI_CATCH(env, nullptr)
+// 返回 void 的入口省略 fallback
+#define ANDAS_JNI_CATCH(env, ...)        \
+    catch (...) {                        \
+        ::andas::rethrowAsJava(env);     \
+        return __VA_ARGS__;              \
+    }
+
+} // namespace andas
+
+#endif //ANDAS_JNI_UTILS_H
@@ -0,0 +1,258 @@
+#include "join_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "hash_utils.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+bool isValidJoinType(int32_t type) {
+    return type >= static_cast<int32_t>(JoinType::INNER) && type <= static_cast<int32_t>(JoinType::ANTI);
+}
+
+namespace {
+
+// 每个分区的目标行数：分区的行号、哈希和槽位约 200KB，能放进 L2 缓存
+constexpr int64_t kPartitionRows = 8192;
+constexpr int kMaxPartitionBits = 10;
+
+// 参与并行的块数，数据量小时只用一个块
+int64_t chunkCountFor(int64_t n) {
+    if (detail::shouldRunSerial(n)) return 1;
+    return detail::planChunks(n, ThreadPool::instance().threadCount(), 4096).chunks;
+}
+
+inline int64_t chunkBegin(int64_t n, int64_t chunks, int64_t chunk) {
+    return n * chunk / chunks;
+}
+
+// 基数分区后的构建侧哈希表
+// rows/hashes 按分区重排，分区内保持原行顺序；next 把同键的行串成升序链表
+class PartitionedTable {
+public:
+    PartitionedTable(const int64_t* const* keys, int32_t keyColumns, int64_t n)
+        : keys_(keys), keyColumns_(keyColumns), n_(n) {
+        while (bits_ < kMaxPartitionBits && (n >> bits_) > kPartitionRows) bits_++;
+        partitions_ = int64_t(1) << bits_;
+        partition();
+        build();
+    }
+
+    int64_t size() const { return n_; }
+    int32_t rowAt(int32_t pos) const { return rows_[static_cast<size_t>(pos)]; }
+    int32_t nextAt(int32_t pos) const { return next_[static_cast<size_t>(pos)]; }
+
+    // 查找与 probeKeys[.][row] 相同的键，返回链表头位置，不存在返回 -1
+    int32_t find(const int64_t* const* probeKeys, int64_t row, uint64_t hash) const {
+        const int64_t p = hashPartition(hash, bits_);
+        const size_t base = static_cast<size_t>(slotStart_[p]);
+        const size_t mask = static_cast<size_t>(slotStart_[p + 1] - slotStart_[p]) - 1;
+        size_t slot = static_cast<size_t>(hash) & mask;
+        for (;;) {
+            int32_t pos = slots_[base + slot];
+            if (pos < 0) return -1;
+            if (hashes_[static_cast<size_t>(pos)] == hash && keysEqual(rowAt(pos), probeKeys, row)) return pos;
+            slot = (slot + 1) & mask;
+        }
+    }
+
+private:
+    bool keysEqual(int64_t buildRow, const int64_t* const* probeKeys, int64_t probeRow) const {
+        for (int32_t c = 0; c < keyColumns_; c++) {
+            if (keys_[c][buildRow] != probeKeys[c][probeRow]) return false;
+        }
+        return true;
+    }
+
+    // 分块统计各分区行数，再按 (分区, 块) 顺序稳定地散布行号
+    void partition() {
+        const int64_t chunks = chunkCountFor(n_);
+        const size_t P = static_cast<size_t>(partitions_);
+        std::vector<uint64_t> rowHash(static_cast<size_t>(n_));
+        std::vector<int64_t> offsets(static_cast<size_t>(chunks) * P, 0);
+
+        std::function<void(int64_t)> countTask = [&](int64_t chunk) {
+            int64_t* count = offsets.data() + static_cast<size_t>(chunk) * P;
+            for (int64_t i = chunkBegin(n_, chunks, chunk); i < chunkBegin(n_, chunks, chunk + 1); i++) {
+                uint64_t hash = hashRow(keys_, keyColumns_, i);
+                rowHash[static_cast<size_t>(i)] = hash;
+                count[hashPartition(hash, bits_)]++;
+            }
+        };
+        ThreadPool::instance().run(chunks, countTask);
+
+        partStart_.assign(P + 1, 0);
+        int64_t running = 0;
+        for (size_t p = 0; p < P; p++) {
+            partStart_[p] = running;
+            for (int64_t c = 0; c < chunks; c++) {
+                int64_t& slot = offsets[static_cast<size_t>(c) * P + p];
+                int64_t count = slot;
+                slot = running;
+                running += count;
+            }
+        }
+        partStart_[P] = running;
+
+        rows_.resize(static_cast<size_t>(n_));
+        hashes_.resize(static_cast<size_t>(n_));
+        std::function<void(int64_t)> scatterTask = [&](int64_t chunk) {
+            int64_t* cursor = offsets.data() + static_cast<size_t>(chunk) * P;
+            for (int64_t i = chunkBegin(n_, chunks, chunk); i < chunkBegin(n_, chunks, chunk + 1); i++) {
+                uint64_t hash = rowHash[static_cast<size_t>(i)];
+                size_t pos = static_cast<size_t>(cursor[hashPartition(hash, bits_)]++);
+                rows_[pos] = static_cast<int32_t>(i);
+                hashes_[pos] = hash;
+            }
+        };
+        ThreadPool::instance().run(chunks, scatterTask);
+    }
+
+    // 各分区独立建表：槽位数为不小于 2 倍行数的 2 的幂
+    void build() {
+        const size_t P = static_cast<size_t>(partitions_);
+        slotStart_.assign(P + 1, 0);
+        for (size_t p = 0; p < P; p++) {
+            int64_t count = partStart_[p + 1] - partStart_[p];
+            int64_t capacity = 2;
+            while (capacity < count * 2) capacity <<= 1;
+            slotStart_[p + 1] = slotStart_[p] + capacity;
+        }
+        slots_.assign(static_cast<size_t>(slotStart_[P]), -1);
+        next_.assign(static_cast<size_t>(n_), -1);
+
+        std::function<void(int64_t)> buildTask = [&](int64_t p) {
+            const size_t base = static_cast<size_t>(slotStart_[p]);
+            const size_t mask = static_cast<size_t>(slotStart_[p + 1] - slotStart_[p]) - 1;
+            // 逆序插入，链表头始终是行号最小的位置，遍历链表即为升序
+            for (int64_t pos = partStart_[p + 1] - 1; pos >= partStart_[p]; pos--) {
+                const uint64_t hash = hashes_[static_cast<size_t>(pos)];
+                const int32_t row = rows_[static_cast<size_t>(pos)];
+                size_t slot = static_cast<size_t>(hash) & mask;
+                for (;;) {
+                    int32_t head = slots_[base + slot];
+                    if (head < 0) break;
+                    if (hashes_[static_cast<size_t>(head)] == hash && keysEqual(rowAt(head), keys_, row)) {
+                        next_[static_cast<size_t>(pos)] = head;
+                        break;
+                    }
+                    slot = (slot + 1) & mask;
+                }
+                slots_[base + slot] = static_cast<int32_t>(pos);
+            }
+        };
+        if (detail::shouldRunSerial(n_)) {
+            for (int64_t p = 0; p < partitions_; p++) buildTask(p);
+        } else {
+            ThreadPool::instance().run(partitions_, buildTask);
+        }
+    }
+
+    const int64_t* const* keys_;
+    int32_t keyColumns_;
+    int64_t n_;
+    int bits_ = 0;
+    int64_t partitions_ = 1;
+    std::vector<int32_t> rows_;
+    std::vector<uint64_t> hashes_;
+    std::vector<int32_t> next_;
+    std::vector<int64_t> partStart_;
+    std::vector<int64_t> slotStart_;
+    std::vector<int32_t> slots_;
+};
+
+// 按块顺序拼接各块的局部结果，拷贝并行进行
+void concatChunks(const std::vector<std::vector<int32_t>>& parts, std::vector<int32_t>& out) {
+    std::vector<size_t> offsets(parts.size() + 1, 0);
+    for (size_t c = 0; c < parts.size(); c++) offsets[c + 1] = offsets[c] + parts[c].size();
+    out.resize(offsets.back());
+    std::function<void(int64_t)> copyTask = [&](int64_t c) {
+        const std::vector<int32_t>& part = parts[static_cast<size_t>(c)];
+        std::copy(part.begin(), part.end(), out.begin() + static_cast<std::ptrdiff_t>(offsets[static_cast<size_t>(c)]));
+    };
+    if (detail::shouldRunSerial(static_cast<int64_t>(out.size()))) {
+        for (size_t c = 0; c < parts.size(); c++) copyTask(static_cast<int64_t>(c));
+    } else {
+        ThreadPool::instance().run(static_cast<int64_t>(parts.size()), copyTask);
+    }
+}
+
+// 以 build 为构建侧、probe 为探测侧执行连接，输出 (probe 行号, build 行号)
+// type 只取 INNER/LEFT/OUTER/SEMI/ANTI，RIGHT 由调用方交换两侧实现
+void probeJoin(const PartitionedTable& table,
+               const int64_t* const* probeKeys, int64_t probeRows, int32_t keyColumns,
+               JoinType type, std::vector<int32_t>& probeOut, std::vector<int32_t>& buildOut) {
+    const bool keepUnmatched = type == JoinType::LEFT || type == JoinType::OUTER;
+    const bool pairs = type != JoinType::SEMI && type != JoinType::ANTI;
+
+    std::unique_ptr<std::atomic<uint8_t>[]> matched;
+    if (type == JoinType::OUTER) {
+        matched.reset(new std::atomic<uint8_t>[static_cast<size_t>(table.size())]());
+    }
+
+    const int64_t chunks = chunkCountFor(probeRows);
+    std::vector<std::vector<int32_t>> probeParts(static_cast<size_t>(chunks));
+    std::vector<std::vector<int32_t>> buildParts(static_cast<size_t>(chunks));
+    std::function<void(int64_t)> probeTask = [&](int64_t chunk) {
+        std::vector<int32_t>& probeLocal = probeParts[static_cast<size_t>(chunk)];
+        std::vector<int32_t>& buildLocal = buildParts[static_cast<size_t>(chunk)];
+        for (int64_t i = chunkBegin(probeRows, chunks, chunk); i < chunkBegin(probeRows, chunks, chunk + 1); i++) {
+            const int32_t row = static_cast<int32_t>(i);
+            const int32_t head = table.find(probeKeys, i, hashRow(probeKeys, keyColumns, i));
+            if (!pairs) {
+                if ((head >= 0) == (type == JoinType::SEMI)) probeLocal.push_back(row);
+                continue;
+            }
+            if (head < 0) {
+                if (keepUnmatched) {
+                    probeLocal.push_back(row);
+                    buildLocal.push_back(-1);
+                }
+                continue;
+            }
+            for (int32_t pos = head; pos >= 0; pos = table.nextAt(pos)) {
+                const int32_t buildRow = table.rowAt(pos);
+                probeLocal.push_back(row);
+                buildLocal.push_back(buildRow);
+                if (matched) matched[static_cast<size_t>(buildRow)].store(1, std::memory_order_relaxed);
+            }
+        }
+    };
+    ThreadPool::instance().run(chunks, probeTask);
+
+    concatChunks(probeParts, probeOut);
+    if (pairs) concatChunks(buildParts, buildOut);
+
+    if (matched) {
+        for (int64_t j = 0; j < table.size(); j++) {
+            if (!matched[static_cast<size_t>(j)].load(std::memory_order_relaxed)) {
+                probeOut.push_back(-1);
+                buildOut.push_back(static_cast<int32_t>(j));
+            }
+        }
+    }
+}
+
+} // namespace
+
+JoinOutput hashJoin(const int64_t* const* leftKeys, int64_t leftRows,
+                    const int64_t* const* rightKeys, int64_t rightRows,
+                    int32_t keyColumns, JoinType type) {
+    JoinOutput out;
+    leftRows = std::max<int64_t>(leftRows, 0);
+    rightRows = std::max<int64_t>(rightRows, 0);
+    if (type == JoinType::RIGHT) {
+        // 右连接 = 以左表为构建侧、按右表顺序做左连接
+        PartitionedTable table(leftKeys, keyColumns, leftRows);
+        probeJoin(table, rightKeys, rightRows, keyColumns, JoinType::LEFT, out.right, out.left);
+    } else {
+        PartitionedTable table(rightKeys, keyColumns, rightRows);
+        probeJoin(table, leftKeys, leftRows, keyColumns, type, out.left, out.right);
+    }
+    return out;
+}
+
+} // namespace andas
@@ -0,0 +1,43 @@
+#ifndef ANDAS_JOIN_ENGINE_H
+#define ANDAS_JOIN_ENGINE_H
+
+#include <cstdint>
+#include <vector>
+
+namespace andas {
+
+// 哈希连接内核（不依赖JNI）
+// - 连接键为一个或多个 int64 列，按精确相等匹配；字符串、浮点等键在上层做字典编码
+// - 构建侧按哈希高位做基数分区，每个分区大小接近缓存容量，各分区并行建表
+// - 探测侧分块并行，结果按块顺序拼接，输出顺序与线程数无关
+
+// 连接类型编码，与 Kotlin 侧 JoinType.code 保持一致
+enum class JoinType : int32_t {
+    INNER = 0,
+    LEFT = 1,
+    RIGHT = 2,
+    OUTER = 3,
+    SEMI = 4,   // 左表中有匹配的行
+    ANTI = 5,   // 左表中没有匹配的行
+};
+
+bool isValidJoinType(int32_t type);
+
+// 输出行号对，-1 表示该侧没有对应行
+// 输出顺序:
+// - inner/left: 按左表顺序，同一左行的多个匹配按右表顺序
+// - right: 按右表顺序，同一右行的多个匹配按左表顺序
+// - outer: 先按 left 的顺序输出，再按右表顺序追加未匹配的右行
+// - semi/anti: 只输出 left（按左表顺序），right 为空
+struct JoinOutput {
+    std::vector<int32_t> left;
+    std::vector<int32_t> right;
+};
+
+JoinOutput hashJoin(const int64_t* const* leftKeys, int64_t leftRows,
+                    const int64_t* const* rightKeys, int64_t rightRows,
+                    int32_t keyColumns, JoinType type);
+
+} // namespace andas
+
+#endif //ANDAS_JOIN_ENGINE_H
@@ -0,0 +1,132 @@
+#include "math_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "moments.h"
+#include "simd_kernels.h"
+#include "sort_engine.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+namespace {
+
+// 部分结果: (最小值, 最大值, 有效计数)
+struct Extremes {
+    double min = INFINITY;
+    double max = -INFINITY;
+    int64_t count = 0;
+};
+
+Extremes validExtremes(const double* x, int64_t n) {
+    const simd::Kernels& k = simd::active();
+    return parallel_reduce(0, n, Extremes(),
+        [&](int64_t lo, int64_t hi) {
+            Extremes local;
+            local.count = k.nanMinMax(x + lo, hi - lo, &local.min, &local.max);
+            return local;
+        },
+        [](Extremes a, Extremes b) {
+            if (b.count == 0) return a;
+            if (a.count == 0) return b;
+            a.min = std::min(a.min, b.min);
+            a.max = std::max(a.max, b.max);
+            a.count += b.count;
+            return a;
+        });
+}
+
+} // namespace
+
+double sum(const double* x, int64_t n) {
+    return computeMoments(x, n, MomentOrder::MEAN).total();
+}
+
+double mean(const double* x, int64_t n) {
+    MomentAccumulator m = computeMoments(x, n, MomentOrder::MEAN);
+    return m.count > 0 ? m.total() / static_cast<double>(m.count) : 0.0;
+}
+
+double max(const double* x, int64_t n) {
+    Extremes e = validExtremes(x, n);
+    return e.count > 0 ? e.max : std::numeric_limits<double>::quiet_NaN();
+}
+
+double min(const double* x, int64_t n) {
+    Extremes e = validExtremes(x, n);
+    return e.count > 0 ? e.min : std::numeric_limits<double>::quiet_NaN();
+}
+
+double variance(const double* x, int64_t n, int64_t ddof) {
+    return computeMoments(x, n, MomentOrder::VARIANCE).variance(ddof);
+}
+
+double dot(const double* a, const double* b, int64_t n) {
+    const simd::Kernels& k = simd::active();
+    return parallel_reduce(0, n, 0.0,
+        [&](int64_t lo, int64_t hi) { return k.dot(a + lo, b + lo, hi - lo); },
+        [](double l, double r) { return l + r; });
+}
+
+double norm(const double* x, int64_t n) {
+    return std::sqrt(dot(x, x, n));
+}
+
+void multiplyScalar(const double* x, double multiplier, double* out, int64_t n) {
+    const simd::Kernels& k = simd::active();
+    parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+        k.scale(x + lo, multiplier, out + lo, hi - lo);
+    });
+}
+
+void add(const double* a, const double* b, double* out, int64_t n) {
+    const simd::Kernels& k = simd::active();
+    parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+        k.add(a + lo, b + lo, out + lo, hi - lo);
+    });
+}
+
+void multiply(const double* a, const double* b, double* out, int64_t n) {
+    const simd::Kernels& k = simd::active();
+    parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+        k.multiply(a + lo, b + lo, out + lo, hi - lo);
+    });
+}
+
+void normalize(const double* x, double* out, int64_t n) {
+    // 总体标准差 (ddof=0)
+    MomentAccumulator m = computeMoments(x, n, MomentOrder::VARIANCE);
+    double mu = m.count > 0 ? m.mean : 0.0;
+    double sd = m.count > 0 ? m.stddev(0) : 0.0;
+    parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) {
+            out[i] = sd > 0 ? (x[i] - mu) / sd : 0.0;
+        }
+    });
+}
+
+void greaterThan(const double* x, double threshold, uint8_t* out, int64_t n) {
+    const simd::Kernels& k = simd::active();
+    parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+        k.compareBytes(x + lo, hi - lo, threshold, simd::CompareOp::GT, out + lo);
+    });
+}
+
+void compareToBitmask(const double* x, double threshold, simd::CompareOp op, uint64_t* bits, int64_t n) {
+    // 按字（64个元素）划分任务，块边界对齐到字，各块写入互不重叠
+    const simd::Kernels& k = simd::active();
+    const int64_t words = (n + 63) / 64;
+    parallel_for(0, words, [&](int64_t lo, int64_t hi) {
+        int64_t begin = lo * 64;
+        int64_t end = std::min(n, hi * 64);
+        k.compareMask(x + begin, end - begin, threshold, op, bits + lo);
+    }, 64);
+}
+
+void argsort(const double* x, int32_t* out, int64_t n) {
+    // 稳定基数排序，NaN 排在最后
+    sortIndices(x, n, false, false, out);
+}
+
+} // namespace andas
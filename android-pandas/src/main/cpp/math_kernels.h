@@ -0,0 +1,36 @@
+#ifndef ANDAS_MATH_KERNELS_H
+#define ANDAS_MATH_KERNELS_H
+
+#include <cstdint>
+#include "simd_kernels.h"
+
+namespace andas {
+
+// 数值计算内核（不依赖JNI）
+// 输入为连续的 double 数组，可以来自 Java 数组或原生列缓冲区
+// NaN 视为缺失值：归约类函数（sum/mean/max/min/variance）跳过 NaN
+// mean/variance/normalize 基于 moments.h 的矩累加器
+
+double sum(const double* x, int64_t n);
+double mean(const double* x, int64_t n);          // 无有效值时返回 0
+double max(const double* x, int64_t n);           // 无有效值时返回 NaN
+double min(const double* x, int64_t n);           // 无有效值时返回 NaN
+double variance(const double* x, int64_t n, int64_t ddof);  // 自由度 count - ddof，有效值不超过 ddof 个时返回 NaN
+double dot(const double* a, const double* b, int64_t n);
+double norm(const double* x, int64_t n);
+
+// 逐元素运算，out 可以与输入相同（原地计算）
+void multiplyScalar(const double* x, double multiplier, double* out, int64_t n);
+void add(const double* a, const double* b, double* out, int64_t n);
+void multiply(const double* a, const double* b, double* out, int64_t n);
+void normalize(const double* x, double* out, int64_t n);
+void greaterThan(const double* x, double threshold, uint8_t* out, int64_t n);
+// 比较结果写成位图，bits 至少 (n + 63) / 64 个字，布局见 simd::Kernels::compareMask
+void compareToBitmask(const double* x, double threshold, simd::CompareOp op, uint64_t* bits, int64_t n);
+
+// 升序稳定排序索引，NaN 排在最后（见 sort_engine.h）
+void argsort(const double* x, int32_t* out, int64_t n);
+
+} // namespace andas
+
+#endif //ANDAS_MATH_KERNELS_H
@@ -3,181 +3,110 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
-#include <functional>
 #include <limits>
-#include <omp.h>
+#include "math_kernels.h"
+#include "moments.h"
+#include "rolling_engine.h"
+#include "memory_pool.h"
+#include "jni_utils.h"
 
 #define LOG_TAG "AndasMath"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 
 // 高性能数学运算库
+// 计算逻辑在 math_kernels.cpp 中，这里只负责 Java 数组/原生列缓冲区与指针之间的转换
+
 extern "C" JNIEXPORT jdoubleArray JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_multiplyDoubleArray(
         JNIEnv* env,
         jobject /* this */,
         jdoubleArray array,
         jdouble multiplier
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.multiplyDoubleArray");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
+    jdouble* elements = andas::getArrayElements(env, array);
 
     jdoubleArray result = env->NewDoubleArray(length);
-    jdouble* resultElements = env->GetDoubleArrayElements(result, nullptr);
+    jdouble* resultElements = andas::getArrayElements(env, result, true);
 
-    #pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        resultElements[i] = elements[i] * multiplier;
-    }
+    andas::multiplyScalar(elements, multiplier, resultElements, length);
 
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(result, resultElements, 0);
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+    andas::releaseArrayElements(env, result, resultElements, 0);
 
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
 
 extern "C" JNIEXPORT jdouble JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_sumDoubleArray(
         JNIEnv* env,
         jobject /* this */,
         jdoubleArray array
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.sumDoubleArray");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
+    jdouble* elements = andas::getArrayElements(env, array);
 
-    double sum = 0.0;
-    #pragma omp parallel for reduction(+:sum)
-    for (int i = 0; i < length; i++) {
-        sum += elements[i];
-    }
+    double sum = andas::sum(elements, length);
 
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
     return sum;
-}
+} ANDAS_JNI_CATCH(env, 0)
 
 extern "C" JNIEXPORT jdouble JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_meanDoubleArray(
         JNIEnv* env,
         jobject /* this */,
         jdoubleArray array
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.meanDoubleArray");
     jsize length = env->GetArrayLength(array);
     if (length == 0) return 0.0;
 
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
-
-    double sum = 0.0;
-    int count = 0;
-    #pragma omp parallel
-    {
-        double local_sum = 0.0;
-        int local_count = 0;
-        
-        #pragma omp for nowait
-        for (int i = 0; i < length; i++) {
-            if (!std::isnan(elements[i])) {
-                local_sum += elements[i];
-                local_count++;
-            }
-        }
-        
-        #pragma omp critical
-        {
-            sum += local_sum;
-            count += local_count;
-        }
-    }
+    jdouble* elements = andas::getArrayElements(env, array);
 
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-    return count > 0 ? sum / count : 0.0;
-}
+    double mean = andas::mean(elements, length);
+
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+    return mean;
+} ANDAS_JNI_CATCH(env, 0)
 
 extern "C" JNIEXPORT jdouble JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_maxDoubleArray(
         JNIEnv* env,
         jobject /* this */,
         jdoubleArray array
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.maxDoubleArray");
     jsize length = env->GetArrayLength(array);
     if (length == 0) return std::numeric_limits<double>::quiet_NaN();
 
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
-
-    double max_val = std::numeric_limits<double>::lowest();
-    bool foundValid = false;
-    
-    #pragma omp parallel
-    {
-        double local_max = std::numeric_limits<double>::lowest();
-        bool local_found = false;
-        
-        #pragma omp for nowait
-        for (int i = 0; i < length; i++) {
-            if (!std::isnan(elements[i])) {
-                if (!local_found || elements[i] > local_max) {
-                    local_max = elements[i];
-                    local_found = true;
-                }
-            }
-        }
-        
-        #pragma omp critical
-        {
-            if (local_found) {
-                if (!foundValid || local_max > max_val) {
-                    max_val = local_max;
-                    foundValid = true;
-                }
-            }
-        }
-    }
+    jdouble* elements = andas::getArrayElements(env, array);
 
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-    return foundValid ? max_val : std::numeric_limits<double>::quiet_NaN();
-}
+    double max_val = andas::max(elements, length);
+
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+    return max_val;
+} ANDAS_JNI_CATCH(env, 0)
 
 extern "C" JNIEXPORT jdouble JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_minDoubleArray(
         JNIEnv* env,
         jobject /* this */,
         jdoubleArray array
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.minDoubleArray");
     jsize length = env->GetArrayLength(array);
     if (length == 0) return std::numeric_limits<double>::quiet_NaN();
 
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
-
-    double min_val = std::numeric_limits<double>::max();
-    bool foundValid = false;
-    
-    #pragma omp parallel
-    {
-        double local_min = std::numeric_limits<double>::max();
-        bool local_found = false;
-        
-        #pragma omp for nowait
-        for (int i = 0; i < length; i++) {
-            if (!std::isnan(elements[i])) {
-                if (!local_found || elements[i] < local_min) {
-                    local_min = elements[i];
-                    local_found = true;
-                }
-            }
-        }
-        
-        #pragma omp critical
-        {
-            if (local_found) {
-                if (!foundValid || local_min < min_val) {
-                    min_val = local_min;
-                    foundValid = true;
-                }
-            }
-        }
-    }
+    jdouble* elements = andas::getArrayElements(env, array);
 
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-    return foundValid ? min_val : std::numeric_limits<double>::quiet_NaN();
-}
+    double min_val = andas::min(elements, length);
+
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+    return min_val;
+} ANDAS_JNI_CATCH(env, 0)
 
 extern "C" JNIEXPORT jdoubleArray JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_vectorizedAdd(
@@ -185,30 +114,28 @@ Java_cn_ac_oac_libs_andas_core_NativeMath_vectorizedAdd(
         jobject /* this */,
         jdoubleArray a,
         jdoubleArray b
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.vectorizedAdd");
     jsize length = env->GetArrayLength(a);
     if (length != env->GetArrayLength(b)) {
         return nullptr;
     }
 
-    jdouble* elementsA = env->GetDoubleArrayElements(a, nullptr);
-    jdouble* elementsB = env->GetDoubleArrayElements(b, nullptr);
+    jdouble* elementsA = andas::getArrayElements(env, a);
+    jdouble* elementsB = andas::getArrayElements(env, b);
 
     jdoubleArray result = env->NewDoubleArray(length);
-    jdouble* resultElements = env->GetDoubleArrayElements(result, nullptr);
+    jdouble* resultElements = andas::getArrayElements(env, result, true);
 
     // 向量化加法
-    #pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        resultElements[i] = elementsA[i] + elementsB[i];
-    }
+    andas::add(elementsA, elementsB, resultElements, length);
 
-    env->ReleaseDoubleArrayElements(a, elementsA, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(b, elementsB, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(result, resultElements, 0);
+    andas::releaseArrayElements(env, a, elementsA, JNI_ABORT);
+    andas::releaseArrayElements(env, b, elementsB, JNI_ABORT);
+    andas::releaseArrayElements(env, result, resultElements, 0);
 
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
 
 extern "C" JNIEXPORT jdoubleArray JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_vectorizedMultiply(
@@ -216,30 +143,28 @@ Java_cn_ac_oac_libs_andas_core_NativeMath_vectorizedMultiply(
         jobject /* this */,
         jdoubleArray a,
         jdoubleArray b
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.vectorizedMultiply");
     jsize length = env->GetArrayLength(a);
     if (length != env->GetArrayLength(b)) {
         return nullptr;
     }
 
-    jdouble* elementsA = env->GetDoubleArrayElements(a, nullptr);
-    jdouble* elementsB = env->GetDoubleArrayElements(b, nullptr);
+    jdouble* elementsA = andas::getArrayElements(env, a);
+    jdouble* elementsB = andas::getArrayElements(env, b);
 
     jdoubleArray result = env->NewDoubleArray(length);
-    jdouble* resultElements = env->GetDoubleArrayElements(result, nullptr);
+    jdouble* resultElements = andas::getArrayElements(env, result, true);
 
     // 向量化乘法
-    #pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        resultElements[i] = elementsA[i] * elementsB[i];
-    }
+    andas::multiply(elementsA, elementsB, resultElements, length);
 
-    env->ReleaseDoubleArrayElements(a, elementsA, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(b, elementsB, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(result, resultElements, 0);
+    andas::releaseArrayElements(env, a, elementsA, JNI_ABORT);
+    andas::releaseArrayElements(env, b, elementsB, JNI_ABORT);
+    andas::releaseArrayElements(env, result, resultElements, 0);
 
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
 
 extern "C" JNIEXPORT jdouble JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_dotProduct(
@@ -247,120 +172,104 @@ Java_cn_ac_oac_libs_andas_core_NativeMath_dotProduct(
         jobject /* this */,
         jdoubleArray a,
         jdoubleArray b
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.dotProduct");
     jsize length = env->GetArrayLength(a);
     if (length != env->GetArrayLength(b)) {
         return 0.0;
     }
 
-    jdouble* elementsA = env->GetDoubleArrayElements(a, nullptr);
-    jdouble* elementsB = env->GetDoubleArrayElements(b, nullptr);
+    jdouble* elementsA = andas::getArrayElements(env, a);
+    jdouble* elementsB = andas::getArrayElements(env, b);
 
-    double dot = 0.0;
-    #pragma omp parallel for reduction(+:dot)
-    for (int i = 0; i < length; i++) {
-        dot += elementsA[i] * elementsB[i];
-    }
+    double dot = andas::dot(elementsA, elementsB, length);
 
-    env->ReleaseDoubleArrayElements(a, elementsA, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(b, elementsB, JNI_ABORT);
+    andas::releaseArrayElements(env, a, elementsA, JNI_ABORT);
+    andas::releaseArrayElements(env, b, elementsB, JNI_ABORT);
 
     return dot;
-}
+} ANDAS_JNI_CATCH(env, 0)
 
 extern "C" JNIEXPORT jdouble JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_norm(
         JNIEnv* env,
         jobject /* this */,
         jdoubleArray array
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.norm");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
+    jdouble* elements = andas::getArrayElements(env, array);
 
-    double sumSq = 0.0;
-    #pragma omp parallel for reduction(+:sumSq)
-    for (int i = 0; i < length; i++) {
-        sumSq += elements[i] * elements[i];
-    }
+    double norm = andas::norm(elements, length);
 
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-    return std::sqrt(sumSq);
-}
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+    return norm;
+} ANDAS_JNI_CATCH(env, 0)
 
 extern "C" JNIEXPORT jdoubleArray JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_normalize(
         JNIEnv* env,
         jobject /* this */,
         jdoubleArray array
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.normalize");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
+    jdouble* elements = andas::getArrayElements(env, array);
 
-    // 计算均值和标准差
-    double sum = 0.0;
-    double sumSq = 0.0;
+    // 归一化
+    jdoubleArray result = env->NewDoubleArray(length);
+    jdouble* resultElements = andas::getArrayElements(env, result, true);
 
-    #pragma omp parallel for reduction(+:sum,sumSq)
-    for (int i = 0; i < length; i++) {
-        sum += elements[i];
-        sumSq += elements[i] * elements[i];
-    }
+    andas::normalize(elements, resultElements, length);
 
-    double mean = sum / length;
-    double variance = (sumSq / length) - (mean * mean);
-    double std = std::sqrt(std::max(variance, 0.0));
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+    andas::releaseArrayElements(env, result, resultElements, 0);
 
-    // 归一化
-    jdoubleArray result = env->NewDoubleArray(length);
-    jdouble* resultElements = env->GetDoubleArrayElements(result, nullptr);
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
 
-    #pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        resultElements[i] = std > 0 ? (elements[i] - mean) / std : 0.0;
-    }
+// 统计函数：返回打包的矩累加器 [count, sum, mean, m2, m3, m4, min, max]（见 moments.h），
+// 方差、偏度、峰度以及与其他批次的合并在 Kotlin 侧 MomentAccumulator 中完成
+namespace {
 
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(result, resultElements, 0);
+bool isValidMomentOrder(jint order) {
+    return order == static_cast<jint>(andas::MomentOrder::MEAN) ||
+           order == static_cast<jint>(andas::MomentOrder::VARIANCE) ||
+           order == static_cast<jint>(andas::MomentOrder::SHAPE);
+}
 
+jdoubleArray packedMoments(JNIEnv* env, const double* x, int64_t n, jint order) {
+    const andas::MomentAccumulator m = andas::computeMoments(x, n, static_cast<andas::MomentOrder>(order));
+    double packed[andas::MomentAccumulator::kPackedSize];
+    m.pack(packed);
+    jdoubleArray result = env->NewDoubleArray(andas::MomentAccumulator::kPackedSize);
+    if (result == nullptr) return nullptr;
+    andas::setArrayRegion(env, result, 0, andas::MomentAccumulator::kPackedSize, packed);
     return result;
 }
 
-// 统计函数
-extern "C" JNIEXPORT jdouble JNICALL
-Java_cn_ac_oac_libs_andas_core_NativeMath_variance(
+} // namespace
+
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_moments(
         JNIEnv* env,
         jobject /* this */,
-        jdoubleArray array
-) {
-    jsize length = env->GetArrayLength(array);
-    if (length <= 1) return 0.0;
-
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
-
-    double sum = 0.0;
-    double sumSq = 0.0;
-
-    #pragma omp parallel for reduction(+:sum,sumSq)
-    for (int i = 0; i < length; i++) {
-        sum += elements[i];
-        sumSq += elements[i] * elements[i];
+        jdoubleArray array,
+        jint order
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.moments");
+    if (!isValidMomentOrder(order)) {
+        andas::throwIllegalArgument(env, "无效的矩阶数");
+        return nullptr;
     }
+    jsize length = env->GetArrayLength(array);
+    jdouble* elements = andas::getArrayElements(env, array);
 
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-
-    double mean = sum / length;
-    return (sumSq / length) - (mean * mean);
-}
+    jdoubleArray result = packedMoments(env, elements, length, order);
 
-extern "C" JNIEXPORT jdouble JNICALL
-Java_cn_ac_oac_libs_andas_core_NativeMath_std(
-        JNIEnv* env,
-        jobject /* this */,
-        jdoubleArray array
-) {
-    double var = Java_cn_ac_oac_libs_andas_core_NativeMath_variance(env, nullptr, array);
-    return std::sqrt(std::max(var, 0.0));
-}
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
 
 // 排序和索引
 extern "C" JNIEXPORT jintArray JNICALL
@@ -368,27 +277,21 @@ Java_cn_ac_oac_libs_andas_core_NativeMath_argsort(
         JNIEnv* env,
         jobject /* this */,
         jdoubleArray array
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.argsort");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
-
-    std::vector<int> indices(length);
-    #pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        indices[i] = i;
-    }
+    jdouble* elements = andas::getArrayElements(env, array);
 
-    // 使用标准排序算法，不使用并行排序以确保兼容性
-    std::sort(indices.begin(), indices.end(),
-              [&](int a, int b) { return elements[a] < elements[b]; });
+    andas::ScratchBuffer<int32_t> indices(length);
+    andas::argsort(elements, indices.data(), length);
 
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
 
     jintArray result = env->NewIntArray(length);
-    env->SetIntArrayRegion(result, 0, length, indices.data());
+    andas::setArrayRegion(env, result, 0, length, indices.data());
 
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
 
 // 布尔运算
 extern "C" JNIEXPORT jbooleanArray JNICALL
@@ -397,20 +300,262 @@ Java_cn_ac_oac_libs_andas_core_NativeMath_greaterThan(
         jobject /* this */,
         jdoubleArray array,
         jdouble threshold
-) {
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.greaterThan");
     jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
+    jdouble* elements = andas::getArrayElements(env, array);
 
     jbooleanArray result = env->NewBooleanArray(length);
-    jboolean* resultElements = env->GetBooleanArrayElements(result, nullptr);
+    jboolean* resultElements = andas::getArrayElements(env, result, true);
+
+    andas::greaterThan(elements, threshold, resultElements, length);
+
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+    andas::releaseArrayElements(env, result, resultElements, 0);
+
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
 
-    #pragma omp parallel for
-    for (int i = 0; i < length; i++) {
-        resultElements[i] = elements[i] > threshold;
+// 滑动窗口：计算第 [from, to) 行的结果，窗口可以使用 [0, from) 和 [to, n) 的值
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_rolling(
+        JNIEnv* env,
+        jobject /* this */,
+        jdoubleArray array,
+        jint op,
+        jint window,
+        jint minPeriods,
+        jboolean center,
+        jboolean expanding,
+        jint from,
+        jint to
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.rolling");
+    jsize length = env->GetArrayLength(array);
+    if (!andas::isValidRollingOp(op)) {
+        andas::throwIllegalArgument(env, "未知的滑动窗口聚合类型");
+        return nullptr;
     }
+    if ((!expanding && window < 1) || minPeriods < 0 || from < 0 || to < from || to > length) {
+        andas::throwIllegalArgument(env, "无效的滑动窗口参数");
+        return nullptr;
+    }
+
+    jdoubleArray result = env->NewDoubleArray(to - from);
+    if (result == nullptr) return nullptr;
+    jdouble* elements = andas::getArrayElements(env, array);
+    jdouble* resultElements = andas::getArrayElements(env, result, true);
 
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-    env->ReleaseBooleanArrayElements(result, resultElements, 0);
+    const andas::RollingWindow spec{window, minPeriods, center == JNI_TRUE, expanding == JNI_TRUE};
+    andas::rolling(elements, length, static_cast<andas::RollingOp>(op), spec, from, to, resultElements);
+
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+    andas::releaseArrayElements(env, result, resultElements, 0);
 
     return result;
-}
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// ==================== 原生列（DirectByteBuffer）版本 ====================
+// 直接在堆外缓冲区上计算，不复制输入；逐元素运算写入调用方提供的输出列
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_multiplyColumn(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject buffer,
+        jobject out,
+        jint length,
+        jdouble multiplier
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.multiplyColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    double* resultElements = andas::directBufferAddress<double>(env, out, length);
+    if (elements == nullptr || resultElements == nullptr) return;
+    andas::multiplyScalar(elements, multiplier, resultElements, length);
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT jdouble JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_sumColumn(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject buffer,
+        jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.sumColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return 0.0;
+    return andas::sum(elements, length);
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT jdouble JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_meanColumn(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject buffer,
+        jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.meanColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return 0.0;
+    return andas::mean(elements, length);
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT jdouble JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_maxColumn(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject buffer,
+        jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.maxColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return std::numeric_limits<double>::quiet_NaN();
+    return andas::max(elements, length);
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT jdouble JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_minColumn(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject buffer,
+        jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.minColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return std::numeric_limits<double>::quiet_NaN();
+    return andas::min(elements, length);
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_addColumns(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject a,
+        jobject b,
+        jobject out,
+        jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.addColumns");
+    const double* elementsA = andas::directBufferAddress<double>(env, a, length);
+    const double* elementsB = andas::directBufferAddress<double>(env, b, length);
+    double* resultElements = andas::directBufferAddress<double>(env, out, length);
+    if (elementsA == nullptr || elementsB == nullptr || resultElements == nullptr) return;
+    andas::add(elementsA, elementsB, resultElements, length);
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_multiplyColumns(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject a,
+        jobject b,
+        jobject out,
+        jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.multiplyColumns");
+    const double* elementsA = andas::directBufferAddress<double>(env, a, length);
+    const double* elementsB = andas::directBufferAddress<double>(env, b, length);
+    double* resultElements = andas::directBufferAddress<double>(env, out, length);
+    if (elementsA == nullptr || elementsB == nullptr || resultElements == nullptr) return;
+    andas::multiply(elementsA, elementsB, resultElements, length);
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT jdouble JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_dotColumns(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject a,
+        jobject b,
+        jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.dotColumns");
+    const double* elementsA = andas::directBufferAddress<double>(env, a, length);
+    const double* elementsB = andas::directBufferAddress<double>(env, b, length);
+    if (elementsA == nullptr || elementsB == nullptr) return 0.0;
+    return andas::dot(elementsA, elementsB, length);
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT jdouble JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_normColumn(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject buffer,
+        jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.normColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return 0.0;
+    return andas::norm(elements, length);
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_normalizeColumn(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject buffer,
+        jobject out,
+        jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.normalizeColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    double* resultElements = andas::directBufferAddress<double>(env, out, length);
+    if (elements == nullptr || resultElements == nullptr) return;
+    andas::normalize(elements, resultElements, length);
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_momentsColumn(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject buffer,
+        jint length,
+        jint order
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.momentsColumn");
+    if (!isValidMomentOrder(order)) {
+        andas::throwIllegalArgument(env, "无效的矩阶数");
+        return nullptr;
+    }
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return nullptr;
+    return packedMoments(env, elements, length, order);
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_argsortColumn(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject buffer,
+        jint length
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.argsortColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return nullptr;
+
+    jintArray result = env->NewIntArray(length);
+    jint* indices = andas::getArrayElements(env, result, true);
+    andas::argsort(elements, indices, length);
+    andas::releaseArrayElements(env, result, indices, 0);
+
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT jbooleanArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeMath_greaterThanColumn(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject buffer,
+        jint length,
+        jdouble threshold
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.greaterThanColumn");
+    const double* elements = andas::directBufferAddress<double>(env, buffer, length);
+    if (elements == nullptr) return nullptr;
+
+    jbooleanArray result = env->NewBooleanArray(length);
+    jboolean* resultElements = andas::getArrayElements(env, result, true);
+    andas::greaterThan(elements, threshold, resultElements, length);
+    andas::releaseArrayElements(env, result, resultElements, 0);
+
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
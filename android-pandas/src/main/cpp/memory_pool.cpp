@@ -0,0 +1,295 @@
+#include "memory_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+namespace andas {
+
+namespace {
+
+// 每个块前面留一个缓存行记录块的大小和级别，返回给调用方的地址仍然按 64 字节对齐
+constexpr size_t kHeaderBytes = 64;
+constexpr int kMinClass = 7;    // 128 字节（含头部）
+constexpr int kMaxClass = 30;   // 1GB，更大的分配不进池
+constexpr size_t kArenaChunkBytes = (size_t(64) << 10) - kHeaderBytes;
+
+struct BlockHeader {
+    size_t bytes;       // 整个块的字节数，含头部
+    int32_t sizeClass;  // -1 表示直接向系统申请
+};
+static_assert(sizeof(BlockHeader) <= kHeaderBytes, "块头部必须放得下一个缓存行");
+
+struct PoolState {
+    std::atomic<int64_t> limit{0};
+    std::atomic<int64_t> current{0};
+    std::atomic<int64_t> peak{0};
+    std::atomic<int64_t> arenaReserved{0};
+    std::atomic<int64_t> systemAllocations{0};
+    std::atomic<int64_t> poolHits{0};
+    std::atomic<int64_t> failures{0};
+
+    std::mutex mutex;
+    std::vector<char*> freeLists[kMaxClass + 1];
+    int64_t cached = 0;
+    int64_t cacheLimit = kDefaultPoolCacheBytes;
+};
+
+// 不析构：线程退出时分配区还会把块还回来，可能晚于静态对象的析构
+PoolState& state() {
+    static PoolState* instance = new PoolState();
+    return *instance;
+}
+
+void updatePeak(int64_t value) {
+    std::atomic<int64_t>& peak = state().peak;
+    int64_t seen = peak.load(std::memory_order_relaxed);
+    while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+bool tryReserve(int64_t bytes) {
+    PoolState& s = state();
+    const int64_t limit = s.limit.load(std::memory_order_relaxed);
+    int64_t current = s.current.load(std::memory_order_relaxed);
+    do {
+        if (limit > 0 && current + bytes > limit) return false;
+    } while (!s.current.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+    updatePeak(current + bytes);
+    return true;
+}
+
+void unreserve(int64_t bytes) {
+    state().current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+// 归还池中所有缓存的块
+void dropCache() {
+    PoolState& s = state();
+    std::vector<char*> blocks;
+    int64_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (int c = kMinClass; c <= kMaxClass; c++) {
+            blocks.insert(blocks.end(), s.freeLists[c].begin(), s.freeLists[c].end());
+            s.freeLists[c].clear();
+        }
+        bytes = s.cached;
+        s.cached = 0;
+    }
+    for (char* block : blocks) std::free(block);
+    unreserve(bytes);
+}
+
+char* systemAlloc(size_t bytes) {
+    PoolState& s = state();
+    const int64_t size = static_cast<int64_t>(bytes);
+    if (!tryReserve(size)) {
+        // 先归还缓存再重试，缓存本身也计在用量里
+        dropCache();
+        if (!tryReserve(size)) {
+            s.failures.fetch_add(1, std::memory_order_relaxed);
+            throw MemoryLimitError("超出原生内存预算: 申请 " + std::to_string(size) + " 字节, 当前 " +
+                                   std::to_string(s.current.load(std::memory_order_relaxed)) + " 字节, 上限 " +
+                                   std::to_string(s.limit.load(std::memory_order_relaxed)) + " 字节");
+        }
+    }
+    void* block = nullptr;
+    if (posix_memalign(&block, kHeaderBytes, bytes) != 0) {
+        unreserve(size);
+        s.failures.fetch_add(1, std::memory_order_relaxed);
+        throw MemoryLimitError("原生内存分配失败: 申请 " + std::to_string(size) + " 字节");
+    }
+    s.systemAllocations.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<char*>(block);
+}
+
+// total 个字节（含头部）所在的级别，超过最大级别返回 -1
+int sizeClassOf(size_t total) {
+    int c = kMinClass;
+    while (c <= kMaxClass && (size_t(1) << c) < total) c++;
+    return c <= kMaxClass ? c : -1;
+}
+
+} // namespace
+
+void setMemoryLimit(int64_t bytes) {
+    state().limit.store(bytes > 0 ? bytes : 0, std::memory_order_relaxed);
+}
+
+int64_t memoryLimit() {
+    return state().limit.load(std::memory_order_relaxed);
+}
+
+void setPoolCacheLimit(int64_t bytes) {
+    PoolState& s = state();
+    bool over = false;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.cacheLimit = std::max<int64_t>(bytes, 0);
+        over = s.cached > s.cacheLimit;
+    }
+    if (over) dropCache();
+}
+
+int64_t poolCacheLimit() {
+    PoolState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.cacheLimit;
+}
+
+MemoryStats memoryStats() {
+    PoolState& s = state();
+    MemoryStats out;
+    out.limit = s.limit.load(std::memory_order_relaxed);
+    out.current = s.current.load(std::memory_order_relaxed);
+    out.peak = std::max(s.peak.load(std::memory_order_relaxed), out.current);
+    out.arenaReserved = s.arenaReserved.load(std::memory_order_relaxed);
+    out.systemAllocations = s.systemAllocations.load(std::memory_order_relaxed);
+    out.poolHits = s.poolHits.load(std::memory_order_relaxed);
+    out.failures = s.failures.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        out.poolCached = s.cached;
+    }
+    return out;
+}
+
+void resetPeakMemory() {
+    PoolState& s = state();
+    s.peak.store(s.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void trimMemory() {
+    detail::ScratchArena::local().release();
+    dropCache();
+}
+
+void* poolAlloc(size_t bytes) {
+    if (bytes > (size_t(1) << 62)) {
+        state().failures.fetch_add(1, std::memory_order_relaxed);
+        throw MemoryLimitError("原生内存分配失败: 申请 " + std::to_string(bytes) + " 字节");
+    }
+    const size_t total = bytes + kHeaderBytes;
+    const int sizeClass = sizeClassOf(total);
+    char* block = nullptr;
+    size_t blockBytes = 0;
+    if (sizeClass >= 0) {
+        blockBytes = size_t(1) << sizeClass;
+        PoolState& s = state();
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            std::vector<char*>& list = s.freeLists[sizeClass];
+            if (!list.empty()) {
+                block = list.back();
+                list.pop_back();
+                s.cached -= static_cast<int64_t>(blockBytes);
+            }
+        }
+        if (block != nullptr) {
+            s.poolHits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            block = systemAlloc(blockBytes);
+        }
+    } else {
+        blockBytes = (total + kHeaderBytes - 1) / kHeaderBytes * kHeaderBytes;
+        block = systemAlloc(blockBytes);
+    }
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+    header->bytes = blockBytes;
+    header->sizeClass = sizeClass;
+    return block + kHeaderBytes;
+}
+
+void poolFree(void* ptr) {
+    if (ptr == nullptr) return;
+    char* block = static_cast<char*>(ptr) - kHeaderBytes;
+    const BlockHeader* header = reinterpret_cast<const BlockHeader*>(block);
+    const int64_t blockBytes = static_cast<int64_t>(header->bytes);
+    if (header->sizeClass >= 0) {
+        PoolState& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.cached + blockBytes <= s.cacheLimit) {
+            try {
+                s.freeLists[header->sizeClass].push_back(block);
+                s.cached += blockBytes;
+                return;
+            } catch (const std::bad_alloc&) {
+                // 空闲链表扩容失败时直接归还
+            }
+        }
+    }
+    std::free(block);
+    unreserve(blockBytes);
+}
+
+namespace detail {
+
+ScratchArena& ScratchArena::local() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+ScratchArena::~ScratchArena() {
+    depth_ = 0;
+    shrink(0);
+}
+
+ScratchArena::Mark ScratchArena::enter() {
+    depth_++;
+    return Mark{current_, offset_};
+}
+
+void ScratchArena::leave(const Mark& mark) {
+    current_ = mark.chunk;
+    offset_ = mark.offset;
+    if (--depth_ == 0 && reserved_ > kArenaRetainBytes) shrink(kArenaRetainBytes);
+}
+
+void* ScratchArena::allocate(size_t bytes) {
+    const size_t rounded = std::max<size_t>((bytes + kHeaderBytes - 1) / kHeaderBytes * kHeaderBytes, kHeaderBytes);
+    // 当前块放不下时顺延到后面的空闲块，都放不下再追加新块
+    while (current_ < chunks_.size()) {
+        Chunk& chunk = chunks_[current_];
+        if (offset_ + rounded <= chunk.size) {
+            void* ptr = chunk.data + offset_;
+            offset_ += rounded;
+            return ptr;
+        }
+        current_++;
+        offset_ = 0;
+    }
+    // 新块至少与已有的总量相同，块数按对数增长；凑满池的级别，不浪费块内空间
+    size_t size = std::max({rounded, kArenaChunkBytes, reserved_});
+    const int sizeClass = sizeClassOf(size + kHeaderBytes);
+    if (sizeClass >= 0) size = (size_t(1) << sizeClass) - kHeaderBytes;
+    chunks_.reserve(chunks_.size() + 1);
+    char* data = static_cast<char*>(poolAlloc(size));
+    chunks_.push_back(Chunk{data, size});
+    reserved_ += size;
+    state().arenaReserved.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    current_ = chunks_.size() - 1;
+    offset_ = rounded;
+    return data;
+}
+
+void ScratchArena::release() {
+    if (depth_ == 0) shrink(0);
+}
+
+void ScratchArena::shrink(size_t retain) {
+    current_ = 0;
+    offset_ = 0;
+    while (!chunks_.empty() && reserved_ > retain) {
+        const Chunk chunk = chunks_.back();
+        chunks_.pop_back();
+        poolFree(chunk.data);
+        reserved_ -= chunk.size;
+        state().arenaReserved.fetch_sub(static_cast<int64_t>(chunk.size), std::memory_order_relaxed);
+    }
+}
+
+} // namespace detail
+
+} // namespace andas
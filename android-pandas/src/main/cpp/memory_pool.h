@@ -0,0 +1,184 @@
+#ifndef ANDAS_MEMORY_POOL_H
+#define ANDAS_MEMORY_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace andas {
+
+// 原生内存管理（不依赖JNI）
+// - 全局预算：经过这里的分配（列缓冲区、排序等内核的临时内存）计入当前用量和峰值；超过上限时先归还缓存再重试，
+//   仍然不够则抛出 MemoryLimitError，JNI 层把它转为 Java 的 OutOfMemoryError，而不是让进程 abort
+// - 按 2 的幂分级的缓冲区池：释放的块按级别缓存，之后同级别的分配直接复用；缓存总量有上限，
+//   超过最大级别的分配直接向系统申请、释放时直接归还
+// - 线程私有的顺序分配区：一次操作内的临时内存（ScratchBuffer）按指针递增分配，作用域结束整体回退；
+//   分配区的块从池中取得，最外层作用域结束时只保留 kArenaRetainBytes，其余还给池
+
+// 超出内存预算或系统分配失败
+class MemoryLimitError : public std::bad_alloc {
+public:
+    explicit MemoryLimitError(std::string message) : message_(std::move(message)) {}
+    const char* what() const noexcept override { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+struct MemoryStats {
+    int64_t limit = 0;           // 0 表示不限制
+    int64_t current = 0;         // 当前占用，包括池中缓存和分配区保留的块
+    int64_t peak = 0;
+    int64_t arenaReserved = 0;   // 各线程分配区持有的字节数
+    int64_t poolCached = 0;      // 池中空闲待复用的字节数
+    int64_t systemAllocations = 0;
+    int64_t poolHits = 0;        // 由池中缓存满足的分配次数
+    int64_t failures = 0;        // 超出预算或系统分配失败的次数
+};
+// MemoryStats 的字段数，JNI 按上面的顺序导出为 long[]
+constexpr int32_t kMemoryStatFields = 8;
+
+// 单个线程分配区在操作之间保留的字节数
+constexpr size_t kArenaRetainBytes = size_t(1) << 20;
+// 池默认最多缓存的字节数
+constexpr int64_t kDefaultPoolCacheBytes = int64_t(64) << 20;
+
+// bytes <= 0 表示不限制；调小上限不会回收已分配的内存，只影响之后的分配
+void setMemoryLimit(int64_t bytes);
+int64_t memoryLimit();
+void setPoolCacheLimit(int64_t bytes);
+int64_t poolCacheLimit();
+MemoryStats memoryStats();
+// 峰值重置为当前用量
+void resetPeakMemory();
+// 归还池中的缓存和当前线程分配区的空闲块
+void trimMemory();
+
+// 计入预算的 64 字节对齐分配，bytes 为 0 时也返回非空地址；失败抛出 MemoryLimitError
+void* poolAlloc(size_t bytes);
+// 只接受 poolAlloc 返回的地址，nullptr 忽略
+void poolFree(void* ptr);
+
+namespace detail {
+
+// 当前线程的顺序分配区，通过 ScratchBuffer 使用
+class ScratchArena {
+public:
+    struct Mark {
+        size_t chunk;
+        size_t offset;
+    };
+
+    static ScratchArena& local();
+
+    ~ScratchArena();
+
+    // 进入/离开一个作用域；离开时回退到进入时的位置，最外层离开时归还多余的块
+    Mark enter();
+    void leave(const Mark& mark);
+    void* allocate(size_t bytes);
+    // 归还所有块，只在没有活动作用域时生效
+    void release();
+
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    void shrink(size_t retain);
+
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;
+    size_t offset_ = 0;
+    size_t reserved_ = 0;
+    int32_t depth_ = 0;
+};
+
+} // namespace detail
+
+// 一次操作内的临时数组，从当前线程的分配区分配，析构时回退；不初始化元素
+// 同一线程内的 ScratchBuffer 必须按创建的相反顺序析构（作为局部变量使用即可），不可拷贝或移动
+template <typename T>
+class ScratchBuffer {
+    static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                  "ScratchBuffer 只用于平凡类型");
+
+public:
+    explicit ScratchBuffer(int64_t count)
+        : arena_(detail::ScratchArena::local()), mark_(arena_.enter()), size_(count > 0 ? count : 0) {
+        try {
+            data_ = static_cast<T*>(arena_.allocate(static_cast<size_t>(size_) * sizeof(T)));
+        } catch (...) {
+            arena_.leave(mark_);
+            throw;
+        }
+    }
+    ~ScratchBuffer() { arena_.leave(mark_); }
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    int64_t size() const { return size_; }
+    T& operator[](int64_t i) { return data_[i]; }
+    const T& operator[](int64_t i) const { return data_[i]; }
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+
+private:
+    detail::ScratchArena& arena_;
+    detail::ScratchArena::Mark mark_;
+    int64_t size_;
+    T* data_ = nullptr;
+};
+
+// 从池中分配的数组，可以移动、可以提前 reset 归还；不初始化元素
+// 用于生命周期不是后进先出的缓冲区
+template <typename T>
+class PooledBuffer {
+    static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                  "PooledBuffer 只用于平凡类型");
+
+public:
+    PooledBuffer() = default;
+    explicit PooledBuffer(int64_t count)
+        : size_(count > 0 ? count : 0), data_(static_cast<T*>(poolAlloc(static_cast<size_t>(size_) * sizeof(T)))) {}
+    ~PooledBuffer() { poolFree(data_); }
+    PooledBuffer(PooledBuffer&& other) noexcept
+        : size_(std::exchange(other.size_, 0)), data_(std::exchange(other.data_, nullptr)) {}
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+        if (this != &other) {
+            poolFree(data_);
+            size_ = std::exchange(other.size_, 0);
+            data_ = std::exchange(other.data_, nullptr);
+        }
+        return *this;
+    }
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    void reset() {
+        poolFree(data_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    int64_t size() const { return size_; }
+    T& operator[](int64_t i) { return data_[i]; }
+    const T& operator[](int64_t i) const { return data_[i]; }
+
+private:
+    int64_t size_ = 0;
+    T* data_ = nullptr;
+};
+
+} // namespace andas
+
+#endif //ANDAS_MEMORY_POOL_H
@@ -0,0 +1,74 @@
+#include "moments.h"
+
+#include <algorithm>
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+namespace {
+
+// 块内两遍扫描的块大小，块数据留在 L1 缓存中
+constexpr int64_t kMomentBlock = 512;
+
+MomentAccumulator blockMoments(const simd::Kernels& k, const double* x, int64_t n, MomentOrder order) {
+    MomentAccumulator b;
+    int64_t count = 0;
+    const double sum = k.nanSum(x, n, &count);
+    if (count == 0) return b;
+    b.count = count;
+    b.sum = sum;
+    b.mean = sum / static_cast<double>(count);
+    if (order == MomentOrder::MEAN) return b;
+
+    k.nanMinMax(x, n, &b.min, &b.max);
+    if (b.min == b.max) {
+        // 块内全部相等：均值取该值本身，中心矩精确为 0（块和的舍入会让 sum / count 偏离该值）
+        b.mean = b.min;
+        return b;
+    }
+    const double mean = b.mean;
+    double s2 = 0.0;
+    if (order == MomentOrder::VARIANCE) {
+        for (int64_t i = 0; i < n; i++) {
+            // NaN 的偏差记为 0，循环没有分支，可以向量化
+            const double d = x[i] == x[i] ? x[i] - mean : 0.0;
+            s2 += d * d;
+        }
+        b.m2 = s2;
+        return b;
+    }
+    double s3 = 0.0;
+    double s4 = 0.0;
+    for (int64_t i = 0; i < n; i++) {
+        const double d = x[i] == x[i] ? x[i] - mean : 0.0;
+        const double d2 = d * d;
+        s2 += d2;
+        s3 += d2 * d;
+        s4 += d2 * d2;
+    }
+    b.m2 = s2;
+    b.m3 = s3;
+    b.m4 = s4;
+    return b;
+}
+
+} // namespace
+
+MomentAccumulator computeMoments(const double* x, int64_t n, MomentOrder order) {
+    const simd::Kernels& k = simd::active();
+    return parallel_reduce(0, n, MomentAccumulator(),
+        [&](int64_t lo, int64_t hi) {
+            MomentAccumulator local;
+            for (int64_t b = lo; b < hi; b += kMomentBlock) {
+                local.merge(blockMoments(k, x + b, std::min(hi, b + kMomentBlock) - b, order));
+            }
+            return local;
+        },
+        [](MomentAccumulator a, const MomentAccumulator& b) {
+            a.merge(b);
+            return a;
+        });
+}
+
+} // namespace andas
@@ -0,0 +1,135 @@
+#ifndef ANDAS_MOMENTS_H
+#define ANDAS_MOMENTS_H
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace andas {
+
+// 可合并的矩累加器（不依赖JNI），所有统计路径共用：数值内核、describe、分批/流式聚合
+// - 保存有效值个数、补偿求和、均值和 2~4 阶中心矩之和 (M2/M3/M4)、最小/最大值
+// - add 为 Welford 在线更新，merge 为 Chan/Pébay 的两组合并公式，
+//   各块、各线程、各批次的部分结果可以按任意分组合并，不需要第二遍扫描
+// - NaN 视为缺失值，不计入
+// - 打包格式（JNI 传输和 Kotlin 侧 MomentAccumulator 一致）：
+//   [count, sum, mean, m2, m3, m4, min, max]
+struct MomentAccumulator {
+    static constexpr int kPackedSize = 8;
+
+    int64_t count = 0;
+    double sum = 0.0;
+    double sumError = 0.0;   // Neumaier 补偿项
+    double mean = 0.0;
+    double m2 = 0.0;
+    double m3 = 0.0;
+    double m4 = 0.0;
+    double min = INFINITY;
+    double max = -INFINITY;
+
+    void add(double v) {
+        if (std::isnan(v)) return;
+        MomentAccumulator one;
+        one.count = 1;
+        one.sum = v;
+        one.mean = v;
+        one.min = v;
+        one.max = v;
+        merge(one);
+    }
+
+    void merge(const MomentAccumulator& b) {
+        if (b.count == 0) return;
+        if (count == 0) {
+            *this = b;
+            return;
+        }
+        const double na = static_cast<double>(count);
+        const double nb = static_cast<double>(b.count);
+        const double n = na + nb;
+        const double delta = b.mean - mean;
+        const double delta2 = delta * delta;
+        const double a2 = m2;
+        const double a3 = m3;
+        m4 += b.m4 + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+              + 6.0 * delta2 * (na * na * b.m2 + nb * nb * a2) / (n * n)
+              + 4.0 * delta * (na * b.m3 - nb * a3) / n;
+        m3 += b.m3 + delta2 * delta * na * nb * (na - nb) / (n * n)
+              + 3.0 * delta * (na * b.m2 - nb * a2) / n;
+        m2 += b.m2 + delta2 * na * nb / n;
+        mean += delta * nb / n;
+        addToSum(b.sum);
+        sumError += b.sumError;
+        if (b.min < min) min = b.min;
+        if (b.max > max) max = b.max;
+        count += b.count;
+    }
+
+    double total() const { return std::isfinite(sum) ? sum + sumError : sum; }
+
+    // 自由度为 count - ddof 的方差，count <= ddof 时为 NaN
+    double variance(int64_t ddof) const {
+        if (count <= ddof) return std::numeric_limits<double>::quiet_NaN();
+        return m2 / static_cast<double>(count - ddof);
+    }
+
+    double stddev(int64_t ddof) const { return std::sqrt(variance(ddof)); }
+
+    // 与 pandas 一致的无偏偏度，有效值不足3个时为 NaN，方差为 0 时为 0
+    double skewness() const {
+        if (count < 3) return std::numeric_limits<double>::quiet_NaN();
+        if (m2 == 0.0) return 0.0;
+        const double n = static_cast<double>(count);
+        return n * std::sqrt(n - 1.0) * m3 / ((n - 2.0) * m2 * std::sqrt(m2));
+    }
+
+    // 与 pandas 一致的无偏超额峰度，有效值不足4个时为 NaN，方差为 0 时为 0
+    double kurtosis() const {
+        if (count < 4) return std::numeric_limits<double>::quiet_NaN();
+        if (m2 == 0.0) return 0.0;
+        const double n = static_cast<double>(count);
+        const double adjust = 3.0 * (n - 1.0) * (n - 1.0) / ((n - 2.0) * (n - 3.0));
+        return n * (n + 1.0) * (n - 1.0) * m4 / ((n - 2.0) * (n - 3.0) * m2 * m2) - adjust;
+    }
+
+    void pack(double* out) const {
+        out[0] = static_cast<double>(count);
+        out[1] = total();
+        out[2] = mean;
+        out[3] = m2;
+        out[4] = m3;
+        out[5] = m4;
+        out[6] = count > 0 ? min : std::numeric_limits<double>::quiet_NaN();
+        out[7] = count > 0 ? max : std::numeric_limits<double>::quiet_NaN();
+    }
+
+private:
+    void addToSum(double v) {
+        const double t = sum + v;
+        if (!std::isfinite(t)) {
+            // 出现 Inf 时补偿项无意义，保持和为 Inf/NaN
+            sum = t;
+            return;
+        }
+        if (std::fabs(sum) >= std::fabs(v)) {
+            sumError += (sum - t) + v;
+        } else {
+            sumError += (v - t) + sum;
+        }
+        sum = t;
+    }
+};
+
+// 需要计算到的阶数；阶数越低扫描越快
+enum class MomentOrder : int32_t {
+    MEAN = 1,       // count / sum / mean
+    VARIANCE = 2,   // 另加 M2 和 min / max
+    SHAPE = 4,      // 另加 M3 / M4（偏度、峰度）
+};
+
+// 并行计算 x[0, n) 的矩：每个小块先求块均值，再在缓存内求块的中心矩，最后按顺序合并
+MomentAccumulator computeMoments(const double* x, int64_t n, MomentOrder order);
+
+} // namespace andas
+
+#endif //ANDAS_MOMENTS_H
@@ -4,89 +4,201 @@
 #include <vector>
 #include <algorithm>
 #include <chrono>
+#include "thread_pool.h"
+#include "simd_kernels.h"
+#include "math_kernels.h"
+#include "moments.h"
+#include "filter_engine.h"
+#include "memory_pool.h"
+#include "pipeline_engine.h"
+#include "jni_utils.h"
 
 #define LOG_TAG "AndasNative"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
 // 性能测试工具
+// 输入数据在计时之外准备，测量的是实际使用的内核；先预热一次，再取 5 次运行的中位数（微秒）
+// 结果写入 volatile 变量，避免被编译器当作无用计算消除
+// 更完整的内核基准（多种规模、缺失比例、线程数，JSON 报告与基线比较）见 benchmarks/andas_bench.cpp
 extern "C" JNIEXPORT jlong JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeMath_00024Benchmark_measureOperationTime(
     JNIEnv* env,
     jobject /* this */,
     jint operationType,
     jint dataSize
-) {
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    // 根据操作类型执行不同的测试
-    switch (operationType) {
-        case 1: { // 数组创建和初始化
-            std::vector<double> data(dataSize);
-            for (int i = 0; i < dataSize; i++) {
-                data[i] = i * 2.0;
-            }
-            break;
-        }
-        case 2: { // 数学运算
-            std::vector<double> data(dataSize);
-            for (int i = 0; i < dataSize; i++) {
-                data[i] = i * 2.0;
-            }
-            for (int i = 0; i < dataSize; i++) {
-                data[i] = data[i] * 1.5;
+) try {
+    ANDAS_JNI_SCOPE("NativeMath.Benchmark.measureOperationTime");
+    const int64_t n = std::max<jint>(dataSize, 0);
+    std::vector<double> data(n);
+    for (int64_t i = 0; i < n; i++) {
+        data[i] = static_cast<double>(i) * 2.0;
+    }
+    std::vector<double> out(n);
+    std::vector<uint64_t> bits((n + 63) / 64);
+    volatile double sink = 0.0;
+
+    auto runOnce = [&]() {
+        switch (operationType) {
+            case 1: { // 数组创建和初始化
+                std::vector<double> created(n);
+                for (int64_t i = 0; i < n; i++) {
+                    created[i] = static_cast<double>(i) * 2.0;
+                }
+                sink = n > 0 ? created[n - 1] : 0.0;
+                break;
             }
-            break;
-        }
-        case 3: { // 统计计算
-            std::vector<double> data(dataSize);
-            double sum = 0.0;
-            for (int i = 0; i < dataSize; i++) {
-                data[i] = i;
-                sum += data[i];
+            case 2: // 数学运算
+                andas::multiplyScalar(data.data(), 1.5, out.data(), n);
+                sink = n > 0 ? out[n - 1] : 0.0;
+                break;
+            case 3: { // 统计计算
+                const andas::MomentAccumulator m = andas::computeMoments(data.data(), n, andas::MomentOrder::VARIANCE);
+                sink = m.mean + m.m2;
+                break;
             }
-            double mean = sum / dataSize;
-            break;
-        }
-        case 4: { // 过滤操作
-            std::vector<int> indices;
-            for (int i = 0; i < dataSize; i++) {
-                if (i > dataSize / 2) {
-                    indices.push_back(i);
-                }
+            case 4: { // 过滤操作
+                andas::compareToBitmask(data.data(), static_cast<double>(n), andas::simd::CompareOp::GT, bits.data(), n);
+                sink = static_cast<double>(andas::selectedRows(bits.data(), n).size());
+                break;
             }
-            break;
         }
+    };
+
+    runOnce();
+    std::vector<int64_t> samples;
+    for (int r = 0; r < 5; r++) {
+        auto start = std::chrono::steady_clock::now();
+        runOnce();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
     }
-    
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-    
-    return duration.count();
-}
+    std::sort(samples.begin(), samples.end());
+    (void)sink;
+    return samples[samples.size() / 2];
+} ANDAS_JNI_CATCH(env, 0)
 
-// 线程安全的批量处理
+// 批量计算 sin(x) + cos(x) * 2.0
+// 作为一个固定的表达式交给流水线执行：按数据块求值，sin/cos 使用向量化内核，块在线程池上并行；
+// batchSize 只为兼容保留，块大小由流水线决定。任意表达式见 DataFrame.eval
 extern "C" JNIEXPORT jdoubleArray JNICALL
 Java_cn_ac_oac_libs_andas_core_NativeBatch_processBatch(
     JNIEnv* env,
     jobject /* this */,
     jdoubleArray array,
-    jint batchSize
-) {
-    jsize length = env->GetArrayLength(array);
-    jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
-    
+    jint /* batchSize */
+) try {
+    ANDAS_JNI_SCOPE("NativeBatch.processBatch");
+    const jsize length = env->GetArrayLength(array);
+    jdouble* elements = andas::getArrayElements(env, array);
+
+    using andas::ExprOp;
+    static const andas::ExprInstruction kProgram[] = {
+        {ExprOp::COLUMN, 0}, {ExprOp::SIN, 0}, {ExprOp::COLUMN, 0}, {ExprOp::COS, 0},
+        {ExprOp::CONST, 0}, {ExprOp::MUL, 0}, {ExprOp::ADD, 0},
+    };
+    static const double kConstants[] = {2.0};
+    const andas::ExprProgram program{kProgram, 7};
+    const double* inputs[] = {elements};
+    const andas::PipelineSpec spec{inputs, 1, nullptr, &program, 1, kConstants, 1};
+    const andas::PipelineResult computed = andas::runPipeline(spec, length);
+    andas::releaseArrayElements(env, array, elements, JNI_ABORT);
+
     jdoubleArray result = env->NewDoubleArray(length);
-    jdouble* resultElements = env->GetDoubleArrayElements(result, nullptr);
-    
-    // 批量计算 - 模拟复杂的数据处理操作
-    for (int i = 0; i < length; i++) {
-        // 模拟复杂计算：sin(x) + cos(x) * 2.0
-        resultElements[i] = std::sin(elements[i]) + std::cos(elements[i]) * 2.0;
-    }
-    
-    env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
-    env->ReleaseDoubleArrayElements(result, resultElements, 0);
-    
+    if (result == nullptr) return nullptr;
+    if (length > 0) andas::setArrayRegion(env, result, 0, length, computed.columns[0].data());
     return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 原生并行运行时控制
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeRuntime_setNumThreads(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jint numThreads
+) {
+    andas::ThreadPool::instance().setThreadCount(numThreads);
+    LOGI("原生线程数设置为: %d", andas::ThreadPool::instance().threadCount());
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeRuntime_getNumThreads(
+    JNIEnv* /* env */,
+    jobject /* this */
+) {
+    return andas::ThreadPool::instance().threadCount();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeRuntime_setParallelThreshold(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong threshold
+) {
+    andas::setParallelThreshold(threshold);
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeRuntime_getParallelThreshold(
+    JNIEnv* /* env */,
+    jobject /* this */
+) {
+    return andas::parallelThreshold();
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeRuntime_getSimdLevel(
+    JNIEnv* env,
+    jobject /* this */
+) {
+    return env->NewStringUTF(andas::simd::active().name);
+}
+
+// 原生内存预算与统计，见 memory_pool.h
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeRuntime_setMemoryLimit(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jlong bytes
+) {
+    andas::setMemoryLimit(bytes);
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeRuntime_getMemoryLimit(
+    JNIEnv* /* env */,
+    jobject /* this */
+) {
+    return andas::memoryLimit();
+}
+
+// [limit, current, peak, arenaReserved, poolCached, systemAllocations, poolHits, failures]
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeRuntime_memoryStatsNative(
+    JNIEnv* env,
+    jobject /* this */
+) {
+    const andas::MemoryStats m = andas::memoryStats();
+    const jlong values[andas::kMemoryStatFields] = {
+        m.limit, m.current, m.peak, m.arenaReserved, m.poolCached, m.systemAllocations, m.poolHits, m.failures
+    };
+    jlongArray result = env->NewLongArray(andas::kMemoryStatFields);
+    if (result != nullptr) env->SetLongArrayRegion(result, 0, andas::kMemoryStatFields, values);
+    return result;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeRuntime_resetPeakMemory(
+    JNIEnv* /* env */,
+    jobject /* this */
+) {
+    andas::resetPeakMemory();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeRuntime_trimMemory(
+    JNIEnv* /* env */,
+    jobject /* this */
+) {
+    andas::trimMemory();
 }
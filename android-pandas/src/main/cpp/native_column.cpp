@@ -0,0 +1,39 @@
+#include <jni.h>
+#include <android/log.h>
+#include <cstdint>
+#include "column_buffer.h"
+#include "jni_utils.h"
+
+#define LOG_TAG "AndasColumn"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+// 原生列缓冲区：对齐的堆外内存，以 DirectByteBuffer 形式交给 Kotlin 持有；释放后留在缓冲区池中复用
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumn_00024Companion_allocateBuffer(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong byteSize
+) try {
+    ANDAS_JNI_SCOPE("NativeColumn.Companion.allocateBuffer");
+    if (byteSize < 0) {
+        andas::throwIllegalArgument(env, "缓冲区大小不能为负数");
+        return nullptr;
+    }
+    // 超出内存预算时 alignedAlloc 抛出 MemoryLimitError，由 ANDAS_JNI_CATCH 转为 OutOfMemoryError
+    void* address = andas::alignedAlloc(static_cast<size_t>(byteSize));
+    jobject buffer = env->NewDirectByteBuffer(address, byteSize);
+    if (buffer == nullptr) andas::alignedFree(address);
+    return buffer;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumn_00024Companion_freeBuffer(
+    JNIEnv* env,
+    jobject /* this */,
+    jobject buffer
+) try {
+    ANDAS_JNI_SCOPE("NativeColumn.Companion.freeBuffer");
+    if (buffer == nullptr) return;
+    andas::alignedFree(env->GetDirectBufferAddress(buffer));
+} ANDAS_JNI_CATCH(env)
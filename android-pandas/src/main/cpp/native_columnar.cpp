@@ -0,0 +1,335 @@
+#include <jni.h>
+#include <cstdint>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "columnar_file.h"
+#include "jni_utils.h"
+
+// 列式文件的 JNI 包装：写入器句柄为 ColumnarWriter 指针，文件句柄为 ColumnarFile 指针
+// 读取时列数据以指向映射内存的 DirectByteBuffer 返回，不复制
+
+namespace {
+
+void throwIOException(JNIEnv* env, const std::string& message) {
+    jclass cls = env->FindClass("java/io/IOException");
+    if (cls != nullptr) env->ThrowNew(cls, message.c_str());
+}
+
+std::string fromBytes(JNIEnv* env, jbyteArray bytes) {
+    const jsize length = env->GetArrayLength(bytes);
+    std::string result(static_cast<size_t>(length), '\0');
+    if (length > 0) andas::getArrayRegion(env, bytes, 0, length, reinterpret_cast<jbyte*>(&result[0]));
+    return result;
+}
+
+andas::ColumnarWriter* writerFrom(JNIEnv* env, jlong handle) {
+    andas::ColumnarWriter* writer = reinterpret_cast<andas::ColumnarWriter*>(handle);
+    if (writer == nullptr) andas::throwIllegalArgument(env, "列式文件写入器已关闭");
+    return writer;
+}
+
+andas::ColumnarFile* fileFrom(JNIEnv* env, jlong handle) {
+    andas::ColumnarFile* file = reinterpret_cast<andas::ColumnarFile*>(handle);
+    if (file == nullptr) andas::throwIllegalArgument(env, "列式文件已关闭");
+    return file;
+}
+
+// 写入一列基本类型数组，Write 接收 (name, values, valid) 并返回是否成功；valid 可以为 null
+template <typename Array, typename Element, typename Write>
+void writePrimitive(JNIEnv* env, jlong handle, jbyteArray name, Array values, jbooleanArray valid, jlong rowCount,
+                    Write write) {
+    andas::ColumnarWriter* writer = writerFrom(env, handle);
+    if (writer == nullptr) return;
+    if (values == nullptr || env->GetArrayLength(values) != rowCount ||
+        (valid != nullptr && env->GetArrayLength(valid) != rowCount)) {
+        andas::throwIllegalArgument(env, "列长度与行数不一致");
+        return;
+    }
+    const std::string columnName = fromBytes(env, name);
+    std::vector<uint8_t> mask;
+    if (valid != nullptr) {
+        mask.resize(static_cast<size_t>(rowCount));
+        andas::getArrayRegion(env, valid, 0, static_cast<jsize>(rowCount), reinterpret_cast<jboolean*>(mask.data()));
+    }
+    // 临界区内只做文件写入，不调用其他 JNI 函数；避免为整列复制一份数组
+    Element* elements = static_cast<Element*>(andas::getPrimitiveArrayCritical(env, values, rowCount * static_cast<int64_t>(sizeof(Element))));
+    if (elements == nullptr) return;
+    const bool ok = write(*writer, columnName, elements, valid != nullptr ? mask.data() : nullptr);
+    env->ReleasePrimitiveArrayCritical(values, elements, JNI_ABORT);
+    if (!ok) throwIOException(env, writer->error());
+}
+
+} // namespace
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_openWriter(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring path,
+    jlong rowCount,
+    jint statsChunkRows
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.openWriter");
+    if (rowCount < 0) {
+        andas::throwIllegalArgument(env, "行数不能为负数");
+        return 0;
+    }
+    const char* chars = env->GetStringUTFChars(path, nullptr);
+    std::string name(chars);
+    env->ReleaseStringUTFChars(path, chars);
+    int fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throwIOException(env, "无法创建文件: " + name);
+        return 0;
+    }
+    std::unique_ptr<andas::ColumnarWriter> writer(new andas::ColumnarWriter(fd, true, rowCount, statsChunkRows));
+    if (!writer->error().empty()) {
+        throwIOException(env, writer->error());
+        return 0;
+    }
+    return reinterpret_cast<jlong>(writer.release());
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_writeBoolean(
+    JNIEnv* env, jobject /* this */, jlong handle, jbyteArray name, jlong rowCount, jbooleanArray values, jbooleanArray valid
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.writeBoolean");
+    // jboolean 为单字节 0/1，与 BOOL 列的存储一致
+    writePrimitive<jbooleanArray, uint8_t>(env, handle, name, values, valid, rowCount,
+        [](andas::ColumnarWriter& w, const std::string& n, const uint8_t* v, const uint8_t* m) { return w.writeBool(n, v, m); });
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_writeInt(
+    JNIEnv* env, jobject /* this */, jlong handle, jbyteArray name, jlong rowCount, jintArray values, jbooleanArray valid
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.writeInt");
+    writePrimitive<jintArray, int32_t>(env, handle, name, values, valid, rowCount,
+        [](andas::ColumnarWriter& w, const std::string& n, const int32_t* v, const uint8_t* m) { return w.writeInt32(n, v, m); });
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_writeLong(
+    JNIEnv* env, jobject /* this */, jlong handle, jbyteArray name, jlong rowCount, jlongArray values, jbooleanArray valid
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.writeLong");
+    writePrimitive<jlongArray, int64_t>(env, handle, name, values, valid, rowCount,
+        [](andas::ColumnarWriter& w, const std::string& n, const int64_t* v, const uint8_t* m) { return w.writeInt64(n, v, m); });
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_writeDouble(
+    JNIEnv* env, jobject /* this */, jlong handle, jbyteArray name, jlong rowCount, jdoubleArray values, jbooleanArray valid
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.writeDouble");
+    writePrimitive<jdoubleArray, double>(env, handle, name, values, valid, rowCount,
+        [](andas::ColumnarWriter& w, const std::string& n, const double* v, const uint8_t* m) { return w.writeFloat64(n, v, m); });
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_writeDoubleColumn(
+    JNIEnv* env, jobject /* this */, jlong handle, jbyteArray name, jlong rowCount, jobject buffer
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.writeDoubleColumn");
+    // 原生列直接从堆外内存写出，NaN 视为空值
+    andas::ColumnarWriter* writer = writerFrom(env, handle);
+    if (writer == nullptr) return;
+    const double* values = andas::directBufferAddress<double>(env, buffer, rowCount);
+    if (values == nullptr) return;
+    if (!writer->writeFloat64(fromBytes(env, name), values, nullptr)) throwIOException(env, writer->error());
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_writeString(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle,
+    jbyteArray name,
+    jlong rowCount,
+    jintArray codes,
+    jbyteArray dictChars,
+    jlongArray dictOffsets
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.writeString");
+    andas::ColumnarWriter* writer = writerFrom(env, handle);
+    if (writer == nullptr) return;
+    if (codes == nullptr || env->GetArrayLength(codes) != rowCount) {
+        andas::throwIllegalArgument(env, "列长度与行数不一致");
+        return;
+    }
+    const jsize dictionarySize = env->GetArrayLength(dictOffsets) - 1;
+    if (dictionarySize < 0) {
+        andas::throwIllegalArgument(env, "字典偏移至少包含一项");
+        return;
+    }
+    std::vector<int64_t> offsets(static_cast<size_t>(dictionarySize) + 1);
+    andas::getArrayRegion(env, dictOffsets, 0, dictionarySize + 1, reinterpret_cast<jlong*>(offsets.data()));
+    if (offsets.back() > env->GetArrayLength(dictChars)) {
+        andas::throwIllegalArgument(env, "字典偏移超出字符数组");
+        return;
+    }
+    const std::string chars = fromBytes(env, dictChars);
+    jint* elements = andas::getArrayElements(env, codes);
+    const bool ok = writer->writeString(fromBytes(env, name), elements, dictionarySize, offsets.data(), chars.data());
+    andas::releaseArrayElements(env, codes, elements, JNI_ABORT);
+    if (!ok) throwIOException(env, writer->error());
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_finishWriter(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.finishWriter");
+    std::unique_ptr<andas::ColumnarWriter> writer(writerFrom(env, handle));
+    if (writer == nullptr) return;
+    if (!writer->finish()) throwIOException(env, writer->error());
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_abortWriter(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.abortWriter");
+    delete reinterpret_cast<andas::ColumnarWriter*>(handle);
+} ANDAS_JNI_CATCH(env)
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_openFile(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring path
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.openFile");
+    const char* chars = env->GetStringUTFChars(path, nullptr);
+    std::string name(chars);
+    env->ReleaseStringUTFChars(path, chars);
+    std::string error;
+    std::unique_ptr<andas::ColumnarFile> file = andas::ColumnarFile::open(name, error);
+    if (file == nullptr) {
+        throwIOException(env, error);
+        return 0;
+    }
+    return reinterpret_cast<jlong>(file.release());
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_rowCount(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.rowCount");
+    andas::ColumnarFile* file = fileFrom(env, handle);
+    return file != nullptr ? file->rows() : 0;
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_columnNames(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.columnNames");
+    andas::ColumnarFile* file = fileFrom(env, handle);
+    if (file == nullptr) return nullptr;
+    const std::vector<andas::ColumnarColumn>& columns = file->columns();
+    jclass byteArrayClass = env->FindClass("[B");
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(columns.size()), byteArrayClass, nullptr);
+    for (size_t i = 0; i < columns.size(); i++) {
+        const std::string& name = columns[i].name;
+        jbyteArray bytes = env->NewByteArray(static_cast<jsize>(name.size()));
+        andas::setArrayRegion(env, bytes, 0, static_cast<jsize>(name.size()), reinterpret_cast<const jbyte*>(name.data()));
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), bytes);
+        env->DeleteLocalRef(bytes);
+    }
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_columnInfo(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.columnInfo");
+    andas::ColumnarFile* file = fileFrom(env, handle);
+    if (file == nullptr) return nullptr;
+    const std::vector<andas::ColumnarColumn>& columns = file->columns();
+    std::vector<jlong> info;
+    info.reserve(columns.size() * 5);
+    for (const andas::ColumnarColumn& column : columns) {
+        info.push_back(static_cast<jlong>(column.type));
+        info.push_back(column.nullCount);
+        info.push_back(column.dictionarySize);
+        info.push_back(column.statsChunkRows);
+        info.push_back(column.statsCount);
+    }
+    jlongArray result = env->NewLongArray(static_cast<jsize>(info.size()));
+    if (result != nullptr) andas::setArrayRegion(env, result, 0, static_cast<jsize>(info.size()), info.data());
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_buffer(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle,
+    jint column,
+    jint part
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.buffer");
+    andas::ColumnarFile* file = fileFrom(env, handle);
+    if (file == nullptr) return nullptr;
+    if (column < 0 || static_cast<size_t>(column) >= file->columns().size()) {
+        andas::throwIllegalArgument(env, "列下标越界");
+        return nullptr;
+    }
+    const andas::ColumnarColumn& c = file->columns()[static_cast<size_t>(column)];
+    const void* address = nullptr;
+    uint64_t bytes = 0;
+    switch (part) {
+        case 0:
+            address = c.validity;
+            bytes = static_cast<uint64_t>((file->rows() + 7) / 8);
+            break;
+        case 1:
+            address = c.values;
+            bytes = c.valuesBytes;
+            break;
+        case 2:
+            address = c.dictOffsets;
+            bytes = static_cast<uint64_t>(c.dictionarySize + 1) * sizeof(int64_t);
+            break;
+        case 3:
+            address = c.dictChars;
+            bytes = c.dictCharsBytes;
+            break;
+        case 4:
+            address = c.stats;
+            bytes = static_cast<uint64_t>(c.statsCount) * 16;
+            break;
+        default:
+            andas::throwIllegalArgument(env, "未知的区段");
+            return nullptr;
+    }
+    if (address == nullptr) return nullptr;
+    // 映射为私有可写，Kotlin 侧对缓冲区的写入不会影响文件
+    return env->NewDirectByteBuffer(const_cast<void*>(address), static_cast<jlong>(bytes));
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeColumnar_closeFile(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeColumnar.closeFile");
+    delete reinterpret_cast<andas::ColumnarFile*>(handle);
+} ANDAS_JNI_CATCH(env)
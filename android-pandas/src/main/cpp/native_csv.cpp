@@ -0,0 +1,320 @@
+#include <jni.h>
+#include <algorithm>
+#include <cstdint>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "csv_reader.h"
+#include "jni_utils.h"
+
+// 流式 CSV 读取器的 JNI 包装：句柄为 CsvHandle 指针，由 Kotlin 侧 NativeCsv 持有
+
+namespace {
+
+// 按路径打开时预读的块数
+constexpr int32_t kPrefetchDepth = 4;
+
+void throwIOException(JNIEnv* env, const std::string& message) {
+    if (env->ExceptionCheck()) return;  // 保留 InputStream.read 抛出的原始异常
+    jclass cls = env->FindClass("java/io/IOException");
+    if (cls != nullptr) env->ThrowNew(cls, message.c_str());
+}
+
+// 通过 JNI 回调 InputStream.read(byte[], int, int) 读取
+// JNIEnv 只在当前调用内有效，每次进入 JNI 时由调用方更新 env
+class JavaStreamSource : public andas::CsvSource {
+public:
+    JavaStreamSource(JNIEnv* env, jobject stream) : env(env) {
+        stream_ = env->NewGlobalRef(stream);
+        chunk_ = static_cast<jbyteArray>(env->NewGlobalRef(env->NewByteArray(kChunk)));
+        jclass cls = env->GetObjectClass(stream);
+        read_ = env->GetMethodID(cls, "read", "([BII)I");
+    }
+
+    void release(JNIEnv* current) {
+        current->DeleteGlobalRef(stream_);
+        current->DeleteGlobalRef(chunk_);
+    }
+
+    int64_t read(char* buffer, int64_t capacity) override {
+        const jint len = static_cast<jint>(capacity < kChunk ? capacity : kChunk);
+        jint n = env->CallIntMethod(stream_, read_, chunk_, 0, len);
+        if (env->ExceptionCheck()) return -1;
+        if (n <= 0) return 0;
+        andas::getArrayRegion(env, chunk_, 0, n, reinterpret_cast<jbyte*>(buffer));
+        return n;
+    }
+
+    JNIEnv* env;
+
+private:
+    static constexpr jint kChunk = 1 << 16;
+    jobject stream_;
+    jbyteArray chunk_;
+    jmethodID read_;
+};
+
+struct CsvHandle {
+    JavaStreamSource* stream = nullptr;  // 由 reader 持有，这里只用于更新 env
+    std::unique_ptr<andas::CsvReader> reader;
+};
+
+CsvHandle* handleFrom(JNIEnv* env, jlong handle) {
+    CsvHandle* h = reinterpret_cast<CsvHandle*>(handle);
+    if (h == nullptr) {
+        andas::throwIllegalArgument(env, "CSV读取器已关闭");
+        return nullptr;
+    }
+    if (h->stream != nullptr) h->stream->env = env;
+    return h;
+}
+
+jbyteArray toByteArray(JNIEnv* env, const char* data, size_t size) {
+    jbyteArray array = env->NewByteArray(static_cast<jsize>(size));
+    if (array != nullptr && size > 0) {
+        andas::setArrayRegion(env, array, 0, static_cast<jsize>(size), reinterpret_cast<const jbyte*>(data));
+    }
+    return array;
+}
+
+// 一列转为 (值数组, 字符串偏移, 有效位, 字典编号)，布局见 NativeCsv.nextBatch
+void putColumn(JNIEnv* env, jobjectArray out, jsize base, const andas::CsvColumn& column, int64_t rows) {
+    const jsize n = static_cast<jsize>(rows);
+    jobject values = nullptr;
+    jobject offsets = nullptr;
+    switch (column.type) {
+        case andas::CsvType::BOOL: {
+            std::vector<jboolean> tmp(static_cast<size_t>(n));
+            for (jsize i = 0; i < n; i++) tmp[static_cast<size_t>(i)] = column.ints[static_cast<size_t>(i)] ? JNI_TRUE : JNI_FALSE;
+            jbooleanArray array = env->NewBooleanArray(n);
+            if (array != nullptr) andas::setArrayRegion(env, array, 0, n, tmp.data());
+            values = array;
+            break;
+        }
+        case andas::CsvType::INT32: {
+            std::vector<jint> tmp(column.ints.begin(), column.ints.end());
+            jintArray array = env->NewIntArray(n);
+            if (array != nullptr) andas::setArrayRegion(env, array, 0, n, tmp.data());
+            values = array;
+            break;
+        }
+        case andas::CsvType::INT64: {
+            jlongArray array = env->NewLongArray(n);
+            if (array != nullptr) andas::setArrayRegion(env, array, 0, n, reinterpret_cast<const jlong*>(column.ints.data()));
+            values = array;
+            break;
+        }
+        case andas::CsvType::FLOAT64: {
+            jdoubleArray array = env->NewDoubleArray(n);
+            if (array != nullptr) andas::setArrayRegion(env, array, 0, n, column.doubles.data());
+            values = array;
+            break;
+        }
+        case andas::CsvType::STRING: {
+            if (column.dictionary != nullptr) {
+                // 字典编码：只返回本批新加入字典的条目和每行的编号
+                const andas::StringDictionary& dictionary = *column.dictionary;
+                const int64_t start = dictionary.offsets()[static_cast<size_t>(column.dictionaryBase)];
+                values = toByteArray(env, dictionary.heap().data() + start,
+                                     static_cast<size_t>(dictionary.offsets().back() - start));
+                const jsize added = dictionary.size() - column.dictionaryBase;
+                std::vector<jint> tmp(static_cast<size_t>(added) + 1);
+                for (jsize i = 0; i <= added; i++) {
+                    tmp[static_cast<size_t>(i)] = static_cast<jint>(
+                        dictionary.offsets()[static_cast<size_t>(column.dictionaryBase + i)] - start);
+                }
+                jintArray entryOffsets = env->NewIntArray(added + 1);
+                if (entryOffsets != nullptr) andas::setArrayRegion(env, entryOffsets, 0, added + 1, tmp.data());
+                offsets = entryOffsets;
+                jintArray codes = env->NewIntArray(n);
+                if (codes != nullptr) andas::setArrayRegion(env, codes, 0, n, column.codes.data());
+                env->SetObjectArrayElement(out, base + 3, codes);
+                if (codes != nullptr) env->DeleteLocalRef(codes);
+                break;
+            }
+            // 字符串以 UTF-8 字节和偏移返回，由 Kotlin 解码，避免 NewStringUTF 对非 BMP 字符的限制
+            values = toByteArray(env, column.chars.data(), column.chars.size());
+            std::vector<jint> tmp(column.offsets.begin(), column.offsets.end());
+            jintArray array = env->NewIntArray(n + 1);
+            if (array != nullptr) andas::setArrayRegion(env, array, 0, n + 1, tmp.data());
+            offsets = array;
+            break;
+        }
+        case andas::CsvType::EMPTY:
+            break;
+    }
+    env->SetObjectArrayElement(out, base, values);
+    env->SetObjectArrayElement(out, base + 1, offsets);
+    if (column.type != andas::CsvType::EMPTY && column.nullCount > 0) {
+        jbooleanArray valid = env->NewBooleanArray(n);
+        if (valid != nullptr) {
+            andas::setArrayRegion(env, valid, 0, n, reinterpret_cast<const jboolean*>(column.valid.data()));
+        }
+        env->SetObjectArrayElement(out, base + 2, valid);
+    }
+    if (values != nullptr) env->DeleteLocalRef(values);
+    if (offsets != nullptr) env->DeleteLocalRef(offsets);
+}
+
+} // namespace
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeCsv_open(
+    JNIEnv* env,
+    jobject /* this */,
+    jstring path,
+    jobject stream,
+    jchar delimiter,
+    jchar quote,
+    jboolean header,
+    jint skipLines,
+    jboolean trim,
+    jboolean inferTypes,
+    jobjectArray nullValues,
+    jint sampleRows,
+    jint chunkBytes,
+    jobjectArray columns,
+    jboolean dictionaryEncode
+) try {
+    ANDAS_JNI_SCOPE("NativeCsv.open");
+    if ((path == nullptr) == (stream == nullptr)) {
+        andas::throwIllegalArgument(env, "path 和 stream 必须且只能指定一个");
+        return 0;
+    }
+    if (delimiter >= 0x80 || quote >= 0x80 || delimiter == quote || delimiter == '\n' || quote == '\n') {
+        andas::throwIllegalArgument(env, "分隔符和引号必须是不同的ASCII字符");
+        return 0;
+    }
+
+    andas::CsvOptions options;
+    options.delimiter = static_cast<char>(delimiter);
+    options.quote = static_cast<char>(quote);
+    options.header = header == JNI_TRUE;
+    options.skipLines = skipLines;
+    options.trim = trim == JNI_TRUE;
+    options.inferTypes = inferTypes == JNI_TRUE;
+    options.sampleRows = sampleRows;
+    if (chunkBytes > 0) options.chunkBytes = chunkBytes;
+    options.dictionaryEncode = dictionaryEncode == JNI_TRUE;
+    options.nullValues.clear();
+    const jsize nullCount = nullValues != nullptr ? env->GetArrayLength(nullValues) : 0;
+    for (jsize i = 0; i < nullCount; i++) {
+        jstring value = static_cast<jstring>(env->GetObjectArrayElement(nullValues, i));
+        if (value == nullptr) continue;
+        const char* chars = env->GetStringUTFChars(value, nullptr);
+        options.nullValues.emplace_back(chars);
+        env->ReleaseStringUTFChars(value, chars);
+        env->DeleteLocalRef(value);
+    }
+    const jsize columnCount = columns != nullptr ? env->GetArrayLength(columns) : 0;
+    for (jsize i = 0; i < columnCount; i++) {
+        jstring name = static_cast<jstring>(env->GetObjectArrayElement(columns, i));
+        if (name == nullptr) {
+            andas::throwIllegalArgument(env, "列名不能为 null");
+            return 0;
+        }
+        const char* chars = env->GetStringUTFChars(name, nullptr);
+        options.columns.emplace_back(chars);
+        env->ReleaseStringUTFChars(name, chars);
+        env->DeleteLocalRef(name);
+    }
+
+    std::unique_ptr<CsvHandle> handle(new CsvHandle());
+    std::unique_ptr<andas::CsvSource> source;
+    if (path != nullptr) {
+        const char* chars = env->GetStringUTFChars(path, nullptr);
+        int fd = ::open(chars, O_RDONLY | O_CLOEXEC);
+        std::string name(chars);
+        env->ReleaseStringUTFChars(path, chars);
+        if (fd < 0) {
+            throwIOException(env, "无法打开文件: " + name);
+            return 0;
+        }
+        // 文件由后台线程预读，磁盘读取与解析重叠；预读量约为一个读取块
+        const int64_t blockBytes = std::max<int64_t>(options.chunkBytes / kPrefetchDepth, 64 << 10);
+        source.reset(new andas::PrefetchCsvSource(
+            std::unique_ptr<andas::CsvSource>(new andas::FdCsvSource(fd, true)), blockBytes, kPrefetchDepth));
+    } else {
+        handle->stream = new JavaStreamSource(env, stream);
+        source.reset(handle->stream);
+    }
+    handle->reader.reset(new andas::CsvReader(std::move(source), std::move(options)));
+    return reinterpret_cast<jlong>(handle.release());
+} ANDAS_JNI_CATCH(env, 0)
+
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeCsv_columnNames(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeCsv.columnNames");
+    CsvHandle* h = handleFrom(env, handle);
+    if (h == nullptr) return nullptr;
+    const std::vector<std::string>& names = h->reader->columnNames();
+    if (!h->reader->error().empty()) {
+        throwIOException(env, h->reader->error());
+        return nullptr;
+    }
+    jclass byteArrayClass = env->FindClass("[B");
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(names.size()), byteArrayClass, nullptr);
+    for (size_t i = 0; i < names.size(); i++) {
+        jbyteArray name = toByteArray(env, names[i].data(), names[i].size());
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), name);
+        env->DeleteLocalRef(name);
+    }
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeCsv_nextBatch(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle,
+    jint maxRows
+) try {
+    ANDAS_JNI_SCOPE("NativeCsv.nextBatch");
+    CsvHandle* h = handleFrom(env, handle);
+    if (h == nullptr) return nullptr;
+    if (maxRows <= 0) {
+        andas::throwIllegalArgument(env, "maxRows 必须为正数");
+        return nullptr;
+    }
+    andas::CsvBatch batch;
+    if (!h->reader->next(batch, maxRows)) {
+        if (!h->reader->error().empty()) throwIOException(env, h->reader->error());
+        return nullptr;
+    }
+
+    const jsize columns = static_cast<jsize>(batch.columns.size());
+    jclass objectClass = env->FindClass("java/lang/Object");
+    jobjectArray result = env->NewObjectArray(1 + 4 * columns, objectClass, nullptr);
+    if (result == nullptr) return nullptr;
+
+    std::vector<jint> header(static_cast<size_t>(columns) + 1);
+    header[0] = static_cast<jint>(batch.rows);
+    for (jsize c = 0; c < columns; c++) header[static_cast<size_t>(c) + 1] = static_cast<jint>(batch.columns[static_cast<size_t>(c)].type);
+    jintArray headerArray = env->NewIntArray(columns + 1);
+    andas::setArrayRegion(env, headerArray, 0, columns + 1, header.data());
+    env->SetObjectArrayElement(result, 0, headerArray);
+    env->DeleteLocalRef(headerArray);
+
+    for (jsize c = 0; c < columns; c++) {
+        putColumn(env, result, 1 + 4 * c, batch.columns[static_cast<size_t>(c)], batch.rows);
+    }
+    return result;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeCsv_close(
+    JNIEnv* env,
+    jobject /* this */,
+    jlong handle
+) try {
+    ANDAS_JNI_SCOPE("NativeCsv.close");
+    CsvHandle* h = reinterpret_cast<CsvHandle*>(handle);
+    if (h == nullptr) return;
+    if (h->stream != nullptr) h->stream->release(env);
+    delete h;
+} ANDAS_JNI_CATCH(env)
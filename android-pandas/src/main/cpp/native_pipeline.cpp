@@ -0,0 +1,259 @@
+#include <jni.h>
+#include <cstdint>
+#include <vector>
+#include "filter_engine.h"
+#include "jni_utils.h"
+#include "pipeline_engine.h"
+
+// LazyFrame 融合流水线的 JNI 包装，见 pipeline_engine.h
+// 两个入口的参数相同：
+// - inputs: 表达式引用的输入列 double[]，长度均为 rowCount
+// - filterColumns/filterProgram/filterDoubles/filterLongs: 与 NativeData.filterRowsArrays 的编码相同，
+//   filterProgram 为空数组时不筛选
+// - expressions: 各输出表达式的指令依次拼接，每条指令 2 个 int: (op, arg)；expressionLengths 为每个表达式的指令条数
+// - constants: 表达式常量池
+
+namespace {
+
+struct PinnedColumn {
+    jarray array = nullptr;
+    void* elements = nullptr;
+    bool isDouble = true;
+};
+
+class PipelineArgs {
+public:
+    explicit PipelineArgs(JNIEnv* env) : env_(env) {}
+
+    // 参数不合法时抛出 IllegalArgumentException 并返回 false，调用方仍需 release
+    bool prepare(jint rowCount, jobjectArray inputs, jobjectArray filterColumns, jintArray filterProgram,
+                 jdoubleArray filterDoubles, jlongArray filterLongs, jintArray expressions,
+                 jintArray expressionLengths, jdoubleArray constants) {
+        if (rowCount < 0) return fail("行数不能为负");
+        rows_ = rowCount;
+
+        const jsize inputCount = env_->GetArrayLength(inputs);
+        inputs_.resize(static_cast<size_t>(inputCount));
+        inputPointers_.resize(static_cast<size_t>(inputCount));
+        for (jsize c = 0; c < inputCount; c++) {
+            jdoubleArray array = static_cast<jdoubleArray>(env_->GetObjectArrayElement(inputs, c));
+            if (array == nullptr || env_->GetArrayLength(array) != rowCount) return fail("输入列长度与行数不一致");
+            inputs_[static_cast<size_t>(c)].array = array;
+            inputs_[static_cast<size_t>(c)].elements = andas::getArrayElements(env_, array);
+            if (inputs_[static_cast<size_t>(c)].elements == nullptr) return false;
+            inputPointers_[static_cast<size_t>(c)] = static_cast<const double*>(inputs_[static_cast<size_t>(c)].elements);
+        }
+
+        if (!prepareFilter(filterColumns, filterProgram, filterDoubles, filterLongs)) return false;
+
+        const jsize outputCount = env_->GetArrayLength(expressionLengths);
+        const jsize codeLength = env_->GetArrayLength(expressions);
+        std::vector<jint> lengths(static_cast<size_t>(outputCount));
+        andas::getArrayRegion(env_, expressionLengths, 0, outputCount, lengths.data());
+        int64_t total = 0;
+        for (jint length : lengths) {
+            if (length <= 0) return fail("表达式为空");
+            total += length;
+        }
+        if (total * 2 != codeLength) return fail("表达式指令长度与各表达式长度之和不一致");
+        std::vector<jint> codes(static_cast<size_t>(codeLength));
+        andas::getArrayRegion(env_, expressions, 0, codeLength, codes.data());
+        instructions_.resize(static_cast<size_t>(total));
+        for (size_t i = 0; i < instructions_.size(); i++) {
+            if (!andas::isValidExprOp(codes[i * 2])) return fail("不支持的表达式操作");
+            instructions_[i] = {static_cast<andas::ExprOp>(codes[i * 2]), codes[i * 2 + 1]};
+        }
+        int64_t offset = 0;
+        for (jint length : lengths) {
+            programs_.push_back({instructions_.data() + offset, length});
+            offset += length;
+        }
+
+        const jsize constantCount = env_->GetArrayLength(constants);
+        constants_.resize(static_cast<size_t>(constantCount));
+        andas::getArrayRegion(env_, constants, 0, constantCount, constants_.data());
+
+        spec_ = andas::PipelineSpec{inputPointers_.data(), inputCount, hasFilter_ ? &filter_ : nullptr,
+                                    programs_.data(), outputCount, constants_.data(), constantCount};
+        const char* error = andas::validatePipeline(spec_);
+        return error == nullptr || fail(error);
+    }
+
+    void release() {
+        for (PinnedColumn& column : inputs_) releaseColumn(column);
+        for (PinnedColumn& column : filterColumns_) releaseColumn(column);
+    }
+
+    const andas::PipelineSpec& spec() const { return spec_; }
+    int64_t rows() const { return rows_; }
+
+private:
+    bool prepareFilter(jobjectArray columns, jintArray program, jdoubleArray doubles, jlongArray longs) {
+        const jsize programLength = env_->GetArrayLength(program);
+        if (programLength == 0) return true;
+        hasFilter_ = true;
+        const jsize columnCount = env_->GetArrayLength(columns);
+        const jsize constantCount = env_->GetArrayLength(doubles);
+        if (programLength % 4 != 0) return fail("筛选指令长度不是4的倍数");
+        if (env_->GetArrayLength(longs) != constantCount) return fail("筛选常量池长度不一致");
+
+        jclass doubleArrayClass = env_->FindClass("[D");
+        filterColumns_.resize(static_cast<size_t>(columnCount));
+        filterColumnSpecs_.resize(static_cast<size_t>(columnCount));
+        for (jsize c = 0; c < columnCount; c++) {
+            jarray array = static_cast<jarray>(env_->GetObjectArrayElement(columns, c));
+            if (array == nullptr || env_->GetArrayLength(array) != rows_) {
+                env_->DeleteLocalRef(doubleArrayClass);
+                return fail("筛选列长度与行数不一致");
+            }
+            PinnedColumn& column = filterColumns_[static_cast<size_t>(c)];
+            column.array = array;
+            column.isDouble = env_->IsInstanceOf(array, doubleArrayClass);
+            if (column.isDouble) {
+                column.elements = andas::getArrayElements(env_, static_cast<jdoubleArray>(array));
+            } else {
+                column.elements = andas::getArrayElements(env_, static_cast<jlongArray>(array));
+            }
+            if (column.elements == nullptr) {
+                env_->DeleteLocalRef(doubleArrayClass);
+                return false;
+            }
+            filterColumnSpecs_[static_cast<size_t>(c)] = {
+                column.isDouble ? andas::FilterColumnType::FLOAT64 : andas::FilterColumnType::INT64, column.elements};
+        }
+        env_->DeleteLocalRef(doubleArrayClass);
+
+        std::vector<jint> codes(static_cast<size_t>(programLength));
+        andas::getArrayRegion(env_, program, 0, programLength, codes.data());
+        filterInstructions_.resize(static_cast<size_t>(programLength / 4));
+        for (size_t i = 0; i < filterInstructions_.size(); i++) {
+            filterInstructions_[i] = {static_cast<andas::FilterOp>(codes[i * 4]), codes[i * 4 + 1], codes[i * 4 + 2],
+                                      codes[i * 4 + 3]};
+        }
+        filterDoubles_.resize(static_cast<size_t>(constantCount));
+        filterLongs_.resize(static_cast<size_t>(constantCount));
+        andas::getArrayRegion(env_, doubles, 0, constantCount, filterDoubles_.data());
+        andas::getArrayRegion(env_, longs, 0, constantCount, reinterpret_cast<jlong*>(filterLongs_.data()));
+        filter_ = andas::FilterProgram{filterColumnSpecs_.data(), columnCount,
+                                       filterInstructions_.data(), static_cast<int32_t>(filterInstructions_.size()),
+                                       filterDoubles_.data(), filterLongs_.data(), constantCount};
+        const char* error = andas::validateFilter(filter_);
+        return error == nullptr || fail(error);
+    }
+
+    bool fail(const char* message) {
+        andas::throwIllegalArgument(env_, message);
+        return false;
+    }
+
+    void releaseColumn(PinnedColumn& column) {
+        if (column.elements == nullptr) return;
+        if (column.isDouble) {
+            andas::releaseArrayElements(env_, static_cast<jdoubleArray>(column.array),
+                                        static_cast<jdouble*>(column.elements), JNI_ABORT);
+        } else {
+            andas::releaseArrayElements(env_, static_cast<jlongArray>(column.array),
+                                        static_cast<jlong*>(column.elements), JNI_ABORT);
+        }
+        column.elements = nullptr;
+    }
+
+    JNIEnv* env_;
+    int64_t rows_ = 0;
+    std::vector<PinnedColumn> inputs_;
+    std::vector<const double*> inputPointers_;
+    bool hasFilter_ = false;
+    std::vector<PinnedColumn> filterColumns_;
+    std::vector<andas::FilterColumn> filterColumnSpecs_;
+    std::vector<andas::FilterInstruction> filterInstructions_;
+    std::vector<double> filterDoubles_;
+    std::vector<int64_t> filterLongs_;
+    andas::FilterProgram filter_{};
+    std::vector<andas::ExprInstruction> instructions_;
+    std::vector<andas::ExprProgram> programs_;
+    std::vector<double> constants_;
+    andas::PipelineSpec spec_{};
+};
+
+} // namespace
+
+// 返回 [选中的行号 int[]（不筛选时为 null）, 每个输出表达式一个 double[]]
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativePipeline_run(
+        JNIEnv* env,
+        jobject /* this */,
+        jint rowCount,
+        jobjectArray inputs,
+        jobjectArray filterColumns,
+        jintArray filterProgram,
+        jdoubleArray filterDoubles,
+        jlongArray filterLongs,
+        jintArray expressions,
+        jintArray expressionLengths,
+        jdoubleArray constants
+) try {
+    ANDAS_JNI_SCOPE("NativePipeline.run");
+    PipelineArgs args(env);
+    if (!args.prepare(rowCount, inputs, filterColumns, filterProgram, filterDoubles, filterLongs,
+                      expressions, expressionLengths, constants)) {
+        args.release();
+        return nullptr;
+    }
+    const andas::PipelineResult result = andas::runPipeline(args.spec(), args.rows());
+    args.release();
+
+    jclass objectClass = env->FindClass("java/lang/Object");
+    const jsize outputCount = static_cast<jsize>(result.columns.size());
+    jobjectArray out = env->NewObjectArray(1 + outputCount, objectClass, nullptr);
+    if (out == nullptr) return nullptr;
+    const jsize size = static_cast<jsize>(result.rowCount);
+    if (args.spec().filter != nullptr) {
+        jintArray rows = env->NewIntArray(size);
+        if (rows == nullptr) return nullptr;
+        andas::setArrayRegion(env, rows, 0, size, result.rows.data());
+        env->SetObjectArrayElement(out, 0, rows);
+        env->DeleteLocalRef(rows);
+    }
+    for (jsize o = 0; o < outputCount; o++) {
+        jdoubleArray column = env->NewDoubleArray(size);
+        if (column == nullptr) return nullptr;
+        andas::setArrayRegion(env, column, 0, size, result.columns[static_cast<size_t>(o)].data());
+        env->SetObjectArrayElement(out, 1 + o, column);
+        env->DeleteLocalRef(column);
+    }
+    return out;
+} ANDAS_JNI_CATCH(env, nullptr)
+
+// 返回每个输出表达式在选中行上的矩，按 MomentAccumulator 的打包格式依次拼接
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativePipeline_moments(
+        JNIEnv* env,
+        jobject /* this */,
+        jint rowCount,
+        jobjectArray inputs,
+        jobjectArray filterColumns,
+        jintArray filterProgram,
+        jdoubleArray filterDoubles,
+        jlongArray filterLongs,
+        jintArray expressions,
+        jintArray expressionLengths,
+        jdoubleArray constants
+) try {
+    ANDAS_JNI_SCOPE("NativePipeline.moments");
+    PipelineArgs args(env);
+    if (!args.prepare(rowCount, inputs, filterColumns, filterProgram, filterDoubles, filterLongs,
+                      expressions, expressionLengths, constants)) {
+        args.release();
+        return nullptr;
+    }
+    const std::vector<andas::MomentAccumulator> moments = andas::pipelineMoments(args.spec(), args.rows());
+    args.release();
+
+    const int32_t width = andas::MomentAccumulator::kPackedSize;
+    std::vector<double> packed(moments.size() * width);
+    for (size_t o = 0; o < moments.size(); o++) moments[o].pack(packed.data() + o * width);
+    const jsize size = static_cast<jsize>(packed.size());
+    jdoubleArray out = env->NewDoubleArray(size);
+    if (out != nullptr) andas::setArrayRegion(env, out, 0, size, packed.data());
+    return out;
+} ANDAS_JNI_CATCH(env, nullptr)
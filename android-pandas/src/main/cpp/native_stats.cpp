@@ -0,0 +1,95 @@
+#include <jni.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "instrumentation.h"
+#include "jni_utils.h"
+
+// 原生埋点的查询接口：计数快照、重置、开关和追踪导出，见 instrumentation.h
+// 这些入口本身不计入统计
+
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeStats_names(
+    JNIEnv* env,
+    jobject /* this */
+) {
+    const std::vector<std::string> names = andas::stats::names();
+    jclass stringClass = env->FindClass("java/lang/String");
+    if (stringClass == nullptr) return nullptr;
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(names.size()), stringClass, nullptr);
+    if (result == nullptr) return nullptr;
+    for (size_t i = 0; i < names.size(); i++) {
+        jstring name = env->NewStringUTF(names[i].c_str());
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), name);
+        env->DeleteLocalRef(name);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeStats_counters(
+    JNIEnv* env,
+    jobject /* this */
+) {
+    const std::vector<int64_t> values = andas::stats::snapshot();
+    jlongArray result = env->NewLongArray(static_cast<jsize>(values.size()));
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, static_cast<jsize>(values.size()),
+                                reinterpret_cast<const jlong*>(values.data()));
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeStats_fieldCount(
+    JNIEnv* /* env */,
+    jobject /* this */
+) {
+    return andas::stats::kFieldCount;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeStats_resetCounters(
+    JNIEnv* /* env */,
+    jobject /* this */
+) {
+    andas::stats::reset();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeStats_setEnabledNative(
+    JNIEnv* /* env */,
+    jobject /* this */,
+    jboolean enabled
+) {
+    andas::stats::setEnabled(enabled == JNI_TRUE);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeStats_isEnabledNative(
+    JNIEnv* /* env */,
+    jobject /* this */
+) {
+    return andas::stats::enabled() ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeStats_startTraceNative(
+    JNIEnv* env,
+    jobject /* this */,
+    jint eventsPerThread
+) {
+    if (eventsPerThread <= 0) {
+        andas::throwIllegalArgument(env, "每个线程的追踪事件数必须为正数");
+        return;
+    }
+    andas::stats::startTrace(eventsPerThread);
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_cn_ac_oac_libs_andas_core_NativeStats_stopTraceNative(
+    JNIEnv* env,
+    jobject /* this */
+) {
+    return env->NewStringUTF(andas::stats::stopTrace().c_str());
+}
@@ -0,0 +1,375 @@
+#include "pipeline_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include "memory_pool.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+namespace {
+
+// 一个数据块中参与计算的行：dense 时为 [begin, begin + count)，否则为 begin + sel[i]
+struct Morsel {
+    int64_t begin;
+    int64_t count;
+    bool dense;
+    const int32_t* sel;
+};
+
+int32_t maxDepthOf(const ExprProgram& program) {
+    int32_t depth = 0;
+    int32_t maxDepth = 0;
+    for (int32_t i = 0; i < program.instructionCount; i++) {
+        depth += 1 - exprOpArity(program.instructions[i].op);
+        maxDepth = std::max(maxDepth, depth);
+    }
+    return maxDepth;
+}
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// 比较与逻辑运算的结果：任一侧缺失时为 NaN，否则为 1/0
+template <typename Predicate>
+void compareBlock(double* a, const double* b, int64_t n, Predicate predicate) {
+    for (int64_t r = 0; r < n; r++) {
+        const double x = a[r];
+        const double y = b[r];
+        a[r] = x != x || y != y ? kNaN : (predicate(x, y) ? 1.0 : 0.0);
+    }
+}
+
+// 在 stack 上求值一个表达式，结果留在 stack 的第一段；每段 kMorselRows 个元素
+void evaluateExpr(const PipelineSpec& spec, const ExprProgram& program, const Morsel& m, double* stack) {
+    const int64_t n = m.count;
+    int32_t depth = 0;
+    for (int32_t i = 0; i < program.instructionCount; i++) {
+        const ExprInstruction& ins = program.instructions[i];
+        double* top = stack + static_cast<int64_t>(depth) * kMorselRows;
+        double* a = top - 2 * kMorselRows;
+        const double* b = top - kMorselRows;
+        double* x = top - kMorselRows;   // 一元运算的操作数
+        switch (ins.op) {
+            case ExprOp::COLUMN: {
+                const double* src = spec.inputs[ins.arg] + m.begin;
+                if (m.dense) {
+                    std::memcpy(top, src, static_cast<size_t>(n) * sizeof(double));
+                } else {
+                    for (int64_t r = 0; r < n; r++) top[r] = src[m.sel[r]];
+                }
+                depth++;
+                break;
+            }
+            case ExprOp::CONST:
+                std::fill(top, top + n, spec.constants[ins.arg]);
+                depth++;
+                break;
+            case ExprOp::ADD:
+                for (int64_t r = 0; r < n; r++) a[r] += b[r];
+                depth--;
+                break;
+            case ExprOp::SUB:
+                for (int64_t r = 0; r < n; r++) a[r] -= b[r];
+                depth--;
+                break;
+            case ExprOp::MUL:
+                for (int64_t r = 0; r < n; r++) a[r] *= b[r];
+                depth--;
+                break;
+            case ExprOp::DIV:
+                for (int64_t r = 0; r < n; r++) a[r] /= b[r];
+                depth--;
+                break;
+            case ExprOp::FILL_NULL:
+                for (int64_t r = 0; r < n; r++) a[r] = a[r] == a[r] ? a[r] : b[r];
+                depth--;
+                break;
+            case ExprOp::NEG:
+                for (int64_t r = 0; r < n; r++) x[r] = -x[r];
+                break;
+            case ExprOp::NORMALIZE: {
+                const double mean = spec.constants[ins.arg];
+                const double sd = spec.constants[ins.arg + 1];
+                if (sd > 0.0) {
+                    const double scale = 1.0 / sd;
+                    for (int64_t r = 0; r < n; r++) x[r] = (x[r] - mean) * scale;
+                } else {
+                    for (int64_t r = 0; r < n; r++) x[r] = x[r] == x[r] ? 0.0 : x[r];
+                }
+                break;
+            }
+            case ExprOp::ABS:
+                for (int64_t r = 0; r < n; r++) x[r] = std::fabs(x[r]);
+                break;
+            case ExprOp::SQRT:
+                for (int64_t r = 0; r < n; r++) x[r] = std::sqrt(x[r]);
+                break;
+            case ExprOp::EXP: simd::active().exp(x, x, n); break;
+            case ExprOp::LOG: simd::active().log(x, x, n); break;
+            case ExprOp::SIN: simd::active().sin(x, x, n); break;
+            case ExprOp::COS: simd::active().cos(x, x, n); break;
+            case ExprOp::POW:
+                // exp(b * log(a)) 会把 log 的舍入误差放大 |b * log(a)| 倍，pow 保持逐元素的 libm 结果
+                for (int64_t r = 0; r < n; r++) a[r] = std::pow(a[r], b[r]);
+                depth--;
+                break;
+            case ExprOp::LT: compareBlock(a, b, n, [](double p, double q) { return p < q; }); depth--; break;
+            case ExprOp::LE: compareBlock(a, b, n, [](double p, double q) { return p <= q; }); depth--; break;
+            case ExprOp::GT: compareBlock(a, b, n, [](double p, double q) { return p > q; }); depth--; break;
+            case ExprOp::GE: compareBlock(a, b, n, [](double p, double q) { return p >= q; }); depth--; break;
+            case ExprOp::EQ: compareBlock(a, b, n, [](double p, double q) { return p == q; }); depth--; break;
+            case ExprOp::NE: compareBlock(a, b, n, [](double p, double q) { return p != q; }); depth--; break;
+            case ExprOp::AND: compareBlock(a, b, n, [](double p, double q) { return p != 0.0 && q != 0.0; }); depth--; break;
+            case ExprOp::OR: compareBlock(a, b, n, [](double p, double q) { return p != 0.0 || q != 0.0; }); depth--; break;
+            case ExprOp::NOT:
+                for (int64_t r = 0; r < n; r++) x[r] = x[r] != x[r] ? kNaN : (x[r] == 0.0 ? 1.0 : 0.0);
+                break;
+            case ExprOp::CLIP: {
+                double* v = top - 3 * kMorselRows;
+                const double* lo = a;
+                const double* hi = b;
+                // NaN 边界的比较为 false，相当于不限制；NaN 值保持不变
+                for (int64_t r = 0; r < n; r++) {
+                    double y = v[r];
+                    y = y < lo[r] ? lo[r] : y;
+                    v[r] = y > hi[r] ? hi[r] : y;
+                }
+                depth -= 2;
+                break;
+            }
+            case ExprOp::WHERE: {
+                double* cond = top - 3 * kMorselRows;
+                for (int64_t r = 0; r < n; r++) {
+                    const double c = cond[r];
+                    cond[r] = c != c ? kNaN : (c != 0.0 ? a[r] : b[r]);
+                }
+                depth -= 2;
+                break;
+            }
+        }
+    }
+}
+
+// 按数据块切分的并行计划，各段包含连续的若干块
+struct MorselPlan {
+    int64_t morsels;
+    int64_t chunks;
+    int64_t grain;   // 每段的块数
+};
+
+MorselPlan planMorsels(int64_t n) {
+    const int64_t morsels = (n + kMorselRows - 1) / kMorselRows;
+    if (morsels <= 1 || detail::shouldRunSerial(n)) return {morsels, 1, std::max<int64_t>(morsels, 1)};
+    const detail::ChunkPlan plan = detail::planChunks(morsels, ThreadPool::instance().threadCount(), 1);
+    return {morsels, plan.chunks, plan.grain};
+}
+
+// 对第 chunk 段的每个数据块调用 visit(morsel)，筛选和表达式求值所需的临时空间都在当前线程的分配区中
+class MorselRunner {
+public:
+    MorselRunner(const PipelineSpec& spec, int64_t n) : spec_(spec), n_(n), plan_(planMorsels(n)) {
+        if (spec.filter != nullptr) filter_.reset(new FilterBlockEvaluator(*spec.filter));
+        for (int32_t o = 0; o < spec.outputCount; o++) depth_ = std::max(depth_, maxDepthOf(spec.outputs[o]));
+    }
+
+    const MorselPlan& plan() const { return plan_; }
+    int32_t stackDepth() const { return depth_; }
+
+    template <typename Visit>
+    void run(Visit&& visit) {
+        std::function<void(int64_t)> task = [&](int64_t chunk) {
+            ScratchBuffer<uint64_t> filterStack(filter_ ? filter_->stackWords() : 0);
+            ScratchBuffer<uint64_t> bits(kFilterBlockWords);
+            ScratchBuffer<int32_t> sel(filter_ ? kMorselRows : 0);
+            const int64_t first = chunk * plan_.grain;
+            const int64_t last = std::min(plan_.morsels, first + plan_.grain);
+            for (int64_t k = first; k < last; k++) {
+                const int64_t begin = k * kMorselRows;
+                const int64_t rows = std::min(kMorselRows, n_ - begin);
+                Morsel m{begin, rows, true, nullptr};
+                if (filter_) {
+                    filter_->evaluate(begin, rows, filterStack.data(), bits.data());
+                    int64_t count = 0;
+                    for (int64_t w = 0; w < (rows + 63) / 64; w++) {
+                        uint64_t word = bits[w];
+                        while (word != 0) {
+                            sel[count++] = static_cast<int32_t>(w * 64 + __builtin_ctzll(word));
+                            word &= word - 1;
+                        }
+                    }
+                    m.count = count;
+                    m.dense = count == rows;
+                    m.sel = sel.data();
+                }
+                visit(chunk, m);
+            }
+        };
+        if (plan_.chunks == 1) {
+            task(0);
+        } else {
+            ThreadPool::instance().run(plan_.chunks, task);
+        }
+    }
+
+private:
+    const PipelineSpec& spec_;
+    int64_t n_;
+    MorselPlan plan_;
+    std::unique_ptr<FilterBlockEvaluator> filter_;
+    int32_t depth_ = 1;
+};
+
+} // namespace
+
+bool isValidExprOp(int32_t op) {
+    return op >= static_cast<int32_t>(ExprOp::COLUMN) && op <= static_cast<int32_t>(ExprOp::NOT);
+}
+
+int32_t exprOpArity(ExprOp op) {
+    switch (op) {
+        case ExprOp::COLUMN:
+        case ExprOp::CONST: return 0;
+        case ExprOp::NEG:
+        case ExprOp::NORMALIZE:
+        case ExprOp::ABS:
+        case ExprOp::SQRT:
+        case ExprOp::EXP:
+        case ExprOp::LOG:
+        case ExprOp::SIN:
+        case ExprOp::COS:
+        case ExprOp::NOT: return 1;
+        case ExprOp::CLIP:
+        case ExprOp::WHERE: return 3;
+        default: return 2;
+    }
+}
+
+const char* validatePipeline(const PipelineSpec& spec) {
+    if (spec.inputCount < 0 || spec.outputCount < 0 || spec.constantCount < 0) return "流水线参数不合法";
+    for (int32_t o = 0; o < spec.outputCount; o++) {
+        const ExprProgram& program = spec.outputs[o];
+        if (program.instructionCount <= 0) return "表达式为空";
+        int32_t depth = 0;
+        for (int32_t i = 0; i < program.instructionCount; i++) {
+            const ExprInstruction& ins = program.instructions[i];
+            if (!isValidExprOp(static_cast<int32_t>(ins.op))) return "不支持的表达式操作";
+            switch (ins.op) {
+                case ExprOp::COLUMN:
+                    if (ins.arg < 0 || ins.arg >= spec.inputCount) return "表达式输入列下标越界";
+                    depth++;
+                    break;
+                case ExprOp::CONST:
+                    if (ins.arg < 0 || ins.arg >= spec.constantCount) return "表达式常量下标越界";
+                    depth++;
+                    break;
+                case ExprOp::NORMALIZE:
+                    if (depth < 1) return "表达式指令缺少操作数";
+                    if (ins.arg < 0 || static_cast<int64_t>(ins.arg) + 2 > spec.constantCount) return "表达式常量下标越界";
+                    break;
+                default: {
+                    const int32_t arity = exprOpArity(ins.op);
+                    if (depth < arity) return "表达式指令缺少操作数";
+                    depth += 1 - arity;
+                    break;
+                }
+            }
+        }
+        if (depth != 1) return "表达式没有组合成单个值";
+    }
+    return nullptr;
+}
+
+PipelineResult runPipeline(const PipelineSpec& spec, int64_t n) {
+    PipelineResult result;
+    result.columns.resize(static_cast<size_t>(spec.outputCount));
+    if (n <= 0) return result;
+    MorselRunner runner(spec, n);
+    const int64_t stackSize = static_cast<int64_t>(runner.stackDepth()) * kMorselRows;
+
+    if (spec.filter == nullptr) {
+        // 不筛选时每块的输出位置已知，直接写入结果
+        result.rowCount = n;
+        for (auto& column : result.columns) column.resize(static_cast<size_t>(n));
+        runner.run([&](int64_t, const Morsel& m) {
+            ScratchBuffer<double> stack(stackSize);
+            for (int32_t o = 0; o < spec.outputCount; o++) {
+                evaluateExpr(spec, spec.outputs[o], m, stack.data());
+                std::memcpy(result.columns[static_cast<size_t>(o)].data() + m.begin, stack.data(),
+                            static_cast<size_t>(m.count) * sizeof(double));
+            }
+        });
+        return result;
+    }
+
+    // 筛选后的行数事先未知：各段先写入自己的缓冲，再按段顺序拼接
+    struct Part {
+        std::vector<int32_t> rows;
+        std::vector<std::vector<double>> columns;
+    };
+    std::vector<Part> parts(static_cast<size_t>(runner.plan().chunks));
+    for (Part& part : parts) part.columns.resize(static_cast<size_t>(spec.outputCount));
+    runner.run([&](int64_t chunk, const Morsel& m) {
+        if (m.count == 0) return;
+        Part& part = parts[static_cast<size_t>(chunk)];
+        if (m.dense) {
+            for (int64_t r = 0; r < m.count; r++) part.rows.push_back(static_cast<int32_t>(m.begin + r));
+        } else {
+            for (int64_t r = 0; r < m.count; r++) part.rows.push_back(static_cast<int32_t>(m.begin + m.sel[r]));
+        }
+        ScratchBuffer<double> stack(stackSize);
+        for (int32_t o = 0; o < spec.outputCount; o++) {
+            evaluateExpr(spec, spec.outputs[o], m, stack.data());
+            part.columns[static_cast<size_t>(o)].insert(part.columns[static_cast<size_t>(o)].end(),
+                                                        stack.data(), stack.data() + m.count);
+        }
+    });
+
+    std::vector<int64_t> offsets(parts.size() + 1, 0);
+    for (size_t p = 0; p < parts.size(); p++) offsets[p + 1] = offsets[p] + static_cast<int64_t>(parts[p].rows.size());
+    result.rowCount = offsets.back();
+    if (parts.size() == 1) {
+        result.rows = std::move(parts[0].rows);
+        result.columns = std::move(parts[0].columns);
+        return result;
+    }
+    result.rows.resize(static_cast<size_t>(result.rowCount));
+    for (auto& column : result.columns) column.resize(static_cast<size_t>(result.rowCount));
+    std::function<void(int64_t)> concat = [&](int64_t p) {
+        Part& part = parts[static_cast<size_t>(p)];
+        std::copy(part.rows.begin(), part.rows.end(), result.rows.begin() + offsets[static_cast<size_t>(p)]);
+        for (int32_t o = 0; o < spec.outputCount; o++) {
+            const std::vector<double>& src = part.columns[static_cast<size_t>(o)];
+            std::copy(src.begin(), src.end(), result.columns[static_cast<size_t>(o)].begin() + offsets[static_cast<size_t>(p)]);
+        }
+    };
+    ThreadPool::instance().run(static_cast<int64_t>(parts.size()), concat);
+    return result;
+}
+
+std::vector<MomentAccumulator> pipelineMoments(const PipelineSpec& spec, int64_t n) {
+    std::vector<MomentAccumulator> total(static_cast<size_t>(spec.outputCount));
+    if (n <= 0) return total;
+    MorselRunner runner(spec, n);
+    const int64_t stackSize = static_cast<int64_t>(runner.stackDepth()) * kMorselRows;
+    // 每段一组部分结果，最后按段顺序合并，结果与线程调度无关
+    std::vector<std::vector<MomentAccumulator>> parts(static_cast<size_t>(runner.plan().chunks), total);
+    runner.run([&](int64_t chunk, const Morsel& m) {
+        if (m.count == 0) return;
+        ScratchBuffer<double> stack(stackSize);
+        std::vector<MomentAccumulator>& local = parts[static_cast<size_t>(chunk)];
+        for (int32_t o = 0; o < spec.outputCount; o++) {
+            evaluateExpr(spec, spec.outputs[o], m, stack.data());
+            local[static_cast<size_t>(o)].merge(computeMoments(stack.data(), m.count, MomentOrder::VARIANCE));
+        }
+    });
+    for (const auto& part : parts) {
+        for (size_t o = 0; o < total.size(); o++) total[o].merge(part[o]);
+    }
+    return total;
+}
+
+} // namespace andas
@@ -0,0 +1,102 @@
+#ifndef ANDAS_PIPELINE_ENGINE_H
+#define ANDAS_PIPELINE_ENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include "filter_engine.h"
+#include "moments.h"
+
+namespace andas {
+
+// 融合执行的查询流水线（不依赖JNI）
+// - 上层（LazyFrame）把筛选条件和逐元素运算优化、合并后交给这里一次执行：
+//   输入按 kMorselRows 行切成数据块，每块先求值筛选位图，再只对选中的行求值各输出表达式，
+//   中间结果只存在于块大小的临时栈中，不为每一步生成整列
+// - 各线程处理连续的一段数据块，结果按块顺序拼接，输出行序与输入一致，与线程数无关
+// - 所有值按 double 处理，NaN 表示缺失值
+
+// 每个数据块的行数，与筛选内核的块大小一致
+constexpr int64_t kMorselRows = kFilterBlockWords * 64;
+
+// 表达式指令编码，与 Kotlin 侧 ExprOp.code 保持一致
+// 表达式按后缀（逆波兰）顺序编码，每条指令作用于整个数据块
+enum class ExprOp : int32_t {
+    COLUMN = 0,      // 压入第 arg 个输入列
+    CONST = 1,       // 压入常量 constants[arg]
+    ADD = 2,
+    SUB = 3,
+    MUL = 4,
+    DIV = 5,
+    NEG = 6,
+    FILL_NULL = 7,   // 弹出 b、a，压入 a 为 NaN 时的 b，否则 a
+    NORMALIZE = 8,   // (x - constants[arg]) / constants[arg + 1]；标准差不为正时非缺失值为 0，与 normalize 一致
+    // 逐元素函数，exp/log/sin/cos 使用当前 SIMD 级别的向量化内核
+    ABS = 9,
+    SQRT = 10,
+    EXP = 11,
+    LOG = 12,
+    SIN = 13,
+    COS = 14,
+    POW = 15,        // 弹出 b、a，压入 a 的 b 次方
+    // 比较：结果为 1/0，任一侧为 NaN 时结果为 NaN（缺失值比较仍是缺失值）
+    LT = 16,
+    LE = 17,
+    GT = 18,
+    GE = 19,
+    EQ = 20,
+    NE = 21,
+    CLIP = 22,       // 弹出 hi、lo、x，把 x 截断到 [lo, hi]；NaN 边界表示不限制
+    WHERE = 23,      // 弹出 b、a、cond，cond 非 0 取 a，为 0 取 b，为 NaN 时结果为 NaN
+    // 逻辑运算：非 0 为真，NaN 参与时结果为 NaN
+    AND = 24,
+    OR = 25,
+    NOT = 26,
+};
+
+struct ExprInstruction {
+    ExprOp op;
+    int32_t arg;
+};
+
+// 一个输出表达式，instructions 求值后恰好留下一个值
+struct ExprProgram {
+    const ExprInstruction* instructions;
+    int32_t instructionCount;
+};
+
+struct PipelineSpec {
+    const double* const* inputs;     // inputCount 个长度为 n 的输入列
+    int32_t inputCount;
+    const FilterProgram* filter;     // nullptr 表示不筛选；筛选列可以与输入列共用同一块内存
+    const ExprProgram* outputs;
+    int32_t outputCount;
+    const double* constants;         // 各输出表达式共用的常量池
+    int32_t constantCount;
+};
+
+struct PipelineResult {
+    // 选中的行号（升序），不筛选时为空
+    std::vector<int32_t> rows;
+    int64_t rowCount = 0;
+    // 每个输出表达式一列，长度 rowCount
+    std::vector<std::vector<double>> columns;
+};
+
+bool isValidExprOp(int32_t op);
+
+// 指令弹出的操作数个数（COLUMN/CONST 为 0），每条指令都只压入一个结果
+int32_t exprOpArity(ExprOp op);
+
+// 检查指令、输入列和常量下标以及栈深度；不合法时返回说明，合法时返回 nullptr；筛选程序另行检查
+const char* validatePipeline(const PipelineSpec& spec);
+
+// 对 n 行执行流水线，spec 必须先通过 validatePipeline
+PipelineResult runPipeline(const PipelineSpec& spec, int64_t n);
+
+// 对 n 行执行流水线但不输出结果，只统计每个输出表达式在选中行上的矩
+// 用于 normalize 等需要先知道整列统计量的算子
+std::vector<MomentAccumulator> pipelineMoments(const PipelineSpec& spec, int64_t n);
+
+} // namespace andas
+
+#endif //ANDAS_PIPELINE_ENGINE_H
@@ -0,0 +1,263 @@
+#include "rolling_engine.h"
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <set>
+#include <vector>
+#include "thread_pool.h"
+
+namespace andas {
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// 每段的输出行数下限；段内先用 O(window) 建立窗口状态，段长至少为窗口的4倍以摊薄这部分开销
+constexpr int64_t kRollingSegment = 65536;
+
+// Neumaier 补偿求和，支持移出
+struct SumState {
+    int64_t count = 0;
+    double sum = 0.0;
+    double compensation = 0.0;
+
+    void accumulate(double v) {
+        const double t = sum + v;
+        if (std::fabs(sum) >= std::fabs(v)) {
+            compensation += (sum - t) + v;
+        } else {
+            compensation += (v - t) + sum;
+        }
+        sum = t;
+    }
+
+    void add(double v) {
+        count++;
+        accumulate(v);
+    }
+
+    void remove(double v) {
+        count--;
+        if (count == 0) {
+            // 窗口清空时归零，避免误差累积
+            sum = 0.0;
+            compensation = 0.0;
+        } else {
+            accumulate(-v);
+        }
+    }
+
+    double value() const { return sum + compensation; }
+};
+
+// Welford 均值和离差平方和，支持移出
+// 数据先减去窗口变空后第一个加入的值，均值远离 0 时移出操作不会放大舍入误差
+// 与 pandas 一致记录末尾连续相等值的个数，窗口内全部相等时方差精确为 0
+struct MomentState {
+    int64_t count = 0;
+    double shift = 0.0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double last = 0.0;
+    int64_t sameRun = 0;
+
+    void add(double v) {
+        if (count == 0) shift = v;
+        sameRun = (sameRun > 0 && v == last) ? sameRun + 1 : 1;
+        last = v;
+        count++;
+        const double d = v - shift;
+        const double delta = d - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (d - mean);
+    }
+
+    void remove(double v) {
+        count--;
+        if (count == 0) {
+            mean = 0.0;
+            m2 = 0.0;
+            return;
+        }
+        const double d = v - shift;
+        const double delta = d - mean;
+        mean -= delta / static_cast<double>(count);
+        m2 -= delta * (d - mean);
+        if (m2 < 0.0) m2 = 0.0;
+    }
+};
+
+// 单调队列：队首为窗口内的最小（或最大）值所在行，按下标移出
+struct ExtremeState {
+    const double* x;
+    bool isMax;
+    std::vector<int64_t> queue;
+    size_t head = 0;
+    int64_t count = 0;
+
+    ExtremeState(const double* values, bool max) : x(values), isMax(max) {}
+
+    void addAt(int64_t j) {
+        if (std::isnan(x[j])) return;
+        count++;
+        const double v = x[j];
+        while (queue.size() > head && (isMax ? x[queue.back()] <= v : x[queue.back()] >= v)) {
+            queue.pop_back();
+        }
+        queue.push_back(j);
+    }
+
+    void removeAt(int64_t j) {
+        if (std::isnan(x[j])) return;
+        count--;
+        if (queue.size() > head && queue[head] == j) head++;
+        // 定期压缩已移出的部分
+        if (head > 4096 && head * 2 > queue.size()) {
+            queue.erase(queue.begin(), queue.begin() + static_cast<std::ptrdiff_t>(head));
+            head = 0;
+        }
+    }
+
+    double value() const { return x[queue[head]]; }
+};
+
+// 两个有序多重集合维护中位数：lower 存较小的一半（个数相等或多一个），upper 存较大的一半
+struct MedianState {
+    std::multiset<double> lower;
+    std::multiset<double> upper;
+
+    int64_t count() const { return static_cast<int64_t>(lower.size() + upper.size()); }
+
+    void rebalance() {
+        if (lower.size() > upper.size() + 1) {
+            auto last = std::prev(lower.end());
+            upper.insert(*last);
+            lower.erase(last);
+        } else if (upper.size() > lower.size()) {
+            auto first = upper.begin();
+            lower.insert(*first);
+            upper.erase(first);
+        }
+    }
+
+    void add(double v) {
+        if (lower.empty() || v <= *lower.rbegin()) {
+            lower.insert(v);
+        } else {
+            upper.insert(v);
+        }
+        rebalance();
+    }
+
+    void remove(double v) {
+        if (!lower.empty() && v <= *lower.rbegin()) {
+            lower.erase(lower.find(v));
+        } else {
+            upper.erase(upper.find(v));
+        }
+        rebalance();
+    }
+
+    double value() const {
+        if (lower.size() > upper.size()) return *lower.rbegin();
+        return (*lower.rbegin() + *upper.begin()) / 2.0;
+    }
+};
+
+// 在 [from, to) 行上滑动窗口：add(j)/remove(j) 维护状态，emit() 输出当前窗口的结果
+template <typename Add, typename Remove, typename Emit>
+void slide(int64_t n, const RollingWindow& w, int64_t from, int64_t to, double* out,
+           Add&& add, Remove&& remove, Emit&& emit) {
+    int64_t curStart = 0;
+    int64_t curEnd = 0;
+    windowBounds(w, n, from, &curStart, &curEnd);
+    for (int64_t j = curStart; j < curEnd; j++) add(j);
+    for (int64_t i = from; i < to; i++) {
+        int64_t start;
+        int64_t end;
+        windowBounds(w, n, i, &start, &end);
+        while (curEnd < end) add(curEnd++);
+        while (curStart < start) remove(curStart++);
+        out[i - from] = emit();
+    }
+}
+
+void rollingSegment(const double* x, int64_t n, RollingOp op, const RollingWindow& w,
+                    int64_t from, int64_t to, double* out) {
+    const int64_t minPeriods = w.minPeriods;
+    switch (op) {
+        case RollingOp::SUM:
+        case RollingOp::MEAN:
+        case RollingOp::COUNT: {
+            SumState state;
+            slide(n, w, from, to, out,
+                [&](int64_t j) { if (!std::isnan(x[j])) state.add(x[j]); },
+                [&](int64_t j) { if (!std::isnan(x[j])) state.remove(x[j]); },
+                [&]() {
+                    if (state.count < minPeriods) return kNaN;
+                    if (op == RollingOp::COUNT) return static_cast<double>(state.count);
+                    if (op == RollingOp::SUM) return state.value();
+                    return state.count > 0 ? state.value() / static_cast<double>(state.count) : kNaN;
+                });
+            break;
+        }
+        case RollingOp::VAR:
+        case RollingOp::STD: {
+            MomentState state;
+            slide(n, w, from, to, out,
+                [&](int64_t j) { if (!std::isnan(x[j])) state.add(x[j]); },
+                [&](int64_t j) { if (!std::isnan(x[j])) state.remove(x[j]); },
+                [&]() {
+                    if (state.count < minPeriods || state.count < 2) return kNaN;
+                    const double var = state.sameRun >= state.count ? 0.0 : state.m2 / static_cast<double>(state.count - 1);
+                    return op == RollingOp::VAR ? var : std::sqrt(var);
+                });
+            break;
+        }
+        case RollingOp::MIN:
+        case RollingOp::MAX: {
+            ExtremeState state(x, op == RollingOp::MAX);
+            slide(n, w, from, to, out,
+                [&](int64_t j) { state.addAt(j); },
+                [&](int64_t j) { state.removeAt(j); },
+                [&]() { return state.count < minPeriods || state.count == 0 ? kNaN : state.value(); });
+            break;
+        }
+        case RollingOp::MEDIAN: {
+            MedianState state;
+            slide(n, w, from, to, out,
+                [&](int64_t j) { if (!std::isnan(x[j])) state.add(x[j]); },
+                [&](int64_t j) { if (!std::isnan(x[j])) state.remove(x[j]); },
+                [&]() { return state.count() < minPeriods || state.count() == 0 ? kNaN : state.value(); });
+            break;
+        }
+    }
+}
+
+} // namespace
+
+bool isValidRollingOp(int32_t op) {
+    return op >= static_cast<int32_t>(RollingOp::SUM) && op <= static_cast<int32_t>(RollingOp::MEDIAN);
+}
+
+void rolling(const double* x, int64_t n, RollingOp op, const RollingWindow& window,
+             int64_t from, int64_t to, double* out) {
+    if (to <= from) return;
+    const int64_t count = to - from;
+    // 扩展窗口每段都要从第 0 行建立状态，只能串行
+    const int64_t segment = window.expanding ? count : std::max(kRollingSegment, window.window * 4);
+    const int64_t segments = (count + segment - 1) / segment;
+    std::function<void(int64_t)> task = [&](int64_t s) {
+        const int64_t lo = from + s * segment;
+        const int64_t hi = std::min(to, lo + segment);
+        rollingSegment(x, n, op, window, lo, hi, out + (lo - from));
+    };
+    if (segments == 1 || detail::shouldRunSerial(count)) {
+        for (int64_t s = 0; s < segments; s++) task(s);
+        return;
+    }
+    ThreadPool::instance().run(segments, task);
+}
+
+} // namespace andas
@@ -0,0 +1,56 @@
+#ifndef ANDAS_ROLLING_ENGINE_H
+#define ANDAS_ROLLING_ENGINE_H
+
+#include <algorithm>
+#include <cstdint>
+
+namespace andas {
+
+// 滑动窗口内核（不依赖JNI）
+// - 窗口左右边界都单调不减，每行只做增量的加入/移出，总代价 O(n)（中位数为 O(n log w)）
+// - 求和/均值使用 Neumaier 补偿求和，方差使用可移出的 Welford 更新，
+//   最小/最大值使用单调队列，中位数使用两个有序多重集合（大根堆/小根堆的可删除版本）
+// - NaN 视为缺失值，不进入窗口状态；有效值少于 minPeriods 的行结果为 NaN
+// - 输出按固定大小分段，每段独立建立窗口状态，各段可并行；分段与线程数无关，结果可复现
+
+// 聚合类型编码，与 Kotlin 侧 RollingOp.code 保持一致
+enum class RollingOp : int32_t {
+    SUM = 0,
+    MEAN = 1,
+    VAR = 2,      // 样本方差 (ddof=1)，有效值不足2个时为 NaN
+    STD = 3,
+    MIN = 4,
+    MAX = 5,
+    COUNT = 6,    // 有效值个数
+    MEDIAN = 7,
+};
+
+bool isValidRollingOp(int32_t op);
+
+struct RollingWindow {
+    int64_t window;        // 窗口行数，expanding 时忽略
+    int64_t minPeriods;    // 0 <= minPeriods
+    bool center;           // 窗口居中
+    bool expanding;        // 扩展窗口：从第 0 行到当前行
+};
+
+// 第 i 行的窗口 [start, end)，与 pandas 一致：居中时窗口向后偏移 (window - 1) / 2 行；超出 [0, n) 的部分截断
+inline void windowBounds(const RollingWindow& w, int64_t n, int64_t i, int64_t* start, int64_t* end) {
+    if (w.expanding) {
+        *start = 0;
+        *end = std::min(n, i + 1);
+        return;
+    }
+    const int64_t offset = w.center ? (w.window - 1) / 2 : 0;
+    const int64_t e = i + 1 + offset;
+    *start = std::max<int64_t>(0, e - w.window);
+    *end = std::min(n, e);
+}
+
+// 计算第 [from, to) 行的结果写入 out[0, to - from)；窗口只使用 x[0, n) 内的值
+void rolling(const double* x, int64_t n, RollingOp op, const RollingWindow& window,
+             int64_t from, int64_t to, double* out);
+
+} // namespace andas
+
+#endif //ANDAS_ROLLING_ENGINE_H
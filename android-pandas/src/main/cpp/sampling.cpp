@@ -0,0 +1,207 @@
+#include "sampling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include "groupby_engine.h"
+#include "hash_utils.h"
+#include "memory_pool.h"
+#include "sort_engine.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+namespace {
+
+constexpr uint64_t kGoldenGamma = 0x9e3779b97f4a7c15ULL;
+constexpr double kUnit53 = 1.0 / 9007199254740992.0;   // 2^-53
+
+inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// 64 位随机数映射到 (0, 1)：取高 53 位并偏移半个单位
+inline double openUnit(uint64_t x) {
+    return (static_cast<double>(x >> 11) + 0.5) * kUnit53;
+}
+
+} // namespace
+
+// ==================== Xoshiro256 ====================
+
+Xoshiro256::Xoshiro256(uint64_t seed) {
+    // splitmix64 展开种子，保证状态不全为 0
+    for (uint64_t& s : s_) {
+        seed += kGoldenGamma;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        s = z ^ (z >> 31);
+    }
+}
+
+uint64_t Xoshiro256::next() {
+    const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+    const uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = rotl(s_[3], 45);
+    return result;
+}
+
+double Xoshiro256::uniform() {
+    return openUnit(next());
+}
+
+uint64_t Xoshiro256::below(uint64_t bound) {
+    // 丢弃落在 [0, 2^64 mod bound) 的值，余下部分恰好是 bound 的整数倍
+    const uint64_t threshold = (0 - bound) % bound;
+    for (;;) {
+        const uint64_t r = next();
+        if (r >= threshold) return r % bound;
+    }
+}
+
+uint64_t deriveSeed(uint64_t seed, uint64_t stream) {
+    return mix64(seed ^ mix64(stream + 1));
+}
+
+// ==================== 简单随机采样 ====================
+
+std::vector<int64_t> sampleIndices(int64_t n, int64_t k, uint64_t seed) {
+    k = std::max<int64_t>(0, std::min(k, n));
+    std::vector<int64_t> out(static_cast<size_t>(k));
+    Xoshiro256 rng(seed);
+
+    // 抽取量占比较大时直接在完整的排列上交换；两种方式消耗的随机数相同，结果一致
+    if (k * 4 >= n) {
+        ScratchBuffer<int64_t> permutation(n);
+        std::iota(permutation.begin(), permutation.end(), 0);
+        for (int64_t i = 0; i < k; i++) {
+            const int64_t j = i + static_cast<int64_t>(rng.below(static_cast<uint64_t>(n - i)));
+            std::swap(permutation[i], permutation[j]);
+            out[i] = permutation[i];
+        }
+        return out;
+    }
+
+    // 未记录的位置 p 上的值就是 p
+    std::unordered_map<int64_t, int64_t> moved;
+    moved.reserve(static_cast<size_t>(k) * 2);
+    for (int64_t i = 0; i < k; i++) {
+        const int64_t j = i + static_cast<int64_t>(rng.below(static_cast<uint64_t>(n - i)));
+        auto atJ = moved.find(j);
+        const int64_t valueJ = atJ == moved.end() ? j : atJ->second;
+        auto atI = moved.find(i);
+        const int64_t valueI = atI == moved.end() ? i : atI->second;
+        out[i] = valueJ;
+        moved[j] = valueI;
+    }
+    return out;
+}
+
+// ==================== 加权采样 ====================
+
+std::vector<int32_t> weightedSampleIndices(const double* weights, int64_t n, int64_t k, uint64_t seed) {
+    if (k <= 0 || n <= 0) return {};
+    const uint64_t base = mix64(seed);
+    ScratchBuffer<double> keys(n);
+    parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) {
+            const double w = weights[i];
+            if (!(w > 0.0)) {
+                keys[i] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            const double u = openUnit(mix64(base + static_cast<uint64_t>(i + 1) * kGoldenGamma));
+            keys[i] = std::log(u) / w;
+        }
+    });
+    const SortKey key{SortKeyType::FLOAT64, keys.data(), true, false};
+    return topK(key, n, k);
+}
+
+// ==================== 分层采样 ====================
+
+namespace {
+
+bool sameKey(const int64_t* const* keys, int32_t keyColumns, int64_t a, int64_t b) {
+    for (int32_t c = 0; c < keyColumns; c++) {
+        if (keys[c][a] != keys[c][b]) return false;
+    }
+    return true;
+}
+
+// 每行所属的层号（按首次出现编号），缺失键的行为 -1；返回层数
+int64_t assignStrata(const int64_t* const* keys, int32_t keyColumns, int64_t n, std::vector<int64_t>* strata) {
+    uint64_t capacity = 16;
+    while (capacity < static_cast<uint64_t>(n) * 2) capacity <<= 1;
+    const uint64_t mask = capacity - 1;
+    // 槽中存该层第一行的行号
+    std::vector<int64_t> slots(capacity, -1);
+    std::vector<int64_t> slotStratum(capacity, -1);
+    strata->assign(static_cast<size_t>(n), -1);
+    int64_t count = 0;
+    for (int64_t row = 0; row < n; row++) {
+        bool missing = false;
+        for (int32_t c = 0; c < keyColumns; c++) missing |= keys[c][row] == kNullGroupKey;
+        if (missing) continue;
+        uint64_t i = hashRow(keys, keyColumns, row) & mask;
+        while (slots[i] >= 0 && !sameKey(keys, keyColumns, slots[i], row)) i = (i + 1) & mask;
+        if (slots[i] < 0) {
+            slots[i] = row;
+            slotStratum[i] = count++;
+        }
+        (*strata)[row] = slotStratum[i];
+    }
+    return count;
+}
+
+} // namespace
+
+std::vector<int32_t> stratifiedSampleIndices(const int64_t* const* keys, int32_t keyColumns, int64_t n,
+                                             int64_t count, double fraction, uint64_t seed) {
+    std::vector<int64_t> strata;
+    const int64_t stratumCount = assignStrata(keys, keyColumns, n, &strata);
+
+    // 按层稳定分桶：rows[offsets[s], offsets[s + 1]) 为第 s 层的行
+    std::vector<int64_t> offsets(static_cast<size_t>(stratumCount) + 1, 0);
+    for (int64_t s : strata) {
+        if (s >= 0) offsets[s + 1]++;
+    }
+    std::vector<int64_t> takes(static_cast<size_t>(stratumCount));
+    std::vector<int64_t> outOffsets(static_cast<size_t>(stratumCount) + 1, 0);
+    for (int64_t s = 0; s < stratumCount; s++) {
+        const int64_t size = offsets[s + 1];
+        const int64_t take = count >= 0
+            ? std::min(count, size)
+            : static_cast<int64_t>(std::floor(fraction * static_cast<double>(size) + 0.5));
+        takes[s] = std::max<int64_t>(0, std::min(take, size));
+        outOffsets[s + 1] = outOffsets[s] + takes[s];
+        offsets[s + 1] += offsets[s];
+    }
+    std::vector<int32_t> rows(static_cast<size_t>(offsets[stratumCount]));
+    std::vector<int64_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (int64_t row = 0; row < n; row++) {
+        if (strata[row] >= 0) rows[cursor[strata[row]]++] = static_cast<int32_t>(row);
+    }
+
+    std::vector<int32_t> out(static_cast<size_t>(outOffsets[stratumCount]));
+    parallel_for(0, stratumCount, [&](int64_t lo, int64_t hi) {
+        for (int64_t s = lo; s < hi; s++) {
+            const int64_t size = offsets[s + 1] - offsets[s];
+            const std::vector<int64_t> picked = sampleIndices(size, takes[s], deriveSeed(seed, static_cast<uint64_t>(s)));
+            for (size_t i = 0; i < picked.size(); i++) {
+                out[outOffsets[s] + static_cast<int64_t>(i)] = rows[offsets[s] + picked[i]];
+            }
+        }
+    });
+    return out;
+}
+
+} // namespace andas
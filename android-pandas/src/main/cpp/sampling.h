@@ -0,0 +1,49 @@
+#ifndef ANDAS_SAMPLING_H
+#define ANDAS_SAMPLING_H
+
+#include <cstdint>
+#include <vector>
+
+namespace andas {
+
+// 随机采样内核（不依赖JNI）
+// - 随机数为 xoshiro256**，64 位种子经 splitmix64 展开为状态；每次调用各自持有生成器，可重入
+// - 有界整数用拒绝采样消除取模偏差
+// - 简单随机采样为部分 Fisher–Yates：只做前 k 次交换，被换出的位置记在哈希表中，O(k) 时间和内存
+// - 加权采样（不放回）为 Efraimidis–Spirakis：每行键为 log(u)/w，取最大的 k 行；
+//   u 由 (种子, 行号) 直接计算，各块可并行，结果与线程数无关
+// - 分层采样按层的首次出现顺序编号，每层使用由 (种子, 层号) 派生的独立随机流
+// Kotlin 侧 core/Sampling.kt 有相同的实现，同一种子在原生库不可用时结果一致
+
+class Xoshiro256 {
+public:
+    explicit Xoshiro256(uint64_t seed);
+
+    uint64_t next();
+    // (0, 1) 内的均匀分布，不会取到 0，可直接取对数
+    double uniform();
+    // [0, bound) 内的均匀整数，bound > 0
+    uint64_t below(uint64_t bound);
+
+private:
+    uint64_t s_[4];
+};
+
+// 由同一种子派生第 stream 条随机流的种子，各流互不相关
+uint64_t deriveSeed(uint64_t seed, uint64_t stream);
+
+// 从 [0, n) 中不放回地取 k 个（k > n 时取 n 个），按抽取顺序返回
+std::vector<int64_t> sampleIndices(int64_t n, int64_t k, uint64_t seed);
+
+// 加权不放回采样，按抽取顺序返回；权重 <= 0 或 NaN 的行不会被选中，可选的行不足 k 个时全部返回
+std::vector<int32_t> weightedSampleIndices(const double* weights, int64_t n, int64_t k, uint64_t seed);
+
+// 分层采样：keys 为 keyColumns 个长度为 n 的 int64 键列，含 kNullGroupKey 的行不参与
+// count >= 0 时每层取 min(count, 层大小) 行，否则每层取 floor(fraction * 层大小 + 0.5) 行
+// 输出按层的首次出现顺序排列，层内按抽取顺序
+std::vector<int32_t> stratifiedSampleIndices(const int64_t* const* keys, int32_t keyColumns, int64_t n,
+                                             int64_t count, double fraction, uint64_t seed);
+
+} // namespace andas
+
+#endif //ANDAS_SAMPLING_H
@@ -0,0 +1,201 @@
+#include "simd_kernels.h"
+
+#include <atomic>
+#include <cmath>
+
+namespace andas {
+namespace simd {
+
+namespace {
+
+// ==================== 标量参考实现 ====================
+
+double scalarNanSum(const double* x, int64_t n, int64_t* count) {
+    double sum = 0.0;
+    int64_t valid = 0;
+    for (int64_t i = 0; i < n; i++) {
+        if (!std::isnan(x[i])) {
+            sum += x[i];
+            valid++;
+        }
+    }
+    if (count != nullptr) *count = valid;
+    return sum;
+}
+
+void scalarNanMoments(const double* x, int64_t n, double* sum, double* sumSq, int64_t* count) {
+    double s = 0.0;
+    double sq = 0.0;
+    int64_t valid = 0;
+    for (int64_t i = 0; i < n; i++) {
+        if (!std::isnan(x[i])) {
+            s += x[i];
+            sq += x[i] * x[i];
+            valid++;
+        }
+    }
+    *sum = s;
+    *sumSq = sq;
+    *count = valid;
+}
+
+int64_t scalarNanMinMax(const double* x, int64_t n, double* min, double* max) {
+    double lo = INFINITY;
+    double hi = -INFINITY;
+    int64_t valid = 0;
+    for (int64_t i = 0; i < n; i++) {
+        if (!std::isnan(x[i])) {
+            if (x[i] < lo) lo = x[i];
+            if (x[i] > hi) hi = x[i];
+            valid++;
+        }
+    }
+    *min = lo;
+    *max = hi;
+    return valid;
+}
+
+double scalarDot(const double* a, const double* b, int64_t n) {
+    double dot = 0.0;
+    for (int64_t i = 0; i < n; i++) {
+        dot += a[i] * b[i];
+    }
+    return dot;
+}
+
+void scalarAdd(const double* a, const double* b, double* out, int64_t n) {
+    for (int64_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+}
+
+void scalarMultiply(const double* a, const double* b, double* out, int64_t n) {
+    for (int64_t i = 0; i < n; i++) out[i] = a[i] * b[i];
+}
+
+void scalarScale(const double* x, double multiplier, double* out, int64_t n) {
+    for (int64_t i = 0; i < n; i++) out[i] = x[i] * multiplier;
+}
+
+void scalarCompareMask(const double* x, int64_t n, double threshold, CompareOp op, uint64_t* bits) {
+    const int64_t words = (n + 63) / 64;
+    for (int64_t w = 0; w < words; w++) {
+        uint64_t word = 0;
+        const int64_t base = w * 64;
+        const int64_t count = (n - base) < 64 ? (n - base) : 64;
+        for (int64_t j = 0; j < count; j++) {
+            if (compare(x[base + j], threshold, op)) word |= uint64_t(1) << j;
+        }
+        bits[w] = word;
+    }
+}
+
+void scalarCompareBytes(const double* x, int64_t n, double threshold, CompareOp op, uint8_t* out) {
+    for (int64_t i = 0; i < n; i++) {
+        out[i] = compare(x[i], threshold, op) ? 1 : 0;
+    }
+}
+
+int64_t scalarFindStructural(const char* p, int64_t n, char delimiter, char quote) {
+    for (int64_t i = 0; i < n; i++) {
+        const char c = p[i];
+        if (c == delimiter || c == quote || c == '\n') return i;
+    }
+    return n;
+}
+
+void scalarExp(const double* x, double* out, int64_t n) {
+    for (int64_t i = 0; i < n; i++) out[i] = std::exp(x[i]);
+}
+
+void scalarLog(const double* x, double* out, int64_t n) {
+    for (int64_t i = 0; i < n; i++) out[i] = std::log(x[i]);
+}
+
+void scalarSin(const double* x, double* out, int64_t n) {
+    for (int64_t i = 0; i < n; i++) out[i] = std::sin(x[i]);
+}
+
+void scalarCos(const double* x, double* out, int64_t n) {
+    for (int64_t i = 0; i < n; i++) out[i] = std::cos(x[i]);
+}
+
+const Kernels kScalarKernels = {
+    Level::Scalar,
+    "scalar",
+    scalarNanSum,
+    scalarNanMoments,
+    scalarNanMinMax,
+    scalarDot,
+    scalarAdd,
+    scalarMultiply,
+    scalarScale,
+    scalarCompareMask,
+    scalarCompareBytes,
+    scalarFindStructural,
+    scalarExp,
+    scalarLog,
+    scalarSin,
+    scalarCos,
+};
+
+const Kernels* bestAvailable() {
+    const Kernels* kernels = forLevel(detectLevel());
+    return kernels != nullptr ? kernels : &kScalarKernels;
+}
+
+std::atomic<const Kernels*>& activeKernels() {
+    static std::atomic<const Kernels*> kernels{bestAvailable()};
+    return kernels;
+}
+
+} // namespace
+
+const Kernels& active() {
+    return *activeKernels().load(std::memory_order_acquire);
+}
+
+const Kernels& scalar() {
+    return kScalarKernels;
+}
+
+const Kernels* forLevel(Level level) {
+    switch (level) {
+        case Level::Scalar: return &kScalarKernels;
+        case Level::SSE2: return sse2Kernels();
+        case Level::AVX2: return avx2Kernels();
+        case Level::NEON: return neonKernels();
+    }
+    return nullptr;
+}
+
+bool setLevel(Level level) {
+    const Kernels* kernels = forLevel(level);
+    if (kernels == nullptr) return false;
+    activeKernels().store(kernels, std::memory_order_release);
+    return true;
+}
+
+Level detectLevel() {
+#if defined(__aarch64__)
+    // arm64 上 NEON 是基础指令集
+    return Level::NEON;
+#elif defined(__x86_64__) || defined(__i386__)
+    if (avx2Kernels() != nullptr) return Level::AVX2;
+    if (sse2Kernels() != nullptr) return Level::SSE2;
+    return Level::Scalar;
+#else
+    return Level::Scalar;
+#endif
+}
+
+const char* levelName(Level level) {
+    switch (level) {
+        case Level::Scalar: return "scalar";
+        case Level::SSE2: return "sse2";
+        case Level::AVX2: return "avx2";
+        case Level::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+} // namespace simd
+} // namespace andas
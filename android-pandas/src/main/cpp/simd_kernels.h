@@ -0,0 +1,100 @@
+#ifndef ANDAS_SIMD_KERNELS_H
+#define ANDAS_SIMD_KERNELS_H
+
+#include <cstdint>
+
+namespace andas {
+namespace simd {
+
+// SIMD 内核层
+// - arm64 使用 NEON，x86_64 使用 SSE2，CPU 支持时使用 AVX2
+// - 加载时按 CPUID/hwcap 选择一次，其余平台回退到标量实现
+// - 内核本身是串行的，由 math_kernels.cpp 按块在线程池上调用
+// - 所有 nan* 内核把 NaN 视为缺失值并跳过
+
+enum class Level {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+enum class CompareOp {
+    GT,
+    GE,
+    LT,
+    LE,
+    EQ,
+    NE   // NaN 与任何值都不相等，NE 对 NaN 为 true
+};
+
+// 标量比较，所有实现的尾部元素都使用它，保证 NaN 语义一致
+inline bool compare(double v, double threshold, CompareOp op) {
+    switch (op) {
+        case CompareOp::GT: return v > threshold;
+        case CompareOp::GE: return v >= threshold;
+        case CompareOp::LT: return v < threshold;
+        case CompareOp::LE: return v <= threshold;
+        case CompareOp::EQ: return v == threshold;
+        case CompareOp::NE: return v != threshold;
+    }
+    return false;
+}
+
+struct Kernels {
+    Level level;
+    const char* name;
+
+    // 跳过 NaN 的求和，count 返回有效值个数（可为 nullptr）
+    double (*nanSum)(const double* x, int64_t n, int64_t* count);
+    // 跳过 NaN 的和与平方和
+    void (*nanMoments)(const double* x, int64_t n, double* sum, double* sumSq, int64_t* count);
+    // 跳过 NaN 的最小/最大值，返回有效值个数，为 0 时 min/max 未定义
+    int64_t (*nanMinMax)(const double* x, int64_t n, double* min, double* max);
+    double (*dot)(const double* a, const double* b, int64_t n);
+
+    void (*add)(const double* a, const double* b, double* out, int64_t n);
+    void (*multiply)(const double* a, const double* b, double* out, int64_t n);
+    void (*scale)(const double* x, double multiplier, double* out, int64_t n);
+
+    // 比较结果写成位图：第 i 个元素对应 bits[i / 64] 的第 i % 64 位，末尾不足一个字的高位清零
+    void (*compareMask)(const double* x, int64_t n, double threshold, CompareOp op, uint64_t* bits);
+    // 比较结果逐元素写成 0/1 字节
+    void (*compareBytes)(const double* x, int64_t n, double threshold, CompareOp op, uint8_t* out);
+
+    // CSV 结构字符扫描：返回第一个等于 delimiter、quote 或 '\n' 的字节下标，没有则返回 n
+    int64_t (*findStructural)(const char* p, int64_t n, char delimiter, char quote);
+
+    // 逐元素超越函数，out 可以与 x 相同；标量表直接调用 libm，其余级别使用 vector_math.h 的多项式逼近
+    void (*exp)(const double* x, double* out, int64_t n);
+    void (*log)(const double* x, double* out, int64_t n);
+    void (*sin)(const double* x, double* out, int64_t n);
+    void (*cos)(const double* x, double* out, int64_t n);
+};
+
+// 当前使用的内核
+const Kernels& active();
+
+// 标量参考实现
+const Kernels& scalar();
+
+// 指定级别的内核，当前 CPU 或编译目标不支持时返回 nullptr
+const Kernels* forLevel(Level level);
+
+// 强制使用指定级别（用于测试和基准），不支持时返回 false 且不改变当前内核
+bool setLevel(Level level);
+
+// 按 CPU 特性检测到的最佳级别
+Level detectLevel();
+
+const char* levelName(Level level);
+
+// 各平台实现，由 simd_kernels.cpp 汇总；不支持的平台返回 nullptr
+const Kernels* sse2Kernels();
+const Kernels* avx2Kernels();
+const Kernels* neonKernels();
+
+} // namespace simd
+} // namespace andas
+
+#endif //ANDAS_SIMD_KERNELS_H
@@ -0,0 +1,313 @@
+#include "simd_kernels.h"
+
+#if defined(__aarch64__)
+
+#include <cmath>
+#include <arm_neon.h>
+#include "vector_math.h"
+
+// arm64 NEON 内核：NEON 是 ARMv8-A 的基础指令集，无需运行时检测
+// 每次迭代 4 个累加器 x 2 路，共 8 个元素
+
+namespace andas {
+namespace simd {
+
+namespace {
+
+template <CompareOp OP>
+inline uint64x2_t cmpNeon(float64x2_t a, float64x2_t b) {
+    switch (OP) {
+        case CompareOp::GT: return vcgtq_f64(a, b);
+        case CompareOp::GE: return vcgeq_f64(a, b);
+        case CompareOp::LT: return vcltq_f64(a, b);
+        case CompareOp::LE: return vcleq_f64(a, b);
+        case CompareOp::EQ: return vceqq_f64(a, b);
+        case CompareOp::NE: return vreinterpretq_u64_u32(vmvnq_u32(vreinterpretq_u32_u64(vceqq_f64(a, b))));
+    }
+    return vdupq_n_u64(0);
+}
+
+// 两个通道的比较结果压缩为 2 位
+inline uint64_t maskBits(uint64x2_t m) {
+    return (vgetq_lane_u64(m, 0) & 1) | ((vgetq_lane_u64(m, 1) & 1) << 1);
+}
+
+// 非 NaN 通道为全 1
+inline uint64x2_t ordered(float64x2_t v) {
+    return vceqq_f64(v, v);
+}
+
+// 掩码为 0 的通道置为 +0.0
+inline float64x2_t keep(float64x2_t v, uint64x2_t m) {
+    return vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(v), m));
+}
+
+void neonNanMoments(const double* x, int64_t n, double* sum, double* sumSq, int64_t* count) {
+    float64x2_t s0 = vdupq_n_f64(0.0), s1 = s0, s2 = s0, s3 = s0;
+    float64x2_t q0 = s0, q1 = s0, q2 = s0, q3 = s0;
+    int64x2_t c0 = vdupq_n_s64(0), c1 = c0;
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float64x2_t v0 = vld1q_f64(x + i);
+        float64x2_t v1 = vld1q_f64(x + i + 2);
+        float64x2_t v2 = vld1q_f64(x + i + 4);
+        float64x2_t v3 = vld1q_f64(x + i + 6);
+        uint64x2_t m0 = ordered(v0);
+        uint64x2_t m1 = ordered(v1);
+        uint64x2_t m2 = ordered(v2);
+        uint64x2_t m3 = ordered(v3);
+        v0 = keep(v0, m0);
+        v1 = keep(v1, m1);
+        v2 = keep(v2, m2);
+        v3 = keep(v3, m3);
+        s0 = vaddq_f64(s0, v0);
+        s1 = vaddq_f64(s1, v1);
+        s2 = vaddq_f64(s2, v2);
+        s3 = vaddq_f64(s3, v3);
+        q0 = vaddq_f64(q0, vmulq_f64(v0, v0));
+        q1 = vaddq_f64(q1, vmulq_f64(v1, v1));
+        q2 = vaddq_f64(q2, vmulq_f64(v2, v2));
+        q3 = vaddq_f64(q3, vmulq_f64(v3, v3));
+        // 全 1 掩码按有符号整数解释为 -1，相减即计数
+        c0 = vsubq_s64(c0, vreinterpretq_s64_u64(m0));
+        c1 = vsubq_s64(c1, vreinterpretq_s64_u64(m1));
+        c0 = vsubq_s64(c0, vreinterpretq_s64_u64(m2));
+        c1 = vsubq_s64(c1, vreinterpretq_s64_u64(m3));
+    }
+    double s = vaddvq_f64(vaddq_f64(vaddq_f64(s0, s1), vaddq_f64(s2, s3)));
+    double sq = vaddvq_f64(vaddq_f64(vaddq_f64(q0, q1), vaddq_f64(q2, q3)));
+    int64_t c = vaddvq_s64(vaddq_s64(c0, c1));
+    for (; i < n; i++) {
+        if (!std::isnan(x[i])) {
+            s += x[i];
+            sq += x[i] * x[i];
+            c++;
+        }
+    }
+    *sum = s;
+    *sumSq = sq;
+    *count = c;
+}
+
+double neonNanSum(const double* x, int64_t n, int64_t* count) {
+    float64x2_t s0 = vdupq_n_f64(0.0), s1 = s0, s2 = s0, s3 = s0;
+    int64x2_t c0 = vdupq_n_s64(0), c1 = c0;
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float64x2_t v0 = vld1q_f64(x + i);
+        float64x2_t v1 = vld1q_f64(x + i + 2);
+        float64x2_t v2 = vld1q_f64(x + i + 4);
+        float64x2_t v3 = vld1q_f64(x + i + 6);
+        uint64x2_t m0 = ordered(v0);
+        uint64x2_t m1 = ordered(v1);
+        uint64x2_t m2 = ordered(v2);
+        uint64x2_t m3 = ordered(v3);
+        s0 = vaddq_f64(s0, keep(v0, m0));
+        s1 = vaddq_f64(s1, keep(v1, m1));
+        s2 = vaddq_f64(s2, keep(v2, m2));
+        s3 = vaddq_f64(s3, keep(v3, m3));
+        c0 = vsubq_s64(c0, vreinterpretq_s64_u64(m0));
+        c1 = vsubq_s64(c1, vreinterpretq_s64_u64(m1));
+        c0 = vsubq_s64(c0, vreinterpretq_s64_u64(m2));
+        c1 = vsubq_s64(c1, vreinterpretq_s64_u64(m3));
+    }
+    double s = vaddvq_f64(vaddq_f64(vaddq_f64(s0, s1), vaddq_f64(s2, s3)));
+    int64_t c = vaddvq_s64(vaddq_s64(c0, c1));
+    for (; i < n; i++) {
+        if (!std::isnan(x[i])) {
+            s += x[i];
+            c++;
+        }
+    }
+    if (count != nullptr) *count = c;
+    return s;
+}
+
+int64_t neonNanMinMax(const double* x, int64_t n, double* min, double* max) {
+    // vminnmq/vmaxnmq 在一个操作数为 NaN 时返回另一个，天然跳过 NaN
+    const float64x2_t posInf = vdupq_n_f64(INFINITY);
+    const float64x2_t negInf = vdupq_n_f64(-INFINITY);
+    float64x2_t lo0 = posInf, lo1 = posInf, hi0 = negInf, hi1 = negInf;
+    int64x2_t c0 = vdupq_n_s64(0), c1 = c0;
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float64x2_t v0 = vld1q_f64(x + i);
+        float64x2_t v1 = vld1q_f64(x + i + 2);
+        lo0 = vminnmq_f64(lo0, v0);
+        lo1 = vminnmq_f64(lo1, v1);
+        hi0 = vmaxnmq_f64(hi0, v0);
+        hi1 = vmaxnmq_f64(hi1, v1);
+        c0 = vsubq_s64(c0, vreinterpretq_s64_u64(ordered(v0)));
+        c1 = vsubq_s64(c1, vreinterpretq_s64_u64(ordered(v1)));
+    }
+    double l = vminnmvq_f64(vminnmq_f64(lo0, lo1));
+    double h = vmaxnmvq_f64(vmaxnmq_f64(hi0, hi1));
+    int64_t c = vaddvq_s64(vaddq_s64(c0, c1));
+    for (; i < n; i++) {
+        if (!std::isnan(x[i])) {
+            if (x[i] < l) l = x[i];
+            if (x[i] > h) h = x[i];
+            c++;
+        }
+    }
+    *min = l;
+    *max = h;
+    return c;
+}
+
+double neonDot(const double* a, const double* b, int64_t n) {
+    float64x2_t s0 = vdupq_n_f64(0.0), s1 = s0, s2 = s0, s3 = s0;
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = vaddq_f64(s0, vmulq_f64(vld1q_f64(a + i), vld1q_f64(b + i)));
+        s1 = vaddq_f64(s1, vmulq_f64(vld1q_f64(a + i + 2), vld1q_f64(b + i + 2)));
+        s2 = vaddq_f64(s2, vmulq_f64(vld1q_f64(a + i + 4), vld1q_f64(b + i + 4)));
+        s3 = vaddq_f64(s3, vmulq_f64(vld1q_f64(a + i + 6), vld1q_f64(b + i + 6)));
+    }
+    double s = vaddvq_f64(vaddq_f64(vaddq_f64(s0, s1), vaddq_f64(s2, s3)));
+    for (; i < n; i++) s += a[i] * b[i];
+    return s;
+}
+
+void neonAdd(const double* a, const double* b, double* out, int64_t n) {
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(out + i, vaddq_f64(vld1q_f64(a + i), vld1q_f64(b + i)));
+    }
+    for (; i < n; i++) out[i] = a[i] + b[i];
+}
+
+void neonMultiply(const double* a, const double* b, double* out, int64_t n) {
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(out + i, vmulq_f64(vld1q_f64(a + i), vld1q_f64(b + i)));
+    }
+    for (; i < n; i++) out[i] = a[i] * b[i];
+}
+
+void neonScale(const double* x, double multiplier, double* out, int64_t n) {
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(out + i, vmulq_n_f64(vld1q_f64(x + i), multiplier));
+    }
+    for (; i < n; i++) out[i] = x[i] * multiplier;
+}
+
+template <CompareOp OP>
+void neonCompareMaskT(const double* x, int64_t n, double threshold, uint64_t* bits) {
+    const float64x2_t t = vdupq_n_f64(threshold);
+    int64_t i = 0;
+    int64_t w = 0;
+    for (; i + 64 <= n; i += 64, w++) {
+        uint64_t word = 0;
+        for (int j = 0; j < 64; j += 2) {
+            word |= maskBits(cmpNeon<OP>(vld1q_f64(x + i + j), t)) << j;
+        }
+        bits[w] = word;
+    }
+    if (i < n) {
+        uint64_t word = 0;
+        for (int64_t j = 0; i + j < n; j++) {
+            if (compare(x[i + j], threshold, OP)) word |= uint64_t(1) << j;
+        }
+        bits[w] = word;
+    }
+}
+
+template <CompareOp OP>
+void neonCompareBytesT(const double* x, int64_t n, double threshold, uint8_t* out) {
+    const float64x2_t t = vdupq_n_f64(threshold);
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        uint64x2_t m = cmpNeon<OP>(vld1q_f64(x + i), t);
+        out[i] = static_cast<uint8_t>(vgetq_lane_u64(m, 0) & 1);
+        out[i + 1] = static_cast<uint8_t>(vgetq_lane_u64(m, 1) & 1);
+    }
+    for (; i < n; i++) out[i] = compare(x[i], threshold, OP) ? 1 : 0;
+}
+
+#define ANDAS_DISPATCH_COMPARE(FN, OP, ...)                      \
+    switch (OP) {                                                \
+        case CompareOp::GT: FN<CompareOp::GT>(__VA_ARGS__); break; \
+        case CompareOp::GE: FN<CompareOp::GE>(__VA_ARGS__); break; \
+        case CompareOp::LT: FN<CompareOp::LT>(__VA_ARGS__); break; \
+        case CompareOp::LE: FN<CompareOp::LE>(__VA_ARGS__); break; \
+        case CompareOp::EQ: FN<CompareOp::EQ>(__VA_ARGS__); break; \
+        case CompareOp::NE: FN<CompareOp::NE>(__VA_ARGS__); break; \
+    }
+
+void neonCompareMask(const double* x, int64_t n, double threshold, CompareOp op, uint64_t* bits) {
+    ANDAS_DISPATCH_COMPARE(neonCompareMaskT, op, x, n, threshold, bits)
+}
+
+void neonCompareBytes(const double* x, int64_t n, double threshold, CompareOp op, uint8_t* out) {
+    ANDAS_DISPATCH_COMPARE(neonCompareBytesT, op, x, n, threshold, out)
+}
+
+#undef ANDAS_DISPATCH_COMPARE
+
+int64_t neonFindStructural(const char* p, int64_t n, char delimiter, char quote) {
+    const uint8x16_t d = vdupq_n_u8(static_cast<uint8_t>(delimiter));
+    const uint8x16_t q = vdupq_n_u8(static_cast<uint8_t>(quote));
+    const uint8x16_t nl = vdupq_n_u8('\n');
+    int64_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p + i));
+        uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(v, d), vceqq_u8(v, q)), vceqq_u8(v, nl));
+        if (vmaxvq_u8(hit) == 0) continue;
+        // 每个字节压缩为 4 位，第一个命中字节的下标 = 尾零数 / 4
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+        return i + (__builtin_ctzll(mask) >> 2);
+    }
+    for (; i < n; i++) {
+        if (p[i] == delimiter || p[i] == quote || p[i] == '\n') return i;
+    }
+    return n;
+}
+
+void neonExp(const double* x, double* out, int64_t n) { vmath::expLoop(x, out, n); }
+void neonLog(const double* x, double* out, int64_t n) { vmath::logLoop(x, out, n); }
+void neonSin(const double* x, double* out, int64_t n) { vmath::sinLoop(x, out, n); }
+void neonCos(const double* x, double* out, int64_t n) { vmath::cosLoop(x, out, n); }
+
+const Kernels kNeonKernels = {
+    Level::NEON,
+    "neon",
+    neonNanSum,
+    neonNanMoments,
+    neonNanMinMax,
+    neonDot,
+    neonAdd,
+    neonMultiply,
+    neonScale,
+    neonCompareMask,
+    neonCompareBytes,
+    neonFindStructural,
+    neonExp,
+    neonLog,
+    neonSin,
+    neonCos,
+};
+
+} // namespace
+
+const Kernels* neonKernels() {
+    return &kNeonKernels;
+}
+
+} // namespace simd
+} // namespace andas
+
+#else
+
+namespace andas {
+namespace simd {
+
+const Kernels* neonKernels() {
+    return nullptr;
+}
+
+} // namespace simd
+} // namespace andas
+
+#endif
@@ -0,0 +1,621 @@
+#include "simd_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cmath>
+#include <immintrin.h>
+#include "vector_math.h"
+
+// x86 内核：SSE2 为 x86_64 基础指令集，AVX2 通过函数级 target 属性编译，
+// 运行时确认 CPU 支持后才会被选用，因此整个文件不需要额外的编译参数
+
+#define ANDAS_TARGET_SSE2 __attribute__((target("sse2")))
+#define ANDAS_TARGET_AVX2 __attribute__((target("avx2")))
+
+namespace andas {
+namespace simd {
+
+namespace {
+
+// 尾部元素统一使用标量处理
+inline void tailMoments(const double* x, int64_t i, int64_t n, double& sum, double& sumSq, int64_t& count) {
+    for (; i < n; i++) {
+        if (!std::isnan(x[i])) {
+            sum += x[i];
+            sumSq += x[i] * x[i];
+            count++;
+        }
+    }
+}
+
+inline void tailMinMax(const double* x, int64_t i, int64_t n, double& lo, double& hi, int64_t& count) {
+    for (; i < n; i++) {
+        if (!std::isnan(x[i])) {
+            if (x[i] < lo) lo = x[i];
+            if (x[i] > hi) hi = x[i];
+            count++;
+        }
+    }
+}
+
+// ==================== SSE2 ====================
+// 每次迭代 4 个累加器 x 2 路，共 8 个元素，打断加法依赖链
+
+ANDAS_TARGET_SSE2 inline double hsum(__m128d v) {
+    return _mm_cvtsd_f64(v) + _mm_cvtsd_f64(_mm_unpackhi_pd(v, v));
+}
+
+ANDAS_TARGET_SSE2 inline int64_t hsum(__m128i v) {
+    alignas(16) int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+    return lanes[0] + lanes[1];
+}
+
+template <CompareOp OP>
+ANDAS_TARGET_SSE2 inline __m128d cmpSse2(__m128d a, __m128d b) {
+    switch (OP) {
+        case CompareOp::GT: return _mm_cmpgt_pd(a, b);
+        case CompareOp::GE: return _mm_cmpge_pd(a, b);
+        case CompareOp::LT: return _mm_cmplt_pd(a, b);
+        case CompareOp::LE: return _mm_cmple_pd(a, b);
+        case CompareOp::EQ: return _mm_cmpeq_pd(a, b);
+        case CompareOp::NE: return _mm_cmpneq_pd(a, b);
+    }
+    return _mm_setzero_pd();
+}
+
+ANDAS_TARGET_SSE2
+void sse2NanMoments(const double* x, int64_t n, double* sum, double* sumSq, int64_t* count) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+    __m128d q0 = _mm_setzero_pd(), q1 = _mm_setzero_pd(), q2 = _mm_setzero_pd(), q3 = _mm_setzero_pd();
+    __m128i c0 = _mm_setzero_si128(), c1 = _mm_setzero_si128();
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128d v0 = _mm_loadu_pd(x + i);
+        __m128d v1 = _mm_loadu_pd(x + i + 2);
+        __m128d v2 = _mm_loadu_pd(x + i + 4);
+        __m128d v3 = _mm_loadu_pd(x + i + 6);
+        // 有序比较：非 NaN 的通道为全 1
+        __m128d m0 = _mm_cmpord_pd(v0, v0);
+        __m128d m1 = _mm_cmpord_pd(v1, v1);
+        __m128d m2 = _mm_cmpord_pd(v2, v2);
+        __m128d m3 = _mm_cmpord_pd(v3, v3);
+        v0 = _mm_and_pd(v0, m0);
+        v1 = _mm_and_pd(v1, m1);
+        v2 = _mm_and_pd(v2, m2);
+        v3 = _mm_and_pd(v3, m3);
+        s0 = _mm_add_pd(s0, v0);
+        s1 = _mm_add_pd(s1, v1);
+        s2 = _mm_add_pd(s2, v2);
+        s3 = _mm_add_pd(s3, v3);
+        q0 = _mm_add_pd(q0, _mm_mul_pd(v0, v0));
+        q1 = _mm_add_pd(q1, _mm_mul_pd(v1, v1));
+        q2 = _mm_add_pd(q2, _mm_mul_pd(v2, v2));
+        q3 = _mm_add_pd(q3, _mm_mul_pd(v3, v3));
+        // 全 1 掩码按整数解释为 -1，相减即计数
+        c0 = _mm_sub_epi64(c0, _mm_castpd_si128(m0));
+        c1 = _mm_sub_epi64(c1, _mm_castpd_si128(m1));
+        c0 = _mm_sub_epi64(c0, _mm_castpd_si128(m2));
+        c1 = _mm_sub_epi64(c1, _mm_castpd_si128(m3));
+    }
+    double s = hsum(_mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3)));
+    double sq = hsum(_mm_add_pd(_mm_add_pd(q0, q1), _mm_add_pd(q2, q3)));
+    int64_t c = hsum(_mm_add_epi64(c0, c1));
+    tailMoments(x, i, n, s, sq, c);
+    *sum = s;
+    *sumSq = sq;
+    *count = c;
+}
+
+ANDAS_TARGET_SSE2
+double sse2NanSum(const double* x, int64_t n, int64_t* count) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+    __m128i c0 = _mm_setzero_si128(), c1 = _mm_setzero_si128();
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128d v0 = _mm_loadu_pd(x + i);
+        __m128d v1 = _mm_loadu_pd(x + i + 2);
+        __m128d v2 = _mm_loadu_pd(x + i + 4);
+        __m128d v3 = _mm_loadu_pd(x + i + 6);
+        __m128d m0 = _mm_cmpord_pd(v0, v0);
+        __m128d m1 = _mm_cmpord_pd(v1, v1);
+        __m128d m2 = _mm_cmpord_pd(v2, v2);
+        __m128d m3 = _mm_cmpord_pd(v3, v3);
+        s0 = _mm_add_pd(s0, _mm_and_pd(v0, m0));
+        s1 = _mm_add_pd(s1, _mm_and_pd(v1, m1));
+        s2 = _mm_add_pd(s2, _mm_and_pd(v2, m2));
+        s3 = _mm_add_pd(s3, _mm_and_pd(v3, m3));
+        c0 = _mm_sub_epi64(c0, _mm_castpd_si128(m0));
+        c1 = _mm_sub_epi64(c1, _mm_castpd_si128(m1));
+        c0 = _mm_sub_epi64(c0, _mm_castpd_si128(m2));
+        c1 = _mm_sub_epi64(c1, _mm_castpd_si128(m3));
+    }
+    double s = hsum(_mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3)));
+    int64_t c = hsum(_mm_add_epi64(c0, c1));
+    for (; i < n; i++) {
+        if (!std::isnan(x[i])) {
+            s += x[i];
+            c++;
+        }
+    }
+    if (count != nullptr) *count = c;
+    return s;
+}
+
+ANDAS_TARGET_SSE2
+int64_t sse2NanMinMax(const double* x, int64_t n, double* min, double* max) {
+    const __m128d posInf = _mm_set1_pd(INFINITY);
+    const __m128d negInf = _mm_set1_pd(-INFINITY);
+    __m128d lo0 = posInf, lo1 = posInf, hi0 = negInf, hi1 = negInf;
+    __m128i c0 = _mm_setzero_si128(), c1 = _mm_setzero_si128();
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d v0 = _mm_loadu_pd(x + i);
+        __m128d v1 = _mm_loadu_pd(x + i + 2);
+        __m128d m0 = _mm_cmpord_pd(v0, v0);
+        __m128d m1 = _mm_cmpord_pd(v1, v1);
+        // NaN 通道替换为不影响结果的无穷值（SSE2 没有 blendv，用与/与非/或组合）
+        lo0 = _mm_min_pd(lo0, _mm_or_pd(_mm_and_pd(m0, v0), _mm_andnot_pd(m0, posInf)));
+        lo1 = _mm_min_pd(lo1, _mm_or_pd(_mm_and_pd(m1, v1), _mm_andnot_pd(m1, posInf)));
+        hi0 = _mm_max_pd(hi0, _mm_or_pd(_mm_and_pd(m0, v0), _mm_andnot_pd(m0, negInf)));
+        hi1 = _mm_max_pd(hi1, _mm_or_pd(_mm_and_pd(m1, v1), _mm_andnot_pd(m1, negInf)));
+        c0 = _mm_sub_epi64(c0, _mm_castpd_si128(m0));
+        c1 = _mm_sub_epi64(c1, _mm_castpd_si128(m1));
+    }
+    __m128d lo = _mm_min_pd(lo0, lo1);
+    __m128d hi = _mm_max_pd(hi0, hi1);
+    double l = std::fmin(_mm_cvtsd_f64(lo), _mm_cvtsd_f64(_mm_unpackhi_pd(lo, lo)));
+    double h = std::fmax(_mm_cvtsd_f64(hi), _mm_cvtsd_f64(_mm_unpackhi_pd(hi, hi)));
+    int64_t c = hsum(_mm_add_epi64(c0, c1));
+    tailMinMax(x, i, n, l, h, c);
+    *min = l;
+    *max = h;
+    return c;
+}
+
+ANDAS_TARGET_SSE2
+double sse2Dot(const double* a, const double* b, int64_t n) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+        s2 = _mm_add_pd(s2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+        s3 = _mm_add_pd(s3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6)));
+    }
+    double s = hsum(_mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3)));
+    for (; i < n; i++) s += a[i] * b[i];
+    return s;
+}
+
+ANDAS_TARGET_SSE2
+void sse2Add(const double* a, const double* b, double* out, int64_t n) {
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    for (; i < n; i++) out[i] = a[i] + b[i];
+}
+
+ANDAS_TARGET_SSE2
+void sse2Multiply(const double* a, const double* b, double* out, int64_t n) {
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    for (; i < n; i++) out[i] = a[i] * b[i];
+}
+
+ANDAS_TARGET_SSE2
+void sse2Scale(const double* x, double multiplier, double* out, int64_t n) {
+    const __m128d m = _mm_set1_pd(multiplier);
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(x + i), m));
+    }
+    for (; i < n; i++) out[i] = x[i] * multiplier;
+}
+
+template <CompareOp OP>
+ANDAS_TARGET_SSE2
+void sse2CompareMaskT(const double* x, int64_t n, double threshold, uint64_t* bits) {
+    const __m128d t = _mm_set1_pd(threshold);
+    int64_t i = 0;
+    int64_t w = 0;
+    for (; i + 64 <= n; i += 64, w++) {
+        uint64_t word = 0;
+        for (int j = 0; j < 64; j += 2) {
+            uint64_t m = static_cast<uint64_t>(_mm_movemask_pd(cmpSse2<OP>(_mm_loadu_pd(x + i + j), t)));
+            word |= m << j;
+        }
+        bits[w] = word;
+    }
+    if (i < n) {
+        uint64_t word = 0;
+        for (int64_t j = 0; i + j < n; j++) {
+            if (compare(x[i + j], threshold, OP)) word |= uint64_t(1) << j;
+        }
+        bits[w] = word;
+    }
+}
+
+template <CompareOp OP>
+ANDAS_TARGET_SSE2
+void sse2CompareBytesT(const double* x, int64_t n, double threshold, uint8_t* out) {
+    const __m128d t = _mm_set1_pd(threshold);
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        int m = _mm_movemask_pd(cmpSse2<OP>(_mm_loadu_pd(x + i), t));
+        out[i] = static_cast<uint8_t>(m & 1);
+        out[i + 1] = static_cast<uint8_t>((m >> 1) & 1);
+    }
+    for (; i < n; i++) out[i] = compare(x[i], threshold, OP) ? 1 : 0;
+}
+
+// ==================== AVX2 ====================
+// 每次迭代 4 个累加器 x 4 路，共 16 个元素
+
+ANDAS_TARGET_AVX2 inline double hsum(__m256d v) {
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_add_pd(lo, hi);
+    return _mm_cvtsd_f64(lo) + _mm_cvtsd_f64(_mm_unpackhi_pd(lo, lo));
+}
+
+ANDAS_TARGET_AVX2 inline int64_t hsum(__m256i v) {
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+template <CompareOp OP>
+ANDAS_TARGET_AVX2 inline __m256d cmpAvx2(__m256d a, __m256d b) {
+    switch (OP) {
+        case CompareOp::GT: return _mm256_cmp_pd(a, b, _CMP_GT_OQ);
+        case CompareOp::GE: return _mm256_cmp_pd(a, b, _CMP_GE_OQ);
+        case CompareOp::LT: return _mm256_cmp_pd(a, b, _CMP_LT_OQ);
+        case CompareOp::LE: return _mm256_cmp_pd(a, b, _CMP_LE_OQ);
+        case CompareOp::EQ: return _mm256_cmp_pd(a, b, _CMP_EQ_OQ);
+        case CompareOp::NE: return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ);
+    }
+    return _mm256_setzero_pd();
+}
+
+ANDAS_TARGET_AVX2
+void avx2NanMoments(const double* x, int64_t n, double* sum, double* sumSq, int64_t* count) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    __m256d q0 = _mm256_setzero_pd(), q1 = _mm256_setzero_pd(), q2 = _mm256_setzero_pd(), q3 = _mm256_setzero_pd();
+    __m256i c0 = _mm256_setzero_si256(), c1 = _mm256_setzero_si256();
+    int64_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256d v0 = _mm256_loadu_pd(x + i);
+        __m256d v1 = _mm256_loadu_pd(x + i + 4);
+        __m256d v2 = _mm256_loadu_pd(x + i + 8);
+        __m256d v3 = _mm256_loadu_pd(x + i + 12);
+        __m256d m0 = _mm256_cmp_pd(v0, v0, _CMP_ORD_Q);
+        __m256d m1 = _mm256_cmp_pd(v1, v1, _CMP_ORD_Q);
+        __m256d m2 = _mm256_cmp_pd(v2, v2, _CMP_ORD_Q);
+        __m256d m3 = _mm256_cmp_pd(v3, v3, _CMP_ORD_Q);
+        v0 = _mm256_and_pd(v0, m0);
+        v1 = _mm256_and_pd(v1, m1);
+        v2 = _mm256_and_pd(v2, m2);
+        v3 = _mm256_and_pd(v3, m3);
+        s0 = _mm256_add_pd(s0, v0);
+        s1 = _mm256_add_pd(s1, v1);
+        s2 = _mm256_add_pd(s2, v2);
+        s3 = _mm256_add_pd(s3, v3);
+        q0 = _mm256_add_pd(q0, _mm256_mul_pd(v0, v0));
+        q1 = _mm256_add_pd(q1, _mm256_mul_pd(v1, v1));
+        q2 = _mm256_add_pd(q2, _mm256_mul_pd(v2, v2));
+        q3 = _mm256_add_pd(q3, _mm256_mul_pd(v3, v3));
+        c0 = _mm256_sub_epi64(c0, _mm256_castpd_si256(m0));
+        c1 = _mm256_sub_epi64(c1, _mm256_castpd_si256(m1));
+        c0 = _mm256_sub_epi64(c0, _mm256_castpd_si256(m2));
+        c1 = _mm256_sub_epi64(c1, _mm256_castpd_si256(m3));
+    }
+    double s = hsum(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+    double sq = hsum(_mm256_add_pd(_mm256_add_pd(q0, q1), _mm256_add_pd(q2, q3)));
+    int64_t c = hsum(_mm256_add_epi64(c0, c1));
+    tailMoments(x, i, n, s, sq, c);
+    *sum = s;
+    *sumSq = sq;
+    *count = c;
+}
+
+ANDAS_TARGET_AVX2
+double avx2NanSum(const double* x, int64_t n, int64_t* count) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    __m256i c0 = _mm256_setzero_si256(), c1 = _mm256_setzero_si256();
+    int64_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256d v0 = _mm256_loadu_pd(x + i);
+        __m256d v1 = _mm256_loadu_pd(x + i + 4);
+        __m256d v2 = _mm256_loadu_pd(x + i + 8);
+        __m256d v3 = _mm256_loadu_pd(x + i + 12);
+        __m256d m0 = _mm256_cmp_pd(v0, v0, _CMP_ORD_Q);
+        __m256d m1 = _mm256_cmp_pd(v1, v1, _CMP_ORD_Q);
+        __m256d m2 = _mm256_cmp_pd(v2, v2, _CMP_ORD_Q);
+        __m256d m3 = _mm256_cmp_pd(v3, v3, _CMP_ORD_Q);
+        s0 = _mm256_add_pd(s0, _mm256_and_pd(v0, m0));
+        s1 = _mm256_add_pd(s1, _mm256_and_pd(v1, m1));
+        s2 = _mm256_add_pd(s2, _mm256_and_pd(v2, m2));
+        s3 = _mm256_add_pd(s3, _mm256_and_pd(v3, m3));
+        c0 = _mm256_sub_epi64(c0, _mm256_castpd_si256(m0));
+        c1 = _mm256_sub_epi64(c1, _mm256_castpd_si256(m1));
+        c0 = _mm256_sub_epi64(c0, _mm256_castpd_si256(m2));
+        c1 = _mm256_sub_epi64(c1, _mm256_castpd_si256(m3));
+    }
+    double s = hsum(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+    int64_t c = hsum(_mm256_add_epi64(c0, c1));
+    for (; i < n; i++) {
+        if (!std::isnan(x[i])) {
+            s += x[i];
+            c++;
+        }
+    }
+    if (count != nullptr) *count = c;
+    return s;
+}
+
+ANDAS_TARGET_AVX2
+int64_t avx2NanMinMax(const double* x, int64_t n, double* min, double* max) {
+    const __m256d posInf = _mm256_set1_pd(INFINITY);
+    const __m256d negInf = _mm256_set1_pd(-INFINITY);
+    __m256d lo0 = posInf, lo1 = posInf, hi0 = negInf, hi1 = negInf;
+    __m256i c0 = _mm256_setzero_si256(), c1 = _mm256_setzero_si256();
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d v0 = _mm256_loadu_pd(x + i);
+        __m256d v1 = _mm256_loadu_pd(x + i + 4);
+        __m256d m0 = _mm256_cmp_pd(v0, v0, _CMP_ORD_Q);
+        __m256d m1 = _mm256_cmp_pd(v1, v1, _CMP_ORD_Q);
+        lo0 = _mm256_min_pd(lo0, _mm256_blendv_pd(posInf, v0, m0));
+        lo1 = _mm256_min_pd(lo1, _mm256_blendv_pd(posInf, v1, m1));
+        hi0 = _mm256_max_pd(hi0, _mm256_blendv_pd(negInf, v0, m0));
+        hi1 = _mm256_max_pd(hi1, _mm256_blendv_pd(negInf, v1, m1));
+        c0 = _mm256_sub_epi64(c0, _mm256_castpd_si256(m0));
+        c1 = _mm256_sub_epi64(c1, _mm256_castpd_si256(m1));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_min_pd(lo0, lo1));
+    double l = std::fmin(std::fmin(lanes[0], lanes[1]), std::fmin(lanes[2], lanes[3]));
+    _mm256_store_pd(lanes, _mm256_max_pd(hi0, hi1));
+    double h = std::fmax(std::fmax(lanes[0], lanes[1]), std::fmax(lanes[2], lanes[3]));
+    int64_t c = hsum(_mm256_add_epi64(c0, c1));
+    tailMinMax(x, i, n, l, h, c);
+    *min = l;
+    *max = h;
+    return c;
+}
+
+ANDAS_TARGET_AVX2
+double avx2Dot(const double* a, const double* b, int64_t n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    int64_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+        s2 = _mm256_add_pd(s2, _mm256_mul_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8)));
+        s3 = _mm256_add_pd(s3, _mm256_mul_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12)));
+    }
+    double s = hsum(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+    for (; i < n; i++) s += a[i] * b[i];
+    return s;
+}
+
+ANDAS_TARGET_AVX2
+void avx2Add(const double* a, const double* b, double* out, int64_t n) {
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    for (; i < n; i++) out[i] = a[i] + b[i];
+}
+
+ANDAS_TARGET_AVX2
+void avx2Multiply(const double* a, const double* b, double* out, int64_t n) {
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    for (; i < n; i++) out[i] = a[i] * b[i];
+}
+
+ANDAS_TARGET_AVX2
+void avx2Scale(const double* x, double multiplier, double* out, int64_t n) {
+    const __m256d m = _mm256_set1_pd(multiplier);
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), m));
+    }
+    for (; i < n; i++) out[i] = x[i] * multiplier;
+}
+
+template <CompareOp OP>
+ANDAS_TARGET_AVX2
+void avx2CompareMaskT(const double* x, int64_t n, double threshold, uint64_t* bits) {
+    const __m256d t = _mm256_set1_pd(threshold);
+    int64_t i = 0;
+    int64_t w = 0;
+    for (; i + 64 <= n; i += 64, w++) {
+        uint64_t word = 0;
+        for (int j = 0; j < 64; j += 4) {
+            uint64_t m = static_cast<uint64_t>(_mm256_movemask_pd(cmpAvx2<OP>(_mm256_loadu_pd(x + i + j), t)));
+            word |= m << j;
+        }
+        bits[w] = word;
+    }
+    if (i < n) {
+        uint64_t word = 0;
+        for (int64_t j = 0; i + j < n; j++) {
+            if (compare(x[i + j], threshold, OP)) word |= uint64_t(1) << j;
+        }
+        bits[w] = word;
+    }
+}
+
+template <CompareOp OP>
+ANDAS_TARGET_AVX2
+void avx2CompareBytesT(const double* x, int64_t n, double threshold, uint8_t* out) {
+    const __m256d t = _mm256_set1_pd(threshold);
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int m = _mm256_movemask_pd(cmpAvx2<OP>(_mm256_loadu_pd(x + i), t));
+        out[i] = static_cast<uint8_t>(m & 1);
+        out[i + 1] = static_cast<uint8_t>((m >> 1) & 1);
+        out[i + 2] = static_cast<uint8_t>((m >> 2) & 1);
+        out[i + 3] = static_cast<uint8_t>((m >> 3) & 1);
+    }
+    for (; i < n; i++) out[i] = compare(x[i], threshold, OP) ? 1 : 0;
+}
+
+// 运行时比较符分派到编译期特化的模板
+#define ANDAS_DISPATCH_COMPARE(FN, OP, ...)                      \
+    switch (OP) {                                                \
+        case CompareOp::GT: FN<CompareOp::GT>(__VA_ARGS__); break; \
+        case CompareOp::GE: FN<CompareOp::GE>(__VA_ARGS__); break; \
+        case CompareOp::LT: FN<CompareOp::LT>(__VA_ARGS__); break; \
+        case CompareOp::LE: FN<CompareOp::LE>(__VA_ARGS__); break; \
+        case CompareOp::EQ: FN<CompareOp::EQ>(__VA_ARGS__); break; \
+        case CompareOp::NE: FN<CompareOp::NE>(__VA_ARGS__); break; \
+    }
+
+void sse2CompareMask(const double* x, int64_t n, double threshold, CompareOp op, uint64_t* bits) {
+    ANDAS_DISPATCH_COMPARE(sse2CompareMaskT, op, x, n, threshold, bits)
+}
+
+void sse2CompareBytes(const double* x, int64_t n, double threshold, CompareOp op, uint8_t* out) {
+    ANDAS_DISPATCH_COMPARE(sse2CompareBytesT, op, x, n, threshold, out)
+}
+
+void avx2CompareMask(const double* x, int64_t n, double threshold, CompareOp op, uint64_t* bits) {
+    ANDAS_DISPATCH_COMPARE(avx2CompareMaskT, op, x, n, threshold, bits)
+}
+
+void avx2CompareBytes(const double* x, int64_t n, double threshold, CompareOp op, uint8_t* out) {
+    ANDAS_DISPATCH_COMPARE(avx2CompareBytesT, op, x, n, threshold, out)
+}
+
+#undef ANDAS_DISPATCH_COMPARE
+
+inline int64_t tailFindStructural(const char* p, int64_t i, int64_t n, char delimiter, char quote) {
+    for (; i < n; i++) {
+        if (p[i] == delimiter || p[i] == quote || p[i] == '\n') return i;
+    }
+    return n;
+}
+
+ANDAS_TARGET_SSE2
+int64_t sse2FindStructural(const char* p, int64_t n, char delimiter, char quote) {
+    const __m128i d = _mm_set1_epi8(delimiter);
+    const __m128i q = _mm_set1_epi8(quote);
+    const __m128i nl = _mm_set1_epi8('\n');
+    int64_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, d), _mm_cmpeq_epi8(v, q)), _mm_cmpeq_epi8(v, nl));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0) return i + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    return tailFindStructural(p, i, n, delimiter, quote);
+}
+
+ANDAS_TARGET_AVX2
+int64_t avx2FindStructural(const char* p, int64_t n, char delimiter, char quote) {
+    const __m256i d = _mm256_set1_epi8(delimiter);
+    const __m256i q = _mm256_set1_epi8(quote);
+    const __m256i nl = _mm256_set1_epi8('\n');
+    int64_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, d), _mm256_cmpeq_epi8(v, q)),
+                                      _mm256_cmpeq_epi8(v, nl));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+    return tailFindStructural(p, i, n, delimiter, quote);
+}
+
+// 超越函数：在目标指令集下实例化 vector_math.h 的无分支循环，由编译器向量化
+ANDAS_TARGET_SSE2 void sse2Exp(const double* x, double* out, int64_t n) { vmath::expLoop(x, out, n); }
+ANDAS_TARGET_SSE2 void sse2Log(const double* x, double* out, int64_t n) { vmath::logLoop(x, out, n); }
+ANDAS_TARGET_SSE2 void sse2Sin(const double* x, double* out, int64_t n) { vmath::sinLoop(x, out, n); }
+ANDAS_TARGET_SSE2 void sse2Cos(const double* x, double* out, int64_t n) { vmath::cosLoop(x, out, n); }
+
+ANDAS_TARGET_AVX2 void avx2Exp(const double* x, double* out, int64_t n) { vmath::expLoop(x, out, n); }
+ANDAS_TARGET_AVX2 void avx2Log(const double* x, double* out, int64_t n) { vmath::logLoop(x, out, n); }
+ANDAS_TARGET_AVX2 void avx2Sin(const double* x, double* out, int64_t n) { vmath::sinLoop(x, out, n); }
+ANDAS_TARGET_AVX2 void avx2Cos(const double* x, double* out, int64_t n) { vmath::cosLoop(x, out, n); }
+
+const Kernels kSse2Kernels = {
+    Level::SSE2,
+    "sse2",
+    sse2NanSum,
+    sse2NanMoments,
+    sse2NanMinMax,
+    sse2Dot,
+    sse2Add,
+    sse2Multiply,
+    sse2Scale,
+    sse2CompareMask,
+    sse2CompareBytes,
+    sse2FindStructural,
+    sse2Exp,
+    sse2Log,
+    sse2Sin,
+    sse2Cos,
+};
+
+const Kernels kAvx2Kernels = {
+    Level::AVX2,
+    "avx2",
+    avx2NanSum,
+    avx2NanMoments,
+    avx2NanMinMax,
+    avx2Dot,
+    avx2Add,
+    avx2Multiply,
+    avx2Scale,
+    avx2CompareMask,
+    avx2CompareBytes,
+    avx2FindStructural,
+    avx2Exp,
+    avx2Log,
+    avx2Sin,
+    avx2Cos,
+};
+
+} // namespace
+
+const Kernels* sse2Kernels() {
+#if defined(__x86_64__)
+    return &kSse2Kernels;
+#else
+    return __builtin_cpu_supports("sse2") ? &kSse2Kernels : nullptr;
+#endif
+}
+
+const Kernels* avx2Kernels() {
+    return __builtin_cpu_supports("avx2") ? &kAvx2Kernels : nullptr;
+}
+
+} // namespace simd
+} // namespace andas
+
+#else
+
+namespace andas {
+namespace simd {
+
+const Kernels* sse2Kernels() {
+    return nullptr;
+}
+
+const Kernels* avx2Kernels() {
+    return nullptr;
+}
+
+} // namespace simd
+} // namespace andas
+
+#endif
@@ -0,0 +1,479 @@
+#include "sketches.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "hash_utils.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+// ==================== QuantileSketch (KLL) ====================
+
+QuantileSketch::QuantileSketch(int32_t k)
+    : k_(std::max(k, kMinK)),
+      min_(std::numeric_limits<double>::infinity()),
+      max_(-std::numeric_limits<double>::infinity()) {
+    grow();
+}
+
+int64_t QuantileSketch::capacity(size_t level) const {
+    const double depth = static_cast<double>(levels_.size() - level - 1);
+    return static_cast<int64_t>(std::ceil(std::pow(2.0 / 3.0, depth) * k_)) + 1;
+}
+
+void QuantileSketch::grow() {
+    levels_.emplace_back();
+    maxSize_ = 0;
+    for (size_t h = 0; h < levels_.size(); h++) maxSize_ += capacity(h);
+}
+
+void QuantileSketch::compress() {
+    for (size_t h = 0; h < levels_.size(); h++) {
+        if (static_cast<int64_t>(levels_[h].size()) < capacity(h)) continue;
+        if (h + 1 == levels_.size()) grow();
+        std::vector<double>& level = levels_[h];
+        std::vector<double>& next = levels_[h + 1];
+        std::sort(level.begin(), level.end());
+        // 奇数个时最小的元素留在本层，其余两两一组随机保留一个升到上一层
+        const size_t start = level.size() & 1;
+        const size_t coin = mix64(compactions_++) & 1;
+        for (size_t i = start; i + 1 < level.size(); i += 2) {
+            next.push_back(level[i + coin]);
+        }
+        level.resize(start);
+        size_ = 0;
+        for (const auto& l : levels_) size_ += static_cast<int64_t>(l.size());
+        if (size_ < maxSize_) break;
+    }
+}
+
+void QuantileSketch::add(double v) {
+    if (std::isnan(v)) return;
+    if (v < min_) min_ = v;
+    if (v > max_) max_ = v;
+    count_++;
+    levels_[0].push_back(v);
+    if (++size_ >= maxSize_) compress();
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.count_ == 0) return;
+    while (levels_.size() < other.levels_.size()) grow();
+    for (size_t h = 0; h < other.levels_.size(); h++) {
+        levels_[h].insert(levels_[h].end(), other.levels_[h].begin(), other.levels_[h].end());
+    }
+    count_ += other.count_;
+    compactions_ += other.compactions_;
+    if (other.min_ < min_) min_ = other.min_;
+    if (other.max_ > max_) max_ = other.max_;
+    size_ += other.size_;
+    while (size_ >= maxSize_) compress();
+}
+
+double QuantileSketch::min() const {
+    return count_ > 0 ? min_ : std::numeric_limits<double>::quiet_NaN();
+}
+
+double QuantileSketch::max() const {
+    return count_ > 0 ? max_ : std::numeric_limits<double>::quiet_NaN();
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (count_ == 0 || std::isnan(q)) return std::numeric_limits<double>::quiet_NaN();
+    q = std::min(1.0, std::max(0.0, q));
+    if (q == 0.0) return min_;
+    if (q == 1.0) return max_;
+    const double rank = q * static_cast<double>(count_ - 1);
+
+    if (exact()) {
+        std::vector<double> sorted = levels_[0];
+        std::sort(sorted.begin(), sorted.end());
+        const auto lo = static_cast<size_t>(std::floor(rank));
+        const double frac = rank - static_cast<double>(lo);
+        if (lo + 1 >= sorted.size() || frac == 0.0) return sorted[lo];
+        return sorted[lo] + (sorted[lo + 1] - sorted[lo]) * frac;
+    }
+
+    std::vector<std::pair<double, int64_t>> weighted;
+    weighted.reserve(static_cast<size_t>(size_));
+    for (size_t h = 0; h < levels_.size(); h++) {
+        for (double v : levels_[h]) weighted.emplace_back(v, int64_t{1} << h);
+    }
+    std::sort(weighted.begin(), weighted.end());
+    int64_t cumulative = 0;
+    for (const auto& item : weighted) {
+        cumulative += item.second;
+        if (static_cast<double>(cumulative) > rank) return item.first;
+    }
+    return max_;
+}
+
+std::vector<double> QuantileSketch::pack() const {
+    std::vector<double> out;
+    out.reserve(6 + levels_.size() + static_cast<size_t>(size_));
+    out.push_back(k_);
+    out.push_back(static_cast<double>(count_));
+    out.push_back(min());
+    out.push_back(max());
+    out.push_back(static_cast<double>(compactions_));
+    out.push_back(static_cast<double>(levels_.size()));
+    for (const auto& level : levels_) out.push_back(static_cast<double>(level.size()));
+    for (const auto& level : levels_) out.insert(out.end(), level.begin(), level.end());
+    return out;
+}
+
+bool QuantileSketch::unpack(const double* data, int64_t size, QuantileSketch* out) {
+    if (size < 6) return false;
+    const auto k = static_cast<int32_t>(data[0]);
+    const auto levels = static_cast<int64_t>(data[5]);
+    if (k < kMinK || levels < 1 || levels > 64 || size < 6 + levels) return false;
+    QuantileSketch sketch(k);
+    while (static_cast<int64_t>(sketch.levels_.size()) < levels) sketch.grow();
+    int64_t offset = 6 + levels;
+    for (int64_t h = 0; h < levels; h++) {
+        const auto n = static_cast<int64_t>(data[6 + h]);
+        if (n < 0 || offset + n > size) return false;
+        sketch.levels_[h].assign(data + offset, data + offset + n);
+        offset += n;
+        sketch.size_ += n;
+    }
+    sketch.count_ = static_cast<int64_t>(data[1]);
+    if (sketch.count_ > 0) {
+        sketch.min_ = data[2];
+        sketch.max_ = data[3];
+    }
+    sketch.compactions_ = static_cast<uint64_t>(data[4]);
+    while (sketch.size_ >= sketch.maxSize_) sketch.compress();
+    *out = std::move(sketch);
+    return true;
+}
+
+QuantileSketch buildQuantileSketch(const double* x, int64_t n, int32_t k) {
+    return parallel_reduce(0, n, QuantileSketch(k),
+        [&](int64_t lo, int64_t hi) {
+            QuantileSketch local(k);
+            for (int64_t i = lo; i < hi; i++) local.add(x[i]);
+            return local;
+        },
+        [](QuantileSketch a, const QuantileSketch& b) {
+            a.merge(b);
+            return a;
+        });
+}
+
+// ==================== DistinctCounter (HyperLogLog) ====================
+
+namespace {
+
+// Ertl 估计量中的 σ(x)，对应空寄存器比例
+double hllSigma(double x) {
+    if (x == 1.0) return std::numeric_limits<double>::infinity();
+    double y = 1.0;
+    double z = x;
+    for (;;) {
+        x *= x;
+        const double previous = z;
+        z += x * y;
+        y += y;
+        if (z == previous) return z;
+    }
+}
+
+// Ertl 估计量中的 τ(x)，对应已饱和寄存器比例
+double hllTau(double x) {
+    if (x == 0.0 || x == 1.0) return 0.0;
+    double y = 1.0;
+    double z = 1.0 - x;
+    for (;;) {
+        x = std::sqrt(x);
+        const double previous = z;
+        y *= 0.5;
+        z -= (1.0 - x) * (1.0 - x) * y;
+        if (z == previous) return z / 3.0;
+    }
+}
+
+} // namespace
+
+DistinctCounter::DistinctCounter(int32_t precision)
+    : precision_(std::min(kMaxPrecision, std::max(kMinPrecision, precision))),
+      registers_(size_t{1} << precision_, 0) {}
+
+void DistinctCounter::add(int64_t key) {
+    const uint64_t hash = mix64(static_cast<uint64_t>(key));
+    const size_t index = static_cast<size_t>(hash >> (64 - precision_));
+    const uint64_t rest = hash << precision_;
+    const int maxRank = 64 - precision_ + 1;
+    const int rank = rest == 0 ? maxRank : __builtin_clzll(rest) + 1;
+    if (rank > registers_[index]) registers_[index] = static_cast<uint8_t>(rank);
+}
+
+void DistinctCounter::merge(const DistinctCounter& other) {
+    if (other.precision_ != precision_) return;
+    for (size_t i = 0; i < registers_.size(); i++) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+double DistinctCounter::estimate() const {
+    const int q = 64 - precision_;
+    std::vector<int64_t> histogram(static_cast<size_t>(q) + 2, 0);
+    for (uint8_t r : registers_) histogram[r]++;
+    const double m = static_cast<double>(registers_.size());
+    double z = m * hllTau(1.0 - static_cast<double>(histogram[q + 1]) / m);
+    for (int k = q; k >= 1; k--) {
+        z += static_cast<double>(histogram[k]);
+        z *= 0.5;
+    }
+    z += m * hllSigma(static_cast<double>(histogram[0]) / m);
+    return m * m / (2.0 * std::log(2.0) * z);
+}
+
+bool DistinctCounter::fromRegisters(const uint8_t* data, int64_t size, DistinctCounter* out) {
+    for (int32_t p = kMinPrecision; p <= kMaxPrecision; p++) {
+        if ((int64_t{1} << p) != size) continue;
+        DistinctCounter counter(p);
+        const uint8_t maxRank = static_cast<uint8_t>(64 - p + 1);
+        for (int64_t i = 0; i < size; i++) counter.registers_[i] = std::min(data[i], maxRank);
+        *out = std::move(counter);
+        return true;
+    }
+    return false;
+}
+
+int64_t doubleKey(double v) {
+    if (v == 0.0) v = 0.0;
+    int64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+namespace {
+
+template <typename Sketch, typename AddChunk>
+Sketch buildChunked(int64_t n, const Sketch& identity, AddChunk&& addChunk) {
+    return parallel_reduce(0, n, identity,
+        [&](int64_t lo, int64_t hi) {
+            Sketch local = identity;
+            addChunk(local, lo, hi);
+            return local;
+        },
+        [](Sketch a, const Sketch& b) {
+            a.merge(b);
+            return a;
+        });
+}
+
+} // namespace
+
+DistinctCounter buildDistinctCounter(const double* x, int64_t n, int32_t precision) {
+    return buildChunked(n, DistinctCounter(precision), [&](DistinctCounter& local, int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) {
+            if (!std::isnan(x[i])) local.add(doubleKey(x[i]));
+        }
+    });
+}
+
+DistinctCounter buildDistinctCounter(const int64_t* keys, int64_t n, int64_t skipKey, int32_t precision) {
+    return buildChunked(n, DistinctCounter(precision), [&](DistinctCounter& local, int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) {
+            if (keys[i] != skipKey) local.add(keys[i]);
+        }
+    });
+}
+
+// ==================== HeavyHitters (Space-Saving) ====================
+
+HeavyHitters::HeavyHitters(int32_t capacity) : capacity_(std::max(capacity, 1)) {
+    uint64_t slots = 16;
+    while (slots < 2 * static_cast<uint64_t>(capacity_)) slots <<= 1;
+    slotKeys_.assign(slots, 0);
+    slotPositions_.assign(slots, -1);
+    slotMask_ = slots - 1;
+}
+
+int64_t HeavyHitters::findSlot(int64_t key) const {
+    for (uint64_t i = mix64(static_cast<uint64_t>(key)) & slotMask_;; i = (i + 1) & slotMask_) {
+        if (slotPositions_[i] < 0) return -1;
+        if (slotKeys_[i] == key) return static_cast<int64_t>(i);
+    }
+}
+
+void HeavyHitters::insertSlot(int64_t key, int32_t position) {
+    uint64_t i = mix64(static_cast<uint64_t>(key)) & slotMask_;
+    while (slotPositions_[i] >= 0) i = (i + 1) & slotMask_;
+    slotKeys_[i] = key;
+    slotPositions_[i] = position;
+    heapSlots_[position] = static_cast<int64_t>(i);
+}
+
+void HeavyHitters::eraseSlot(int64_t slot) {
+    // 后移删除：把后续探测链上不能越过空槽的元素前移，不留墓碑
+    uint64_t hole = static_cast<uint64_t>(slot);
+    for (uint64_t j = (hole + 1) & slotMask_; slotPositions_[j] >= 0; j = (j + 1) & slotMask_) {
+        const uint64_t home = mix64(static_cast<uint64_t>(slotKeys_[j])) & slotMask_;
+        // home 不在 (hole, j] 之间时，该元素可以移到空槽
+        const bool between = hole < j ? (home > hole && home <= j) : (home > hole || home <= j);
+        if (between) continue;
+        slotKeys_[hole] = slotKeys_[j];
+        slotPositions_[hole] = slotPositions_[j];
+        heapSlots_[slotPositions_[hole]] = static_cast<int64_t>(hole);
+        hole = j;
+    }
+    slotPositions_[hole] = -1;
+}
+
+int64_t HeavyHitters::minCount() const {
+    return static_cast<int32_t>(heap_.size()) < capacity_ ? 0 : heap_[0].count;
+}
+
+void HeavyHitters::swapEntries(int32_t a, int32_t b) {
+    std::swap(heap_[a], heap_[b]);
+    std::swap(heapSlots_[a], heapSlots_[b]);
+    slotPositions_[heapSlots_[a]] = a;
+    slotPositions_[heapSlots_[b]] = b;
+}
+
+void HeavyHitters::siftUp(int32_t i) {
+    while (i > 0) {
+        const int32_t parent = (i - 1) / 2;
+        if (heap_[parent].count <= heap_[i].count) break;
+        swapEntries(i, parent);
+        i = parent;
+    }
+}
+
+void HeavyHitters::siftDown(int32_t i) {
+    const auto n = static_cast<int32_t>(heap_.size());
+    for (;;) {
+        const int32_t left = 2 * i + 1;
+        if (left >= n) break;
+        int32_t smallest = left;
+        if (left + 1 < n && heap_[left + 1].count < heap_[left].count) smallest = left + 1;
+        if (heap_[i].count <= heap_[smallest].count) break;
+        swapEntries(i, smallest);
+        i = smallest;
+    }
+}
+
+void HeavyHitters::add(int64_t key, int64_t weight) {
+    if (weight <= 0) return;
+    total_ += weight;
+    const int64_t slot = findSlot(key);
+    if (slot >= 0) {
+        const int32_t i = slotPositions_[slot];
+        heap_[i].count += weight;
+        siftDown(i);
+        return;
+    }
+    if (static_cast<int32_t>(heap_.size()) < capacity_) {
+        heap_.push_back({key, weight, 0});
+        heapSlots_.push_back(-1);
+        const auto i = static_cast<int32_t>(heap_.size() - 1);
+        insertSlot(key, i);
+        siftUp(i);
+        return;
+    }
+    // 替换计数最小的键，新键继承其计数作为误差上界
+    Entry& root = heap_[0];
+    eraseSlot(heapSlots_[0]);
+    root = {key, root.count + weight, root.count};
+    insertSlot(key, 0);
+    siftDown(0);
+}
+
+void HeavyHitters::rebuild(std::vector<Entry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    if (static_cast<int32_t>(entries.size()) > capacity_) entries.resize(capacity_);
+    heap_.clear();
+    heapSlots_.clear();
+    std::fill(slotPositions_.begin(), slotPositions_.end(), -1);
+    for (const Entry& e : entries) {
+        heap_.push_back(e);
+        heapSlots_.push_back(-1);
+        const auto i = static_cast<int32_t>(heap_.size() - 1);
+        insertSlot(e.key, i);
+        siftUp(i);
+    }
+}
+
+void HeavyHitters::merge(const HeavyHitters& other) {
+    if (other.total_ == 0) return;
+    const int64_t minSelf = minCount();
+    const int64_t minOther = other.minCount();
+    std::vector<Entry> combined;
+    combined.reserve(heap_.size() + other.heap_.size());
+    for (const Entry& e : heap_) {
+        const int64_t slot = other.findSlot(e.key);
+        if (slot >= 0) {
+            const Entry& o = other.heap_[other.slotPositions_[slot]];
+            combined.push_back({e.key, e.count + o.count, e.error + o.error});
+        } else {
+            combined.push_back({e.key, e.count + minOther, e.error + minOther});
+        }
+    }
+    for (const Entry& o : other.heap_) {
+        if (findSlot(o.key) < 0) {
+            combined.push_back({o.key, o.count + minSelf, o.error + minSelf});
+        }
+    }
+    total_ += other.total_;
+    rebuild(std::move(combined));
+}
+
+std::vector<HeavyHitters::Entry> HeavyHitters::top(int32_t k) const {
+    std::vector<Entry> entries = heap_;
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    if (k >= 0 && static_cast<int32_t>(entries.size()) > k) entries.resize(k);
+    return entries;
+}
+
+std::vector<int64_t> HeavyHitters::pack() const {
+    std::vector<int64_t> out;
+    out.reserve(2 + 3 * heap_.size());
+    out.push_back(capacity_);
+    out.push_back(total_);
+    for (const Entry& e : top(-1)) {
+        out.push_back(e.key);
+        out.push_back(e.count);
+        out.push_back(e.error);
+    }
+    return out;
+}
+
+bool HeavyHitters::unpack(const int64_t* data, int64_t size, HeavyHitters* out) {
+    if (size < 2 || (size - 2) % 3 != 0 || data[0] < 1 || data[0] > std::numeric_limits<int32_t>::max()) {
+        return false;
+    }
+    HeavyHitters sketch(static_cast<int32_t>(data[0]));
+    sketch.total_ = data[1];
+    std::vector<Entry> entries;
+    for (int64_t i = 2; i < size; i += 3) entries.push_back({data[i], data[i + 1], data[i + 2]});
+    sketch.rebuild(std::move(entries));
+    *out = std::move(sketch);
+    return true;
+}
+
+HeavyHitters buildHeavyHitters(const double* x, int64_t n, int32_t capacity) {
+    return buildChunked(n, HeavyHitters(capacity), [&](HeavyHitters& local, int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) {
+            if (!std::isnan(x[i])) local.add(doubleKey(x[i]));
+        }
+    });
+}
+
+HeavyHitters buildHeavyHitters(const int64_t* keys, int64_t n, int64_t skipKey, int32_t capacity) {
+    return buildChunked(n, HeavyHitters(capacity), [&](HeavyHitters& local, int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) {
+            if (keys[i] != skipKey) local.add(keys[i]);
+        }
+    });
+}
+
+} // namespace andas
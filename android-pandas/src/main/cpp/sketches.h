@@ -0,0 +1,153 @@
+#ifndef ANDAS_SKETCHES_H
+#define ANDAS_SKETCHES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace andas {
+
+// 可合并的流式摘要（不依赖JNI）：内存与数据量无关，按块、按批、按线程分别构建后合并
+// - QuantileSketch：KLL 分位数摘要
+// - DistinctCounter：HyperLogLog 去重计数
+// - HeavyHitters：Space-Saving 高频项
+// 打包格式与 Kotlin 侧 QuantileSketch / DistinctCountSketch / HeavyHitters 一致
+
+// KLL 分位数摘要：各层压缩器容量按 c = 2/3 几何递减，压缩时排序后隔一个取一个升到上一层，
+// 第 h 层元素的权重为 2^h；秩误差约为 1.7 / k（k = 400 时在 0.5% 以内）
+// 从未压缩过时保存了全部数据，分位数为精确值（线性插值，与 pandas 一致）
+// 压缩的取舍由压缩次数的哈希决定，同样的输入和合并顺序得到同样的结果
+// NaN 视为缺失值，不计入
+// 打包格式：[k, count, min, max, compactions, levels, size_0 .. size_{levels-1}, items...]
+class QuantileSketch {
+public:
+    static constexpr int32_t kDefaultK = 400;
+    static constexpr int32_t kMinK = 8;
+
+    explicit QuantileSketch(int32_t k = kDefaultK);
+
+    void add(double v);
+    void merge(const QuantileSketch& other);
+
+    int32_t k() const { return k_; }
+    int64_t count() const { return count_; }
+    double min() const;
+    double max() const;
+    // 还保存着全部数据（从未压缩）
+    bool exact() const { return levels_.size() == 1; }
+    int64_t retained() const { return size_; }
+
+    // q 位于 [0, 1]，没有数据时为 NaN
+    double quantile(double q) const;
+
+    std::vector<double> pack() const;
+    // 打包数据不合法时返回 false
+    static bool unpack(const double* data, int64_t size, QuantileSketch* out);
+
+private:
+    int32_t k_;
+    int64_t count_ = 0;
+    double min_;
+    double max_;
+    uint64_t compactions_ = 0;
+    int64_t size_ = 0;
+    int64_t maxSize_ = 0;
+    std::vector<std::vector<double>> levels_;
+
+    int64_t capacity(size_t level) const;
+    void grow();
+    void compress();
+};
+
+// 并行构建 x[0, n) 的分位数摘要：各块分别构建后按顺序合并
+QuantileSketch buildQuantileSketch(const double* x, int64_t n, int32_t k);
+
+// HyperLogLog 去重计数：2^precision 个 6 位寄存器（按字节保存），
+// 标准误差约 1.04 / sqrt(2^precision)（precision = 14 时约 0.8%）
+// 键先经 mix64 打散；估计使用 Ertl 的改进估计量，小基数和大基数都不需要经验修正表
+// 合并为寄存器逐个取最大值，需要相同的 precision
+class DistinctCounter {
+public:
+    static constexpr int32_t kDefaultPrecision = 14;
+    static constexpr int32_t kMinPrecision = 4;
+    static constexpr int32_t kMaxPrecision = 18;
+
+    explicit DistinctCounter(int32_t precision = kDefaultPrecision);
+
+    void add(int64_t key);
+    void merge(const DistinctCounter& other);
+    double estimate() const;
+
+    int32_t precision() const { return precision_; }
+    const std::vector<uint8_t>& registers() const { return registers_; }
+    // 寄存器个数必须是 2 的 precision 次方，否则返回 false
+    static bool fromRegisters(const uint8_t* data, int64_t size, DistinctCounter* out);
+
+private:
+    int32_t precision_;
+    std::vector<uint8_t> registers_;
+};
+
+// double 值的去重键：原始位模式，-0.0 与 0.0 视为同一个值；NaN 的调用方应跳过
+int64_t doubleKey(double v);
+
+// 并行构建去重计数：double 跳过 NaN，int64 跳过 skipKey（缺失值编码）
+DistinctCounter buildDistinctCounter(const double* x, int64_t n, int32_t precision);
+DistinctCounter buildDistinctCounter(const int64_t* keys, int64_t n, int64_t skipKey, int32_t precision);
+
+// Space-Saving 高频项：最多跟踪 capacity 个键，计数器满时新键替换计数最小的键并继承其计数，
+// 每个键的估计计数 count 满足 count - error <= 真实次数 <= count，error <= total / capacity
+// 计数最小的键用索引最小堆维护，单次更新 O(log capacity)，不分配内存
+// 合并时一侧缺少的键按该侧的最小计数补足（Agarwal 等的可合并摘要），再保留计数最大的 capacity 个
+// 打包格式：[capacity, total, (key, count, error)...]
+class HeavyHitters {
+public:
+    static constexpr int32_t kDefaultCapacity = 1024;
+
+    struct Entry {
+        int64_t key;
+        int64_t count;
+        int64_t error;
+    };
+
+    explicit HeavyHitters(int32_t capacity = kDefaultCapacity);
+
+    void add(int64_t key, int64_t weight = 1);
+    void merge(const HeavyHitters& other);
+
+    int32_t capacity() const { return capacity_; }
+    int64_t total() const { return total_; }
+    // 按计数降序的前 k 项，计数相同时键小的在前
+    std::vector<Entry> top(int32_t k) const;
+
+    std::vector<int64_t> pack() const;
+    static bool unpack(const int64_t* data, int64_t size, HeavyHitters* out);
+
+private:
+    int32_t capacity_;
+    int64_t total_ = 0;
+    std::vector<Entry> heap_;   // 按 count 的最小堆
+    std::vector<int64_t> heapSlots_;   // 堆中每项所在的槽，交换时不必重新探测
+    // 键 -> 堆中位置的开放寻址表（线性探测，删除时后移），容量为 2 的幂且不低于 2 * capacity
+    std::vector<int64_t> slotKeys_;
+    std::vector<int32_t> slotPositions_;   // -1 表示空槽
+    uint64_t slotMask_ = 0;
+
+    int64_t minCount() const;
+    // 键所在的槽，不存在时返回 -1
+    int64_t findSlot(int64_t key) const;
+    void insertSlot(int64_t key, int32_t position);
+    void eraseSlot(int64_t slot);
+    void siftUp(int32_t i);
+    void siftDown(int32_t i);
+    void swapEntries(int32_t a, int32_t b);
+    void rebuild(std::vector<Entry> entries);
+};
+
+// 并行构建高频项摘要，跳过规则与 buildDistinctCounter 相同；double 的键为 doubleKey
+HeavyHitters buildHeavyHitters(const double* x, int64_t n, int32_t capacity);
+HeavyHitters buildHeavyHitters(const int64_t* keys, int64_t n, int64_t skipKey, int32_t capacity);
+
+} // namespace andas
+
+#endif //ANDAS_SKETCHES_H
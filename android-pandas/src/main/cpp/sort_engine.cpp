@@ -0,0 +1,279 @@
+#include "sort_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include "memory_pool.h"
+#include "thread_pool.h"
+
+namespace andas {
+
+namespace {
+
+constexpr uint64_t kSignBit = uint64_t{1} << 63;
+constexpr uint64_t kMaxCode = std::numeric_limits<uint64_t>::max();
+
+// 基数排序的块不小于该行数，更小的区间直接用 std::stable_sort
+constexpr int64_t kRadixMinRows = 256;
+// 并行排序时每块至少的行数
+constexpr int64_t kParallelChunkRows = 1 << 16;
+
+// 非缺失值的编码落在 [1, kMaxCode - 1]，缺失值为 0 或 kMaxCode，互不冲突
+inline uint64_t encodeRow(const SortKey& key, int64_t row) {
+    const uint64_t nullCode = key.nullsFirst ? 0 : kMaxCode;
+    if (key.type == SortKeyType::FLOAT64) {
+        return encodeSortKey(static_cast<const double*>(key.values)[row], key.descending, key.nullsFirst);
+    }
+    const int64_t v = static_cast<const int64_t*>(key.values)[row];
+    if (v == kNullSortKey) return nullCode;
+    // 去掉缺失值后的取值范围为 [0, kMaxCode - 1]
+    uint64_t code = (static_cast<uint64_t>(v) ^ kSignBit) - 1;
+    if (key.descending) code = (kMaxCode - 1) - code;
+    return key.nullsFirst ? code + 1 : code;
+}
+
+// LSD 基数排序 (keys, rows) 对，每趟 8 位，结果写回 keys/rows
+template <typename K>
+void radixSort(K* keys, int32_t* rows, K* keyScratch, int32_t* rowScratch, int64_t n) {
+    if (n <= 1) return;
+    if (n < kRadixMinRows) {
+        std::vector<std::pair<K, int32_t>> pairs(static_cast<size_t>(n));
+        for (int64_t i = 0; i < n; i++) pairs[static_cast<size_t>(i)] = {keys[i], rows[i]};
+        std::stable_sort(pairs.begin(), pairs.end(),
+                         [](const std::pair<K, int32_t>& a, const std::pair<K, int32_t>& b) { return a.first < b.first; });
+        for (int64_t i = 0; i < n; i++) {
+            keys[i] = pairs[static_cast<size_t>(i)].first;
+            rows[i] = pairs[static_cast<size_t>(i)].second;
+        }
+        return;
+    }
+
+    constexpr int kPasses = static_cast<int>(sizeof(K));
+    ScratchBuffer<int64_t> counts(kPasses * 256);
+    std::fill(counts.begin(), counts.end(), 0);
+    for (int64_t i = 0; i < n; i++) {
+        const K key = keys[i];
+        for (int p = 0; p < kPasses; p++) {
+            counts[p * 256 + ((key >> (8 * p)) & 0xFF)]++;
+        }
+    }
+
+    K* srcKeys = keys;
+    int32_t* srcRows = rows;
+    K* dstKeys = keyScratch;
+    int32_t* dstRows = rowScratch;
+    for (int p = 0; p < kPasses; p++) {
+        int64_t* count = counts.data() + p * 256;
+        // 所有行该字节相同，本趟不改变顺序
+        if (count[(keys[0] >> (8 * p)) & 0xFF] == n) continue;
+        int64_t offset = 0;
+        for (int b = 0; b < 256; b++) {
+            const int64_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+        for (int64_t i = 0; i < n; i++) {
+            const K key = srcKeys[i];
+            const int64_t pos = count[(key >> (8 * p)) & 0xFF]++;
+            dstKeys[pos] = key;
+            dstRows[pos] = srcRows[i];
+        }
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcRows, dstRows);
+    }
+    if (srcKeys != keys) {
+        std::memcpy(keys, srcKeys, static_cast<size_t>(n) * sizeof(K));
+        std::memcpy(rows, srcRows, static_cast<size_t>(n) * sizeof(int32_t));
+    }
+}
+
+// merge path：a、b 归并后前 diagonal 个元素中来自 a 的个数；键相等时 a 在前（稳定）
+template <typename K>
+int64_t coRank(const K* a, int64_t m, const K* b, int64_t l, int64_t diagonal) {
+    int64_t lo = std::max<int64_t>(0, diagonal - l);
+    int64_t hi = std::min(diagonal, m);
+    while (lo < hi) {
+        const int64_t mid = lo + (hi - lo) / 2;
+        if (a[mid] <= b[diagonal - mid - 1]) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// 稳定归并 src 的 [0, m) 与 [m, m + l) 的一段输出 [d0, d1) 到 dst
+template <typename K>
+void mergeSegment(const K* srcKeys, const int32_t* srcRows, int64_t m, int64_t l,
+                  K* dstKeys, int32_t* dstRows, int64_t d0, int64_t d1) {
+    const K* aKeys = srcKeys;
+    const K* bKeys = srcKeys + m;
+    int64_t i = coRank(aKeys, m, bKeys, l, d0);
+    int64_t j = d0 - i;
+    const int64_t iEnd = coRank(aKeys, m, bKeys, l, d1);
+    const int64_t jEnd = d1 - iEnd;
+    for (int64_t d = d0; d < d1; d++) {
+        if (j >= jEnd || (i < iEnd && aKeys[i] <= bKeys[j])) {
+            dstKeys[d] = aKeys[i];
+            dstRows[d] = srcRows[i];
+            i++;
+        } else {
+            dstKeys[d] = bKeys[j];
+            dstRows[d] = srcRows[m + j];
+            j++;
+        }
+    }
+}
+
+// 稳定排序 (keys, rows)：小数据串行基数排序；大数据分块并行基数排序后逐层归并，
+// 每层的每次归并再按 merge path 切成多段并行
+template <typename K>
+void sortPairs(K* keys, int32_t* rows, int64_t n) {
+    if (n <= 1) return;
+    ScratchBuffer<K> keyScratch(n);
+    ScratchBuffer<int32_t> rowScratch(n);
+    if (detail::shouldRunSerial(n)) {
+        radixSort(keys, rows, keyScratch.data(), rowScratch.data(), n);
+        return;
+    }
+
+    ThreadPool& pool = ThreadPool::instance();
+    const int64_t threads = pool.threadCount();
+    const int64_t chunks = std::max<int64_t>(1, std::min<int64_t>(threads, n / kParallelChunkRows));
+    const int64_t grain = (n + chunks - 1) / chunks;
+    std::function<void(int64_t)> sortTask = [&](int64_t chunk) {
+        const int64_t lo = chunk * grain;
+        const int64_t hi = std::min(n, lo + grain);
+        if (lo < hi) radixSort(keys + lo, rows + lo, keyScratch.data() + lo, rowScratch.data() + lo, hi - lo);
+    };
+    pool.run(chunks, sortTask);
+
+    K* srcKeys = keys;
+    int32_t* srcRows = rows;
+    K* dstKeys = keyScratch.data();
+    int32_t* dstRows = rowScratch.data();
+    for (int64_t width = grain; width < n; width *= 2) {
+        const int64_t pairs = (n + 2 * width - 1) / (2 * width);
+        const int64_t segments = std::max<int64_t>(1, threads * 2 / pairs);
+        std::function<void(int64_t)> mergeTask = [&](int64_t task) {
+            const int64_t pair = task / segments;
+            const int64_t segment = task % segments;
+            const int64_t lo = pair * 2 * width;
+            const int64_t mid = std::min(n, lo + width);
+            const int64_t hi = std::min(n, lo + 2 * width);
+            const int64_t total = hi - lo;
+            const int64_t d0 = total * segment / segments;
+            const int64_t d1 = total * (segment + 1) / segments;
+            mergeSegment(srcKeys + lo, srcRows + lo, mid - lo, hi - mid, dstKeys + lo, dstRows + lo, d0, d1);
+        };
+        pool.run(pairs * segments, mergeTask);
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcRows, dstRows);
+    }
+    if (srcKeys != keys) {
+        parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+            std::memcpy(keys + lo, srcKeys + lo, static_cast<size_t>(hi - lo) * sizeof(K));
+            std::memcpy(rows + lo, srcRows + lo, static_cast<size_t>(hi - lo) * sizeof(int32_t));
+        });
+    }
+}
+
+// 按一个键对 order 做稳定排序
+void sortByKey(const SortKey& key, int32_t* order, int64_t n) {
+    // codes 在改用 32 位键时提前归还，生命周期不是后进先出，从池中分配
+    PooledBuffer<uint64_t> codes(n);
+    parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) codes[i] = encodeRow(key, order[i]);
+    });
+    using Range = std::pair<uint64_t, uint64_t>;
+    const Range range = parallel_reduce(0, n, Range{kMaxCode, 0},
+        [&](int64_t lo, int64_t hi) {
+            Range r{kMaxCode, 0};
+            for (int64_t i = lo; i < hi; i++) {
+                r.first = std::min(r.first, codes[i]);
+                r.second = std::max(r.second, codes[i]);
+            }
+            return r;
+        },
+        [](Range a, Range b) { return Range{std::min(a.first, b.first), std::max(a.second, b.second)}; });
+
+    // 取值跨度不超过 32 位（如一天内的毫秒时间戳）时按 32 位键排序，键内存减半
+    if (range.second - range.first <= std::numeric_limits<uint32_t>::max()) {
+        ScratchBuffer<uint32_t> narrow(n);
+        parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+            for (int64_t i = lo; i < hi; i++) {
+                narrow[i] = static_cast<uint32_t>(codes[i] - range.first);
+            }
+        });
+        codes.reset();
+        sortPairs(narrow.data(), order, n);
+    } else {
+        sortPairs(codes.data(), order, n);
+    }
+}
+
+struct Candidate {
+    uint64_t code;
+    int32_t row;
+};
+
+inline bool candidateLess(const Candidate& a, const Candidate& b) {
+    return a.code < b.code || (a.code == b.code && a.row < b.row);
+}
+
+// 保留最小的 k 个候选
+void keepSmallest(std::vector<Candidate>& candidates, int64_t k) {
+    if (static_cast<int64_t>(candidates.size()) <= k) return;
+    std::nth_element(candidates.begin(), candidates.begin() + k, candidates.end(), candidateLess);
+    candidates.resize(static_cast<size_t>(k));
+}
+
+} // namespace
+
+void sortIndices(const SortKey* keys, int32_t keyCount, int64_t n, int32_t* out) {
+    parallel_for(0, n, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) out[i] = static_cast<int32_t>(i);
+    });
+    for (int32_t c = keyCount - 1; c >= 0; c--) {
+        sortByKey(keys[c], out, n);
+    }
+}
+
+void sortIndices(const double* x, int64_t n, bool descending, bool nullsFirst, int32_t* out) {
+    SortKey key{SortKeyType::FLOAT64, x, descending, nullsFirst};
+    sortIndices(&key, 1, n, out);
+}
+
+std::vector<int32_t> topK(const SortKey& key, int64_t n, int64_t k) {
+    if (k <= 0 || n <= 0) return {};
+    SortKey selectKey = key;
+    selectKey.nullsFirst = false;
+    std::vector<Candidate> candidates = parallel_reduce(0, n, std::vector<Candidate>(),
+        [&](int64_t lo, int64_t hi) {
+            // 候选数达到上限时收缩一次，块内内存不超过 O(k)
+            const size_t limit = static_cast<size_t>(std::max<int64_t>(2 * k, 1024));
+            std::vector<Candidate> local;
+            for (int64_t i = lo; i < hi; i++) {
+                const uint64_t code = encodeRow(selectKey, i);
+                if (code == kMaxCode) continue;
+                local.push_back({code, static_cast<int32_t>(i)});
+                if (local.size() >= limit) keepSmallest(local, k);
+            }
+            keepSmallest(local, k);
+            return local;
+        },
+        [k](std::vector<Candidate> a, std::vector<Candidate> b) {
+            a.insert(a.end(), b.begin(), b.end());
+            keepSmallest(a, k);
+            return a;
+        });
+    std::sort(candidates.begin(), candidates.end(), candidateLess);
+    std::vector<int32_t> rows(candidates.size());
+    for (size_t i = 0; i < candidates.size(); i++) rows[i] = candidates[i].row;
+    return rows;
+}
+
+} // namespace andas
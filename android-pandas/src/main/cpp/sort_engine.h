@@ -0,0 +1,61 @@
+#ifndef ANDAS_SORT_ENGINE_H
+#define ANDAS_SORT_ENGINE_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace andas {
+
+// 排序内核（不依赖JNI）
+// - 每个键先转换为保序的 uint64 编码：double 按 IEEE754 位翻转，int64 翻转符号位；
+//   降序取反，缺失值编码为 0（排在最前）或 UINT64_MAX（排在最后），之后只比较无符号整数
+// - 单键使用 LSD 基数排序（每趟 8 位，所有行该字节相同的趟直接跳过），天然稳定；
+//   数据量大时各块并行基数排序，再两两稳定归并
+// - 多键按字典序：从最后一个键到第一个键依次做稳定排序
+// - 所有排序都是稳定的，相等的行保持原顺序，结果与线程数无关
+
+// int64 键中表示缺失值的编码，与分组键一致
+constexpr int64_t kNullSortKey = std::numeric_limits<int64_t>::min();
+
+// 键类型编码，与 Kotlin 侧一致
+enum class SortKeyType : int32_t {
+    FLOAT64 = 0,   // NaN 为缺失值；-0.0 与 0.0 相等
+    INT64 = 1,     // kNullSortKey 为缺失值
+};
+
+struct SortKey {
+    SortKeyType type;
+    const void* values;      // double* 或 int64_t*，长度为行数
+    bool descending;
+    bool nullsFirst;         // 缺失值的位置与升降序无关
+};
+
+// double 键的保序编码：非缺失值落在 [1, UINT64_MAX - 1]，缺失值（NaN）为 0 或 UINT64_MAX
+// 外存排序把编码写进临时文件，归并时同样只比较无符号整数
+inline uint64_t encodeSortKey(double v, bool descending, bool nullsFirst) {
+    constexpr uint64_t kSignBit = uint64_t{1} << 63;
+    if (std::isnan(v)) return nullsFirst ? 0 : std::numeric_limits<uint64_t>::max();
+    if (v == 0.0) v = 0.0;  // -0.0 与 0.0 编码相同
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    const uint64_t code = (bits & kSignBit) ? ~bits : (bits | kSignBit);
+    return descending ? ~code : code;
+}
+
+// 多列稳定排序，out 写入 n 个行号
+void sortIndices(const SortKey* keys, int32_t keyCount, int64_t n, int32_t* out);
+
+// 单列 double 稳定排序
+void sortIndices(const double* x, int64_t n, bool descending, bool nullsFirst, int32_t* out);
+
+// 部分排序：返回按 key 稳定排序后的前 k 个非缺失行
+// key.descending 为 true 时即 nlargest，否则为 nsmallest；nullsFirst 不起作用
+// 各块用 introselect 选出块内前 k 个，合并候选后再选一次，只对最终的 k 行排序
+std::vector<int32_t> topK(const SortKey& key, int64_t n, int64_t k);
+
+} // namespace andas
+
+#endif //ANDAS_SORT_ENGINE_H
@@ -0,0 +1,537 @@
+#include "spill_engine.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unistd.h>
+#include "hash_utils.h"
+#include "sort_engine.h"
+
+namespace andas {
+
+namespace {
+
+// 排序段的写缓冲（同一时刻只写一个段）
+constexpr size_t kRunWriteBuffer = size_t(1) << 20;
+// 分区文件的写缓冲（同一时刻写一层的 kSpillPartitions 个分区）
+constexpr size_t kPartitionWriteBuffer = size_t(64) << 10;
+// 再分区的层数上限，用完哈希的全部位后不再分区
+constexpr int32_t kMaxSpillLevels = 64 / kSpillPartitionBits;
+
+std::string ioError(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+// 临时文件：创建后立即从目录中删除，只通过文件描述符访问，析构时关闭
+class SpillFile {
+public:
+    SpillFile(const std::string& directory, size_t bufferBytes) : buffer_(bufferBytes) {
+        std::string path = (directory.empty() ? std::string(".") : directory) + "/andas-spill-XXXXXX";
+        fd_ = ::mkstemp(&path[0]);
+        if (fd_ < 0) throw std::runtime_error(ioError(("无法创建临时文件 " + path).c_str()));
+        ::unlink(path.c_str());
+    }
+
+    ~SpillFile() { ::close(fd_); }
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    // 已写入的字节数，包括还在缓冲中的部分
+    int64_t size() const { return written_ + static_cast<int64_t>(used_); }
+
+    void write(const void* data, size_t bytes) {
+        const char* p = static_cast<const char*>(data);
+        while (bytes > 0) {
+            if (used_ == buffer_.size()) flush();
+            const size_t n = std::min(bytes, buffer_.size() - used_);
+            std::memcpy(buffer_.data() + used_, p, n);
+            used_ += n;
+            p += n;
+            bytes -= n;
+        }
+    }
+
+    template <typename T>
+    void write(const T& value) {
+        write(&value, sizeof(T));
+    }
+
+    void flush() {
+        size_t done = 0;
+        while (done < used_) {
+            const ssize_t n = ::pwrite(fd_, buffer_.data() + done, used_ - done, written_);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(ioError("写入临时文件失败"));
+            }
+            done += static_cast<size_t>(n);
+            written_ += n;
+        }
+        used_ = 0;
+    }
+
+    // 从 offset 处读取至多 bytes 字节，返回实际读到的字节数，0 表示已到文件末尾
+    size_t readAt(int64_t offset, void* out, size_t bytes) const {
+        for (;;) {
+            const ssize_t n = ::pread(fd_, out, bytes, offset);
+            if (n >= 0) return static_cast<size_t>(n);
+            if (errno != EINTR) throw std::runtime_error(ioError("读取临时文件失败"));
+        }
+    }
+
+private:
+    int fd_ = -1;
+    int64_t written_ = 0;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+};
+
+namespace {
+
+// 临时文件的顺序读取，每次从文件读一整块缓冲；多个读取器可以同时读不同的文件
+class SpillReader {
+public:
+    SpillReader(SpillFile& file, size_t bufferBytes) : file_(file), buffer_(bufferBytes) { file.flush(); }
+
+    // 读取 bytes 字节；文件已读完时返回 false，只剩不完整的记录时抛出异常
+    bool read(void* out, size_t bytes) {
+        char* p = static_cast<char*>(out);
+        size_t copied = 0;
+        while (copied < bytes) {
+            if (pos_ == end_) {
+                end_ = file_.readAt(offset_, buffer_.data(), buffer_.size());
+                offset_ += static_cast<int64_t>(end_);
+                pos_ = 0;
+                if (end_ == 0) {
+                    if (copied == 0) return false;
+                    throw std::runtime_error("临时文件不完整");
+                }
+            }
+            const size_t n = std::min(bytes - copied, end_ - pos_);
+            std::memcpy(p + copied, buffer_.data() + pos_, n);
+            pos_ += n;
+            copied += n;
+        }
+        return true;
+    }
+
+    template <typename T>
+    T readValue() {
+        T value;
+        if (!read(&value, sizeof(T))) throw std::runtime_error("临时文件不完整");
+        return value;
+    }
+
+private:
+    SpillFile& file_;
+    std::vector<char> buffer_;
+    int64_t offset_ = 0;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+};
+
+} // namespace
+
+// ==================== 外存排序 ====================
+
+// 段文件中的记录：[编码 uint64][长度 uint32][内容]，编码见 encodeSortKey
+// 多路归并：按 (编码, 段号) 取最小，编码相同时段号小（输入靠前）的先输出，保证稳定
+class ExternalSorter::Merger {
+public:
+    Merger(std::vector<std::unique_ptr<SpillFile>>& runs, size_t begin, size_t end, size_t bufferBytes) {
+        for (size_t r = begin; r < end; r++) {
+            cursors_.emplace_back(new Cursor(*runs[r], bufferBytes));
+            if (cursors_.back()->advance()) {
+                heap_.push_back(static_cast<int32_t>(cursors_.size() - 1));
+                std::push_heap(heap_.begin(), heap_.end(), After{this});
+            }
+        }
+    }
+
+    // 取出最小的记录，内容与 record 交换；全部取完时返回 false
+    bool pop(uint64_t* code, std::vector<uint8_t>* record) {
+        if (heap_.empty()) return false;
+        std::pop_heap(heap_.begin(), heap_.end(), After{this});
+        Cursor& cursor = *cursors_[static_cast<size_t>(heap_.back())];
+        *code = cursor.code;
+        record->swap(cursor.record);
+        if (cursor.advance()) {
+            std::push_heap(heap_.begin(), heap_.end(), After{this});
+        } else {
+            heap_.pop_back();
+        }
+        return true;
+    }
+
+private:
+    struct Cursor {
+        Cursor(SpillFile& file, size_t bufferBytes) : reader(file, bufferBytes) {}
+
+        bool advance() {
+            if (!reader.read(&code, sizeof(code))) return false;
+            const uint32_t length = reader.readValue<uint32_t>();
+            record.resize(length);
+            if (length > 0 && !reader.read(record.data(), length)) throw std::runtime_error("临时文件不完整");
+            return true;
+        }
+
+        SpillReader reader;
+        uint64_t code = 0;
+        std::vector<uint8_t> record;
+    };
+
+    // 堆顶是不排在任何其他段之后的段
+    struct After {
+        const Merger* merger;
+        bool operator()(int32_t a, int32_t b) const {
+            const uint64_t ca = merger->cursors_[static_cast<size_t>(a)]->code;
+            const uint64_t cb = merger->cursors_[static_cast<size_t>(b)]->code;
+            return ca != cb ? ca > cb : a > b;
+        }
+    };
+
+    std::vector<std::unique_ptr<Cursor>> cursors_;
+    std::vector<int32_t> heap_;
+};
+
+ExternalSorter::ExternalSorter(std::string directory, int64_t memoryBudget, bool descending)
+    : directory_(std::move(directory)), budget_(std::max<int64_t>(memoryBudget, 1)), descending_(descending),
+      offsets_(1, 0) {}
+
+ExternalSorter::~ExternalSorter() = default;
+
+int64_t ExternalSorter::bufferedBytes() const {
+    constexpr int64_t kPerRecord = sizeof(double) + sizeof(int64_t) + sizeof(int32_t);
+    return static_cast<int64_t>(payload_.size()) + static_cast<int64_t>(keys_.size()) * kPerRecord;
+}
+
+void ExternalSorter::add(const double* keys, const uint8_t* payload, const int32_t* offsets, int64_t n) {
+    if (finished_) throw std::logic_error("排序输入已结束");
+    for (int64_t i = 0; i < n; i++) {
+        keys_.push_back(keys[i]);
+        payload_.insert(payload_.end(), payload + offsets[i], payload + offsets[i + 1]);
+        offsets_.push_back(static_cast<int64_t>(payload_.size()));
+        // 段内行号为 int32
+        if (bufferedBytes() >= budget_ || keys_.size() >= static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+            spillBuffer();
+        }
+    }
+}
+
+void ExternalSorter::sortBuffer() {
+    order_.resize(keys_.size());
+    sortIndices(keys_.data(), static_cast<int64_t>(keys_.size()), descending_, false, order_.data());
+}
+
+void ExternalSorter::spillBuffer() {
+    if (keys_.empty()) return;
+    sortBuffer();
+    std::unique_ptr<SpillFile> run(new SpillFile(directory_, kRunWriteBuffer));
+    for (const int32_t r : order_) {
+        const uint64_t code = encodeSortKey(keys_[static_cast<size_t>(r)], descending_, false);
+        const int64_t begin = offsets_[static_cast<size_t>(r)];
+        const uint32_t length = static_cast<uint32_t>(offsets_[static_cast<size_t>(r) + 1] - begin);
+        run->write(code);
+        run->write(length);
+        run->write(payload_.data() + begin, length);
+    }
+    run->flush();
+    spilledBytes_ += run->size();
+    runs_.push_back(std::move(run));
+    // 保留容量，下一段直接复用
+    keys_.clear();
+    payload_.clear();
+    offsets_.assign(1, 0);
+    order_.clear();
+}
+
+std::unique_ptr<SpillFile> ExternalSorter::mergeRuns(size_t begin, size_t end) {
+    const size_t bufferBytes = static_cast<size_t>(std::max<int64_t>(kSpillReadBuffer, budget_ / static_cast<int64_t>(end - begin + 1)));
+    Merger merger(runs_, begin, end, bufferBytes);
+    std::unique_ptr<SpillFile> out(new SpillFile(directory_, kRunWriteBuffer));
+    uint64_t code;
+    while (merger.pop(&code, &record_)) {
+        const uint32_t length = static_cast<uint32_t>(record_.size());
+        out->write(code);
+        out->write(length);
+        out->write(record_.data(), length);
+    }
+    out->flush();
+    spilledBytes_ += out->size();
+    return out;
+}
+
+void ExternalSorter::finish() {
+    if (finished_) return;
+    finished_ = true;
+    if (runs_.empty()) {
+        sortBuffer();
+        return;
+    }
+    spillBuffer();
+    std::vector<double>().swap(keys_);
+    std::vector<uint8_t>().swap(payload_);
+    std::vector<int64_t>().swap(offsets_);
+    std::vector<int32_t>().swap(order_);
+
+    // 每段至少 kSpillReadBuffer 的读缓冲，段数超过预算能容纳的路数时逐层归并相邻的段（保持稳定）
+    const size_t fanIn = static_cast<size_t>(std::max<int64_t>(2, budget_ / kSpillReadBuffer));
+    while (runs_.size() > fanIn) {
+        std::vector<std::unique_ptr<SpillFile>> merged;
+        for (size_t begin = 0; begin < runs_.size(); begin += fanIn) {
+            const size_t end = std::min(begin + fanIn, runs_.size());
+            if (end - begin == 1) {
+                merged.push_back(std::move(runs_[begin]));
+            } else {
+                merged.push_back(mergeRuns(begin, end));
+                for (size_t r = begin; r < end; r++) runs_[r].reset();
+            }
+        }
+        runs_ = std::move(merged);
+    }
+    const size_t bufferBytes = static_cast<size_t>(std::max<int64_t>(kSpillReadBuffer, budget_ / static_cast<int64_t>(runs_.size())));
+    merger_.reset(new Merger(runs_, 0, runs_.size(), bufferBytes));
+}
+
+int64_t ExternalSorter::next(int64_t maxBytes, std::vector<uint8_t>& payload, std::vector<int32_t>& offsets) {
+    if (!finished_) throw std::logic_error("排序输入还未结束");
+    payload.clear();
+    offsets.assign(1, 0);
+    int64_t count = 0;
+    while (count == 0 || static_cast<int64_t>(payload.size()) < maxBytes) {
+        if (merger_) {
+            uint64_t code;
+            if (!merger_->pop(&code, &record_)) break;
+            payload.insert(payload.end(), record_.begin(), record_.end());
+        } else {
+            if (emitted_ >= static_cast<int64_t>(order_.size())) break;
+            const size_t r = static_cast<size_t>(order_[static_cast<size_t>(emitted_++)]);
+            payload.insert(payload.end(), payload_.begin() + offsets_[r], payload_.begin() + offsets_[r + 1]);
+        }
+        offsets.push_back(static_cast<int32_t>(payload.size()));
+        count++;
+    }
+    return count;
+}
+
+// ==================== 溢写分组 ====================
+
+void SpillGroups::clear() {
+    keys.clear();
+    offsets.assign(1, 0);
+    rows.clear();
+    counts.clear();
+    sums.clear();
+    mins.clear();
+    maxs.clear();
+}
+
+// 开放寻址（线性探测）哈希表，键复制到连续的字节区，分组按首次出现的顺序编号
+class SpillAggregator::Table {
+public:
+    struct Group {
+        uint64_t hash;
+        int64_t keyOffset;
+        int32_t keyLength;
+        int64_t rows;
+        int64_t count;
+        double sum;
+        double min;
+        double max;
+    };
+
+    Table() : slots_(16, -1) {}
+
+    Group& findOrInsert(uint64_t hash, const uint8_t* key, int32_t length, bool* inserted) {
+        size_t mask = slots_.size() - 1;
+        size_t pos = static_cast<size_t>(hash) & mask;
+        for (;;) {
+            const int32_t id = slots_[pos];
+            if (id < 0) break;
+            Group& group = groups_[static_cast<size_t>(id)];
+            if (group.hash == hash && group.keyLength == length &&
+                (length == 0 || std::memcmp(arena_.data() + group.keyOffset, key, static_cast<size_t>(length)) == 0)) {
+                *inserted = false;
+                return group;
+            }
+            pos = (pos + 1) & mask;
+        }
+        slots_[pos] = static_cast<int32_t>(groups_.size());
+        groups_.push_back(Group{hash, static_cast<int64_t>(arena_.size()), length, 0, 0, 0.0,
+                                std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()});
+        arena_.insert(arena_.end(), key, key + length);
+        // 负载因子保持在 1/2 以下
+        if (groups_.size() * 2 > slots_.size()) grow();
+        *inserted = true;
+        return groups_.back();
+    }
+
+    // 表占用的字节数，用于和预算比较
+    int64_t memoryBytes() const {
+        return static_cast<int64_t>(arena_.size() + groups_.size() * sizeof(Group) + slots_.size() * sizeof(int32_t));
+    }
+
+    const std::vector<Group>& groups() const { return groups_; }
+
+    const uint8_t* key(const Group& group) const { return arena_.data() + group.keyOffset; }
+
+    // 分组和键的容量保留复用，槽位缩回初始大小
+    void clear() {
+        groups_.clear();
+        arena_.clear();
+        slots_.assign(16, -1);
+    }
+
+private:
+    void grow() {
+        std::vector<int32_t> slots(slots_.size() * 2, -1);
+        const size_t mask = slots.size() - 1;
+        for (size_t id = 0; id < groups_.size(); id++) {
+            size_t pos = static_cast<size_t>(groups_[id].hash) & mask;
+            while (slots[pos] >= 0) pos = (pos + 1) & mask;
+            slots[pos] = static_cast<int32_t>(id);
+        }
+        slots_.swap(slots);
+    }
+
+    std::vector<int32_t> slots_;
+    std::vector<Group> groups_;
+    std::vector<uint8_t> arena_;
+};
+
+// 待处理的分区文件，level 为分区所在的层（决定再分区时使用哈希的哪几位）
+struct SpillAggregator::Pending {
+    std::unique_ptr<SpillFile> file;
+    int32_t level;
+};
+
+SpillAggregator::SpillAggregator(std::string directory, int64_t memoryBudget)
+    : directory_(std::move(directory)), budget_(std::max<int64_t>(memoryBudget, 1)), table_(new Table()) {}
+
+SpillAggregator::~SpillAggregator() = default;
+
+void SpillAggregator::add(const uint8_t* keys, const int32_t* offsets, const double* values, int64_t n) {
+    if (finished_) throw std::logic_error("分组输入已结束");
+    for (int64_t i = 0; i < n; i++) {
+        const uint8_t* key = keys + offsets[i];
+        const int32_t length = offsets[i + 1] - offsets[i];
+        const uint64_t hash = hashBytes(reinterpret_cast<const char*>(key), length);
+        bool inserted;
+        Table::Group& group = table_->findOrInsert(hash, key, length, &inserted);
+        group.rows++;
+        if (values != nullptr && !std::isnan(values[i])) {
+            group.count++;
+            group.sum += values[i];
+            group.min = std::min(group.min, values[i]);
+            group.max = std::max(group.max, values[i]);
+        }
+        // 只有新分组会增加内存
+        if (inserted && table_->memoryBytes() > budget_) spillTable(partitions_, 0);
+    }
+}
+
+// 分区文件中的记录：[哈希 uint64][键长 int32][键][行数 int64][非缺失值个数 int64][和][最小值][最大值]
+void SpillAggregator::spillTable(std::vector<std::unique_ptr<SpillFile>>& files, int32_t level) {
+    if (files.empty()) {
+        for (int32_t p = 0; p < kSpillPartitions; p++) files.emplace_back(new SpillFile(directory_, kPartitionWriteBuffer));
+    }
+    const int shift = 64 - kSpillPartitionBits * (level + 1);
+    for (const Table::Group& group : table_->groups()) {
+        SpillFile& file = *files[static_cast<size_t>((group.hash >> shift) & (kSpillPartitions - 1))];
+        file.write(group.hash);
+        file.write(group.keyLength);
+        file.write(table_->key(group), static_cast<size_t>(group.keyLength));
+        file.write(group.rows);
+        file.write(group.count);
+        file.write(group.sum);
+        file.write(group.min);
+        file.write(group.max);
+        spilledBytes_ += static_cast<int64_t>(sizeof(uint64_t) + sizeof(int32_t) + 2 * sizeof(int64_t) + 3 * sizeof(double)) +
+                         group.keyLength;
+    }
+    table_->clear();
+}
+
+void SpillAggregator::finish() {
+    if (finished_) return;
+    finished_ = true;
+    if (partitions_.empty()) return;
+    spillTable(partitions_, 0);
+    // pending_ 是栈，倒序放入使分区 0 先处理
+    for (size_t p = partitions_.size(); p-- > 0;) {
+        if (partitions_[p]->size() > 0) pending_.push_back(Pending{std::move(partitions_[p]), 0});
+    }
+    partitions_.clear();
+}
+
+bool SpillAggregator::next(SpillGroups& out) {
+    if (!finished_) throw std::logic_error("分组输入还未结束");
+    out.clear();
+    if (spilledBytes_ == 0) {
+        if (emitted_) return false;
+        emitted_ = true;
+    } else {
+        for (;;) {
+            if (pending_.empty()) return false;
+            Pending pending = std::move(pending_.back());
+            pending_.pop_back();
+
+            // 读回一个分区，合并各次溢写的部分结果；仍然超出预算时按哈希的下几位再分区
+            const bool canSplit = pending.level + 1 < kMaxSpillLevels;
+            std::vector<std::unique_ptr<SpillFile>> children;
+            std::vector<uint8_t> key;
+            {
+                SpillReader reader(*pending.file, static_cast<size_t>(kSpillReadBuffer));
+                uint64_t hash;
+                while (reader.read(&hash, sizeof(hash))) {
+                    const int32_t length = reader.readValue<int32_t>();
+                    key.resize(static_cast<size_t>(length));
+                    if (length > 0 && !reader.read(key.data(), static_cast<size_t>(length))) {
+                        throw std::runtime_error("临时文件不完整");
+                    }
+                    const int64_t rows = reader.readValue<int64_t>();
+                    const int64_t count = reader.readValue<int64_t>();
+                    const double sum = reader.readValue<double>();
+                    const double min = reader.readValue<double>();
+                    const double max = reader.readValue<double>();
+                    bool inserted;
+                    Table::Group& group = table_->findOrInsert(hash, key.data(), length, &inserted);
+                    group.rows += rows;
+                    group.count += count;
+                    group.sum += sum;
+                    group.min = std::min(group.min, min);
+                    group.max = std::max(group.max, max);
+                    if (inserted && canSplit && table_->memoryBytes() > budget_) spillTable(children, pending.level + 1);
+                }
+            }
+            pending.file.reset();
+            if (children.empty()) break;
+            spillTable(children, pending.level + 1);
+            for (size_t p = children.size(); p-- > 0;) {
+                if (children[p]->size() > 0) pending_.push_back(Pending{std::move(children[p]), pending.level + 1});
+            }
+        }
+    }
+
+    for (const Table::Group& group : table_->groups()) {
+        const uint8_t* key = table_->key(group);
+        out.keys.insert(out.keys.end(), key, key + group.keyLength);
+        out.offsets.push_back(static_cast<int32_t>(out.keys.size()));
+        out.rows.push_back(group.rows);
+        out.counts.push_back(group.count);
+        out.sums.push_back(group.sum);
+        out.mins.push_back(group.count > 0 ? group.min : std::numeric_limits<double>::quiet_NaN());
+        out.maxs.push_back(group.count > 0 ? group.max : std::numeric_limits<double>::quiet_NaN());
+    }
+    table_->clear();
+    return out.size() > 0;
+}
+
+} // namespace andas
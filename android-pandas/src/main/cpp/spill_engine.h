@@ -0,0 +1,132 @@
+#ifndef ANDAS_SPILL_ENGINE_H
+#define ANDAS_SPILL_ENGINE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace andas {
+
+// 外存排序与溢写分组（不依赖JNI），用于处理放不进内存的数据流
+// - 内存中的数据超过预算（memoryBudget 字节）时写到 directory 下的临时文件；文件创建后立即从目录中删除，
+//   对象析构（或进程退出）时由系统回收，不会留下残留文件；文件只顺序读写，每次读写一整块缓冲
+// - 排序：攒满预算的记录在内存中稳定排序后写成一个有序段（run），输入结束后多路归并；
+//   段数超过归并路数上限（预算 / kSpillReadBuffer）时先逐层归并成较少的段
+// - 分组：内存中的哈希表超过预算时，把各组的部分聚合结果按键哈希的高位写到 kSpillPartitions 个分区文件；
+//   输入结束后逐个分区读回合并，一个分区仍然放不下时用哈希的下几位再分区
+// I/O 失败抛出 std::runtime_error
+
+// 每层分区数
+constexpr int32_t kSpillPartitionBits = 4;
+constexpr int32_t kSpillPartitions = 1 << kSpillPartitionBits;
+// 归并时每个段的读缓冲字节数下限
+constexpr int64_t kSpillReadBuffer = int64_t(256) << 10;
+
+class SpillFile;
+
+// 外存排序：记录为排序键（double，NaN 为缺失值，无论升降序都排在最后）加任意字节内容，排序稳定
+class ExternalSorter {
+public:
+    ExternalSorter(std::string directory, int64_t memoryBudget, bool descending);
+    ~ExternalSorter();
+
+    ExternalSorter(const ExternalSorter&) = delete;
+    ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+    // 追加 n 条记录：第 i 条的排序键为 keys[i]，内容为 payload[offsets[i], offsets[i + 1])
+    void add(const double* keys, const uint8_t* payload, const int32_t* offsets, int64_t n);
+
+    // 结束输入，之后只能调用 next
+    void finish();
+
+    // 按排序后的顺序取出记录，直到内容累计达到 maxBytes（至少一条）；
+    // payload/offsets 的格式同 add，返回条数，0 表示已全部取出
+    int64_t next(int64_t maxBytes, std::vector<uint8_t>& payload, std::vector<int32_t>& offsets);
+
+    // 写到临时文件的字节数（包括中间归并），0 表示全部在内存中完成
+    int64_t spilledBytes() const { return spilledBytes_; }
+
+private:
+    class Merger;
+
+    int64_t bufferedBytes() const;
+    void sortBuffer();
+    void spillBuffer();
+    std::unique_ptr<SpillFile> mergeRuns(size_t begin, size_t end);
+
+    std::string directory_;
+    int64_t budget_;
+    bool descending_;
+    bool finished_ = false;
+
+    // 内存中还没有写出的记录
+    std::vector<double> keys_;
+    std::vector<uint8_t> payload_;
+    std::vector<int64_t> offsets_;
+    std::vector<int32_t> order_;
+    int64_t emitted_ = 0;
+
+    std::vector<std::unique_ptr<SpillFile>> runs_;
+    std::unique_ptr<Merger> merger_;
+    std::vector<uint8_t> record_;
+    int64_t spilledBytes_ = 0;
+};
+
+// 一批分组的聚合结果，分组 g 的键为 keys[offsets[g], offsets[g + 1])
+struct SpillGroups {
+    std::vector<uint8_t> keys;
+    std::vector<int32_t> offsets;
+    std::vector<int64_t> rows;     // 行数
+    std::vector<int64_t> counts;   // 非缺失值个数
+    std::vector<double> sums;
+    std::vector<double> mins;      // 没有非缺失值时为 NaN
+    std::vector<double> maxs;
+
+    int64_t size() const { return static_cast<int64_t>(rows.size()); }
+    void clear();
+};
+
+// 溢写分组聚合：键为任意字节串（按字节比较），每组计算行数、非缺失值个数、和、最小值和最大值
+// 内存中只保存各组的部分结果，与行数无关；分组数超出预算时才写临时文件
+class SpillAggregator {
+public:
+    SpillAggregator(std::string directory, int64_t memoryBudget);
+    ~SpillAggregator();
+
+    SpillAggregator(const SpillAggregator&) = delete;
+    SpillAggregator& operator=(const SpillAggregator&) = delete;
+
+    // 追加 n 行：第 i 行的分组键为 keys[offsets[i], offsets[i + 1])，值为 values[i]（NaN 为缺失值）；
+    // values 为 nullptr 时只计行数
+    void add(const uint8_t* keys, const int32_t* offsets, const double* values, int64_t n);
+
+    // 结束输入，之后只能调用 next
+    void finish();
+
+    // 取出下一批分组（一个分区）的结果，返回 false 表示已全部取出；每个分组只出现一次
+    // 没有溢写时只有一批，分组按首次出现的顺序
+    bool next(SpillGroups& out);
+
+    int64_t spilledBytes() const { return spilledBytes_; }
+
+private:
+    class Table;
+    struct Pending;
+
+    void spillTable(std::vector<std::unique_ptr<SpillFile>>& files, int32_t level);
+
+    std::string directory_;
+    int64_t budget_;
+    bool finished_ = false;
+    bool emitted_ = false;
+    std::unique_ptr<Table> table_;
+    // 输入阶段的第一层分区，没有溢写时为空
+    std::vector<std::unique_ptr<SpillFile>> partitions_;
+    std::vector<Pending> pending_;
+    int64_t spilledBytes_ = 0;
+};
+
+} // namespace andas
+
+#endif //ANDAS_SPILL_ENGINE_H
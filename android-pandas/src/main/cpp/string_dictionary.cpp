@@ -0,0 +1,76 @@
+#include "string_dictionary.h"
+
+#include <cstring>
+#include "hash_utils.h"
+
+namespace andas {
+
+namespace {
+
+constexpr size_t kInitialSlots = 64;
+
+} // namespace
+
+StringDictionary::StringDictionary() : offsets_(1, 0) {
+    rehash(kInitialSlots);
+}
+
+// 返回字符串所在的槽位；不存在时返回它应插入的空槽位，编码为 -(槽位 + 1)
+int64_t StringDictionary::probe(uint64_t hash, const char* data, int64_t length) const {
+    size_t slot = static_cast<size_t>(hash) & mask_;
+    while (true) {
+        const int32_t code = slots_[slot];
+        if (code < 0) return -static_cast<int64_t>(slot) - 1;
+        if (hashes_[static_cast<size_t>(code)] == hash && this->length(code) == length &&
+            std::memcmp(this->data(code), data, static_cast<size_t>(length)) == 0) {
+            return static_cast<int64_t>(slot);
+        }
+        slot = (slot + 1) & mask_;
+    }
+}
+
+int32_t StringDictionary::intern(const char* data, int64_t length) {
+    const uint64_t hash = hashBytes(data, length);
+    int64_t slot = probe(hash, data, length);
+    if (slot >= 0) return slots_[static_cast<size_t>(slot)];
+
+    const int32_t code = size();
+    heap_.append(data, static_cast<size_t>(length));
+    offsets_.push_back(static_cast<int64_t>(heap_.size()));
+    hashes_.push_back(hash);
+    // 装载因子不超过 1/2
+    if (hashes_.size() * 2 > slots_.size()) {
+        rehash(slots_.size() * 2);
+    } else {
+        slots_[static_cast<size_t>(-slot - 1)] = code;
+    }
+    return code;
+}
+
+int32_t StringDictionary::find(const char* data, int64_t length) const {
+    const int64_t slot = probe(hashBytes(data, length), data, length);
+    return slot >= 0 ? slots_[static_cast<size_t>(slot)] : -1;
+}
+
+void StringDictionary::rehash(size_t capacity) {
+    slots_.assign(capacity, -1);
+    mask_ = capacity - 1;
+    for (size_t code = 0; code < hashes_.size(); code++) {
+        size_t slot = static_cast<size_t>(hashes_[code]) & mask_;
+        while (slots_[slot] >= 0) slot = (slot + 1) & mask_;
+        slots_[slot] = static_cast<int32_t>(code);
+    }
+}
+
+void encodeStrings(const char* chars, const int64_t* offsets, const uint8_t* valid, int64_t n,
+                   StringDictionary& dictionary, int32_t* codes) {
+    for (int64_t i = 0; i < n; i++) {
+        if (valid != nullptr && valid[i] == 0) {
+            codes[i] = -1;
+            continue;
+        }
+        codes[i] = dictionary.intern(chars + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+}
+
+} // namespace andas
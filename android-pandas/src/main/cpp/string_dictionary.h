@@ -0,0 +1,54 @@
+#ifndef ANDAS_STRING_DICTIONARY_H
+#define ANDAS_STRING_DICTIONARY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace andas {
+
+// 字符串字典（不依赖JNI）：不同的 UTF-8 字符串按首次出现的顺序编号为 0, 1, 2...
+// - 所有字符串连续存放在一个字节堆中，第 i 个为 heap[offsets[i], offsets[i+1])，没有逐个的字符串对象
+// - 开放寻址哈希表的槽位只存编号，另存每个编号的哈希值；探测时先比较哈希，相等时再回到字节堆比较内容
+// - 只追加不删除，已分配的编号不会改变；读取方可以只取 [上次的 size(), size()) 的新条目
+// 非线程安全，多个线程各自使用自己的字典
+class StringDictionary {
+public:
+    StringDictionary();
+
+    // 返回字符串的编号，不存在时加入字典
+    int32_t intern(const char* data, int64_t length);
+
+    // 不存在时返回 -1
+    int32_t find(const char* data, int64_t length) const;
+
+    int32_t size() const { return static_cast<int32_t>(hashes_.size()); }
+
+    const char* data(int32_t code) const { return heap_.data() + offsets_[static_cast<size_t>(code)]; }
+    int64_t length(int32_t code) const {
+        return offsets_[static_cast<size_t>(code) + 1] - offsets_[static_cast<size_t>(code)];
+    }
+
+    const std::string& heap() const { return heap_; }
+    // size() + 1 项
+    const std::vector<int64_t>& offsets() const { return offsets_; }
+
+private:
+    int64_t probe(uint64_t hash, const char* data, int64_t length) const;
+    void rehash(size_t capacity);
+
+    std::string heap_;
+    std::vector<int64_t> offsets_;
+    std::vector<uint64_t> hashes_;
+    std::vector<int32_t> slots_;   // -1 为空槽
+    size_t mask_ = 0;
+};
+
+// 把 n 个字符串编码为字典编号：第 i 个为 chars[offsets[i], offsets[i+1])；
+// valid 为 nullptr 表示没有空值，否则 valid[i] 为 0 的行编码为 -1
+void encodeStrings(const char* chars, const int64_t* offsets, const uint8_t* valid, int64_t n,
+                   StringDictionary& dictionary, int32_t* codes);
+
+} // namespace andas
+
+#endif //ANDAS_STRING_DICTIONARY_H
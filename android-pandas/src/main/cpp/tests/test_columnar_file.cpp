@@ -0,0 +1,273 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "columnar_file.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+// 临时文件，析构时删除
+struct TempFile {
+    char path[32] = "/tmp/andas_col_XXXXXX";
+    int fd = -1;
+
+    TempFile() { fd = mkstemp(path); }
+    ~TempFile() {
+        if (fd >= 0) ::close(fd);
+        unlink(path);
+    }
+
+    std::string bytes() const {
+        std::string data;
+        int in = ::open(path, O_RDONLY);
+        char buffer[4096];
+        ssize_t n;
+        while ((n = ::read(in, buffer, sizeof(buffer))) > 0) data.append(buffer, static_cast<size_t>(n));
+        ::close(in);
+        return data;
+    }
+
+    void overwrite(const std::string& data) const {
+        int out = ::open(path, O_WRONLY | O_TRUNC);
+        CHECK(::write(out, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+        ::close(out);
+    }
+};
+
+bool aligned(const void* p) {
+    return reinterpret_cast<uintptr_t>(p) % 64 == 0;
+}
+
+std::string dictEntry(const ColumnarColumn& column, int32_t code) {
+    return std::string(column.dictChars + column.dictOffsets[code],
+                       static_cast<size_t>(column.dictOffsets[code + 1] - column.dictOffsets[code]));
+}
+
+void testRoundTrip() {
+    TempFile file;
+    const int64_t rows = 5;
+    const uint8_t flags[] = {1, 0, 1, 1, 0};
+    const int32_t ints[] = {7, -3, 0, 42, 9};
+    const uint8_t intValid[] = {1, 1, 0, 1, 1};
+    const int64_t longs[] = {INT64_MIN, 1, 2, 3, INT64_MAX};
+    const double doubles[] = {1.5, NAN, -2.25, 1e300, 0.0};
+    const uint8_t doubleValid[] = {1, 1, 1, 1, 0};
+    const int32_t codes[] = {1, -1, 0, 1, 2};
+    const char chars[] = "北京Shanghai";
+    const int64_t offsets[] = {0, 6, 14, 14};  // "北京"、"Shanghai"、""
+
+    {
+        ColumnarWriter writer(file.fd, false, rows, 2);
+        CHECK(writer.writeBool("flag", flags, nullptr));
+        CHECK(writer.writeInt32("int", ints, intValid));
+        CHECK(writer.writeInt64("long", longs, nullptr));
+        CHECK(writer.writeFloat64("double", doubles, doubleValid));
+        CHECK(writer.writeString("城市", codes, 3, offsets, chars));
+        CHECK(writer.finish());
+        CHECK(writer.error().empty());
+    }
+
+    std::string error;
+    std::unique_ptr<ColumnarFile> loaded = ColumnarFile::open(file.path, error);
+    CHECK(loaded != nullptr);
+    if (loaded == nullptr) return;
+    CHECK(loaded->rows() == rows);
+    const std::vector<ColumnarColumn>& columns = loaded->columns();
+    CHECK(columns.size() == 5);
+    for (const ColumnarColumn& column : columns) CHECK(aligned(column.values));
+
+    CHECK(columns[0].name == "flag" && columns[0].type == ColumnarType::BOOL);
+    CHECK(columns[0].validity == nullptr && columns[0].nullCount == 0);
+    CHECK(std::memcmp(columns[0].values, flags, sizeof(flags)) == 0);
+
+    const ColumnarColumn& intColumn = columns[1];
+    CHECK(intColumn.type == ColumnarType::INT32 && intColumn.nullCount == 1);
+    CHECK(aligned(intColumn.validity));
+    CHECK(columnarIsValid(intColumn.validity, 1) && !columnarIsValid(intColumn.validity, 2));
+    CHECK(static_cast<const int32_t*>(intColumn.values)[3] == 42);
+    // 每 2 行一块统计，空值不参与
+    CHECK(intColumn.statsCount == 3 && intColumn.statsChunkRows == 2);
+    const int64_t* intStats = static_cast<const int64_t*>(intColumn.stats);
+    CHECK(intStats[0] == -3 && intStats[1] == 7);
+    CHECK(intStats[2] == 42 && intStats[3] == 42);
+    CHECK(intStats[4] == 9 && intStats[5] == 9);
+
+    const ColumnarColumn& longColumn = columns[2];
+    CHECK(static_cast<const int64_t*>(longColumn.values)[0] == INT64_MIN);
+    CHECK(static_cast<const int64_t*>(longColumn.values)[4] == INT64_MAX);
+
+    // NaN 与显式空值都记为空值，值统一为 NaN
+    const ColumnarColumn& doubleColumn = columns[3];
+    const double* values = static_cast<const double*>(doubleColumn.values);
+    CHECK(doubleColumn.nullCount == 2);
+    CHECK(!columnarIsValid(doubleColumn.validity, 1) && !columnarIsValid(doubleColumn.validity, 4));
+    CHECK(std::isnan(values[1]) && std::isnan(values[4]));
+    CHECK(values[2] == -2.25 && values[3] == 1e300);
+    const double* doubleStats = static_cast<const double*>(doubleColumn.stats);
+    CHECK(doubleStats[0] == 1.5 && doubleStats[1] == 1.5);
+    CHECK(doubleStats[2] == -2.25 && doubleStats[3] == 1e300);
+    CHECK(doubleStats[4] > doubleStats[5]);  // 整块为空
+
+    const ColumnarColumn& stringColumn = columns[4];
+    CHECK(stringColumn.name == "城市" && stringColumn.type == ColumnarType::STRING);
+    CHECK(stringColumn.dictionarySize == 3 && stringColumn.nullCount == 1);
+    CHECK(stringColumn.stats == nullptr);
+    const int32_t* loadedCodes = static_cast<const int32_t*>(stringColumn.values);
+    CHECK(dictEntry(stringColumn, loadedCodes[0]) == "Shanghai");
+    CHECK(dictEntry(stringColumn, loadedCodes[2]) == "北京");
+    CHECK(dictEntry(stringColumn, loadedCodes[4]).empty());
+    CHECK(loadedCodes[1] == -1 && !columnarIsValid(stringColumn.validity, 1));
+}
+
+void testEmpty() {
+    TempFile noColumns;
+    {
+        ColumnarWriter writer(noColumns.fd, false, 0);
+        CHECK(writer.finish());
+    }
+    std::string error;
+    std::unique_ptr<ColumnarFile> loaded = ColumnarFile::open(noColumns.path, error);
+    CHECK(loaded != nullptr && loaded->rows() == 0 && loaded->columns().empty());
+
+    TempFile noRows;
+    {
+        const int64_t offsets[] = {0};
+        ColumnarWriter writer(noRows.fd, false, 0);
+        CHECK(writer.writeFloat64("x", nullptr, nullptr));
+        CHECK(writer.writeString("s", nullptr, 0, offsets, nullptr));
+        CHECK(writer.finish());
+    }
+    loaded = ColumnarFile::open(noRows.path, error);
+    CHECK(loaded != nullptr && loaded->columns().size() == 2);
+    if (loaded != nullptr) CHECK(loaded->columns()[0].stats == nullptr && loaded->columns()[1].dictionarySize == 0);
+}
+
+void testWriterErrors() {
+    TempFile file;
+    const int32_t values[] = {1, 2};
+    const int32_t badCodes[] = {0, 5};
+    const int64_t offsets[] = {0, 1};
+    ColumnarWriter writer(file.fd, false, 2);
+    CHECK(writer.writeInt32("a", values, nullptr));
+    CHECK(!writer.writeInt32("a", values, nullptr));
+    CHECK(writer.error().find("列名重复") != std::string::npos);
+
+    TempFile other;
+    ColumnarWriter codesWriter(other.fd, false, 2);
+    CHECK(!codesWriter.writeString("s", badCodes, 1, offsets, "x"));
+    CHECK(!codesWriter.finish());
+
+    // 未完成的写入只有占位文件头，不能被读取
+    std::string error;
+    CHECK(ColumnarFile::open(other.path, error) == nullptr);
+    CHECK(!error.empty());
+    CHECK(ColumnarFile::open("/tmp/andas_col_missing", error) == nullptr);
+}
+
+void testCorruption() {
+    TempFile file;
+    const int64_t rows = 1000;
+    std::vector<double> doubles(rows);
+    std::vector<int32_t> codes(rows);
+    for (int64_t i = 0; i < rows; i++) {
+        doubles[static_cast<size_t>(i)] = static_cast<double>(i) * 0.5;
+        codes[static_cast<size_t>(i)] = static_cast<int32_t>(i % 3) - 1;
+    }
+    const int64_t offsets[] = {0, 1, 3};
+    {
+        ColumnarWriter writer(file.fd, false, rows, 100);
+        CHECK(writer.writeFloat64("d", doubles.data(), nullptr));
+        CHECK(writer.writeString("s", codes.data(), 2, offsets, "abc"));
+        CHECK(writer.finish());
+    }
+    const std::string original = file.bytes();
+    std::string error;
+
+    // 截断：schema 区不完整
+    file.overwrite(original.substr(0, original.size() - 8));
+    CHECK(ColumnarFile::open(file.path, error) == nullptr);
+
+    // 随机改写文件头和 schema 区的字节：要么拒绝，要么所有区段仍在文件内
+    std::mt19937_64 rng(7);
+    ColumnarFileHeader header;
+    std::memcpy(&header, original.data(), sizeof(header));
+    for (int round = 0; round < 2000; round++) {
+        std::string damaged = original;
+        const bool inHeader = round % 2 == 0;
+        const size_t span = inHeader ? sizeof(header) : static_cast<size_t>(header.schemaBytes);
+        const size_t start = inHeader ? 0 : static_cast<size_t>(header.schemaOffset);
+        damaged[start + rng() % span] = static_cast<char>(rng());
+        file.overwrite(damaged);
+        std::unique_ptr<ColumnarFile> loaded = ColumnarFile::open(file.path, error);
+        if (loaded == nullptr) continue;
+        for (const ColumnarColumn& column : loaded->columns()) {
+            volatile uint8_t sink = 0;
+            const uint8_t* values = static_cast<const uint8_t*>(column.values);
+            for (uint64_t i = 0; i < column.valuesBytes; i++) sink ^= values[i];
+            for (int64_t k = 0; k < column.dictionarySize; k++) sink ^= static_cast<uint8_t>(dictEntry(column, static_cast<int32_t>(k)).size());
+            (void)sink;
+        }
+    }
+}
+
+void testLargeStats() {
+    TempFile file;
+    const int64_t rows = 300000;
+    std::mt19937_64 rng(11);
+    std::vector<int64_t> values(static_cast<size_t>(rows));
+    std::vector<uint8_t> valid(static_cast<size_t>(rows));
+    for (int64_t i = 0; i < rows; i++) {
+        values[static_cast<size_t>(i)] = static_cast<int64_t>(rng() % 2000001) - 1000000;
+        valid[static_cast<size_t>(i)] = rng() % 10 != 0;
+    }
+    {
+        ColumnarWriter writer(file.fd, false, rows);
+        CHECK(writer.writeInt64("v", values.data(), valid.data()));
+        CHECK(writer.finish());
+    }
+    std::string error;
+    std::unique_ptr<ColumnarFile> loaded = ColumnarFile::open(file.path, error);
+    CHECK(loaded != nullptr);
+    if (loaded == nullptr) return;
+    const ColumnarColumn& column = loaded->columns()[0];
+    CHECK(column.statsChunkRows == kDefaultStatsChunkRows);
+    CHECK(column.statsCount == (rows + kDefaultStatsChunkRows - 1) / kDefaultStatsChunkRows);
+    const int64_t* stats = static_cast<const int64_t*>(column.stats);
+    const int64_t* mapped = static_cast<const int64_t*>(column.values);
+    int64_t nulls = 0;
+    for (int64_t c = 0; c < column.statsCount; c++) {
+        int64_t lo = INT64_MAX;
+        int64_t hi = INT64_MIN;
+        for (int64_t i = c * column.statsChunkRows; i < std::min(rows, (c + 1) * column.statsChunkRows); i++) {
+            CHECK(columnarIsValid(column.validity, i) == (valid[static_cast<size_t>(i)] != 0));
+            if (!valid[static_cast<size_t>(i)]) {
+                nulls++;
+                continue;
+            }
+            CHECK(mapped[i] == values[static_cast<size_t>(i)]);
+            lo = std::min(lo, mapped[i]);
+            hi = std::max(hi, mapped[i]);
+        }
+        CHECK(stats[c * 2] == lo && stats[c * 2 + 1] == hi);
+    }
+    CHECK(nulls == column.nullCount);
+}
+
+} // namespace
+
+int main() {
+    RUN_TEST(testRoundTrip);
+    RUN_TEST(testEmpty);
+    RUN_TEST(testWriterErrors);
+    RUN_TEST(testCorruption);
+    RUN_TEST(testLargeStats);
+    return TEST_RESULT();
+}
@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+#include "corr_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// 两列都不缺失的行
+void complete(const std::vector<double>& x, const std::vector<double>& y,
+              std::vector<double>* xs, std::vector<double>* ys) {
+    xs->clear();
+    ys->clear();
+    for (size_t i = 0; i < x.size(); i++) {
+        if (std::isnan(x[i]) || std::isnan(y[i])) continue;
+        xs->push_back(x[i]);
+        ys->push_back(y[i]);
+    }
+}
+
+double referenceCov(const std::vector<double>& x, const std::vector<double>& y, int64_t ddof) {
+    const double m = static_cast<double>(x.size());
+    if (m <= static_cast<double>(ddof)) return kNaN;
+    long double mx = 0.0L, my = 0.0L;
+    for (size_t i = 0; i < x.size(); i++) {
+        mx += x[i];
+        my += y[i];
+    }
+    mx /= m;
+    my /= m;
+    long double s = 0.0L;
+    for (size_t i = 0; i < x.size(); i++) s += (x[i] - mx) * (y[i] - my);
+    return static_cast<double>(s / (m - static_cast<double>(ddof)));
+}
+
+double referencePearson(const std::vector<double>& x, const std::vector<double>& y) {
+    if (x.empty()) return kNaN;
+    const double vx = referenceCov(x, x, 0);
+    const double vy = referenceCov(y, y, 0);
+    if (vx <= 0.0 || vy <= 0.0) return kNaN;
+    return referenceCov(x, y, 0) / std::sqrt(vx * vy);
+}
+
+std::vector<double> referenceRanks(const std::vector<double>& x) {
+    std::vector<double> ranks(x.size());
+    for (size_t i = 0; i < x.size(); i++) {
+        double less = 0.0, equal = 0.0;
+        for (double v : x) {
+            if (v < x[i]) less++;
+            if (v == x[i]) equal++;
+        }
+        ranks[i] = less + (equal + 1.0) / 2.0;
+    }
+    return ranks;
+}
+
+double referenceKendall(const std::vector<double>& x, const std::vector<double>& y) {
+    double concordant = 0.0, discordant = 0.0, tiedX = 0.0, tiedY = 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+        for (size_t j = i + 1; j < x.size(); j++) {
+            const double dx = x[i] - x[j];
+            const double dy = y[i] - y[j];
+            if (dx == 0.0 && dy == 0.0) continue;
+            if (dx == 0.0) {
+                tiedX++;
+            } else if (dy == 0.0) {
+                tiedY++;
+            } else if ((dx > 0) == (dy > 0)) {
+                concordant++;
+            } else {
+                discordant++;
+            }
+        }
+    }
+    const double denominator = std::sqrt((concordant + discordant + tiedX) * (concordant + discordant + tiedY));
+    return denominator == 0.0 ? kNaN : (concordant - discordant) / denominator;
+}
+
+bool close(double actual, double expected, double tolerance = 1e-9) {
+    if (std::isnan(expected)) return std::isnan(actual);
+    return std::fabs(actual - expected) <= tolerance;
+}
+
+struct Table {
+    std::vector<std::vector<double>> columns;
+    std::vector<const double*> pointers() const {
+        std::vector<const double*> out;
+        for (const auto& c : columns) out.push_back(c.data());
+        return out;
+    }
+};
+
+// 相关、反相关、带重复值、常数列与全缺失列，nullRate 为缺失值比例
+Table makeTable(int32_t k, int64_t n, double nullRate, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    Table t;
+    std::vector<double> base(static_cast<size_t>(n));
+    for (auto& v : base) v = normal(rng);
+    for (int32_t c = 0; c < k; c++) {
+        std::vector<double> col(static_cast<size_t>(n));
+        for (int64_t i = 0; i < n; i++) {
+            const double noise = normal(rng);
+            switch (c % 5) {
+                case 0: col[i] = 1e6 + base[i] + 0.5 * noise; break;   // 大偏移量考验数值稳定性
+                case 1: col[i] = -2.0 * base[i] + noise; break;
+                case 2: col[i] = std::round(noise * 2.0); break;        // 大量重复值
+                case 3: col[i] = c == 3 ? 7.0 : noise; break;           // 常数列
+                default: col[i] = noise * noise; break;
+            }
+            if (unit(rng) < nullRate) col[i] = kNaN;
+        }
+        t.columns.push_back(std::move(col));
+    }
+    return t;
+}
+
+void checkAgainstReference(const Table& t, int64_t minPeriods) {
+    const int32_t k = static_cast<int32_t>(t.columns.size());
+    const int64_t n = static_cast<int64_t>(t.columns[0].size());
+    const auto ptrs = t.pointers();
+    std::vector<double> pearson(static_cast<size_t>(k) * k);
+    std::vector<double> spearman(pearson.size());
+    std::vector<double> kendall(pearson.size());
+    std::vector<double> cov(pearson.size());
+    correlationMatrix(ptrs.data(), k, n, CorrMethod::PEARSON, minPeriods, pearson.data());
+    correlationMatrix(ptrs.data(), k, n, CorrMethod::SPEARMAN, minPeriods, spearman.data());
+    correlationMatrix(ptrs.data(), k, n, CorrMethod::KENDALL, minPeriods, kendall.data());
+    covarianceMatrix(ptrs.data(), k, n, minPeriods, 1, cov.data());
+
+    std::vector<double> xs, ys;
+    for (int32_t a = 0; a < k; a++) {
+        for (int32_t b = 0; b < k; b++) {
+            const size_t at = static_cast<size_t>(a) * k + b;
+            complete(t.columns[a], t.columns[b], &xs, &ys);
+            const bool enough = static_cast<int64_t>(xs.size()) >= std::max<int64_t>(1, minPeriods);
+            double p = enough ? referencePearson(xs, ys) : kNaN;
+            double s = enough ? referencePearson(referenceRanks(xs), referenceRanks(ys)) : kNaN;
+            double kt = enough ? (a == b ? 1.0 : referenceKendall(xs, ys)) : kNaN;
+            if (a == b && !std::isnan(p)) p = 1.0;
+            if (a == b && !std::isnan(s)) s = 1.0;
+            const double c = enough ? referenceCov(xs, ys, 1) : kNaN;
+            CHECK(close(pearson[at], p));
+            CHECK(close(spearman[at], s));
+            CHECK(close(kendall[at], kt));
+            CHECK(close(cov[at], c, 1e-9 * std::max(1.0, std::fabs(c))));
+            // 对称
+            const size_t ba = static_cast<size_t>(b) * k + a;
+            CHECK(std::memcmp(&pearson[at], &pearson[ba], sizeof(double)) == 0);
+            CHECK(std::memcmp(&cov[at], &cov[ba], sizeof(double)) == 0);
+        }
+    }
+}
+
+void testDense() {
+    // 列数不是 4 的倍数，覆盖不满的列块
+    checkAgainstReference(makeTable(7, 500, 0.0, 1), 1);
+    checkAgainstReference(makeTable(1, 10, 0.0, 2), 1);
+}
+
+void testNulls() {
+    checkAgainstReference(makeTable(9, 400, 0.2, 3), 1);
+    checkAgainstReference(makeTable(6, 300, 0.5, 4), 100);
+
+    // 全缺失列与只有一个共同有效行的列对
+    Table t;
+    t.columns.push_back({1.0, 2.0, kNaN, 4.0});
+    t.columns.push_back({kNaN, kNaN, kNaN, kNaN});
+    t.columns.push_back({kNaN, 5.0, 6.0, kNaN});
+    checkAgainstReference(t, 1);
+    std::vector<double> out(9);
+    const auto ptrs = t.pointers();
+    correlationMatrix(ptrs.data(), 3, 4, CorrMethod::PEARSON, 1, out.data());
+    CHECK(out[0] == 1.0);
+    CHECK(std::isnan(out[4]));
+    CHECK(std::isnan(out[2]));
+    covarianceMatrix(ptrs.data(), 3, 4, 1, 0, out.data());
+    CHECK_NEAR(out[2], 0.0, 0.0);
+    CHECK_NEAR(out[0], 14.0 / 9.0, 1e-12);
+}
+
+void testKnownValues() {
+    Table t;
+    t.columns.push_back({1.0, 2.0, 3.0, 4.0, 5.0});
+    t.columns.push_back({5.0, 6.0, 7.0, 8.0, 7.0});
+    t.columns.push_back({1.0, 4.0, 9.0, 16.0, 25.0});
+    const auto ptrs = t.pointers();
+    std::vector<double> out(9);
+    correlationMatrix(ptrs.data(), 3, 5, CorrMethod::PEARSON, 1, out.data());
+    CHECK_NEAR(out[1], 0.8320502943378437, 1e-12);
+    correlationMatrix(ptrs.data(), 3, 5, CorrMethod::SPEARMAN, 1, out.data());
+    CHECK_NEAR(out[1], 0.8207826816681233, 1e-12);
+    CHECK_NEAR(out[2], 1.0, 1e-12);
+    correlationMatrix(ptrs.data(), 3, 5, CorrMethod::KENDALL, 1, out.data());
+    CHECK_NEAR(out[1], 0.7378647873726218, 1e-12);
+    CHECK_NEAR(out[2], 1.0, 1e-12);
+    CHECK(isValidCorrMethod(2));
+    CHECK(!isValidCorrMethod(3));
+    CHECK(!isValidCorrMethod(-1));
+}
+
+void testParallelDeterministic() {
+    // 多个行段与列块，不同线程数下结果逐位相同
+    const Table t = makeTable(10, 300000, 0.05, 5);
+    const auto ptrs = t.pointers();
+    const int32_t k = 10;
+    const int64_t n = 300000;
+    std::vector<std::vector<double>> results;
+    for (int threads : {1, 3, 8}) {
+        ThreadPool::instance().setThreadCount(threads);
+        for (CorrMethod method : {CorrMethod::PEARSON, CorrMethod::SPEARMAN}) {
+            std::vector<double> out(static_cast<size_t>(k) * k);
+            correlationMatrix(ptrs.data(), k, n, method, 1, out.data());
+            results.push_back(out);
+        }
+        std::vector<double> cov(static_cast<size_t>(k) * k);
+        covarianceMatrix(ptrs.data(), k, n, 1, 1, cov.data());
+        results.push_back(cov);
+    }
+    ThreadPool::instance().setThreadCount(4);
+    for (size_t r = 3; r < results.size(); r++) {
+        CHECK(std::memcmp(results[r].data(), results[r % 3].data(), results[r].size() * sizeof(double)) == 0);
+    }
+
+    // 与参考实现比较几个列对
+    std::vector<double> xs, ys;
+    for (int32_t b : {1, 2, 9}) {
+        complete(t.columns[0], t.columns[b], &xs, &ys);
+        CHECK(close(results[0][b], referencePearson(xs, ys)));
+        CHECK(close(results[2][b], referenceCov(xs, ys, 1), 1e-9));
+    }
+
+    // Kendall 较大的输入与 O(n²) 参考实现比较
+    const Table small = makeTable(4, 3000, 0.1, 6);
+    const auto sp = small.pointers();
+    std::vector<double> out(16);
+    correlationMatrix(sp.data(), 4, 3000, CorrMethod::KENDALL, 1, out.data());
+    for (int32_t b = 1; b < 4; b++) {
+        complete(small.columns[0], small.columns[b], &xs, &ys);
+        CHECK(close(out[b], referenceKendall(xs, ys)));
+    }
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testDense);
+    RUN_TEST(testNulls);
+    RUN_TEST(testKnownValues);
+    RUN_TEST(testParallelDeterministic);
+    return TEST_RESULT();
+}
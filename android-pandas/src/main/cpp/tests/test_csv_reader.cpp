@@ -0,0 +1,455 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "csv_reader.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+// 读完整个输入，每个单元格转为字符串，空值为 "<null>"
+struct Table {
+    std::vector<std::string> names;
+    std::vector<CsvType> types;
+    std::vector<std::vector<std::string>> cells;  // [列][行]
+    int64_t batches = 0;
+};
+
+std::string cellText(const CsvColumn& column, int64_t row) {
+    const size_t r = static_cast<size_t>(row);
+    if (!column.valid[r]) return "<null>";
+    char buf[64];
+    switch (column.type) {
+        case CsvType::BOOL: return column.ints[r] ? "true" : "false";
+        case CsvType::INT32:
+        case CsvType::INT64: return std::to_string(column.ints[r]);
+        case CsvType::FLOAT64:
+            std::snprintf(buf, sizeof(buf), "%.17g", column.doubles[r]);
+            return buf;
+        case CsvType::STRING:
+            if (column.dictionary != nullptr) {
+                const int32_t code = column.codes[r];
+                return std::string(column.dictionary->data(code), static_cast<size_t>(column.dictionary->length(code)));
+            }
+            return column.chars.substr(static_cast<size_t>(column.offsets[r]),
+                                       static_cast<size_t>(column.offsets[r + 1] - column.offsets[r]));
+        case CsvType::EMPTY: break;
+    }
+    return "<empty>";
+}
+
+Table readAll(std::unique_ptr<CsvSource> source, CsvOptions options, int64_t maxRows = INT64_MAX) {
+    CsvReader reader(std::move(source), options);
+    Table table;
+    table.names = reader.columnNames();
+    table.cells.resize(table.names.size());
+    CsvBatch batch;
+    while (reader.next(batch, maxRows)) {
+        table.batches++;
+        for (size_t c = 0; c < batch.columns.size(); c++) {
+            for (int64_t r = 0; r < batch.rows; r++) table.cells[c].push_back(cellText(batch.columns[c], r));
+        }
+    }
+    CHECK(reader.error().empty());
+    table.types = reader.schema();
+    return table;
+}
+
+Table readAll(const std::string& data, CsvOptions options, int64_t maxRows = INT64_MAX) {
+    return readAll(std::unique_ptr<CsvSource>(new MemoryCsvSource(data.data(), static_cast<int64_t>(data.size()))),
+                   options, maxRows);
+}
+
+void testNumberParsing() {
+    int64_t v = 0;
+    CHECK(parseCsvInt64("-9223372036854775808", 20, v) && v == INT64_MIN);
+    CHECK(parseCsvInt64("9223372036854775807", 19, v) && v == INT64_MAX);
+    CHECK(!parseCsvInt64("9223372036854775808", 19, v));
+    CHECK(!parseCsvInt64("-", 1, v));
+    CHECK(!parseCsvInt64("+1", 2, v));
+
+    double d = 0;
+    CHECK(parseCsvDouble("1.5", 3, d) && d == 1.5);
+    CHECK(parseCsvDouble("-0.0", 4, d) && d == 0.0 && std::signbit(d));
+    CHECK(parseCsvDouble("1e3", 3, d) && d == 1000.0);
+    CHECK(!parseCsvDouble(".5", 2, d));
+    CHECK(!parseCsvDouble("5.", 2, d));
+    CHECK(!parseCsvDouble("1e", 2, d));
+    CHECK(!parseCsvDouble("NaN", 3, d));
+
+    CHECK(classifyCsvValue("12", 2) == CsvType::INT32);
+    CHECK(classifyCsvValue("3000000000", 10) == CsvType::INT64);
+    CHECK(classifyCsvValue("99999999999999999999", 20) == CsvType::FLOAT64);
+    CHECK(classifyCsvValue("2.50", 4) == CsvType::FLOAT64);
+    CHECK(classifyCsvValue("Yes", 3) == CsvType::BOOL);
+    CHECK(classifyCsvValue("1", 1) == CsvType::INT32);  // 与原解析器一样，整数优先于布尔
+    CHECK(classifyCsvValue("2024-01-02", 10) == CsvType::STRING);
+
+    CHECK(joinCsvTypes(CsvType::EMPTY, CsvType::BOOL) == CsvType::BOOL);
+    CHECK(joinCsvTypes(CsvType::INT32, CsvType::FLOAT64) == CsvType::FLOAT64);
+    CHECK(joinCsvTypes(CsvType::BOOL, CsvType::INT32) == CsvType::STRING);
+
+    // 快速路径与慢速路径都必须和 strtod 完全一致
+    std::mt19937_64 rng(5);
+    bool same = true;
+    for (int i = 0; i < 200000; i++) {
+        char buf[64];
+        const int digits = 1 + static_cast<int>(rng() % 20);
+        int len = 0;
+        if (rng() & 1) buf[len++] = '-';
+        for (int k = 0; k < digits; k++) buf[len++] = static_cast<char>('0' + rng() % 10);
+        if (rng() % 3 != 0) {
+            buf[len++] = '.';
+            const int frac = 1 + static_cast<int>(rng() % 12);
+            for (int k = 0; k < frac; k++) buf[len++] = static_cast<char>('0' + rng() % 10);
+        }
+        if (rng() % 4 == 0) {
+            len += std::snprintf(buf + len, sizeof(buf) - static_cast<size_t>(len), "e%d",
+                                 static_cast<int>(rng() % 80) - 40);
+        }
+        buf[len] = '\0';
+        double parsed = 0;
+        same = same && parseCsvDouble(buf, len, parsed) && parsed == std::strtod(buf, nullptr);
+    }
+    CHECK(same);
+}
+
+void testSyntax() {
+    const std::string data =
+        "\xEF\xBB\xBF# 注释行\n"
+        "id, name ,score,flag,note\r\n"
+        "1,\"Smith, J\",1.5,true,\"他说\"\"你好\"\"\"\r\n"
+        "\n"
+        "2,  Li  ,NA,no,\"第一行\n第二行\"\n"
+        "3,Wang,2,YES\n"
+        "4,\"O'Brien\",-3e2,false,x,extra\n"
+        "5,,null,,";
+    CsvOptions options;
+    options.skipLines = 1;
+    Table t = readAll(data, options);
+
+    CHECK(t.names == std::vector<std::string>({"id", "name", "score", "flag", "note"}));
+    CHECK(t.types == std::vector<CsvType>({CsvType::INT32, CsvType::STRING, CsvType::FLOAT64,
+                                           CsvType::BOOL, CsvType::STRING}));
+    CHECK(t.cells[0] == std::vector<std::string>({"1", "2", "3", "4", "5"}));
+    CHECK(t.cells[1] == std::vector<std::string>({"Smith, J", "Li", "Wang", "O'Brien", "<null>"}));
+    CHECK(t.cells[2] == std::vector<std::string>({"1.5", "<null>", "2", "-300", "<null>"}));
+    CHECK(t.cells[3] == std::vector<std::string>({"true", "false", "true", "false", "<null>"}));
+    CHECK(t.cells[4] == std::vector<std::string>({"他说\"你好\"", "第一行\n第二行", "<null>", "x", "<null>"}));
+
+    // 不推断类型、不 trim、没有表头
+    CsvOptions raw;
+    raw.header = false;
+    raw.trim = false;
+    raw.inferTypes = false;
+    raw.nullValues = {"NA"};
+    Table r = readAll("a, 1 ,NA\nb,2\n", raw);
+    CHECK(r.names == std::vector<std::string>({"col0", "col1", "col2"}));
+    CHECK(r.types == std::vector<CsvType>(3, CsvType::STRING));
+    CHECK(r.cells[1] == std::vector<std::string>({" 1 ", "2"}));
+    CHECK(r.cells[2] == std::vector<std::string>({"<null>", ""}));
+
+    CHECK(readAll("", CsvOptions()).names.empty());
+    Table headerOnly = readAll("a,b\n", CsvOptions());
+    CHECK(headerOnly.names.size() == 2 && headerOnly.batches == 0);
+}
+
+void testTypePromotion() {
+    // 类型在后面的批次中逐步变宽：EMPTY -> INT32 -> INT64 -> FLOAT64 -> STRING
+    std::string data = "v,w\n";
+    for (int i = 0; i < 50; i++) data += "\n";
+    data += ",1\n";
+    for (int i = 0; i < 50; i++) data += std::to_string(i) + ",2\n";
+    data += "5000000000,3\n";
+    data += "2.5,4\n";
+    data += "abc,true\n";
+    CsvOptions options;
+    options.sampleRows = 10;
+    options.chunkBytes = 64;
+
+    CsvReader reader(std::unique_ptr<CsvSource>(new MemoryCsvSource(data.data(), static_cast<int64_t>(data.size()))),
+                     options);
+    CHECK(reader.columnNames().size() == 2);
+    CsvBatch batch;
+    std::vector<CsvType> seen;
+    std::vector<std::string> lastValues;
+    while (reader.next(batch, 20)) {
+        seen.push_back(batch.columns[0].type);
+        for (int64_t r = 0; r < batch.rows; r++) lastValues.push_back(cellText(batch.columns[0], r));
+    }
+    CHECK(seen.size() >= 4);
+    for (size_t i = 1; i < seen.size(); i++) CHECK(seen[i] >= seen[i - 1]);
+    CHECK(seen.front() == CsvType::EMPTY || seen.front() == CsvType::INT32);
+    CHECK(seen.back() == CsvType::STRING);
+    CHECK(reader.schema()[0] == CsvType::STRING);
+    CHECK(reader.schema()[1] == CsvType::STRING);
+    CHECK(lastValues.size() == 54);
+    CHECK(lastValues.back() == "abc");
+
+    // 同一批内的提升：第一遍失败后按整批推断再解析
+    CsvOptions single;
+    single.sampleRows = 1;
+    Table t = readAll("x\n1\n2\n3000000000\n4.25\n", single);
+    CHECK(t.types[0] == CsvType::FLOAT64);
+    CHECK(t.cells[0] == std::vector<std::string>({"1", "2", "3000000000", "4.25"}));
+}
+
+// 随机数据：整数列、浮点列、含引号/分隔符/换行的字符串列
+std::string makeCsv(int64_t rows, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::string data = "id,value,text\n";
+    for (int64_t i = 0; i < rows; i++) {
+        data += std::to_string(static_cast<int64_t>(rng() % 2000000) - 1000000);
+        data += ',';
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.6f", static_cast<double>(rng() % 1000000) / 7.0);
+        data += (rng() % 50 == 0) ? "" : buf;
+        data += ',';
+        switch (rng() % 5) {
+            case 0: data += "\"a,b\""; break;
+            case 1: data += "\"line1\nline2\""; break;
+            case 2: data += "\"say \"\"hi\"\"\""; break;
+            case 3: data += "plain" + std::to_string(i); break;
+            default: data += "NA"; break;
+        }
+        data += (rng() % 3 == 0) ? "\r\n" : "\n";
+    }
+    return data;
+}
+
+void testChunkBoundaries() {
+    // 不同块大小和批行数下结果一致，覆盖行跨块、引号内换行跨块的情况
+    const std::string data = makeCsv(3000, 17);
+    CsvOptions big;
+    big.chunkBytes = 1 << 20;
+    Table reference = readAll(data, big);
+    CHECK(reference.cells[0].size() == 3000);
+    CHECK(reference.types == std::vector<CsvType>({CsvType::INT32, CsvType::FLOAT64, CsvType::STRING}));
+
+    const int64_t chunkSizes[] = {64, 100, 1000, 4099};
+    const int64_t maxRows[] = {1, 7, INT64_MAX};
+    for (int64_t chunk : chunkSizes) {
+        for (int64_t rows : maxRows) {
+            CsvOptions options;
+            options.chunkBytes = chunk;
+            options.sampleRows = 3;
+            Table t = readAll(data, options, rows);
+            CHECK(t.names == reference.names);
+            CHECK(t.types == reference.types);
+            CHECK(t.cells == reference.cells);
+        }
+    }
+}
+
+void testParallelMatchesSerial() {
+    const std::string data = makeCsv(200000, 23);
+    CsvOptions options;
+    options.chunkBytes = 1 << 22;
+    Table parallel = readAll(data, options);
+    const int64_t threshold = parallelThreshold();
+    setParallelThreshold(INT64_MAX);
+    Table serial = readAll(data, options);
+    setParallelThreshold(threshold);
+    CHECK(parallel.cells[0].size() == 200000);
+    CHECK(parallel.types == serial.types);
+    CHECK(parallel.cells == serial.cells);
+}
+
+void testProjection() {
+    // 只解析选中的列，按给出的顺序输出，结果与全部读取后再取列相同
+    const std::string data = makeCsv(20000, 17);
+    CsvOptions all;
+    all.chunkBytes = 4096;
+    const Table full = readAll(data, all);
+
+    CsvOptions options = all;
+    options.columns = {"text", "id"};
+    const Table projected = readAll(data, options, 3000);
+    CHECK(projected.names == std::vector<std::string>({"text", "id"}));
+    CHECK(projected.types.size() == 2);
+    CHECK(projected.types[0] == full.types[2]);
+    CHECK(projected.types[1] == full.types[0]);
+    CHECK(projected.cells[0] == full.cells[2]);
+    CHECK(projected.cells[1] == full.cells[0]);
+
+    // 只选第一列时后面的字段不参与类型推断，字段不足的行补空值
+    options.columns = {"a"};
+    const Table first = readAll("a,b\n1,x\n2\n,y\n", options);
+    CHECK(first.types == std::vector<CsvType>({CsvType::INT32}));
+    CHECK(first.cells[0] == std::vector<std::string>({"1", "2", "<null>"}));
+
+    // 不存在或重复的列名
+    options.columns = {"a", "missing"};
+    const std::string small = "a,b\n1,2\n";
+    CsvReader missing(std::unique_ptr<CsvSource>(new MemoryCsvSource(small.data(), static_cast<int64_t>(small.size()))),
+                      options);
+    CHECK(missing.columnNames().empty());
+    CHECK(missing.error() == "CSV中不存在列: missing");
+    CsvBatch batch;
+    CHECK(!missing.next(batch));
+    options.columns = {"b", "b"};
+    CsvReader duplicated(std::unique_ptr<CsvSource>(new MemoryCsvSource(small.data(), static_cast<int64_t>(small.size()))),
+                         options);
+    CHECK(!duplicated.next(batch));
+    CHECK(!duplicated.error().empty());
+}
+
+void testDictionaryEncoding() {
+    // 字典编码后的内容与不编码时一致，编号在各批之间保持不变
+    const std::string data = makeCsv(20000, 23);
+    CsvOptions plain;
+    plain.chunkBytes = 4096;
+    const Table reference = readAll(data, plain);
+    CsvOptions options = plain;
+    options.dictionaryEncode = true;
+    const Table encoded = readAll(data, options, 1500);
+    CHECK(encoded.types == reference.types);
+    CHECK(encoded.cells == reference.cells);
+
+    CsvReader reader(std::unique_ptr<CsvSource>(new MemoryCsvSource(data.data(), static_cast<int64_t>(data.size()))),
+                     options);
+    CsvBatch batch;
+    int32_t seen = 0;
+    int32_t quotedCode = -2;
+    bool ok = true;
+    while (reader.next(batch, 700)) {
+        const CsvColumn& text = batch.columns[2];
+        ok = ok && text.dictionary == reader.dictionary(2) && text.dictionaryBase == seen;
+        ok = ok && text.chars.empty() && text.offsets.empty() && text.codes.size() == static_cast<size_t>(batch.rows);
+        for (int64_t r = 0; r < batch.rows; r++) {
+            const int32_t code = text.codes[static_cast<size_t>(r)];
+            ok = ok && (code < 0) == (text.valid[static_cast<size_t>(r)] == 0) && code < text.dictionary->size();
+            if (code >= 0 && std::string(text.dictionary->data(code), static_cast<size_t>(text.dictionary->length(code))) == "a,b") {
+                ok = ok && (quotedCode == -2 || quotedCode == code);
+                quotedCode = code;
+            }
+        }
+        seen = text.dictionary->size();
+        // 数值列不编码
+        ok = ok && batch.columns[0].dictionary == nullptr && reader.dictionary(0) == nullptr;
+    }
+    CHECK(ok);
+    CHECK(quotedCode >= 0);
+    CHECK(reader.dictionary(2)->find("a,b", 3) == quotedCode);
+
+    // 数值列在后面的批次提升为 STRING 时才开始编码
+    options.sampleRows = 2;
+    std::string mixed = "k\n";
+    for (int i = 0; i < 3000; i++) mixed += std::to_string(i % 7) + "\n";
+    mixed += "x\ny\nx\n";
+    CsvReader widened(std::unique_ptr<CsvSource>(new MemoryCsvSource(mixed.data(), static_cast<int64_t>(mixed.size()))),
+                      options);
+    std::vector<std::string> cells;
+    bool encodedStrings = true;
+    while (widened.next(batch, 1000)) {
+        const CsvColumn& k = batch.columns[0];
+        encodedStrings = encodedStrings && (k.type != CsvType::STRING || k.dictionary != nullptr);
+        for (int64_t r = 0; r < batch.rows; r++) cells.push_back(cellText(k, r));
+    }
+    CHECK(encodedStrings);
+    CHECK(cells.size() == 3003);
+    CHECK(cells[3000] == "x" && cells[3002] == "x" && cells[6] == "6");
+    CHECK(widened.dictionary(0) != nullptr);
+}
+
+void testFileDescriptor() {
+    char path[] = "/tmp/andas_csv_XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    if (fd < 0) return;
+    const std::string data = makeCsv(500, 31);
+    CHECK(write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    lseek(fd, 0, SEEK_SET);
+
+    CsvOptions options;
+    options.chunkBytes = 256;
+    CsvReader reader(std::unique_ptr<CsvSource>(new FdCsvSource(fd, true)), options);
+    int64_t rows = 0;
+    CsvBatch batch;
+    while (reader.next(batch)) rows += batch.rows;
+    CHECK(rows == 500);
+    CHECK(reader.error().empty());
+    unlink(path);
+}
+
+// 前 failAfter 字节正常返回，之后读取失败
+class FailingSource : public CsvSource {
+public:
+    FailingSource(const std::string& data, int64_t failAfter) : data_(data), failAfter_(failAfter) {}
+
+    int64_t read(char* buffer, int64_t capacity) override {
+        if (position_ >= failAfter_) return -1;
+        const int64_t n = std::min<int64_t>({capacity, failAfter_ - position_, 7});
+        std::memcpy(buffer, data_.data() + position_, static_cast<size_t>(n));
+        position_ += n;
+        return n;
+    }
+
+private:
+    std::string data_;
+    int64_t failAfter_;
+    int64_t position_ = 0;
+};
+
+void testPrefetch() {
+    const std::string data = makeCsv(3000, 41);
+    CsvOptions options;
+    options.chunkBytes = 4096;
+    const Table expected = readAll(data, options);
+    for (int64_t blockBytes : {64, 1000, 1 << 20}) {
+        for (int32_t depth : {2, 5}) {
+            std::unique_ptr<CsvSource> inner(new MemoryCsvSource(data.data(), static_cast<int64_t>(data.size())));
+            const Table actual = readAll(
+                std::unique_ptr<CsvSource>(new PrefetchCsvSource(std::move(inner), blockBytes, depth)), options);
+            CHECK(actual.names == expected.names);
+            CHECK(actual.types == expected.types);
+            CHECK(actual.cells == expected.cells);
+        }
+    }
+
+    // 失败之前读到的数据照常返回，之后返回 -1
+    PrefetchCsvSource failing(std::unique_ptr<CsvSource>(new FailingSource(data, 500)), 64, 2);
+    std::string received;
+    char buffer[100];
+    int64_t n = 0;
+    while ((n = failing.read(buffer, sizeof(buffer))) > 0) received.append(buffer, static_cast<size_t>(n));
+    CHECK(n == -1);
+    CHECK(received == data.substr(0, 500));
+
+    // 没读完就析构：后台线程阻塞在背压上，析构时应能停下
+    for (int i = 0; i < 20; i++) {
+        PrefetchCsvSource partial(
+            std::unique_ptr<CsvSource>(new MemoryCsvSource(data.data(), static_cast<int64_t>(data.size()))), 64, 2);
+        CHECK(partial.read(buffer, 10) == 10);
+        CHECK(std::memcmp(buffer, data.data(), 10) == 0);
+    }
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testNumberParsing);
+    RUN_TEST(testSyntax);
+    RUN_TEST(testTypePromotion);
+    RUN_TEST(testChunkBoundaries);
+    RUN_TEST(testParallelMatchesSerial);
+    RUN_TEST(testProjection);
+    RUN_TEST(testDictionaryEncoding);
+    RUN_TEST(testFileDescriptor);
+    RUN_TEST(testPrefetch);
+    return TEST_RESULT();
+}
@@ -0,0 +1,197 @@
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+#include "dedup_engine.h"
+#include "groupby_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+using Columns = std::vector<std::vector<int64_t>>;
+
+std::vector<const int64_t*> pointersOf(const Columns& columns) {
+    std::vector<const int64_t*> pointers;
+    for (const auto& column : columns) pointers.push_back(column.data());
+    return pointers;
+}
+
+std::vector<int64_t> rowKey(const Columns& columns, size_t row) {
+    std::vector<int64_t> key;
+    for (const auto& column : columns) key.push_back(column[row]);
+    return key;
+}
+
+// 参考实现：std::map 按首次出现记录行号和次数
+struct Reference {
+    std::vector<int32_t> firstRows;
+    std::vector<int64_t> counts;
+    std::vector<uint8_t> first;
+    std::vector<uint8_t> last;
+    std::vector<uint8_t> none;
+};
+
+Reference reference(const Columns& columns) {
+    const size_t n = columns[0].size();
+    std::map<std::vector<int64_t>, size_t> seen;
+    std::vector<int64_t> lastRow;
+    Reference ref;
+    std::vector<size_t> groupOf(n);
+    for (size_t i = 0; i < n; i++) {
+        auto key = rowKey(columns, i);
+        auto it = seen.find(key);
+        if (it == seen.end()) {
+            it = seen.emplace(key, ref.firstRows.size()).first;
+            ref.firstRows.push_back(static_cast<int32_t>(i));
+            ref.counts.push_back(0);
+            lastRow.push_back(-1);
+        }
+        groupOf[i] = it->second;
+        ref.counts[it->second]++;
+        lastRow[it->second] = static_cast<int64_t>(i);
+    }
+    for (size_t i = 0; i < n; i++) {
+        const size_t g = groupOf[i];
+        ref.first.push_back(ref.firstRows[g] != static_cast<int32_t>(i));
+        ref.last.push_back(lastRow[g] != static_cast<int64_t>(i));
+        ref.none.push_back(ref.counts[g] > 1);
+    }
+    return ref;
+}
+
+Columns makeKeys(int64_t n, int64_t cardinality, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    Columns keys(3, std::vector<int64_t>(static_cast<size_t>(n)));
+    for (int64_t i = 0; i < n; i++) {
+        keys[0][static_cast<size_t>(i)] = static_cast<int64_t>(rng() % static_cast<uint64_t>(cardinality));
+        keys[1][static_cast<size_t>(i)] = static_cast<int64_t>(rng() % 3) - 1;
+        // 缺失值编码也是普通的键值
+        keys[2][static_cast<size_t>(i)] = rng() % 5 == 0 ? kNullGroupKey : static_cast<int64_t>(rng() % 2);
+    }
+    return keys;
+}
+
+std::vector<uint8_t> duplicated(const Columns& columns, int32_t keyColumns, DuplicateKeep keep) {
+    std::vector<const int64_t*> pointers = pointersOf(columns);
+    std::vector<uint8_t> out(columns[0].size(), 7);
+    duplicatedRows(pointers.data(), keyColumns, static_cast<int64_t>(columns[0].size()), keep, out.data());
+    return out;
+}
+
+void testSmallExample() {
+    // (a, b) 行：(1,1) (2,1) (1,1) (null,1) (2,2) (null,1) (1,1)
+    const Columns keys = {{1, 2, 1, kNullGroupKey, 2, kNullGroupKey, 1}, {1, 1, 1, 1, 2, 1, 1}};
+    std::vector<const int64_t*> pointers = pointersOf(keys);
+
+    UniqueOutput unique = uniqueRows(pointers.data(), 2, 7, false);
+    CHECK((unique.rows == std::vector<int32_t>{0, 1, 3, 4}));
+    CHECK((unique.counts == std::vector<int64_t>{3, 1, 2, 1}));
+
+    UniqueOutput counts = uniqueRows(pointers.data(), 2, 7, true);
+    CHECK((counts.rows == std::vector<int32_t>{0, 3, 1, 4}));
+    CHECK((counts.counts == std::vector<int64_t>{3, 2, 1, 1}));
+
+    CHECK((duplicated(keys, 2, DuplicateKeep::FIRST) == std::vector<uint8_t>{0, 0, 1, 0, 0, 1, 1}));
+    CHECK((duplicated(keys, 2, DuplicateKeep::LAST) == std::vector<uint8_t>{1, 0, 1, 1, 0, 0, 0}));
+    CHECK((duplicated(keys, 2, DuplicateKeep::NONE) == std::vector<uint8_t>{1, 0, 1, 1, 0, 1, 1}));
+
+    // 只看第一列
+    CHECK((duplicated(keys, 1, DuplicateKeep::FIRST) == std::vector<uint8_t>{0, 0, 1, 0, 1, 1, 1}));
+
+    UniqueOutput empty = uniqueRows(pointers.data(), 2, 0, true);
+    CHECK(empty.rows.empty() && empty.counts.empty());
+    CHECK(isValidDuplicateKeep(2));
+    CHECK(!isValidDuplicateKeep(3));
+    CHECK(!isValidDuplicateKeep(-1));
+}
+
+void testMatchesReference() {
+    // 串行（小于并行阈值）和分区并行两条路径
+    for (int64_t n : {500, 50000}) {
+        for (int64_t cardinality : {3, 200, 100000}) {
+            const Columns keys = makeKeys(n, cardinality, static_cast<uint64_t>(n * 31 + cardinality));
+            const Reference ref = reference(keys);
+            std::vector<const int64_t*> pointers = pointersOf(keys);
+
+            UniqueOutput unique = uniqueRows(pointers.data(), 3, n, false);
+            CHECK(unique.rows == ref.firstRows);
+            CHECK(unique.counts == ref.counts);
+            CHECK(duplicated(keys, 3, DuplicateKeep::FIRST) == ref.first);
+            CHECK(duplicated(keys, 3, DuplicateKeep::LAST) == ref.last);
+            CHECK(duplicated(keys, 3, DuplicateKeep::NONE) == ref.none);
+
+            UniqueOutput sorted = uniqueRows(pointers.data(), 3, n, true);
+            CHECK(sorted.rows.size() == ref.firstRows.size());
+            bool ordered = true;
+            int64_t total = 0;
+            for (size_t g = 0; g < sorted.rows.size(); g++) {
+                total += sorted.counts[g];
+                if (g > 0) {
+                    ordered &= sorted.counts[g - 1] > sorted.counts[g] ||
+                        (sorted.counts[g - 1] == sorted.counts[g] && sorted.rows[g - 1] < sorted.rows[g]);
+                }
+            }
+            CHECK(ordered);
+            CHECK(total == n);
+        }
+    }
+}
+
+void testThreadCountIndependent() {
+    const int64_t n = 40000;
+    const Columns keys = makeKeys(n, 5000, 99);
+    std::vector<const int64_t*> pointers = pointersOf(keys);
+    UniqueOutput parallel = uniqueRows(pointers.data(), 3, n, true);
+    std::vector<uint8_t> parallelNone = duplicated(keys, 3, DuplicateKeep::NONE);
+
+    ThreadPool::instance().setThreadCount(1);
+    UniqueOutput serial = uniqueRows(pointers.data(), 3, n, true);
+    std::vector<uint8_t> serialNone = duplicated(keys, 3, DuplicateKeep::NONE);
+    ThreadPool::instance().setThreadCount(4);
+
+    CHECK(parallel.rows == serial.rows);
+    CHECK(parallel.counts == serial.counts);
+    CHECK(parallelNone == serialNone);
+}
+
+void testDistinctKeySetAcrossBatches() {
+    // 按不同大小的批依次插入，结果应等于整体 duplicated(keep=first) 为 0 的行
+    const int64_t n = 30000;
+    const Columns keys = makeKeys(n, 4000, 7);
+    const Reference ref = reference(keys);
+
+    DistinctKeySet set(3);
+    CHECK(set.keyColumns() == 3);
+    std::vector<int32_t> fresh;
+    int64_t start = 0;
+    for (int64_t batch : {1, 999, 5000, 0, 24000}) {
+        std::vector<const int64_t*> pointers;
+        for (const auto& column : keys) pointers.push_back(column.data() + start);
+        for (int32_t row : set.insert(pointers.data(), batch)) fresh.push_back(static_cast<int32_t>(start + row));
+        start += batch;
+    }
+    CHECK(start == n);
+    CHECK(fresh == ref.firstRows);
+    CHECK(set.size() == static_cast<int64_t>(ref.firstRows.size()));
+
+    // 再插入一遍全部行，没有新键
+    std::vector<const int64_t*> pointers = pointersOf(keys);
+    CHECK(set.insert(pointers.data(), n).empty());
+    CHECK(set.size() == static_cast<int64_t>(ref.firstRows.size()));
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testSmallExample);
+    RUN_TEST(testMatchesReference);
+    RUN_TEST(testThreadCountIndependent);
+    RUN_TEST(testDistinctKeySetAcrossBatches);
+    return TEST_RESULT();
+}
@@ -0,0 +1,217 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include "filter_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// 逐行参考实现
+bool referenceLeaf(const FilterProgram& program, const FilterInstruction& ins, int64_t row) {
+    const FilterColumn& column = program.columns[ins.column];
+    bool isNull;
+    double dv = 0.0;
+    int64_t lv = 0;
+    if (column.type == FilterColumnType::FLOAT64) {
+        dv = static_cast<const double*>(column.values)[row];
+        isNull = std::isnan(dv);
+    } else {
+        lv = static_cast<const int64_t*>(column.values)[row];
+        isNull = lv == kNullFilterKey;
+    }
+    if (ins.op == FilterOp::IS_NULL) return isNull;
+    if (ins.op == FilterOp::NOT_NULL) return !isNull;
+    if (ins.op == FilterOp::NE && isNull) return true;
+    if (isNull) return false;
+    auto cmp = [&](int32_t arg) {
+        if (column.type == FilterColumnType::FLOAT64) {
+            const double c = program.doubles[arg];
+            return dv < c ? -1 : (dv > c ? 1 : (dv == c ? 0 : 2));
+        }
+        const int64_t c = program.longs[arg];
+        return lv < c ? -1 : (lv > c ? 1 : 0);
+    };
+    switch (ins.op) {
+        case FilterOp::GT: return cmp(ins.arg) == 1;
+        case FilterOp::GE: return cmp(ins.arg) == 1 || cmp(ins.arg) == 0;
+        case FilterOp::LT: return cmp(ins.arg) == -1;
+        case FilterOp::LE: return cmp(ins.arg) == -1 || cmp(ins.arg) == 0;
+        case FilterOp::EQ: return cmp(ins.arg) == 0;
+        case FilterOp::NE: return cmp(ins.arg) != 0;
+        case FilterOp::BETWEEN: {
+            const int lo = cmp(ins.arg);
+            const int hi = cmp(ins.arg + 1);
+            return (lo == 1 || lo == 0) && (hi == -1 || hi == 0);
+        }
+        case FilterOp::IN_SET:
+            for (int32_t c = 0; c < ins.count; c++) {
+                if (cmp(ins.arg + c) == 0) return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+std::vector<int32_t> referenceRows(const FilterProgram& program, int64_t n) {
+    std::vector<int32_t> rows;
+    for (int64_t row = 0; row < n; row++) {
+        std::vector<bool> stack;
+        for (int32_t i = 0; i < program.instructionCount; i++) {
+            const FilterInstruction& ins = program.instructions[i];
+            if (ins.op == FilterOp::NOT) {
+                stack.back() = !stack.back();
+            } else if (ins.op == FilterOp::AND || ins.op == FilterOp::OR) {
+                const bool rhs = stack.back();
+                stack.pop_back();
+                stack.back() = ins.op == FilterOp::AND ? (stack.back() && rhs) : (stack.back() || rhs);
+            } else {
+                stack.push_back(referenceLeaf(program, ins, row));
+            }
+        }
+        if (stack.back()) rows.push_back(static_cast<int32_t>(row));
+    }
+    return rows;
+}
+
+std::vector<int32_t> engineRows(const FilterProgram& program, int64_t n) {
+    std::vector<uint64_t> bits(static_cast<size_t>((n + 63) / 64) + 1, ~uint64_t(0));
+    evaluateFilter(program, n, bits.data());
+    // 末尾多余位必须为 0
+    if (n % 64 != 0) CHECK((bits[static_cast<size_t>(n / 64)] >> (n % 64)) == 0);
+    std::vector<int32_t> rows = selectedRows(bits.data(), n);
+    CHECK(countSelected(bits.data(), n) == static_cast<int64_t>(rows.size()));
+    return rows;
+}
+
+struct Fixture {
+    std::vector<double> price;
+    std::vector<int64_t> qty;
+    std::vector<int64_t> city;   // 字典编码
+    std::vector<FilterColumn> columns;
+
+    explicit Fixture(int64_t n, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        for (int64_t i = 0; i < n; i++) {
+            price.push_back(rng() % 10 == 0 ? kNaN : static_cast<double>(rng() % 200) * 0.5 - 20.0);
+            qty.push_back(rng() % 12 == 0 ? kNullFilterKey : static_cast<int64_t>(rng() % 50) - 5);
+            city.push_back(rng() % 20 == 0 ? kNullFilterKey : static_cast<int64_t>(rng() % 30));
+        }
+        columns = {
+            {FilterColumnType::FLOAT64, price.data()},
+            {FilterColumnType::INT64, qty.data()},
+            {FilterColumnType::INT64, city.data()},
+        };
+    }
+};
+
+// 常量池：下标 0..1 比较/区间，2..13 为 IN 集合
+const double kDoubles[] = {10.0, 35.5, -3.0, 0.0, 0.5, 1.0, 2.0, 2.5, 3.0, 4.0, 5.0, 6.0, 7.0, kNaN};
+const int64_t kLongs[] = {10, 20, 3, 0, 7, 1, 2, 11, 13, 17, 19, 23, 29, kNullFilterKey};
+const int32_t kConstantCount = 14;
+
+FilterProgram makeProgram(const Fixture& f, const std::vector<FilterInstruction>& instructions) {
+    return {f.columns.data(), static_cast<int32_t>(f.columns.size()),
+            instructions.data(), static_cast<int32_t>(instructions.size()),
+            kDoubles, kLongs, kConstantCount};
+}
+
+void testLeaves() {
+    const Fixture f(1000, 1);
+    const int64_t n = static_cast<int64_t>(f.price.size());
+    for (int32_t column = 0; column < 3; column++) {
+        for (int32_t op = 0; op <= static_cast<int32_t>(FilterOp::NOT_NULL); op++) {
+            // IN_SET 分别覆盖线性比较（4个）和二分查找（12个，含缺失值常量）
+            for (int32_t count : {4, 12}) {
+                std::vector<FilterInstruction> ins = {{static_cast<FilterOp>(op), column, op == 7 ? 2 : 0, count}};
+                const FilterProgram program = makeProgram(f, ins);
+                CHECK(validateFilter(program) == nullptr);
+                CHECK(engineRows(program, n) == referenceRows(program, n));
+            }
+        }
+    }
+}
+
+void testCompound() {
+    // 普通大小，以及超过并行阈值、跨多个块且末尾不足一个字的大小
+    for (int64_t n : {int64_t(0), int64_t(1), int64_t(63), int64_t(64), int64_t(4097), int64_t(300001)}) {
+        const Fixture f(n, 9);
+        // price > 10 AND qty == 20 OR city IS NULL
+        const std::vector<FilterInstruction> a = {
+            {FilterOp::GT, 0, 0, 0}, {FilterOp::EQ, 1, 1, 0}, {FilterOp::AND, 0, 0, 0},
+            {FilterOp::IS_NULL, 2, 0, 0}, {FilterOp::OR, 0, 0, 0},
+        };
+        // NOT (price BETWEEN 10 AND 35.5) AND (city IN (...) OR NOT qty < 3)
+        const std::vector<FilterInstruction> b = {
+            {FilterOp::BETWEEN, 0, 0, 0}, {FilterOp::NOT, 0, 0, 0},
+            {FilterOp::IN_SET, 2, 2, 11}, {FilterOp::LT, 1, 2, 0}, {FilterOp::NOT, 0, 0, 0},
+            {FilterOp::OR, 0, 0, 0}, {FilterOp::AND, 0, 0, 0},
+        };
+        for (const auto* ins : {&a, &b}) {
+            const FilterProgram program = makeProgram(f, *ins);
+            CHECK(validateFilter(program) == nullptr);
+            const std::vector<int32_t> parallel = engineRows(program, n);
+            const int64_t threshold = parallelThreshold();
+            setParallelThreshold(n + 1);
+            const std::vector<int32_t> serial = engineRows(program, n);
+            setParallelThreshold(threshold);
+            CHECK(parallel == serial);
+            CHECK(parallel == referenceRows(program, n));
+        }
+    }
+}
+
+void testValidate() {
+    const Fixture f(10, 2);
+    auto check = [&](const std::vector<FilterInstruction>& ins) {
+        return validateFilter(makeProgram(f, ins)) != nullptr;
+    };
+    CHECK(check({}));
+    CHECK(check({{FilterOp::GT, 3, 0, 0}}));
+    CHECK(check({{FilterOp::GT, 0, kConstantCount, 0}}));
+    CHECK(check({{FilterOp::BETWEEN, 0, kConstantCount - 1, 0}}));
+    CHECK(check({{FilterOp::IN_SET, 0, 10, 5}}));
+    CHECK(check({{FilterOp::IN_SET, 0, 0, -1}}));
+    CHECK(check({{FilterOp::AND, 0, 0, 0}}));
+    CHECK(check({{FilterOp::GT, 0, 0, 0}, {FilterOp::GT, 1, 0, 0}}));
+    CHECK(check({{static_cast<FilterOp>(42), 0, 0, 0}}));
+    CHECK(!check({{FilterOp::IN_SET, 0, 3, 0}}));
+    CHECK(!check({{FilterOp::IS_NULL, 1, -1, 0}, {FilterOp::NOT, 0, 0, 0}}));
+}
+
+void testBitmapOps() {
+    const int64_t n = 130;
+    std::vector<uint64_t> a = {0xF0F0F0F0F0F0F0F0ULL, 0x00000000FFFFFFFFULL, 0x1ULL};
+    std::vector<uint64_t> b = {0xFF00FF00FF00FF00ULL, 0xFFFFFFFF00000000ULL, 0x3ULL};
+    std::vector<uint64_t> out(3);
+    bitmapAnd(a.data(), b.data(), out.data(), n);
+    CHECK((out == std::vector<uint64_t>{0xF000F000F000F000ULL, 0, 0x1ULL}));
+    bitmapOr(a.data(), b.data(), out.data(), n);
+    CHECK((out == std::vector<uint64_t>{0xFFF0FFF0FFF0FFF0ULL, ~uint64_t(0), 0x3ULL}));
+    bitmapNot(a.data(), out.data(), n);
+    CHECK((out == std::vector<uint64_t>{0x0F0F0F0F0F0F0F0FULL, 0xFFFFFFFF00000000ULL, 0x2ULL}));
+    CHECK(countSelected(out.data(), n) == 32 + 32 + 1);
+    const std::vector<int32_t> rows = selectedRows(a.data(), n);
+    CHECK(rows.size() == 32 + 32 + 1);
+    CHECK(rows.front() == 4 && rows[32] == 64 && rows.back() == 128);
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testLeaves);
+    RUN_TEST(testCompound);
+    RUN_TEST(testValidate);
+    RUN_TEST(testBitmapOps);
+    return TEST_RESULT();
+}
@@ -0,0 +1,187 @@
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+#include "groupby_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+const AggSpec kAllOps[] = {
+    {0, AggOp::SUM}, {0, AggOp::MEAN}, {0, AggOp::COUNT}, {0, AggOp::MIN},
+    {0, AggOp::MAX}, {0, AggOp::VAR}, {0, AggOp::FIRST}, {0, AggOp::LAST},
+};
+const int32_t kOpCount = 8;
+
+bool sameValue(double a, double b, double tol) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    return std::fabs(a - b) <= tol * (1.0 + std::fabs(b));
+}
+
+void testSmallExample() {
+    // 键: 3, 1, 3, NULL, 1, 2  值: 1, 2, NaN, 4, 5, NaN
+    std::vector<int64_t> key = {3, 1, 3, kNullGroupKey, 1, 2};
+    std::vector<double> value = {1.0, 2.0, NAN, 4.0, 5.0, NAN};
+    const int64_t* keys[] = {key.data()};
+    const double* values[] = {value.data()};
+    GroupByOutput out = groupByAggregate(keys, 1, values, 1, kAllOps, kOpCount, 6);
+
+    CHECK(out.groupCount == 3);
+    // 按首次出现顺序输出
+    CHECK(out.keys[0] == std::vector<int64_t>({3, 1, 2}));
+    CHECK(out.sizes == std::vector<int64_t>({2, 2, 1}));
+    CHECK_NEAR(out.aggregates[0][1], 7.0, 0.0);      // sum
+    CHECK_NEAR(out.aggregates[1][1], 3.5, 1e-12);    // mean
+    CHECK_NEAR(out.aggregates[2][0], 1.0, 0.0);      // count 跳过 NaN
+    CHECK_NEAR(out.aggregates[3][1], 2.0, 0.0);      // min
+    CHECK_NEAR(out.aggregates[4][1], 5.0, 0.0);      // max
+    CHECK_NEAR(out.aggregates[5][1], 4.5, 1e-12);    // 样本方差
+    CHECK(std::isnan(out.aggregates[5][0]));         // 有效值不足2个
+    CHECK_NEAR(out.aggregates[6][1], 2.0, 0.0);      // first
+    CHECK_NEAR(out.aggregates[7][1], 5.0, 0.0);      // last
+    // 全部为 NaN 的分组
+    CHECK_NEAR(out.aggregates[0][2], 0.0, 0.0);
+    CHECK(std::isnan(out.aggregates[1][2]));
+    CHECK(std::isnan(out.aggregates[6][2]));
+}
+
+void testNoValueColumns() {
+    std::vector<int64_t> key = {5, 5, 6, 5};
+    const int64_t* keys[] = {key.data()};
+    GroupByOutput out = groupByAggregate(keys, 1, nullptr, 0, nullptr, 0, 4);
+    CHECK(out.groupCount == 2);
+    CHECK(out.sizes == std::vector<int64_t>({3, 1}));
+    CHECK(out.aggregates.empty());
+
+    GroupByOutput empty = groupByAggregate(keys, 1, nullptr, 0, nullptr, 0, 0);
+    CHECK(empty.groupCount == 0);
+}
+
+// 参考实现：std::map 逐行累加
+struct Reference {
+    int64_t firstRow = -1;
+    int64_t size = 0;
+    std::vector<double> valid;
+};
+
+void checkAgainstReference(int64_t n, int64_t cardinality, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<int64_t> k0(static_cast<size_t>(n)), k1(static_cast<size_t>(n));
+    std::vector<double> v0(static_cast<size_t>(n)), v1(static_cast<size_t>(n));
+    std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+    for (int64_t i = 0; i < n; i++) {
+        k0[static_cast<size_t>(i)] = (rng() % 50 == 0) ? kNullGroupKey
+                                     : static_cast<int64_t>(rng() % static_cast<uint64_t>(cardinality)) - 7;
+        k1[static_cast<size_t>(i)] = static_cast<int64_t>(rng() % 3);
+        v0[static_cast<size_t>(i)] = (rng() % 10 == 0) ? NAN : dist(rng);
+        v1[static_cast<size_t>(i)] = static_cast<double>(i % 13);
+    }
+
+    std::map<std::pair<int64_t, int64_t>, Reference> ref;
+    for (int64_t i = 0; i < n; i++) {
+        if (k0[static_cast<size_t>(i)] == kNullGroupKey) continue;
+        Reference& r = ref[{k0[static_cast<size_t>(i)], k1[static_cast<size_t>(i)]}];
+        if (r.firstRow < 0) r.firstRow = i;
+        r.size++;
+        if (!std::isnan(v0[static_cast<size_t>(i)])) r.valid.push_back(v0[static_cast<size_t>(i)]);
+    }
+
+    const int64_t* keys[] = {k0.data(), k1.data()};
+    const double* values[] = {v0.data(), v1.data()};
+    std::vector<AggSpec> specs(kAllOps, kAllOps + kOpCount);
+    specs.push_back({1, AggOp::SUM});
+    GroupByOutput out = groupByAggregate(keys, 2, values, 2, specs.data(),
+                                         static_cast<int32_t>(specs.size()), n);
+
+    CHECK(out.groupCount == static_cast<int64_t>(ref.size()));
+    int64_t previousFirst = -1;
+    for (int64_t g = 0; g < out.groupCount; g++) {
+        auto it = ref.find({out.keys[0][static_cast<size_t>(g)], out.keys[1][static_cast<size_t>(g)]});
+        if (it == ref.end()) {
+            CHECK(false);
+            continue;
+        }
+        const Reference& r = it->second;
+        CHECK(r.firstRow > previousFirst);
+        previousFirst = r.firstRow;
+        CHECK(out.sizes[static_cast<size_t>(g)] == r.size);
+
+        double sum = 0.0, mn = INFINITY, mx = -INFINITY;
+        for (double v : r.valid) {
+            sum += v;
+            mn = std::min(mn, v);
+            mx = std::max(mx, v);
+        }
+        const double cnt = static_cast<double>(r.valid.size());
+        const double mean = r.valid.empty() ? NAN : sum / cnt;
+        double m2 = 0.0;
+        for (double v : r.valid) m2 += (v - mean) * (v - mean);
+        const double expected[] = {
+            sum, mean, cnt,
+            r.valid.empty() ? NAN : mn,
+            r.valid.empty() ? NAN : mx,
+            r.valid.size() > 1 ? m2 / (cnt - 1) : NAN,
+            r.valid.empty() ? NAN : r.valid.front(),
+            r.valid.empty() ? NAN : r.valid.back(),
+        };
+        for (int32_t s = 0; s < kOpCount; s++) {
+            if (!sameValue(out.aggregates[static_cast<size_t>(s)][static_cast<size_t>(g)], expected[s], 1e-9)) {
+                std::fprintf(stderr, "分组 %lld 聚合 %d 不一致: %.17g != %.17g\n", static_cast<long long>(g), s,
+                             out.aggregates[static_cast<size_t>(s)][static_cast<size_t>(g)], expected[s]);
+                gTestFailures++;
+            }
+        }
+    }
+}
+
+void testMatchesReference() {
+    checkAgainstReference(1000, 10, 1);
+    checkAgainstReference(50000, 20, 2);
+    // 高基数：大部分分组跨越多个块
+    checkAgainstReference(200000, 40000, 3);
+}
+
+void testParallelMatchesSerial() {
+    const int64_t n = 100000;
+    std::vector<int64_t> key(static_cast<size_t>(n));
+    std::vector<double> value(static_cast<size_t>(n));
+    for (int64_t i = 0; i < n; i++) {
+        key[static_cast<size_t>(i)] = (i * 7919) % 1237;
+        value[static_cast<size_t>(i)] = std::sin(static_cast<double>(i));
+    }
+    const int64_t* keys[] = {key.data()};
+    const double* values[] = {value.data()};
+
+    GroupByOutput parallel = groupByAggregate(keys, 1, values, 1, kAllOps, kOpCount, n);
+    const int64_t threshold = parallelThreshold();
+    setParallelThreshold(n + 1);
+    GroupByOutput serial = groupByAggregate(keys, 1, values, 1, kAllOps, kOpCount, n);
+    setParallelThreshold(threshold);
+
+    CHECK(parallel.keys == serial.keys);
+    CHECK(parallel.sizes == serial.sizes);
+    for (int32_t s = 0; s < kOpCount; s++) {
+        for (int64_t g = 0; g < serial.groupCount; g++) {
+            CHECK(sameValue(parallel.aggregates[static_cast<size_t>(s)][static_cast<size_t>(g)],
+                            serial.aggregates[static_cast<size_t>(s)][static_cast<size_t>(g)], 1e-9));
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testSmallExample);
+    RUN_TEST(testNoValueColumns);
+    RUN_TEST(testMatchesReference);
+    RUN_TEST(testParallelMatchesSerial);
+    return TEST_RESULT();
+}
@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+#include "index_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+// 按链取出键的全部位置
+std::vector<int32_t> positionsOf(const HashIndex& index, int64_t key) {
+    std::vector<int32_t> positions;
+    for (int32_t p = index.first(key); p >= 0; p = index.next(p)) positions.push_back(p);
+    return positions;
+}
+
+void testSmallExample() {
+    const std::vector<int64_t> keys = {5, -3, 5, 1LL << 40, -3, 5, INT64_MIN};
+    HashIndex index(keys.data(), static_cast<int64_t>(keys.size()));
+    CHECK(index.size() == 7);
+    CHECK(!index.unique());
+    CHECK((positionsOf(index, 5) == std::vector<int32_t>{0, 2, 5}));
+    CHECK((positionsOf(index, -3) == std::vector<int32_t>{1, 4}));
+    CHECK((positionsOf(index, 1LL << 40) == std::vector<int32_t>{3}));
+    CHECK((positionsOf(index, INT64_MIN) == std::vector<int32_t>{6}));
+    CHECK(index.first(0) == -1);
+    CHECK(index.first(6) == -1);
+
+    std::vector<int32_t> codes(keys.size());
+    index.firstPositions(codes.data());
+    CHECK((codes == std::vector<int32_t>{0, 1, 0, 3, 1, 0, 6}));
+
+    const std::vector<int64_t> distinct = {10, 20, 30};
+    HashIndex unique(distinct.data(), 3);
+    CHECK(unique.unique());
+    CHECK(unique.first(20) == 1);
+
+    HashIndex empty(nullptr, 0);
+    CHECK(empty.size() == 0);
+    CHECK(empty.unique());
+    CHECK(empty.first(1) == -1);
+}
+
+void testMatchesReference() {
+    // 串行（小于并行阈值）和并行查找两条路径
+    for (int64_t n : {300, 60000}) {
+        for (int64_t cardinality : {int64_t{7}, n * 4}) {
+            std::mt19937_64 rng(static_cast<uint64_t>(n + cardinality));
+            std::vector<int64_t> keys(static_cast<size_t>(n));
+            std::map<int64_t, std::vector<int32_t>> reference;
+            for (int64_t i = 0; i < n; i++) {
+                keys[static_cast<size_t>(i)] = static_cast<int64_t>(rng() % static_cast<uint64_t>(cardinality)) * 1000003 - 50;
+                reference[keys[static_cast<size_t>(i)]].push_back(static_cast<int32_t>(i));
+            }
+            HashIndex index(keys.data(), n);
+            bool chains = true;
+            for (const auto& entry : reference) chains &= positionsOf(index, entry.first) == entry.second;
+            CHECK(chains);
+            CHECK(index.unique() == (reference.size() == static_cast<size_t>(n)));
+
+            // 一半探测命中，一半不存在
+            std::vector<int64_t> probes(static_cast<size_t>(n));
+            for (int64_t i = 0; i < n; i++) {
+                probes[static_cast<size_t>(i)] = i % 2 == 0 ? keys[static_cast<size_t>(rng() % n)] : static_cast<int64_t>(rng() % 1000003) * 2 + 1;
+            }
+            std::vector<int32_t> out(static_cast<size_t>(n));
+            index.lookup(probes.data(), n, out.data());
+            bool matched = true;
+            for (int64_t i = 0; i < n; i++) {
+                auto it = reference.find(probes[static_cast<size_t>(i)]);
+                matched &= out[static_cast<size_t>(i)] == (it == reference.end() ? -1 : it->second.front());
+            }
+            CHECK(matched);
+
+            std::vector<int32_t> codes(static_cast<size_t>(n));
+            index.firstPositions(codes.data());
+            bool firsts = true;
+            for (int64_t i = 0; i < n; i++) firsts &= codes[static_cast<size_t>(i)] == reference[keys[static_cast<size_t>(i)]].front();
+            CHECK(firsts);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testSmallExample);
+    RUN_TEST(testMatchesReference);
+    return TEST_RESULT();
+}
@@ -0,0 +1,178 @@
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "instrumentation.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+int64_t field(const std::vector<int64_t>& snapshot, int32_t name, int32_t f) {
+    return snapshot[static_cast<size_t>(name) * stats::kFieldCount + f];
+}
+
+int64_t histogramTotal(const std::vector<int64_t>& snapshot, int32_t name) {
+    int64_t total = 0;
+    for (int32_t b = 0; b < stats::kLatencyBuckets; b++) total += field(snapshot, name, stats::LATENCY + b);
+    return total;
+}
+
+int64_t countOf(const std::string& text, const std::string& pattern) {
+    int64_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) count++;
+    return count;
+}
+
+} // namespace
+
+void testRegistry() {
+    const int32_t a = stats::registerName("Test.a");
+    CHECK(a > stats::kMarshalSpan);
+    CHECK(stats::registerName("Test.a") == a);
+    CHECK(stats::registerName("Test.b") != a);
+    CHECK(stats::names()[a] == "Test.a");
+    CHECK(stats::names()[stats::kUnscoped] == "(unscoped)");
+
+    CHECK(stats::latencyBucket(0) == 0);
+    CHECK(stats::latencyBucket(1) == 0);
+    CHECK(stats::latencyBucket(2) == 1);
+    CHECK(stats::latencyBucket(1023) == 9);
+    CHECK(stats::latencyBucket(1024) == 10);
+    CHECK(stats::latencyBucket(INT64_MAX) == stats::kLatencyBuckets - 1);
+}
+
+void testScopes() {
+    const int32_t outer = stats::registerName("Test.outer");
+    const int32_t inner = stats::registerName("Test.inner");
+    stats::reset();
+    for (int i = 0; i < 10; i++) {
+        stats::KernelScope scope(outer);
+        stats::recordArray(800, false);
+        stats::recordArray(80, true);
+        stats::recordBytesOut(40, false);
+        {
+            // 嵌套作用域内的数据转换计入内层
+            stats::KernelScope nested(inner);
+            stats::recordDirect(16);
+            stats::MarshalTimer timer;
+        }
+        stats::recordArray(8, false, false);
+    }
+    // 作用域外的数据转换计入 (unscoped)
+    stats::recordArray(1000, true);
+
+    const std::vector<int64_t> s = stats::snapshot();
+    CHECK(field(s, outer, stats::CALLS) == 10);
+    CHECK(field(s, outer, stats::BYTES_IN) == 8800);
+    CHECK(field(s, outer, stats::BYTES_OUT) == 400);
+    CHECK(field(s, outer, stats::PINNED) == 20);
+    CHECK(field(s, outer, stats::COPIED) == 10);
+    CHECK(field(s, outer, stats::COPIED_BYTES) == 800);
+    CHECK(field(s, outer, stats::MARSHAL_NS) == 0);
+    CHECK(histogramTotal(s, outer) == 10);
+    // 外层耗时包含内层
+    CHECK(field(s, outer, stats::TOTAL_NS) >= field(s, inner, stats::TOTAL_NS));
+
+    CHECK(field(s, inner, stats::CALLS) == 10);
+    CHECK(field(s, inner, stats::DIRECT) == 10);
+    CHECK(field(s, inner, stats::BYTES_IN) == 160);
+    CHECK(field(s, inner, stats::MARSHAL_NS) >= 0);
+    CHECK(field(s, inner, stats::MARSHAL_NS) <= field(s, inner, stats::TOTAL_NS));
+
+    CHECK(field(s, stats::kUnscoped, stats::COPIED_BYTES) == 1000);
+}
+
+void testThreadsAndReset() {
+    const int32_t name = stats::registerName("Test.threads");
+    stats::reset();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([name] {
+            for (int i = 0; i < 1000; i++) {
+                stats::KernelScope scope(name);
+                stats::recordArray(8, false);
+            }
+        });
+    }
+    // 线程运行中也可以读取快照，计数只增不减
+    const int64_t during = field(stats::snapshot(), name, stats::CALLS);
+    for (auto& t : threads) t.join();
+    CHECK(during >= 0 && during <= 4000);
+
+    // 已退出线程的计数并入全局
+    std::vector<int64_t> s = stats::snapshot();
+    CHECK(field(s, name, stats::CALLS) == 4000);
+    CHECK(field(s, name, stats::BYTES_IN) == 32000);
+    CHECK(histogramTotal(s, name) == 4000);
+
+    stats::reset();
+    s = stats::snapshot();
+    CHECK(field(s, name, stats::CALLS) == 0);
+    CHECK(histogramTotal(s, name) == 0);
+    {
+        stats::KernelScope scope(name);
+    }
+    CHECK(field(stats::snapshot(), name, stats::CALLS) == 1);
+
+    // 关闭后不计数
+    stats::setEnabled(false);
+    {
+        stats::KernelScope scope(name);
+        stats::recordArray(8, true);
+    }
+    stats::setEnabled(true);
+    s = stats::snapshot();
+    CHECK(field(s, name, stats::CALLS) == 1);
+    CHECK(field(s, name, stats::COPIED) == 0);
+}
+
+void testTrace() {
+    const int32_t name = stats::registerName("Test.traced");
+    {
+        // 未开启追踪时不记录事件
+        stats::KernelScope scope(name);
+    }
+    stats::startTrace(1000);
+    CHECK(stats::tracing());
+    for (int i = 0; i < 3; i++) {
+        stats::KernelScope scope(name);
+        stats::MarshalTimer timer;
+    }
+    std::vector<double> data(1 << 16, 1.0);
+    std::atomic<int64_t> touched{0};
+    parallel_for(0, static_cast<int64_t>(data.size()), [&](int64_t lo, int64_t hi) {
+        touched.fetch_add(hi - lo);
+    }, 1024);
+    CHECK(touched.load() == static_cast<int64_t>(data.size()));
+    std::string json = stats::stopTrace();
+    CHECK(!stats::tracing());
+
+    CHECK(json.compare(0, 15, "{\"traceEvents\":") == 0);
+    CHECK(countOf(json, "\"name\":\"Test.traced\"") == 3);
+    CHECK(countOf(json, "\"name\":\"JNI.marshal\"") == 3);
+    CHECK(countOf(json, "\"name\":\"ThreadPool.participate\"") >= 1);
+    CHECK(countOf(json, "andas-worker-") >= 1);
+    CHECK(json.find("\"dropped\":0") != std::string::npos);
+
+    // 超过容量的事件计入 dropped；再次导出时事件已清空
+    stats::startTrace(2);
+    for (int i = 0; i < 5; i++) stats::KernelScope scope(name);
+    json = stats::stopTrace();
+    CHECK(countOf(json, "\"name\":\"Test.traced\"") == 2);
+    CHECK(json.find("\"dropped\":3") != std::string::npos);
+    CHECK(countOf(stats::stopTrace(), "\"ph\":\"X\"") == 0);
+}
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testRegistry);
+    RUN_TEST(testScopes);
+    RUN_TEST(testThreadsAndReset);
+    RUN_TEST(testTrace);
+    return TEST_RESULT();
+}
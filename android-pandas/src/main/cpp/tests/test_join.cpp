@@ -0,0 +1,177 @@
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+#include "join_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+using Pairs = std::vector<std::pair<int32_t, int32_t>>;
+
+Pairs toPairs(const JoinOutput& out) {
+    Pairs pairs;
+    for (size_t i = 0; i < out.left.size(); i++) {
+        pairs.emplace_back(out.left[i], out.right.empty() ? -1 : out.right[i]);
+    }
+    return pairs;
+}
+
+// 参考实现：嵌套循环，输出顺序与 join_engine.h 中的约定一致
+Pairs nestedLoop(const std::vector<std::vector<int64_t>>& left, const std::vector<std::vector<int64_t>>& right,
+                 JoinType type) {
+    const int64_t nl = static_cast<int64_t>(left[0].size());
+    const int64_t nr = static_cast<int64_t>(right[0].size());
+    auto equal = [&](int64_t i, int64_t j) {
+        for (size_t c = 0; c < left.size(); c++) {
+            if (left[c][static_cast<size_t>(i)] != right[c][static_cast<size_t>(j)]) return false;
+        }
+        return true;
+    };
+    Pairs pairs;
+    if (type == JoinType::RIGHT) {
+        for (int64_t j = 0; j < nr; j++) {
+            bool any = false;
+            for (int64_t i = 0; i < nl; i++) {
+                if (equal(i, j)) {
+                    pairs.emplace_back(i, j);
+                    any = true;
+                }
+            }
+            if (!any) pairs.emplace_back(-1, j);
+        }
+        return pairs;
+    }
+    std::vector<bool> rightMatched(static_cast<size_t>(nr), false);
+    for (int64_t i = 0; i < nl; i++) {
+        bool any = false;
+        for (int64_t j = 0; j < nr; j++) {
+            if (!equal(i, j)) continue;
+            any = true;
+            rightMatched[static_cast<size_t>(j)] = true;
+            if (type != JoinType::SEMI && type != JoinType::ANTI) pairs.emplace_back(i, j);
+        }
+        if (type == JoinType::SEMI && any) pairs.emplace_back(i, -1);
+        if (type == JoinType::ANTI && !any) pairs.emplace_back(i, -1);
+        if ((type == JoinType::LEFT || type == JoinType::OUTER) && !any) pairs.emplace_back(i, -1);
+    }
+    if (type == JoinType::OUTER) {
+        for (int64_t j = 0; j < nr; j++) {
+            if (!rightMatched[static_cast<size_t>(j)]) pairs.emplace_back(-1, j);
+        }
+    }
+    return pairs;
+}
+
+std::vector<std::vector<int64_t>> makeKeys(int64_t n, int64_t cardinality, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<std::vector<int64_t>> keys(2, std::vector<int64_t>(static_cast<size_t>(n)));
+    for (int64_t i = 0; i < n; i++) {
+        keys[0][static_cast<size_t>(i)] = static_cast<int64_t>(rng() % static_cast<uint64_t>(cardinality)) * 1000003;
+        keys[1][static_cast<size_t>(i)] = static_cast<int64_t>(rng() % 2) - 1;
+    }
+    return keys;
+}
+
+JoinOutput runJoin(const std::vector<std::vector<int64_t>>& left, const std::vector<std::vector<int64_t>>& right,
+                   int32_t keyColumns, JoinType type) {
+    const int64_t* lk[] = {left[0].data(), left[1].data()};
+    const int64_t* rk[] = {right[0].data(), right[1].data()};
+    return hashJoin(lk, static_cast<int64_t>(left[0].size()), rk, static_cast<int64_t>(right[0].size()),
+                    keyColumns, type);
+}
+
+const JoinType kTypes[] = {JoinType::INNER, JoinType::LEFT, JoinType::RIGHT,
+                           JoinType::OUTER, JoinType::SEMI, JoinType::ANTI};
+
+void testSmallExample() {
+    std::vector<int64_t> l = {1, 2, 2, 3};
+    std::vector<int64_t> r = {2, 4, 1, 2};
+    const int64_t* lk[] = {l.data()};
+    const int64_t* rk[] = {r.data()};
+
+    JoinOutput inner = hashJoin(lk, 4, rk, 4, 1, JoinType::INNER);
+    CHECK(toPairs(inner) == Pairs({{0, 2}, {1, 0}, {1, 3}, {2, 0}, {2, 3}}));
+
+    JoinOutput left = hashJoin(lk, 4, rk, 4, 1, JoinType::LEFT);
+    CHECK(toPairs(left) == Pairs({{0, 2}, {1, 0}, {1, 3}, {2, 0}, {2, 3}, {3, -1}}));
+
+    JoinOutput right = hashJoin(lk, 4, rk, 4, 1, JoinType::RIGHT);
+    CHECK(toPairs(right) == Pairs({{1, 0}, {2, 0}, {-1, 1}, {0, 2}, {1, 3}, {2, 3}}));
+
+    JoinOutput outer = hashJoin(lk, 4, rk, 4, 1, JoinType::OUTER);
+    CHECK(toPairs(outer) == Pairs({{0, 2}, {1, 0}, {1, 3}, {2, 0}, {2, 3}, {3, -1}, {-1, 1}}));
+
+    JoinOutput semi = hashJoin(lk, 4, rk, 4, 1, JoinType::SEMI);
+    CHECK(semi.left == std::vector<int32_t>({0, 1, 2}));
+    CHECK(semi.right.empty());
+
+    JoinOutput anti = hashJoin(lk, 4, rk, 4, 1, JoinType::ANTI);
+    CHECK(anti.left == std::vector<int32_t>({3}));
+}
+
+void testEmptySides() {
+    std::vector<int64_t> l = {1, 2};
+    const int64_t* lk[] = {l.data()};
+    const int64_t* rk[] = {nullptr};
+    CHECK(hashJoin(lk, 2, rk, 0, 1, JoinType::INNER).left.empty());
+    CHECK(toPairs(hashJoin(lk, 2, rk, 0, 1, JoinType::LEFT)) == Pairs({{0, -1}, {1, -1}}));
+    CHECK(toPairs(hashJoin(rk, 0, lk, 2, 1, JoinType::OUTER)) == Pairs({{-1, 0}, {-1, 1}}));
+}
+
+void testMatchesNestedLoop() {
+    // 小规模：与嵌套循环逐项比较（含重复键、组合键）
+    auto left = makeKeys(700, 150, 11);
+    auto right = makeKeys(500, 150, 12);
+    for (JoinType type : kTypes) {
+        for (int32_t keyColumns = 1; keyColumns <= 2; keyColumns++) {
+            std::vector<std::vector<int64_t>> l(left.begin(), left.begin() + keyColumns);
+            std::vector<std::vector<int64_t>> r(right.begin(), right.begin() + keyColumns);
+            CHECK(toPairs(runJoin(left, right, keyColumns, type)) == nestedLoop(l, r, type));
+        }
+    }
+}
+
+void testPartitionedParallel() {
+    // 构建侧超过单个分区容量并走并行路径，结果应与串行一致
+    auto left = makeKeys(60000, 30000, 21);
+    auto right = makeKeys(40000, 30000, 22);
+    for (JoinType type : kTypes) {
+        JoinOutput parallel = runJoin(left, right, 2, type);
+        const int64_t threshold = parallelThreshold();
+        setParallelThreshold(INT64_MAX);
+        JoinOutput serial = runJoin(left, right, 2, type);
+        setParallelThreshold(threshold);
+        CHECK(parallel.left == serial.left);
+        CHECK(parallel.right == serial.right);
+    }
+
+    // 抽查 inner 结果的每一对键都相等，且 left+anti 覆盖全部左行
+    JoinOutput inner = runJoin(left, right, 2, JoinType::INNER);
+    bool allEqual = true;
+    for (size_t i = 0; i < inner.left.size(); i++) {
+        for (int c = 0; c < 2; c++) {
+            allEqual &= left[c][static_cast<size_t>(inner.left[i])] == right[c][static_cast<size_t>(inner.right[i])];
+        }
+    }
+    CHECK(allEqual);
+    JoinOutput semi = runJoin(left, right, 2, JoinType::SEMI);
+    JoinOutput anti = runJoin(left, right, 2, JoinType::ANTI);
+    CHECK(semi.left.size() + anti.left.size() == left[0].size());
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testSmallExample);
+    RUN_TEST(testEmptySides);
+    RUN_TEST(testMatchesNestedLoop);
+    RUN_TEST(testPartitionedParallel);
+    return TEST_RESULT();
+}
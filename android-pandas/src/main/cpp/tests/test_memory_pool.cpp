@@ -0,0 +1,223 @@
+#include <cstdint>
+#include <new>
+#include <vector>
+#include "memory_pool.h"
+#include "column_buffer.h"
+#include "sort_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+bool aligned(const void* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) % 64 == 0;
+}
+
+std::vector<double> shuffled(int64_t n) {
+    std::vector<double> x(static_cast<size_t>(n));
+    uint64_t state = 12345;
+    for (auto& v : x) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        v = static_cast<double>(state >> 40);
+    }
+    return x;
+}
+
+bool sortedBy(const std::vector<double>& x, const std::vector<int32_t>& order) {
+    for (size_t i = 1; i < order.size(); i++) {
+        if (x[static_cast<size_t>(order[i - 1])] > x[static_cast<size_t>(order[i])]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void testPoolReuse() {
+    trimMemory();
+    const MemoryStats before = memoryStats();
+    void* a = poolAlloc(1000);
+    CHECK(a != nullptr);
+    CHECK(aligned(a));
+    const MemoryStats held = memoryStats();
+    CHECK(held.current > before.current);
+    CHECK(held.peak >= held.current);
+
+    // 释放的块留在池中，同级别的下一次分配直接复用，用量不变
+    poolFree(a);
+    CHECK(memoryStats().poolCached > 0);
+    CHECK(memoryStats().current == held.current);
+    void* b = poolAlloc(1100);
+    CHECK(b == a);
+    CHECK(memoryStats().poolHits == held.poolHits + 1);
+    poolFree(b);
+
+    // 空分配也返回非空地址
+    void* zero = poolAlloc(0);
+    CHECK(zero != nullptr);
+    poolFree(zero);
+    poolFree(nullptr);
+
+    void* column = alignedAlloc(3);
+    CHECK(aligned(column));
+    alignedFree(column);
+
+    trimMemory();
+    CHECK(memoryStats().poolCached == 0);
+    CHECK(memoryStats().current == before.current);
+}
+
+void testLimit() {
+    trimMemory();
+    const int64_t base = memoryStats().current;
+    const int64_t failures = memoryStats().failures;
+
+    // 缓存的块也计入用量，超出上限时先归还缓存再重试
+    poolFree(poolAlloc(500000));
+    CHECK(memoryStats().poolCached == 524288);
+    setMemoryLimit(base + 524288 + 600000);
+    CHECK(memoryLimit() == base + 524288 + 600000);
+    void* big = poolAlloc(700000);
+    CHECK(memoryStats().poolCached == 0);
+    CHECK(memoryStats().failures == failures);
+
+    bool threw = false;
+    try {
+        poolAlloc(700000);
+    } catch (const MemoryLimitError& e) {
+        threw = std::string(e.what()).find("超出原生内存预算") != std::string::npos;
+    }
+    CHECK(threw);
+    CHECK(memoryStats().failures == failures + 1);
+
+    // 也能当作 std::bad_alloc 捕获
+    threw = false;
+    try {
+        alignedAlloc(size_t(1) << 24);
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    poolFree(big);
+    setMemoryLimit(0);
+    CHECK(memoryLimit() == 0);
+    void* ok = poolAlloc(size_t(1) << 24);
+    poolFree(ok);
+
+    resetPeakMemory();
+    trimMemory();
+    CHECK(memoryStats().peak >= memoryStats().current);
+    CHECK(memoryStats().current == base);
+}
+
+void testScratchArena() {
+    trimMemory();
+    const int64_t reservedBefore = memoryStats().arenaReserved;
+    const int32_t* first = nullptr;
+    {
+        ScratchBuffer<int32_t> a(100);
+        CHECK(aligned(a.data()));
+        CHECK(a.size() == 100);
+        first = a.data();
+        {
+            ScratchBuffer<double> b(10);
+            CHECK(aligned(b.data()));
+            CHECK(reinterpret_cast<const char*>(b.data()) >= reinterpret_cast<const char*>(a.data() + 100));
+        }
+        // 内层作用域结束后回退，同样的分配拿到同一个地址
+        ScratchBuffer<double> c(10);
+        ScratchBuffer<double> d(0);
+        CHECK(d.data() != nullptr);
+        CHECK(memoryStats().arenaReserved > reservedBefore);
+    }
+    {
+        ScratchBuffer<int32_t> again(100);
+        CHECK(again.data() == first);
+    }
+
+    // 一次操作用了很多临时内存，结束后只保留 kArenaRetainBytes
+    {
+        ScratchBuffer<uint8_t> small(1000);
+        ScratchBuffer<uint8_t> large(int64_t(8) << 20);
+        large[(int64_t(8) << 20) - 1] = 1;
+        CHECK(memoryStats().arenaReserved >= reservedBefore + (int64_t(8) << 20));
+    }
+    CHECK(memoryStats().arenaReserved <= reservedBefore + static_cast<int64_t>(kArenaRetainBytes));
+
+    // 分配失败后分配区仍然可用
+    setMemoryLimit(memoryStats().current + 4096);
+    bool threw = false;
+    try {
+        ScratchBuffer<double> tooLarge(int64_t(1) << 24);
+    } catch (const MemoryLimitError&) {
+        threw = true;
+    }
+    CHECK(threw);
+    setMemoryLimit(0);
+    {
+        ScratchBuffer<int32_t> after(100);
+        CHECK(after.data() == first);
+    }
+
+    trimMemory();
+    CHECK(memoryStats().arenaReserved <= reservedBefore);
+}
+
+void testPooledBuffer() {
+    trimMemory();
+    const int64_t base = memoryStats().current;
+    PooledBuffer<int64_t> a(1000);
+    CHECK(a.size() == 1000);
+    CHECK(aligned(a.data()));
+    a[999] = 7;
+    PooledBuffer<int64_t> b(std::move(a));
+    CHECK(a.data() == nullptr);
+    CHECK(b[999] == 7);
+    b.reset();
+    CHECK(b.data() == nullptr);
+    trimMemory();
+    CHECK(memoryStats().current == base);
+}
+
+void testParallelKernels() {
+    // 排序在各工作线程上使用临时分配区；超出预算时异常传回调用线程，之后仍可正常运行
+    const int64_t n = 300000;
+    const std::vector<double> x = shuffled(n);
+    std::vector<int32_t> order(static_cast<size_t>(n));
+    for (int round = 0; round < 3; round++) {
+        sortIndices(x.data(), n, false, false, order.data());
+        CHECK(sortedBy(x, order));
+    }
+
+    trimMemory();
+    setMemoryLimit(memoryStats().current + 64 * 1024);
+    bool threw = false;
+    try {
+        sortIndices(x.data(), n, false, false, order.data());
+    } catch (const MemoryLimitError&) {
+        threw = true;
+    }
+    CHECK(threw);
+    setMemoryLimit(0);
+
+    sortIndices(x.data(), n, true, false, order.data());
+    bool descending = true;
+    for (int64_t i = 1; i < n; i++) {
+        if (x[static_cast<size_t>(order[i - 1])] < x[static_cast<size_t>(order[i])]) descending = false;
+    }
+    CHECK(descending);
+}
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testPoolReuse);
+    RUN_TEST(testLimit);
+    RUN_TEST(testScratchArena);
+    RUN_TEST(testPooledBuffer);
+    RUN_TEST(testParallelKernels);
+    return TEST_RESULT();
+}
@@ -0,0 +1,170 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include "math_kernels.h"
+#include "moments.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// long double 两遍扫描的参考值
+struct Reference {
+    int64_t count = 0;
+    long double mean = 0.0L;
+    long double m2 = 0.0L;
+    long double m3 = 0.0L;
+    long double m4 = 0.0L;
+};
+
+Reference reference(const std::vector<double>& x) {
+    Reference r;
+    long double sum = 0.0L;
+    for (double v : x) {
+        if (std::isnan(v)) continue;
+        sum += v;
+        r.count++;
+    }
+    r.mean = sum / r.count;
+    for (double v : x) {
+        if (std::isnan(v)) continue;
+        const long double d = v - r.mean;
+        r.m2 += d * d;
+        r.m3 += d * d * d;
+        r.m4 += d * d * d * d;
+    }
+    return r;
+}
+
+bool relClose(double actual, long double expected, double tolerance) {
+    return std::fabs(actual - static_cast<double>(expected)) <=
+           tolerance * std::max(1.0, std::fabs(static_cast<double>(expected)));
+}
+
+std::vector<double> skewedValues(int64_t n, uint64_t seed, double offset) {
+    std::mt19937_64 rng(seed);
+    std::exponential_distribution<double> dist(0.5);
+    std::vector<double> x(static_cast<size_t>(n));
+    for (auto& v : x) v = rng() % 17 == 0 ? kNaN : offset + dist(rng);
+    return x;
+}
+
+void testMatchesReference() {
+    // 均值远离 0 的偏态数据，覆盖块边界、线程分块和 NaN
+    for (int64_t n : {int64_t(1), int64_t(5), int64_t(513), int64_t(100003)}) {
+        const std::vector<double> x = skewedValues(n, static_cast<uint64_t>(n), 1e6);
+        const Reference r = reference(x);
+        const MomentAccumulator m = computeMoments(x.data(), n, MomentOrder::SHAPE);
+        CHECK(m.count == r.count);
+        CHECK(relClose(m.mean, r.mean, 1e-14));
+        if (r.count < 2) continue;
+        const long double var = r.m2 / (r.count - 1);
+        CHECK(relClose(m.variance(1), var, 1e-9));
+        if (r.count < 4) continue;
+        const long double nn = r.count;
+        const long double skew = nn * std::sqrt(nn - 1) * r.m3 / ((nn - 2) * std::pow(r.m2, 1.5L));
+        const long double kurt = nn * (nn + 1) * (nn - 1) * r.m4 / ((nn - 2) * (nn - 3) * r.m2 * r.m2)
+                                 - 3 * (nn - 1) * (nn - 1) / ((nn - 2) * (nn - 3));
+        CHECK(relClose(m.skewness(), skew, 1e-7));
+        CHECK(relClose(m.kurtosis(), kurt, 1e-7));
+    }
+}
+
+void testCancellation() {
+    // sumSq/n - mean^2 在这组数据上完全失效：真实样本方差为 30
+    const int64_t n = 1000000;
+    std::vector<double> x(static_cast<size_t>(n));
+    const double pattern[] = {4.0, 7.0, 13.0, 16.0};
+    for (int64_t i = 0; i < n; i++) x[static_cast<size_t>(i)] = 1e9 + pattern[i % 4];
+    CHECK_NEAR(variance(x.data(), n, 0), 22.5, 1e-6);
+    CHECK_NEAR(variance(x.data(), n, 1), 22.5 * n / (n - 1), 1e-6);
+    CHECK_NEAR(mean(x.data(), n), 1e9 + 10.0, 1e-6);
+
+    // 全部相等时方差、偏度、峰度精确为 0
+    std::vector<double> flat(5000, 0.1 + 1e6);
+    const MomentAccumulator m = computeMoments(flat.data(), 5000, MomentOrder::SHAPE);
+    CHECK(m.variance(1) == 0.0);
+    CHECK(m.skewness() == 0.0);
+    CHECK(m.kurtosis() == 0.0);
+}
+
+void testMerge() {
+    // 逐个加入、任意分组合并与并行计算的结果一致
+    const int64_t n = 20000;
+    const std::vector<double> x = skewedValues(n, 3, -250.0);
+    const MomentAccumulator whole = computeMoments(x.data(), n, MomentOrder::SHAPE);
+
+    MomentAccumulator single;
+    for (double v : x) single.add(v);
+
+    std::mt19937_64 rng(9);
+    MomentAccumulator merged;
+    int64_t from = 0;
+    while (from < n) {
+        const int64_t to = std::min(n, from + 1 + static_cast<int64_t>(rng() % 3000));
+        MomentAccumulator part = computeMoments(x.data() + from, to - from, MomentOrder::SHAPE);
+        // 右侧合并与左侧合并交替进行
+        if (rng() % 2 == 0) {
+            merged.merge(part);
+        } else {
+            part.merge(merged);
+            merged = part;
+        }
+        from = to;
+    }
+
+    for (const MomentAccumulator* m : {&single, &merged}) {
+        CHECK(m->count == whole.count);
+        CHECK_NEAR(m->total(), whole.total(), 1e-9 * std::fabs(whole.total()));
+        CHECK_NEAR(m->variance(1), whole.variance(1), 1e-10 * whole.variance(1));
+        CHECK_NEAR(m->skewness(), whole.skewness(), 1e-9);
+        CHECK_NEAR(m->kurtosis(), whole.kurtosis(), 1e-8);
+        CHECK(m->min == whole.min && m->max == whole.max);
+    }
+
+    const int64_t threshold = parallelThreshold();
+    setParallelThreshold(n + 1);
+    const MomentAccumulator serial = computeMoments(x.data(), n, MomentOrder::SHAPE);
+    setParallelThreshold(threshold);
+    CHECK_NEAR(serial.variance(1), whole.variance(1), 1e-10 * whole.variance(1));
+}
+
+void testSmallCounts() {
+    const double x[] = {kNaN, 2.0, kNaN, 4.0, 9.0};
+    const MomentAccumulator m = computeMoments(x, 5, MomentOrder::SHAPE);
+    CHECK(m.count == 3);
+    CHECK(m.total() == 15.0);
+    CHECK(m.min == 2.0 && m.max == 9.0);
+    CHECK(std::isnan(m.variance(3)));
+    CHECK(std::isnan(m.kurtosis()));
+    CHECK(!std::isnan(m.skewness()));
+
+    const MomentAccumulator empty = computeMoments(x, 1, MomentOrder::SHAPE);
+    CHECK(empty.count == 0);
+    CHECK(std::isnan(empty.variance(0)));
+    double packed[MomentAccumulator::kPackedSize];
+    empty.pack(packed);
+    CHECK(packed[0] == 0.0 && std::isnan(packed[6]) && std::isnan(packed[7]));
+
+    const double withInf[] = {1.0, INFINITY, 2.0};
+    CHECK(sum(withInf, 3) == INFINITY);
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testMatchesReference);
+    RUN_TEST(testCancellation);
+    RUN_TEST(testMerge);
+    RUN_TEST(testSmallCounts);
+    return TEST_RESULT();
+}
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "pipeline_engine.h"
+#include "filter_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// 可复现的输入：a 在 [0, 1) 内，b 每 7 行一个缺失值
+struct Inputs {
+    std::vector<double> a;
+    std::vector<double> b;
+    const double* columns[2];
+
+    explicit Inputs(int64_t n) : a(static_cast<size_t>(n)), b(static_cast<size_t>(n)) {
+        uint64_t state = 2024;
+        for (int64_t i = 0; i < n; i++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            a[static_cast<size_t>(i)] = static_cast<double>(state >> 11) / 9007199254740992.0;
+            b[static_cast<size_t>(i)] = i % 7 == 0 ? kNaN : static_cast<double>(i % 100);
+        }
+        columns[0] = a.data();
+        columns[1] = b.data();
+    }
+};
+
+bool sameValue(double x, double y) {
+    return (std::isnan(x) && std::isnan(y)) || std::fabs(x - y) <= 1e-12 * std::max(1.0, std::fabs(y));
+}
+
+// (a + fillnull(b, -1)) * 2
+const ExprInstruction kSumTimesTwo[] = {
+    {ExprOp::COLUMN, 0}, {ExprOp::COLUMN, 1}, {ExprOp::CONST, 0}, {ExprOp::FILL_NULL, 0},
+    {ExprOp::ADD, 0}, {ExprOp::CONST, 1}, {ExprOp::MUL, 0},
+};
+// -(b / a)
+const ExprInstruction kNegRatio[] = {
+    {ExprOp::COLUMN, 1}, {ExprOp::COLUMN, 0}, {ExprOp::DIV, 0}, {ExprOp::NEG, 0},
+};
+const double kConstants[] = {-1.0, 2.0, 0.5, 10.0};
+
+double sumTimesTwo(double a, double b) {
+    return (a + (std::isnan(b) ? -1.0 : b)) * 2.0;
+}
+
+// a > 0.5 AND b IS NOT NULL
+struct HalfFilter {
+    FilterColumn columns[2];
+    FilterInstruction instructions[3];
+    double doubles[1] = {0.5};
+    int64_t longs[1] = {0};
+    FilterProgram program;
+
+    explicit HalfFilter(const Inputs& in)
+        : columns{{FilterColumnType::FLOAT64, in.a.data()}, {FilterColumnType::FLOAT64, in.b.data()}},
+          instructions{{FilterOp::GT, 0, 0, 0}, {FilterOp::NOT_NULL, 1, 0, 0}, {FilterOp::AND, 0, 0, 0}},
+          program{columns, 2, instructions, 3, doubles, longs, 1} {}
+};
+
+PipelineSpec specOf(const Inputs& in, const ExprProgram* outputs, int32_t count, const FilterProgram* filter) {
+    return PipelineSpec{in.columns, 2, filter, outputs, count, kConstants, 4};
+}
+
+} // namespace
+
+void testExpressions() {
+    const int64_t n = 3 * kMorselRows + 123;
+    const Inputs in(n);
+    const ExprProgram outputs[] = {{kSumTimesTwo, 7}, {kNegRatio, 4}};
+    const PipelineSpec spec = specOf(in, outputs, 2, nullptr);
+    CHECK(validatePipeline(spec) == nullptr);
+
+    const PipelineResult result = runPipeline(spec, n);
+    CHECK(result.rowCount == n);
+    CHECK(result.rows.empty());
+    CHECK(result.columns.size() == 2);
+    bool ok = true;
+    for (int64_t i = 0; i < n; i++) {
+        const double a = in.a[static_cast<size_t>(i)];
+        const double b = in.b[static_cast<size_t>(i)];
+        ok = ok && sameValue(result.columns[0][static_cast<size_t>(i)], sumTimesTwo(a, b));
+        ok = ok && sameValue(result.columns[1][static_cast<size_t>(i)], -(b / a));
+    }
+    CHECK(ok);
+
+    // 没有行时只返回空列
+    const PipelineResult empty = runPipeline(spec, 0);
+    CHECK(empty.rowCount == 0);
+    CHECK(empty.columns.size() == 2 && empty.columns[0].empty());
+}
+
+void testFilterFusion() {
+    const int64_t n = 10 * kMorselRows + 77;
+    const Inputs in(n);
+    const HalfFilter filter(in);
+    CHECK(validateFilter(filter.program) == nullptr);
+    const ExprProgram outputs[] = {{kSumTimesTwo, 7}};
+    const PipelineSpec spec = specOf(in, outputs, 1, &filter.program);
+
+    // 与先求整列位图再逐行计算的结果一致
+    std::vector<uint64_t> bits(static_cast<size_t>((n + 63) / 64));
+    evaluateFilter(filter.program, n, bits.data());
+    const std::vector<int32_t> expectedRows = selectedRows(bits.data(), n);
+
+    const PipelineResult result = runPipeline(spec, n);
+    CHECK(result.rowCount == static_cast<int64_t>(expectedRows.size()));
+    CHECK(result.rows == expectedRows);
+    CHECK(result.columns[0].size() == expectedRows.size());
+    bool ok = true;
+    for (size_t k = 0; k < expectedRows.size(); k++) {
+        const size_t i = static_cast<size_t>(expectedRows[k]);
+        ok = ok && sameValue(result.columns[0][k], sumTimesTwo(in.a[i], in.b[i]));
+        ok = ok && in.a[i] > 0.5 && !std::isnan(in.b[i]);
+    }
+    CHECK(ok);
+
+    // 筛选后没有输出表达式时只返回行号
+    const PipelineSpec rowsOnly = specOf(in, nullptr, 0, &filter.program);
+    const PipelineResult selected = runPipeline(rowsOnly, n);
+    CHECK(selected.rows == expectedRows);
+    CHECK(selected.columns.empty());
+}
+
+void testMomentsAndNormalize() {
+    const int64_t n = 5 * kMorselRows + 9;
+    const Inputs in(n);
+    const HalfFilter filter(in);
+    const ExprProgram outputs[] = {{kSumTimesTwo, 7}};
+    const PipelineSpec spec = specOf(in, outputs, 1, &filter.program);
+
+    // 选中行上的矩与物化后直接计算的一致
+    const PipelineResult materialized = runPipeline(spec, n);
+    const MomentAccumulator expected = computeMoments(materialized.columns[0].data(), materialized.rowCount,
+                                                      MomentOrder::VARIANCE);
+    const std::vector<MomentAccumulator> moments = pipelineMoments(spec, n);
+    CHECK(moments.size() == 1);
+    CHECK(moments[0].count == expected.count);
+    CHECK_NEAR(moments[0].mean, expected.mean, 1e-9);
+    CHECK_NEAR(moments[0].variance(0), expected.variance(0), 1e-6);
+
+    // 用统计量归一化，结果的均值为 0、总体标准差为 1
+    const double normalizeConstants[] = {-1.0, 2.0, moments[0].mean, moments[0].stddev(0)};
+    const ExprInstruction normalized[] = {
+        {ExprOp::COLUMN, 0}, {ExprOp::COLUMN, 1}, {ExprOp::CONST, 0}, {ExprOp::FILL_NULL, 0},
+        {ExprOp::ADD, 0}, {ExprOp::CONST, 1}, {ExprOp::MUL, 0}, {ExprOp::NORMALIZE, 2},
+    };
+    const ExprProgram normalizedOutput[] = {{normalized, 8}};
+    const PipelineSpec normalizeSpec{in.columns, 2, &filter.program, normalizedOutput, 1, normalizeConstants, 4};
+    CHECK(validatePipeline(normalizeSpec) == nullptr);
+    const PipelineResult result = runPipeline(normalizeSpec, n);
+    const MomentAccumulator check = computeMoments(result.columns[0].data(), result.rowCount, MomentOrder::VARIANCE);
+    CHECK_NEAR(check.mean, 0.0, 1e-9);
+    CHECK_NEAR(check.stddev(0), 1.0, 1e-9);
+
+    // 标准差为 0 时非缺失值为 0，缺失值保持缺失
+    const double constantConstants[] = {3.0, 0.0};
+    const ExprInstruction constantNormalize[] = {{ExprOp::COLUMN, 1}, {ExprOp::NORMALIZE, 0}};
+    const ExprProgram constantOutput[] = {{constantNormalize, 2}};
+    const PipelineSpec constantSpec{in.columns, 2, nullptr, constantOutput, 1, constantConstants, 2};
+    const PipelineResult zero = runPipeline(constantSpec, 20);
+    CHECK(std::isnan(zero.columns[0][0]));
+    CHECK(zero.columns[0][1] == 0.0);
+}
+
+void testFunctionsAndComparisons() {
+    const int64_t n = 4 * kMorselRows + 31;
+    const Inputs in(n);
+    const double constants[] = {1.0, 2.0, 50.0, 10.0, 60.0, 0.5, 3.0, 90.0, 1.5, kNaN};
+    // log(a + 1) * 2 + exp(-a) * sin(b)
+    const ExprInstruction transcendental[] = {
+        {ExprOp::COLUMN, 0}, {ExprOp::CONST, 0}, {ExprOp::ADD, 0}, {ExprOp::LOG, 0}, {ExprOp::CONST, 1},
+        {ExprOp::MUL, 0}, {ExprOp::COLUMN, 0}, {ExprOp::NEG, 0}, {ExprOp::EXP, 0}, {ExprOp::COLUMN, 1},
+        {ExprOp::SIN, 0}, {ExprOp::MUL, 0}, {ExprOp::ADD, 0},
+    };
+    // where(b > 50, clip(b, 10, 60), -a)
+    const ExprInstruction conditional[] = {
+        {ExprOp::COLUMN, 1}, {ExprOp::CONST, 2}, {ExprOp::GT, 0}, {ExprOp::COLUMN, 1}, {ExprOp::CONST, 3},
+        {ExprOp::CONST, 4}, {ExprOp::CLIP, 0}, {ExprOp::COLUMN, 0}, {ExprOp::NEG, 0}, {ExprOp::WHERE, 0},
+    };
+    // (a < 0.5 & !(b == 3)) | b >= 90
+    const ExprInstruction logical[] = {
+        {ExprOp::COLUMN, 0}, {ExprOp::CONST, 5}, {ExprOp::LT, 0}, {ExprOp::COLUMN, 1}, {ExprOp::CONST, 6},
+        {ExprOp::EQ, 0}, {ExprOp::NOT, 0}, {ExprOp::AND, 0}, {ExprOp::COLUMN, 1}, {ExprOp::CONST, 7},
+        {ExprOp::GE, 0}, {ExprOp::OR, 0},
+    };
+    // sqrt(abs(cos(b))) + pow(a, 1.5) + clip(a, NaN, 0.5)
+    const ExprInstruction misc[] = {
+        {ExprOp::COLUMN, 1}, {ExprOp::COS, 0}, {ExprOp::ABS, 0}, {ExprOp::SQRT, 0}, {ExprOp::COLUMN, 0},
+        {ExprOp::CONST, 8}, {ExprOp::POW, 0}, {ExprOp::ADD, 0}, {ExprOp::COLUMN, 0}, {ExprOp::CONST, 9},
+        {ExprOp::CONST, 5}, {ExprOp::CLIP, 0}, {ExprOp::ADD, 0},
+    };
+    const ExprProgram outputs[] = {{transcendental, 13}, {conditional, 10}, {logical, 12}, {misc, 13}};
+    const PipelineSpec spec{in.columns, 2, nullptr, outputs, 4, constants, 10};
+    CHECK(validatePipeline(spec) == nullptr);
+    const PipelineResult result = runPipeline(spec, n);
+
+    bool ok = true;
+    for (int64_t i = 0; i < n; i++) {
+        const size_t r = static_cast<size_t>(i);
+        const double a = in.a[r];
+        const double b = in.b[r];
+        const double expected0 = std::log(a + 1.0) * 2.0 + std::exp(-a) * std::sin(b);
+        const double expected1 = std::isnan(b) ? kNaN : (b > 50.0 ? std::min(std::max(b, 10.0), 60.0) : -a);
+        const double expected2 = std::isnan(b) ? kNaN : ((a < 0.5 && b != 3.0) || b >= 90.0 ? 1.0 : 0.0);
+        const double expected3 = std::sqrt(std::fabs(std::cos(b))) + std::pow(a, 1.5) + std::min(a, 0.5);
+        ok = ok && sameValue(result.columns[0][r], expected0);
+        ok = ok && sameValue(result.columns[1][r], expected1);
+        ok = ok && sameValue(result.columns[2][r], expected2);
+        ok = ok && sameValue(result.columns[3][r], expected3);
+    }
+    CHECK(ok);
+
+    // 缺失值参与比较和逻辑运算时结果仍为缺失值，WHERE 的条件为 NaN 时同样
+    const double x[] = {kNaN, 1.0, 0.0};
+    const double* columns[] = {x};
+    const double logicConstants[] = {0.0};
+    const ExprInstruction notEqual[] = {{ExprOp::COLUMN, 0}, {ExprOp::CONST, 0}, {ExprOp::NE, 0}};
+    const ExprInstruction orTrue[] = {{ExprOp::COLUMN, 0}, {ExprOp::COLUMN, 0}, {ExprOp::NOT, 0}, {ExprOp::OR, 0}};
+    const ExprProgram small[] = {{notEqual, 3}, {orTrue, 4}};
+    const PipelineResult edge = runPipeline(PipelineSpec{columns, 1, nullptr, small, 2, logicConstants, 1}, 3);
+    CHECK(std::isnan(edge.columns[0][0]) && edge.columns[0][1] == 1.0 && edge.columns[0][2] == 0.0);
+    CHECK(std::isnan(edge.columns[1][0]) && edge.columns[1][1] == 1.0 && edge.columns[1][2] == 1.0);
+}
+
+void testValidation() {
+    const Inputs in(10);
+    auto check = [&](std::vector<ExprInstruction> code, int32_t constantCount, const std::string& message) {
+        const ExprProgram output{code.data(), static_cast<int32_t>(code.size())};
+        const PipelineSpec spec{in.columns, 2, nullptr, &output, 1, kConstants, constantCount};
+        const char* error = validatePipeline(spec);
+        CHECK(error != nullptr && message == error);
+    };
+    check({}, 4, "表达式为空");
+    check({{ExprOp::COLUMN, 2}}, 4, "表达式输入列下标越界");
+    check({{ExprOp::CONST, 4}}, 4, "表达式常量下标越界");
+    check({{ExprOp::COLUMN, 0}, {ExprOp::ADD, 0}}, 4, "表达式指令缺少操作数");
+    check({{ExprOp::NEG, 0}}, 4, "表达式指令缺少操作数");
+    check({{ExprOp::COLUMN, 0}, {ExprOp::NORMALIZE, 3}}, 4, "表达式常量下标越界");
+    check({{ExprOp::COLUMN, 0}, {ExprOp::COLUMN, 1}}, 4, "表达式没有组合成单个值");
+    check({{static_cast<ExprOp>(99), 0}}, 4, "不支持的表达式操作");
+    check({{ExprOp::COLUMN, 0}, {ExprOp::COLUMN, 1}, {ExprOp::CLIP, 0}}, 4, "表达式指令缺少操作数");
+    check({{ExprOp::COLUMN, 0}, {ExprOp::WHERE, 0}}, 4, "表达式指令缺少操作数");
+    CHECK(isValidExprOp(static_cast<int32_t>(ExprOp::NOT)));
+    CHECK(!isValidExprOp(static_cast<int32_t>(ExprOp::NOT) + 1));
+    CHECK(exprOpArity(ExprOp::POW) == 2 && exprOpArity(ExprOp::SIN) == 1 && exprOpArity(ExprOp::CLIP) == 3);
+}
+
+void testParallelMatchesSerial() {
+    const int64_t n = 40 * kMorselRows + 5;
+    const Inputs in(n);
+    const HalfFilter filter(in);
+    const ExprProgram outputs[] = {{kSumTimesTwo, 7}, {kNegRatio, 4}};
+    const PipelineSpec spec = specOf(in, outputs, 2, &filter.program);
+
+    const PipelineResult parallel = runPipeline(spec, n);
+    const std::vector<MomentAccumulator> parallelMoments = pipelineMoments(spec, n);
+    ThreadPool::instance().setThreadCount(1);
+    const PipelineResult serial = runPipeline(spec, n);
+    const std::vector<MomentAccumulator> serialMoments = pipelineMoments(spec, n);
+    ThreadPool::instance().setThreadCount(4);
+
+    CHECK(parallel.rows == serial.rows);
+    CHECK(parallel.columns[0] == serial.columns[0]);
+    CHECK(parallel.columns[1].size() == serial.columns[1].size());
+    bool same = true;
+    for (size_t i = 0; i < serial.columns[1].size(); i++) same = same && sameValue(parallel.columns[1][i], serial.columns[1][i]);
+    CHECK(same);
+    CHECK(parallelMoments[0].count == serialMoments[0].count);
+    CHECK_NEAR(parallelMoments[0].mean, serialMoments[0].mean, 1e-9);
+}
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testExpressions);
+    RUN_TEST(testFilterFusion);
+    RUN_TEST(testMomentsAndNormalize);
+    RUN_TEST(testFunctionsAndComparisons);
+    RUN_TEST(testValidation);
+    RUN_TEST(testParallelMatchesSerial);
+    return TEST_RESULT();
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include "rolling_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// 逐窗口直接计算的参考实现
+double referenceAt(const std::vector<double>& x, RollingOp op, const RollingWindow& w, int64_t i) {
+    int64_t start;
+    int64_t end;
+    windowBounds(w, static_cast<int64_t>(x.size()), i, &start, &end);
+    std::vector<double> values;
+    for (int64_t j = start; j < end; j++) {
+        if (!std::isnan(x[static_cast<size_t>(j)])) values.push_back(x[static_cast<size_t>(j)]);
+    }
+    const int64_t count = static_cast<int64_t>(values.size());
+    if (count < w.minPeriods) return kNaN;
+    long double sum = 0.0L;
+    for (double v : values) sum += v;
+    switch (op) {
+        case RollingOp::COUNT: return static_cast<double>(count);
+        case RollingOp::SUM: return static_cast<double>(sum);
+        case RollingOp::MEAN: return count > 0 ? static_cast<double>(sum / count) : kNaN;
+        case RollingOp::VAR:
+        case RollingOp::STD: {
+            if (count < 2) return kNaN;
+            const long double mean = sum / count;
+            long double ss = 0.0L;
+            for (double v : values) ss += (v - mean) * (v - mean);
+            const double var = static_cast<double>(ss / (count - 1));
+            return op == RollingOp::VAR ? var : std::sqrt(var);
+        }
+        case RollingOp::MIN:
+            return count > 0 ? *std::min_element(values.begin(), values.end()) : kNaN;
+        case RollingOp::MAX:
+            return count > 0 ? *std::max_element(values.begin(), values.end()) : kNaN;
+        case RollingOp::MEDIAN: {
+            if (count == 0) return kNaN;
+            std::sort(values.begin(), values.end());
+            const size_t mid = values.size() / 2;
+            return values.size() % 2 == 1 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+        }
+    }
+    return kNaN;
+}
+
+bool close(double actual, double expected) {
+    if (std::isnan(expected)) return std::isnan(actual);
+    return std::fabs(actual - expected) <= 1e-9 * std::max(1.0, std::fabs(expected));
+}
+
+std::vector<double> randomValues(int64_t n, uint64_t seed, int nullEvery) {
+    std::mt19937_64 rng(seed);
+    std::vector<double> x(static_cast<size_t>(n));
+    for (auto& v : x) {
+        // 少量重复值，覆盖中位数和单调队列的相等情况
+        v = rng() % nullEvery == 0 ? kNaN : static_cast<double>(rng() % 40) * 0.25 + 1e6;
+    }
+    return x;
+}
+
+void testMatchesReference() {
+    const std::vector<double> x = randomValues(300, 5, 7);
+    const int64_t n = static_cast<int64_t>(x.size());
+    std::vector<double> out(x.size());
+    for (int32_t op = 0; op <= static_cast<int32_t>(RollingOp::MEDIAN); op++) {
+        for (int64_t window : {1, 2, 5, 16}) {
+            for (bool center : {false, true}) {
+                for (int64_t minPeriods : {int64_t(0), int64_t(1), window}) {
+                    const RollingWindow w{window, minPeriods, center, false};
+                    rolling(x.data(), n, static_cast<RollingOp>(op), w, 0, n, out.data());
+                    bool ok = true;
+                    for (int64_t i = 0; i < n; i++) {
+                        ok = ok && close(out[static_cast<size_t>(i)], referenceAt(x, static_cast<RollingOp>(op), w, i));
+                    }
+                    CHECK(ok);
+                }
+            }
+        }
+        const RollingWindow expanding{0, 1, false, true};
+        rolling(x.data(), n, static_cast<RollingOp>(op), expanding, 0, n, out.data());
+        bool ok = true;
+        for (int64_t i = 0; i < n; i++) {
+            ok = ok && close(out[static_cast<size_t>(i)], referenceAt(x, static_cast<RollingOp>(op), expanding, i));
+        }
+        CHECK(ok);
+    }
+}
+
+void testWindowBounds() {
+    // 与 pandas 一致：window=4 居中时窗口为 [i-2, i+1]
+    const RollingWindow w{4, 1, true, false};
+    int64_t start;
+    int64_t end;
+    windowBounds(w, 10, 5, &start, &end);
+    CHECK(start == 3 && end == 7);
+    windowBounds(w, 10, 0, &start, &end);
+    CHECK(start == 0 && end == 2);
+    windowBounds(w, 10, 9, &start, &end);
+    CHECK(start == 7 && end == 10);
+
+    const std::vector<double> x = {1.0, 2.0, kNaN, 4.0, 5.0};
+    std::vector<double> out(5);
+    const RollingWindow mean2{2, 2, false, false};
+    rolling(x.data(), 5, RollingOp::MEAN, mean2, 0, 5, out.data());
+    CHECK(std::isnan(out[0]) && out[1] == 1.5 && std::isnan(out[2]) && std::isnan(out[3]) && out[4] == 4.5);
+}
+
+void testSegmentsAndRange() {
+    // 超过分段大小和并行阈值：并行与串行结果逐位相同，抽样与参考实现一致
+    const int64_t n = 300000;
+    const std::vector<double> x = randomValues(n, 11, 50);
+    for (RollingOp op : {RollingOp::SUM, RollingOp::STD, RollingOp::MAX, RollingOp::MEDIAN}) {
+        const RollingWindow w{1000, 10, true, false};
+        std::vector<double> parallel(static_cast<size_t>(n));
+        std::vector<double> serial(static_cast<size_t>(n));
+        rolling(x.data(), n, op, w, 0, n, parallel.data());
+        const int64_t threshold = parallelThreshold();
+        setParallelThreshold(n + 1);
+        rolling(x.data(), n, op, w, 0, n, serial.data());
+        setParallelThreshold(threshold);
+        bool same = true;
+        for (int64_t i = 0; i < n; i++) {
+            const double a = parallel[static_cast<size_t>(i)];
+            const double b = serial[static_cast<size_t>(i)];
+            same = same && (a == b || (std::isnan(a) && std::isnan(b)));
+        }
+        CHECK(same);
+        for (int64_t i : {int64_t(0), int64_t(499), int64_t(65535), int64_t(65536), int64_t(200001), n - 1}) {
+            CHECK(close(parallel[static_cast<size_t>(i)], referenceAt(x, op, w, i)));
+        }
+
+        // 只计算部分行，与整体计算一致
+        std::vector<double> part(100);
+        rolling(x.data(), n, op, w, 150000, 150100, part.data());
+        for (int64_t i = 0; i < 100; i++) {
+            CHECK(close(part[static_cast<size_t>(i)], parallel[static_cast<size_t>(150000 + i)]));
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testMatchesReference);
+    RUN_TEST(testWindowBounds);
+    RUN_TEST(testSegmentsAndRange);
+    return TEST_RESULT();
+}
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <set>
+#include <vector>
+#include "groupby_engine.h"
+#include "sampling.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+// 完整排列上的 Fisher–Yates 前 k 步，作为两种实现路径的参考
+std::vector<int64_t> referenceSample(int64_t n, int64_t k, uint64_t seed) {
+    Xoshiro256 rng(seed);
+    std::vector<int64_t> permutation(static_cast<size_t>(n));
+    std::iota(permutation.begin(), permutation.end(), 0);
+    for (int64_t i = 0; i < k; i++) {
+        std::swap(permutation[i], permutation[i + static_cast<int64_t>(rng.below(static_cast<uint64_t>(n - i)))]);
+    }
+    permutation.resize(static_cast<size_t>(k));
+    return permutation;
+}
+
+} // namespace
+
+void testGenerator() {
+    // 与 Kotlin 侧 SamplingTest 使用相同的参考值
+    Xoshiro256 rng(42);
+    CHECK(rng.next() == 1546998764402558742ULL);
+    CHECK(rng.next() == 6990951692964543102ULL);
+    CHECK(rng.next() == 12544586762248559009ULL);
+    CHECK(deriveSeed(42, 0) == 4340728156303693306ULL);
+
+    // below 无取模偏差：bound 为 3 时各值频率接近 1/3
+    Xoshiro256 small(1);
+    int64_t counts[3] = {0, 0, 0};
+    const int64_t draws = 300000;
+    for (int64_t i = 0; i < draws; i++) counts[small.below(3)]++;
+    for (int64_t c : counts) CHECK_NEAR(static_cast<double>(c) / draws, 1.0 / 3.0, 0.005);
+
+    double minU = 1.0;
+    double maxU = 0.0;
+    for (int i = 0; i < 100000; i++) {
+        const double u = small.uniform();
+        minU = std::min(minU, u);
+        maxU = std::max(maxU, u);
+    }
+    CHECK(minU > 0.0 && maxU < 1.0);
+}
+
+void testSampleIndices() {
+    const std::vector<int64_t> sparse = sampleIndices(1000000, 5, 7);
+    CHECK((sparse == std::vector<int64_t>{475994, 515067, 406320, 994628, 453924}));
+
+    // 稀疏（哈希表）与稠密（完整排列）两条路径都与参考实现一致
+    for (int64_t n : {1, 10, 1000, 100000}) {
+        for (int64_t k : {int64_t{0}, int64_t{1}, n / 10, n / 4, n / 2, n}) {
+            CHECK(sampleIndices(n, k, 99) == referenceSample(n, k, 99));
+        }
+    }
+    CHECK(sampleIndices(10, 20, 7).size() == 10);
+    CHECK(sampleIndices(0, 5, 7).empty());
+
+    const std::vector<int64_t> big = sampleIndices(1000000, 10000, 3);
+    std::set<int64_t> distinct(big.begin(), big.end());
+    CHECK(distinct.size() == big.size());
+    CHECK(*distinct.begin() >= 0 && *distinct.rbegin() < 1000000);
+
+    // 每个位置被抽中的概率为 k / n
+    std::vector<int64_t> hits(20, 0);
+    const int trials = 20000;
+    for (int t = 0; t < trials; t++) {
+        for (int64_t i : sampleIndices(20, 5, static_cast<uint64_t>(t))) hits[i]++;
+    }
+    for (int64_t h : hits) CHECK_NEAR(static_cast<double>(h) / trials, 0.25, 0.015);
+}
+
+void testWeightedSample() {
+    const double weights[6] = {1.0, 2.0, 0.0, 3.0, -1.0, 4.0};
+    CHECK((weightedSampleIndices(weights, 6, 3, 11) == std::vector<int32_t>{5, 3, 1}));
+    // 非正权重的行永远不会被选中
+    const std::vector<int32_t> all = weightedSampleIndices(weights, 6, 10, 11);
+    CHECK(all.size() == 4);
+    for (int32_t row : all) CHECK(weights[row] > 0.0);
+
+    // 取 1 行时被选中的概率与权重成正比
+    std::vector<int64_t> hits(6, 0);
+    const int trials = 40000;
+    for (int t = 0; t < trials; t++) hits[weightedSampleIndices(weights, 6, 1, static_cast<uint64_t>(t))[0]]++;
+    for (int i = 0; i < 6; i++) {
+        CHECK_NEAR(static_cast<double>(hits[i]) / trials, std::max(weights[i], 0.0) / 10.0, 0.01);
+    }
+
+    // 结果与线程数无关
+    const int64_t n = 200000;
+    std::vector<double> w(static_cast<size_t>(n));
+    for (int64_t i = 0; i < n; i++) w[i] = 1.0 + static_cast<double>(i % 17);
+    const std::vector<int32_t> parallel = weightedSampleIndices(w.data(), n, 500, 5);
+    ThreadPool::instance().setThreadCount(1);
+    const std::vector<int32_t> serial = weightedSampleIndices(w.data(), n, 500, 5);
+    ThreadPool::instance().setThreadCount(4);
+    CHECK(parallel == serial);
+    CHECK(std::set<int32_t>(parallel.begin(), parallel.end()).size() == 500);
+}
+
+void testStratifiedSample() {
+    // 层 7 有 10 行，层 3 有 4 行，层 9 有 1 行，另有 2 行缺失键
+    std::vector<int64_t> strata;
+    for (int i = 0; i < 10; i++) {
+        strata.push_back(7);
+        if (i < 4) strata.push_back(3);
+    }
+    strata.push_back(kNullGroupKey);
+    strata.push_back(9);
+    strata.push_back(kNullGroupKey);
+    const int64_t n = static_cast<int64_t>(strata.size());
+    const int64_t* keys[1] = {strata.data()};
+
+    // 按比例：round(0.25 * 10) = 3，round(0.25 * 4) = 1，round(0.25 * 1) = 0
+    const std::vector<int32_t> byFraction = stratifiedSampleIndices(keys, 1, n, -1, 0.25, 5);
+    CHECK(byFraction.size() == 4);
+    for (int i = 0; i < 3; i++) CHECK(strata[byFraction[i]] == 7);
+    CHECK(strata[byFraction[3]] == 3);
+
+    // 按行数：每层最多 2 行，缺失键的行不参与
+    const std::vector<int32_t> byCount = stratifiedSampleIndices(keys, 1, n, 2, 0.0, 5);
+    CHECK(byCount.size() == 5);
+    CHECK(strata[byCount[0]] == 7 && strata[byCount[1]] == 7);
+    CHECK(strata[byCount[2]] == 3 && strata[byCount[3]] == 3);
+    CHECK(strata[byCount[4]] == 9);
+    CHECK(stratifiedSampleIndices(keys, 1, n, 2, 0.0, 5) == byCount);
+
+    // 多列键：(a, b) 组合相同才属于同一层
+    const int64_t m = 100000;
+    std::vector<int64_t> a(static_cast<size_t>(m));
+    std::vector<int64_t> b(static_cast<size_t>(m));
+    for (int64_t i = 0; i < m; i++) {
+        a[i] = i % 3;
+        b[i] = i % 5;
+    }
+    const int64_t* pair[2] = {a.data(), b.data()};
+    const std::vector<int32_t> sampled = stratifiedSampleIndices(pair, 2, m, -1, 0.1, 8);
+    CHECK(sampled.size() == 10005);
+    std::vector<int64_t> perStratum(15, 0);
+    for (int32_t row : sampled) perStratum[a[row] * 5 + b[row]]++;
+    for (int64_t c : perStratum) CHECK(c == 667);
+    CHECK(std::set<int32_t>(sampled.begin(), sampled.end()).size() == sampled.size());
+}
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testGenerator);
+    RUN_TEST(testSampleIndices);
+    RUN_TEST(testWeightedSample);
+    RUN_TEST(testStratifiedSample);
+    return TEST_RESULT();
+}
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "math_kernels.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+const int64_t kLengths[] = {0, 1, 2, 3, 7, 8, 15, 16, 17, 63, 64, 65, 127, 1000, 4099};
+const simd::CompareOp kOps[] = {
+    simd::CompareOp::GT, simd::CompareOp::GE, simd::CompareOp::LT,
+    simd::CompareOp::LE, simd::CompareOp::EQ, simd::CompareOp::NE};
+
+// 含 NaN、无穷和重复值的测试数据，多分配一个元素以测试非对齐起点
+std::vector<double> makeData(int64_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> pick(0, 19);
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+    std::vector<double> data(static_cast<size_t>(n) + 1);
+    for (auto& v : data) {
+        int p = pick(rng);
+        if (p == 0) v = NAN;
+        else if (p == 1) v = 0.5;  // 与比较阈值相等
+        else if (p == 2) v = (rng() & 1) ? INFINITY : -INFINITY;
+        else v = dist(rng);
+    }
+    return data;
+}
+
+double tolerance(double reference) {
+    return 1e-9 * (1.0 + std::fabs(reference));
+}
+
+// 从每个位置开始扫描，命中位置覆盖向量块内、块边界和尾部
+void checkFindStructural(const simd::Kernels& k, const simd::Kernels& ref) {
+    std::mt19937_64 rng(7);
+    const char alphabet[] = "abc,\"\n;x\xe4";
+    for (int64_t n : kLengths) {
+        std::string text(static_cast<size_t>(n), 'a');
+        for (auto& c : text) {
+            // 结构字符稀疏出现，保证长距离扫描也被覆盖
+            c = (rng() % 23 == 0) ? alphabet[rng() % (sizeof(alphabet) - 1)] : 'z';
+        }
+        bool same = true;
+        for (int64_t start = 0; start <= n; start++) {
+            same = same && k.findStructural(text.data() + start, n - start, ',', '"') ==
+                           ref.findStructural(text.data() + start, n - start, ',', '"');
+            same = same && k.findStructural(text.data() + start, n - start, ';', '\'') ==
+                           ref.findStructural(text.data() + start, n - start, ';', '\'');
+        }
+        CHECK(same);
+    }
+    const std::string plain(100, 'z');
+    CHECK(k.findStructural(plain.data(), 100, ',', '"') == 100);
+}
+
+// 两个 double 之间相隔的可表示数个数，NaN 与 NaN、同为无穷时为 0
+int64_t ulpDistance(double a, double b) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b) ? 0 : INT64_MAX;
+    if (a == b) return 0;
+    if (std::isinf(a) || std::isinf(b)) return INT64_MAX;
+    int64_t ia, ib;
+    std::memcpy(&ia, &a, sizeof(ia));
+    std::memcpy(&ib, &b, sizeof(ib));
+    // 转成按数值单调的整数序
+    if (ia < 0) ia = INT64_MIN - ia;
+    if (ib < 0) ib = INT64_MIN - ib;
+    return ia > ib ? ia - ib : ib - ia;
+}
+
+// 超越函数与 libm 比较：覆盖逼近区间、边界两侧和特殊值，并验证原地计算
+void checkTranscendentals(const simd::Kernels& k) {
+    std::mt19937_64 rng(11);
+    std::vector<double> x;
+    const double specials[] = {0.0, -0.0, 1.0, -1.0, NAN, INFINITY, -INFINITY, 1e-310, -1e-310,
+                               2.2250738585072014e-308, 1.7976931348623157e308, 708.0, 708.5, -708.0,
+                               -709.5, -745.2, 709.8, 710.0, 1e5, -1e5, 1e5 + 1.0, 1e22, 3.141592653589793,
+                               1.5707963267948966, 0.7853981633974483, 1.4142135623730951, 0.70710678118654757};
+    for (double v : specials) x.push_back(v);
+    std::uniform_real_distribution<double> small(-20.0, 20.0);
+    std::uniform_real_distribution<double> wide(-750.0, 750.0);
+    std::uniform_real_distribution<double> exponent(-300.0, 300.0);
+    for (int i = 0; i < 5000; i++) {
+        x.push_back(small(rng));
+        x.push_back(wide(rng));
+        x.push_back(std::pow(10.0, exponent(rng)));
+    }
+    const int64_t n = static_cast<int64_t>(x.size());
+    std::vector<double> out(x.size());
+
+    struct Case {
+        void (*fn)(const double*, double*, int64_t);
+        double (*ref)(double);
+        const char* name;
+    };
+    const Case cases[] = {
+        {k.exp, [](double v) { return std::exp(v); }, "exp"},
+        {k.log, [](double v) { return std::log(v); }, "log"},
+        {k.sin, [](double v) { return std::sin(v); }, "sin"},
+        {k.cos, [](double v) { return std::cos(v); }, "cos"},
+    };
+    for (const Case& c : cases) {
+        c.fn(x.data(), out.data(), n);
+        int64_t worst = 0;
+        for (int64_t i = 0; i < n; i++) {
+            const double expected = c.ref(x[i]);
+            // sin/cos 在零点附近相对误差没有意义，绝对误差足够小即可
+            if (std::fabs(out[i] - expected) <= 1e-16) continue;
+            worst = std::max(worst, ulpDistance(out[i], expected));
+        }
+        std::printf("    %s: 最大误差 %lld ulp\n", c.name, static_cast<long long>(worst));
+        CHECK(worst <= 4);
+
+        // 原地计算与非对齐起点
+        std::vector<double> inPlace(x.begin(), x.end());
+        c.fn(inPlace.data() + 1, inPlace.data() + 1, n - 1);
+        CHECK(inPlace[0] == x[0]);
+        CHECK(std::memcmp(inPlace.data() + 1, out.data() + 1, static_cast<size_t>(n - 1) * sizeof(double)) == 0);
+    }
+}
+
+void checkAgainstScalar(const simd::Kernels& k) {
+    const simd::Kernels& ref = simd::scalar();
+    std::printf("  内核: %s\n", k.name);
+    for (int64_t n : kLengths) {
+        for (int offset = 0; offset <= 1; offset++) {
+            std::vector<double> bufA = makeData(n, 1000 + n);
+            std::vector<double> bufB = makeData(n, 2000 + n);
+            // 去掉无穷值，避免 inf - inf 使求和比较失去意义
+            for (auto& v : bufA) if (std::isinf(v)) v = 1.0;
+            const double* a = bufA.data() + offset;
+            const double* b = bufB.data() + offset;
+
+            int64_t c1 = -1, c2 = -1;
+            double s1 = k.nanSum(a, n, &c1);
+            double s2 = ref.nanSum(a, n, &c2);
+            CHECK_NEAR(s1, s2, tolerance(s2));
+            CHECK(c1 == c2);
+
+            double sum1, sq1, sum2, sq2;
+            k.nanMoments(a, n, &sum1, &sq1, &c1);
+            ref.nanMoments(a, n, &sum2, &sq2, &c2);
+            CHECK_NEAR(sum1, sum2, tolerance(sum2));
+            CHECK_NEAR(sq1, sq2, tolerance(sq2));
+            CHECK(c1 == c2);
+
+            double lo1, hi1, lo2, hi2;
+            c1 = k.nanMinMax(b, n, &lo1, &hi1);
+            c2 = ref.nanMinMax(b, n, &lo2, &hi2);
+            CHECK(c1 == c2);
+            if (c2 > 0) {
+                CHECK(lo1 == lo2);
+                CHECK(hi1 == hi2);
+            }
+
+            std::vector<double> dotA(bufA.begin(), bufA.end());
+            for (auto& v : dotA) if (std::isnan(v)) v = 2.0;
+            std::vector<double> dotB(dotA.rbegin(), dotA.rend());
+            double d1 = k.dot(dotA.data() + offset, dotB.data() + offset, n);
+            double d2 = ref.dot(dotA.data() + offset, dotB.data() + offset, n);
+            CHECK_NEAR(d1, d2, tolerance(d2) * 100);
+
+            std::vector<double> out1(n), out2(n);
+            k.add(a, b, out1.data(), n);
+            ref.add(a, b, out2.data(), n);
+            bool same = true;
+            for (int64_t i = 0; i < n; i++) {
+                same = same && (out1[i] == out2[i] || (std::isnan(out1[i]) && std::isnan(out2[i])));
+            }
+            CHECK(same);
+
+            k.scale(a, -1.5, out1.data(), n);
+            ref.scale(a, -1.5, out2.data(), n);
+            same = true;
+            for (int64_t i = 0; i < n; i++) {
+                same = same && (out1[i] == out2[i] || (std::isnan(out1[i]) && std::isnan(out2[i])));
+            }
+            CHECK(same);
+
+            for (simd::CompareOp op : kOps) {
+                const int64_t words = (n + 63) / 64;
+                std::vector<uint64_t> bits1(words, ~uint64_t(0)), bits2(words, ~uint64_t(0));
+                k.compareMask(b, n, 0.5, op, bits1.data());
+                ref.compareMask(b, n, 0.5, op, bits2.data());
+                CHECK(bits1 == bits2);
+
+                std::vector<uint8_t> bytes1(n, 7), bytes2(n, 7);
+                k.compareBytes(b, n, 0.5, op, bytes1.data());
+                ref.compareBytes(b, n, 0.5, op, bytes2.data());
+                CHECK(bytes1 == bytes2);
+            }
+        }
+    }
+    checkFindStructural(k, ref);
+}
+
+} // namespace
+
+static void testScalarReference() {
+    const double x[] = {1.0, NAN, 3.0, -2.0};
+    int64_t count = 0;
+    CHECK(simd::scalar().nanSum(x, 4, &count) == 2.0);
+    CHECK(count == 3);
+
+    double lo, hi;
+    CHECK(simd::scalar().nanMinMax(x, 4, &lo, &hi) == 3);
+    CHECK(lo == -2.0 && hi == 3.0);
+
+    uint64_t bits = ~uint64_t(0);
+    simd::scalar().compareMask(x, 4, 0.0, simd::CompareOp::GT, &bits);
+    CHECK(bits == 0x5);  // 元素 0 和 2，NaN 比较为 false，高位清零
+    simd::scalar().compareMask(x, 4, 0.0, simd::CompareOp::NE, &bits);
+    CHECK(bits == 0xF);  // NaN 与任何值都不相等
+
+    const char line[] = "ab\"c,d\n";
+    CHECK(simd::scalar().findStructural(line, 7, ',', '"') == 2);
+    CHECK(simd::scalar().findStructural(line + 3, 4, ',', '"') == 1);
+    CHECK(simd::scalar().findStructural(line + 5, 2, ',', '"') == 1);
+}
+
+static void testAllAvailableLevels() {
+    const simd::Level levels[] = {simd::Level::SSE2, simd::Level::AVX2, simd::Level::NEON};
+    for (simd::Level level : levels) {
+        const simd::Kernels* k = simd::forLevel(level);
+        if (k == nullptr) {
+            std::printf("  跳过不支持的级别: %s\n", simd::levelName(level));
+            continue;
+        }
+        checkAgainstScalar(*k);
+    }
+}
+
+static void testTranscendentals() {
+    const simd::Level levels[] = {simd::Level::Scalar, simd::Level::SSE2, simd::Level::AVX2, simd::Level::NEON};
+    for (simd::Level level : levels) {
+        const simd::Kernels* k = simd::forLevel(level);
+        if (k == nullptr) continue;
+        std::printf("  内核: %s\n", k->name);
+        checkTranscendentals(*k);
+    }
+}
+
+static void testDispatchedMathKernels() {
+    std::printf("  当前内核: %s\n", simd::active().name);
+    const int64_t n = 200003;
+    std::vector<double> data = makeData(n, 99);
+    for (auto& v : data) if (std::isinf(v)) v = 3.0;
+
+    int64_t count = 0;
+    double refSum = simd::scalar().nanSum(data.data(), n, &count);
+    CHECK_NEAR(andas::sum(data.data(), n), refSum, tolerance(refSum));
+    CHECK_NEAR(andas::mean(data.data(), n), refSum / count, 1e-9);
+
+    double lo, hi;
+    simd::scalar().nanMinMax(data.data(), n, &lo, &hi);
+    CHECK(andas::min(data.data(), n) == lo);
+    CHECK(andas::max(data.data(), n) == hi);
+
+    const int64_t words = (n + 63) / 64;
+    std::vector<uint64_t> bits(words), refBits(words);
+    andas::compareToBitmask(data.data(), 0.5, simd::CompareOp::LE, bits.data(), n);
+    simd::scalar().compareMask(data.data(), n, 0.5, simd::CompareOp::LE, refBits.data());
+    CHECK(bits == refBits);
+
+    CHECK(std::isnan(andas::max(data.data(), 0)));
+    const double allNan[] = {NAN, NAN, NAN};
+    CHECK(std::isnan(andas::min(allNan, 3)));
+    CHECK(andas::mean(allNan, 3) == 0.0);
+}
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testScalarReference);
+    RUN_TEST(testAllAvailableLevels);
+    RUN_TEST(testTranscendentals);
+    RUN_TEST(testDispatchedMathKernels);
+
+    // 强制标量内核后结果仍一致
+    CHECK(simd::setLevel(simd::Level::Scalar));
+    RUN_TEST(testDispatchedMathKernels);
+    return TEST_RESULT();
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+#include "sketches.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// 值 v 在有序数据中的秩（小于 v 的个数）占总数的比例
+double rankOf(const std::vector<double>& sorted, double v) {
+    return static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), v) - sorted.begin()) /
+           static_cast<double>(sorted.size());
+}
+
+void testQuantileAccuracy() {
+    std::mt19937_64 rng(7);
+    std::lognormal_distribution<double> dist(0.0, 1.5);
+    std::vector<double> x(1000000);
+    for (auto& v : x) v = rng() % 23 == 0 ? kNaN : dist(rng);
+    std::vector<double> sorted;
+    for (double v : x) {
+        if (!std::isnan(v)) sorted.push_back(v);
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    const QuantileSketch sketch = buildQuantileSketch(x.data(), static_cast<int64_t>(x.size()), QuantileSketch::kDefaultK);
+    CHECK(sketch.count() == static_cast<int64_t>(sorted.size()));
+    CHECK(!sketch.exact());
+    CHECK(sketch.retained() < 4 * QuantileSketch::kDefaultK);
+    CHECK(sketch.min() == sorted.front() && sketch.max() == sorted.back());
+    for (double q : {0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99}) {
+        CHECK(std::fabs(rankOf(sorted, sketch.quantile(q)) - q) < 0.01);
+    }
+    CHECK(sketch.quantile(0.0) == sorted.front());
+    CHECK(sketch.quantile(1.0) == sorted.back());
+}
+
+void testQuantileExact() {
+    // 未压缩时与 pandas 的线性插值一致
+    QuantileSketch sketch;
+    for (double v : {4.0, kNaN, 1.0, 3.0, 2.0, 10.0}) sketch.add(v);
+    CHECK(sketch.exact());
+    CHECK(sketch.count() == 5);
+    CHECK_NEAR(sketch.quantile(0.5), 3.0, 0.0);
+    CHECK_NEAR(sketch.quantile(0.25), 2.0, 0.0);
+    CHECK_NEAR(sketch.quantile(0.9), 7.6, 1e-12);
+
+    QuantileSketch empty;
+    CHECK(std::isnan(empty.quantile(0.5)));
+    CHECK(std::isnan(empty.min()));
+}
+
+void testQuantileMerge() {
+    std::mt19937_64 rng(11);
+    std::normal_distribution<double> dist(100.0, 15.0);
+    std::vector<double> x(300000);
+    for (auto& v : x) v = dist(rng);
+    std::vector<double> sorted = x;
+    std::sort(sorted.begin(), sorted.end());
+
+    // 大小不一的分批摘要，经打包/解包后合并
+    QuantileSketch merged;
+    size_t from = 0;
+    while (from < x.size()) {
+        const size_t to = std::min(x.size(), from + 1 + rng() % 20000);
+        const QuantileSketch part = buildQuantileSketch(x.data() + from, static_cast<int64_t>(to - from), QuantileSketch::kDefaultK);
+        const std::vector<double> packed = part.pack();
+        QuantileSketch restored;
+        CHECK(QuantileSketch::unpack(packed.data(), static_cast<int64_t>(packed.size()), &restored));
+        CHECK(restored.count() == part.count());
+        CHECK(restored.quantile(0.3) == part.quantile(0.3));
+        merged.merge(restored);
+        from = to;
+    }
+    CHECK(merged.count() == static_cast<int64_t>(x.size()));
+    for (double q : {0.05, 0.5, 0.95}) {
+        CHECK(std::fabs(rankOf(sorted, merged.quantile(q)) - q) < 0.01);
+    }
+
+    const double bad[] = {400.0, 3.0};
+    QuantileSketch ignored;
+    CHECK(!QuantileSketch::unpack(bad, 2, &ignored));
+}
+
+void testDistinctCount() {
+    for (int64_t n : {int64_t(0), int64_t(10), int64_t(1000), int64_t(50000), int64_t(2000000)}) {
+        std::vector<int64_t> keys(static_cast<size_t>(n * 2));
+        for (int64_t i = 0; i < n * 2; i++) keys[i] = (i % n) * 7919 + 13;
+        const DistinctCounter counter = buildDistinctCounter(keys.data(), n * 2, std::numeric_limits<int64_t>::min(),
+                                                             DistinctCounter::kDefaultPrecision);
+        const double estimate = counter.estimate();
+        if (n <= 10) {
+            CHECK(std::fabs(estimate - static_cast<double>(n)) < 0.5);
+        } else {
+            CHECK(std::fabs(estimate / static_cast<double>(n) - 1.0) < 0.025);
+        }
+    }
+
+    // double 键：-0.0 与 0.0 相同，NaN 跳过
+    const double x[] = {0.0, -0.0, kNaN, 1.5, 1.5, 2.0};
+    CHECK_NEAR(buildDistinctCounter(x, 6, DistinctCounter::kDefaultPrecision).estimate(), 3.0, 0.01);
+}
+
+void testDistinctMerge() {
+    DistinctCounter a;
+    DistinctCounter b;
+    DistinctCounter both;
+    for (int64_t i = 0; i < 200000; i++) {
+        a.add(i);
+        both.add(i);
+    }
+    for (int64_t i = 100000; i < 300000; i++) {
+        b.add(i);
+        both.add(i);
+    }
+    const auto& registers = b.registers();
+    DistinctCounter restored;
+    CHECK(DistinctCounter::fromRegisters(registers.data(), static_cast<int64_t>(registers.size()), &restored));
+    a.merge(restored);
+    CHECK(a.registers() == both.registers());
+    CHECK(std::fabs(a.estimate() / 300000.0 - 1.0) < 0.025);
+
+    const uint8_t bad[3] = {0, 1, 2};
+    CHECK(!DistinctCounter::fromRegisters(bad, 3, &restored));
+}
+
+void testHeavyHitters() {
+    // Zipf 分布：少数键占大部分次数
+    std::mt19937_64 rng(5);
+    const int64_t universe = 100000;
+    std::vector<double> weights(universe);
+    for (int64_t i = 0; i < universe; i++) weights[i] = 1.0 / std::pow(static_cast<double>(i + 1), 1.1);
+    std::discrete_distribution<int64_t> dist(weights.begin(), weights.end());
+    std::vector<int64_t> keys(500000);
+    std::map<int64_t, int64_t> truth;
+    for (auto& k : keys) {
+        k = dist(rng) * 3 + 1;
+        truth[k]++;
+    }
+    std::vector<std::pair<int64_t, int64_t>> expected;
+    for (const auto& kv : truth) expected.emplace_back(kv.second, kv.first);
+    std::sort(expected.rbegin(), expected.rend());
+
+    const HeavyHitters hh = buildHeavyHitters(keys.data(), static_cast<int64_t>(keys.size()),
+                                              std::numeric_limits<int64_t>::min(), 256);
+    CHECK(hh.total() == static_cast<int64_t>(keys.size()));
+    const std::vector<HeavyHitters::Entry> top = hh.top(10);
+    CHECK(top.size() == 10);
+    std::set<int64_t> topKeys;
+    for (const auto& e : top) {
+        topKeys.insert(e.key);
+        const int64_t actual = truth[e.key];
+        CHECK(e.count >= actual);
+        CHECK(e.count - e.error <= actual);
+        CHECK(e.count - actual <= hh.total() / 256);
+    }
+    for (int i = 0; i < 5; i++) CHECK(topKeys.count(expected[i].second) == 1);
+
+    // 打包/解包后与分批合并
+    HeavyHitters merged(256);
+    for (size_t from = 0; from < keys.size(); from += 70000) {
+        HeavyHitters part(256);
+        for (size_t i = from; i < std::min(keys.size(), from + 70000); i++) part.add(keys[i]);
+        const std::vector<int64_t> packed = part.pack();
+        HeavyHitters restored;
+        CHECK(HeavyHitters::unpack(packed.data(), static_cast<int64_t>(packed.size()), &restored));
+        merged.merge(restored);
+    }
+    CHECK(merged.total() == hh.total());
+    for (const auto& e : merged.top(5)) {
+        CHECK(e.count >= truth[e.key]);
+        CHECK(e.count - e.error <= truth[e.key]);
+    }
+    CHECK(merged.top(1)[0].key == expected[0].second);
+
+    HeavyHitters exact(8);
+    for (int64_t k : {3, 1, 3, 2, 3, 1}) exact.add(k);
+    const auto counts = exact.top(-1);
+    CHECK(counts.size() == 3);
+    CHECK(counts[0].key == 3 && counts[0].count == 3 && counts[0].error == 0);
+    CHECK(counts[1].key == 1 && counts[1].count == 2);
+    CHECK(counts[2].key == 2 && counts[2].count == 1);
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testQuantileAccuracy);
+    RUN_TEST(testQuantileExact);
+    RUN_TEST(testQuantileMerge);
+    RUN_TEST(testDistinctCount);
+    RUN_TEST(testDistinctMerge);
+    RUN_TEST(testHeavyHitters);
+    return TEST_RESULT();
+}
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "sort_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+bool isNull(const SortKey& key, int32_t row) {
+    if (key.type == SortKeyType::FLOAT64) return std::isnan(static_cast<const double*>(key.values)[row]);
+    return static_cast<const int64_t*>(key.values)[row] == kNullSortKey;
+}
+
+// 比较两行在一个键上的先后：<0 表示 a 在前，0 表示相等
+int compareRows(const SortKey& key, int32_t a, int32_t b) {
+    const bool nullA = isNull(key, a);
+    const bool nullB = isNull(key, b);
+    if (nullA || nullB) {
+        if (nullA && nullB) return 0;
+        return (nullA == key.nullsFirst) ? -1 : 1;
+    }
+    int result;
+    if (key.type == SortKeyType::FLOAT64) {
+        const double x = static_cast<const double*>(key.values)[a];
+        const double y = static_cast<const double*>(key.values)[b];
+        result = x < y ? -1 : (x > y ? 1 : 0);
+    } else {
+        const int64_t x = static_cast<const int64_t*>(key.values)[a];
+        const int64_t y = static_cast<const int64_t*>(key.values)[b];
+        result = x < y ? -1 : (x > y ? 1 : 0);
+    }
+    return key.descending ? -result : result;
+}
+
+// 参考实现：std::stable_sort 按键依次比较
+std::vector<int32_t> referenceSort(const std::vector<SortKey>& keys, int64_t n) {
+    std::vector<int32_t> rows(static_cast<size_t>(n));
+    std::iota(rows.begin(), rows.end(), 0);
+    std::stable_sort(rows.begin(), rows.end(), [&](int32_t a, int32_t b) {
+        for (const SortKey& key : keys) {
+            const int c = compareRows(key, a, b);
+            if (c != 0) return c < 0;
+        }
+        return false;
+    });
+    return rows;
+}
+
+std::vector<int32_t> engineSort(const std::vector<SortKey>& keys, int64_t n) {
+    std::vector<int32_t> rows(static_cast<size_t>(n));
+    sortIndices(keys.data(), static_cast<int32_t>(keys.size()), n, rows.data());
+    return rows;
+}
+
+void testDoubleOrdering() {
+    const std::vector<double> x = {3.0, kNaN, -1.0, 0.0, -0.0, 3.0, -INFINITY, INFINITY, kNaN, 2.5};
+    const int64_t n = static_cast<int64_t>(x.size());
+    std::vector<int32_t> out(x.size());
+
+    sortIndices(x.data(), n, false, false, out.data());
+    CHECK((out == std::vector<int32_t>{6, 2, 3, 4, 9, 0, 5, 7, 1, 8}));
+
+    sortIndices(x.data(), n, true, false, out.data());
+    CHECK((out == std::vector<int32_t>{7, 0, 5, 9, 3, 4, 2, 6, 1, 8}));
+
+    sortIndices(x.data(), n, false, true, out.data());
+    CHECK((out == std::vector<int32_t>{1, 8, 6, 2, 3, 4, 9, 0, 5, 7}));
+
+    sortIndices(x.data(), n, true, true, out.data());
+    CHECK((out == std::vector<int32_t>{1, 8, 7, 0, 5, 9, 3, 4, 2, 6}));
+}
+
+void testInt64Extremes() {
+    const int64_t kMin = kNullSortKey + 1;
+    const int64_t kMax = std::numeric_limits<int64_t>::max();
+    const std::vector<int64_t> x = {kMax, kNullSortKey, kMin, 0, -1, kMax, kMin};
+    const int64_t n = static_cast<int64_t>(x.size());
+    for (int mode = 0; mode < 4; mode++) {
+        std::vector<SortKey> keys = {{SortKeyType::INT64, x.data(), (mode & 1) != 0, (mode & 2) != 0}};
+        CHECK(engineSort(keys, n) == referenceSort(keys, n));
+    }
+}
+
+void testMultiColumnMatchesReference() {
+    std::mt19937_64 rng(42);
+    for (int64_t n : {0, 1, 7, 255, 256, 5000}) {
+        std::vector<int64_t> a(static_cast<size_t>(n));
+        std::vector<double> b(static_cast<size_t>(n));
+        std::vector<int64_t> c(static_cast<size_t>(n));
+        for (int64_t i = 0; i < n; i++) {
+            a[static_cast<size_t>(i)] = rng() % 10 == 0 ? kNullSortKey : static_cast<int64_t>(rng() % 5) - 2;
+            b[static_cast<size_t>(i)] = rng() % 8 == 0 ? kNaN : static_cast<double>(rng() % 7) * 0.5 - 1.0;
+            c[static_cast<size_t>(i)] = static_cast<int64_t>(rng());
+        }
+        for (int mode = 0; mode < 8; mode++) {
+            std::vector<SortKey> keys = {
+                {SortKeyType::INT64, a.data(), (mode & 1) != 0, (mode & 2) != 0},
+                {SortKeyType::FLOAT64, b.data(), (mode & 4) != 0, (mode & 1) != 0},
+                {SortKeyType::INT64, c.data(), (mode & 2) != 0, false},
+            };
+            CHECK(engineSort(keys, n) == referenceSort(keys, n));
+        }
+    }
+}
+
+void testParallelMatchesSerial() {
+    // 超过并行阈值且多于4块，覆盖分块基数排序与 merge path 归并
+    const int64_t n = 600000;
+    std::mt19937_64 rng(7);
+    std::vector<int64_t> timestamps(static_cast<size_t>(n));
+    std::vector<double> wide(static_cast<size_t>(n));
+    for (int64_t i = 0; i < n; i++) {
+        // 跨度小于 32 位的时间戳（毫秒）与大量重复值
+        timestamps[static_cast<size_t>(i)] = 1700000000000LL + static_cast<int64_t>(rng() % 86400000) / 1000 * 1000;
+        wide[static_cast<size_t>(i)] = rng() % 100 == 0 ? kNaN : std::ldexp(static_cast<double>(rng() % 2001) - 1000.0, static_cast<int>(rng() % 200) - 100);
+    }
+    for (int mode = 0; mode < 2; mode++) {
+        std::vector<SortKey> keys = {
+            {SortKeyType::INT64, timestamps.data(), mode == 1, false},
+            {SortKeyType::FLOAT64, wide.data(), mode == 0, mode == 1},
+        };
+        std::vector<int32_t> parallel = engineSort(keys, n);
+        const int64_t threshold = parallelThreshold();
+        setParallelThreshold(n + 1);
+        std::vector<int32_t> serial = engineSort(keys, n);
+        setParallelThreshold(threshold);
+        CHECK(parallel == serial);
+        CHECK(parallel == referenceSort(keys, n));
+    }
+}
+
+void testTopK() {
+    std::mt19937_64 rng(3);
+    const int64_t n = 200000;
+    std::vector<double> x(static_cast<size_t>(n));
+    for (int64_t i = 0; i < n; i++) {
+        x[static_cast<size_t>(i)] = rng() % 50 == 0 ? kNaN : static_cast<double>(rng() % 1000);
+    }
+    for (bool largest : {false, true}) {
+        SortKey key{SortKeyType::FLOAT64, x.data(), largest, true};
+        std::vector<SortKey> keys = {{SortKeyType::FLOAT64, x.data(), largest, false}};
+        const std::vector<int32_t> full = referenceSort(keys, n);
+        for (int64_t k : {0, 1, 10, 3000}) {
+            std::vector<int32_t> top = topK(key, n, k);
+            CHECK(static_cast<int64_t>(top.size()) == k);
+            CHECK(std::equal(top.begin(), top.end(), full.begin()));
+        }
+    }
+    // k 超过非缺失行数时返回全部非缺失行
+    const std::vector<double> small = {kNaN, 2.0, 1.0, kNaN};
+    SortKey key{SortKeyType::FLOAT64, small.data(), false, false};
+    CHECK((topK(key, 4, 10) == std::vector<int32_t>{2, 1}));
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testDoubleOrdering);
+    RUN_TEST(testInt64Extremes);
+    RUN_TEST(testMultiColumnMatchesReference);
+    RUN_TEST(testParallelMatchesSerial);
+    RUN_TEST(testTopK);
+    return TEST_RESULT();
+}
@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "spill_engine.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+const char* kTempDir = "/tmp";
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// 把字符串打包为 payload/offsets
+struct Packed {
+    std::vector<uint8_t> bytes;
+    std::vector<int32_t> offsets{0};
+
+    void add(const std::string& s) {
+        bytes.insert(bytes.end(), s.begin(), s.end());
+        offsets.push_back(static_cast<int32_t>(bytes.size()));
+    }
+};
+
+std::vector<std::string> drainSorter(ExternalSorter& sorter, int64_t maxBytes) {
+    std::vector<std::string> out;
+    std::vector<uint8_t> payload;
+    std::vector<int32_t> offsets;
+    while (int64_t count = sorter.next(maxBytes, payload, offsets)) {
+        CHECK(static_cast<int64_t>(offsets.size()) == count + 1);
+        for (int64_t i = 0; i < count; i++) {
+            out.emplace_back(payload.begin() + offsets[i], payload.begin() + offsets[i + 1]);
+        }
+    }
+    return out;
+}
+
+// 参考实现：稳定排序，NaN 无论升降序都在最后
+std::vector<std::string> referenceSort(const std::vector<double>& keys, const std::vector<std::string>& rows, bool descending) {
+    std::vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const double x = keys[a];
+        const double y = keys[b];
+        if (std::isnan(x) || std::isnan(y)) return !std::isnan(x) && std::isnan(y);
+        return descending ? x > y : x < y;
+    });
+    std::vector<std::string> out;
+    for (size_t i : order) out.push_back(rows[i]);
+    return out;
+}
+
+void testSortInMemory() {
+    const std::vector<double> keys = {3.0, kNaN, 1.0, 3.0, -0.0, 0.0, -2.5};
+    const std::vector<std::string> rows = {"a", "null", "b", "c", "negzero", "zero", ""};
+    for (bool descending : {false, true}) {
+        ExternalSorter sorter(kTempDir, int64_t(1) << 20, descending);
+        Packed packed;
+        for (const std::string& row : rows) packed.add(row);
+        sorter.add(keys.data(), packed.bytes.data(), packed.offsets.data(), static_cast<int64_t>(keys.size()));
+        sorter.finish();
+        CHECK(drainSorter(sorter, 1 << 20) == referenceSort(keys, rows, descending));
+        CHECK(sorter.spilledBytes() == 0);
+    }
+
+    ExternalSorter empty(kTempDir, 1024, false);
+    empty.finish();
+    std::vector<uint8_t> payload;
+    std::vector<int32_t> offsets;
+    CHECK(empty.next(1024, payload, offsets) == 0);
+}
+
+void testSortSpills() {
+    std::mt19937_64 rng(7);
+    const size_t n = 50000;
+    std::vector<double> keys(n);
+    std::vector<std::string> rows(n);
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = rng() % 50 == 0 ? kNaN : static_cast<double>(static_cast<int64_t>(rng() % 1000) - 500) / 4;
+        rows[i] = std::to_string(i) + std::string(rng() % 40, 'x');
+    }
+    for (bool descending : {false, true}) {
+        // 预算远小于数据量：生成很多段，归并路数只有 2，需要多层归并
+        ExternalSorter sorter(kTempDir, 64 << 10, descending);
+        for (size_t start = 0; start < n; start += 777) {
+            const size_t end = std::min(n, start + 777);
+            Packed packed;
+            for (size_t i = start; i < end; i++) packed.add(rows[i]);
+            sorter.add(keys.data() + start, packed.bytes.data(), packed.offsets.data(), static_cast<int64_t>(end - start));
+        }
+        sorter.finish();
+        CHECK(sorter.spilledBytes() > 0);
+        CHECK(drainSorter(sorter, 4096) == referenceSort(keys, rows, descending));
+    }
+}
+
+struct ReferenceGroup {
+    int64_t rows = 0;
+    int64_t count = 0;
+    double sum = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+};
+
+std::map<std::string, ReferenceGroup> drainAggregator(SpillAggregator& aggregator, int64_t* batches) {
+    std::map<std::string, ReferenceGroup> out;
+    SpillGroups groups;
+    *batches = 0;
+    while (aggregator.next(groups)) {
+        (*batches)++;
+        for (int64_t g = 0; g < groups.size(); g++) {
+            const std::string key(groups.keys.begin() + groups.offsets[g], groups.keys.begin() + groups.offsets[g + 1]);
+            CHECK(out.count(key) == 0);  // 每个分组只出现一次
+            ReferenceGroup& group = out[key];
+            group.rows = groups.rows[g];
+            group.count = groups.counts[g];
+            group.sum = groups.sums[g];
+            group.min = groups.mins[g];
+            group.max = groups.maxs[g];
+        }
+    }
+    return out;
+}
+
+void testAggregateInMemory() {
+    SpillAggregator aggregator(kTempDir, int64_t(1) << 20);
+    Packed keys;
+    for (const char* key : {"b", "a", "b", "", "a", "b"}) keys.add(key);
+    const double values[] = {1.0, kNaN, 2.0, 5.0, kNaN, -4.0};
+    aggregator.add(keys.bytes.data(), keys.offsets.data(), values, 6);
+    aggregator.finish();
+
+    SpillGroups groups;
+    CHECK(aggregator.next(groups));
+    CHECK(groups.size() == 3);
+    // 按首次出现的顺序
+    CHECK(std::string(groups.keys.begin(), groups.keys.end()) == "ba");
+    CHECK((groups.offsets == std::vector<int32_t>{0, 1, 2, 2}));
+    CHECK((groups.rows == std::vector<int64_t>{3, 2, 1}));
+    CHECK((groups.counts == std::vector<int64_t>{3, 0, 1}));
+    CHECK(groups.sums[0] == -1.0 && groups.mins[0] == -4.0 && groups.maxs[0] == 2.0);
+    CHECK(std::isnan(groups.mins[1]) && std::isnan(groups.maxs[1]) && groups.sums[1] == 0.0);
+    CHECK(!aggregator.next(groups));
+    CHECK(aggregator.spilledBytes() == 0);
+
+    // 只计行数
+    SpillAggregator counter(kTempDir, int64_t(1) << 20);
+    counter.add(keys.bytes.data(), keys.offsets.data(), nullptr, 6);
+    counter.finish();
+    CHECK(counter.next(groups));
+    CHECK((groups.rows == std::vector<int64_t>{3, 2, 1}));
+    CHECK((groups.counts == std::vector<int64_t>{0, 0, 0}));
+
+    SpillAggregator empty(kTempDir, 1024);
+    empty.finish();
+    CHECK(!empty.next(groups));
+}
+
+void testAggregateSpills() {
+    std::mt19937_64 rng(11);
+    const size_t n = 200000;
+    const uint64_t cardinality = 20000;
+    std::map<std::string, ReferenceGroup> expected;
+    // 预算远小于分组数据：输入阶段多次溢写，第一层的分区仍然放不下，需要再分区
+    SpillAggregator aggregator(kTempDir, 32 << 10);
+    for (size_t start = 0; start < n; start += 4096) {
+        const size_t end = std::min(n, start + 4096);
+        Packed keys;
+        std::vector<double> values;
+        for (size_t i = start; i < end; i++) {
+            const uint64_t k = rng() % cardinality;
+            const std::string key = "key-" + std::to_string(k) + std::string(k % 13, '#');
+            const double value = rng() % 10 == 0 ? kNaN : static_cast<double>(rng() % 1000);
+            keys.add(key);
+            values.push_back(value);
+            ReferenceGroup& group = expected[key];
+            group.rows++;
+            if (!std::isnan(value)) {
+                group.count++;
+                group.sum += value;
+                group.min = std::min(group.min, value);
+                group.max = std::max(group.max, value);
+            }
+        }
+        aggregator.add(keys.bytes.data(), keys.offsets.data(), values.data(), static_cast<int64_t>(end - start));
+    }
+    aggregator.finish();
+    CHECK(aggregator.spilledBytes() > 0);
+
+    int64_t batches = 0;
+    const std::map<std::string, ReferenceGroup> actual = drainAggregator(aggregator, &batches);
+    CHECK(batches > kSpillPartitions);
+    CHECK(actual.size() == expected.size());
+    for (const auto& entry : expected) {
+        auto it = actual.find(entry.first);
+        if (it == actual.end()) {
+            CHECK(false);
+            continue;
+        }
+        const ReferenceGroup& e = entry.second;
+        const ReferenceGroup& a = it->second;
+        CHECK(a.rows == e.rows);
+        CHECK(a.count == e.count);
+        CHECK(a.sum == e.sum);  // 整数值的和是精确的
+        if (e.count > 0) {
+            CHECK(a.min == e.min && a.max == e.max);
+        } else {
+            CHECK(std::isnan(a.min) && std::isnan(a.max));
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testSortInMemory);
+    RUN_TEST(testSortSpills);
+    RUN_TEST(testAggregateInMemory);
+    RUN_TEST(testAggregateSpills);
+    return TEST_RESULT();
+}
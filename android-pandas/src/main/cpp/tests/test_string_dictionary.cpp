@@ -0,0 +1,97 @@
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "string_dictionary.h"
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+namespace {
+
+int32_t internString(StringDictionary& dictionary, const std::string& s) {
+    return dictionary.intern(s.data(), static_cast<int64_t>(s.size()));
+}
+
+std::string entry(const StringDictionary& dictionary, int32_t code) {
+    return std::string(dictionary.data(code), static_cast<size_t>(dictionary.length(code)));
+}
+
+} // namespace
+
+void testInternOrder() {
+    StringDictionary dictionary;
+    CHECK(dictionary.size() == 0);
+    CHECK(internString(dictionary, "北京") == 0);
+    CHECK(internString(dictionary, "") == 1);
+    CHECK(internString(dictionary, "上海") == 2);
+    CHECK(internString(dictionary, "北京") == 0);
+    CHECK(internString(dictionary, "") == 1);
+    CHECK(dictionary.size() == 3);
+    CHECK(entry(dictionary, 0) == "北京");
+    CHECK(dictionary.length(1) == 0);
+    CHECK(dictionary.find("上海", 6) == 2);
+    CHECK(dictionary.find("广州", 6) == -1);
+    // 前缀相同、长度不同的字符串是不同的条目
+    CHECK(internString(dictionary, std::string("a\0b", 3)) == 3);
+    CHECK(internString(dictionary, "a") == 4);
+    CHECK(dictionary.offsets().size() == 6);
+    CHECK(static_cast<int64_t>(dictionary.heap().size()) == dictionary.offsets().back());
+}
+
+void testGrowth() {
+    // 多次扩容后编号不变，与 unordered_map 的结果一致
+    StringDictionary dictionary;
+    std::unordered_map<std::string, int32_t> expected;
+    std::vector<int32_t> codes;
+    uint64_t state = 7;
+    bool ok = true;
+    for (int i = 0; i < 200000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const std::string value = "device-" + std::to_string((state >> 33) % 50000);
+        const int32_t code = internString(dictionary, value);
+        auto it = expected.find(value);
+        if (it == expected.end()) {
+            ok = ok && code == static_cast<int32_t>(expected.size());
+            expected.emplace(value, code);
+        } else {
+            ok = ok && code == it->second;
+        }
+    }
+    CHECK(ok);
+    CHECK(dictionary.size() == static_cast<int32_t>(expected.size()));
+    bool found = true;
+    for (const auto& kv : expected) {
+        found = found && dictionary.find(kv.first.data(), static_cast<int64_t>(kv.first.size())) == kv.second;
+        found = found && entry(dictionary, kv.second) == kv.first;
+    }
+    CHECK(found);
+}
+
+void testEncodeStrings() {
+    const std::string chars = "xyxzzx";
+    const int64_t offsets[] = {0, 1, 2, 3, 4, 4, 6};
+    const uint8_t valid[] = {1, 1, 1, 1, 0, 1};
+    StringDictionary dictionary;
+    int32_t codes[6];
+    encodeStrings(chars.data(), offsets, valid, 6, dictionary, codes);
+    CHECK(codes[0] == 0 && codes[1] == 1 && codes[2] == 0 && codes[3] == 2);
+    CHECK(codes[4] == -1);
+    CHECK(codes[5] == 3 && entry(dictionary, 3) == "zx");
+
+    // 继续编码到同一字典时已有条目的编号不变
+    encodeStrings(chars.data(), offsets, nullptr, 6, dictionary, codes);
+    CHECK(codes[0] == 0 && codes[3] == 2 && codes[5] == 3);
+    CHECK(codes[4] == 4 && dictionary.length(4) == 0);
+}
+
+int main() {
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testInternOrder);
+    RUN_TEST(testGrowth);
+    RUN_TEST(testEncodeStrings);
+    return TEST_RESULT();
+}
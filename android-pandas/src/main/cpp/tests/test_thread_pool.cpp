@@ -0,0 +1,92 @@
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "thread_pool.h"
+#include "test_utils.h"
+
+using namespace andas;
+
+static void testParallelForCoversRange() {
+    std::vector<int> hits(100003, 0);
+    parallel_for(0, static_cast<int64_t>(hits.size()), [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) hits[i]++;
+    }, 1000);
+    bool allOnce = true;
+    for (int h : hits) allOnce = allOnce && h == 1;
+    CHECK(allOnce);
+}
+
+static void testReduceIsDeterministic() {
+    std::vector<double> values(1000000);
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    for (auto& v : values) v = dist(rng);
+
+    auto run = [&] {
+        return parallel_reduce(0, static_cast<int64_t>(values.size()), 0.0,
+            [&](int64_t lo, int64_t hi) {
+                double s = 0.0;
+                for (int64_t i = lo; i < hi; i++) s += values[i];
+                return s;
+            },
+            [](double a, double b) { return a + b; });
+    };
+    double first = run();
+    for (int i = 0; i < 20; i++) CHECK(run() == first);
+}
+
+static void testExceptionPropagates() {
+    bool caught = false;
+    try {
+        parallel_for(0, 1000000, [&](int64_t lo, int64_t) {
+            if (lo >= 500000) throw std::runtime_error("块内异常");
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    CHECK(caught);
+}
+
+static void testNestedRunsSerial() {
+    std::vector<int64_t> sums(64, 0);
+    parallel_for(0, 64, [&](int64_t lo, int64_t hi) {
+        for (int64_t i = lo; i < hi; i++) {
+            sums[i] = parallel_reduce(0, 100000, int64_t(0),
+                [](int64_t l, int64_t h) { return h - l; },
+                [](int64_t a, int64_t b) { return a + b; });
+        }
+    }, 1);
+    bool ok = true;
+    for (int64_t s : sums) ok = ok && s == 100000;
+    CHECK(ok);
+}
+
+static void testParallelSort() {
+    std::vector<double> keys(777777);
+    std::mt19937_64 rng(7);
+    for (auto& k : keys) k = static_cast<double>(rng() % 100000);
+    std::vector<int> idx(keys.size());
+    std::iota(idx.begin(), idx.end(), 0);
+    parallel_sort(idx.begin(), idx.end(), [&](int a, int b) { return keys[a] < keys[b]; });
+    bool sorted = true;
+    for (size_t i = 1; i < idx.size(); i++) sorted = sorted && keys[idx[i - 1]] <= keys[idx[i]];
+    CHECK(sorted);
+}
+
+int main() {
+    // 主机可能只有一个核心，强制多线程以覆盖并行路径
+    ThreadPool::instance().setThreadCount(4);
+    setParallelThreshold(1024);
+
+    RUN_TEST(testParallelForCoversRange);
+    RUN_TEST(testReduceIsDeterministic);
+    RUN_TEST(testExceptionPropagates);
+    RUN_TEST(testNestedRunsSerial);
+    RUN_TEST(testParallelSort);
+
+    ThreadPool::instance().setThreadCount(2);
+    CHECK(ThreadPool::instance().threadCount() == 2);
+    RUN_TEST(testParallelForCoversRange);
+    return TEST_RESULT();
+}
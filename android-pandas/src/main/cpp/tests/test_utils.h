@@ -0,0 +1,39 @@
+#ifndef ANDAS_TEST_UTILS_H
+#define ANDAS_TEST_UTILS_H
+
+#include <cmath>
+#include <cstdio>
+
+// 轻量断言：失败时打印位置并计数，main 根据失败数返回
+static int gTestFailures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK 失败: %s\n", __FILE__, __LINE__, #cond); \
+            gTestFailures++;                                                     \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                  \
+    do {                                                                         \
+        double a_ = (actual);                                                    \
+        double e_ = (expected);                                                  \
+        if (!(std::fabs(a_ - e_) <= (tolerance))) {                              \
+            std::fprintf(stderr, "%s:%d: CHECK_NEAR 失败: %s = %.17g, 期望 %.17g\n", \
+                         __FILE__, __LINE__, #actual, a_, e_);                   \
+            gTestFailures++;                                                     \
+        }                                                                        \
+    } while (0)
+
+#define RUN_TEST(fn)                              \
+    do {                                          \
+        std::printf("=== %s ===\n", #fn);        \
+        fn();                                     \
+    } while (0)
+
+#define TEST_RESULT()                                                  \
+    (gTestFailures == 0 ? (std::printf("✅ 全部通过\n"), 0)            \
+                        : (std::printf("❌ %d 项失败\n", gTestFailures), 1))
+
+#endif //ANDAS_TEST_UTILS_H
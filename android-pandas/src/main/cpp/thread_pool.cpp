@@ -0,0 +1,214 @@
+#include "thread_pool.h"
+
+#include <string>
+#include "instrumentation.h"
+
+namespace andas {
+
+namespace {
+
+// 默认并行阈值：约256KB的double数据，低于此规模线程调度开销大于收益
+std::atomic<int64_t> gParallelThreshold{32768};
+
+thread_local bool tlsInParallelRegion = false;
+
+// 在作用域内标记当前线程处于并行区域
+struct ParallelRegionGuard {
+    bool previous;
+    ParallelRegionGuard() : previous(tlsInParallelRegion) { tlsInParallelRegion = true; }
+    ~ParallelRegionGuard() { tlsInParallelRegion = previous; }
+};
+
+int defaultThreadCount() {
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : static_cast<int>(hw);
+}
+
+} // namespace
+
+int64_t parallelThreshold() {
+    return gParallelThreshold.load(std::memory_order_relaxed);
+}
+
+void setParallelThreshold(int64_t threshold) {
+    gParallelThreshold.store(std::max<int64_t>(1, threshold), std::memory_order_relaxed);
+}
+
+bool inParallelRegion() {
+    return tlsInParallelRegion;
+}
+
+ThreadPool& ThreadPool::instance() {
+    // 进程生命周期内常驻，不在静态析构阶段join线程
+    static ThreadPool* pool = new ThreadPool();
+    return *pool;
+}
+
+ThreadPool::ThreadPool() {
+    int count = defaultThreadCount();
+    threadCount_ = count;
+    startWorkers(count - 1);
+}
+
+ThreadPool::~ThreadPool() {
+    stopWorkers();
+}
+
+void ThreadPool::setThreadCount(int count) {
+    if (count <= 0) count = defaultThreadCount();
+    std::lock_guard<std::mutex> jobLock(jobMutex_);
+    std::lock_guard<std::mutex> configLock(configMutex_);
+    if (count == threadCount_) return;
+    stopWorkers();
+    threadCount_ = count;
+    startWorkers(count - 1);
+}
+
+int ThreadPool::threadCount() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return threadCount_;
+}
+
+void ThreadPool::startWorkers(int workerCount) {
+    std::vector<Slot> slots(static_cast<size_t>(workerCount + 1));
+    slots_.swap(slots);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = false;
+    }
+    workers_.reserve(static_cast<size_t>(workerCount));
+    for (int i = 0; i < workerCount; i++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i + 1);
+    }
+}
+
+void ThreadPool::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wakeCv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+}
+
+void ThreadPool::workerLoop(int participant) {
+    tlsInParallelRegion = true;
+    stats::setThreadName(("andas-worker-" + std::to_string(participant)).c_str());
+    uint64_t seenGeneration;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        seenGeneration = generation_;
+    }
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wakeCv_.wait(lock, [&] { return stopping_ || generation_ != seenGeneration; });
+            if (stopping_) return;
+            seenGeneration = generation_;
+            if (body_ == nullptr) continue;
+            activeWorkers_.fetch_add(1, std::memory_order_acq_rel);
+        }
+        participate(participant);
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            activeWorkers_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        doneCv_.notify_all();
+    }
+}
+
+void ThreadPool::participate(int participant) {
+    // 追踪中每个参与者一段区间，用来观察各线程的负载是否均衡
+    static const int32_t span = stats::registerName("ThreadPool.participate");
+    stats::TraceSpan trace(span);
+    const int participants = static_cast<int>(slots_.size());
+    // 先处理自己的区间，再按顺序从其他参与者处窃取剩余块
+    for (int k = 0; k < participants; k++) {
+        Slot& slot = slots_[static_cast<size_t>((participant + k) % participants)];
+        for (;;) {
+            int64_t chunk = slot.next.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= slot.end) break;
+            runChunk(chunk);
+        }
+    }
+}
+
+bool ThreadPool::runChunk(int64_t chunk) {
+    try {
+        (*body_)(chunk);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        if (!error_) error_ = std::current_exception();
+    }
+    int64_t done = chunksDone_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (done == chunkCount_) {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        doneCv_.notify_all();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::run(int64_t chunkCount, const std::function<void(int64_t)>& body) {
+    if (chunkCount <= 0) return;
+
+    auto runSerial = [&] {
+        ParallelRegionGuard guard;
+        for (int64_t chunk = 0; chunk < chunkCount; chunk++) body(chunk);
+    };
+
+    if (chunkCount == 1 || tlsInParallelRegion) {
+        runSerial();
+        return;
+    }
+    // 其他线程正在使用线程池时不排队等待，直接在调用线程串行执行
+    std::unique_lock<std::mutex> jobLock(jobMutex_, std::try_to_lock);
+    if (!jobLock.owns_lock() || workers_.empty()) {
+        runSerial();
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        // 等待上一任务中迟到的工作线程全部退出，再重置任务状态
+        doneCv_.wait(lock, [&] { return activeWorkers_.load(std::memory_order_acquire) == 0; });
+
+        const int64_t participants = static_cast<int64_t>(slots_.size());
+        const int64_t perSlot = (chunkCount + participants - 1) / participants;
+        for (int64_t i = 0; i < participants; i++) {
+            Slot& slot = slots_[static_cast<size_t>(i)];
+            int64_t lo = std::min(chunkCount, i * perSlot);
+            slot.next.store(lo, std::memory_order_relaxed);
+            slot.end = std::min(chunkCount, lo + perSlot);
+        }
+        chunkCount_ = chunkCount;
+        chunksDone_.store(0, std::memory_order_relaxed);
+        error_ = nullptr;
+        body_ = &body;
+        ++generation_;
+    }
+    wakeCv_.notify_all();
+
+    {
+        ParallelRegionGuard guard;
+        participate(0);
+    }
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        doneCv_.wait(lock, [&] {
+            return chunksDone_.load(std::memory_order_acquire) == chunkCount_ &&
+                   activeWorkers_.load(std::memory_order_acquire) == 0;
+        });
+        body_ = nullptr;
+        error = error_;
+        error_ = nullptr;
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace andas
@@ -0,0 +1,180 @@
+#ifndef ANDAS_THREAD_POOL_H
+#define ANDAS_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace andas {
+
+// 原生并行运行时
+// - 常驻工作线程，避免每次JNI调用创建线程
+// - 任务按块(chunk)切分，每个参与者持有一段连续的块区间，
+//   自己的区间处理完后从其他参与者处窃取(work stealing)
+// - 调用线程本身也作为参与者执行任务
+// - 数据量小于阈值时直接串行执行，避免线程调度开销
+class ThreadPool {
+public:
+    static ThreadPool& instance();
+
+    // 设置参与计算的线程总数（包含调用线程），<= 0 表示使用CPU核心数
+    void setThreadCount(int count);
+    int threadCount() const;
+
+    // 执行 chunkCount 个块任务，阻塞直到全部完成
+    // body(chunkIndex) 可能在任意参与线程上执行
+    void run(int64_t chunkCount, const std::function<void(int64_t)>& body);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    ThreadPool();
+    ~ThreadPool();
+
+    struct alignas(64) Slot {
+        std::atomic<int64_t> next{0};
+        int64_t end = 0;
+    };
+
+    void startWorkers(int workerCount);
+    void stopWorkers();
+    void workerLoop(int participant);
+    void participate(int participant);
+    bool runChunk(int64_t chunk);
+
+    std::vector<std::thread> workers_;
+    mutable std::mutex configMutex_;   // 保护线程数变更
+    std::mutex jobMutex_;              // 同一时刻只允许一个并行任务占用线程池
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    std::condition_variable doneCv_;
+
+    // 当前任务状态
+    const std::function<void(int64_t)>* body_ = nullptr;
+    std::vector<Slot> slots_;
+    int64_t chunkCount_ = 0;
+    std::atomic<int64_t> chunksDone_{0};
+    std::atomic<int> activeWorkers_{0};
+    uint64_t generation_ = 0;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+    std::mutex errorMutex_;
+
+    int threadCount_ = 1;
+};
+
+// 低于该元素数量的操作串行执行
+int64_t parallelThreshold();
+void setParallelThreshold(int64_t threshold);
+
+// 当前线程是否为线程池工作线程（用于嵌套并行时退化为串行）
+bool inParallelRegion();
+
+namespace detail {
+
+struct ChunkPlan {
+    int64_t grain;
+    int64_t chunks;
+};
+
+// 按线程数和数据量规划分块：每线程约4个块，便于负载均衡和窃取
+inline ChunkPlan planChunks(int64_t n, int threads, int64_t minGrain) {
+    int64_t target = static_cast<int64_t>(threads) * 4;
+    int64_t grain = std::max<int64_t>(minGrain, (n + target - 1) / target);
+    return {grain, (n + grain - 1) / grain};
+}
+
+inline bool shouldRunSerial(int64_t n) {
+    return n < parallelThreshold() || ThreadPool::instance().threadCount() <= 1 || inParallelRegion();
+}
+
+} // namespace detail
+
+// 分块并行循环：body(lo, hi) 处理区间 [lo, hi)
+template <typename Body>
+void parallel_for(int64_t begin, int64_t end, Body&& body, int64_t minGrain = 4096) {
+    const int64_t n = end - begin;
+    if (n <= 0) return;
+    if (detail::shouldRunSerial(n)) {
+        body(begin, end);
+        return;
+    }
+    ThreadPool& pool = ThreadPool::instance();
+    const detail::ChunkPlan plan = detail::planChunks(n, pool.threadCount(), minGrain);
+    std::function<void(int64_t)> task = [&](int64_t chunk) {
+        int64_t lo = begin + chunk * plan.grain;
+        int64_t hi = std::min(end, lo + plan.grain);
+        body(lo, hi);
+    };
+    pool.run(plan.chunks, task);
+}
+
+// 分块并行归约：map(lo, hi) 计算块内部分结果，combine(a, b) 合并
+// 合并按块顺序串行进行，结果与线程调度无关（浮点求和结果可复现）
+template <typename T, typename Map, typename Combine>
+T parallel_reduce(int64_t begin, int64_t end, T identity, Map&& map, Combine&& combine,
+                  int64_t minGrain = 4096) {
+    const int64_t n = end - begin;
+    if (n <= 0) return identity;
+    if (detail::shouldRunSerial(n)) {
+        return combine(std::move(identity), map(begin, end));
+    }
+    ThreadPool& pool = ThreadPool::instance();
+    const detail::ChunkPlan plan = detail::planChunks(n, pool.threadCount(), minGrain);
+    std::vector<T> partials(static_cast<size_t>(plan.chunks), identity);
+    std::function<void(int64_t)> task = [&](int64_t chunk) {
+        int64_t lo = begin + chunk * plan.grain;
+        int64_t hi = std::min(end, lo + plan.grain);
+        partials[static_cast<size_t>(chunk)] = map(lo, hi);
+    };
+    pool.run(plan.chunks, task);
+    T result = std::move(identity);
+    for (auto& part : partials) {
+        result = combine(std::move(result), std::move(part));
+    }
+    return result;
+}
+
+// 并行排序：各块独立排序后逐层两两归并
+template <typename RandomIt, typename Compare>
+void parallel_sort(RandomIt first, RandomIt last, Compare comp) {
+    const int64_t n = last - first;
+    if (n <= 1) return;
+    if (detail::shouldRunSerial(n)) {
+        std::sort(first, last, comp);
+        return;
+    }
+    ThreadPool& pool = ThreadPool::instance();
+    const int64_t chunks = std::min<int64_t>(pool.threadCount(), (n + 4095) / 4096);
+    const int64_t grain = (n + chunks - 1) / chunks;
+
+    std::function<void(int64_t)> sortTask = [&](int64_t chunk) {
+        int64_t lo = chunk * grain;
+        int64_t hi = std::min(n, lo + grain);
+        if (lo < hi) std::sort(first + lo, first + hi, comp);
+    };
+    pool.run(chunks, sortTask);
+
+    for (int64_t width = grain; width < n; width *= 2) {
+        const int64_t pairs = (n + 2 * width - 1) / (2 * width);
+        std::function<void(int64_t)> mergeTask = [&](int64_t pair) {
+            int64_t lo = pair * 2 * width;
+            int64_t mid = std::min(n, lo + width);
+            int64_t hi = std::min(n, lo + 2 * width);
+            if (mid < hi) std::inplace_merge(first + lo, first + mid, first + hi, comp);
+        };
+        pool.run(pairs, mergeTask);
+    }
+}
+
+} // namespace andas
+
+#endif //ANDAS_THREAD_POOL_H
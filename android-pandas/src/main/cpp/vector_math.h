@@ -0,0 +1,210 @@
+#ifndef ANDAS_VECTOR_MATH_H
+#define ANDAS_VECTOR_MATH_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace andas {
+namespace vmath {
+
+// 可向量化的超越函数（exp/log/sin/cos）
+// - 主循环是无分支的多项式逼近（范围约简 + Horner），只用浮点运算、64 位整数加法/移位和条件选择，
+//   编译器可以直接向量化；simd_kernels_* 在各自的目标指令集下实例化这些循环
+// - 逼近范围之外的元素（NaN、无穷、溢出/下溢边界、sin/cos 的大参数）由随后的标量循环改用 libm，
+//   因此特殊值的结果与 libm 完全一致；范围内误差不超过 2 ulp 左右
+// - 按 kChunk 个元素分段，每段先复制输入，out 可以与 x 相同
+
+constexpr int64_t kChunk = 256;
+
+// 2^52 + 2^51：加上后低位即为四舍五入到整数的结果，避免向量化不友好的 double -> int64 转换
+constexpr double kRoundMagic = 6755399441055744.0;
+
+inline uint64_t bitsOf(double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+inline double fromBits(uint64_t bits) {
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// ==================== exp ====================
+
+constexpr double kExpLimit = 708.0;   // |x| 不超过该值时结果为正规数，2^k 不溢出
+
+inline double expCore(double x) {
+    const double ln2Hi = 6.93147180369123816490e-01;
+    const double ln2Lo = 1.90821492927058770002e-10;
+    const double log2e = 1.44269504088896338700e+00;
+    // 不在范围内的元素随后由 libm 重新计算，这里只需保证中间值有限
+    x = x > kExpLimit ? kExpLimit : x;
+    x = x < -kExpLimit ? -kExpLimit : x;
+    x = x == x ? x : 0.0;
+    const double t = x * log2e + kRoundMagic;
+    const double k = t - kRoundMagic;
+    const double r = (x - k * ln2Hi) - k * ln2Lo;   // |r| <= ln2 / 2
+    // e^r 的泰勒展开到 r^13，截断误差约 4e-18；用 Estrin 格式求值，依赖链比 Horner 短得多，
+    // 向量化后不再受乘加延迟限制
+    const double r2 = r * r;
+    const double r4 = r2 * r2;
+    const double r8 = r4 * r4;
+    const double a0 = 1.0 + r;
+    const double a1 = 1.0 / 2.0 + r * (1.0 / 6.0);
+    const double a2 = 1.0 / 24.0 + r * (1.0 / 120.0);
+    const double a3 = 1.0 / 720.0 + r * (1.0 / 5040.0);
+    const double a4 = 1.0 / 40320.0 + r * (1.0 / 362880.0);
+    const double a5 = 1.0 / 3628800.0 + r * (1.0 / 39916800.0);
+    const double a6 = 1.0 / 479001600.0 + r * (1.0 / 6227020800.0);
+    const double b0 = a0 + r2 * a1;
+    const double b1 = a2 + r2 * a3;
+    const double b2 = a4 + r2 * a5;
+    const double d0 = b0 + r4 * b1;
+    const double d1 = b2 + r4 * a6;
+    const double p = d0 + r8 * d1;
+    // t 的低位是 k 的补码，加上偏置后移到指数位即为 2^k
+    const double scale = fromBits((bitsOf(t) + 1023) << 52);
+    return p * scale;
+}
+
+inline bool expInRange(double x) {
+    return std::fabs(x) <= kExpLimit;
+}
+
+// ==================== log ====================
+
+constexpr double kMinNormal = 2.2250738585072014e-308;
+constexpr double kMaxFinite = 1.7976931348623157e308;
+
+inline double logCore(double x) {
+    const double ln2Hi = 6.93147180369123816490e-01;
+    const double ln2Lo = 1.90821492927058770002e-10;
+    const double sqrt2 = 1.41421356237309514547e+00;
+    const double lg1 = 6.666666666666735130e-01;
+    const double lg2 = 3.999999999940941908e-01;
+    const double lg3 = 2.857142874366239149e-01;
+    const double lg4 = 2.222219843214978396e-01;
+    const double lg5 = 1.818357216161805012e-01;
+    const double lg6 = 1.531383769920937332e-01;
+    const double lg7 = 1.479819860511658591e-01;
+    x = x >= kMinNormal && x <= kMaxFinite ? x : 1.0;
+    const uint64_t bits = bitsOf(x);
+    // x = m * 2^e，m 在 [1, 2)；m > sqrt(2) 时改为 m / 2，使 f = m - 1 在 [sqrt(2)/2 - 1, sqrt(2) - 1] 内
+    double m = fromBits((bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL);
+    // 无符号的 2^52 + 偏置指数，减去常数即为 e，不需要整数到浮点的转换
+    double e = fromBits(0x4330000000000000ULL | (bits >> 52)) - (4503599627370496.0 + 1023.0);
+    const bool high = m > sqrt2;
+    m = high ? m * 0.5 : m;
+    e = high ? e + 1.0 : e;
+    const double f = m - 1.0;
+    // fdlibm 的 log1p 核心：log(1 + f) = f - hfsq + s * (hfsq + R)
+    const double s = f / (2.0 + f);
+    const double z = s * s;
+    const double w = z * z;
+    const double t1 = w * (lg2 + w * (lg4 + w * lg6));
+    const double t2 = z * (lg1 + w * (lg3 + w * (lg5 + w * lg7)));
+    const double rr = t2 + t1;
+    const double hfsq = 0.5 * f * f;
+    return e * ln2Hi - ((hfsq - (s * (hfsq + rr) + e * ln2Lo)) - f);
+}
+
+inline bool logInRange(double x) {
+    return x >= kMinNormal && x <= kMaxFinite;
+}
+
+// ==================== sin / cos ====================
+
+constexpr double kTrigLimit = 1e5;   // Cody-Waite 三段约简在该范围内精确
+
+// 约简到 [-pi/4, pi/4]，返回 r 与象限 (0..3)
+inline double trigReduce(double x, uint64_t* quadrant) {
+    const double twoOverPi = 6.36619772367581382433e-01;
+    const double pio2_1 = 1.57079632673412561417e+00;
+    const double pio2_2 = 6.07710050630396597660e-11;
+    const double pio2_2t = 2.02226624879595063154e-21;
+    x = std::fabs(x) <= kTrigLimit ? x : 0.0;
+    const double t = x * twoOverPi + kRoundMagic;
+    const double j = t - kRoundMagic;
+    *quadrant = bitsOf(t) & 3;
+    return ((x - j * pio2_1) - j * pio2_2) - j * pio2_2t;
+}
+
+// fdlibm 的 __kernel_sin / __kernel_cos 系数，|r| <= pi/4
+inline double sinPoly(double r) {
+    const double z = r * r;
+    const double p = -1.66666666666666324348e-01 + z * (8.33333333332248946124e-03 + z * (-1.98412698298579493134e-04 +
+                     z * (2.75573137070700676789e-06 + z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10))));
+    return r + r * z * p;
+}
+
+inline double cosPoly(double r) {
+    const double z = r * r;
+    const double p = 4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03 + z * (2.48015872894767294178e-05 +
+                     z * (-2.75573143513906633035e-07 + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11))));
+    const double hz = 0.5 * z;
+    const double w = 1.0 - hz;
+    return w + (((1.0 - w) - hz) + z * z * p);
+}
+
+// 按象限选择 sin/cos 多项式并修正符号；只用 64 位与/或/异或/减法，SSE2 也能向量化
+inline double trigSelect(double s, double c, uint64_t useCos, uint64_t negate) {
+    const uint64_t mask = 0 - (useCos & 1);
+    const uint64_t bits = (bitsOf(c) & mask) | (bitsOf(s) & ~mask);
+    return fromBits(bits ^ ((negate & 2) << 62));
+}
+
+inline double sinCore(double x) {
+    uint64_t q;
+    const double r = trigReduce(x, &q);
+    return trigSelect(sinPoly(r), cosPoly(r), q, q);
+}
+
+inline double cosCore(double x) {
+    uint64_t q;
+    const double r = trigReduce(x, &q);
+    return trigSelect(sinPoly(r), cosPoly(r), q ^ 1, q + 1);
+}
+
+inline bool trigInRange(double x) {
+    return std::fabs(x) <= kTrigLimit;
+}
+
+// ==================== 循环 ====================
+
+// 先对整段做无分支的逼近，再把范围外的元素改用 libm
+// 强制内联：循环要在调用方的 target 属性（SSE2/AVX2）下编译才能用上对应宽度的向量
+#define ANDAS_VMATH_INLINE __attribute__((always_inline)) inline
+
+template <double (*Core)(double), bool (*InRange)(double), double (*Exact)(double)>
+ANDAS_VMATH_INLINE void applyChunked(const double* x, double* out, int64_t n) {
+    double in[kChunk];
+    for (int64_t start = 0; start < n; start += kChunk) {
+        const int64_t len = n - start < kChunk ? n - start : kChunk;
+        std::memcpy(in, x + start, static_cast<size_t>(len) * sizeof(double));
+        double* o = out + start;
+        for (int64_t i = 0; i < len; i++) o[i] = Core(in[i]);
+        for (int64_t i = 0; i < len; i++) {
+            if (!InRange(in[i])) o[i] = Exact(in[i]);
+        }
+    }
+}
+
+inline double libmExp(double x) { return std::exp(x); }
+inline double libmLog(double x) { return std::log(x); }
+inline double libmSin(double x) { return std::sin(x); }
+inline double libmCos(double x) { return std::cos(x); }
+
+ANDAS_VMATH_INLINE void expLoop(const double* x, double* out, int64_t n) { applyChunked<expCore, expInRange, libmExp>(x, out, n); }
+ANDAS_VMATH_INLINE void logLoop(const double* x, double* out, int64_t n) { applyChunked<logCore, logInRange, libmLog>(x, out, n); }
+ANDAS_VMATH_INLINE void sinLoop(const double* x, double* out, int64_t n) { applyChunked<sinCore, trigInRange, libmSin>(x, out, n); }
+ANDAS_VMATH_INLINE void cosLoop(const double* x, double* out, int64_t n) { applyChunked<cosCore, trigInRange, libmCos>(x, out, n); }
+
+#undef ANDAS_VMATH_INLINE
+
+} // namespace vmath
+} // namespace andas
+
+#endif //ANDAS_VECTOR_MATH_H
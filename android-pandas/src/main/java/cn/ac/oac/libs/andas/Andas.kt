@@ -2,6 +2,9 @@ package cn.ac.oac.libs.andas
 
 import android.content.Context
 import cn.ac.oac.libs.andas.core.AndaThreadPool
+import cn.ac.oac.libs.andas.core.NativeRuntime
+import cn.ac.oac.libs.andas.core.SpillEngine
+import cn.ac.oac.libs.andas.core.NativeStats
 import cn.ac.oac.libs.andas.core.asyncIO
 import cn.ac.oac.libs.andas.core.asyncCompute
 import cn.ac.oac.libs.andas.entity.DataFrame
@@ -62,6 +65,9 @@ class Andas private constructor() {
         var timeoutSeconds = 30L
         var memoryOptimization = true
         var maxConcurrentTasks = 4
+        var nativeThreads = 0 // 原生计算线程数，0 表示使用CPU核心数
+        var nativeMemoryLimit = 0L // 原生内存预算（字节），0 表示不限制
+        var spillMemoryBudget = 64L shl 20 // 外存排序、溢写分组各自的内存预算（字节），超出时写到缓存目录
         var logLevel = LogLevel.INFO
         var errorHandler: ((Exception) -> Unit)? = null
         
@@ -69,6 +75,15 @@ class Andas private constructor() {
             if (maxConcurrentTasks < 1) {
                 throw IllegalArgumentException("最大并发任务数必须大于0")
             }
+            if (nativeThreads < 0) {
+                throw IllegalArgumentException("原生线程数不能为负数")
+            }
+            if (nativeMemoryLimit < 0) {
+                throw IllegalArgumentException("原生内存预算不能为负数")
+            }
+            if (spillMemoryBudget <= 0) {
+                throw IllegalArgumentException("溢写内存预算必须大于0")
+            }
         }
     }
     
@@ -100,6 +115,16 @@ class Andas private constructor() {
                 cacheDir.mkdirs()
             }
             
+            // 配置原生线程池
+            if (NativeRuntime.isAvailable()) {
+                NativeRuntime.setNumThreads(config.nativeThreads)
+                NativeRuntime.setMemoryLimit(config.nativeMemoryLimit)
+            }
+            
+            // 外存排序和溢写分组的临时文件放在应用私有的缓存目录
+            SpillEngine.directory = File(cacheDir, "spill")
+            SpillEngine.memoryBudget = config.spillMemoryBudget
+            
             initialized = true
             
             logInfo("Andas SDK初始化成功")
@@ -477,7 +502,11 @@ class Andas private constructor() {
             "initialized" to initialized,
             "debug_mode" to config.debugMode,
             "cache_directory" to getCacheDirectory().absolutePath,
-            "thread_pool_stats" to AndaThreadPool.getThreadPoolStats()
+            "thread_pool_stats" to AndaThreadPool.getThreadPoolStats(),
+            "native_threads" to (if (NativeRuntime.isAvailable()) NativeRuntime.getNumThreads() else 0),
+            "native_simd" to (if (NativeRuntime.isAvailable()) NativeRuntime.getSimdLevel() else "unavailable"),
+            "native_memory" to (if (NativeRuntime.isAvailable()) NativeRuntime.memoryStats().toMap() else emptyMap()),
+            "native_stats" to NativeStats.snapshot().toMap()
         )
     }
     
@@ -0,0 +1,159 @@
+package cn.ac.oac.libs.andas.core
+
+import java.io.Closeable
+import java.util.concurrent.ArrayBlockingQueue
+import java.util.concurrent.Callable
+import java.util.concurrent.ExecutionException
+import java.util.concurrent.ExecutorCompletionService
+import java.util.concurrent.Executors
+import java.util.concurrent.Future
+import java.util.concurrent.TimeUnit
+
+/**
+ * 预取迭代器：后台线程运行 producer，产生的元素放进容量为 capacity 的有界队列，调用方按顺序取出
+ * - 队列满时 producer 阻塞（背压），内存中最多有 capacity 个已产生但未取出的元素
+ * - producer 抛出的异常在取到该位置时原样抛给调用方
+ * - 没取完就 [close] 时 producer 在下一次产生元素时停止；关闭会等待后台线程结束
+ *
+ * 后台线程在整个读取期间阻塞于 I/O 和背压，使用独立线程而不占用 [AndaThreadPool] 的线程
+ */
+class PrefetchIterator<T : Any> internal constructor(
+    capacity: Int,
+    name: String,
+    producer: (emit: (T) -> Unit) -> Unit
+) : Iterator<T>, Closeable {
+
+    // 结束标记和异常包装，与元素放在同一个队列中以保持顺序
+    private object End
+    private class Failure(val error: Throwable)
+    private class Cancelled : RuntimeException()
+
+    init {
+        if (capacity <= 0) throw IllegalArgumentException("预取容量必须为正数: $capacity")
+    }
+
+    private val queue = ArrayBlockingQueue<Any>(capacity)
+    @Volatile
+    private var closed = false
+    private var buffered: T? = null
+    private var finished = false
+
+    private val thread = Thread({
+        try {
+            producer { item ->
+                if (closed) throw Cancelled()
+                queue.put(item)
+            }
+            if (!closed) queue.put(End)
+        } catch (e: Cancelled) {
+            // 调用方已关闭
+        } catch (e: Throwable) {
+            if (!closed) queue.put(Failure(e))
+        }
+    }, name)
+
+    init {
+        thread.isDaemon = true
+        thread.start()
+    }
+
+    override fun hasNext(): Boolean {
+        if (buffered != null) return true
+        if (finished) return false
+        check(!closed) { "预取迭代器已关闭" }
+        when (val item = queue.take()) {
+            End -> {
+                finished = true
+                return false
+            }
+            is Failure -> {
+                finished = true
+                throw item.error
+            }
+            else -> {
+                @Suppress("UNCHECKED_CAST")
+                buffered = item as T
+                return true
+            }
+        }
+    }
+
+    override fun next(): T {
+        if (!hasNext()) throw NoSuchElementException()
+        val item = buffered!!
+        buffered = null
+        return item
+    }
+
+    override fun close() {
+        if (closed) return
+        closed = true
+        buffered = null
+        // producer 可能阻塞在 put 上，清空队列使其继续，直到它看到 closed 后退出
+        while (thread.isAlive) {
+            queue.clear()
+            thread.join(10)
+        }
+        queue.clear()
+    }
+}
+
+/**
+ * 分批流水线：source 在调用线程上逐个取出批次，由 workers 个工作线程执行 transform，结果在调用线程上交给 consumer
+ * - 同时在处理中的批次最多 2 × workers 个，consumer 跟不上时不再从 source 取批次（背压）
+ * - ordered 为 true 时按批次顺序交付，否则按完成顺序交付
+ * - transform 或 consumer 抛出异常时停止取批次，原样抛出第一个异常
+ */
+internal object BatchPipeline {
+
+    fun <T, R> run(
+        source: Iterator<T>,
+        workers: Int,
+        ordered: Boolean,
+        transform: (T) -> R,
+        consumer: (R) -> Unit
+    ) {
+        if (workers <= 0) throw IllegalArgumentException("工作线程数必须为正数: $workers")
+        val executor = Executors.newFixedThreadPool(workers) { runnable ->
+            Thread(runnable, "andas-batch-worker").apply { isDaemon = true }
+        }
+        try {
+            val completion = ExecutorCompletionService<R>(executor)
+            val inFlight = ArrayDeque<Future<R>>()
+            val limit = workers * 2
+
+            fun deliver(future: Future<R>) {
+                inFlight.remove(future)
+                val result = try {
+                    future.get()
+                } catch (e: ExecutionException) {
+                    throw e.cause ?: e
+                }
+                consumer(result)
+            }
+
+            // 交付已完成的结果；block 为 true 时至少交付一个
+            fun drain(block: Boolean) {
+                if (ordered) {
+                    if (block) deliver(inFlight.first())
+                    while (inFlight.isNotEmpty() && inFlight.first().isDone) deliver(inFlight.first())
+                } else {
+                    if (block) deliver(completion.take())
+                    while (true) deliver(completion.poll() ?: break)
+                }
+            }
+
+            while (source.hasNext()) {
+                val item = source.next()
+                // 有序交付不经过 completion 的完成队列，避免其中积累已完成的任务
+                val task = Callable { transform(item) }
+                inFlight.addLast(if (ordered) executor.submit(task) else completion.submit(task))
+                drain(inFlight.size >= limit)
+            }
+            while (inFlight.isNotEmpty()) drain(true)
+        } finally {
+            executor.shutdownNow()
+            executor.awaitTermination(1, TimeUnit.MINUTES)
+        }
+    }
+}
@@ -0,0 +1,348 @@
+package cn.ac.oac.libs.andas.core
+
+import java.io.Closeable
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * 列式文件的列类型，编码与原生层 ColumnarType 一致
+ */
+enum class ColumnarType(val code: Int) {
+    BOOL(1),
+    INT32(2),
+    INT64(3),
+    FLOAT64(4),
+    STRING(5);
+
+    companion object {
+        fun fromCode(code: Int): ColumnarType =
+            values().firstOrNull { it.code == code } ?: throw IllegalArgumentException("未知的列类型: $code")
+    }
+}
+
+/**
+ * 一个统计块：行 [startRow, startRow + rowCount) 中非空值的最小值和最大值，整块为空时两者为 null
+ */
+data class ColumnChunkStats(
+    val startRow: Int,
+    val rowCount: Int,
+    val min: Number?,
+    val max: Number?
+)
+
+/**
+ * 二进制列式文件写入器
+ * 每次写入一整列并立即写出，内存中不保留已写的列；所有列写完后调用 finish() 生成有效文件，
+ * 未调用 finish() 就 close() 时文件无效
+ *
+ * @param rowCount 每列的行数
+ * @param statsChunkRows 每多少行记录一次 min/max 统计，<= 0 不记录
+ */
+class ColumnarWriter(
+    file: File,
+    val rowCount: Int,
+    statsChunkRows: Int = DEFAULT_STATS_CHUNK_ROWS
+) : Closeable {
+
+    private var handle: Long = NativeColumnar.openWriter(file.path, rowCount.toLong(), statsChunkRows)
+
+    fun writeBooleans(name: String, values: BooleanArray, valid: BooleanArray? = null) {
+        NativeColumnar.writeBoolean(checkOpen(), name.toByteArray(Charsets.UTF_8), rowCount.toLong(), values, valid)
+    }
+
+    fun writeInts(name: String, values: IntArray, valid: BooleanArray? = null) {
+        NativeColumnar.writeInt(checkOpen(), name.toByteArray(Charsets.UTF_8), rowCount.toLong(), values, valid)
+    }
+
+    fun writeLongs(name: String, values: LongArray, valid: BooleanArray? = null) {
+        NativeColumnar.writeLong(checkOpen(), name.toByteArray(Charsets.UTF_8), rowCount.toLong(), values, valid)
+    }
+
+    /**
+     * NaN 与 valid 中的 false 都写为空值
+     */
+    fun writeDoubles(name: String, values: DoubleArray, valid: BooleanArray? = null) {
+        NativeColumnar.writeDouble(checkOpen(), name.toByteArray(Charsets.UTF_8), rowCount.toLong(), values, valid)
+    }
+
+    /**
+     * 直接从原生列的堆外内存写出，不经过 Java 数组
+     */
+    fun writeColumn(name: String, column: NativeColumn) {
+        column.checkOpen()
+        if (column.size != rowCount) throw IllegalArgumentException("列长度与行数不一致: ${column.size}")
+        NativeColumnar.writeDoubleColumn(checkOpen(), name.toByteArray(Charsets.UTF_8), rowCount.toLong(), column.buffer)
+    }
+
+    /**
+     * 字典编码写出字符串列，相同的字符串只存一次
+     */
+    fun writeStrings(name: String, values: List<String?>) {
+        requireRows(values.size)
+        val dictionary = HashMap<String, Int>()
+        val chars = java.io.ByteArrayOutputStream()
+        val offsets = ArrayList<Long>()
+        offsets.add(0L)
+        val codes = IntArray(values.size)
+        for (i in values.indices) {
+            val value = values[i]
+            if (value == null) {
+                codes[i] = -1
+                continue
+            }
+            codes[i] = dictionary.getOrPut(value) {
+                chars.write(value.toByteArray(Charsets.UTF_8))
+                offsets.add(chars.size().toLong())
+                dictionary.size
+            }
+        }
+        NativeColumnar.writeString(
+            checkOpen(), name.toByteArray(Charsets.UTF_8), rowCount.toLong(),
+            codes, chars.toByteArray(), offsets.toLongArray()
+        )
+    }
+
+    /**
+     * 按值的类型写出一列：Boolean→BOOL，Byte/Short/Int→INT32，含 Long 的整数→INT64，
+     * 含其他数值→FLOAT64，其余（含混合类型）按 toString() 写为 STRING；全为空值时写为 STRING
+     */
+    fun writeValues(name: String, values: List<Any?>) {
+        requireRows(values.size)
+        when (inferType(values)) {
+            ColumnarType.BOOL -> {
+                val valid = validity(values)
+                writeBooleans(name, BooleanArray(values.size) { values[it] == true }, valid)
+            }
+            ColumnarType.INT32 -> {
+                val valid = validity(values)
+                writeInts(name, IntArray(values.size) { (values[it] as? Number)?.toInt() ?: 0 }, valid)
+            }
+            ColumnarType.INT64 -> {
+                val valid = validity(values)
+                writeLongs(name, LongArray(values.size) { (values[it] as? Number)?.toLong() ?: 0L }, valid)
+            }
+            ColumnarType.FLOAT64 -> {
+                writeDoubles(name, DoubleArray(values.size) { (values[it] as? Number)?.toDouble() ?: Double.NaN })
+            }
+            ColumnarType.STRING -> writeStrings(name, values.map { it?.toString() })
+        }
+    }
+
+    fun finish() {
+        val current = checkOpen()
+        handle = 0L
+        NativeColumnar.finishWriter(current)
+    }
+
+    override fun close() {
+        if (handle == 0L) return
+        NativeColumnar.abortWriter(handle)
+        handle = 0L
+    }
+
+    private fun checkOpen(): Long {
+        if (handle == 0L) throw IllegalStateException("列式文件写入器已关闭")
+        return handle
+    }
+
+    private fun requireRows(size: Int) {
+        if (size != rowCount) throw IllegalArgumentException("列长度与行数不一致: $size")
+    }
+
+    private fun validity(values: List<Any?>): BooleanArray? {
+        if (values.none { it == null }) return null
+        return BooleanArray(values.size) { values[it] != null }
+    }
+
+    private fun inferType(values: List<Any?>): ColumnarType {
+        var bools = false
+        var ints = false
+        var longs = false
+        var floats = false
+        var others = false
+        for (value in values) {
+            when (value) {
+                null -> {}
+                is Boolean -> bools = true
+                is Int, is Short, is Byte -> ints = true
+                is Long -> longs = true
+                is Number -> floats = true
+                else -> others = true
+            }
+        }
+        val numeric = ints || longs || floats
+        return when {
+            others || (bools && numeric) -> ColumnarType.STRING
+            bools -> ColumnarType.BOOL
+            floats -> ColumnarType.FLOAT64
+            longs -> ColumnarType.INT64
+            ints -> ColumnarType.INT32
+            else -> ColumnarType.STRING
+        }
+    }
+
+    companion object {
+        const val DEFAULT_STATS_CHUNK_ROWS = 65536
+    }
+}
+
+/**
+ * 内存映射的二进制列式文件
+ * 打开时只解析 schema，列数据按需由操作系统分页载入；column() 返回的列表和 nativeColumn()
+ * 返回的原生列直接读取映射内存，不复制。它们持有本对象，文件不会先于它们被回收；
+ * 显式 close() 后再访问这些列会抛出 IllegalStateException
+ */
+class ColumnarFile private constructor(
+    private var handle: Long,
+    val rowCount: Int,
+    val columnNames: List<String>,
+    val types: List<ColumnarType>,
+    private val info: LongArray
+) : Closeable {
+
+    fun type(name: String): ColumnarType = types[columnIndex(name)]
+
+    fun nullCount(name: String): Int = info[columnIndex(name) * 5 + 1].toInt()
+
+    /**
+     * 列的只读视图，空值为 null；BOOL→Boolean, INT32→Int, INT64→Long, FLOAT64→Double, STRING→String
+     * 字符串字典项在首次访问时解码
+     */
+    fun column(name: String): List<Any?> {
+        val c = columnIndex(name)
+        return when (types[c]) {
+            ColumnarType.BOOL -> object : ColumnView(c) {
+                override fun value(index: Int): Any = values.get(index).toInt() != 0
+            }
+            ColumnarType.INT32 -> object : ColumnView(c) {
+                override fun value(index: Int): Any = values.getInt(index * 4)
+            }
+            ColumnarType.INT64 -> object : ColumnView(c) {
+                override fun value(index: Int): Any = values.getLong(index * 8)
+            }
+            ColumnarType.FLOAT64 -> object : ColumnView(c) {
+                override fun value(index: Int): Any = values.getDouble(index * 8)
+            }
+            ColumnarType.STRING -> StringView(c)
+        }
+    }
+
+    /**
+     * FLOAT64 列的原生列，直接指向映射内存，原生运算不经过 Java 数组
+     * 映射为写时复制，原地修改只影响本进程，不会写回文件
+     */
+    fun nativeColumn(name: String): NativeColumn {
+        val c = columnIndex(name)
+        if (types[c] != ColumnarType.FLOAT64) throw IllegalArgumentException("列不是FLOAT64类型: $name")
+        return NativeColumn.wrap(part(c, NativeColumnar.PART_VALUES)!!, rowCount, this)
+    }
+
+    /**
+     * 数值列的分块 min/max 统计，可用于跳过不满足条件的行块；没有统计时返回空列表
+     */
+    fun chunkStats(name: String): List<ColumnChunkStats> {
+        val c = columnIndex(name)
+        val chunkRows = info[c * 5 + 3].toInt()
+        val count = info[c * 5 + 4].toInt()
+        val stats = part(c, NativeColumnar.PART_STATS) ?: return emptyList()
+        return List(count) { k ->
+            val start = k * chunkRows
+            val rows = minOf(chunkRows, rowCount - start)
+            if (types[c] == ColumnarType.FLOAT64) {
+                val lo = stats.getDouble(k * 16)
+                val hi = stats.getDouble(k * 16 + 8)
+                if (lo > hi) ColumnChunkStats(start, rows, null, null) else ColumnChunkStats(start, rows, lo, hi)
+            } else {
+                val lo = stats.getLong(k * 16)
+                val hi = stats.getLong(k * 16 + 8)
+                if (lo > hi) ColumnChunkStats(start, rows, null, null) else ColumnChunkStats(start, rows, lo, hi)
+            }
+        }
+    }
+
+    fun isClosed(): Boolean = handle == 0L
+
+    @Synchronized
+    override fun close() {
+        if (handle == 0L) return
+        val current = handle
+        handle = 0L
+        NativeColumnar.closeFile(current)
+    }
+
+    // 未显式关闭时，所有列视图都不再被引用后由GC解除映射
+    protected fun finalize() {
+        close()
+    }
+
+    private fun checkOpen() {
+        if (handle == 0L) throw IllegalStateException("列式文件已关闭")
+    }
+
+    private fun columnIndex(name: String): Int {
+        val c = columnNames.indexOf(name)
+        if (c < 0) throw IllegalArgumentException("列不存在: $name")
+        return c
+    }
+
+    private fun part(column: Int, part: Int): ByteBuffer? {
+        checkOpen()
+        return NativeColumnar.buffer(handle, column, part)?.order(ByteOrder.nativeOrder())
+    }
+
+    private abstract inner class ColumnView(column: Int) : AbstractList<Any?>(), RandomAccess {
+        protected val values: ByteBuffer = part(column, NativeColumnar.PART_VALUES)!!
+        private val validity: ByteBuffer? = part(column, NativeColumnar.PART_VALIDITY)
+
+        override val size: Int get() = rowCount
+
+        override fun get(index: Int): Any? {
+            if (index < 0 || index >= rowCount) throw IndexOutOfBoundsException("索引越界: $index")
+            checkOpen()
+            if (validity != null && (validity.get(index ushr 3).toInt() shr (index and 7)) and 1 == 0) return null
+            return value(index)
+        }
+
+        abstract fun value(index: Int): Any
+    }
+
+    private inner class StringView(column: Int) : ColumnView(column) {
+        private val offsets: ByteBuffer = part(column, NativeColumnar.PART_DICT_OFFSETS)!!
+        private val chars: ByteBuffer? = part(column, NativeColumnar.PART_DICT_CHARS)
+        private val dictionary = arrayOfNulls<String>(info[column * 5 + 2].toInt())
+
+        override fun value(index: Int): Any {
+            val code = values.getInt(index * 4)
+            dictionary[code]?.let { return it }
+            val start = offsets.getLong(code * 8).toInt()
+            val end = offsets.getLong(code * 8 + 8).toInt()
+            val bytes = ByteArray(end - start)
+            if (bytes.isNotEmpty()) chars!!.duplicate().apply { position(start) }.get(bytes)
+            val decoded = String(bytes, Charsets.UTF_8)
+            dictionary[code] = decoded
+            return decoded
+        }
+    }
+
+    companion object {
+        /**
+         * 映射并打开列式文件，只读取 schema，与文件大小无关
+         */
+        fun open(file: File): ColumnarFile {
+            if (!file.exists()) throw IllegalArgumentException("文件不存在: ${file.absolutePath}")
+            val handle = NativeColumnar.openFile(file.path)
+            try {
+                val rows = NativeColumnar.rowCount(handle)
+                if (rows > Int.MAX_VALUE) throw IllegalArgumentException("行数超出支持范围: $rows")
+                val names = NativeColumnar.columnNames(handle).map { String(it, Charsets.UTF_8) }
+                val info = NativeColumnar.columnInfo(handle)
+                val types = names.indices.map { ColumnarType.fromCode(info[it * 5].toInt()) }
+                return ColumnarFile(handle, rows.toInt(), names, types, info)
+            } catch (e: Throwable) {
+                NativeColumnar.closeFile(handle)
+                throw e
+            }
+        }
+    }
+}
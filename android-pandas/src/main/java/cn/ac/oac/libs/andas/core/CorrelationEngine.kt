@@ -0,0 +1,161 @@
+package cn.ac.oac.libs.andas.core
+
+import kotlin.math.sqrt
+
+/**
+ * 相关系数方法，code 与原生层 CorrMethod 一致
+ */
+enum class CorrMethod(val code: Int) {
+    PEARSON(0),
+    SPEARMAN(1),   // 平均秩上的 Pearson
+    KENDALL(2);    // tau-b
+
+    companion object {
+        fun fromName(name: String): CorrMethod {
+            return when (name.lowercase()) {
+                "pearson" -> PEARSON
+                "spearman" -> SPEARMAN
+                "kendall" -> KENDALL
+                else -> throw IllegalArgumentException("不支持的相关系数方法: $name")
+            }
+        }
+    }
+}
+
+/**
+ * 相关系数/协方差矩阵入口：优先使用原生分块内核（一次遍历得到所有列对的和，多线程），
+ * 原生库不可用时逐列对计算，两者语义一致
+ *
+ * NaN 为缺失值；每对列只使用两列都不缺失的行，有效行数少于 minPeriods 或方差为 0 时结果为 NaN。
+ * 结果为 k×k 行主序矩阵
+ */
+internal object CorrelationEngine {
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeData.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    fun correlation(columns: List<DoubleArray>, method: CorrMethod, minPeriods: Int = 1): DoubleArray {
+        checkColumns(columns)
+        if (nativeAvailable) {
+            return NativeData.correlationMatrix(columns.toTypedArray(), method.code, minPeriods)
+        }
+        return pairwise(columns) { a, b, x, y ->
+            when {
+                x.size < maxOf(1, minPeriods) -> Double.NaN
+                method == CorrMethod.KENDALL -> if (a == b) 1.0 else kendall(x, y)
+                else -> {
+                    val r = if (method == CorrMethod.SPEARMAN) pearson(ranks(x), ranks(y)) else pearson(x, y)
+                    if (a == b && !r.isNaN()) 1.0 else r
+                }
+            }
+        }
+    }
+
+    fun covariance(columns: List<DoubleArray>, minPeriods: Int = 1, ddof: Int = 1): DoubleArray {
+        checkColumns(columns)
+        if (nativeAvailable) {
+            return NativeData.covarianceMatrix(columns.toTypedArray(), minPeriods, ddof)
+        }
+        return pairwise(columns) { _, _, x, y ->
+            val n = x.size
+            if (n < maxOf(1, minPeriods) || n <= ddof) {
+                Double.NaN
+            } else {
+                val meanX = x.average()
+                val meanY = y.average()
+                var sum = 0.0
+                for (i in 0 until n) sum += (x[i] - meanX) * (y[i] - meanY)
+                sum / (n - ddof)
+            }
+        }
+    }
+
+    private fun checkColumns(columns: List<DoubleArray>) {
+        val n = columns.firstOrNull()?.size ?: return
+        if (columns.any { it.size != n }) {
+            throw IllegalArgumentException("参与计算的列长度不一致: ${columns.map { it.size }}")
+        }
+    }
+
+    /**
+     * 对每对列 (a <= b) 取两列都不缺失的行计算 value，结果对称
+     */
+    private fun pairwise(
+        columns: List<DoubleArray>,
+        value: (Int, Int, DoubleArray, DoubleArray) -> Double
+    ): DoubleArray {
+        val k = columns.size
+        val out = DoubleArray(k * k)
+        for (a in 0 until k) {
+            for (b in a until k) {
+                val rows = columns[a].indices.filter { !columns[a][it].isNaN() && !columns[b][it].isNaN() }
+                val x = DoubleArray(rows.size) { columns[a][rows[it]] }
+                val y = DoubleArray(rows.size) { columns[b][rows[it]] }
+                val r = value(a, b, x, y)
+                out[a * k + b] = r
+                out[b * k + a] = r
+            }
+        }
+        return out
+    }
+
+    private fun pearson(x: DoubleArray, y: DoubleArray): Double {
+        val meanX = x.average()
+        val meanY = y.average()
+        var cross = 0.0
+        var sqX = 0.0
+        var sqY = 0.0
+        for (i in x.indices) {
+            val dx = x[i] - meanX
+            val dy = y[i] - meanY
+            cross += dx * dy
+            sqX += dx * dx
+            sqY += dy * dy
+        }
+        if (sqX <= 0.0 || sqY <= 0.0) return Double.NaN
+        return (cross / sqrt(sqX * sqY)).coerceIn(-1.0, 1.0)
+    }
+
+    // 平均秩，从 1 开始
+    private fun ranks(x: DoubleArray): DoubleArray {
+        val order = x.indices.sortedBy { x[it] }
+        val out = DoubleArray(x.size)
+        var i = 0
+        while (i < order.size) {
+            var j = i
+            while (j + 1 < order.size && x[order[j + 1]] == x[order[i]]) j++
+            val rank = (i + j) / 2.0 + 1.0
+            for (p in i..j) out[order[p]] = rank
+            i = j + 1
+        }
+        return out
+    }
+
+    // tau-b，逐对比较
+    private fun kendall(x: DoubleArray, y: DoubleArray): Double {
+        var concordant = 0L
+        var discordant = 0L
+        var tiedX = 0L
+        var tiedY = 0L
+        for (i in x.indices) {
+            for (j in i + 1 until x.size) {
+                val sameX = x[i] == x[j]
+                val sameY = y[i] == y[j]
+                when {
+                    sameX && sameY -> {}
+                    sameX -> tiedX++
+                    sameY -> tiedY++
+                    (x[i] < x[j]) == (y[i] < y[j]) -> concordant++
+                    else -> discordant++
+                }
+            }
+        }
+        val denominator = sqrt((concordant + discordant + tiedX).toDouble() * (concordant + discordant + tiedY).toDouble())
+        return if (denominator == 0.0) Double.NaN else ((concordant - discordant) / denominator).coerceIn(-1.0, 1.0)
+    }
+}
@@ -0,0 +1,561 @@
+package cn.ac.oac.libs.andas.core
+
+import cn.ac.oac.libs.andas.entity.DictionaryColumn
+import cn.ac.oac.libs.andas.entity.StringDictionary
+import java.io.Closeable
+import java.io.File
+import java.io.FileInputStream
+import java.io.IOException
+import java.io.InputStream
+import java.io.InputStreamReader
+import java.io.Reader
+import java.nio.charset.Charset
+
+/**
+ * CSV 列类型，按提升顺序排列，编码与原生 CsvType 一致
+ */
+enum class CsvColumnType(val code: Int) {
+    EMPTY(0),    // 只见过空值
+    BOOL(1),     // true/false/yes/no，不区分大小写
+    INT32(2),
+    INT64(3),
+    FLOAT64(4),  // 含超出 Long 范围的整数
+    STRING(5);
+
+    /**
+     * 类型格上的合并：EMPTY 是单位元，数值类型取较宽者，BOOL 与数值合并为 STRING
+     */
+    fun join(other: CsvColumnType): CsvColumnType = when {
+        this == EMPTY -> other
+        other == EMPTY -> this
+        this == other -> this
+        this == BOOL || other == BOOL -> STRING
+        else -> if (code >= other.code) this else other
+    }
+
+    /**
+     * 把按本类型解析出的值转换为更宽的 target 类型；提升到 STRING 时数值按 toString 格式化
+     */
+    internal fun widen(value: Any?, target: CsvColumnType): Any? {
+        if (value == null || target == this) return value
+        return when (target) {
+            INT64 -> (value as Number).toLong()
+            FLOAT64 -> (value as Number).toDouble()
+            STRING -> value.toString()
+            else -> value
+        }
+    }
+
+    companion object {
+        private val INTEGER = Regex("-?\\d+")
+        private val NUMBER = Regex("-?\\d+(\\.\\d+)?([eE][+-]?\\d+)?")
+
+        fun fromCode(code: Int): CsvColumnType =
+            values().firstOrNull { it.code == code } ?: throw IllegalArgumentException("未知的CSV列类型: $code")
+
+        /**
+         * 单个值（已去引号和 trim）的最窄类型，规则与原生 classifyCsvValue 一致
+         */
+        fun classify(text: String): CsvColumnType {
+            if (INTEGER.matches(text)) {
+                val value = text.toLongOrNull() ?: return FLOAT64
+                return if (value >= Int.MIN_VALUE && value <= Int.MAX_VALUE) INT32 else INT64
+            }
+            if (NUMBER.matches(text)) return FLOAT64
+            if (parseBool(text) != null) return BOOL
+            return STRING
+        }
+
+        /**
+         * 按类型转换，text 必须能放进该类型
+         */
+        internal fun convert(text: String, type: CsvColumnType): Any? = when (type) {
+            EMPTY -> null
+            BOOL -> parseBool(text)
+            INT32 -> text.toInt()
+            INT64 -> text.toLong()
+            FLOAT64 -> text.toDouble()
+            STRING -> text
+        }
+
+        private fun parseBool(text: String): Boolean? = when {
+            text.equals("true", ignoreCase = true) || text.equals("yes", ignoreCase = true) -> true
+            text.equals("false", ignoreCase = true) || text.equals("no", ignoreCase = true) -> false
+            else -> null
+        }
+    }
+}
+
+/**
+ * CSV 读取选项
+ *
+ * @param sampleRows 预先推断类型的样本行数；之后放不下的值会触发整列类型提升，
+ *                   因此结果类型与样本大小无关，样本只影响需要重新解析的次数
+ * @param chunkBytes 每次从输入读取的字节数，决定流式读取的内存上限
+ * @param columns 只读取这些列，按给出的顺序输出；为 null 时读取全部列。
+ *                其余列只切分不解析，列名不存在时读取列名会抛出 IOException
+ * @param categorical 字符串列按字典编码读取，批次中的字符串列为字典编码列，
+ *                    同一列的编号在整个读取过程中不变；原生读取器在解析时直接建字典
+ */
+data class CsvOptions(
+    val delimiter: Char = ',',
+    val quote: Char = '"',
+    val header: Boolean = true,
+    val skipLines: Int = 0,
+    val trim: Boolean = true,
+    val autoType: Boolean = true,
+    val nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+    val encoding: String = "UTF-8",
+    val sampleRows: Int = 1000,
+    val chunkBytes: Int = 4 shl 20,
+    val columns: List<String>? = null,
+    val categorical: Boolean = false
+)
+
+/**
+ * 一批已解析的行，columns[c] 的值类型由 types[c] 决定：
+ * BOOL→Boolean, INT32→Int, INT64→Long, FLOAT64→Double, STRING→String，空值为 null
+ * 按字典编码读取时 STRING 列是共享读取器字典的 DictionaryColumn
+ */
+class CsvBatch(
+    val rowCount: Int,
+    val types: List<CsvColumnType>,
+    val columns: List<List<Any?>>
+)
+
+/**
+ * 流式 CSV 读取，每批的列类型不窄于之前的批次
+ */
+interface CsvStream : Closeable {
+    val columnNames: List<String>
+
+    /**
+     * 读取下一批，最多 maxRows 行，没有更多数据时返回 null
+     */
+    fun nextBatch(maxRows: Int = Int.MAX_VALUE): CsvBatch?
+}
+
+/**
+ * 流式 CSV 读取入口
+ * 原生库可用且编码为 UTF-8 时使用原生读取器（分块读取、并行解析），否则使用 Kotlin 实现；
+ * 两者的语法、空值和类型推断规则一致
+ */
+object CsvReader {
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeRuntime.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    /**
+     * 打开文件，返回的流持有文件，关闭流时一并关闭
+     */
+    fun open(file: File, options: CsvOptions = CsvOptions()): CsvStream {
+        if (useNative(options)) {
+            return NativeCsvStream(openNative(file.path, null, options))
+        }
+        return KotlinCsvStream(FileInputStream(file), options, ownsInput = true)
+    }
+
+    /**
+     * 打开数据流，关闭返回的流不会关闭 input
+     */
+    fun open(input: InputStream, options: CsvOptions = CsvOptions()): CsvStream {
+        if (useNative(options)) {
+            return NativeCsvStream(openNative(null, input, options))
+        }
+        return KotlinCsvStream(input, options, ownsInput = false)
+    }
+
+    /**
+     * 读取剩余的所有行，返回各列的值；后面的批次提升了类型时，已读的值一并转换
+     */
+    fun readAll(stream: CsvStream): List<List<Any?>> {
+        val builder = CsvColumnBuilder(stream.columnNames.size)
+        while (true) {
+            val batch = stream.nextBatch() ?: break
+            builder.append(batch)
+        }
+        return builder.columns
+    }
+
+    private fun useNative(options: CsvOptions): Boolean {
+        val utf8 = try {
+            Charset.forName(options.encoding) == Charsets.UTF_8
+        } catch (e: Exception) {
+            false
+        }
+        return nativeAvailable && utf8 &&
+            options.delimiter.code < 0x80 && options.quote.code < 0x80 && options.delimiter != options.quote
+    }
+
+    private fun openNative(path: String?, input: InputStream?, options: CsvOptions): Long {
+        return NativeCsv.open(
+            path, input, options.delimiter, options.quote, options.header, options.skipLines,
+            options.trim, options.autoType, options.nullValues.toTypedArray(), options.sampleRows, options.chunkBytes,
+            options.columns?.toTypedArray(), options.categorical
+        )
+    }
+}
+
+/**
+ * 按列累积多个批次；列类型变宽时把已累积的值转换为新类型
+ * 批次中的字典编码列按编号累积到构建器自己的字典，之前以普通值累积的字符串一并编码
+ */
+internal class CsvColumnBuilder(columnCount: Int) {
+    val types = Array(columnCount) { CsvColumnType.EMPTY }
+    private val values: List<ArrayList<Any?>> = List(columnCount) { ArrayList<Any?>() }
+    private val encoded = arrayOfNulls<EncodedColumn>(columnCount)
+    var rowCount = 0
+        private set
+
+    /**
+     * 各列的值，字典编码的列为 DictionaryColumn
+     */
+    val columns: List<List<Any?>>
+        get() = List(values.size) { c -> encoded[c]?.toColumn() ?: values[c] }
+
+    fun append(batch: CsvBatch) {
+        for (c in values.indices) {
+            val column = values[c]
+            val current = types[c]
+            val target = current.join(batch.types[c])
+            val batchType = batch.types[c]
+            val source = batch.columns[c]
+            if (target == CsvColumnType.STRING && (source is DictionaryColumn || encoded[c] != null)) {
+                val codes = encoded[c] ?: EncodedColumn().also { created ->
+                    for (value in column) created.add(current.widen(value, target) as String?)
+                    column.clear()
+                    column.trimToSize()
+                    encoded[c] = created
+                }
+                types[c] = target
+                if (source is DictionaryColumn) {
+                    codes.addAll(source)
+                } else {
+                    for (value in source) codes.add(batchType.widen(value, target) as String?)
+                }
+                continue
+            }
+            if (target != current) {
+                for (i in column.indices) column[i] = current.widen(column[i], target)
+                types[c] = target
+            }
+            if (batchType == target) {
+                column.addAll(source)
+            } else {
+                for (value in source) column.add(batchType.widen(value, target))
+            }
+        }
+        rowCount += batch.rowCount
+    }
+
+    // 一列的编号；来源字典的条目按需映射到本列字典，同一来源字典增长时只映射新增部分
+    private class EncodedColumn {
+        private val dictionary = StringDictionary()
+        private var codes = IntArray(1024)
+        private var size = 0
+        private var source: StringDictionary? = null
+        private var remap = IntArray(0)
+        private var mapped = 0
+
+        fun add(value: String?) {
+            reserve(1)
+            codes[size++] = if (value == null) -1 else dictionary.intern(value)
+        }
+
+        fun addAll(column: DictionaryColumn) {
+            val from = column.dictionary
+            if (from !== source) {
+                source = from
+                mapped = 0
+            }
+            if (remap.size < from.size) remap = remap.copyOf(maxOf(from.size, remap.size * 2))
+            while (mapped < from.size) {
+                remap[mapped] = dictionary.intern(from[mapped])
+                mapped++
+            }
+            reserve(column.size)
+            for (i in 0 until column.size) {
+                val code = column.codeAt(i)
+                codes[size++] = if (code < 0) -1 else remap[code]
+            }
+        }
+
+        fun toColumn(): DictionaryColumn = DictionaryColumn(codes.copyOf(size), dictionary)
+
+        private fun reserve(extra: Int) {
+            if (size + extra > codes.size) codes = codes.copyOf(maxOf(size + extra, codes.size * 2))
+        }
+    }
+}
+
+/**
+ * 原生读取器：每批的列以基本类型数组从 JNI 返回，这里只做装箱
+ * 字典编码的列只返回新增的字典条目，在 Kotlin 侧维护同样编号的字典镜像
+ */
+internal class NativeCsvStream(private var handle: Long) : CsvStream {
+
+    override val columnNames: List<String> = try {
+        NativeCsv.columnNames(handle).map { String(it, Charsets.UTF_8) }
+    } catch (e: Throwable) {
+        close()
+        throw e
+    }
+
+    private val mirrors = arrayOfNulls<DictionaryMirror>(columnNames.size)
+
+    override fun nextBatch(maxRows: Int): CsvBatch? {
+        check(handle != 0L) { "CSV读取器已关闭" }
+        val raw = NativeCsv.nextBatch(handle, maxRows) ?: return null
+        val header = raw[0] as IntArray
+        val rows = header[0]
+        val types = List(columnNames.size) { CsvColumnType.fromCode(header[it + 1]) }
+        val columns = List(columnNames.size) { c ->
+            val codes = raw[4 + 4 * c] as IntArray?
+            if (codes != null) {
+                val mirror = mirrors[c] ?: DictionaryMirror().also { mirrors[c] = it }
+                mirror.append(raw[1 + 4 * c] as ByteArray, raw[2 + 4 * c] as IntArray)
+                mirror.column(codes)
+            } else {
+                decodeColumn(types[c], raw[1 + 4 * c], raw[2 + 4 * c] as IntArray?, raw[3 + 4 * c] as BooleanArray?, rows)
+            }
+        }
+        return CsvBatch(rows, types, columns)
+    }
+
+    // 原生字典的镜像；非法 UTF-8 解码后可能与已有条目相同，此时原生编号经 remap 转换
+    private class DictionaryMirror {
+        val dictionary = StringDictionary()
+        private var remap = IntArray(0)
+        private var size = 0
+        private var identity = true
+
+        fun append(bytes: ByteArray, offsets: IntArray) {
+            val added = offsets.size - 1
+            if (remap.size < size + added) remap = remap.copyOf(maxOf(size + added, remap.size * 2))
+            for (i in 0 until added) {
+                val code = dictionary.intern(String(bytes, offsets[i], offsets[i + 1] - offsets[i], Charsets.UTF_8))
+                if (code != size) identity = false
+                remap[size++] = code
+            }
+        }
+
+        fun column(codes: IntArray): DictionaryColumn {
+            if (!identity) {
+                for (i in codes.indices) {
+                    if (codes[i] >= 0) codes[i] = remap[codes[i]]
+                }
+            }
+            return DictionaryColumn(codes, dictionary)
+        }
+    }
+
+    private fun decodeColumn(type: CsvColumnType, values: Any?, offsets: IntArray?, valid: BooleanArray?, rows: Int): List<Any?> {
+        val result = ArrayList<Any?>(rows)
+        for (i in 0 until rows) {
+            if (type == CsvColumnType.EMPTY || (valid != null && !valid[i])) {
+                result.add(null)
+                continue
+            }
+            result.add(
+                when (type) {
+                    CsvColumnType.BOOL -> (values as BooleanArray)[i]
+                    CsvColumnType.INT32 -> (values as IntArray)[i]
+                    CsvColumnType.INT64 -> (values as LongArray)[i]
+                    CsvColumnType.FLOAT64 -> (values as DoubleArray)[i]
+                    else -> String(values as ByteArray, offsets!![i], offsets[i + 1] - offsets[i], Charsets.UTF_8)
+                }
+            )
+        }
+        return result
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            NativeCsv.close(handle)
+            handle = 0L
+        }
+    }
+}
+
+/**
+ * Kotlin 实现：逐字符读取记录，规则与原生读取器一致
+ * - 引号按出现次数切换状态，引号内的分隔符和换行属于字段，引号内两个连续引号表示一个引号
+ * - 行尾 \r 去掉、空行跳过，字段不足补空字段、多余字段忽略
+ * - 每批的列类型 = 之前的类型与本批所有非空值类型的合并
+ */
+internal class KotlinCsvStream(
+    private val input: InputStream,
+    private val options: CsvOptions,
+    private val ownsInput: Boolean
+) : CsvStream {
+
+    private val reader: Reader = InputStreamReader(input, charset(options.encoding))
+    private val buffer = CharArray(1 shl 16)
+    private var position = 0
+    private var limit = 0
+    private val record = StringBuilder()
+    private var pending: String? = null
+    private val schema: Array<CsvColumnType>
+    // 各输出列在文件中的下标，以及每行需要切分的字段数
+    private val projection: IntArray
+    private val fieldLimit: Int
+    // 按字典编码读取时各列的字典，跨批次共享
+    private val dictionaries: Array<StringDictionary?>
+
+    override val columnNames: List<String>
+
+    init {
+        if (peek() == '\uFEFF') position++  // 跳过 BOM
+        repeat(options.skipLines) { skipLine() }
+        val first = readRecord()
+        val fileNames = when {
+            first == null -> emptyList()
+            options.header -> splitRecord(first, Int.MAX_VALUE)
+            else -> splitRecord(first, Int.MAX_VALUE).indices.map { "col$it" }
+        }
+        projection = projectionOf(fileNames, options.columns)
+        fieldLimit = (projection.maxOrNull() ?: -1) + 1
+        columnNames = projection.map { fileNames[it] }
+        if (!options.header) pending = first
+        val initial = if (options.autoType) CsvColumnType.EMPTY else CsvColumnType.STRING
+        schema = Array(columnNames.size) { initial }
+        dictionaries = arrayOfNulls(columnNames.size)
+    }
+
+    override fun nextBatch(maxRows: Int): CsvBatch? {
+        require(maxRows > 0) { "maxRows 必须为正数" }
+        val columnCount = columnNames.size
+        if (columnCount == 0) return null
+        val cells = List(columnCount) { ArrayList<String?>() }
+        var rows = 0
+        while (rows < maxRows) {
+            val line = pending ?: readRecord() ?: break
+            pending = null
+            val fields = splitRecord(line, fieldLimit)
+            for (c in 0 until columnCount) {
+                val field = projection[c]
+                val text = if (field < fields.size) fields[field] else ""
+                cells[c].add(if (text in options.nullValues) null else text)
+            }
+            rows++
+        }
+        if (rows == 0) return null
+
+        for (c in 0 until columnCount) {
+            var type = schema[c]
+            for (text in cells[c]) {
+                if (type == CsvColumnType.STRING) break
+                if (text != null) type = type.join(CsvColumnType.classify(text))
+            }
+            schema[c] = type
+        }
+        val columns = List(columnCount) { c ->
+            val type = schema[c]
+            if (options.categorical && type == CsvColumnType.STRING) {
+                val dictionary = dictionaries[c] ?: StringDictionary().also { dictionaries[c] = it }
+                DictionaryColumn(IntArray(rows) { i -> cells[c][i]?.let { dictionary.intern(it) } ?: -1 }, dictionary)
+            } else {
+                cells[c].map { text -> text?.let { CsvColumnType.convert(it, type) } }
+            }
+        }
+        return CsvBatch(rows, schema.toList(), columns)
+    }
+
+    override fun close() {
+        if (ownsInput) reader.close()
+    }
+
+    private fun projectionOf(fileNames: List<String>, selected: List<String>?): IntArray {
+        if (selected.isNullOrEmpty() || fileNames.isEmpty()) return fileNames.indices.toList().toIntArray()
+        val seen = HashSet<Int>()
+        return selected.map { name ->
+            val index = fileNames.indexOf(name)
+            if (index < 0) throw IOException("CSV中不存在列: $name")
+            if (!seen.add(index)) throw IOException("重复选择的列: $name")
+            index
+        }.toIntArray()
+    }
+
+    private fun fillBuffer(): Boolean {
+        if (position < limit) return true
+        val n = reader.read(buffer, 0, buffer.size)
+        if (n <= 0) return false
+        position = 0
+        limit = n
+        return true
+    }
+
+    private fun peek(): Char? = if (fillBuffer()) buffer[position] else null
+
+    private fun skipLine() {
+        while (fillBuffer()) {
+            if (buffer[position++] == '\n') return
+        }
+    }
+
+    // 读取一条记录（引号外的换行结束），去掉行尾 \r，跳过空行；输入结束返回 null
+    private fun readRecord(): String? {
+        while (true) {
+            record.setLength(0)
+            var inQuote = false
+            var terminated = false
+            while (!terminated && fillBuffer()) {
+                val start = position
+                while (position < limit) {
+                    val ch = buffer[position]
+                    if (ch == options.quote) {
+                        inQuote = !inQuote
+                    } else if (ch == '\n' && !inQuote) {
+                        terminated = true
+                        break
+                    }
+                    position++
+                }
+                record.appendRange(buffer, start, position)
+                if (terminated) position++
+            }
+            if (record.isNotEmpty() && record[record.length - 1] == '\r') record.setLength(record.length - 1)
+            if (record.isNotEmpty()) return record.toString()
+            if (!terminated) return null
+        }
+    }
+
+    // 拆分字段：去掉引号和首尾空白，最多 limit 个字段
+    private fun splitRecord(line: String, limit: Int): List<String> {
+        val fields = ArrayList<String>()
+        val current = StringBuilder()
+        var inQuote = false
+        var i = 0
+        while (i < line.length && fields.size < limit) {
+            val ch = line[i]
+            when {
+                ch == options.quote -> {
+                    if (inQuote && i + 1 < line.length && line[i + 1] == options.quote) {
+                        current.append(ch)
+                        i++
+                    } else {
+                        inQuote = !inQuote
+                    }
+                }
+                ch == options.delimiter && !inQuote -> {
+                    fields.add(finishField(current))
+                    current.setLength(0)
+                }
+                else -> current.append(ch)
+            }
+            i++
+        }
+        if (fields.size < limit) fields.add(finishField(current))
+        return fields
+    }
+
+    private fun finishField(current: StringBuilder): String {
+        if (!options.trim) return current.toString()
+        return current.toString().trim { it == ' ' || it == '\t' || it == '\r' || it == '\n' || it == '\u000C' || it == '\u000B' }
+    }
+}
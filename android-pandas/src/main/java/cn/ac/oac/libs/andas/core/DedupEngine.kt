@@ -0,0 +1,259 @@
+package cn.ac.oac.libs.andas.core
+
+import cn.ac.oac.libs.andas.entity.DictionaryColumn
+import cn.ac.oac.libs.andas.entity.DoubleColumn
+import cn.ac.oac.libs.andas.entity.IntColumn
+import cn.ac.oac.libs.andas.entity.LongColumn
+import java.io.Closeable
+
+/**
+ * 重复行保留哪一个，code 与原生层 andas::DuplicateKeep 一致
+ */
+enum class DuplicateKeep(val code: Int) {
+    FIRST(0),   // 第一次出现的不算重复
+    LAST(1),    // 最后一次出现的不算重复
+    NONE(2);    // 出现多次的全部算重复（pandas 的 keep=False）
+
+    companion object {
+        fun fromName(name: String): DuplicateKeep {
+            return when (name.lowercase()) {
+                "first" -> FIRST
+                "last" -> LAST
+                "none", "false" -> NONE
+                else -> throw IllegalArgumentException("不支持的重复行保留方式: $name")
+            }
+        }
+    }
+}
+
+/**
+ * 去重结果
+ *
+ * @property rows 每个不同键首次出现的行号
+ * @property counts 对应键出现的次数
+ */
+class UniqueResult(val rows: IntArray, val counts: LongArray) {
+    val size: Int get() = rows.size
+}
+
+/**
+ * 去重键编码：编码相等当且仅当值相等（equals），空值也是一个键值
+ * Int、Long 列直接作为 int64 键，Double 列使用位模式（NaN 统一为一个值，-0.0 与 0.0 不同，与 Double.equals 一致），
+ * 字典编码列使用编号，其他类型按首次出现顺序做字典编码
+ */
+internal object DedupKeyEncoding {
+
+    private const val NULL_KEY = NativeData.NULL_GROUP_KEY
+
+    // doubleToLongBits 只产生一种 NaN 位模式，另一种 NaN 位模式不会与任何值冲突，用作 double 列的空值
+    private const val NULL_DOUBLE_KEY = 0x7ff8000000000001L
+
+    fun encode(values: List<Any?>): LongArray {
+        when (values) {
+            is DictionaryColumn -> return values.codesOr(NULL_KEY)
+            is IntColumn -> return values.longsOr(NULL_KEY)
+            is DoubleColumn -> return LongArray(values.size) { i ->
+                if (values.isValid(i)) java.lang.Double.doubleToLongBits(values.doubleAt(i)) else NULL_DOUBLE_KEY
+            }
+            is LongColumn -> {
+                // Long.MIN_VALUE 与空值编码冲突，出现时改用字典编码
+                val longs = values.longsOr(NULL_KEY)
+                if ((0 until values.size).none { longs[it] == NULL_KEY && values.isValid(it) }) return longs
+            }
+        }
+        val nonNull = values.asSequence().filterNotNull()
+        if (nonNull.all { it is Int } || nonNull.all { it is Long && it != NULL_KEY }) {
+            return LongArray(values.size) { i -> (values[i] as Number?)?.toLong() ?: NULL_KEY }
+        }
+        if (nonNull.all { it is Double }) {
+            return LongArray(values.size) { i -> doubleKey(values[i] as Double?) }
+        }
+        return GroupKeyEncoding.encode(values).codes
+    }
+
+    private fun doubleKey(value: Double?): Long = value?.let { java.lang.Double.doubleToLongBits(it) } ?: NULL_DOUBLE_KEY
+}
+
+/**
+ * 跨批次保持不变的去重键编码，用于流式去重：每批推断出的列类型和字典都可能不同，同一个值在各批的编码必须相同，
+ * 因此按值的文本比较（Int 1、Long 1 与字符串 "1" 相等，Double 1.0 与 "1.0" 相等）
+ * - 文本是绝对值小于 2^62 的整数时直接以数值作为键
+ * - 其他文本使用持续增长的字典，编号从 2^62 开始，不会与整数冲突
+ * - 字典编码列只对本批字典中的条目各编码一次
+ * 占用的内存与各列不同的非整数值个数成正比
+ */
+internal class StableKeyEncoder {
+
+    private val lookup = HashMap<String, Long>()
+
+    fun encode(values: List<Any?>): LongArray {
+        if (values is DictionaryColumn) {
+            val remap = LongArray(values.dictionary.size) { code -> textKey(values.dictionary[code]) }
+            return LongArray(values.size) { i ->
+                val code = values.codeAt(i)
+                if (code >= 0) remap[code] else NULL_KEY
+            }
+        }
+        return LongArray(values.size) { i ->
+            when (val value = values[i]) {
+                null -> NULL_KEY
+                is Int -> value.toLong()
+                is Long -> if (value > -DICTIONARY_BASE && value < DICTIONARY_BASE) value else textKey(value.toString())
+                else -> textKey(value.toString())
+            }
+        }
+    }
+
+    private fun textKey(text: String): Long {
+        // 只有规范写法的整数（没有前导 0 和 + 号）才与数值相等
+        val number = text.toLongOrNull()
+        if (number != null && number > -DICTIONARY_BASE && number < DICTIONARY_BASE && number.toString() == text) {
+            return number
+        }
+        return lookup.getOrPut(text) { DICTIONARY_BASE + lookup.size }
+    }
+
+    private companion object {
+        const val NULL_KEY = NativeData.NULL_GROUP_KEY
+        const val DICTIONARY_BASE = 1L shl 62
+    }
+}
+
+/**
+ * 去重入口：优先使用原生哈希去重（按哈希分区并行），原生库不可用时退化为 Kotlin 实现，两者结果一致
+ */
+internal object DedupEngine {
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeData.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    fun unique(keys: Array<LongArray>, sortByCount: Boolean = false): UniqueResult {
+        checkKeys(keys)
+        if (nativeAvailable) {
+            return NativeData.uniqueRows(keys, sortByCount)
+        }
+        // 每个键的编号按首次出现的顺序分配
+        val groupOf = HashMap<List<Long>, Int>()
+        val firstRows = ArrayList<Int>()
+        val counts = ArrayList<Long>()
+        for (i in 0 until keys[0].size) {
+            val group = groupOf.getOrPut(keys.map { it[i] }) {
+                firstRows.add(i)
+                counts.add(0L)
+                firstRows.size - 1
+            }
+            counts[group]++
+        }
+        var order = firstRows.indices.toList()
+        // sortedBy 是稳定排序，次数相同的保持首次出现的顺序
+        if (sortByCount) order = order.sortedBy { -counts[it] }
+        return UniqueResult(IntArray(order.size) { firstRows[order[it]] }, LongArray(order.size) { counts[order[it]] })
+    }
+
+    fun duplicated(keys: Array<LongArray>, keep: DuplicateKeep): BooleanArray {
+        checkKeys(keys)
+        if (nativeAvailable) {
+            return NativeData.duplicatedRows(keys, keep)
+        }
+        val rowCount = keys.firstOrNull()?.size ?: 0
+        val rowsOf = HashMap<List<Long>, MutableList<Int>>()
+        for (i in 0 until rowCount) rowsOf.getOrPut(keys.map { it[i] }) { mutableListOf() }.add(i)
+        val result = BooleanArray(rowCount)
+        for (rows in rowsOf.values) {
+            when (keep) {
+                DuplicateKeep.FIRST -> rows.drop(1).forEach { result[it] = true }
+                DuplicateKeep.LAST -> rows.dropLast(1).forEach { result[it] = true }
+                DuplicateKeep.NONE -> if (rows.size > 1) rows.forEach { result[it] = true }
+            }
+        }
+        return result
+    }
+
+    /**
+     * 打开跨批次的去重集合，用完须关闭
+     */
+    fun openSet(keyColumns: Int): DistinctRowSet {
+        if (keyColumns <= 0) throw IllegalArgumentException("至少需要一个去重键列")
+        return if (nativeAvailable) NativeDistinctRowSet(keyColumns) else KotlinDistinctRowSet(keyColumns)
+    }
+
+    private fun checkKeys(keys: Array<LongArray>) {
+        if (keys.isEmpty()) throw IllegalArgumentException("至少需要一个去重键列")
+        val n = keys[0].size
+        if (keys.any { it.size != n }) {
+            throw IllegalArgumentException("去重键列长度不一致: ${keys.map { it.size }}")
+        }
+    }
+}
+
+/**
+ * 跨批次的去重集合：依次插入各批的键，返回此前没有出现过的行；只保存键，不保存行本身
+ */
+internal abstract class DistinctRowSet(val keyColumns: Int) : Closeable {
+
+    /**
+     * 插入一批键（每列一个数组），返回此前各批和本批前面的行都没有出现过的行号（升序）
+     */
+    fun insert(keys: Array<LongArray>): IntArray {
+        if (keys.size != keyColumns) {
+            throw IllegalArgumentException("去重键列数不一致: ${keys.size} != $keyColumns")
+        }
+        val n = keys[0].size
+        if (keys.any { it.size != n }) {
+            throw IllegalArgumentException("去重键列长度不一致: ${keys.map { it.size }}")
+        }
+        return insertChecked(keys)
+    }
+
+    /**
+     * 已保存的不同键个数
+     */
+    abstract val size: Long
+
+    protected abstract fun insertChecked(keys: Array<LongArray>): IntArray
+}
+
+private class NativeDistinctRowSet(keyColumns: Int) : DistinctRowSet(keyColumns) {
+
+    private var handle: Long = NativeData.distinctSetCreate(keyColumns)
+
+    override val size: Long get() = NativeData.distinctSetSize(checkOpen())
+
+    override fun insertChecked(keys: Array<LongArray>): IntArray = NativeData.distinctSetInsert(checkOpen(), keys)
+
+    private fun checkOpen(): Long {
+        check(handle != 0L) { "去重集合已关闭" }
+        return handle
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            NativeData.distinctSetRelease(handle)
+            handle = 0L
+        }
+    }
+}
+
+private class KotlinDistinctRowSet(keyColumns: Int) : DistinctRowSet(keyColumns) {
+
+    private val seen = HashSet<List<Long>>()
+
+    override val size: Long get() = seen.size.toLong()
+
+    override fun insertChecked(keys: Array<LongArray>): IntArray {
+        val fresh = ArrayList<Int>()
+        for (i in keys[0].indices) {
+            if (seen.add(keys.map { it[i] })) fresh.add(i)
+        }
+        return fresh.toIntArray()
+    }
+
+    override fun close() {
+        seen.clear()
+    }
+}
@@ -0,0 +1,245 @@
+package cn.ac.oac.libs.andas.core
+
+/**
+ * 把 `a * 2 + log(b)` 这样的表达式字符串解析为 [Expr]
+ *
+ * 优先级从低到高：`|`/`or`，`&`/`and`，`~`/`not`，比较（`< <= > >= == !=`），`+ -`，`* /`，
+ * 一元负号，`**`（右结合，`-a ** 2` 为 `-(a ** 2)`）。
+ * 函数：abs、sqrt、exp、log、sin、cos、pow(x, y)、clip(x, lo, hi)、where(cond, a, b)、fill_null(x, v)、normalize(x)；
+ * 列名为字母（含中文）、数字和下划线组成的标识符，其他列名用反引号括起，如 `` `单价(元)` * 2 ``。
+ * 常量 nan 表示缺失值，true/false 为 1/0
+ */
+internal object ExprParser {
+
+    private val unaryFunctions = mapOf(
+        "abs" to ExprOp.ABS,
+        "sqrt" to ExprOp.SQRT,
+        "exp" to ExprOp.EXP,
+        "log" to ExprOp.LOG,
+        "sin" to ExprOp.SIN,
+        "cos" to ExprOp.COS
+    )
+
+    private val comparisons = mapOf(
+        "<" to ExprOp.LT,
+        "<=" to ExprOp.LE,
+        ">" to ExprOp.GT,
+        ">=" to ExprOp.GE,
+        "==" to ExprOp.EQ,
+        "!=" to ExprOp.NE
+    )
+
+    fun parse(text: String): Expr {
+        val parser = Parser(tokenize(text), text)
+        val expr = parser.or()
+        parser.expectEnd()
+        return expr
+    }
+
+    private enum class Kind { NUMBER, NAME, QUOTED, SYMBOL, END }
+
+    private class Token(val kind: Kind, val text: String, val position: Int)
+
+    private fun tokenize(text: String): List<Token> {
+        val tokens = ArrayList<Token>()
+        var i = 0
+        while (i < text.length) {
+            val c = text[i]
+            val start = i
+            when {
+                c.isWhitespace() -> i++
+                c.isDigit() || (c == '.' && i + 1 < text.length && text[i + 1].isDigit()) -> {
+                    while (i < text.length && (text[i].isDigit() || text[i] == '.')) i++
+                    if (i < text.length && (text[i] == 'e' || text[i] == 'E')) {
+                        var j = i + 1
+                        if (j < text.length && (text[j] == '+' || text[j] == '-')) j++
+                        if (j < text.length && text[j].isDigit()) {
+                            i = j
+                            while (i < text.length && text[i].isDigit()) i++
+                        }
+                    }
+                    tokens.add(Token(Kind.NUMBER, text.substring(start, i), start))
+                }
+                c.isLetter() || c == '_' -> {
+                    while (i < text.length && (text[i].isLetterOrDigit() || text[i] == '_')) i++
+                    tokens.add(Token(Kind.NAME, text.substring(start, i), start))
+                }
+                c == '`' -> {
+                    val end = text.indexOf('`', i + 1)
+                    if (end < 0) throw syntaxError(text, start, "反引号没有闭合")
+                    tokens.add(Token(Kind.QUOTED, text.substring(i + 1, end), start))
+                    i = end + 1
+                }
+                else -> {
+                    val two = if (i + 1 < text.length) text.substring(i, i + 2) else ""
+                    val symbol = when {
+                        two in setOf("**", "<=", ">=", "==", "!=") -> two
+                        c in "+-*/()<>,&|~" -> c.toString()
+                        else -> throw syntaxError(text, start, "无法识别的字符 '$c'")
+                    }
+                    tokens.add(Token(Kind.SYMBOL, symbol, start))
+                    i += symbol.length
+                }
+            }
+        }
+        tokens.add(Token(Kind.END, "", text.length))
+        return tokens
+    }
+
+    private fun syntaxError(text: String, position: Int, message: String) =
+        IllegalArgumentException("表达式语法错误: $message（位置 $position）: $text")
+
+    private class Parser(private val tokens: List<Token>, private val text: String) {
+        private var pos = 0
+
+        private val current get() = tokens[pos]
+
+        private fun accept(vararg symbols: String): String? {
+            val t = current
+            val matched = (t.kind == Kind.SYMBOL && t.text in symbols) ||
+                (t.kind == Kind.NAME && t.text.lowercase() in symbols)
+            if (!matched) return null
+            pos++
+            return if (t.kind == Kind.NAME) t.text.lowercase() else t.text
+        }
+
+        private fun expect(symbol: String) {
+            if (accept(symbol) == null) throw fail("缺少 '$symbol'")
+        }
+
+        private fun fail(message: String): IllegalArgumentException {
+            val found = if (current.kind == Kind.END) "表达式结尾" else "'${current.text}'"
+            return syntaxError(text, current.position, "$message，遇到 $found")
+        }
+
+        fun expectEnd() {
+            if (current.kind != Kind.END) throw fail("多余的内容")
+        }
+
+        fun or(): Expr {
+            var left = and()
+            while (accept("|", "or") != null) left = Expr.binary(ExprOp.OR, left, and())
+            return left
+        }
+
+        private fun and(): Expr {
+            var left = not()
+            while (accept("&", "and") != null) left = Expr.binary(ExprOp.AND, left, not())
+            return left
+        }
+
+        private fun not(): Expr {
+            if (accept("~", "not") != null) return Expr.call(ExprOp.NOT, listOf(not()))
+            return comparison()
+        }
+
+        // 比较不能连写，a < b < c 需要写成 (a < b) & (b < c)
+        private fun comparison(): Expr {
+            val left = additive()
+            val symbol = accept(*comparisons.keys.toTypedArray()) ?: return left
+            val result = Expr.binary(comparisons.getValue(symbol), left, additive())
+            if (current.kind == Kind.SYMBOL && current.text in comparisons) throw fail("比较运算不能连写")
+            return result
+        }
+
+        private fun additive(): Expr {
+            var left = multiplicative()
+            while (true) {
+                left = when (accept("+", "-")) {
+                    "+" -> Expr.binary(ExprOp.ADD, left, multiplicative())
+                    "-" -> Expr.binary(ExprOp.SUB, left, multiplicative())
+                    else -> return left
+                }
+            }
+        }
+
+        private fun multiplicative(): Expr {
+            var left = unary()
+            while (true) {
+                left = when (accept("*", "/")) {
+                    "*" -> Expr.binary(ExprOp.MUL, left, unary())
+                    "/" -> Expr.binary(ExprOp.DIV, left, unary())
+                    else -> return left
+                }
+            }
+        }
+
+        private fun unary(): Expr {
+            if (accept("-") != null) {
+                val operand = unary()
+                return if (operand is Expr.Literal) Expr.Literal(-operand.value) else Expr.Neg(operand)
+            }
+            if (accept("+") != null) return unary()
+            return power()
+        }
+
+        private fun power(): Expr {
+            val base = primary()
+            if (accept("**") != null) return Expr.binary(ExprOp.POW, base, unary())
+            return base
+        }
+
+        private fun primary(): Expr {
+            val t = current
+            return when (t.kind) {
+                Kind.NUMBER -> {
+                    pos++
+                    Expr.Literal(t.text.toDoubleOrNull() ?: throw syntaxError(text, t.position, "数字格式不正确 '${t.text}'"))
+                }
+                Kind.QUOTED -> {
+                    pos++
+                    Expr.Column(t.text)
+                }
+                Kind.NAME -> {
+                    pos++
+                    if (current.kind == Kind.SYMBOL && current.text == "(") {
+                        call(t)
+                    } else {
+                        when (t.text.lowercase()) {
+                            "nan" -> Expr.Literal(Double.NaN)
+                            "true" -> Expr.Literal(1.0)
+                            "false" -> Expr.Literal(0.0)
+                            "and", "or", "not" -> throw syntaxError(text, t.position, "'${t.text}' 是关键字，作为列名时请用反引号")
+                            else -> Expr.Column(t.text)
+                        }
+                    }
+                }
+                else -> {
+                    if (accept("(") == null) throw fail("缺少操作数")
+                    val inner = or()
+                    expect(")")
+                    inner
+                }
+            }
+        }
+
+        private fun call(name: Token): Expr {
+            expect("(")
+            val args = ArrayList<Expr>()
+            if (accept(")") == null) {
+                do {
+                    args.add(or())
+                } while (accept(",") != null)
+                expect(")")
+            }
+            val function = name.text.lowercase()
+            val expected = when (function) {
+                in unaryFunctions, "normalize" -> 1
+                "pow", "fill_null" -> 2
+                "clip", "where" -> 3
+                else -> throw syntaxError(text, name.position, "不支持的函数 '${name.text}'")
+            }
+            if (args.size != expected) {
+                throw syntaxError(text, name.position, "函数 ${name.text} 需要 $expected 个参数，实际为 ${args.size}")
+            }
+            return when (function) {
+                "normalize" -> Expr.Normalize(args[0])
+                "pow" -> Expr.binary(ExprOp.POW, args[0], args[1])
+                "fill_null" -> args[0].let { if (it is Expr.Literal && !it.value.isNaN()) it else Expr.FillNull(it, args[1]) }
+                "clip" -> Expr.call(ExprOp.CLIP, args)
+                "where" -> Expr.call(ExprOp.WHERE, args)
+                else -> Expr.call(unaryFunctions.getValue(function), args)
+            }
+        }
+    }
+}
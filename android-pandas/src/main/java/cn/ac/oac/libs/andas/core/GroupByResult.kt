@@ -0,0 +1,243 @@
+package cn.ac.oac.libs.andas.core
+
+import cn.ac.oac.libs.andas.entity.DictionaryColumn
+import cn.ac.oac.libs.andas.entity.Index
+
+/**
+ * 分组聚合类型，code 与原生层 andas::AggOp 一致
+ */
+enum class AggOp(val code: Int) {
+    SUM(0),
+    MEAN(1),
+    COUNT(2),
+    MIN(3),
+    MAX(4),
+    VAR(5),
+    FIRST(6),
+    LAST(7);
+
+    companion object {
+        /**
+         * 按名称解析聚合类型（不区分大小写），支持 pandas 风格的别名
+         */
+        fun fromName(name: String): AggOp {
+            return when (name.lowercase()) {
+                "sum" -> SUM
+                "mean", "avg" -> MEAN
+                "count" -> COUNT
+                "min" -> MIN
+                "max" -> MAX
+                "var" -> VAR
+                "first" -> FIRST
+                "last" -> LAST
+                else -> throw IllegalArgumentException("不支持的聚合操作: $name")
+            }
+        }
+    }
+}
+
+/**
+ * 原生分组聚合结果，分组按首次出现的顺序排列
+ *
+ * @property keys 每个分组键列一个数组
+ * @property sizes 每组的行数
+ * @property aggregates 每个聚合请求一个数组，缺失结果为 NaN
+ */
+class GroupByResult(
+    val keys: Array<LongArray>,
+    val sizes: LongArray,
+    val aggregates: Array<DoubleArray>
+) {
+    val groupCount: Int get() = sizes.size
+}
+
+/**
+ * 分组键编码：Int 或 Long 列直接作为 int64 键，字典编码列直接使用编号，其他类型按首次出现顺序做字典编码
+ * 空值编码为 [NativeData.NULL_GROUP_KEY]
+ */
+internal class GroupKeyEncoding private constructor(
+    val codes: LongArray,
+    private val dictionary: List<Any>?,
+    private val intKeys: Boolean
+) {
+    fun decode(code: Long): Any? {
+        return when {
+            code == NativeData.NULL_GROUP_KEY -> null
+            dictionary != null -> dictionary[code.toInt()]
+            intKeys -> code.toInt()
+            else -> code
+        }
+    }
+
+    companion object {
+        /**
+         * 行索引的分组编码：Int 标签直接作为键，其他标签使用索引给出的第一次出现位置，解码时回到索引取标签
+         */
+        fun ofIndex(index: Index): GroupKeyEncoding {
+            return GroupKeyEncoding(index.groupCodes(), if (index.intLabels) null else index, index.intLabels)
+        }
+
+        fun encode(values: List<Any?>): GroupKeyEncoding {
+            if (values is DictionaryColumn) {
+                return GroupKeyEncoding(values.codesOr(NativeData.NULL_GROUP_KEY), values.dictionary.values(), false)
+            }
+            val nonNull = values.asSequence().filterNotNull()
+            val allInt = nonNull.all { it is Int }
+            val allLong = !allInt && nonNull.all { it is Long && it != NativeData.NULL_GROUP_KEY }
+            if (allInt || allLong) {
+                val codes = LongArray(values.size) { i ->
+                    (values[i] as Number?)?.toLong() ?: NativeData.NULL_GROUP_KEY
+                }
+                return GroupKeyEncoding(codes, null, allInt)
+            }
+
+            val dictionary = ArrayList<Any>()
+            val lookup = HashMap<Any, Long>()
+            val codes = LongArray(values.size) { i ->
+                val value = values[i]
+                if (value == null) {
+                    NativeData.NULL_GROUP_KEY
+                } else {
+                    lookup.getOrPut(value) {
+                        dictionary.add(value)
+                        (dictionary.size - 1).toLong()
+                    }
+                }
+            }
+            return GroupKeyEncoding(codes, dictionary, false)
+        }
+    }
+}
+
+/**
+ * 值列编码：数值列转为 double（空值为 NaN）
+ * 非数值列按排序后的字典编码，编码的大小顺序与值一致，min/max/first/last/count 可以直接在编码上计算；
+ * 字典编码列直接取编号在排序后字典中的位置
+ */
+internal class GroupValueEncoding private constructor(
+    val values: DoubleArray,
+    val numeric: Boolean,
+    private val dictionary: List<Any>?,
+    private val intValues: Boolean,
+    private val longValues: Boolean
+) {
+    /**
+     * 还原 min/max/first/last 的结果，整数列保持原类型
+     */
+    fun decode(value: Double): Any? {
+        return when {
+            value.isNaN() -> null
+            dictionary != null -> dictionary[value.toInt()]
+            intValues -> value.toInt()
+            longValues -> value.toLong()
+            else -> value
+        }
+    }
+
+    companion object {
+        fun encode(values: List<Any?>): GroupValueEncoding {
+            if (values is DictionaryColumn) {
+                val sorted = values.dictionary.sorted()
+                val array = DoubleArray(values.size) { i ->
+                    val code = values.codeAt(i)
+                    if (code >= 0) sorted.ranks[code].toDouble() else Double.NaN
+                }
+                return GroupValueEncoding(array, false, sorted.values, false, false)
+            }
+            val nonNull = values.filterNotNull()
+            if (nonNull.all { it is Number }) {
+                val array = DoubleArray(values.size) { i ->
+                    (values[i] as Number?)?.toDouble() ?: Double.NaN
+                }
+                val intValues = nonNull.isNotEmpty() && nonNull.all { it is Int }
+                val longValues = nonNull.isNotEmpty() && nonNull.all { it is Long }
+                return GroupValueEncoding(array, true, null, intValues, longValues)
+            }
+
+            val distinct = nonNull.distinct()
+            val sameType = distinct.all { it is Comparable<*> } && distinct.map { it::class }.toSet().size == 1
+            @Suppress("UNCHECKED_CAST")
+            val dictionary: List<Any> = if (sameType) {
+                (distinct as List<Comparable<Any>>).sorted()
+            } else {
+                distinct.sortedBy { it.toString() }
+            }
+            val lookup = HashMap<Any, Int>(dictionary.size * 2)
+            dictionary.forEachIndexed { i, value -> lookup[value] = i }
+            val array = DoubleArray(values.size) { i ->
+                values[i]?.let { lookup[it]!!.toDouble() } ?: Double.NaN
+            }
+            return GroupValueEncoding(array, false, dictionary, false, false)
+        }
+    }
+}
+
+/**
+ * 分组聚合入口：优先使用原生哈希分组，原生库不可用时退化为 Kotlin 实现，两者语义一致
+ */
+internal object GroupByEngine {
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeData.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    fun aggregate(
+        keys: Array<LongArray>,
+        values: Array<DoubleArray>,
+        aggregations: List<Pair<Int, AggOp>>
+    ): GroupByResult {
+        if (nativeAvailable) {
+            return NativeData.groupByAggregate(keys, values, aggregations)
+        }
+        return aggregateKotlin(keys, values, aggregations)
+    }
+
+    private fun aggregateKotlin(
+        keys: Array<LongArray>,
+        values: Array<DoubleArray>,
+        aggregations: List<Pair<Int, AggOp>>
+    ): GroupByResult {
+        val rowCount = keys.firstOrNull()?.size ?: 0
+        val groupOf = LinkedHashMap<List<Long>, Int>()
+        val groupRows = ArrayList<MutableList<Int>>()
+        for (i in 0 until rowCount) {
+            val key = keys.map { it[i] }
+            if (key.any { it == NativeData.NULL_GROUP_KEY }) continue
+            val group = groupOf.getOrPut(key) {
+                groupRows.add(mutableListOf())
+                groupRows.size - 1
+            }
+            groupRows[group].add(i)
+        }
+
+        val groupKeys = groupOf.keys.toList()
+        val aggregates = Array(aggregations.size) { s ->
+            val (column, op) = aggregations[s]
+            DoubleArray(groupRows.size) { g ->
+                val valid = groupRows[g].map { values[column][it] }.filter { !it.isNaN() }
+                when (op) {
+                    AggOp.SUM -> valid.sum()
+                    AggOp.MEAN -> if (valid.isEmpty()) Double.NaN else valid.average()
+                    AggOp.COUNT -> valid.size.toDouble()
+                    AggOp.MIN -> valid.minOrNull() ?: Double.NaN
+                    AggOp.MAX -> valid.maxOrNull() ?: Double.NaN
+                    AggOp.VAR -> if (valid.size < 2) Double.NaN else {
+                        val mean = valid.average()
+                        valid.sumOf { (it - mean) * (it - mean) } / (valid.size - 1)
+                    }
+                    AggOp.FIRST -> valid.firstOrNull() ?: Double.NaN
+                    AggOp.LAST -> valid.lastOrNull() ?: Double.NaN
+                }
+            }
+        }
+        return GroupByResult(
+            keys = Array(keys.size) { c -> LongArray(groupKeys.size) { g -> groupKeys[g][c] } },
+            sizes = LongArray(groupRows.size) { groupRows[it].size.toLong() },
+            aggregates = aggregates
+        )
+    }
+}
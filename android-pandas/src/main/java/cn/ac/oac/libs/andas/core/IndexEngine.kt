@@ -0,0 +1,117 @@
+package cn.ac.oac.libs.andas.core
+
+/**
+ * 行索引的哈希表：int64 键 -> 第一次出现的位置，相同键的位置按升序串成链
+ * 字符串标签的键是其 64 位哈希（见 [IndexEngine.stringKey]），不同标签可能得到相同的键，调用方须核对标签本身
+ */
+internal abstract class LabelHashTable {
+
+    /**
+     * 没有重复的键
+     */
+    abstract val isUnique: Boolean
+
+    /**
+     * 键第一次出现的位置，不存在时为 -1
+     */
+    abstract fun first(key: Long): Int
+
+    /**
+     * 与 position 键相同的下一个位置，没有时为 -1
+     */
+    abstract fun next(position: Int): Int
+
+    /**
+     * 批量查找每个探测键第一次出现的位置
+     */
+    abstract fun lookup(probes: LongArray): IntArray
+
+    /**
+     * 每个位置的键第一次出现的位置
+     */
+    abstract fun firstPositions(): IntArray
+}
+
+/**
+ * 行索引入口：优先使用原生哈希表（开放寻址，每个键 16 字节，批量查找并行），原生库不可用时退化为 Kotlin 实现
+ */
+internal object IndexEngine {
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeData.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    fun build(keys: LongArray): LabelHashTable {
+        return if (nativeAvailable) NativeLabelHashTable(keys) else KotlinLabelHashTable(keys)
+    }
+
+    /**
+     * 字符串标签的 64 位哈希（FNV-1a）
+     */
+    fun stringKey(label: String): Long {
+        var hash = -0x340d631b7bdddcdbL   // 0xcbf29ce484222325
+        for (ch in label) {
+            hash = (hash xor ch.code.toLong()) * 0x100000001b3L
+        }
+        return hash
+    }
+}
+
+private class NativeLabelHashTable(keys: LongArray) : LabelHashTable() {
+
+    private val handle: Long = NativeData.hashIndexCreate(keys)
+
+    override val isUnique: Boolean by lazy { NativeData.hashIndexIsUnique(handle) }
+
+    override fun first(key: Long): Int = NativeData.hashIndexFirst(handle, key)
+
+    override fun next(position: Int): Int = NativeData.hashIndexNext(handle, position)
+
+    override fun lookup(probes: LongArray): IntArray = NativeData.hashIndexLookup(handle, probes)
+
+    override fun firstPositions(): IntArray = NativeData.hashIndexFirstPositions(handle)
+
+    // 索引由多个 DataFrame 共享，没有明确的关闭时机，由GC释放
+    protected fun finalize() {
+        NativeData.hashIndexRelease(handle)
+    }
+}
+
+private class KotlinLabelHashTable(keys: LongArray) : LabelHashTable() {
+
+    private val firsts = HashMap<Long, Int>(keys.size * 2)
+    private val nexts = IntArray(keys.size) { -1 }
+
+    override val isUnique: Boolean
+
+    init {
+        val lasts = HashMap<Long, Int>(keys.size * 2)
+        for (i in keys.indices) {
+            val last = lasts.put(keys[i], i)
+            if (last == null) firsts[keys[i]] = i else nexts[last] = i
+        }
+        isUnique = firsts.size == keys.size
+    }
+
+    override fun first(key: Long): Int = firsts[key] ?: -1
+
+    override fun next(position: Int): Int = nexts[position]
+
+    override fun lookup(probes: LongArray): IntArray = IntArray(probes.size) { first(probes[it]) }
+
+    override fun firstPositions(): IntArray {
+        val result = IntArray(nexts.size)
+        for (start in firsts.values) {
+            var p = start
+            while (p >= 0) {
+                result[p] = start
+                p = nexts[p]
+            }
+        }
+        return result
+    }
+}
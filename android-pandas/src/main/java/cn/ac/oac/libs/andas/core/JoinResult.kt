@@ -0,0 +1,149 @@
+package cn.ac.oac.libs.andas.core
+
+import cn.ac.oac.libs.andas.entity.DictionaryColumn
+
+/**
+ * 连接类型，code 与原生层 andas::JoinType 一致
+ */
+enum class JoinType(val code: Int) {
+    INNER(0),
+    LEFT(1),
+    RIGHT(2),
+    OUTER(3),
+    SEMI(4),
+    ANTI(5);
+
+    companion object {
+        /**
+         * 按名称解析连接类型（不区分大小写）
+         */
+        fun fromName(name: String): JoinType {
+            return when (name.lowercase()) {
+                "inner" -> INNER
+                "left" -> LEFT
+                "right" -> RIGHT
+                "outer", "full" -> OUTER
+                "semi", "left_semi" -> SEMI
+                "anti", "left_anti" -> ANTI
+                else -> throw IllegalArgumentException("不支持的连接类型: $name")
+            }
+        }
+    }
+}
+
+/**
+ * 连接键编码：左右两侧共用一套编码，编码相等当且仅当值相等（equals）
+ * 两侧都是 Int 或都是 Long 时直接作为 int64 键，两侧都是字典编码列时使用编号，否则使用共享字典；空值与空值匹配
+ */
+internal object JoinKeyEncoding {
+
+    private const val NULL_KEY = Long.MIN_VALUE
+
+    fun encode(left: List<Any?>, right: List<Any?>): Pair<LongArray, LongArray> {
+        if (left is DictionaryColumn && right is DictionaryColumn) {
+            return encodeDictionaries(left, right)
+        }
+        val nonNull = left.asSequence().filterNotNull() + right.asSequence().filterNotNull()
+        val allInt = nonNull.all { it is Int }
+        val allLong = !allInt && nonNull.all { it is Long && it != NULL_KEY }
+        if (allInt || allLong) {
+            val direct = { values: List<Any?> ->
+                LongArray(values.size) { i -> (values[i] as Number?)?.toLong() ?: NULL_KEY }
+            }
+            return direct(left) to direct(right)
+        }
+
+        val lookup = HashMap<Any, Long>()
+        val dictionary = { values: List<Any?> ->
+            LongArray(values.size) { i ->
+                values[i]?.let { lookup.getOrPut(it) { lookup.size.toLong() } } ?: NULL_KEY
+            }
+        }
+        return dictionary(left) to dictionary(right)
+    }
+
+    // 右侧字典的条目映射到左侧编号，左侧没有的值编号为左侧字典大小之后的位置，只与右侧自身相等
+    private fun encodeDictionaries(left: DictionaryColumn, right: DictionaryColumn): Pair<LongArray, LongArray> {
+        val leftCodes = left.codesOr(NULL_KEY)
+        if (left.dictionary === right.dictionary) {
+            return leftCodes to right.codesOr(NULL_KEY)
+        }
+        val leftSize = left.dictionary.size.toLong()
+        val remap = LongArray(right.dictionary.size) { code ->
+            val found = left.dictionary.find(right.dictionary[code])
+            if (found >= 0) found.toLong() else leftSize + code
+        }
+        return leftCodes to LongArray(right.size) { i ->
+            val code = right.codeAt(i)
+            if (code >= 0) remap[code] else NULL_KEY
+        }
+    }
+}
+
+/**
+ * 连接入口：优先使用原生哈希连接，原生库不可用时退化为 Kotlin 实现，输出顺序一致
+ */
+internal object JoinEngine {
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeData.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    fun join(leftKeys: Array<LongArray>, rightKeys: Array<LongArray>, how: JoinType): Pair<IntArray, IntArray> {
+        if (nativeAvailable) {
+            return NativeData.joinIndices(leftKeys, rightKeys, how)
+        }
+        return joinKotlin(leftKeys, rightKeys, how)
+    }
+
+    private fun joinKotlin(leftKeys: Array<LongArray>, rightKeys: Array<LongArray>, how: JoinType): Pair<IntArray, IntArray> {
+        if (how == JoinType.RIGHT) {
+            val (rightOut, leftOut) = joinKotlin(rightKeys, leftKeys, JoinType.LEFT)
+            return leftOut to rightOut
+        }
+        val leftRows = leftKeys.firstOrNull()?.size ?: 0
+        val rightRows = rightKeys.firstOrNull()?.size ?: 0
+        val buildTable = HashMap<List<Long>, MutableList<Int>>()
+        for (j in 0 until rightRows) {
+            buildTable.getOrPut(rightKeys.map { it[j] }) { mutableListOf() }.add(j)
+        }
+
+        val leftOut = ArrayList<Int>()
+        val rightOut = ArrayList<Int>()
+        val matchedRight = BooleanArray(rightRows)
+        for (i in 0 until leftRows) {
+            val matches = buildTable[leftKeys.map { it[i] }]
+            when (how) {
+                JoinType.SEMI -> if (matches != null) leftOut.add(i)
+                JoinType.ANTI -> if (matches == null) leftOut.add(i)
+                else -> {
+                    if (matches == null) {
+                        if (how == JoinType.LEFT || how == JoinType.OUTER) {
+                            leftOut.add(i)
+                            rightOut.add(-1)
+                        }
+                    } else {
+                        matches.forEach { j ->
+                            leftOut.add(i)
+                            rightOut.add(j)
+                            matchedRight[j] = true
+                        }
+                    }
+                }
+            }
+        }
+        if (how == JoinType.OUTER) {
+            for (j in 0 until rightRows) {
+                if (!matchedRight[j]) {
+                    leftOut.add(-1)
+                    rightOut.add(j)
+                }
+            }
+        }
+        return leftOut.toIntArray() to rightOut.toIntArray()
+    }
+}
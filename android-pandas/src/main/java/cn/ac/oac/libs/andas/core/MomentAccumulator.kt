@@ -0,0 +1,253 @@
+package cn.ac.oac.libs.andas.core
+
+import kotlin.math.abs
+import kotlin.math.sqrt
+
+/**
+ * 需要计算到的矩阶数，code 与原生层 MomentOrder 一致；阶数越低扫描越快
+ */
+internal enum class MomentOrder(val code: Int) {
+    MEAN(1),       // count / sum / mean
+    VARIANCE(2),   // 另加 M2 和 min / max
+    SHAPE(4)       // 另加 M3 / M4（偏度、峰度）
+}
+
+/**
+ * 可合并的矩累加器：有效值个数、补偿求和、均值、2~4 阶中心矩之和、最小/最大值
+ *
+ * 单值加入为 Welford 在线更新，[merge] 为 Chan/Pébay 的合并公式，分块、分批、分线程的部分结果
+ * 可以直接合并，不需要第二遍扫描；与原生层 moments.h 的 MomentAccumulator 使用同一套公式
+ * NaN 视为缺失值，不计入
+ */
+class MomentAccumulator {
+
+    var count: Long = 0
+        private set
+    private var sumValue = 0.0
+    private var sumError = 0.0
+    private var meanValue = 0.0
+    private var m2 = 0.0
+    private var m3 = 0.0
+    private var m4 = 0.0
+    private var minValue = Double.POSITIVE_INFINITY
+    private var maxValue = Double.NEGATIVE_INFINITY
+
+    /**
+     * 补偿求和的结果
+     */
+    val sum: Double get() = if (sumValue.isFinite()) sumValue + sumError else sumValue
+
+    /**
+     * 均值，没有有效值时为 NaN
+     */
+    val mean: Double get() = if (count > 0) meanValue else Double.NaN
+
+    val min: Double get() = if (count > 0) minValue else Double.NaN
+
+    val max: Double get() = if (count > 0) maxValue else Double.NaN
+
+    fun add(value: Double): MomentAccumulator {
+        if (value.isNaN()) return this
+        return merge(single(value))
+    }
+
+    /**
+     * 加入一批值，原生库可用时在原生层计算后合并
+     */
+    fun addAll(values: DoubleArray): MomentAccumulator = merge(of(values))
+
+    /**
+     * 合并另一部分数据的结果，other 不变
+     */
+    fun merge(other: MomentAccumulator): MomentAccumulator {
+        if (other.count == 0L) return this
+        if (count == 0L) {
+            copyFrom(other)
+            return this
+        }
+        val na = count.toDouble()
+        val nb = other.count.toDouble()
+        val n = na + nb
+        val delta = other.meanValue - meanValue
+        val delta2 = delta * delta
+        val a2 = m2
+        val a3 = m3
+        m4 += other.m4 + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n) +
+            6.0 * delta2 * (na * na * other.m2 + nb * nb * a2) / (n * n) +
+            4.0 * delta * (na * other.m3 - nb * a3) / n
+        m3 += other.m3 + delta2 * delta * na * nb * (na - nb) / (n * n) +
+            3.0 * delta * (na * other.m2 - nb * a2) / n
+        m2 += other.m2 + delta2 * na * nb / n
+        meanValue += delta * nb / n
+        addToSum(other.sumValue)
+        sumError += other.sumError
+        if (other.minValue < minValue) minValue = other.minValue
+        if (other.maxValue > maxValue) maxValue = other.maxValue
+        count += other.count
+        return this
+    }
+
+    /**
+     * 自由度为 count - ddof 的方差，有效值不超过 ddof 个时为 NaN
+     */
+    fun variance(ddof: Int = 1): Double {
+        if (count <= ddof) return Double.NaN
+        return m2 / (count - ddof)
+    }
+
+    fun std(ddof: Int = 1): Double = sqrt(variance(ddof))
+
+    /**
+     * 与 pandas 一致的无偏偏度，有效值不足3个时为 NaN，方差为 0 时为 0
+     */
+    fun skew(): Double {
+        if (count < 3) return Double.NaN
+        if (m2 == 0.0) return 0.0
+        val n = count.toDouble()
+        return n * sqrt(n - 1.0) * m3 / ((n - 2.0) * m2 * sqrt(m2))
+    }
+
+    /**
+     * 与 pandas 一致的无偏超额峰度，有效值不足4个时为 NaN，方差为 0 时为 0
+     */
+    fun kurt(): Double {
+        if (count < 4) return Double.NaN
+        if (m2 == 0.0) return 0.0
+        val n = count.toDouble()
+        val adjust = 3.0 * (n - 1.0) * (n - 1.0) / ((n - 2.0) * (n - 3.0))
+        return n * (n + 1.0) * (n - 1.0) * m4 / ((n - 2.0) * (n - 3.0) * m2 * m2) - adjust
+    }
+
+    override fun toString(): String =
+        "MomentAccumulator(count=$count, mean=$mean, std=${std()}, min=$min, max=$max)"
+
+    private fun copyFrom(other: MomentAccumulator) {
+        count = other.count
+        sumValue = other.sumValue
+        sumError = other.sumError
+        meanValue = other.meanValue
+        m2 = other.m2
+        m3 = other.m3
+        m4 = other.m4
+        minValue = other.minValue
+        maxValue = other.maxValue
+    }
+
+    // Neumaier 补偿求和
+    private fun addToSum(v: Double) {
+        val t = sumValue + v
+        if (!t.isFinite()) {
+            sumValue = t
+            return
+        }
+        sumError += if (abs(sumValue) >= abs(v)) (sumValue - t) + v else (v - t) + sumValue
+        sumValue = t
+    }
+
+    companion object {
+        // 块内两遍扫描的块大小，与原生层一致
+        private const val BLOCK = 512
+
+        private val nativeAvailable: Boolean by lazy {
+            try {
+                NativeMath.isAvailable()
+            } catch (e: Throwable) {
+                false
+            }
+        }
+
+        /**
+         * 计算一组值的矩，原生库可用时并行计算
+         */
+        fun of(values: DoubleArray): MomentAccumulator = of(values, MomentOrder.SHAPE)
+
+        internal fun of(values: DoubleArray, order: MomentOrder): MomentAccumulator {
+            if (nativeAvailable) {
+                return fromPacked(NativeMath.moments(values, order.code))
+            }
+            val result = MomentAccumulator()
+            var from = 0
+            while (from < values.size) {
+                val to = minOf(values.size, from + BLOCK)
+                result.merge(block(values, from, to, order))
+                from = to
+            }
+            return result
+        }
+
+        internal fun of(column: NativeColumn, order: MomentOrder): MomentAccumulator =
+            fromPacked(NativeMath.moments(column, order))
+
+        /**
+         * 由原生层的打包结果 [count, sum, mean, m2, m3, m4, min, max] 构建
+         */
+        internal fun fromPacked(packed: DoubleArray): MomentAccumulator {
+            val result = MomentAccumulator()
+            result.count = packed[0].toLong()
+            if (result.count == 0L) return result
+            result.sumValue = packed[1]
+            result.meanValue = packed[2]
+            result.m2 = packed[3]
+            result.m3 = packed[4]
+            result.m4 = packed[5]
+            result.minValue = packed[6]
+            result.maxValue = packed[7]
+            return result
+        }
+
+        private fun single(value: Double): MomentAccumulator {
+            val result = MomentAccumulator()
+            result.count = 1
+            result.sumValue = value
+            result.meanValue = value
+            result.minValue = value
+            result.maxValue = value
+            return result
+        }
+
+        // 与原生层 blockMoments 相同：先求块均值，再求块内中心矩
+        private fun block(values: DoubleArray, from: Int, to: Int, order: MomentOrder): MomentAccumulator {
+            val result = MomentAccumulator()
+            var count = 0L
+            var sum = 0.0
+            var min = Double.POSITIVE_INFINITY
+            var max = Double.NEGATIVE_INFINITY
+            for (i in from until to) {
+                val v = values[i]
+                if (v.isNaN()) continue
+                count++
+                sum += v
+                if (v < min) min = v
+                if (v > max) max = v
+            }
+            if (count == 0L) return result
+            result.count = count
+            result.sumValue = sum
+            result.meanValue = sum / count
+            if (order == MomentOrder.MEAN) return result
+            result.minValue = min
+            result.maxValue = max
+            if (min == max) {
+                result.meanValue = min
+                return result
+            }
+            val mean = result.meanValue
+            var s2 = 0.0
+            var s3 = 0.0
+            var s4 = 0.0
+            for (i in from until to) {
+                val v = values[i]
+                if (v.isNaN()) continue
+                val d = v - mean
+                val d2 = d * d
+                s2 += d2
+                s3 += d2 * d
+                s4 += d2 * d2
+            }
+            result.m2 = s2
+            result.m3 = s3
+            result.m4 = s4
+            return result
+        }
+    }
+}
@@ -10,7 +10,10 @@ object NativeBatch {
         System.loadLibrary("andas_native")
     }
     
-    // 批量处理操作
+    /**
+     * 逐元素计算 sin(x) + cos(x) * 2.0，由原生表达式流水线按数据块并行执行；batchSize 只为兼容保留。
+     * 任意逐元素表达式使用 DataFrame.eval
+     */
     external fun processBatch(array: DoubleArray, batchSize: Int): DoubleArray
     
     /**
@@ -0,0 +1,121 @@
+package cn.ac.oac.libs.andas.core
+
+import java.io.Closeable
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.DoubleBuffer
+
+/**
+ * 原生列 - 堆外 double 列
+ * 内存由原生层按64字节对齐分配，以 DirectByteBuffer 形式持有，
+ * NativeMath/NativeData 的列版本直接在该内存上计算，不经过 Java 数组复制
+ *
+ * 空值以 NaN 表示。使用完毕后应调用 close() 释放原生内存，关闭后不可再访问
+ * 由 ColumnarFile 映射得到的列不拥有内存，随文件关闭失效
+ */
+class NativeColumn private constructor(
+    val buffer: ByteBuffer,
+    val size: Int,
+    private val owner: ColumnarFile? = null
+) : Closeable {
+
+    private val doubles: DoubleBuffer = buffer.order(ByteOrder.nativeOrder()).asDoubleBuffer()
+
+    @Volatile
+    private var closed = false
+
+    operator fun get(index: Int): Double {
+        checkOpen()
+        return doubles.get(index)
+    }
+
+    operator fun set(index: Int, value: Double) {
+        checkOpen()
+        doubles.put(index, value)
+    }
+
+    /**
+     * 复制到 Java 数组
+     */
+    fun toDoubleArray(): DoubleArray {
+        checkOpen()
+        val result = DoubleArray(size)
+        doubles.duplicate().apply { position(0) }.get(result, 0, size)
+        return result
+    }
+
+    /**
+     * 只读列表视图，NaN 视为 null，不复制数据
+     */
+    fun asList(): List<Double?> = object : AbstractList<Double?>() {
+        override val size: Int get() = this@NativeColumn.size
+        override fun get(index: Int): Double? {
+            val value = this@NativeColumn[index]
+            return if (value.isNaN()) null else value
+        }
+    }
+
+    fun isClosed(): Boolean = closed || owner?.isClosed() == true
+
+    @Synchronized
+    override fun close() {
+        if (closed) return
+        closed = true
+        if (owner == null) freeBuffer(buffer)
+    }
+
+    // 未显式关闭时由GC兜底释放
+    protected fun finalize() {
+        close()
+    }
+
+    internal fun checkOpen() {
+        if (isClosed()) throw IllegalStateException("原生列已释放")
+    }
+
+    companion object {
+        init {
+            System.loadLibrary("andas_native")
+        }
+
+        private external fun allocateBuffer(byteSize: Long): ByteBuffer
+        private external fun freeBuffer(buffer: ByteBuffer)
+
+        /**
+         * 分配指定长度的原生列，内容未初始化
+         */
+        fun allocate(size: Int): NativeColumn {
+            if (size < 0) throw IllegalArgumentException("列长度不能为负数: $size")
+            return NativeColumn(allocateBuffer(size.toLong() * 8), size)
+        }
+
+        /**
+         * 包装映射文件中的 double 数据，不复制也不负责释放；列持有 owner，文件不会先于列被回收
+         */
+        internal fun wrap(buffer: ByteBuffer, size: Int, owner: ColumnarFile): NativeColumn {
+            return NativeColumn(buffer, size, owner)
+        }
+
+        /**
+         * 从 Java 数组创建原生列（复制一次）
+         */
+        fun fromDoubleArray(array: DoubleArray): NativeColumn {
+            val column = allocate(array.size)
+            column.doubles.duplicate().apply { position(0) }.put(array, 0, array.size)
+            return column
+        }
+
+        /**
+         * 从数值列表创建原生列，null 转为 NaN
+         */
+        fun fromValues(values: List<Any?>): NativeColumn {
+            val column = allocate(values.size)
+            val target = column.doubles
+            for (i in values.indices) {
+                val value = values[i]
+                target.put(i, if (value == null) Double.NaN else (value as Number).toDouble())
+            }
+            return column
+        }
+    }
+}
@@ -0,0 +1,77 @@
+package cn.ac.oac.libs.andas.core
+
+import java.nio.ByteBuffer
+
+/**
+ * 原生列式文件 - JNI包装
+ * 写入器和文件均以句柄表示；写入器由 finishWriter/abortWriter 释放，文件由 closeFile 释放
+ * 列名以 UTF-8 字节传递
+ */
+object NativeColumnar {
+
+    init {
+        System.loadLibrary("andas_native")
+    }
+
+    // buffer 的区段编号
+    const val PART_VALIDITY = 0
+    const val PART_VALUES = 1
+    const val PART_DICT_OFFSETS = 2
+    const val PART_DICT_CHARS = 3
+    const val PART_STATS = 4
+
+    external fun openWriter(path: String, rowCount: Long, statsChunkRows: Int): Long
+
+    /**
+     * 写入一列，values 长度必须等于 rowCount；valid 中 false 表示空值，为 null 表示没有空值
+     */
+    external fun writeBoolean(handle: Long, name: ByteArray, rowCount: Long, values: BooleanArray, valid: BooleanArray?)
+    external fun writeInt(handle: Long, name: ByteArray, rowCount: Long, values: IntArray, valid: BooleanArray?)
+    external fun writeLong(handle: Long, name: ByteArray, rowCount: Long, values: LongArray, valid: BooleanArray?)
+    external fun writeDouble(handle: Long, name: ByteArray, rowCount: Long, values: DoubleArray, valid: BooleanArray?)
+
+    /**
+     * 从 DirectByteBuffer 写入 double 列，NaN 视为空值
+     */
+    external fun writeDoubleColumn(handle: Long, name: ByteArray, rowCount: Long, buffer: ByteBuffer)
+
+    /**
+     * 写入字典编码的字符串列：codes[i] 为字典下标（-1 表示空值），
+     * 第 k 个字典项为 dictChars[dictOffsets[k], dictOffsets[k + 1])
+     */
+    external fun writeString(
+        handle: Long,
+        name: ByteArray,
+        rowCount: Long,
+        codes: IntArray,
+        dictChars: ByteArray,
+        dictOffsets: LongArray
+    )
+
+    /**
+     * 写出 schema 并回填文件头，无论成功与否都释放写入器
+     */
+    external fun finishWriter(handle: Long)
+
+    /**
+     * 放弃写入并释放写入器，已写出的文件无效
+     */
+    external fun abortWriter(handle: Long)
+
+    external fun openFile(path: String): Long
+    external fun rowCount(handle: Long): Long
+    external fun columnNames(handle: Long): Array<ByteArray>
+
+    /**
+     * 每列 5 项：类型编码, 空值数, 字典大小, 统计块行数, 统计块数
+     */
+    external fun columnInfo(handle: Long): LongArray
+
+    /**
+     * 指向映射内存的 DirectByteBuffer（不复制），区段不存在时返回 null
+     * 文件关闭后缓冲区失效，不可再访问
+     */
+    external fun buffer(handle: Long, column: Int, part: Int): ByteBuffer?
+
+    external fun closeFile(handle: Long)
+}
@@ -0,0 +1,61 @@
+package cn.ac.oac.libs.andas.core
+
+import java.io.InputStream
+
+/**
+ * 原生流式CSV读取器 - JNI包装
+ * open 返回读取器句柄，使用完毕必须调用 close 释放
+ */
+object NativeCsv {
+
+    init {
+        System.loadLibrary("andas_native")
+    }
+
+    /**
+     * 打开读取器，path 与 stream 只能指定一个
+     * 指定 stream 时按块回调 InputStream.read，不会关闭该流
+     *
+     * @param delimiter 分隔符，必须是ASCII字符
+     * @param quote 引号字符，必须是ASCII字符
+     * @param sampleRows 预先推断类型的样本行数
+     * @param chunkBytes 每次读取的块大小，<= 0 使用默认值（4MB）
+     * @param columns 只读取这些列，按给出的顺序输出；为 null 或空时读取全部列
+     * @param dictionaryEncode 字符串列在解析时做字典编码，见 nextBatch
+     */
+    external fun open(
+        path: String?,
+        stream: InputStream?,
+        delimiter: Char,
+        quote: Char,
+        header: Boolean,
+        skipLines: Int,
+        trim: Boolean,
+        inferTypes: Boolean,
+        nullValues: Array<String>,
+        sampleRows: Int,
+        chunkBytes: Int,
+        columns: Array<String>?,
+        dictionaryEncode: Boolean
+    ): Long
+
+    /**
+     * 列名（UTF-8字节）
+     */
+    external fun columnNames(handle: Long): Array<ByteArray>
+
+    /**
+     * 读取下一批，最多 maxRows 行，没有更多数据时返回 null
+     *
+     * 布局：[IntArray(行数, 各列类型编码...), 每列依次 4 项: 值, 字符串偏移, 有效位, 字典编号]
+     * - 值：BOOL→BooleanArray, INT32→IntArray, INT64→LongArray, FLOAT64→DoubleArray,
+     *   STRING→ByteArray(UTF-8)，EMPTY 为 null
+     * - 字符串偏移：仅 STRING 列，IntArray(行数 + 1)
+     * - 有效位：BooleanArray，false 表示空值；列中没有空值时为 null
+     * - 字典编号：仅字典编码的 STRING 列，IntArray(行数)，空值为 -1；
+     *   此时值和偏移只包含本批新加入字典的条目，编号在整个读取过程中保持不变
+     */
+    external fun nextBatch(handle: Long, maxRows: Int): Array<Any?>?
+
+    external fun close(handle: Long)
+}
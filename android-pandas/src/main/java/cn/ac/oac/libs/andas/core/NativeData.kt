@@ -1,5 +1,7 @@
 package cn.ac.oac.libs.andas.core
 
+import java.nio.ByteBuffer
+
 /**
  * 原生数据处理库 - JNI包装
  * 提供高性能的数据处理操作
@@ -20,20 +22,224 @@ object NativeData {
     // 分组聚合
     external fun groupBySum(values: DoubleArray, groups: IntArray): Map<String, Double>
     
-    // 排序和索引
+    /**
+     * 分组键中表示缺失值的编码，含缺失键的行不参与分组
+     */
+    const val NULL_GROUP_KEY = Long.MIN_VALUE
+    
+    /**
+     * 哈希分组聚合：一次遍历计算所有聚合，分组按首次出现的顺序返回
+     *
+     * @param keys 分组键列（int64，字符串等需先字典编码）
+     * @param values 值列，NaN 视为缺失值
+     * @param aggregations 聚合请求：(值列下标, 聚合类型)
+     */
+    fun groupByAggregate(
+        keys: Array<LongArray>,
+        values: Array<DoubleArray>,
+        aggregations: List<Pair<Int, AggOp>>
+    ): GroupByResult {
+        val columns = IntArray(aggregations.size) { aggregations[it].first }
+        val ops = IntArray(aggregations.size) { aggregations[it].second.code }
+        val raw = groupByAggregateArrays(keys, values, columns, ops)
+        return GroupByResult(
+            keys = Array(keys.size) { raw[it] as LongArray },
+            sizes = raw[keys.size] as LongArray,
+            aggregates = Array(aggregations.size) { raw[keys.size + 1 + it] as DoubleArray }
+        )
+    }
+    
+    private external fun groupByAggregateArrays(
+        keys: Array<LongArray>,
+        values: Array<DoubleArray>,
+        columns: IntArray,
+        ops: IntArray
+    ): Array<Any>
+    
+    // 排序和索引：稳定排序，NaN 无论升降序都排在最后
     external fun sortIndices(array: DoubleArray, descending: Boolean): IntArray
     
+    /**
+     * 多列稳定排序（基数排序），按键的先后做字典序比较，返回排序后的行号
+     */
+    fun sortIndices(keys: List<SortKey>): IntArray {
+        return sortIndicesArrays(
+            Array(keys.size) { keys[it].values },
+            BooleanArray(keys.size) { keys[it].descending },
+            BooleanArray(keys.size) { keys[it].nullsFirst }
+        )
+    }
+    
+    /**
+     * 部分排序：最大（largest）或最小的 k 个非缺失值的行号，按排序后的顺序，相等时行号小的在前
+     *
+     * @param values DoubleArray 或 LongArray，缺失值约定同 [SortKey]
+     */
+    fun topK(values: Any, k: Int, largest: Boolean): IntArray {
+        if (values !is DoubleArray && values !is LongArray) {
+            throw IllegalArgumentException("排序键必须是 DoubleArray 或 LongArray")
+        }
+        return topKIndices(values, k, largest)
+    }
+    
+    private external fun sortIndicesArrays(keys: Array<Any>, descending: BooleanArray, nullsFirst: BooleanArray): IntArray
+    private external fun topKIndices(values: Any, k: Int, largest: Boolean): IntArray
+    
     // 数据合并
     external fun mergeIndices(left: DoubleArray, right: DoubleArray): IntArray
     
+    /**
+     * 哈希连接：按精确相等匹配，返回 (左表行号, 右表行号)，-1 表示该侧没有对应行
+     * semi/anti 连接只返回左表行号，右表行号为空数组
+     *
+     * @param leftKeys 左表连接键列（int64，两侧需使用相同的编码）
+     * @param rightKeys 右表连接键列
+     */
+    fun joinIndices(leftKeys: Array<LongArray>, rightKeys: Array<LongArray>, how: JoinType): Pair<IntArray, IntArray> {
+        val result = joinIndicesArrays(leftKeys, rightKeys, how.code)
+        return result[0] to result[1]
+    }
+    
+    private external fun joinIndicesArrays(leftKeys: Array<LongArray>, rightKeys: Array<LongArray>, type: Int): Array<IntArray>
+    
     // 布尔索引
     external fun where(mask: BooleanArray): IntArray
-    
+
+    /**
+     * 谓词筛选：按后缀指令序列在选择位图上求值，返回选中的行号（升序）
+     *
+     * @param columns DoubleArray（NaN 为缺失值）或 LongArray（[NULL_GROUP_KEY] 为缺失值），长度一致
+     * @param program 每条指令 4 个 int：操作码、列下标、常量下标、常量个数，见 [FilterOp]
+     * @param doubles double 列使用的常量
+     * @param longs long 列使用的常量，长度与 doubles 相同
+     */
+    fun filterRows(columns: List<Any>, program: IntArray, doubles: DoubleArray, longs: LongArray): IntArray {
+        return filterRowsArrays(columns.toTypedArray(), program, doubles, longs)
+    }
+
+    private external fun filterRowsArrays(columns: Array<Any>, program: IntArray, doubles: DoubleArray, longs: LongArray): IntArray
+
     // 统计描述
     external fun describe(array: DoubleArray): DoubleArray
     
-    // 数据采样
-    external fun sample(array: DoubleArray, sampleSize: Int): DoubleArray
+    // 相关系数/协方差矩阵：k 个等长的列（NaN 为缺失值），返回 k×k 行主序矩阵，见 CorrelationEngine
+    external fun correlationMatrix(columns: Array<DoubleArray>, method: Int, minPeriods: Int): DoubleArray
+    external fun covarianceMatrix(columns: Array<DoubleArray>, minPeriods: Int, ddof: Int): DoubleArray
+
+    // 随机采样：返回按抽取顺序排列的行号，同一种子结果确定，见 SamplingEngine
+    external fun sampleIndices(n: Int, k: Int, seed: Long): IntArray
+    external fun weightedSampleIndices(weights: DoubleArray, k: Int, seed: Long): IntArray
+    external fun stratifiedSampleIndices(keys: Array<LongArray>, count: Int, fraction: Double, seed: Long): IntArray
+
+    // 流式摘要：返回打包结果，由 QuantileSketch / DistinctCountSketch / HeavyHitters 解析后合并
+    external fun quantileSketch(array: DoubleArray, k: Int): DoubleArray
+
+    /**
+     * HyperLogLog 寄存器
+     *
+     * @param values DoubleArray（NaN 为缺失值）或 LongArray（[NULL_GROUP_KEY] 为缺失值）
+     */
+    fun distinctSketch(values: Any, precision: Int): ByteArray {
+        if (values !is DoubleArray && values !is LongArray) {
+            throw IllegalArgumentException("去重计数的列必须是 DoubleArray 或 LongArray")
+        }
+        return distinctSketchArray(values, precision)
+    }
+
+    /**
+     * Space-Saving 高频项：[capacity, total, (key, count, error)...]，double 的键为位模式
+     *
+     * @param values 约定同 [distinctSketch]
+     */
+    fun heavyHitterSketch(values: Any, capacity: Int): LongArray {
+        if (values !is DoubleArray && values !is LongArray) {
+            throw IllegalArgumentException("高频项统计的列必须是 DoubleArray 或 LongArray")
+        }
+        return heavyHitterSketchArray(values, capacity)
+    }
+
+    private external fun distinctSketchArray(values: Any, precision: Int): ByteArray
+    private external fun heavyHitterSketchArray(values: Any, capacity: Int): LongArray
+
+    /**
+     * 多列去重：每个不同键首次出现的行号和出现次数，空值也是普通的键值
+     *
+     * @param keys 去重键列（int64，编码见 DedupKeyEncoding）
+     * @param sortByCount 按出现次数降序，次数相同的按首次出现的顺序；否则按首次出现的顺序
+     */
+    fun uniqueRows(keys: Array<LongArray>, sortByCount: Boolean): UniqueResult {
+        val raw = uniqueRowsArrays(keys, sortByCount)
+        return UniqueResult(raw[0] as IntArray, raw[1] as LongArray)
+    }
+
+    /**
+     * 每行是否为重复行
+     */
+    fun duplicatedRows(keys: Array<LongArray>, keep: DuplicateKeep): BooleanArray = duplicatedRowsArrays(keys, keep.code)
+
+    private external fun uniqueRowsArrays(keys: Array<LongArray>, sortByCount: Boolean): Array<Any>
+    private external fun duplicatedRowsArrays(keys: Array<LongArray>, keep: Int): BooleanArray
+
+    // 跨批次去重集合的句柄，见 DistinctRowSet
+    external fun distinctSetCreate(keyColumns: Int): Long
+    external fun distinctSetInsert(handle: Long, keys: Array<LongArray>): IntArray
+    external fun distinctSetSize(handle: Long): Long
+    external fun distinctSetRelease(handle: Long)
+
+    // 行索引的哈希表句柄，见 LabelHashTable
+    external fun hashIndexCreate(keys: LongArray): Long
+    external fun hashIndexFirst(handle: Long, key: Long): Int
+    external fun hashIndexNext(handle: Long, position: Int): Int
+    external fun hashIndexLookup(handle: Long, probes: LongArray): IntArray
+    external fun hashIndexFirstPositions(handle: Long): IntArray
+    external fun hashIndexIsUnique(handle: Long): Boolean
+    external fun hashIndexRelease(handle: Long)
+
+    // 外存排序与溢写分组的句柄，见 ExternalSorter / SpillAggregator
+    external fun externalSortCreate(directory: String, memoryBudget: Long, descending: Boolean): Long
+    external fun externalSortAdd(handle: Long, keys: DoubleArray, payload: ByteArray, offsets: IntArray)
+    external fun externalSortFinish(handle: Long)
+    external fun externalSortNext(handle: Long, maxBytes: Int): Array<Any>?
+    external fun externalSortSpilledBytes(handle: Long): Long
+    external fun externalSortRelease(handle: Long)
+    external fun spillAggregateCreate(directory: String, memoryBudget: Long): Long
+    external fun spillAggregateAdd(handle: Long, keys: ByteArray, offsets: IntArray, values: DoubleArray?)
+    external fun spillAggregateFinish(handle: Long)
+    external fun spillAggregateNext(handle: Long): Array<Any>?
+    external fun spillAggregateSpilledBytes(handle: Long): Long
+    external fun spillAggregateRelease(handle: Long)
+
+    // ==================== 原生列版本 ====================
+    
+    fun findNullIndices(column: NativeColumn): IntArray {
+        column.checkOpen()
+        return findNullIndicesColumn(column.buffer, column.size)
+    }
+    
+    fun fillNullWithConstant(column: NativeColumn, value: Double, out: NativeColumn = NativeColumn.allocate(column.size)): NativeColumn {
+        column.checkOpen()
+        out.checkOpen()
+        if (column.size != out.size) {
+            throw IllegalArgumentException("原生列长度不一致: ${column.size} != ${out.size}")
+        }
+        fillNullColumn(column.buffer, out.buffer, column.size, value)
+        return out
+    }
+    
+    fun sortIndices(column: NativeColumn, descending: Boolean): IntArray {
+        column.checkOpen()
+        return sortIndicesColumn(column.buffer, column.size, descending)
+    }
+    
+    fun describe(column: NativeColumn): DoubleArray {
+        column.checkOpen()
+        return describeColumn(column.buffer, column.size)
+    }
+    
+    private external fun findNullIndicesColumn(buffer: ByteBuffer, length: Int): IntArray
+    private external fun fillNullColumn(buffer: ByteBuffer, out: ByteBuffer, length: Int, value: Double)
+    private external fun sortIndicesColumn(buffer: ByteBuffer, length: Int, descending: Boolean): IntArray
+    private external fun describeColumn(buffer: ByteBuffer, length: Int): DoubleArray
     
     /**
      * 检查是否可用
@@ -1,5 +1,7 @@
 package cn.ac.oac.libs.andas.core
 
+import java.nio.ByteBuffer
+
 /**
  * 原生数学运算库 - JNI包装
  * 提供高性能的数学运算实现
@@ -24,9 +26,16 @@ object NativeMath {
     external fun norm(array: DoubleArray): Double
     external fun normalize(array: DoubleArray): DoubleArray
     
-    // 统计函数
-    external fun variance(array: DoubleArray): Double
-    external fun std(array: DoubleArray): Double
+    // 统计函数：返回打包的矩累加器 [count, sum, mean, m2, m3, m4, min, max]，order 为 MomentOrder.code
+    external fun moments(array: DoubleArray, order: Int): DoubleArray
+    
+    /**
+     * 方差，默认为样本方差 (ddof=1)，有效值不超过 ddof 个时为 NaN
+     */
+    fun variance(array: DoubleArray, ddof: Int = 1): Double =
+        MomentAccumulator.fromPacked(moments(array, MomentOrder.VARIANCE.code)).variance(ddof)
+    
+    fun std(array: DoubleArray, ddof: Int = 1): Double = kotlin.math.sqrt(variance(array, ddof))
     
     // 排序和索引
     external fun argsort(array: DoubleArray): IntArray
@@ -34,6 +43,120 @@ object NativeMath {
     // 布尔运算
     external fun greaterThan(array: DoubleArray, threshold: Double): BooleanArray
     
+    // 滑动窗口：op 为 RollingOp.code，返回第 [from, to) 行的结果，NaN 表示缺失
+    external fun rolling(
+        array: DoubleArray,
+        op: Int,
+        window: Int,
+        minPeriods: Int,
+        center: Boolean,
+        expanding: Boolean,
+        from: Int,
+        to: Int
+    ): DoubleArray
+    
+    // ==================== 原生列版本 ====================
+    // 直接在 NativeColumn 的堆外内存上计算，不复制输入
+    // 逐元素运算结果写入 out，out 传入输入列本身即为原地计算
+    
+    fun multiplyDoubleArray(column: NativeColumn, multiplier: Double, out: NativeColumn = NativeColumn.allocate(column.size)): NativeColumn {
+        checkSameSize(column, out)
+        multiplyColumn(column.buffer, out.buffer, column.size, multiplier)
+        return out
+    }
+    
+    fun sumDoubleArray(column: NativeColumn): Double {
+        column.checkOpen()
+        return sumColumn(column.buffer, column.size)
+    }
+    
+    fun meanDoubleArray(column: NativeColumn): Double {
+        column.checkOpen()
+        return meanColumn(column.buffer, column.size)
+    }
+    
+    fun maxDoubleArray(column: NativeColumn): Double {
+        column.checkOpen()
+        return maxColumn(column.buffer, column.size)
+    }
+    
+    fun minDoubleArray(column: NativeColumn): Double {
+        column.checkOpen()
+        return minColumn(column.buffer, column.size)
+    }
+    
+    fun vectorizedAdd(a: NativeColumn, b: NativeColumn, out: NativeColumn = NativeColumn.allocate(a.size)): NativeColumn {
+        checkSameSize(a, b)
+        checkSameSize(a, out)
+        addColumns(a.buffer, b.buffer, out.buffer, a.size)
+        return out
+    }
+    
+    fun vectorizedMultiply(a: NativeColumn, b: NativeColumn, out: NativeColumn = NativeColumn.allocate(a.size)): NativeColumn {
+        checkSameSize(a, b)
+        checkSameSize(a, out)
+        multiplyColumns(a.buffer, b.buffer, out.buffer, a.size)
+        return out
+    }
+    
+    fun dotProduct(a: NativeColumn, b: NativeColumn): Double {
+        checkSameSize(a, b)
+        return dotColumns(a.buffer, b.buffer, a.size)
+    }
+    
+    fun norm(column: NativeColumn): Double {
+        column.checkOpen()
+        return normColumn(column.buffer, column.size)
+    }
+    
+    fun normalize(column: NativeColumn, out: NativeColumn = NativeColumn.allocate(column.size)): NativeColumn {
+        checkSameSize(column, out)
+        normalizeColumn(column.buffer, out.buffer, column.size)
+        return out
+    }
+    
+    internal fun moments(column: NativeColumn, order: MomentOrder): DoubleArray {
+        column.checkOpen()
+        return momentsColumn(column.buffer, column.size, order.code)
+    }
+    
+    fun variance(column: NativeColumn, ddof: Int = 1): Double =
+        MomentAccumulator.of(column, MomentOrder.VARIANCE).variance(ddof)
+    
+    fun std(column: NativeColumn, ddof: Int = 1): Double = kotlin.math.sqrt(variance(column, ddof))
+    
+    fun argsort(column: NativeColumn): IntArray {
+        column.checkOpen()
+        return argsortColumn(column.buffer, column.size)
+    }
+    
+    fun greaterThan(column: NativeColumn, threshold: Double): BooleanArray {
+        column.checkOpen()
+        return greaterThanColumn(column.buffer, column.size, threshold)
+    }
+    
+    private fun checkSameSize(a: NativeColumn, b: NativeColumn) {
+        a.checkOpen()
+        b.checkOpen()
+        if (a.size != b.size) {
+            throw IllegalArgumentException("原生列长度不一致: ${a.size} != ${b.size}")
+        }
+    }
+    
+    private external fun multiplyColumn(buffer: ByteBuffer, out: ByteBuffer, length: Int, multiplier: Double)
+    private external fun sumColumn(buffer: ByteBuffer, length: Int): Double
+    private external fun meanColumn(buffer: ByteBuffer, length: Int): Double
+    private external fun maxColumn(buffer: ByteBuffer, length: Int): Double
+    private external fun minColumn(buffer: ByteBuffer, length: Int): Double
+    private external fun addColumns(a: ByteBuffer, b: ByteBuffer, out: ByteBuffer, length: Int)
+    private external fun multiplyColumns(a: ByteBuffer, b: ByteBuffer, out: ByteBuffer, length: Int)
+    private external fun dotColumns(a: ByteBuffer, b: ByteBuffer, length: Int): Double
+    private external fun normColumn(buffer: ByteBuffer, length: Int): Double
+    private external fun normalizeColumn(buffer: ByteBuffer, out: ByteBuffer, length: Int)
+    private external fun momentsColumn(buffer: ByteBuffer, length: Int, order: Int): DoubleArray
+    private external fun argsortColumn(buffer: ByteBuffer, length: Int): IntArray
+    private external fun greaterThanColumn(buffer: ByteBuffer, length: Int, threshold: Double): BooleanArray
+    
     /**
      * 检查是否可用
      */
@@ -0,0 +1,50 @@
+package cn.ac.oac.libs.andas.core
+
+/**
+ * 融合流水线 - JNI包装
+ * 筛选和一组逐元素表达式在原生层按数据块一次完成，中间结果不写回完整的列
+ *
+ * 两个方法的参数相同：
+ * - inputs: 表达式引用的输入列，长度均为 rowCount，NaN 为缺失值
+ * - filterColumns/filterProgram/filterDoubles/filterLongs: 与 [NativeData.filterRows] 的编码相同，
+ *   filterProgram 为空数组时不筛选
+ * - expressions: 各输出表达式的指令依次拼接，每条指令两个 int (op, arg)，op 见 [ExprOp]；
+ *   expressionLengths 为每个表达式的指令条数
+ * - constants: 表达式常量池
+ */
+internal object NativePipeline {
+
+    init {
+        System.loadLibrary("andas_native")
+    }
+
+    /**
+     * @return [选中的行号 IntArray（不筛选时为 null）, 每个输出表达式一个 DoubleArray]
+     */
+    external fun run(
+        rowCount: Int,
+        inputs: Array<DoubleArray>,
+        filterColumns: Array<Any>,
+        filterProgram: IntArray,
+        filterDoubles: DoubleArray,
+        filterLongs: LongArray,
+        expressions: IntArray,
+        expressionLengths: IntArray,
+        constants: DoubleArray
+    ): Array<Any?>
+
+    /**
+     * @return 每个输出表达式在选中行上的矩，按 [MomentAccumulator] 的打包格式每个 8 个 double 依次拼接
+     */
+    external fun moments(
+        rowCount: Int,
+        inputs: Array<DoubleArray>,
+        filterColumns: Array<Any>,
+        filterProgram: IntArray,
+        filterDoubles: DoubleArray,
+        filterLongs: LongArray,
+        expressions: IntArray,
+        expressionLengths: IntArray,
+        constants: DoubleArray
+    ): DoubleArray
+}
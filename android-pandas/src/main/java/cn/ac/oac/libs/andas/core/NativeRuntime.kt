@@ -0,0 +1,92 @@
+package cn.ac.oac.libs.andas.core
+
+/**
+ * 原生并行运行时 - JNI包装
+ * 控制 andas_native 内部线程池的线程数和串行阈值，以及原生内存预算
+ */
+object NativeRuntime {
+
+    init {
+        System.loadLibrary("andas_native")
+    }
+
+    /**
+     * 设置原生计算线程数（包含调用线程），<= 0 表示使用CPU核心数
+     */
+    external fun setNumThreads(numThreads: Int)
+    external fun getNumThreads(): Int
+
+    /**
+     * 设置并行阈值：元素数量低于该值的操作串行执行
+     */
+    external fun setParallelThreshold(threshold: Long)
+    external fun getParallelThreshold(): Long
+
+    /**
+     * 当前使用的SIMD内核：neon / avx2 / sse2 / scalar
+     */
+    external fun getSimdLevel(): String
+
+    /**
+     * 原生内存统计（字节）
+     *
+     * @param current 当前占用，包括缓冲区池中待复用的块和各线程临时分配区保留的块
+     * @param failures 超出预算或系统分配失败的次数，每次失败在 Kotlin 侧表现为 OutOfMemoryError
+     */
+    data class MemoryStats(
+        val limit: Long,
+        val current: Long,
+        val peak: Long,
+        val arenaReserved: Long,
+        val poolCached: Long,
+        val systemAllocations: Long,
+        val poolHits: Long,
+        val failures: Long
+    ) {
+        fun toMap(): Map<String, Any> = mapOf(
+            "limit_bytes" to limit,
+            "current_bytes" to current,
+            "peak_bytes" to peak,
+            "arena_reserved_bytes" to arenaReserved,
+            "pool_cached_bytes" to poolCached,
+            "system_allocations" to systemAllocations,
+            "pool_hits" to poolHits,
+            "failures" to failures
+        )
+    }
+
+    /**
+     * 设置原生内存预算（字节），<= 0 表示不限制
+     * 原生列缓冲区和内核的临时内存计入预算；超出时先归还缓存，仍然不够则对应调用抛出 OutOfMemoryError
+     */
+    external fun setMemoryLimit(bytes: Long)
+    external fun getMemoryLimit(): Long
+
+    fun memoryStats(): MemoryStats {
+        val v = memoryStatsNative()
+        return MemoryStats(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7])
+    }
+
+    /**
+     * 峰值重置为当前占用
+     */
+    external fun resetPeakMemory()
+
+    /**
+     * 归还缓冲区池中的缓存和调用线程的空闲临时内存
+     */
+    external fun trimMemory()
+
+    private external fun memoryStatsNative(): LongArray
+
+    /**
+     * 检查是否可用
+     */
+    fun isAvailable(): Boolean {
+        return try {
+            getNumThreads() > 0
+        } catch (e: Throwable) {
+            false
+        }
+    }
+}
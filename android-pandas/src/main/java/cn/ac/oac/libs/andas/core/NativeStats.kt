@@ -0,0 +1,221 @@
+package cn.ac.oac.libs.andas.core
+
+import java.io.File
+import kotlin.math.ceil
+
+/**
+ * 原生层埋点 - JNI包装
+ *
+ * 每个 JNI 入口（如 `NativeData.groupByAggregateArrays`）记录调用次数、总耗时、Java 数组的获取/释放/拷贝耗时、
+ * 输入输出字节数、数组是被固定(pin)还是被拷贝，以及耗时直方图；计数在原生层按线程累加，[snapshot] 时汇总。
+ * 追踪开启后记录每次调用和线程池各线程的区间，导出为 Chrome trace-event JSON（chrome://tracing 或 Perfetto 打开）。
+ *
+ * 原生库不可用时 [snapshot] 返回空快照，其余方法不做任何事
+ */
+object NativeStats {
+
+    /**
+     * 一个 JNI 入口的计数
+     *
+     * @param latencyHistogram 第 b 个元素为耗时落在 [2^b, 2^(b+1)) 纳秒内的调用次数
+     */
+    data class KernelStats(
+        val name: String,
+        val calls: Long,
+        val totalNanos: Long,
+        val marshalNanos: Long,
+        val bytesIn: Long,
+        val bytesOut: Long,
+        val pinnedArrays: Long,
+        val copiedArrays: Long,
+        val copiedBytes: Long,
+        val directBuffers: Long,
+        val latencyHistogram: LongArray
+    ) {
+        /**
+         * 不含数据转换的计算耗时
+         */
+        val computeNanos: Long get() = maxOf(0L, totalNanos - marshalNanos)
+
+        val meanNanos: Double get() = if (calls > 0) totalNanos.toDouble() / calls else 0.0
+
+        /**
+         * 由直方图估计的耗时分位数（纳秒），取所在桶的上界，误差在 2 倍以内
+         */
+        fun latencyPercentile(p: Double): Long {
+            if (p !in 0.0..1.0) throw IllegalArgumentException("分位数必须在 [0, 1] 内: $p")
+            val total = latencyHistogram.sum()
+            if (total == 0L) return 0L
+            val rank = maxOf(1L, ceil(p * total).toLong())
+            var seen = 0L
+            for (b in latencyHistogram.indices) {
+                seen += latencyHistogram[b]
+                if (seen >= rank) return (1L shl (b + 1)) - 1
+            }
+            return (1L shl latencyHistogram.size) - 1
+        }
+
+        fun toMap(): Map<String, Any> = mapOf(
+            "calls" to calls,
+            "total_ms" to totalNanos / 1e6,
+            "compute_ms" to computeNanos / 1e6,
+            "marshal_ms" to marshalNanos / 1e6,
+            "p50_us" to latencyPercentile(0.5) / 1e3,
+            "p99_us" to latencyPercentile(0.99) / 1e3,
+            "bytes_in" to bytesIn,
+            "bytes_out" to bytesOut,
+            "pinned_arrays" to pinnedArrays,
+            "copied_arrays" to copiedArrays,
+            "copied_bytes" to copiedBytes,
+            "direct_buffers" to directBuffers
+        )
+
+        override fun equals(other: Any?): Boolean =
+            other is KernelStats && name == other.name && calls == other.calls && totalNanos == other.totalNanos &&
+                marshalNanos == other.marshalNanos && bytesIn == other.bytesIn && bytesOut == other.bytesOut &&
+                pinnedArrays == other.pinnedArrays && copiedArrays == other.copiedArrays &&
+                copiedBytes == other.copiedBytes && directBuffers == other.directBuffers &&
+                latencyHistogram.contentEquals(other.latencyHistogram)
+
+        override fun hashCode(): Int = 31 * name.hashCode() + latencyHistogram.contentHashCode()
+    }
+
+    /**
+     * 自上次 [reset] 以来的计数，只包含有记录的入口；不在任何入口内的数据转换记在 "(unscoped)" 下
+     */
+    class Snapshot(val kernels: List<KernelStats>) {
+
+        val totalNanos: Long get() = kernels.sumOf { it.totalNanos }
+        val marshalNanos: Long get() = kernels.sumOf { it.marshalNanos }
+        val pinnedArrays: Long get() = kernels.sumOf { it.pinnedArrays }
+        val copiedArrays: Long get() = kernels.sumOf { it.copiedArrays }
+        val copiedBytes: Long get() = kernels.sumOf { it.copiedBytes }
+
+        operator fun get(name: String): KernelStats? = kernels.firstOrNull { it.name == name }
+
+        /**
+         * 总耗时最多的 n 个入口
+         */
+        fun slowest(n: Int = 10): List<KernelStats> = kernels.sortedByDescending { it.totalNanos }.take(n)
+
+        fun toMap(): Map<String, Any> = mapOf(
+            "total_ms" to totalNanos / 1e6,
+            "marshal_ms" to marshalNanos / 1e6,
+            "pinned_arrays" to pinnedArrays,
+            "copied_arrays" to copiedArrays,
+            "copied_bytes" to copiedBytes,
+            "kernels" to slowest(kernels.size).associate { it.name to it.toMap() }
+        )
+
+        override fun toString(): String = buildString {
+            append(String.format("%-48s %8s %12s %12s %10s %10s\n", "kernel", "calls", "total(ms)", "marshal(ms)", "p50(us)", "p99(us)"))
+            for (k in slowest(kernels.size)) {
+                append(String.format("%-48s %8d %12.3f %12.3f %10.1f %10.1f\n", k.name, k.calls, k.totalNanos / 1e6,
+                    k.marshalNanos / 1e6, k.latencyPercentile(0.5) / 1e3, k.latencyPercentile(0.99) / 1e3))
+            }
+        }
+    }
+
+    // 字段顺序与 instrumentation.h 的 Field 一致
+    private const val CALLS = 0
+    private const val TOTAL_NS = 1
+    private const val MARSHAL_NS = 2
+    private const val BYTES_IN = 3
+    private const val BYTES_OUT = 4
+    private const val PINNED = 5
+    private const val COPIED = 6
+    private const val COPIED_BYTES = 7
+    private const val DIRECT = 8
+    private const val LATENCY = 9
+
+    /**
+     * 每个线程默认保留的追踪事件数
+     */
+    const val DEFAULT_TRACE_EVENTS = 1 shl 16
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            System.loadLibrary("andas_native")
+            fieldCount() > LATENCY
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    /**
+     * 统计开关，默认开启；关闭后各入口只多一次标志检查
+     */
+    var enabled: Boolean
+        get() = nativeAvailable && isEnabledNative()
+        set(value) {
+            if (nativeAvailable) setEnabledNative(value)
+        }
+
+    fun snapshot(): Snapshot {
+        if (!nativeAvailable) return Snapshot(emptyList())
+        val stride = fieldCount()
+        val names = names()
+        val values = counters()
+        val kernels = ArrayList<KernelStats>()
+        for (i in names.indices) {
+            val base = i * stride
+            if (base + stride > values.size) break
+            if (values[base + CALLS] == 0L && values[base + MARSHAL_NS] == 0L && values[base + DIRECT] == 0L) continue
+            kernels.add(
+                KernelStats(
+                    name = names[i],
+                    calls = values[base + CALLS],
+                    totalNanos = values[base + TOTAL_NS],
+                    marshalNanos = values[base + MARSHAL_NS],
+                    bytesIn = values[base + BYTES_IN],
+                    bytesOut = values[base + BYTES_OUT],
+                    pinnedArrays = values[base + PINNED],
+                    copiedArrays = values[base + COPIED],
+                    copiedBytes = values[base + COPIED_BYTES],
+                    directBuffers = values[base + DIRECT],
+                    latencyHistogram = values.copyOfRange(base + LATENCY, base + stride)
+                )
+            )
+        }
+        return Snapshot(kernels)
+    }
+
+    /**
+     * 清零计数：之后的 [snapshot] 只包含 reset 之后的调用
+     */
+    fun reset() {
+        if (nativeAvailable) resetCounters()
+    }
+
+    /**
+     * 开始追踪并丢弃之前的事件；每个线程最多保留 eventsPerThread 个事件，多出的计入导出结果的 dropped
+     */
+    fun startTrace(eventsPerThread: Int = DEFAULT_TRACE_EVENTS) {
+        if (eventsPerThread <= 0) throw IllegalArgumentException("每个线程的追踪事件数必须为正数: $eventsPerThread")
+        if (nativeAvailable) startTraceNative(eventsPerThread)
+    }
+
+    /**
+     * 停止追踪，返回 Chrome trace-event JSON
+     */
+    fun stopTrace(): String {
+        if (!nativeAvailable) return "{\"traceEvents\":[]}"
+        return stopTraceNative()
+    }
+
+    /**
+     * 停止追踪并写入文件
+     */
+    fun stopTrace(file: File) {
+        file.writeText(stopTrace())
+    }
+
+    private external fun names(): Array<String>
+    private external fun counters(): LongArray
+    private external fun fieldCount(): Int
+    private external fun resetCounters()
+    private external fun setEnabledNative(enabled: Boolean)
+    private external fun isEnabledNative(): Boolean
+    private external fun startTraceNative(eventsPerThread: Int)
+    private external fun stopTraceNative(): String
+}
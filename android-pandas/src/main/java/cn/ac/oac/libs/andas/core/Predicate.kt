@@ -0,0 +1,422 @@
+package cn.ac.oac.libs.andas.core
+
+/**
+ * 列引用，用于构造筛选条件
+ *
+ * 例：`df.filter((col("price") gt 10) and (col("city") isIn listOf("北京", "上海")) or col("qty").isNull())`
+ *
+ * 中缀函数的优先级相同且从左到右结合，比较条件需要加括号
+ */
+class ColumnRef internal constructor(val name: String) {
+    infix fun gt(value: Any): Predicate = Predicate.Compare(name, FilterOp.GT, value)
+    infix fun ge(value: Any): Predicate = Predicate.Compare(name, FilterOp.GE, value)
+    infix fun lt(value: Any): Predicate = Predicate.Compare(name, FilterOp.LT, value)
+    infix fun le(value: Any): Predicate = Predicate.Compare(name, FilterOp.LE, value)
+    infix fun eq(value: Any): Predicate = Predicate.Compare(name, FilterOp.EQ, value)
+
+    /**
+     * 不等于，缺失值也被选中（与 pandas 一致）
+     */
+    infix fun ne(value: Any): Predicate = Predicate.Compare(name, FilterOp.NE, value)
+
+    /**
+     * low <= 值 <= high
+     */
+    fun between(low: Any, high: Any): Predicate = Predicate.Between(name, low, high)
+
+    /**
+     * 值属于集合；集合包含 null 时缺失值也被选中
+     */
+    infix fun isIn(values: Collection<Any?>): Predicate = Predicate.In(name, values.toList())
+
+    fun isNull(): Predicate = Predicate.IsNull(name)
+    fun notNull(): Predicate = Predicate.NotNull(name)
+}
+
+/**
+ * 引用列构造筛选条件
+ */
+fun col(name: String): ColumnRef = ColumnRef(name)
+
+/**
+ * 筛选条件，由 [col] 构造，用 and / or / not 组合
+ * 比较、区间和集合条件不选中缺失值（ne 除外），字符串等按值的自然顺序比较
+ */
+sealed class Predicate {
+    infix fun and(other: Predicate): Predicate = And(this, other)
+    infix fun or(other: Predicate): Predicate = Or(this, other)
+    operator fun not(): Predicate = Not(this)
+
+    /**
+     * 条件引用的所有列
+     */
+    fun columns(): Set<String> = LinkedHashSet<String>().also { collectColumns(it) }
+
+    private fun collectColumns(out: MutableSet<String>) {
+        when (this) {
+            is Compare -> out.add(column)
+            is Between -> out.add(column)
+            is In -> out.add(column)
+            is IsNull -> out.add(column)
+            is NotNull -> out.add(column)
+            is And -> { left.collectColumns(out); right.collectColumns(out) }
+            is Or -> { left.collectColumns(out); right.collectColumns(out) }
+            is Not -> operand.collectColumns(out)
+        }
+    }
+
+    internal class Compare(val column: String, val op: FilterOp, val value: Any) : Predicate() {
+        override fun toString() = "$column ${op.symbol} ${literal(value)}"
+    }
+
+    internal class Between(val column: String, val low: Any, val high: Any) : Predicate() {
+        override fun toString() = "$column BETWEEN ${literal(low)} AND ${literal(high)}"
+    }
+
+    internal class In(val column: String, val values: List<Any?>) : Predicate() {
+        override fun toString() = "$column IN (${values.joinToString(", ") { literal(it) }})"
+    }
+
+    internal class IsNull(val column: String) : Predicate() {
+        override fun toString() = "$column IS NULL"
+    }
+
+    internal class NotNull(val column: String) : Predicate() {
+        override fun toString() = "$column IS NOT NULL"
+    }
+
+    internal class And(val left: Predicate, val right: Predicate) : Predicate() {
+        override fun toString() = "($left AND $right)"
+    }
+
+    internal class Or(val left: Predicate, val right: Predicate) : Predicate() {
+        override fun toString() = "($left OR $right)"
+    }
+
+    internal class Not(val operand: Predicate) : Predicate() {
+        override fun toString() = "NOT $operand"
+    }
+
+    private companion object {
+        fun literal(value: Any?): String = if (value is String) "'$value'" else value.toString()
+    }
+}
+
+/**
+ * 筛选指令编码，与原生层 filter_engine.h 中的 FilterOp 保持一致
+ */
+internal enum class FilterOp(val code: Int, val symbol: String) {
+    GT(0, ">"),
+    GE(1, ">="),
+    LT(2, "<"),
+    LE(3, "<="),
+    EQ(4, "=="),
+    NE(5, "!="),
+    BETWEEN(6, "BETWEEN"),
+    IN_SET(7, "IN"),
+    IS_NULL(8, "IS NULL"),
+    NOT_NULL(9, "IS NOT NULL"),
+    AND(10, "AND"),
+    OR(11, "OR"),
+    NOT(12, "NOT");
+
+    companion object {
+        fun of(code: Int): FilterOp =
+            values().firstOrNull { it.code == code } ?: throw IllegalArgumentException("不支持的筛选操作: $code")
+    }
+}
+
+/**
+ * 筛选入口：条件编译为后缀指令序列，优先在原生层按选择位图求值，
+ * 原生库不可用时用 Kotlin 按相同语义逐行求值
+ */
+internal object FilterEngine {
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeData.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    /**
+     * 求值筛选条件，返回选中的行号（升序）
+     *
+     * @param rowCount 行数
+     * @param column 按列名取列数据，列不存在时抛出 IllegalArgumentException
+     */
+    fun selectRows(predicate: Predicate, rowCount: Int, column: (String) -> List<Any?>): IntArray {
+        val compiled = compile(predicate, rowCount, column)
+        if (nativeAvailable) {
+            return NativeData.filterRows(compiled.columns, compiled.codes, compiled.doubles, compiled.longs)
+        }
+        return evaluate(compiled, rowCount)
+    }
+
+    /**
+     * 编译后的筛选程序，编码与 NativeData.filterRows 一致；供融合执行的流水线直接交给原生层
+     */
+    class Compiled(
+        val columns: List<Any>,
+        val codes: IntArray,
+        val doubles: DoubleArray,
+        val longs: LongArray
+    )
+
+    fun compile(predicate: Predicate, rowCount: Int, column: (String) -> List<Any?>): Compiled {
+        val program = Program(column)
+        program.compile(predicate)
+        if (program.columns.any { columnSize(it) != rowCount }) {
+            throw IllegalArgumentException("筛选列长度与行数不一致")
+        }
+        return Compiled(
+            program.columns,
+            program.codes.toIntArray(),
+            program.doubles.toDoubleArray(),
+            program.longs.toLongArray()
+        )
+    }
+
+    private fun columnSize(values: Any): Int = if (values is DoubleArray) values.size else (values as LongArray).size
+
+    /**
+     * 整数键上的常量：floor 为不大于常量的最大整数，exact 表示常量恰好等于 floor
+     */
+    private class Bound(val floor: Long, val exact: Boolean)
+
+    private class Program(private val source: (String) -> List<Any?>) {
+        val columns = mutableListOf<Any>()
+        val codes = mutableListOf<Int>()
+        val doubles = mutableListOf<Double>()
+        val longs = mutableListOf<Long>()
+        private val encodings = mutableListOf<SortKeyEncoding.Encoded>()
+        private val columnIndex = HashMap<String, Int>()
+
+        fun compile(predicate: Predicate) {
+            when (predicate) {
+                is Predicate.And -> {
+                    compile(predicate.left)
+                    compile(predicate.right)
+                    emit(FilterOp.AND)
+                }
+                is Predicate.Or -> {
+                    compile(predicate.left)
+                    compile(predicate.right)
+                    emit(FilterOp.OR)
+                }
+                is Predicate.Not -> {
+                    compile(predicate.operand)
+                    emit(FilterOp.NOT)
+                }
+                is Predicate.IsNull -> emit(FilterOp.IS_NULL, columnOf(predicate.column))
+                is Predicate.NotNull -> emit(FilterOp.NOT_NULL, columnOf(predicate.column))
+                is Predicate.Compare -> compare(predicate)
+                is Predicate.Between -> between(predicate)
+                is Predicate.In -> inSet(predicate)
+            }
+        }
+
+        private fun compare(p: Predicate.Compare) {
+            val column = columnOf(p.column)
+            if (columns[column] is DoubleArray) {
+                emit(p.op, column, constant(doubleOf(p.column, p.value), 0L))
+                return
+            }
+            val ordering = p.op != FilterOp.EQ && p.op != FilterOp.NE
+            val bound = boundOf(column, p.column, p.value, ordering)
+            when {
+                // 与任何值都不相等：!= 选中所有行
+                p.op == FilterOp.NE && (bound == null || !bound.exact) -> {
+                    emitNone(column)
+                    emit(FilterOp.NOT)
+                }
+                bound == null || (!bound.exact && p.op == FilterOp.EQ) -> emitNone(column)
+                // floor < 常量 < floor + 1：> 和 >= 都等价于 > floor，< 和 <= 都等价于 <= floor
+                !bound.exact && (p.op == FilterOp.GT || p.op == FilterOp.GE) ->
+                    emit(FilterOp.GT, column, constant(0.0, bound.floor))
+                !bound.exact -> emit(FilterOp.LE, column, constant(0.0, bound.floor))
+                else -> emit(p.op, column, constant(0.0, bound.floor))
+            }
+        }
+
+        private fun between(p: Predicate.Between) {
+            val column = columnOf(p.column)
+            if (columns[column] is DoubleArray) {
+                val arg = constant(doubleOf(p.column, p.low), 0L)
+                constant(doubleOf(p.column, p.high), 0L)
+                emit(FilterOp.BETWEEN, column, arg)
+                return
+            }
+            val low = boundOf(column, p.column, p.low, true)
+            val high = boundOf(column, p.column, p.high, true)
+            if (low == null || high == null || (!low.exact && low.floor == Long.MAX_VALUE)) {
+                emitNone(column)
+                return
+            }
+            val arg = constant(0.0, if (low.exact) low.floor else low.floor + 1)
+            constant(0.0, high.floor)
+            emit(FilterOp.BETWEEN, column, arg)
+        }
+
+        private fun inSet(p: Predicate.In) {
+            val column = columnOf(p.column)
+            val arg = doubles.size
+            var count = 0
+            for (value in p.values) {
+                if (value == null) continue
+                if (columns[column] is DoubleArray) {
+                    if (value !is Number) continue
+                    constant(value.toDouble(), 0L)
+                } else {
+                    val bound = boundOf(column, p.column, value, false)
+                    if (bound == null || !bound.exact) continue
+                    constant(0.0, bound.floor)
+                }
+                count++
+            }
+            emit(FilterOp.IN_SET, column, arg, count)
+            if (p.values.any { it == null }) {
+                emit(FilterOp.IS_NULL, column)
+                emit(FilterOp.OR)
+            }
+        }
+
+        private fun doubleOf(name: String, value: Any): Double {
+            return when (value) {
+                is Number -> value.toDouble()
+                is Boolean -> if (value) 1.0 else 0.0
+                else -> throw IllegalArgumentException("无法将 $value 与数值列 $name 比较")
+            }
+        }
+
+        /**
+         * 常量在整数列（含字典编码列）上的位置；无法比较（NaN、字典中不可比较的等值条件）时返回 null
+         */
+        private fun boundOf(column: Int, name: String, value: Any, ordering: Boolean): Bound? {
+            val encoded = encodings[column]
+            val dictionary = encoded.dictionary
+            if (dictionary != null) {
+                encoded.lookup!![value]?.let { return Bound(it, true) }
+                val position = try {
+                    dictionary.binarySearch(value, encoded.comparator!!)
+                } catch (e: ClassCastException) {
+                    if (ordering) throw IllegalArgumentException("无法将 $value 与列 $name 比较")
+                    return null
+                }
+                // 未找到时常量位于 insertion - 1 与 insertion 两个编码之间
+                return if (position >= 0) Bound(position.toLong(), false) else Bound(-position - 2L, false)
+            }
+            return when (value) {
+                is Int, is Long, is Short, is Byte -> Bound((value as Number).toLong(), true)
+                is Boolean -> Bound(if (value) 1L else 0L, true)
+                is Number -> {
+                    val d = value.toDouble()
+                    if (d.isNaN()) return null
+                    val floor = Math.floor(d)
+                    // toLong 在超出范围时饱和到 Long.MIN_VALUE / Long.MAX_VALUE
+                    Bound(floor.toLong(), d == floor && d >= -9.223372036854775808E18 && d < 9.223372036854775808E18)
+                }
+                else -> throw IllegalArgumentException("无法将 $value 与数值列 $name 比较")
+            }
+        }
+
+        private fun columnOf(name: String): Int {
+            return columnIndex.getOrPut(name) {
+                val encoded = SortKeyEncoding.encodeWithDictionary(source(name))
+                encodings.add(encoded)
+                columns.add(encoded.values)
+                columns.size - 1
+            }
+        }
+
+        private fun constant(d: Double, l: Long): Int {
+            doubles.add(d)
+            longs.add(l)
+            return doubles.size - 1
+        }
+
+        // 不选中任何行：空的 IN 集合
+        private fun emitNone(column: Int) = emit(FilterOp.IN_SET, column, 0, 0)
+
+        private fun emit(op: FilterOp, column: Int = 0, arg: Int = 0, count: Int = 0) {
+            codes.add(op.code)
+            codes.add(column)
+            codes.add(arg)
+            codes.add(count)
+        }
+    }
+
+    /**
+     * Kotlin 逐行求值，原生库不可用时使用
+     */
+    fun evaluate(program: Compiled, rowCount: Int): IntArray {
+        val codes = program.codes
+        val doubles = program.doubles
+        val longs = program.longs
+        val stack = ArrayList<BooleanArray>()
+        for (i in 0 until codes.size / 4) {
+            val op = FilterOp.of(codes[i * 4])
+            when (op) {
+                FilterOp.AND, FilterOp.OR -> {
+                    val right = stack.removeAt(stack.size - 1)
+                    val left = stack[stack.size - 1]
+                    for (row in 0 until rowCount) {
+                        left[row] = if (op == FilterOp.AND) left[row] && right[row] else left[row] || right[row]
+                    }
+                }
+                FilterOp.NOT -> {
+                    val top = stack[stack.size - 1]
+                    for (row in 0 until rowCount) top[row] = !top[row]
+                }
+                else -> {
+                    val values = program.columns[codes[i * 4 + 1]]
+                    val arg = codes[i * 4 + 2]
+                    val count = codes[i * 4 + 3]
+                    stack.add(if (values is DoubleArray) {
+                        BooleanArray(rowCount) { row -> doubleLeaf(op, values[row], doubles, arg, count) }
+                    } else {
+                        BooleanArray(rowCount) { row -> longLeaf(op, (values as LongArray)[row], longs, arg, count) }
+                    })
+                }
+            }
+        }
+        val selected = stack.single()
+        return (0 until rowCount).filter { selected[it] }.toIntArray()
+    }
+
+    private fun doubleLeaf(op: FilterOp, v: Double, constants: DoubleArray, arg: Int, count: Int): Boolean {
+        return when (op) {
+            FilterOp.GT -> v > constants[arg]
+            FilterOp.GE -> v >= constants[arg]
+            FilterOp.LT -> v < constants[arg]
+            FilterOp.LE -> v <= constants[arg]
+            FilterOp.EQ -> v == constants[arg]
+            FilterOp.NE -> !(v == constants[arg])
+            FilterOp.BETWEEN -> v >= constants[arg] && v <= constants[arg + 1]
+            FilterOp.IN_SET -> (arg until arg + count).any { v == constants[it] }
+            FilterOp.IS_NULL -> v.isNaN()
+            FilterOp.NOT_NULL -> !v.isNaN()
+            else -> false
+        }
+    }
+
+    private fun longLeaf(op: FilterOp, v: Long, constants: LongArray, arg: Int, count: Int): Boolean {
+        val isNull = v == NativeData.NULL_GROUP_KEY
+        return when (op) {
+            FilterOp.IS_NULL -> isNull
+            FilterOp.NOT_NULL -> !isNull
+            FilterOp.NE -> isNull || v != constants[arg]
+            else -> !isNull && when (op) {
+                FilterOp.GT -> v > constants[arg]
+                FilterOp.GE -> v >= constants[arg]
+                FilterOp.LT -> v < constants[arg]
+                FilterOp.LE -> v <= constants[arg]
+                FilterOp.EQ -> v == constants[arg]
+                FilterOp.BETWEEN -> v >= constants[arg] && v <= constants[arg + 1]
+                FilterOp.IN_SET -> (arg until arg + count).any { v == constants[it] }
+                else -> false
+            }
+        }
+    }
+}
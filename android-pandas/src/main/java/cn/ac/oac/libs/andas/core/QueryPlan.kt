@@ -0,0 +1,529 @@
+package cn.ac.oac.libs.andas.core
+
+/**
+ * 表达式指令编码，与原生层 pipeline_engine.h 中的 ExprOp 保持一致
+ *
+ * @param arity 弹出的操作数个数，每条指令压入一个结果
+ */
+internal enum class ExprOp(val code: Int, val symbol: String, val arity: Int) {
+    COLUMN(0, "", 0),
+    CONST(1, "", 0),
+    ADD(2, "+", 2),
+    SUB(3, "-", 2),
+    MUL(4, "*", 2),
+    DIV(5, "/", 2),
+    NEG(6, "-", 1),
+    FILL_NULL(7, "fill_null", 2),
+    NORMALIZE(8, "normalize", 1),
+    ABS(9, "abs", 1),
+    SQRT(10, "sqrt", 1),
+    EXP(11, "exp", 1),
+    LOG(12, "log", 1),
+    SIN(13, "sin", 1),
+    COS(14, "cos", 1),
+    POW(15, "**", 2),
+    LT(16, "<", 2),
+    LE(17, "<=", 2),
+    GT(18, ">", 2),
+    GE(19, ">=", 2),
+    EQ(20, "==", 2),
+    NE(21, "!=", 2),
+    CLIP(22, "clip", 3),
+    WHERE(23, "where", 3),
+    AND(24, "&", 2),
+    OR(25, "|", 2),
+    NOT(26, "~", 1);
+
+    /**
+     * 对单个值求值，语义与原生层一致：比较和逻辑运算的结果为 1/0，有缺失值参与时为 NaN。
+     * 用于常量折叠和原生库不可用时的逐行求值；COLUMN/CONST/NORMALIZE 需要上下文，不在这里处理
+     */
+    fun apply(x: Double, y: Double = Double.NaN, z: Double = Double.NaN): Double = when (this) {
+        ADD -> x + y
+        SUB -> x - y
+        MUL -> x * y
+        DIV -> x / y
+        NEG -> -x
+        FILL_NULL -> if (x.isNaN()) y else x
+        ABS -> kotlin.math.abs(x)
+        SQRT -> kotlin.math.sqrt(x)
+        EXP -> kotlin.math.exp(x)
+        LOG -> kotlin.math.ln(x)
+        SIN -> kotlin.math.sin(x)
+        COS -> kotlin.math.cos(x)
+        POW -> Math.pow(x, y)
+        LT -> compare(x, y) { a, b -> a < b }
+        LE -> compare(x, y) { a, b -> a <= b }
+        GT -> compare(x, y) { a, b -> a > b }
+        GE -> compare(x, y) { a, b -> a >= b }
+        EQ -> compare(x, y) { a, b -> a == b }
+        NE -> compare(x, y) { a, b -> a != b }
+        AND -> compare(x, y) { a, b -> a != 0.0 && b != 0.0 }
+        OR -> compare(x, y) { a, b -> a != 0.0 || b != 0.0 }
+        NOT -> if (x.isNaN()) x else if (x == 0.0) 1.0 else 0.0
+        // NaN 边界的比较为 false，相当于不限制
+        CLIP -> (if (x < y) y else x).let { if (it > z) z else it }
+        WHERE -> if (x.isNaN()) x else if (x != 0.0) y else z
+        COLUMN, CONST, NORMALIZE -> throw IllegalArgumentException("不是逐元素运算: $this")
+    }
+
+    private inline fun compare(x: Double, y: Double, predicate: (Double, Double) -> Boolean): Double =
+        if (x.isNaN() || y.isNaN()) Double.NaN else if (predicate(x, y)) 1.0 else 0.0
+
+    companion object {
+        private val byCode = values().associateBy { it.code }
+
+        fun fromCode(code: Int): ExprOp = byCode[code] ?: throw IllegalArgumentException("不支持的表达式操作: $code")
+    }
+}
+
+/**
+ * 逐元素表达式，所有值按 double 计算，缺失值为 NaN
+ * 节点是数据类，结构相同的表达式相等，normalize 的统计量按结构去重
+ */
+internal sealed class Expr {
+
+    data class Column(val name: String) : Expr() {
+        override fun toString() = name
+    }
+
+    data class Literal(val value: Double) : Expr() {
+        override fun toString() = value.toString()
+    }
+
+    data class Binary(val op: ExprOp, val left: Expr, val right: Expr) : Expr() {
+        override fun toString() = "($left ${op.symbol} $right)"
+    }
+
+    data class Neg(val operand: Expr) : Expr() {
+        override fun toString() = "-$operand"
+    }
+
+    /**
+     * input 为缺失值时取 value
+     */
+    data class FillNull(val input: Expr, val value: Expr) : Expr() {
+        override fun toString() = "fill_null($input, $value)"
+    }
+
+    /**
+     * 按所在位置的行（之前的筛选之后）计算均值和总体标准差做标准化，缺失值保持缺失
+     */
+    data class Normalize(val input: Expr) : Expr() {
+        override fun toString() = "normalize($input)"
+    }
+
+    /**
+     * 一元或三元的函数调用：abs/sqrt/exp/log/sin/cos/not，clip(x, lo, hi)，where(cond, a, b)
+     */
+    data class Call(val op: ExprOp, val args: List<Expr>) : Expr() {
+        override fun toString() = if (op == ExprOp.NOT) "~${args[0]}" else "${op.symbol}(${args.joinToString(", ")})"
+    }
+
+    /**
+     * 表达式引用的所有列
+     */
+    fun columns(): Set<String> = LinkedHashSet<String>().also { collectColumns(it) }
+
+    private fun collectColumns(out: MutableSet<String>) {
+        when (this) {
+            is Column -> out.add(name)
+            is Literal -> {}
+            is Binary -> { left.collectColumns(out); right.collectColumns(out) }
+            is Neg -> operand.collectColumns(out)
+            is FillNull -> { input.collectColumns(out); value.collectColumns(out) }
+            is Normalize -> input.collectColumns(out)
+            is Call -> args.forEach { it.collectColumns(out) }
+        }
+    }
+
+    /**
+     * 所有 normalize 子表达式，内层在前
+     */
+    fun normalizations(): List<Normalize> = ArrayList<Normalize>().also { collectNormalizations(it) }
+
+    private fun collectNormalizations(out: MutableList<Normalize>) {
+        when (this) {
+            is Column, is Literal -> {}
+            is Binary -> { left.collectNormalizations(out); right.collectNormalizations(out) }
+            is Neg -> operand.collectNormalizations(out)
+            is FillNull -> { input.collectNormalizations(out); value.collectNormalizations(out) }
+            is Normalize -> { input.collectNormalizations(out); out.add(this) }
+            is Call -> args.forEach { it.collectNormalizations(out) }
+        }
+    }
+
+    /**
+     * 把引用的列替换为 bindings 中的表达式（融合相邻的逐元素运算），并折叠常量
+     */
+    fun substitute(bindings: Map<String, Expr>): Expr = when (this) {
+        is Column -> bindings[name] ?: this
+        is Literal -> this
+        is Binary -> binary(op, left.substitute(bindings), right.substitute(bindings))
+        is Neg -> operand.substitute(bindings).let { if (it is Literal) Literal(-it.value) else Neg(it) }
+        is FillNull -> input.substitute(bindings).let { if (it is Literal && !it.value.isNaN()) it else FillNull(it, value.substitute(bindings)) }
+        is Normalize -> Normalize(input.substitute(bindings))
+        is Call -> call(op, args.map { it.substitute(bindings) })
+    }
+
+    companion object {
+        /**
+         * 二元运算，两侧都是常量时直接折叠
+         */
+        fun binary(op: ExprOp, left: Expr, right: Expr): Expr {
+            if (op.arity != 2 || op == ExprOp.FILL_NULL) throw IllegalArgumentException("不是二元运算: $op")
+            if (left is Literal && right is Literal) return Literal(op.apply(left.value, right.value))
+            return Binary(op, left, right)
+        }
+
+        /**
+         * 函数调用，参数都是常量时直接折叠
+         */
+        fun call(op: ExprOp, args: List<Expr>): Expr {
+            if (op.arity != args.size || op.arity == 2 || op == ExprOp.NORMALIZE) {
+                throw IllegalArgumentException("不是${args.size}元函数: $op")
+            }
+            if (args.all { it is Literal }) {
+                val v = args.map { (it as Literal).value }
+                return Literal(op.apply(v[0], v.getOrElse(1) { Double.NaN }, v.getOrElse(2) { Double.NaN }))
+            }
+            return Call(op, args)
+        }
+    }
+}
+
+/**
+ * 查询计划的数据源，由上层实现
+ */
+internal interface ScanSource {
+    /**
+     * 列名；需要读取数据才能知道时为 null，列名检查推迟到执行时
+     */
+    val schema: List<String>?
+
+    fun describe(): String
+}
+
+/**
+ * 逻辑查询计划，每个节点的输出是一张表
+ */
+internal sealed class PlanNode {
+
+    /**
+     * 输出列名，未知时为 null
+     */
+    abstract fun schema(): List<String>?
+
+    /**
+     * @param columns 只读取这些列，为 null 时读取全部列
+     */
+    class Scan(val source: ScanSource, val columns: List<String>? = null) : PlanNode() {
+        override fun schema() = columns ?: source.schema
+    }
+
+    class Filter(val input: PlanNode, val predicate: Predicate) : PlanNode() {
+        override fun schema() = input.schema()
+    }
+
+    /**
+     * 计算新列或替换已有列，右侧引用的是输入中的列
+     */
+    class WithColumns(val input: PlanNode, val assignments: Map<String, Expr>) : PlanNode() {
+        override fun schema() = input.schema()?.let { names -> names + assignments.keys.filter { it !in names } }
+    }
+
+    class Select(val input: PlanNode, val columns: List<String>) : PlanNode() {
+        override fun schema() = columns
+    }
+
+    /**
+     * 分组聚合；operations 为 null 时对所有数值列求和
+     */
+    class Aggregate(val input: PlanNode, val keys: List<String>, val operations: Map<String, String>?) : PlanNode() {
+        override fun schema(): List<String>? {
+            if (operations == null) return null
+            return keys + operations.keys.map { if (it in keys) "${it}_${operations[it]!!.lowercase()}" else it }
+        }
+    }
+
+    /**
+     * 按缩进列出计划树，子节点在下
+     */
+    fun explain(): String = StringBuilder().also { appendTo(it, 0) }.toString().trimEnd()
+
+    private fun appendTo(out: StringBuilder, depth: Int) {
+        out.append("  ".repeat(depth))
+        when (this) {
+            is Scan -> out.append("Scan ${source.describe()}")
+                .append(if (columns != null) " columns=[${columns.joinToString(", ")}]" else "")
+            is Filter -> out.append("Filter $predicate")
+            is WithColumns -> out.append("WithColumns [${assignments.entries.joinToString(", ") { "${it.key} = ${it.value}" }}]")
+            is Select -> out.append("Select [${columns.joinToString(", ")}]")
+            is Aggregate -> out.append("Aggregate keys=[${keys.joinToString(", ")}] ")
+                .append(operations?.entries?.joinToString(", ", "[", "]") { "${it.value}(${it.key})" } ?: "sum(*)")
+        }
+        out.append('\n')
+        when (this) {
+            is Scan -> {}
+            is Filter -> input.appendTo(out, depth + 1)
+            is WithColumns -> input.appendTo(out, depth + 1)
+            is Select -> input.appendTo(out, depth + 1)
+            is Aggregate -> input.appendTo(out, depth + 1)
+        }
+    }
+}
+
+/**
+ * 查询计划优化：
+ * - 谓词下推：筛选移到不影响其结果的逐元素运算和列选择之下，相邻筛选合并为一个 AND；
+ *   含 normalize 的运算统计量依赖行集合，筛选不会越过它
+ * - 运算融合：相邻的 WithColumns 通过表达式代入合并为一个，执行时整段在一次遍历中完成
+ * - 投影裁剪：自顶向下计算需要的列，丢弃没有用到的计算列，数据源只读取需要的列（CSV 只解析这些列）
+ */
+internal object QueryOptimizer {
+
+    private const val MAX_PASSES = 32
+
+    fun optimize(plan: PlanNode): PlanNode {
+        var current = plan
+        for (pass in 0 until MAX_PASSES) {
+            val changed = BooleanArray(1)
+            current = rewrite(current, changed)
+            if (!changed[0]) break
+        }
+        return prune(current, null)
+    }
+
+    private fun rewrite(node: PlanNode, changed: BooleanArray): PlanNode {
+        val rewritten = when (node) {
+            is PlanNode.Scan -> node
+            is PlanNode.Filter -> PlanNode.Filter(rewrite(node.input, changed), node.predicate)
+            is PlanNode.WithColumns -> PlanNode.WithColumns(rewrite(node.input, changed), node.assignments)
+            is PlanNode.Select -> PlanNode.Select(rewrite(node.input, changed), node.columns)
+            is PlanNode.Aggregate -> PlanNode.Aggregate(rewrite(node.input, changed), node.keys, node.operations)
+        }
+        val local = rewriteLocal(rewritten) ?: return rewritten
+        changed[0] = true
+        return local
+    }
+
+    // 对单个节点应用一条规则，不适用时返回 null
+    private fun rewriteLocal(node: PlanNode): PlanNode? {
+        if (node is PlanNode.Filter) {
+            val input = node.input
+            when (input) {
+                is PlanNode.Filter -> return PlanNode.Filter(input.input, input.predicate and node.predicate)
+                is PlanNode.Select -> return PlanNode.Select(PlanNode.Filter(input.input, node.predicate), input.columns)
+                is PlanNode.WithColumns -> {
+                    val independent = node.predicate.columns().none { it in input.assignments }
+                    val stable = input.assignments.values.all { it.normalizations().isEmpty() }
+                    if (independent && stable) {
+                        return PlanNode.WithColumns(PlanNode.Filter(input.input, node.predicate), input.assignments)
+                    }
+                }
+                else -> {}
+            }
+            return null
+        }
+        if (node is PlanNode.WithColumns) {
+            val input = node.input
+            if (input is PlanNode.WithColumns) {
+                val merged = LinkedHashMap(input.assignments)
+                for ((name, expr) in node.assignments) merged[name] = expr.substitute(input.assignments)
+                return PlanNode.WithColumns(input.input, merged)
+            }
+            // 列选择上移，让两侧的运算可以继续合并；只在运算不引用被丢弃的列时进行
+            val referenced = node.assignments.values.flatMap { it.columns() }
+            if (input is PlanNode.Select && input.columns.containsAll(referenced)) {
+                val added = node.assignments.keys.filter { it !in input.columns }
+                return PlanNode.Select(PlanNode.WithColumns(input.input, node.assignments), input.columns + added)
+            }
+            return null
+        }
+        if (node is PlanNode.Select) {
+            val input = node.input
+            if (input is PlanNode.Select) return PlanNode.Select(input.input, node.columns)
+        }
+        return null
+    }
+
+    // required 为上层需要的列，null 表示全部
+    private fun prune(node: PlanNode, required: Set<String>?): PlanNode = when (node) {
+        is PlanNode.Scan -> {
+            val names = node.source.schema
+            val columns = when {
+                required == null -> null
+                names != null -> names.filter { it in required }
+                else -> required.toList()
+            }
+            PlanNode.Scan(node.source, columns)
+        }
+        is PlanNode.Filter -> PlanNode.Filter(prune(node.input, required?.plus(node.predicate.columns())), node.predicate)
+        is PlanNode.WithColumns -> {
+            val kept = if (required == null) node.assignments else node.assignments.filterKeys { it in required }
+            val below = required?.let { needed ->
+                (needed - kept.keys) + kept.values.flatMap { it.columns() }
+            }
+            val input = prune(node.input, below)
+            if (kept.isEmpty()) input else PlanNode.WithColumns(input, kept)
+        }
+        is PlanNode.Select -> PlanNode.Select(prune(node.input, node.columns.toSet()), node.columns)
+        is PlanNode.Aggregate -> {
+            val below = node.operations?.let { node.keys.toSet() + it.keys }
+            PlanNode.Aggregate(prune(node.input, below), node.keys, node.operations)
+        }
+    }
+}
+
+/**
+ * 把一组输出表达式编译为原生流水线的指令：每条指令两个 int (op, arg)，各表达式的指令依次拼接
+ *
+ * @param stats 各 normalize 子表达式的 (均值, 总体标准差)
+ */
+internal class ExprCompiler(private val stats: Map<Expr.Normalize, DoubleArray>) {
+    val inputs = mutableListOf<String>()
+    private val inputIndex = HashMap<String, Int>()
+    private val codes = mutableListOf<Int>()
+    private val lengths = mutableListOf<Int>()
+    private val constants = mutableListOf<Double>()
+
+    fun add(expr: Expr) {
+        val before = codes.size
+        emit(expr)
+        lengths.add((codes.size - before) / 2)
+    }
+
+    fun codes(): IntArray = codes.toIntArray()
+    fun lengths(): IntArray = lengths.toIntArray()
+    fun constants(): DoubleArray = constants.toDoubleArray()
+
+    private fun emit(expr: Expr) {
+        when (expr) {
+            is Expr.Column -> emit(ExprOp.COLUMN, inputIndex.getOrPut(expr.name) { inputs.add(expr.name); inputs.size - 1 })
+            is Expr.Literal -> emit(ExprOp.CONST, constant(expr.value))
+            is Expr.Binary -> { emit(expr.left); emit(expr.right); emit(expr.op, 0) }
+            is Expr.Neg -> { emit(expr.operand); emit(ExprOp.NEG, 0) }
+            is Expr.FillNull -> { emit(expr.input); emit(expr.value); emit(ExprOp.FILL_NULL, 0) }
+            is Expr.Call -> { expr.args.forEach { emit(it) }; emit(expr.op, 0) }
+            is Expr.Normalize -> {
+                val moments = stats[expr] ?: throw IllegalStateException("缺少标准化统计量: $expr")
+                emit(expr.input)
+                val arg = constant(moments[0])
+                constant(moments[1])
+                emit(ExprOp.NORMALIZE, arg)
+            }
+        }
+    }
+
+    private fun constant(value: Double): Int {
+        constants.add(value)
+        return constants.size - 1
+    }
+
+    private fun emit(op: ExprOp, arg: Int) {
+        codes.add(op.code)
+        codes.add(arg)
+    }
+}
+
+/**
+ * 流水线执行结果
+ *
+ * @param rows 选中的行号（升序），没有筛选时为 null
+ */
+internal class PipelineResult(val rows: IntArray?, val columns: List<DoubleArray>)
+
+/**
+ * 融合流水线入口：筛选和所有输出表达式在原生层按数据块一次完成，
+ * 原生库不可用时用 Kotlin 按相同语义逐行求值
+ */
+internal object PipelineEngine {
+
+    // 原生层每个 MomentAccumulator 打包为 8 个 double
+    private const val PACKED_MOMENTS = 8
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeRuntime.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    fun run(rowCount: Int, inputs: List<DoubleArray>, filter: FilterEngine.Compiled?, program: ExprCompiler): PipelineResult {
+        if (nativeAvailable) {
+            val raw = NativePipeline.run(
+                rowCount, inputs.toTypedArray(),
+                (filter?.columns ?: emptyList()).toTypedArray(), filter?.codes ?: IntArray(0),
+                filter?.doubles ?: DoubleArray(0), filter?.longs ?: LongArray(0),
+                program.codes(), program.lengths(), program.constants()
+            )
+            return PipelineResult(raw[0] as IntArray?, (1 until raw.size).map { raw[it] as DoubleArray })
+        }
+        val rows = filter?.let { FilterEngine.evaluate(it, rowCount) }
+        return PipelineResult(rows, evaluate(rowCount, inputs, rows, program))
+    }
+
+    /**
+     * 各输出表达式在选中行上的矩
+     */
+    fun moments(rowCount: Int, inputs: List<DoubleArray>, filter: FilterEngine.Compiled?, program: ExprCompiler): List<MomentAccumulator> {
+        if (nativeAvailable) {
+            val packed = NativePipeline.moments(
+                rowCount, inputs.toTypedArray(),
+                (filter?.columns ?: emptyList()).toTypedArray(), filter?.codes ?: IntArray(0),
+                filter?.doubles ?: DoubleArray(0), filter?.longs ?: LongArray(0),
+                program.codes(), program.lengths(), program.constants()
+            )
+            val width = PACKED_MOMENTS
+            return (0 until packed.size / width).map {
+                MomentAccumulator.fromPacked(packed.copyOfRange(it * width, (it + 1) * width))
+            }
+        }
+        return run(rowCount, inputs, filter, program).columns.map { column ->
+            MomentAccumulator().also { acc -> column.forEach { acc.add(it) } }
+        }
+    }
+
+    private fun evaluate(rowCount: Int, inputs: List<DoubleArray>, rows: IntArray?, program: ExprCompiler): List<DoubleArray> {
+        val codes = program.codes()
+        val constants = program.constants()
+        val size = rows?.size ?: rowCount
+        val outputs = ArrayList<DoubleArray>()
+        var start = 0
+        for (length in program.lengths()) {
+            val out = DoubleArray(size)
+            val stack = DoubleArray(length)
+            for (r in 0 until size) {
+                val row = rows?.get(r) ?: r
+                var depth = 0
+                for (i in start until start + length) {
+                    val arg = codes[i * 2 + 1]
+                    when (val code = codes[i * 2]) {
+                        ExprOp.COLUMN.code -> stack[depth++] = inputs[arg][row]
+                        ExprOp.CONST.code -> stack[depth++] = constants[arg]
+                        ExprOp.NORMALIZE.code -> {
+                            val x = stack[depth - 1]
+                            val sd = constants[arg + 1]
+                            stack[depth - 1] = if (sd > 0.0) (x - constants[arg]) / sd else if (x.isNaN()) x else 0.0
+                        }
+                        else -> {
+                            val op = ExprOp.fromCode(code)
+                            val base = depth - op.arity
+                            stack[base] = when (op.arity) {
+                                1 -> op.apply(stack[base])
+                                2 -> op.apply(stack[base], stack[base + 1])
+                                else -> op.apply(stack[base], stack[base + 1], stack[base + 2])
+                            }
+                            depth = base + 1
+                        }
+                    }
+                }
+                out[r] = stack[0]
+            }
+            outputs.add(out)
+            start += length
+        }
+        return outputs
+    }
+}
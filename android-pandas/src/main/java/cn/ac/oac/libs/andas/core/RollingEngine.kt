@@ -0,0 +1,154 @@
+package cn.ac.oac.libs.andas.core
+
+import kotlin.math.sqrt
+
+/**
+ * 滑动窗口聚合类型，code 与原生层 RollingOp 一致
+ */
+enum class RollingOp(val code: Int) {
+    SUM(0),
+    MEAN(1),
+    VAR(2),      // 样本方差 (ddof=1)
+    STD(3),
+    MIN(4),
+    MAX(5),
+    COUNT(6),    // 非缺失值个数
+    MEDIAN(7)
+}
+
+/**
+ * 窗口参数
+ *
+ * @property window 窗口行数，expanding 时忽略
+ * @property minPeriods 窗口内非缺失值少于该数时结果为缺失值
+ * @property center 窗口居中，与 pandas 一致向后偏移 (window - 1) / 2 行
+ * @property expanding 扩展窗口：从第 0 行到当前行
+ */
+internal data class WindowSpec(
+    val window: Int,
+    val minPeriods: Int,
+    val center: Boolean = false,
+    val expanding: Boolean = false
+) {
+    init {
+        if (!expanding && window < 1) throw IllegalArgumentException("窗口大小必须大于0: $window")
+        if (minPeriods < 0 || (!expanding && minPeriods > window)) {
+            throw IllegalArgumentException("minPeriods 必须在 0 到窗口大小之间: $minPeriods")
+        }
+    }
+
+    val offset: Int get() = if (center && !expanding) (window - 1) / 2 else 0
+
+    /**
+     * 长度为 n 的序列中第 i 行的窗口 [start, end)
+     */
+    fun bounds(n: Int, i: Int): IntRange {
+        if (expanding) return 0 until minOf(n, i + 1)
+        val end = i + 1 + offset
+        return maxOf(0, end - window) until minOf(n, end)
+    }
+
+    companion object {
+        fun fixed(window: Int, minPeriods: Int?, center: Boolean): WindowSpec =
+            WindowSpec(window, minPeriods ?: window, center, false)
+
+        fun expanding(minPeriods: Int): WindowSpec = WindowSpec(0, minPeriods, false, true)
+    }
+}
+
+/**
+ * 滑动窗口入口：优先使用原生增量算法（总代价 O(n)），原生库不可用时逐窗口计算，两者语义一致
+ * NaN 为缺失值，不计入窗口；结果中的 NaN 表示缺失
+ */
+internal object RollingEngine {
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeMath.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    /**
+     * 计算第 [from, to) 行的结果，窗口可以使用该范围以外的值
+     */
+    fun apply(values: DoubleArray, op: RollingOp, spec: WindowSpec, from: Int = 0, to: Int = values.size): DoubleArray {
+        if (from < 0 || to < from || to > values.size) {
+            throw IllegalArgumentException("行范围越界: [$from, $to)")
+        }
+        if (nativeAvailable) {
+            return NativeMath.rolling(values, op.code, spec.window, spec.minPeriods, spec.center, spec.expanding, from, to)
+        }
+        return DoubleArray(to - from) { aggregate(values, spec.bounds(values.size, from + it), op, spec.minPeriods) }
+    }
+
+    private fun aggregate(values: DoubleArray, range: IntRange, op: RollingOp, minPeriods: Int): Double {
+        val window = range.map { values[it] }.filter { !it.isNaN() }
+        val count = window.size
+        if (count < minPeriods) return Double.NaN
+        return when (op) {
+            RollingOp.COUNT -> count.toDouble()
+            RollingOp.SUM -> window.sum()
+            RollingOp.MEAN -> if (count > 0) window.sum() / count else Double.NaN
+            RollingOp.VAR, RollingOp.STD -> {
+                if (count < 2) return Double.NaN
+                // 与原生层一致：全部相等时方差为 0
+                val variance = if (window.all { it == window[0] }) 0.0 else {
+                    val mean = window.sum() / count
+                    window.sumOf { (it - mean) * (it - mean) } / (count - 1)
+                }
+                if (op == RollingOp.VAR) variance else sqrt(variance)
+            }
+            RollingOp.MIN -> window.minOrNull() ?: Double.NaN
+            RollingOp.MAX -> window.maxOrNull() ?: Double.NaN
+            RollingOp.MEDIAN -> {
+                if (count == 0) return Double.NaN
+                val sorted = window.sorted()
+                if (count % 2 == 1) sorted[count / 2] else (sorted[count / 2 - 1] + sorted[count / 2]) / 2.0
+            }
+        }
+    }
+}
+
+/**
+ * 分批滑动窗口：按顺序逐批输入数据，跨批次保留窗口所需的最后 window - 1 个值，
+ * 结果与一次性计算整列相同
+ *
+ * 居中窗口时每批末尾 (window - 1) / 2 行要等后续数据才能确定，在下一批或 [finish] 时输出
+ * 扩展窗口需要保留全部历史，不支持分批
+ */
+class RollingAccumulator(
+    private val op: RollingOp,
+    window: Int,
+    minPeriods: Int? = null,
+    center: Boolean = false
+) {
+    private val spec = WindowSpec.fixed(window, minPeriods, center)
+    // 上一批保留的末尾数据，其中最后 pending 行尚未输出
+    private var carry = DoubleArray(0)
+    private var pending = 0
+
+    /**
+     * 输入一批数据（NaN 为缺失值），返回本批新确定的各行结果
+     */
+    fun update(batch: DoubleArray): DoubleArray {
+        val buffer = carry + batch
+        val from = carry.size - pending
+        val to = maxOf(from, buffer.size - spec.offset)
+        val result = RollingEngine.apply(buffer, op, spec, from, to)
+        pending = buffer.size - to
+        carry = buffer.copyOfRange(maxOf(0, buffer.size - (spec.window - 1)), buffer.size)
+        return result
+    }
+
+    /**
+     * 数据输入完毕，返回剩余未输出行的结果，并重置状态
+     */
+    fun finish(): DoubleArray {
+        val result = RollingEngine.apply(carry, op, spec, carry.size - pending, carry.size)
+        carry = DoubleArray(0)
+        pending = 0
+        return result
+    }
+}
@@ -0,0 +1,283 @@
+package cn.ac.oac.libs.andas.core
+
+import kotlin.math.exp
+import kotlin.math.floor
+import kotlin.math.ln
+import kotlin.math.ln1p
+import kotlin.random.Random
+
+/**
+ * xoshiro256** 随机数生成器，种子经 splitmix64 展开；与原生实现逐位一致
+ */
+internal class Xoshiro256(seed: Long) {
+    private var s0: Long
+    private var s1: Long
+    private var s2: Long
+    private var s3: Long
+
+    init {
+        var state = seed
+        fun splitMix(): Long {
+            state += GOLDEN_GAMMA
+            var z = state
+            z = (z xor (z ushr 30)) * 0xbf58476d1ce4e5b9UL.toLong()
+            z = (z xor (z ushr 27)) * 0x94d049bb133111ebUL.toLong()
+            return z xor (z ushr 31)
+        }
+        s0 = splitMix()
+        s1 = splitMix()
+        s2 = splitMix()
+        s3 = splitMix()
+    }
+
+    fun next(): Long {
+        val result = (s1 * 5).rotateLeft(7) * 9
+        val t = s1 shl 17
+        s2 = s2 xor s0
+        s3 = s3 xor s1
+        s1 = s1 xor s2
+        s0 = s0 xor s3
+        s2 = s2 xor t
+        s3 = s3.rotateLeft(45)
+        return result
+    }
+
+    /**
+     * (0, 1) 内的均匀分布，不会取到 0
+     */
+    fun uniform(): Double = openUnit(next())
+
+    /**
+     * [0, bound) 内的均匀整数，拒绝采样消除取模偏差
+     */
+    fun below(bound: Long): Long {
+        val b = bound.toULong()
+        val threshold = (0UL - b) % b
+        while (true) {
+            val r = next().toULong()
+            if (r >= threshold) return (r % b).toLong()
+        }
+    }
+
+    fun below(bound: Int): Int = below(bound.toLong()).toInt()
+
+    companion object {
+        val GOLDEN_GAMMA = 0x9e3779b97f4a7c15UL.toLong()
+
+        fun openUnit(bits: Long): Double = ((bits ushr 11).toDouble() + 0.5) * (1.0 / (1L shl 53))
+
+        /**
+         * 由同一种子派生第 stream 条随机流的种子
+         */
+        fun deriveSeed(seed: Long, stream: Long): Long = SketchKeys.mix64(seed xor SketchKeys.mix64(stream + 1))
+    }
+}
+
+/**
+ * 采样入口：返回行号，优先使用原生实现，原生库不可用时退化为 Kotlin 实现，同一种子两者结果一致
+ */
+internal object SamplingEngine {
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeData.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    /**
+     * 未指定种子时随机取一个
+     */
+    fun seedOf(seed: Long?): Long = seed ?: Random.nextLong()
+
+    /**
+     * 按比例采样的行数：round(fraction * n)
+     */
+    fun countOf(fraction: Double, n: Int): Int {
+        checkFraction(fraction)
+        return floor(fraction * n + 0.5).toInt()
+    }
+
+    fun checkFraction(fraction: Double) {
+        if (!(fraction in 0.0..1.0)) throw IllegalArgumentException("采样比例必须在 [0, 1] 内: $fraction")
+    }
+
+    /**
+     * 从 [0, n) 中不放回地取 k 个（部分 Fisher–Yates），按抽取顺序返回
+     */
+    fun sampleIndices(n: Int, k: Int, seed: Long): IntArray {
+        if (nativeAvailable) return NativeData.sampleIndices(n, k, seed)
+        return sampleIndicesKotlin(n, k, seed)
+    }
+
+    /**
+     * 加权不放回采样（Efraimidis–Spirakis），按抽取顺序返回；权重 <= 0 或 NaN 的行不会被选中
+     */
+    fun weightedSampleIndices(weights: DoubleArray, k: Int, seed: Long): IntArray {
+        if (nativeAvailable) return NativeData.weightedSampleIndices(weights, k, seed)
+        if (k <= 0) return IntArray(0)
+        val base = SketchKeys.mix64(seed)
+        val keys = DoubleArray(weights.size) { i ->
+            val w = weights[i]
+            if (w > 0.0) ln(Xoshiro256.openUnit(SketchKeys.mix64(base + (i + 1L) * Xoshiro256.GOLDEN_GAMMA))) / w else Double.NaN
+        }
+        return weights.indices
+            .filter { !keys[it].isNaN() }
+            .sortedWith(compareByDescending<Int> { keys[it] }.thenBy { it })
+            .take(k)
+            .toIntArray()
+    }
+
+    /**
+     * 分层采样：count >= 0 时每层取 count 行，否则每层取 round(fraction * 层大小) 行；
+     * 含 [NativeData.NULL_GROUP_KEY] 的行不参与，输出按层的首次出现顺序排列
+     */
+    fun stratifiedSampleIndices(keys: Array<LongArray>, count: Int, fraction: Double, seed: Long): IntArray {
+        if (nativeAvailable) return NativeData.stratifiedSampleIndices(keys, count, fraction, seed)
+        val rowCount = keys.firstOrNull()?.size ?: 0
+        val strata = LinkedHashMap<List<Long>, MutableList<Int>>()
+        for (i in 0 until rowCount) {
+            val key = keys.map { it[i] }
+            if (key.any { it == NativeData.NULL_GROUP_KEY }) continue
+            strata.getOrPut(key) { mutableListOf() }.add(i)
+        }
+        val result = ArrayList<Int>()
+        strata.values.forEachIndexed { s, rows ->
+            val take = if (count >= 0) minOf(count, rows.size) else floor(fraction * rows.size + 0.5).toInt().coerceIn(0, rows.size)
+            val picked = sampleIndicesKotlin(rows.size, take, Xoshiro256.deriveSeed(seed, s.toLong()))
+            picked.forEach { result.add(rows[it]) }
+        }
+        return result.toIntArray()
+    }
+
+    private fun sampleIndicesKotlin(n: Int, k: Int, seed: Long): IntArray {
+        val size = k.coerceIn(0, maxOf(n, 0))
+        val random = Xoshiro256(seed)
+        if (size.toLong() * 4 >= n) {
+            val permutation = IntArray(n) { it }
+            for (i in 0 until size) {
+                val j = i + random.below(n - i)
+                val tmp = permutation[i]
+                permutation[i] = permutation[j]
+                permutation[j] = tmp
+            }
+            return permutation.copyOf(size)
+        }
+        // 未记录的位置 p 上的值就是 p
+        val moved = HashMap<Int, Int>(size * 2)
+        return IntArray(size) { i ->
+            val j = i + random.below(n - i)
+            val valueJ = moved[j] ?: j
+            moved[j] = moved[i] ?: i
+            valueJ
+        }
+    }
+}
+
+/**
+ * 蓄水池采样（Algorithm L）：一次遍历数据流，始终保留 capacity 个等概率样本，
+ * 只为被选中的元素消耗随机数，总代价 O(capacity · log(n / capacity))
+ *
+ * @param capacity 样本容量
+ * @param seed 随机种子，相同种子和相同输入得到相同样本
+ */
+class ReservoirSampler(val capacity: Int, seed: Long) {
+    private val random = Xoshiro256(seed)
+    private var weight = 0.0
+    // 下一个被选中元素的序号
+    private var nextIndex = 0L
+
+    /**
+     * 已经处理的元素个数
+     */
+    var seen = 0L
+        private set
+
+    init {
+        if (capacity < 0) throw IllegalArgumentException("样本容量不能为负数: $capacity")
+    }
+
+    /**
+     * 处理接下来的 count 个元素：被选中的元素调用 consumer(在本批中的偏移, 槽位)，
+     * 槽位在 [0, capacity) 内，后调用的覆盖同一槽位上较早的元素
+     */
+    fun advance(count: Int, consumer: (offset: Int, slot: Int) -> Unit) {
+        val end = seen + count
+        while (capacity > 0 && nextIndex < end) {
+            val offset = (nextIndex - seen).toInt()
+            if (nextIndex < capacity) {
+                // 前 capacity 个元素直接填满蓄水池
+                consumer(offset, nextIndex.toInt())
+                if (nextIndex == capacity - 1L) {
+                    weight = exp(ln(random.uniform()) / capacity)
+                    nextIndex += gap()
+                } else {
+                    nextIndex++
+                }
+            } else {
+                consumer(offset, random.below(capacity))
+                weight *= exp(ln(random.uniform()) / capacity)
+                nextIndex += gap()
+            }
+        }
+        seen = end
+    }
+
+    // 到下一个被选中元素的距离，至少为 1
+    private fun gap(): Long {
+        val skip = floor(ln(random.uniform()) / ln1p(-weight))
+        return if (skip >= MAX_GAP) MAX_GAP else skip.toLong() + 1
+    }
+
+    private companion object {
+        const val MAX_GAP = Long.MAX_VALUE / 4
+    }
+}
+
+/**
+ * 伯努利采样：每个元素独立地以 fraction 的概率选中；按几何分布直接跳到下一个被选中的元素，
+ * 适合从数据流中取固定比例的样本
+ *
+ * @param fraction 选中概率，[0, 1]
+ * @param seed 随机种子
+ */
+class BernoulliSampler(val fraction: Double, seed: Long) {
+    private val random = Xoshiro256(seed)
+    // 下一个被选中元素的序号
+    private var nextIndex: Long
+
+    /**
+     * 已经处理的元素个数
+     */
+    var seen = 0L
+        private set
+
+    init {
+        SamplingEngine.checkFraction(fraction)
+        nextIndex = skip()
+    }
+
+    /**
+     * 处理接下来的 count 个元素，被选中的元素按顺序调用 consumer(在本批中的偏移)
+     */
+    fun advance(count: Int, consumer: (offset: Int) -> Unit) {
+        val end = seen + count
+        while (nextIndex < end) {
+            consumer((nextIndex - seen).toInt())
+            nextIndex += skip() + 1
+        }
+        seen = end
+    }
+
+    // 到下一个被选中元素之前跳过的元素个数
+    private fun skip(): Long {
+        if (fraction == 0.0) return MAX_SKIP
+        val skip = floor(ln(random.uniform()) / ln1p(-fraction))
+        return if (skip >= MAX_SKIP) MAX_SKIP else skip.toLong()
+    }
+
+    private companion object {
+        const val MAX_SKIP = Long.MAX_VALUE / 4
+    }
+}
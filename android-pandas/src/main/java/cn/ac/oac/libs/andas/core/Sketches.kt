@@ -0,0 +1,593 @@
+package cn.ac.oac.libs.andas.core
+
+import java.math.BigDecimal
+import kotlin.math.ceil
+import kotlin.math.ln
+import kotlin.math.pow
+import kotlin.math.roundToLong
+import kotlin.math.sqrt
+
+/**
+ * 摘要使用的 64 位键和哈希，与原生层 hash_utils.h / sketches.cpp 一致
+ */
+internal object SketchKeys {
+
+    fun mix64(value: Long): Long {
+        var x = value
+        x = x xor (x ushr 33)
+        x *= 0xff51afd7ed558ccdUL.toLong()
+        x = x xor (x ushr 33)
+        x *= 0xc4ceb9fe1a85ec53UL.toLong()
+        x = x xor (x ushr 33)
+        return x
+    }
+
+    /**
+     * double 的键为原始位模式，-0.0 与 0.0 视为同一个值
+     */
+    fun doubleKey(value: Double): Long = (if (value == 0.0) 0.0 else value).toRawBits()
+
+    /**
+     * 任意非空值的键：数值按 double 取位模式（与 pandas 一样 1 与 1.0 视为同一个值，
+     * 超过 2^53 的 long 会按 double 精度合并），其他类型为字符串形式的 64 位 FNV-1a 哈希
+     */
+    fun keyOf(value: Any): Long = when (value) {
+        is Number -> doubleKey(value.toDouble())
+        is Boolean -> if (value) 1L else 0L
+        else -> fnv1a(value.toString())
+    }
+
+    /**
+     * 列表的键，null 和 NaN 为 [NativeData.NULL_GROUP_KEY]
+     */
+    fun keysOf(values: List<*>): LongArray = LongArray(values.size) { i ->
+        val value = values[i]
+        if (value == null || (value is Double && value.isNaN()) || (value is Float && value.isNaN())) {
+            NativeData.NULL_GROUP_KEY
+        } else {
+            keyOf(value)
+        }
+    }
+
+    private fun fnv1a(text: String): Long {
+        var hash = 0xcbf29ce484222325UL.toLong()
+        for (c in text) {
+            hash = (hash xor c.code.toLong()) * 0x100000001b3L
+        }
+        return hash
+    }
+}
+
+/**
+ * 可合并的分位数摘要（KLL），与原生层 QuantileSketch 使用同一套算法和打包格式
+ *
+ * 各层压缩器的容量按 2/3 几何递减，第 h 层元素代表 2^h 个原始值，保留的元素约为 3k 个，
+ * 与数据量无关；秩误差约为 1.7 / k。从未压缩过时保存了全部数据，分位数为精确值（线性插值，与 pandas 一致）
+ * NaN 视为缺失值，不计入
+ */
+class QuantileSketch(k: Int = DEFAULT_K) {
+
+    val k: Int = k.coerceAtLeast(MIN_K)
+
+    var count: Long = 0
+        private set
+    private var minValue = Double.POSITIVE_INFINITY
+    private var maxValue = Double.NEGATIVE_INFINITY
+    private var compactions = 0L
+    private var size = 0L
+    private var maxSize = 0L
+    private val levels = mutableListOf<MutableList<Double>>()
+
+    init {
+        grow()
+    }
+
+    val min: Double get() = if (count > 0) minValue else Double.NaN
+
+    val max: Double get() = if (count > 0) maxValue else Double.NaN
+
+    /**
+     * 还保存着全部数据，分位数为精确值
+     */
+    val isExact: Boolean get() = levels.size == 1
+
+    fun add(value: Double): QuantileSketch {
+        if (value.isNaN()) return this
+        if (value < minValue) minValue = value
+        if (value > maxValue) maxValue = value
+        count++
+        levels[0].add(value)
+        if (++size >= maxSize) compress()
+        return this
+    }
+
+    /**
+     * 加入一批值，原生库可用时在原生层构建后合并
+     */
+    fun addAll(values: DoubleArray): QuantileSketch = merge(of(values, k))
+
+    /**
+     * 合并另一部分数据的摘要，other 不变
+     */
+    fun merge(other: QuantileSketch): QuantileSketch {
+        if (other.count == 0L) return this
+        while (levels.size < other.levels.size) grow()
+        for (h in other.levels.indices) levels[h].addAll(other.levels[h])
+        count += other.count
+        compactions += other.compactions
+        if (other.minValue < minValue) minValue = other.minValue
+        if (other.maxValue > maxValue) maxValue = other.maxValue
+        size += other.size
+        while (size >= maxSize) compress()
+        return this
+    }
+
+    /**
+     * q 分位数，q 位于 [0, 1]，没有数据时为 NaN
+     */
+    fun quantile(q: Double): Double {
+        if (count == 0L || q.isNaN()) return Double.NaN
+        val p = q.coerceIn(0.0, 1.0)
+        if (p == 0.0) return minValue
+        if (p == 1.0) return maxValue
+        val rank = p * (count - 1)
+
+        if (isExact) {
+            val sorted = levels[0].sorted()
+            val lo = rank.toInt()
+            val frac = rank - lo
+            if (lo + 1 >= sorted.size || frac == 0.0) return sorted[lo]
+            return sorted[lo] + (sorted[lo + 1] - sorted[lo]) * frac
+        }
+
+        val weighted = ArrayList<Pair<Double, Long>>(size.toInt())
+        for (h in levels.indices) {
+            for (v in levels[h]) weighted.add(v to (1L shl h))
+        }
+        weighted.sortWith(compareBy<Pair<Double, Long>> { it.first }.thenBy { it.second })
+        var cumulative = 0L
+        for ((value, weight) in weighted) {
+            cumulative += weight
+            if (cumulative > rank) return value
+        }
+        return maxValue
+    }
+
+    fun quantiles(qs: List<Double>): List<Double> = qs.map { quantile(it) }
+
+    override fun toString(): String =
+        "QuantileSketch(k=$k, count=$count, retained=$size, median=${quantile(0.5)})"
+
+    private fun capacity(level: Int): Long {
+        val depth = levels.size - level - 1
+        return ceil((2.0 / 3.0).pow(depth) * k).toLong() + 1
+    }
+
+    private fun grow() {
+        levels.add(mutableListOf())
+        maxSize = 0
+        for (h in levels.indices) maxSize += capacity(h)
+    }
+
+    // 与原生层相同：排序后奇数个时最小的留在本层，其余两两一组由压缩次数的哈希决定保留哪一个
+    private fun compress() {
+        var h = 0
+        while (h < levels.size) {
+            if (levels[h].size < capacity(h)) {
+                h++
+                continue
+            }
+            if (h + 1 == levels.size) grow()
+            val level = levels[h]
+            val next = levels[h + 1]
+            level.sort()
+            val start = level.size and 1
+            val coin = (SketchKeys.mix64(compactions++) and 1L).toInt()
+            var i = start
+            while (i + 1 < level.size) {
+                next.add(level[i + coin])
+                i += 2
+            }
+            level.subList(start, level.size).clear()
+            size = levels.sumOf { it.size.toLong() }
+            if (size < maxSize) break
+            h++
+        }
+    }
+
+    companion object {
+        const val DEFAULT_K = 400
+        private const val MIN_K = 8
+
+        /**
+         * describe 默认输出的分位数，与 pandas 一致
+         */
+        val DEFAULT_PERCENTILES = listOf(0.25, 0.5, 0.75)
+
+        private val nativeAvailable: Boolean by lazy {
+            try {
+                NativeData.isAvailable()
+            } catch (e: Throwable) {
+                false
+            }
+        }
+
+        /**
+         * 构建一组值的摘要，原生库可用时并行构建
+         */
+        fun of(values: DoubleArray, k: Int = DEFAULT_K): QuantileSketch {
+            if (nativeAvailable) {
+                return fromPacked(NativeData.quantileSketch(values, k))
+            }
+            val sketch = QuantileSketch(k)
+            values.forEach { sketch.add(it) }
+            return sketch
+        }
+
+        /**
+         * 由原生层的打包结果 [k, count, min, max, compactions, levels, size_0.., items...] 构建
+         */
+        internal fun fromPacked(packed: DoubleArray): QuantileSketch {
+            val sketch = QuantileSketch(packed[0].toInt())
+            val levelCount = packed[5].toInt()
+            while (sketch.levels.size < levelCount) sketch.grow()
+            var offset = 6 + levelCount
+            for (h in 0 until levelCount) {
+                val n = packed[6 + h].toInt()
+                for (i in offset until offset + n) sketch.levels[h].add(packed[i])
+                offset += n
+                sketch.size += n
+            }
+            sketch.count = packed[1].toLong()
+            if (sketch.count > 0) {
+                sketch.minValue = packed[2]
+                sketch.maxValue = packed[3]
+            }
+            sketch.compactions = packed[4].toLong()
+            return sketch
+        }
+
+        /**
+         * 分位数在 describe 结果中的键，如 0.25 -> "25%"，0.025 -> "2.5%"
+         */
+        internal fun percentileLabel(q: Double): String {
+            if (q.isNaN() || q < 0.0 || q > 1.0) {
+                throw IllegalArgumentException("分位数必须在 [0, 1] 之间: $q")
+            }
+            return BigDecimal.valueOf(q).movePointRight(2).stripTrailingZeros().toPlainString() + "%"
+        }
+    }
+}
+
+/**
+ * 可合并的去重计数（HyperLogLog），与原生层 DistinctCounter 使用同一套哈希、寄存器和估计量
+ *
+ * 2^precision 个寄存器，标准误差约 1.04 / sqrt(2^precision)（默认 precision = 14，约 0.8%，占 16KB），
+ * 估计使用 Ertl 的改进估计量；合并为寄存器逐个取最大值
+ * null 和 NaN 不计入
+ */
+class DistinctCountSketch(precision: Int = DEFAULT_PRECISION) {
+
+    val precision: Int = precision.coerceIn(MIN_PRECISION, MAX_PRECISION)
+    private var registers = ByteArray(1 shl this.precision)
+
+    fun add(value: Any?): DistinctCountSketch {
+        if (value == null || (value is Double && value.isNaN()) || (value is Float && value.isNaN())) return this
+        addKey(SketchKeys.keyOf(value))
+        return this
+    }
+
+    /**
+     * 加入一批值，键的计算规则见 [add]；原生库可用时在原生层更新寄存器
+     */
+    fun addAll(values: List<*>): DistinctCountSketch = merge(ofLongs(SketchKeys.keysOf(values), precision))
+
+    internal fun addKey(key: Long) {
+        val hash = SketchKeys.mix64(key)
+        val index = (hash ushr (64 - precision)).toInt()
+        val rest = hash shl precision
+        val rank = if (rest == 0L) 64 - precision + 1 else java.lang.Long.numberOfLeadingZeros(rest) + 1
+        if (rank > registers[index]) registers[index] = rank.toByte()
+    }
+
+    /**
+     * 合并另一部分数据的摘要，两者的 precision 必须相同
+     */
+    fun merge(other: DistinctCountSketch): DistinctCountSketch {
+        if (other.precision != precision) {
+            throw IllegalArgumentException("HyperLogLog 精度不一致: $precision != ${other.precision}")
+        }
+        for (i in registers.indices) {
+            if (other.registers[i] > registers[i]) registers[i] = other.registers[i]
+        }
+        return this
+    }
+
+    /**
+     * 去重个数的估计值
+     */
+    fun estimate(): Double {
+        val q = 64 - precision
+        val histogram = LongArray(q + 2)
+        for (r in registers) histogram[r.toInt()]++
+        val m = registers.size.toDouble()
+        var z = m * tau(1.0 - histogram[q + 1] / m)
+        for (k in q downTo 1) {
+            z += histogram[k]
+            z *= 0.5
+        }
+        z += m * sigma(histogram[0] / m)
+        return m * m / (2.0 * ln(2.0) * z)
+    }
+
+    fun count(): Long = estimate().roundToLong()
+
+    override fun toString(): String = "DistinctCountSketch(precision=$precision, estimate=${count()})"
+
+    companion object {
+        const val DEFAULT_PRECISION = 14
+        private const val MIN_PRECISION = 4
+        private const val MAX_PRECISION = 18
+
+        private val nativeAvailable: Boolean by lazy {
+            try {
+                NativeData.isAvailable()
+            } catch (e: Throwable) {
+                false
+            }
+        }
+
+        /**
+         * double 数组的摘要，NaN 不计入；原生库可用时并行构建
+         */
+        fun ofDoubles(values: DoubleArray, precision: Int = DEFAULT_PRECISION): DistinctCountSketch {
+            val sketch = DistinctCountSketch(precision)
+            if (nativeAvailable) {
+                sketch.registers = NativeData.distinctSketch(values, sketch.precision)
+                return sketch
+            }
+            values.forEach { if (!it.isNaN()) sketch.addKey(SketchKeys.doubleKey(it)) }
+            return sketch
+        }
+
+        /**
+         * 整数键数组的摘要，[NativeData.NULL_GROUP_KEY] 为缺失值
+         */
+        fun ofLongs(values: LongArray, precision: Int = DEFAULT_PRECISION): DistinctCountSketch {
+            val sketch = DistinctCountSketch(precision)
+            if (nativeAvailable) {
+                sketch.registers = NativeData.distinctSketch(values, sketch.precision)
+                return sketch
+            }
+            values.forEach { if (it != NativeData.NULL_GROUP_KEY) sketch.addKey(it) }
+            return sketch
+        }
+
+        // Ertl 估计量中的 σ(x)，对应空寄存器比例
+        private fun sigma(value: Double): Double {
+            if (value == 1.0) return Double.POSITIVE_INFINITY
+            var x = value
+            var y = 1.0
+            var z = x
+            while (true) {
+                x *= x
+                val previous = z
+                z += x * y
+                y += y
+                if (z == previous) return z
+            }
+        }
+
+        // Ertl 估计量中的 τ(x)，对应已饱和寄存器比例
+        private fun tau(value: Double): Double {
+            if (value == 0.0 || value == 1.0) return 0.0
+            var x = value
+            var y = 1.0
+            var z = 1.0 - x
+            while (true) {
+                x = sqrt(x)
+                val previous = z
+                y *= 0.5
+                z -= (1.0 - x) * (1.0 - x) * y
+                if (z == previous) return z / 3.0
+            }
+        }
+    }
+}
+
+/**
+ * 可合并的高频项摘要（Space-Saving），与原生层 HeavyHitters 使用同一套算法
+ *
+ * 最多跟踪 capacity 个值，计数器满时新值替换计数最小的值并继承其计数；
+ * 每项的估计计数满足 count - error <= 真实次数 <= count，且 error <= total / capacity
+ * 合并时一侧缺少的值按该侧的最小计数补足，再保留计数最大的 capacity 个
+ * null 不计入
+ */
+class HeavyHitters<T : Any>(capacity: Int = DEFAULT_CAPACITY) {
+
+    /**
+     * 一个高频项：估计次数 count，误差上界 error
+     */
+    data class Entry<T>(val value: T, val count: Long, val error: Long)
+
+    private class Slot<T>(val value: T, var count: Long, var error: Long)
+
+    val capacity: Int = capacity.coerceAtLeast(1)
+
+    /**
+     * 加入的总次数
+     */
+    var total: Long = 0
+        private set
+    private val heap = ArrayList<Slot<T>>()        // 按 count 的最小堆
+    private val position = HashMap<T, Int>()        // 值 -> 堆中位置
+
+    fun add(value: T?, weight: Long = 1): HeavyHitters<T> {
+        if (value == null || weight <= 0) return this
+        total += weight
+        val i = position[value]
+        if (i != null) {
+            heap[i].count += weight
+            siftDown(i)
+            return this
+        }
+        if (heap.size < capacity) {
+            heap.add(Slot(value, weight, 0))
+            position[value] = heap.size - 1
+            siftUp(heap.size - 1)
+            return this
+        }
+        // 替换计数最小的值，新值继承其计数作为误差上界
+        val root = heap[0]
+        position.remove(root.value)
+        heap[0] = Slot(value, root.count + weight, root.count)
+        position[value] = 0
+        siftDown(0)
+        return this
+    }
+
+    /**
+     * 合并另一部分数据的摘要，other 不变
+     */
+    fun merge(other: HeavyHitters<T>): HeavyHitters<T> {
+        if (other.total == 0L) return this
+        val minSelf = minCount()
+        val minOther = other.minCount()
+        val combined = ArrayList<Slot<T>>(heap.size + other.heap.size)
+        for (slot in heap) {
+            val j = other.position[slot.value]
+            if (j != null) {
+                val o = other.heap[j]
+                combined.add(Slot(slot.value, slot.count + o.count, slot.error + o.error))
+            } else {
+                combined.add(Slot(slot.value, slot.count + minOther, slot.error + minOther))
+            }
+        }
+        for (o in other.heap) {
+            if (!position.containsKey(o.value)) {
+                combined.add(Slot(o.value, o.count + minSelf, o.error + minSelf))
+            }
+        }
+        total += other.total
+        rebuild(combined)
+        return this
+    }
+
+    /**
+     * 估计次数最多的 k 项，按次数降序
+     */
+    fun top(k: Int): List<Entry<T>> =
+        heap.sortedByDescending { it.count }.take(k).map { Entry(it.value, it.count, it.error) }
+
+    override fun toString(): String = "HeavyHitters(capacity=$capacity, total=$total, top=${top(5)})"
+
+    private fun minCount(): Long = if (heap.size < capacity) 0 else heap[0].count
+
+    private fun swap(a: Int, b: Int) {
+        val t = heap[a]
+        heap[a] = heap[b]
+        heap[b] = t
+        position[heap[a].value] = a
+        position[heap[b].value] = b
+    }
+
+    private fun siftUp(start: Int) {
+        var i = start
+        while (i > 0) {
+            val parent = (i - 1) / 2
+            if (heap[parent].count <= heap[i].count) break
+            swap(i, parent)
+            i = parent
+        }
+    }
+
+    private fun siftDown(start: Int) {
+        var i = start
+        while (true) {
+            val left = 2 * i + 1
+            if (left >= heap.size) break
+            var smallest = left
+            if (left + 1 < heap.size && heap[left + 1].count < heap[left].count) smallest = left + 1
+            if (heap[i].count <= heap[smallest].count) break
+            swap(i, smallest)
+            i = smallest
+        }
+    }
+
+    private fun rebuild(slots: List<Slot<T>>) {
+        heap.clear()
+        position.clear()
+        for (slot in slots.sortedByDescending { it.count }.take(capacity)) {
+            heap.add(slot)
+            position[slot.value] = heap.size - 1
+            siftUp(heap.size - 1)
+        }
+    }
+
+    companion object {
+        const val DEFAULT_CAPACITY = 1024
+
+        private val nativeAvailable: Boolean by lazy {
+            try {
+                NativeData.isAvailable()
+            } catch (e: Throwable) {
+                false
+            }
+        }
+
+        /**
+         * double 数组的摘要，NaN 不计入；原生库可用时并行构建
+         */
+        fun ofDoubles(values: DoubleArray, capacity: Int = DEFAULT_CAPACITY): HeavyHitters<Double> =
+            ofDoubles(values, capacity) { it }
+
+        /**
+         * double 数组的摘要，decode 把 double 还原为列的元素类型
+         */
+        internal fun <T : Any> ofDoubles(values: DoubleArray, capacity: Int, decode: (Double) -> T): HeavyHitters<T> {
+            if (nativeAvailable) {
+                return fromPacked(NativeData.heavyHitterSketch(values, capacity)) { decode(Double.fromBits(it)) }
+            }
+            val sketch = HeavyHitters<T>(capacity)
+            values.forEach { if (!it.isNaN()) sketch.add(decode(if (it == 0.0) 0.0 else it)) }
+            return sketch
+        }
+
+        /**
+         * 由原生层的打包结果 [capacity, total, (key, count, error)...] 构建
+         */
+        internal fun <T : Any> fromPacked(packed: LongArray, decode: (Long) -> T): HeavyHitters<T> {
+            val sketch = HeavyHitters<T>(packed[0].toInt())
+            sketch.total = packed[1]
+            val slots = ArrayList<Slot<T>>((packed.size - 2) / 3)
+            var i = 2
+            while (i + 2 < packed.size) {
+                slots.add(Slot(decode(packed[i]), packed[i + 1], packed[i + 2]))
+                i += 3
+            }
+            sketch.rebuild(slots)
+            return sketch
+        }
+    }
+}
+
+/**
+ * describe 的结果：count, mean, std (ddof=1), min, 各分位数, max；没有有效值时除 count 外均为 NaN
+ */
+internal fun describeOf(
+    moments: MomentAccumulator,
+    sketch: QuantileSketch,
+    percentiles: List<Double>
+): Map<String, Double> {
+    val result = linkedMapOf(
+        "count" to moments.count.toDouble(),
+        "mean" to moments.mean,
+        "std" to moments.std(),
+        "min" to moments.min
+    )
+    for (q in percentiles) {
+        result[QuantileSketch.percentileLabel(q)] = sketch.quantile(q)
+    }
+    result["max"] = moments.max
+    return result
+}
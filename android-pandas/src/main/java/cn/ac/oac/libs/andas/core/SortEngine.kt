@@ -0,0 +1,182 @@
+package cn.ac.oac.libs.andas.core
+
+import cn.ac.oac.libs.andas.entity.DictionaryColumn
+import cn.ac.oac.libs.andas.entity.DoubleColumn
+import cn.ac.oac.libs.andas.entity.IntColumn
+import cn.ac.oac.libs.andas.entity.LongColumn
+
+/**
+ * 排序键
+ *
+ * @property values DoubleArray（NaN 为缺失值）或 LongArray（[NativeData.NULL_GROUP_KEY] 为缺失值）
+ * @property descending 是否降序
+ * @property nullsFirst 缺失值是否排在最前，与升降序无关
+ */
+class SortKey(
+    val values: Any,
+    val descending: Boolean = false,
+    val nullsFirst: Boolean = false
+) {
+    init {
+        if (values !is DoubleArray && values !is LongArray) {
+            throw IllegalArgumentException("排序键必须是 DoubleArray 或 LongArray")
+        }
+    }
+
+    val size: Int get() = if (values is DoubleArray) values.size else (values as LongArray).size
+
+    internal fun isNull(row: Int): Boolean {
+        return if (values is DoubleArray) values[row].isNaN() else (values as LongArray)[row] == NativeData.NULL_GROUP_KEY
+    }
+
+    /**
+     * 两行在该键上的先后（不含缺失值），-0.0 与 0.0 相等
+     */
+    internal fun compareValues(a: Int, b: Int): Int {
+        val result = if (values is DoubleArray) {
+            val x = values[a]
+            val y = values[b]
+            if (x < y) -1 else if (x > y) 1 else 0
+        } else {
+            (values as LongArray)[a].compareTo(values[b])
+        }
+        return if (descending) -result else result
+    }
+}
+
+/**
+ * 排序键编码：整数和布尔列为 LongArray，其他数值列为 DoubleArray；
+ * 其余类型按排序后的字典编码为 LongArray，编码的大小顺序与值一致；
+ * 字典编码列只排序字典，每行的编码是编号在排序后字典中的位置
+ */
+internal object SortKeyEncoding {
+
+    /**
+     * 编码结果；字典编码时 dictionary 为排序后的不同值，序号即编码，comparator 为字典的排序规则
+     */
+    class Encoded(
+        val values: Any,
+        val dictionary: List<Any>? = null,
+        val lookup: Map<Any, Long>? = null,
+        val comparator: Comparator<Any>? = null
+    )
+
+    private val STRING_ORDER = Comparator<Any> { a, b -> (a as String).compareTo(b as String) }
+
+    fun encode(values: List<Any?>): Any = encodeWithDictionary(values).values
+
+    fun encodeWithDictionary(values: List<Any?>): Encoded {
+        when (values) {
+            is DoubleColumn -> return Encoded(values.doublesOrNaN())
+            is IntColumn -> return Encoded(values.longsOr(NativeData.NULL_GROUP_KEY))
+            is DictionaryColumn -> {
+                val sorted = values.dictionary.sorted()
+                val ranks = LongArray(values.size) { i ->
+                    val code = values.codeAt(i)
+                    if (code >= 0) sorted.ranks[code].toLong() else NativeData.NULL_GROUP_KEY
+                }
+                return Encoded(ranks, sorted.values, sorted.lookup, STRING_ORDER)
+            }
+            is LongColumn -> {
+                // Long.MIN_VALUE 与缺失值编码冲突，出现时改用字典编码
+                val longs = values.longsOr(NativeData.NULL_GROUP_KEY)
+                if ((0 until values.size).none { longs[it] == NativeData.NULL_GROUP_KEY && values.isValid(it) }) {
+                    return Encoded(longs)
+                }
+            }
+        }
+
+        val nonNull = values.filterNotNull()
+        val integral = nonNull.all { it is Int || it is Long || it is Short || it is Byte }
+        if (integral && nonNull.none { it == NativeData.NULL_GROUP_KEY }) {
+            return Encoded(LongArray(values.size) { i -> (values[i] as Number?)?.toLong() ?: NativeData.NULL_GROUP_KEY })
+        }
+        if (!integral && nonNull.all { it is Number }) {
+            return Encoded(DoubleArray(values.size) { i -> (values[i] as Number?)?.toDouble() ?: Double.NaN })
+        }
+        if (nonNull.all { it is Boolean }) {
+            return Encoded(LongArray(values.size) { i ->
+                when (values[i]) {
+                    null -> NativeData.NULL_GROUP_KEY
+                    true -> 1L
+                    else -> 0L
+                }
+            })
+        }
+
+        val distinct = nonNull.distinct()
+        val sameType = distinct.all { it is Comparable<*> } && distinct.map { it::class }.toSet().size == 1
+        @Suppress("UNCHECKED_CAST")
+        val comparator: Comparator<Any> = when {
+            integral -> compareBy { (it as Number).toLong() }
+            sameType -> Comparator { a, b -> (a as Comparable<Any>).compareTo(b) }
+            else -> compareBy { it.toString() }
+        }
+        val dictionary = distinct.sortedWith(comparator)
+        val lookup = HashMap<Any, Long>(dictionary.size * 2)
+        dictionary.forEachIndexed { i, value -> lookup[value] = i.toLong() }
+        val codes = LongArray(values.size) { i -> values[i]?.let { lookup[it]!! } ?: NativeData.NULL_GROUP_KEY }
+        return Encoded(codes, dictionary, lookup, comparator)
+    }
+}
+
+/**
+ * 排序入口：优先使用原生基数排序，原生库不可用时退化为 Kotlin 稳定排序，两者结果一致
+ */
+internal object SortEngine {
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeData.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    /**
+     * 多列稳定排序，返回排序后的行号
+     */
+    fun sortIndices(keys: List<SortKey>): IntArray {
+        if (keys.isEmpty()) throw IllegalArgumentException("至少需要一个排序键列")
+        val rowCount = keys[0].size
+        if (keys.any { it.size != rowCount }) {
+            throw IllegalArgumentException("排序键列长度不一致")
+        }
+        if (nativeAvailable) {
+            return NativeData.sortIndices(keys)
+        }
+        val comparator = Comparator<Int> { a, b ->
+            for (key in keys) {
+                val c = compareRows(key, a, b)
+                if (c != 0) return@Comparator c
+            }
+            0
+        }
+        return (0 until rowCount).sortedWith(comparator).toIntArray()
+    }
+
+    /**
+     * 最大（largest）或最小的 k 个非缺失值的行号，按排序后的顺序，相等时行号小的在前
+     */
+    fun topK(values: Any, k: Int, largest: Boolean): IntArray {
+        if (nativeAvailable) {
+            return NativeData.topK(values, k, largest)
+        }
+        val key = SortKey(values, largest, false)
+        return (0 until key.size)
+            .filter { !key.isNull(it) }
+            .sortedWith { a, b -> key.compareValues(a, b) }
+            .take(maxOf(k, 0))
+            .toIntArray()
+    }
+
+    private fun compareRows(key: SortKey, a: Int, b: Int): Int {
+        val nullA = key.isNull(a)
+        val nullB = key.isNull(b)
+        if (nullA || nullB) {
+            if (nullA && nullB) return 0
+            return if (nullA == key.nullsFirst) -1 else 1
+        }
+        return key.compareValues(a, b)
+    }
+}
@@ -0,0 +1,763 @@
+package cn.ac.oac.libs.andas.core
+
+import java.io.BufferedInputStream
+import java.io.BufferedOutputStream
+import java.io.ByteArrayInputStream
+import java.io.ByteArrayOutputStream
+import java.io.Closeable
+import java.io.DataInputStream
+import java.io.DataOutputStream
+import java.io.EOFException
+import java.io.File
+import java.io.FileInputStream
+import java.io.FileOutputStream
+import java.util.PriorityQueue
+
+/**
+ * 一批变长记录：第 i 条的内容为 bytes[offsets[i], offsets[i + 1])
+ */
+internal class RecordChunk(val bytes: ByteArray, val offsets: IntArray) {
+
+    val size: Int get() = offsets.size - 1
+
+    fun record(i: Int): ByteArray = bytes.copyOfRange(offsets[i], offsets[i + 1])
+
+    fun input(i: Int): DataInputStream = DataInputStream(ByteArrayInputStream(bytes, offsets[i], offsets[i + 1] - offsets[i]))
+}
+
+/**
+ * 逐条拼装 [RecordChunk]：向 [out] 写完一条记录的内容后调用 [endRecord]
+ */
+internal class RecordBuilder {
+
+    private val buffer = ByteArrayOutputStream()
+    val out = DataOutputStream(buffer)
+    private var offsets = IntArray(64)
+    private var count = 0
+
+    val size: Int get() = count
+
+    fun endRecord() {
+        if (count + 1 == offsets.size) offsets = offsets.copyOf(offsets.size * 2)
+        offsets[++count] = buffer.size()
+    }
+
+    fun add(record: ByteArray) {
+        out.write(record)
+        endRecord()
+    }
+
+    fun build(): RecordChunk = RecordChunk(buffer.toByteArray(), offsets.copyOf(count + 1))
+}
+
+/**
+ * 单元格值的二进制编码：一个类型标记加值本身，解码后类型不变（Int 仍是 Int）
+ * 两个值的编码相同当且仅当 equals 相等（Double 使用 doubleToLongBits，NaN 只有一种编码）
+ */
+internal object ValueCodec {
+
+    private const val NULL = 0
+    private const val INT = 1
+    private const val LONG = 2
+    private const val DOUBLE = 3
+    private const val FLOAT = 4
+    private const val BOOLEAN = 5
+    private const val STRING = 6
+
+    fun write(out: DataOutputStream, value: Any?) {
+        when (value) {
+            null -> out.writeByte(NULL)
+            is Int -> {
+                out.writeByte(INT)
+                out.writeInt(value)
+            }
+            is Long -> {
+                out.writeByte(LONG)
+                out.writeLong(value)
+            }
+            is Double -> {
+                out.writeByte(DOUBLE)
+                out.writeLong(java.lang.Double.doubleToLongBits(value))
+            }
+            is Float -> {
+                out.writeByte(FLOAT)
+                out.writeInt(java.lang.Float.floatToIntBits(value))
+            }
+            is Boolean -> {
+                out.writeByte(BOOLEAN)
+                out.writeBoolean(value)
+            }
+            is String -> {
+                // writeUTF 限制 64KB，这里用 int 长度
+                val bytes = value.toByteArray(Charsets.UTF_8)
+                out.writeByte(STRING)
+                out.writeInt(bytes.size)
+                out.write(bytes)
+            }
+            else -> throw IllegalArgumentException("不支持溢写的值类型: ${value::class.simpleName}")
+        }
+    }
+
+    fun read(input: DataInputStream): Any? {
+        return when (val tag = input.readUnsignedByte()) {
+            NULL -> null
+            INT -> input.readInt()
+            LONG -> input.readLong()
+            DOUBLE -> java.lang.Double.longBitsToDouble(input.readLong())
+            FLOAT -> java.lang.Float.intBitsToFloat(input.readInt())
+            BOOLEAN -> input.readBoolean()
+            STRING -> {
+                val bytes = ByteArray(input.readInt())
+                input.readFully(bytes)
+                String(bytes, Charsets.UTF_8)
+            }
+            else -> throw IllegalStateException("溢写数据已损坏: 未知的类型标记 $tag")
+        }
+    }
+}
+
+/**
+ * 一批分组的聚合结果，分组 g 的键为 keys 的第 g 条记录
+ *
+ * @property rows 行数
+ * @property counts 非缺失值个数
+ * @property mins 没有非缺失值时为 NaN
+ */
+internal class SpillGroups(
+    val keys: RecordChunk,
+    val rows: LongArray,
+    val counts: LongArray,
+    val sums: DoubleArray,
+    val mins: DoubleArray,
+    val maxs: DoubleArray
+) {
+    val size: Int get() = rows.size
+}
+
+/**
+ * 外存排序与溢写分组的入口：数据超过内存预算时写到临时文件，内存占用与数据量无关
+ * 优先使用原生实现，原生库不可用时退化为 Kotlin 实现，两者的文件格式不同但结果一致
+ */
+object SpillEngine {
+
+    /**
+     * 每个排序或分组默认的内存预算（字节），[cn.ac.oac.libs.andas.Andas.init] 时按配置设置
+     */
+    @Volatile
+    var memoryBudget: Long = 64L shl 20
+
+    /**
+     * 临时文件目录，null 表示系统临时目录；[cn.ac.oac.libs.andas.Andas.init] 后为应用缓存目录下的 spill 子目录
+     */
+    @Volatile
+    var directory: File? = null
+
+    private val nativeAvailable: Boolean by lazy {
+        try {
+            NativeData.isAvailable()
+        } catch (e: Throwable) {
+            false
+        }
+    }
+
+    /**
+     * 打开外存排序，用完须关闭
+     */
+    internal fun openSorter(descending: Boolean, memoryBudget: Long = this.memoryBudget): ExternalSorter {
+        checkBudget(memoryBudget)
+        val dir = spillDirectory()
+        return if (nativeAvailable) {
+            NativeExternalSorter(dir, memoryBudget, descending)
+        } else {
+            KotlinExternalSorter(dir, memoryBudget, descending)
+        }
+    }
+
+    /**
+     * 打开溢写分组聚合，用完须关闭
+     */
+    internal fun openAggregator(memoryBudget: Long = this.memoryBudget): SpillAggregator {
+        checkBudget(memoryBudget)
+        val dir = spillDirectory()
+        return if (nativeAvailable) NativeSpillAggregator(dir, memoryBudget) else KotlinSpillAggregator(dir, memoryBudget)
+    }
+
+    private fun checkBudget(memoryBudget: Long) {
+        if (memoryBudget <= 0) throw IllegalArgumentException("内存预算必须大于0: $memoryBudget")
+    }
+
+    private fun spillDirectory(): File {
+        val dir = directory ?: File(System.getProperty("java.io.tmpdir"))
+        if (!dir.isDirectory && !dir.mkdirs()) {
+            throw IllegalStateException("无法创建临时文件目录: ${dir.absolutePath}")
+        }
+        return dir
+    }
+}
+
+/**
+ * 外存排序：记录为排序键（NaN 为缺失值，无论升降序都排在最后）加任意字节内容，排序稳定
+ */
+internal abstract class ExternalSorter : Closeable {
+
+    /**
+     * 追加一批记录，第 i 条的排序键为 keys[i]
+     */
+    fun add(keys: DoubleArray, records: RecordChunk) {
+        if (keys.size != records.size) {
+            throw IllegalArgumentException("排序键与记录条数不一致: ${keys.size} != ${records.size}")
+        }
+        if (keys.isNotEmpty()) addChecked(keys, records)
+    }
+
+    protected abstract fun addChecked(keys: DoubleArray, records: RecordChunk)
+
+    /**
+     * 结束输入，之后只能调用 [next]
+     */
+    abstract fun finish()
+
+    /**
+     * 按排序后的顺序取出记录，直到内容累计达到 maxBytes（至少一条），null 表示已全部取出
+     */
+    abstract fun next(maxBytes: Int = 1 shl 20): RecordChunk?
+
+    /**
+     * 写到临时文件的字节数，0 表示全部在内存中完成
+     */
+    abstract val spilledBytes: Long
+}
+
+/**
+ * 溢写分组聚合：键为任意字节串（按字节比较），每组计算行数、非缺失值个数、和、最小值和最大值
+ */
+internal abstract class SpillAggregator : Closeable {
+
+    /**
+     * 追加一批行，第 i 行的分组键为 keys 的第 i 条记录；values 为 null 时只计行数，NaN 为缺失值
+     */
+    fun add(keys: RecordChunk, values: DoubleArray?) {
+        if (values != null && values.size != keys.size) {
+            throw IllegalArgumentException("分组键与值的行数不一致: ${keys.size} != ${values.size}")
+        }
+        if (keys.size > 0) addChecked(keys, values)
+    }
+
+    protected abstract fun addChecked(keys: RecordChunk, values: DoubleArray?)
+
+    /**
+     * 结束输入，之后只能调用 [next]
+     */
+    abstract fun finish()
+
+    /**
+     * 取出下一批分组（一个分区）的结果，null 表示已全部取出；每个分组只出现一次
+     * 没有溢写时只有一批，分组按首次出现的顺序
+     */
+    abstract fun next(): SpillGroups?
+
+    abstract val spilledBytes: Long
+}
+
+private class NativeExternalSorter(directory: File, memoryBudget: Long, descending: Boolean) : ExternalSorter() {
+
+    private var handle: Long = NativeData.externalSortCreate(directory.absolutePath, memoryBudget, descending)
+
+    override val spilledBytes: Long get() = NativeData.externalSortSpilledBytes(checkOpen())
+
+    override fun addChecked(keys: DoubleArray, records: RecordChunk) {
+        NativeData.externalSortAdd(checkOpen(), keys, records.bytes, records.offsets)
+    }
+
+    override fun finish() = NativeData.externalSortFinish(checkOpen())
+
+    override fun next(maxBytes: Int): RecordChunk? {
+        val raw = NativeData.externalSortNext(checkOpen(), maxBytes) ?: return null
+        return RecordChunk(raw[0] as ByteArray, raw[1] as IntArray)
+    }
+
+    private fun checkOpen(): Long {
+        check(handle != 0L) { "外存排序已关闭" }
+        return handle
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            NativeData.externalSortRelease(handle)
+            handle = 0L
+        }
+    }
+}
+
+private class NativeSpillAggregator(directory: File, memoryBudget: Long) : SpillAggregator() {
+
+    private var handle: Long = NativeData.spillAggregateCreate(directory.absolutePath, memoryBudget)
+
+    override val spilledBytes: Long get() = NativeData.spillAggregateSpilledBytes(checkOpen())
+
+    override fun addChecked(keys: RecordChunk, values: DoubleArray?) {
+        NativeData.spillAggregateAdd(checkOpen(), keys.bytes, keys.offsets, values)
+    }
+
+    override fun finish() = NativeData.spillAggregateFinish(checkOpen())
+
+    override fun next(): SpillGroups? {
+        val raw = NativeData.spillAggregateNext(checkOpen()) ?: return null
+        return SpillGroups(
+            keys = RecordChunk(raw[0] as ByteArray, raw[1] as IntArray),
+            rows = raw[2] as LongArray,
+            counts = raw[3] as LongArray,
+            sums = raw[4] as DoubleArray,
+            mins = raw[5] as DoubleArray,
+            maxs = raw[6] as DoubleArray
+        )
+    }
+
+    private fun checkOpen(): Long {
+        check(handle != 0L) { "溢写分组已关闭" }
+        return handle
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            NativeData.spillAggregateRelease(handle)
+            handle = 0L
+        }
+    }
+}
+
+// Kotlin 实现的临时文件缓冲大小；每条记录在内存中的估计额外开销（数组对象头、引用等）
+private const val SPILL_BUFFER = 256 shl 10
+private const val RECORD_OVERHEAD = 48L
+
+private fun newSpillFile(directory: File): File = File.createTempFile("andas-spill-", ".tmp", directory)
+
+private fun spillOutput(file: File): DataOutputStream =
+    DataOutputStream(BufferedOutputStream(FileOutputStream(file), SPILL_BUFFER))
+
+private fun spillInput(file: File): DataInputStream =
+    DataInputStream(BufferedInputStream(FileInputStream(file), SPILL_BUFFER))
+
+/**
+ * 排序键转为按无符号整数比较的编码，与原生层 encodeSortKey 一致：NaN 无论升降序都最大，-0.0 与 0.0 相等
+ */
+private fun sortCode(value: Double, descending: Boolean): Long {
+    if (value.isNaN()) return -1L
+    val bits = java.lang.Double.doubleToRawLongBits(if (value == 0.0) 0.0 else value)
+    val code = if (bits < 0) bits.inv() else bits or Long.MIN_VALUE
+    return if (descending) code.inv() else code
+}
+
+private class KotlinExternalSorter(
+    private val directory: File,
+    private val budget: Long,
+    private val descending: Boolean
+) : ExternalSorter() {
+
+    // 内存中还没有写出的记录
+    private var codes = LongArray(1024)
+    private val records = ArrayList<ByteArray>()
+    private var bufferedBytes = 0L
+
+    private val runs = ArrayList<File>()
+    private var finished = false
+    private var order: IntArray? = null
+    private var emitted = 0
+    private var merger: RunMerger? = null
+
+    override var spilledBytes = 0L
+        private set
+
+    override fun addChecked(keys: DoubleArray, records: RecordChunk) {
+        check(!finished) { "外存排序的输入已结束" }
+        for (i in keys.indices) {
+            if (this.records.size == codes.size) codes = codes.copyOf(codes.size * 2)
+            codes[this.records.size] = sortCode(keys[i], descending)
+            val record = records.record(i)
+            this.records.add(record)
+            bufferedBytes += record.size + RECORD_OVERHEAD
+            if (bufferedBytes >= budget) spillBuffer()
+        }
+    }
+
+    // sortedWith 是稳定排序
+    private fun sortedOrder(): IntArray =
+        records.indices.sortedWith { a, b -> java.lang.Long.compareUnsigned(codes[a], codes[b]) }.toIntArray()
+
+    private fun spillBuffer() {
+        if (records.isEmpty()) return
+        val sorted = sortedOrder()
+        val file = newSpillFile(directory)
+        runs.add(file)
+        spillOutput(file).use { out ->
+            for (r in sorted) {
+                out.writeLong(codes[r])
+                out.writeInt(records[r].size)
+                out.write(records[r])
+            }
+        }
+        spilledBytes += file.length()
+        records.clear()
+        bufferedBytes = 0
+    }
+
+    override fun finish() {
+        if (finished) return
+        finished = true
+        if (runs.isEmpty()) {
+            order = sortedOrder()
+            return
+        }
+        spillBuffer()
+        codes = LongArray(0)
+        // 每路至少 SPILL_BUFFER 的读缓冲，段数超过归并路数时先逐层归并相邻的段
+        val fanIn = maxOf(2L, minOf(budget / SPILL_BUFFER, 1024L)).toInt()
+        while (runs.size > fanIn) {
+            val merged = ArrayList<File>()
+            for (begin in runs.indices step fanIn) {
+                val group = runs.subList(begin, minOf(begin + fanIn, runs.size))
+                merged.add(if (group.size == 1) group[0] else mergeRuns(group))
+            }
+            runs.clear()
+            runs.addAll(merged)
+        }
+        merger = RunMerger(runs)
+    }
+
+    private fun mergeRuns(group: List<File>): File {
+        val file = newSpillFile(directory)
+        RunMerger(group).use { source ->
+            spillOutput(file).use { out ->
+                while (source.advance()) {
+                    out.writeLong(source.code)
+                    out.writeInt(source.record.size)
+                    out.write(source.record)
+                }
+            }
+        }
+        group.forEach { it.delete() }
+        spilledBytes += file.length()
+        return file
+    }
+
+    override fun next(maxBytes: Int): RecordChunk? {
+        check(finished) { "外存排序的输入还没有结束" }
+        val builder = RecordBuilder()
+        var bytes = 0L
+        while (builder.size == 0 || bytes < maxBytes) {
+            val record = nextRecord() ?: break
+            builder.add(record)
+            bytes += record.size
+        }
+        return if (builder.size == 0) null else builder.build()
+    }
+
+    private fun nextRecord(): ByteArray? {
+        val sorted = order
+        if (sorted != null) {
+            if (emitted == sorted.size) return null
+            return records[sorted[emitted++]]
+        }
+        val source = merger ?: return null
+        return if (source.advance()) source.record else null
+    }
+
+    override fun close() {
+        merger?.close()
+        merger = null
+        runs.forEach { it.delete() }
+        runs.clear()
+        records.clear()
+    }
+}
+
+/**
+ * 有序段的多路归并，编码相同时段号小的在前，保持排序稳定
+ */
+private class RunMerger(runs: List<File>) : Closeable {
+
+    private class Cursor(val run: Int, file: File) {
+        val input = spillInput(file)
+        var code = 0L
+        var record = ByteArray(0)
+
+        fun advance(): Boolean {
+            code = try {
+                input.readLong()
+            } catch (e: EOFException) {
+                return false
+            }
+            record = ByteArray(input.readInt())
+            input.readFully(record)
+            return true
+        }
+    }
+
+    private val cursors = ArrayList<Cursor>()
+    private val heap = PriorityQueue<Cursor>(maxOf(1, runs.size)) { a, b ->
+        val c = java.lang.Long.compareUnsigned(a.code, b.code)
+        if (c != 0) c else a.run.compareTo(b.run)
+    }
+
+    var code = 0L
+        private set
+    var record = ByteArray(0)
+        private set
+
+    init {
+        try {
+            for ((i, file) in runs.withIndex()) {
+                val cursor = Cursor(i, file)
+                cursors.add(cursor)
+                if (cursor.advance()) heap.add(cursor)
+            }
+        } catch (e: Throwable) {
+            close()
+            throw e
+        }
+    }
+
+    /**
+     * 移到下一条记录，结果在 [code] 和 [record] 中，false 表示已归并完
+     */
+    fun advance(): Boolean {
+        val cursor = heap.poll() ?: return false
+        code = cursor.code
+        record = cursor.record
+        if (cursor.advance()) heap.add(cursor)
+        return true
+    }
+
+    override fun close() {
+        cursors.forEach { it.input.close() }
+        cursors.clear()
+        heap.clear()
+    }
+}
+
+private class KotlinSpillAggregator(private val directory: File, private val budget: Long) : SpillAggregator() {
+
+    private class Key(val bytes: ByteArray, val hash: Long) {
+        override fun equals(other: Any?): Boolean = other is Key && hash == other.hash && bytes.contentEquals(other.bytes)
+        override fun hashCode(): Int = (hash xor (hash ushr 32)).toInt()
+    }
+
+    private class Group {
+        var rows = 0L
+        var count = 0L
+        var sum = 0.0
+        var min = Double.POSITIVE_INFINITY
+        var max = Double.NEGATIVE_INFINITY
+    }
+
+    // 一组分区文件，第 level 层按哈希从高位数起的第 level 个 4 位分区
+    private inner class Partitions(val level: Int) : Closeable {
+        val files = ArrayList<File>()
+        private val outputs = ArrayList<DataOutputStream>()
+
+        init {
+            try {
+                repeat(PARTITIONS) {
+                    val file = newSpillFile(directory)
+                    files.add(file)
+                    outputs.add(spillOutput(file))
+                }
+            } catch (e: Throwable) {
+                close()
+                files.forEach { it.delete() }
+                throw e
+            }
+        }
+
+        fun output(hash: Long): DataOutputStream = outputs[((hash ushr (60 - PARTITION_BITS * level)) and 15L).toInt()]
+
+        override fun close() {
+            outputs.forEach { it.close() }
+            outputs.clear()
+        }
+    }
+
+    private class Pending(val file: File, val level: Int)
+
+    // LinkedHashMap 保持首次出现的顺序
+    private val table = LinkedHashMap<Key, Group>()
+    private var tableBytes = 0L
+    private var finished = false
+    private var emitted = false
+    private var partitions: Partitions? = null
+    private val pending = ArrayList<Pending>()
+
+    override var spilledBytes = 0L
+        private set
+
+    override fun addChecked(keys: RecordChunk, values: DoubleArray?) {
+        check(!finished) { "溢写分组的输入已结束" }
+        for (i in 0 until keys.size) {
+            val bytes = keys.record(i)
+            val group = upsert(Key(bytes, hashOf(bytes)))
+            group.rows++
+            if (values != null) {
+                val value = values[i]
+                if (!value.isNaN()) {
+                    group.count++
+                    group.sum += value
+                    if (value < group.min) group.min = value
+                    if (value > group.max) group.max = value
+                }
+            }
+            if (tableBytes > budget) {
+                val level0 = partitions ?: Partitions(0).also { partitions = it }
+                spillTable(level0)
+            }
+        }
+    }
+
+    private fun upsert(key: Key): Group {
+        return table.getOrPut(key) {
+            tableBytes += key.bytes.size + GROUP_OVERHEAD
+            Group()
+        }
+    }
+
+    private fun spillTable(target: Partitions) {
+        for ((key, group) in table) {
+            val out = target.output(key.hash)
+            out.writeLong(key.hash)
+            out.writeInt(key.bytes.size)
+            out.write(key.bytes)
+            out.writeLong(group.rows)
+            out.writeLong(group.count)
+            out.writeDouble(group.sum)
+            out.writeDouble(group.min)
+            out.writeDouble(group.max)
+        }
+        table.clear()
+        tableBytes = 0
+    }
+
+    // 关闭一组分区文件，非空的按分区顺序入栈（栈顶为第 0 个分区）
+    private fun pushPartitions(done: Partitions) {
+        done.close()
+        for (file in done.files.asReversed()) {
+            if (file.length() == 0L) {
+                file.delete()
+            } else {
+                spilledBytes += file.length()
+                pending.add(Pending(file, done.level))
+            }
+        }
+    }
+
+    override fun finish() {
+        if (finished) return
+        finished = true
+        val level0 = partitions ?: return
+        spillTable(level0)
+        partitions = null
+        pushPartitions(level0)
+    }
+
+    override fun next(): SpillGroups? {
+        check(finished) { "溢写分组的输入还没有结束" }
+        if (spilledBytes == 0L) {
+            if (emitted) return null
+            emitted = true
+            return drainTable()
+        }
+        while (pending.isNotEmpty()) {
+            val partition = pending.removeAt(pending.size - 1)
+            val canSplit = partition.level + 1 < MAX_LEVELS
+            var children: Partitions? = null
+            val input = spillInput(partition.file)
+            try {
+                var more = true
+                while (more) {
+                    val hash = try {
+                        input.readLong()
+                    } catch (e: EOFException) {
+                        more = false
+                        continue
+                    }
+                    val bytes = ByteArray(input.readInt())
+                    input.readFully(bytes)
+                    val group = upsert(Key(bytes, hash))
+                    group.rows += input.readLong()
+                    group.count += input.readLong()
+                    group.sum += input.readDouble()
+                    group.min = minOf(group.min, input.readDouble())
+                    group.max = maxOf(group.max, input.readDouble())
+                    // 一个分区仍然放不下：用哈希的下 4 位再分区
+                    if (canSplit && tableBytes > budget) {
+                        val split = children ?: Partitions(partition.level + 1).also { children = it }
+                        spillTable(split)
+                    }
+                }
+            } finally {
+                input.close()
+                partition.file.delete()
+            }
+            val split = children
+            if (split == null) {
+                if (table.isNotEmpty()) return drainTable()
+            } else {
+                spillTable(split)
+                pushPartitions(split)
+            }
+        }
+        return null
+    }
+
+    private fun drainTable(): SpillGroups? {
+        if (table.isEmpty()) return null
+        val n = table.size
+        val keys = RecordBuilder()
+        val rows = LongArray(n)
+        val counts = LongArray(n)
+        val sums = DoubleArray(n)
+        val mins = DoubleArray(n)
+        val maxs = DoubleArray(n)
+        var g = 0
+        for ((key, group) in table) {
+            keys.add(key.bytes)
+            rows[g] = group.rows
+            counts[g] = group.count
+            sums[g] = group.sum
+            mins[g] = if (group.count > 0) group.min else Double.NaN
+            maxs[g] = if (group.count > 0) group.max else Double.NaN
+            g++
+        }
+        table.clear()
+        tableBytes = 0
+        return SpillGroups(keys.build(), rows, counts, sums, mins, maxs)
+    }
+
+    override fun close() {
+        partitions?.let {
+            it.close()
+            it.files.forEach { file -> file.delete() }
+        }
+        partitions = null
+        pending.forEach { it.file.delete() }
+        pending.clear()
+        table.clear()
+    }
+
+    private companion object {
+        const val PARTITION_BITS = 4
+        const val PARTITIONS = 1 shl PARTITION_BITS
+        const val MAX_LEVELS = 16
+        // 每个分组在 LinkedHashMap 中的估计开销（条目、键对象、聚合状态）
+        const val GROUP_OVERHEAD = 160L
+
+        // FNV-1a 加 64 位末尾混合，使分区用到的高位分布均匀
+        fun hashOf(bytes: ByteArray): Long {
+            var h = -0x340d631b7bdddcdbL
+            for (b in bytes) h = (h xor (b.toLong() and 0xffL)) * 0x100000001b3L
+            h = h xor (h ushr 33)
+            h *= -0xae502812aa7333L
+            h = h xor (h ushr 33)
+            h *= -0x3b314601e57a13adL
+            return h xor (h ushr 33)
+        }
+    }
+}
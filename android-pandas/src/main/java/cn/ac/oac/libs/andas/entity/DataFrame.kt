@@ -5,8 +5,41 @@ import cn.ac.oac.libs.andas.types.AndaTypes
 import cn.ac.oac.libs.andas.core.NativeMath
 import cn.ac.oac.libs.andas.core.NativeData
 import cn.ac.oac.libs.andas.core.NativeBatch
+import cn.ac.oac.libs.andas.core.AggOp
+import cn.ac.oac.libs.andas.core.GroupByEngine
+import cn.ac.oac.libs.andas.core.GroupByResult
+import cn.ac.oac.libs.andas.core.GroupKeyEncoding
+import cn.ac.oac.libs.andas.core.GroupValueEncoding
+import cn.ac.oac.libs.andas.core.JoinEngine
+import cn.ac.oac.libs.andas.core.JoinKeyEncoding
+import cn.ac.oac.libs.andas.core.JoinType
+import cn.ac.oac.libs.andas.core.FilterEngine
+import cn.ac.oac.libs.andas.core.Predicate
+import cn.ac.oac.libs.andas.core.col
+import cn.ac.oac.libs.andas.core.SortEngine
+import cn.ac.oac.libs.andas.core.MomentAccumulator
+import cn.ac.oac.libs.andas.core.MomentOrder
+import cn.ac.oac.libs.andas.core.QuantileSketch
+import cn.ac.oac.libs.andas.core.DistinctCountSketch
+import cn.ac.oac.libs.andas.core.describeOf
+import cn.ac.oac.libs.andas.core.RollingOp
+import cn.ac.oac.libs.andas.core.SamplingEngine
+import cn.ac.oac.libs.andas.core.WindowSpec
+import cn.ac.oac.libs.andas.core.SortKey
+import cn.ac.oac.libs.andas.core.SortKeyEncoding
+import cn.ac.oac.libs.andas.core.CsvReader
+import cn.ac.oac.libs.andas.core.CorrMethod
+import cn.ac.oac.libs.andas.core.CorrelationEngine
+import cn.ac.oac.libs.andas.core.ColumnarFile
+import cn.ac.oac.libs.andas.core.ColumnarType
+import cn.ac.oac.libs.andas.core.ColumnarWriter
+import cn.ac.oac.libs.andas.core.ExprParser
+import cn.ac.oac.libs.andas.core.DedupEngine
+import cn.ac.oac.libs.andas.core.DedupKeyEncoding
+import cn.ac.oac.libs.andas.core.DuplicateKeep
 import java.io.File
 import java.io.FileWriter
+import java.io.IOException
 import java.io.BufferedReader
 import java.io.InputStreamReader
 import kotlin.collections.sorted
@@ -15,7 +48,7 @@ import kotlin.collections.sorted
  * DataFrame 类似于二维表格，是Andas库的核心数据结构
  * 提供类似pandas.DataFrame的数据操作接口
  * 
- * index 通过 data 中的 Series 获取，不单独存储
+ * index 通过 data 中的 Series 获取，不单独存储；各列共享同一个 [Index]
  */
 class DataFrame {
     private val data: MutableMap<String, Series<Any>> = mutableMapOf()
@@ -34,11 +67,8 @@ class DataFrame {
         // 找到最长列的长度作为索引长度
         val maxSize = columnsData.values.maxOfOrNull { it.size } ?: 0
         
-        // 创建默认索引 (0 until maxSize)
-        val defaultIndex = (0 until maxSize).toList()
-        
-        // 验证索引类型
-        validateIndexType(defaultIndex)
+        // 创建默认索引 (0 until maxSize)，不存储标签
+        val defaultIndex = Index.range(maxSize)
         
         columnsData.forEach { (colName, colData) ->
             // 如果列长度不足，用null填充
@@ -68,10 +98,7 @@ class DataFrame {
         this.columns = allColumns.toList()
         
         // 创建默认索引
-        val defaultIndex = rowsData.indices.map { it }
-        
-        // 验证索引类型
-        validateIndexType(defaultIndex)
+        val defaultIndex = Index.range(rowsData.size)
         
         // 转换为列数据
         columns.forEach { colName ->
@@ -81,41 +108,22 @@ class DataFrame {
     }
     
     /**
-     * 私有构造函数 - 用于内部创建DataFrame
+     * 内部构造函数 - 由已有的Series创建DataFrame，各Series的索引须一致（Series 创建时已校验索引类型）
      */
-    private constructor(
+    internal constructor(
         data: Map<String, Series<Any>>,
         columns: List<String>
     ) {
         this.data.putAll(data)
         this.columns = columns
-        
-        // 验证所有Series的索引类型一致且有效
-        if (data.isNotEmpty()) {
-            val firstSeries = data.values.first()
-            val indexList = firstSeries.index()
-            validateIndexType(indexList)
-        }
-    }
-    
-    /**
-     * 验证索引类型：只能是Int或String
-     */
-    private fun validateIndexType(indexList: List<Any>) {
-        for (item in indexList) {
-            when (item) {
-                is Int, is String -> continue
-                else -> throw IllegalArgumentException("索引类型必须是Int或String，但得到了: ${item::class.simpleName}")
-            }
-        }
     }
 
     /**
-     * 获取索引列表 - 从第一个Series获取
+     * 获取索引 - 从第一个Series获取
      */
-    fun index(): List<Any> {
+    fun index(): Index {
         if (data.isEmpty()) {
-            return emptyList()
+            return Index.range(0)
         }
         return data.values.first().index()
     }
@@ -189,84 +197,52 @@ class DataFrame {
     }
     
     /**
-     * 计算 DataFrame 列之间的相关系数矩阵
+     * 计算数值列之间的相关系数矩阵，行索引与列名均为参与计算的列名
+     *
+     * 每对列只使用两列都不缺失的行；有效行数少于 minPeriods 或方差为 0 时结果为空值
+     *
+     * @param method "pearson"、"spearman" 或 "kendall"
+     * @param minPeriods 每对列至少需要的有效行数
+     */
+    fun corr(method: String = "pearson", minPeriods: Int = 1): DataFrame {
+        val corrMethod = CorrMethod.fromName(method)
+        return pairwiseMatrix("相关系数") { CorrelationEngine.correlation(it, corrMethod, minPeriods) }
+    }
+
+    /**
+     * 计算数值列之间的协方差矩阵，每对列只使用两列都不缺失的行
+     *
+     * @param minPeriods 每对列至少需要的有效行数
+     * @param ddof 自由度修正，分母为有效行数 - ddof
      */
-    fun corr(): DataFrame {
+    fun cov(minPeriods: Int = 1, ddof: Int = 1): DataFrame {
+        return pairwiseMatrix("协方差") { CorrelationEngine.covariance(it, minPeriods, ddof) }
+    }
+
+    private fun pairwiseMatrix(label: String, compute: (List<DoubleArray>) -> DoubleArray): DataFrame {
         if (columns.isEmpty()) {
             return DataFrame(emptyList<Map<String, Any?>>())
         }
-        
-        // 只考虑数值类型的列
+
+        // 只考虑数值类型的列：首个非空值为数值或全为空
         val numericColumns = columns.filter { colName ->
-            val series = data[colName]!!
-            val values = series.values().filterNotNull()
-            values.isEmpty() || values.first() is Number
+            val first = data[colName]!!.values().firstOrNull { it != null }
+            first == null || first is Number
         }
-        
         if (numericColumns.size < 2) {
-            throw IllegalArgumentException("需要至少两个数值列来计算相关系数")
-        }
-        
-        // 计算相关系数矩阵
-        val corrData = mutableMapOf<String, List<Double>>()
-        
-        for (col1 in numericColumns) {
-            val rowValues = mutableListOf<Double>()
-            for (col2 in numericColumns) {
-                val corr = calculateCorrelation(col1, col2)
-                rowValues.add(corr)
-            }
-            corrData[col1] = rowValues
-        }
-        
-        // 创建相关系数矩阵 DataFrame
-        val corrDF = DataFrame(corrData)
-        // 重命名行索引为列名
-        val renamedDF = DataFrame(
-            numericColumns.map { rowName ->
-                numericColumns.mapIndexed { i, colName -> 
-                    colName to corrData[rowName]!![i] 
-                }.toMap()
-            }
-        )
-        
-        return renamedDF
-    }
-    
-    /**
-     * 计算两列之间的相关系数
-     */
-    private fun calculateCorrelation(col1: String, col2: String): Double {
-        val series1 = data[col1]!!
-        val series2 = data[col2]!!
-        
-        val values1 = series1.values().filterNotNull().map { (it as Number).toDouble() }
-        val values2 = series2.values().filterNotNull().map { (it as Number).toDouble() }
-        
-        if (values1.size != values2.size || values1.isEmpty()) {
-            return Double.NaN
+            throw IllegalArgumentException("需要至少两个数值列来计算$label")
         }
-        
-        // 计算皮尔逊相关系数
-        val n = values1.size
-        val mean1 = values1.sum() / n
-        val mean2 = values2.sum() / n
-        
-        var numerator = 0.0
-        var sumSq1 = 0.0
-        var sumSq2 = 0.0
-        
-        for (i in 0 until n) {
-            val diff1 = values1[i] - mean1
-            val diff2 = values2[i] - mean2
-            numerator += diff1 * diff2
-            sumSq1 += diff1 * diff1
-            sumSq2 += diff2 * diff2
+
+        val k = numericColumns.size
+        val matrix = compute(numericColumns.map { data[it]!!.doublesOrNaN() })
+        val newData = numericColumns.withIndex().associate { (b, colName) ->
+            @Suppress("UNCHECKED_CAST")
+            val series = Series.wrap(
+                DoubleColumn.nanAsNull(DoubleArray(k) { a -> matrix[a * k + b] }), numericColumns, colName, AndaTypes.FLOAT64
+            ) as Series<Any>
+            colName to series
         }
-        
-        val denominator = kotlin.math.sqrt(sumSq1 * sumSq2)
-        
-        return if (denominator == 0.0) 0.0 else numerator / denominator
+        return DataFrame(newData, numericColumns)
     }
     
     /**
@@ -275,11 +251,7 @@ class DataFrame {
     fun head(n: Int = 5): DataFrame {
         val indexList = index()
         val actualN = kotlin.math.min(n, indexList.size)
-        val newIndex = indexList.take(actualN)
-        val newData = columns.associate { colName ->
-            colName to data[colName]!!.head(actualN)
-        }
-        return DataFrame(newData, columns)
+        return sliceRows(0, actualN)
     }
     
     /**
@@ -288,10 +260,15 @@ class DataFrame {
     fun tail(n: Int = 5): DataFrame {
         val indexList = index()
         val actualN = kotlin.math.min(n, indexList.size)
-        val newIndex = indexList.takeLast(actualN)
-        val newData = columns.associate { colName ->
-            colName to data[colName]!!.tail(actualN)
-        }
+        return sliceRows(indexList.size - actualN, indexList.size)
+    }
+
+    /**
+     * 位置区间 [from, until) 的行，各列共享同一个子索引
+     */
+    private fun sliceRows(from: Int, until: Int): DataFrame {
+        val newIndex = index().slice(from, until)
+        val newData = columns.associateWith { data[it]!!.slice(from, until, newIndex) }
         return DataFrame(newData, columns)
     }
     
@@ -384,35 +361,25 @@ class DataFrame {
     }
 
     /**
-     * 按条件筛选行
+     * 按条件筛选行，保留原索引标签
+     * 每行都要构造行对象，数据量大时使用 [filter] 的条件表达式版本
      */
     fun filter(predicate: (Map<String, Series<Any>?>) -> Boolean): DataFrame {
-        val indexList = index()
-        val filteredData = mutableListOf<Map<String, Any?>>()
-        val filteredIndex = mutableListOf<Any>()
-        
-        for (i in indexList.indices) {
-            val row = getRow(i)
-            if (predicate(row)) {
-                // 将 Series<Any> 转换回 Map<String, Any?> 用于创建新 DataFrame
-                val rowValues = row.mapValues { (_, series) -> series?.get(0) }
-                filteredData.add(rowValues)
-                filteredIndex.add(indexList[i])
-            }
-        }
-        
-        // 创建新的DataFrame，需要重新创建Series以使用新的索引
-        if (filteredData.isEmpty()) {
-            return DataFrame(emptyList<Map<String, Any?>>())
-        }
-        
-        val newData = mutableMapOf<String, Series<Any>>()
-        columns.forEach { colName ->
-            val colData = filteredData.map { row -> row[colName] }
-            newData[colName] = Series(colData, filteredIndex, colName)
+        val rows = index().indices.filter { predicate(getRow(it)) }
+        return takeRows(rows.toIntArray())
+    }
+    
+    /**
+     * 按条件表达式筛选行，保留原索引标签
+     * 原生库可用时在选择位图上求值，不逐行构造对象
+     *
+     * 例：`df.filter((col("price") gt 10) and (col("city") eq "北京") or col("qty").isNull())`
+     */
+    fun filter(predicate: Predicate): DataFrame {
+        val rows = FilterEngine.selectRows(predicate, index().size) { name ->
+            (data[name] ?: throw IllegalArgumentException("列不存在: $name")).values()
         }
-        
-        return DataFrame(newData, columns)
+        return takeRows(rows)
     }
     
     /**
@@ -428,7 +395,7 @@ class DataFrame {
             // 为每个单元格创建一个只包含单个元素的 Series
             val cellValue = data[colName]!![rowIndex]
             val cellSeries = if (cellValue != null) {
-                Series(listOf(cellValue), listOf(0), colName)
+                Series(listOf(cellValue), null, colName)
             } else {
                 null
             }
@@ -440,14 +407,22 @@ class DataFrame {
      * 按标签获取行 - 返回 Map<String, Series<Any>?>
      */
     fun loc(label: Any): Map<String, Series<Any>?> {
-        val indexList = index()
-        val position = indexList.indexOf(label)
+        val position = index().positionOf(label)
         if (position == -1) {
             throw NoSuchElementException("未找到索引: $label")
         }
         return getRow(position)
     }
     
+    /**
+     * 按标签区间取行，含两端（同 pandas 的 df.loc[start:end]），null 表示不限
+     * 单调的索引按二分查找，端点标签可以不存在；非单调的索引要求端点标签存在且唯一，见 [Index.sliceLocs]
+     */
+    fun loc(start: Any?, end: Any?): DataFrame {
+        val range = index().sliceLocs(start, end)
+        return sliceRows(range.first, range.last + 1)
+    }
+    
     /**
      * 按位置获取行 - 返回 Map<String, Series<Any>?>
      */
@@ -464,14 +439,37 @@ class DataFrame {
      * 按标签获取单元格值
      */
     fun at(label: Any, colName: String): Any? {
-        val indexList = index()
-        val position = indexList.indexOf(label)
+        val position = index().positionOf(label)
         if (position == -1) {
             throw NoSuchElementException("未找到索引: $label")
         }
         return data[colName]?.get(position)
     }
     
+    /**
+     * 以某列的值作为行索引，该列从数据中移除；值只能是 Int 或 String，不能为空
+     */
+    fun setIndex(colName: String): DataFrame {
+        val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
+        val labels = series.values().map { it ?: throw IllegalArgumentException("索引不能包含空值: $colName") }
+        val newIndex = Index.of(labels)
+        val remaining = columns - colName
+        return DataFrame(remaining.associateWith { data[it]!!.withIndex(newIndex) }, remaining)
+    }
+    
+    /**
+     * 把行索引还原为普通列（放在最前面），行索引改为默认的 0 until n
+     */
+    fun resetIndex(name: String = "index"): DataFrame {
+        if (name in columns) throw IllegalArgumentException("列已存在: $name")
+        val labels = index()
+        val newIndex = Index.range(labels.size)
+        val newData = LinkedHashMap<String, Series<Any>>()
+        newData[name] = Series(labels.toList(), newIndex, name)
+        columns.forEach { colName -> newData[colName] = data[colName]!!.withIndex(newIndex) }
+        return DataFrame(newData, listOf(name) + columns)
+    }
+    
     /**
      * 检查空值
      */
@@ -547,6 +545,43 @@ class DataFrame {
         return DataFrame(newData, columns)
     }
     
+    /**
+     * 标记重复行，如 `df.duplicated(listOf("user", "item", "ts"))`
+     *
+     * 各列编码为 int64 键后，在原生层一次算出每行的组合哈希，按哈希分区并行去重；空值与空值相等
+     *
+     * @param subset 参与比较的列，默认全部列
+     * @param keep "first"：第一次出现的不算重复；"last"：最后一次出现的不算重复；"none"（或 "false"）：出现多次的全部算重复
+     * @return 与原行对齐的布尔Series，索引不变
+     */
+    fun duplicated(subset: List<String>? = null, keep: String = "first"): Series<Boolean> {
+        val flags = duplicatedRows(subset, DuplicateKeep.fromName(keep))
+        return Series.wrap(BoolColumn(flags, null), index(), null, AndaTypes.BOOL)
+    }
+
+    /**
+     * 删除重复行，保留原索引标签，规则同 [duplicated]
+     */
+    fun dropDuplicates(subset: List<String>? = null, keep: String = "first"): DataFrame {
+        val flags = duplicatedRows(subset, DuplicateKeep.fromName(keep))
+        val rows = IntArray(flags.count { !it })
+        var k = 0
+        for (i in flags.indices) {
+            if (!flags[i]) rows[k++] = i
+        }
+        return takeRows(rows)
+    }
+
+    private fun duplicatedRows(subset: List<String>?, keep: DuplicateKeep): BooleanArray {
+        val keyCols = subset ?: columns
+        if (keyCols.isEmpty()) throw IllegalArgumentException("至少需要一个去重列")
+        val keys = keyCols.map { colName ->
+            val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
+            DedupKeyEncoding.encode(series.values())
+        }
+        return DedupEngine.duplicated(keys.toTypedArray(), keep)
+    }
+    
     /**
      * 按列分组
      */
@@ -554,6 +589,14 @@ class DataFrame {
         return GroupBy(this, groupCols.toList())
     }
     
+    /**
+     * 按行索引分组（同 pandas 的 groupby(level=0)），结果以分组标签为索引
+     * 分组键直接使用索引的编码（Int 标签本身，或索引哈希表给出的第一次出现位置），不再逐值查字典
+     */
+    fun groupByIndex(): GroupBy {
+        return GroupBy(this)
+    }
+    
     /**
      * 聚合操作
      */
@@ -693,6 +736,29 @@ class DataFrame {
         return DataFrame(newData, newColumns)
     }
     
+    /**
+     * 把字符串列转为字典编码存储，分组、连接、排序、筛选和去重在编号上计算
+     * 不指定列时转换所有非空值全是字符串的列
+     */
+    fun asCategorical(vararg colNames: String): DataFrame {
+        val invalidCols = colNames.filter { it !in columns }
+        if (invalidCols.isNotEmpty()) {
+            throw IllegalArgumentException("不存在的列: $invalidCols")
+        }
+        val newData = data.toMutableMap()
+        if (colNames.isEmpty()) {
+            columns.forEach { colName ->
+                val values = data[colName]!!.values()
+                if (values.any { it != null } && values.all { it == null || it is String }) {
+                    newData[colName] = data[colName]!!.asCategorical()
+                }
+            }
+        } else {
+            colNames.forEach { colName -> newData[colName] = data[colName]!!.asCategorical() }
+        }
+        return DataFrame(newData, columns)
+    }
+
     /**
      * 复制DataFrame，可选修改属性
      */
@@ -749,10 +815,7 @@ class DataFrame {
             return sumNative(colName)
         }
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = series.nonNullDoubles()
         var sum = 0.0
         doubleArray.forEach {
             sum = sum + it
@@ -809,10 +872,7 @@ class DataFrame {
             return maxNative(colName)
         }
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = series.nonNullDoubles()
 
         if (doubleArray.isEmpty()) return Double.NaN
         
@@ -824,10 +884,7 @@ class DataFrame {
      */
     private fun maxNative(colName: String): Double {
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = series.nonNullDoubles()
         
         return NativeMath.maxDoubleArray(doubleArray)
     }
@@ -840,10 +897,7 @@ class DataFrame {
             return minNative(colName)
         }
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = series.nonNullDoubles()
         
         if (doubleArray.isEmpty()) return Double.NaN
         
@@ -855,71 +909,58 @@ class DataFrame {
      */
     private fun minNative(colName: String): Double {
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = series.nonNullDoubles()
         
         return NativeMath.minDoubleArray(doubleArray)
     }
     
     /**
-     * 计算指定数值列的方差 - 优先使用原生方法
+     * 计算指定数值列的方差，默认为样本方差 (ddof=1)，有效值不超过 ddof 个时为 NaN
      */
-    fun variance(colName: String): Double {
-        if (isNativeAvailable()) {
-            return varianceNative(colName)
-        }
-        val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        if (doubleArray.size < 2) return Double.NaN
-        
-        val mean = doubleArray.sum() / doubleArray.size
-        val sumSquaredDiff = doubleArray.sumOf { (it - mean) * (it - mean) }
-        return sumSquaredDiff / (doubleArray.size - 1)
-    }
+    fun variance(colName: String, ddof: Int = 1): Double = columnMoments(colName, MomentOrder.VARIANCE).variance(ddof)
     
     /**
-     * 使用原生方法计算指定数值列的方差（高性能）
+     * 计算指定数值列的标准差，默认 ddof=1
      */
-    private fun varianceNative(colName: String): Double {
-        val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        return NativeMath.variance(doubleArray)
-    }
+    fun std(colName: String, ddof: Int = 1): Double = columnMoments(colName, MomentOrder.VARIANCE).std(ddof)
     
     /**
-     * 计算指定数值列的标准差 - 优先使用原生方法
+     * 指定数值列的无偏偏度，有效值不足3个时为 NaN
      */
-    fun std(colName: String): Double {
-        if (isNativeAvailable()) {
-            return stdNative(colName)
-        }
-        val variance = variance(colName)
-        return kotlin.math.sqrt(variance)
-    }
+    fun skew(colName: String): Double = columnMoments(colName, MomentOrder.SHAPE).skew()
     
     /**
-     * 使用原生方法计算指定数值列的标准差（高性能）
+     * 指定数值列的无偏超额峰度，有效值不足4个时为 NaN
      */
-    private fun stdNative(colName: String): Double {
+    fun kurt(colName: String): Double = columnMoments(colName, MomentOrder.SHAPE).kurt()
+    
+    // 原生库可用时在原生层一次扫描计算，否则使用相同公式的 Kotlin 实现
+    private fun columnMoments(colName: String, order: MomentOrder): MomentAccumulator {
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        return NativeMath.std(doubleArray)
+        return series.moments(order)
     }
     
+    /**
+     * 指定数值列的近似分位数（KLL 摘要），q 位于 [0, 1]
+     */
+    fun approxQuantile(colName: String, q: Double): Double = column(colName).approxQuantile(q)
+    
+    fun approxQuantile(colName: String, qs: List<Double>): List<Double> = column(colName).approxQuantile(qs)
+    
+    /**
+     * 指定列的近似去重个数（HyperLogLog），缺失值不计入
+     */
+    fun approxNunique(colName: String, precision: Int = DistinctCountSketch.DEFAULT_PRECISION): Long =
+        column(colName).approxNunique(precision)
+    
+    /**
+     * 指定列出现次数最多的 k 个值及其估计次数（Space-Saving），按次数降序
+     */
+    fun topK(colName: String, k: Int): Map<Any, Long> = column(colName).topK(k)
+    
+    private fun column(colName: String): Series<Any> =
+        data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
+    
     /**
      * 对指定数值列进行标准归一化 - 优先使用原生方法
      */
@@ -929,10 +970,7 @@ class DataFrame {
         }
         
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = series.nonNullDoubles()
         
         if (doubleArray.isEmpty()) return this
         
@@ -956,15 +994,12 @@ class DataFrame {
      */
     private fun normalizeNative(colName: String): DataFrame {
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = series.nonNullDoubles()
         
         val normalized = NativeMath.normalize(doubleArray)
         
-        val newValues = normalized.map { it as Any? }
-        val newSeries = Series(newValues, index(), colName)
+        @Suppress("UNCHECKED_CAST")
+        val newSeries = Series.ofDoubles(normalized, index(), colName) as Series<Any>
         
         val newData = data.toMutableMap()
         newData[colName] = newSeries
@@ -1014,20 +1049,14 @@ class DataFrame {
         val series1 = data[col1] ?: throw IllegalArgumentException("列不存在: $col1")
         val series2 = data[col2] ?: throw IllegalArgumentException("列不存在: $col2")
         
-        val array1 = series1.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val array1 = series1.nonNullDoubles()
         
-        val array2 = series2.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val array2 = series2.nonNullDoubles()
         
         val result = NativeMath.vectorizedAdd(array1, array2)
         
-        val newValues = result.map { it as Any? }
-        val newSeries = Series(newValues, index(), resultCol)
+        @Suppress("UNCHECKED_CAST")
+        val newSeries = Series.ofDoubles(result, index(), resultCol) as Series<Any>
         
         val newData = data.toMutableMap()
         newData[resultCol] = newSeries
@@ -1079,20 +1108,14 @@ class DataFrame {
         val series1 = data[col1] ?: throw IllegalArgumentException("列不存在: $col1")
         val series2 = data[col2] ?: throw IllegalArgumentException("列不存在: $col2")
         
-        val array1 = series1.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val array1 = series1.nonNullDoubles()
         
-        val array2 = series2.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val array2 = series2.nonNullDoubles()
         
         val result = NativeMath.vectorizedMultiply(array1, array2)
         
-        val newValues = result.map { it as Any? }
-        val newSeries = Series(newValues, index(), resultCol)
+        @Suppress("UNCHECKED_CAST")
+        val newSeries = Series.ofDoubles(result, index(), resultCol) as Series<Any>
         
         val newData = data.toMutableMap()
         newData[resultCol] = newSeries
@@ -1135,15 +1158,9 @@ class DataFrame {
         val series1 = data[col1] ?: throw IllegalArgumentException("列不存在: $col1")
         val series2 = data[col2] ?: throw IllegalArgumentException("列不存在: $col2")
         
-        val array1 = series1.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val array1 = series1.nonNullDoubles()
         
-        val array2 = series2.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val array2 = series2.nonNullDoubles()
         
         return NativeMath.dotProduct(array1, array2)
     }
@@ -1171,120 +1188,140 @@ class DataFrame {
      */
     private fun normNative(colName: String): Double {
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = series.nonNullDoubles()
         
         return NativeMath.norm(doubleArray)
     }
     
     /**
-     * 排序 - 优先使用原生方法
+     * 按一列排序（稳定），缺失值排在最后，保留原索引标签
      */
     fun sortValues(by: String, descending: Boolean = false): DataFrame {
-        if (isNativeAvailable()) {
-            return sortValuesNative(by, descending)
-        }
-        
-        if (by !in columns) {
-            throw IllegalArgumentException("列不存在: $by")
-        }
-        
-        val series = data[by]!!
-        val indexList = index()
-        val sortedPairs = indexList.zip(series.values()).sortedBy { 
-            it.second?.toString() 
-        }
-        
-        val finalPairs = if (descending) {
-            sortedPairs.reversed()
-        } else {
-            sortedPairs
-        }
-        
-        val newIndex = finalPairs.map { it.first }
-        val sortedRows = newIndex.map { label ->
-            val pos = indexList.indexOf(label)
-            columns.associate { colName -> colName to data[colName]!![pos] }
-        }
-        
-        return DataFrame(sortedRows)
+        return sortValues(listOf(by), listOf(!descending))
     }
     
     /**
-     * 使用原生方法进行排序（高性能）
+     * 按多列排序（稳定），依次比较各列，保留原索引标签
+     * 原生库可用时使用基数排序
+     *
+     * @param by 排序列
+     * @param ascending 每列是否升序，默认全部升序
+     * @param naPosition 缺失值位置："last" 或 "first"
      */
-    private fun sortValuesNative(colName: String, descending: Boolean = false): DataFrame {
-        val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        val indices = if (descending) {
-            NativeMath.argsort(doubleArray).reversed()
-        } else {
-            NativeMath.argsort(doubleArray).toList()
-        }
-        
-        val indexList = index()
-        val newIndex = indices.map { indexList[it] }
-        val sortedRows = newIndex.map { label ->
-            val pos = indexList.indexOf(label)
-            columns.associate { colName -> colName to data[colName]!![pos] }
-        }
-        
-        return DataFrame(sortedRows)
+    fun sortValues(
+        by: List<String>,
+        ascending: List<Boolean> = List(by.size) { true },
+        naPosition: String = "last"
+    ): DataFrame {
+        return takeRows(sortRowIndices(by, ascending, naPosition))
     }
     
     /**
-     * 布尔筛选（大于阈值）- 优先使用原生方法
+     * 指定列最大的 n 行（按降序，相等时保持原顺序），缺失值不参与
      */
-    fun filterGreaterThan(colName: String, threshold: Double): DataFrame {
-        if (isNativeAvailable()) {
-            return filterGreaterThanNative(colName, threshold)
-        }
-        
-        val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val values = series.values()
-        
-        val filteredIndices = values.mapIndexedNotNull { index, value ->
-            if (value != null && (value as Number).toDouble() > threshold) index else null
-        }
-        
-        val filteredRows = filteredIndices.map { i ->
-            columns.associate { colName -> colName to data[colName]!![i] }
-        }
-        
-        return DataFrame(filteredRows)
-    }
+    fun nlargest(n: Int, column: String): DataFrame = takeRows(topRows(n, column, largest = true))
     
     /**
-     * 使用原生方法进行布尔筛选（高性能）
+     * 指定列最小的 n 行（按升序，相等时保持原顺序），缺失值不参与
      */
-    private fun filterGreaterThanNative(colName: String, threshold: Double): DataFrame {
-        val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        val mask = NativeMath.greaterThan(doubleArray, threshold)
-        val indices = NativeData.where(mask)
-        val filteredRows = indices.map { i ->
-            columns.associate { colName2 ->
-                colName2 to data[colName2]!![i.toInt()]
-            }
-        }
-
-        return DataFrame(filteredRows)
+    fun nsmallest(n: Int, column: String): DataFrame = takeRows(topRows(n, column, largest = false))
+    
+    /**
+     * 对各数值列做滑动窗口，非数值列不出现在结果中，例：`df.rolling(7, minPeriods = 1).mean()`
+     *
+     * @param window 窗口行数
+     * @param minPeriods 窗口内非缺失值少于该数时结果为 null，默认等于 window
+     * @param center 窗口是否居中
+     */
+    fun rolling(window: Int, minPeriods: Int? = null, center: Boolean = false): Rolling<DataFrame> {
+        val spec = WindowSpec.fixed(window, minPeriods, center)
+        return Rolling { op -> rollingApply(op, spec) }
     }
     
     /**
-     * 查找空值索引 - 优先使用原生方法
+     * 对各数值列做扩展窗口（从第一行到当前行）
      */
-    fun findNullIndices(colName: String): List<Int> {
+    fun expanding(minPeriods: Int = 1): Rolling<DataFrame> {
+        val spec = WindowSpec.expanding(minPeriods)
+        return Rolling { op -> rollingApply(op, spec) }
+    }
+    
+    private fun rollingApply(op: RollingOp, spec: WindowSpec): DataFrame {
+        val numericColumns = columns.filter { colName -> data[colName]!!.values().all { it == null || it is Number } }
+        @Suppress("UNCHECKED_CAST")
+        val newData = numericColumns.associateWith { data[it]!!.rollingApply(op, spec) as Series<Any> }
+        return DataFrame(newData, numericColumns)
+    }
+    
+    private fun sortRowIndices(by: List<String>, ascending: List<Boolean>, naPosition: String): IntArray {
+        if (by.isEmpty()) throw IllegalArgumentException("至少需要一个排序列")
+        if (ascending.size != by.size) {
+            throw IllegalArgumentException("ascending 的长度必须与排序列数一致: ${ascending.size} != ${by.size}")
+        }
+        val nullsFirst = when (naPosition.lowercase()) {
+            "first" -> true
+            "last" -> false
+            else -> throw IllegalArgumentException("不支持的缺失值位置: $naPosition")
+        }
+        val keys = by.mapIndexed { i, colName ->
+            val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
+            SortKey(SortKeyEncoding.encode(series.values()), !ascending[i], nullsFirst)
+        }
+        return SortEngine.sortIndices(keys)
+    }
+    
+    private fun topRows(n: Int, column: String, largest: Boolean): IntArray {
+        val series = data[column] ?: throw IllegalArgumentException("列不存在: $column")
+        return SortEngine.topK(SortKeyEncoding.encode(series.values()), n, largest)
+    }
+    
+    /**
+     * 按行号取出行，保留原索引标签
+     */
+    internal fun takeRows(rows: IntArray): DataFrame {
+        val newIndex = index().take(rows)
+        val newData = columns.associateWith { data[it]!!.take(rows, newIndex) }
+        return DataFrame(newData, columns)
+    }
+    
+    /**
+     * 转为延迟执行的 [LazyFrame]，之后的操作只记录到查询计划中，collect 时优化后一次执行
+     */
+    fun lazy(): LazyFrame = LazyFrame.of(this)
+
+    /**
+     * 对数值列求值逐元素表达式，如 `df.eval("a * 2 + log(b)")`，结果与原行对齐，索引不变
+     *
+     * 整个表达式编译为一段指令，在原生层按数据块一次遍历完成，exp/log/sin/cos 使用向量化内核，不为中间步骤生成整列。
+     * 支持 `+ - * / **`、比较（结果为 1/0）、`& | ~`、abs/sqrt/exp/log/sin/cos/pow/clip/where/fill_null/normalize；
+     * 缺失值参与运算（包括比较）时结果为缺失值
+     *
+     * @throws IllegalArgumentException 表达式语法错误、列不存在或不是数值列
+     */
+    fun eval(expression: String): Series<Double> {
+        val values = LazyExecutor.evaluate(this, listOf(ExprParser.parse(expression)))[0]
+        return Series.wrap(DoubleColumn.nanAsNull(values), index(), null, AndaTypes.FLOAT64)
+    }
+
+    /**
+     * 按表达式计算多列，如 `df.withColumns("total" to "price * qty", "log_total" to "log(total + 1)")`
+     *
+     * 赋值依次生效，后面的表达式可以引用前面算出的列；所有表达式融合为一次遍历
+     */
+    fun withColumns(vararg assignments: Pair<String, String>): DataFrame =
+        lazy().withColumns(*assignments).collect()
+    
+    /**
+     * 布尔筛选（大于阈值）- 优先使用原生方法
+     */
+    fun filterGreaterThan(colName: String, threshold: Double): DataFrame {
+        return filter(col(colName) gt threshold)
+    }
+    
+    /**
+     * 查找空值索引 - 优先使用原生方法
+     */
+    fun findNullIndices(colName: String): List<Int> {
         if (isNativeAvailable()) {
             return findNullIndicesNative(colName)
         }
@@ -1299,12 +1336,7 @@ class DataFrame {
      */
     private fun findNullIndicesNative(colName: String): List<Int> {
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .map { 
-                if (it == null) Double.NaN 
-                else (it as Number).toDouble() 
-            }
-            .toDoubleArray()
+        val doubleArray = series.doublesOrNaN()
         
         return NativeData.findNullIndices(doubleArray).toList()
     }
@@ -1335,12 +1367,7 @@ class DataFrame {
      */
     private fun dropNullValuesNative(colName: String): DataFrame {
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .map { 
-                if (it == null) Double.NaN 
-                else (it as Number).toDouble() 
-            }
-            .toDoubleArray()
+        val doubleArray = series.doublesOrNaN()
         
         val result = NativeData.dropNullValues(doubleArray)
         
@@ -1385,17 +1412,12 @@ class DataFrame {
      */
     private fun fillNullWithConstantNative(colName: String, value: Double): DataFrame {
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .map { 
-                if (it == null) Double.NaN 
-                else (it as Number).toDouble() 
-            }
-            .toDoubleArray()
+        val doubleArray = series.doublesOrNaN()
         
         val result = NativeData.fillNullWithConstant(doubleArray, value)
         
-        val newValues = result.map { it as Any? }
-        val newSeries = Series(newValues, index(), colName)
+        @Suppress("UNCHECKED_CAST")
+        val newSeries = Series.ofDoubles(result, index(), colName) as Series<Any>
         
         val newData = data.toMutableMap()
         newData[colName] = newSeries
@@ -1404,182 +1426,87 @@ class DataFrame {
     }
     
     /**
-     * 分组求和 - 优先使用原生方法
+     * 分组求和 - 通过哈希分组引擎计算，原生库不可用时自动退化为 Kotlin 实现
      */
     fun groupBySum(groupCol: String, valueCol: String): DataFrame {
-        if (isNativeAvailable()) {
-            return groupBySumNative(groupCol, valueCol)
-        }
-        
-        val groupSeries = data[groupCol] ?: throw IllegalArgumentException("列不存在: $groupCol")
-        val valueSeries = data[valueCol] ?: throw IllegalArgumentException("列不存在: $valueCol")
-        
-        // 分组并求和
-        val groupMap = mutableMapOf<Any?, Double>()
-        
-        val indexList = index()
-        for (i in indexList.indices) {
-            val groupKey = groupSeries[i]
-            val value = valueSeries[i]
-            
-            if (groupKey != null && value != null) {
-                val currentValue = groupMap[groupKey] ?: 0.0
-                groupMap[groupKey] = currentValue + (value as Number).toDouble()
-            }
-        }
-        
-        // 转换为DataFrame
-        val resultRows = groupMap.map { (key, sum) ->
-            mapOf(
-                groupCol to key,
-                valueCol to sum
-            )
-        }
-        
-        return DataFrame(resultRows)
+        if (valueCol !in columns) throw IllegalArgumentException("列不存在: $valueCol")
+        return groupBy(groupCol).agg(mapOf(valueCol to "sum"))
     }
     
     /**
-     * 使用原生方法进行分组求和（高性能）
-     */
-    private fun groupBySumNative(groupCol: String, valueCol: String): DataFrame {
-        val groupSeries = data[groupCol] ?: throw IllegalArgumentException("列不存在: $groupCol")
-        val valueSeries = data[valueCol] ?: throw IllegalArgumentException("列不存在: $valueCol")
-        
-        // 将分组列转换为整数索引
-        val uniqueGroups = groupSeries.values().filterNotNull().toSet().sortedWith(compareBy { it.toString() })
-        val groupToIndex = uniqueGroups.mapIndexed { index, value -> value to index }.toMap()
-        
-        val groups = groupSeries.values().map { 
-            groupToIndex[it] ?: -1 
-        }.toIntArray()
-        
-        val values = valueSeries.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        val result = NativeData.groupBySum(values, groups)
-        
-        // 转换为DataFrame
-        val resultRows = result.map { (key, sum) ->
-            mapOf(
-                groupCol to uniqueGroups[key.toInt()],
-                valueCol to sum
-            )
-        }
-        
-        return DataFrame(resultRows)
-    }
-    
-    /**
-     * 排序索引 - 优先使用原生方法
+     * 排序索引（稳定），缺失值排在最后
      */
     fun sortIndices(colName: String, descending: Boolean = false): List<Int> {
-        if (isNativeAvailable()) {
-            return sortIndicesNative(colName, descending)
-        }
-        
-        val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val values = series.values()
-        
-        return values.mapIndexed { index, value -> index to value }
-            .sortedBy { it.second?.toString() }
-            .let { if (descending) it.reversed() else it }
-            .map { it.first }
+        return sortRowIndices(listOf(colName), listOf(!descending), "last").toList()
     }
     
     /**
-     * 使用原生方法进行排序索引（高性能）
+     * 数据合并（类似 SQL JOIN）- 通过原生哈希连接计算行号，再按列收集结果
+     * how: inner/left/right/outer/semi/anti；连接键按值精确相等匹配，空值与空值匹配
+     * 两侧同名的非连接列分别加后缀 "_x" 和 "_y"
      */
-    private fun sortIndicesNative(colName: String, descending: Boolean = false): List<Int> {
-        val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        return NativeData.sortIndices(doubleArray, descending).toList()
+    fun merge(other: DataFrame, on: String, how: String = "inner"): DataFrame {
+        return merge(other, listOf(on), how)
     }
     
     /**
-     * 数据合并 - 优先使用原生方法
+     * 按多列组合键合并
      */
-    fun merge(other: DataFrame, on: String, how: String = "inner"): DataFrame {
-        if (isNativeAvailable()) {
-            return mergeNative(other, on)
+    fun merge(other: DataFrame, on: List<String>, how: String = "inner"): DataFrame {
+        if (on.isEmpty()) throw IllegalArgumentException("至少需要一个连接列")
+        on.forEach { colName ->
+            if (colName !in columns || colName !in other.columns) {
+                throw IllegalArgumentException("列不存在: $colName")
+            }
         }
+        val joinType = JoinType.fromName(how)
+        val encodedKeys = on.map { colName ->
+            JoinKeyEncoding.encode(data[colName]!!.values(), other.data[colName]!!.values())
+        }
+        val (leftIndices, rightIndices) = JoinEngine.join(
+            encodedKeys.map { it.first }.toTypedArray(),
+            encodedKeys.map { it.second }.toTypedArray(),
+            joinType
+        )
         
-        val resultRows = mutableListOf<Map<String, Any?>>()
-        
-        val indexList = index()
-        val otherIndexList = other.index()
+        val resultData = LinkedHashMap<String, List<Any?>>()
+        if (joinType == JoinType.SEMI || joinType == JoinType.ANTI) {
+            columns.forEach { colName ->
+                resultData[colName] = gatherRows(data[colName]!!.values(), leftIndices)
+            }
+            return DataFrame(resultData)
+        }
         
-        for (i in indexList.indices) {
-            val thisValue = at(i, on)
-            for (j in otherIndexList.indices) {
-                val otherValue = other.at(j, on)
-                if (thisValue == otherValue) {
-                    val row = mutableMapOf<String, Any?>()
-                    // 添加当前DataFrame的所有列
-                    columns.forEach { colName ->
-                        row[colName] = at(i, colName)
-                    }
-                    // 添加另一个DataFrame的所有列（排除连接列）
-                    other.columns().forEach { colName ->
-                        if (colName != on) {
-                            row[colName] = other.at(j, colName)
-                        }
-                    }
-                    resultRows.add(row)
+        val rightCols = other.columns.filter { it !in on }
+        columns.forEach { colName ->
+            val leftValues = data[colName]!!.values()
+            if (colName in on) {
+                // 连接列取有对应行的一侧
+                val rightValues = other.data[colName]!!.values()
+                resultData[colName] = List(leftIndices.size) { k ->
+                    if (leftIndices[k] >= 0) leftValues[leftIndices[k]] else rightValues[rightIndices[k]]
                 }
+            } else {
+                val outName = if (colName in rightCols) "${colName}_x" else colName
+                resultData[outName] = gatherRows(leftValues, leftIndices)
             }
         }
-        
-        return DataFrame(resultRows)
+        rightCols.forEach { colName ->
+            val outName = if (colName in columns) "${colName}_y" else colName
+            resultData[outName] = gatherRows(other.data[colName]!!.values(), rightIndices)
+        }
+        return DataFrame(resultData)
     }
     
     /**
-     * 使用原生方法进行数据合并（高性能）
+     * 按行号收集值，-1 对应 null；字典编码列只收集编号
      */
-    private fun mergeNative(other: DataFrame, on: String): DataFrame {
-        val leftSeries = this.data[on] ?: throw IllegalArgumentException("列不存在: $on")
-        val rightSeries = other.data[on] ?: throw IllegalArgumentException("列不存在: $on")
-        
-        val leftArray = leftSeries.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        val rightArray = rightSeries.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        val indices = NativeData.mergeIndices(leftArray, rightArray)
-        
-        // indices数组包含成对的索引：[leftIndex1, rightIndex1, leftIndex2, rightIndex2, ...]
-        val resultRows = mutableListOf<Map<String, Any?>>()
-        
-        for (i in indices.indices step 2) {
-            val leftIndex = indices[i]
-            val rightIndex = indices[i + 1]
-            
-            val row = mutableMapOf<String, Any?>()
-            // 添加左DataFrame的所有列
-            columns.forEach { colName ->
-                row[colName] = this.data[colName]!![leftIndex]
-            }
-            // 添加右DataFrame的所有列（排除连接列）
-            other.columns().forEach { colName ->
-                if (colName != on) {
-                    row[colName] = other.data[colName]!![rightIndex]
-                }
-            }
-            resultRows.add(row)
+    private fun gatherRows(values: List<Any?>, indices: IntArray): List<Any?> {
+        if (values is DictionaryColumn) return values.gatherOrNull(indices)
+        return List(indices.size) { k ->
+            val row = indices[k]
+            if (row >= 0) values[row] else null
         }
-        
-        return DataFrame(resultRows)
     }
     
     /**
@@ -1609,10 +1536,7 @@ class DataFrame {
      */
     private fun whereNative(colName: String, threshold: Double): DataFrame {
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = series.nonNullDoubles()
         
         val mask = NativeMath.greaterThan(doubleArray, threshold)
         val indices = NativeData.where(mask)
@@ -1625,125 +1549,54 @@ class DataFrame {
     }
     
     /**
-     * 统计描述 - 优先使用原生方法
+     * 统计描述：count, mean, std (ddof=1), min, 各分位数, max；没有有效值时除 count 外均为 NaN
+     *
+     * @param percentiles 输出的分位数，键如 "25%"；由分位数摘要计算，有效值较多时为近似值
      */
-    fun describe(colName: String): Map<String, Double> {
-        if (isNativeAvailable()) {
-            return describeNative(colName)
-        }
-        
-        val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-        
-        if (doubleArray.isEmpty()) {
-            return mapOf(
-                "count" to 0.0,
-                "mean" to Double.NaN,
-                "std" to Double.NaN,
-                "min" to Double.NaN,
-                "max" to Double.NaN
-            )
-        }
-        
-        val count = doubleArray.size.toDouble()
-        val mean = doubleArray.sum() / count
-        val variance = doubleArray.sumOf { (it - mean) * (it - mean) } / count
-        val std = kotlin.math.sqrt(variance)
-        val min = doubleArray.minOrNull() ?: Double.NaN
-        val max = doubleArray.maxOrNull() ?: Double.NaN
-        
-        return mapOf(
-            "count" to count,
-            "mean" to mean,
-            "std" to std,
-            "min" to min,
-            "max" to max
-        )
+    fun describe(colName: String, percentiles: List<Double> = QuantileSketch.DEFAULT_PERCENTILES): Map<String, Double> {
+        val series = column(colName)
+        return describeOf(series.moments(MomentOrder.VARIANCE), series.quantileSketch(), percentiles)
     }
     
     /**
-     * 使用原生方法进行统计描述（高性能）
+     * 不放回随机采样，所有列使用同一组行号，按抽取顺序返回并保留索引标签；
+     * sampleSize 不小于行数时返回打乱顺序的全部行
+     *
+     * @param seed 随机种子，相同种子得到相同的样本；为 null 时随机选取
+     * @param weights 权重列名，每行被抽中的概率与权重成正比；空值视为 0，权重不能为负数
      */
-    private fun describeNative(colName: String): Map<String, Double> {
-        val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        val result = NativeData.describe(doubleArray)
-        
-        return mapOf(
-            "count" to result[0],
-            "mean" to result[1],
-            "std" to result[2],
-            "min" to result[3],
-            "max" to result[4]
-        )
+    fun sample(sampleSize: Int, seed: Long? = null, weights: String? = null): DataFrame {
+        val k = maxOf(sampleSize, 0)
+        val resolvedSeed = SamplingEngine.seedOf(seed)
+        val rows = if (weights == null) {
+            SamplingEngine.sampleIndices(shape().first, k, resolvedSeed)
+        } else {
+            SamplingEngine.weightedSampleIndices(sampleWeights(weights, k), k, resolvedSeed)
+        }
+        return takeRows(rows)
     }
     
     /**
-     * 数据采样 - 优先使用原生方法
+     * 按比例不放回随机采样 round(fraction * 行数) 行
      */
-    fun sample(sampleSize: Int): DataFrame {
-        if (isNativeAvailable()) {
-            return sampleNative(sampleSize)
-        }
-        
-        val indexList = index()
-        if (indexList.isEmpty()) {
-            return this
-        }
-        
-        val actualSampleSize = kotlin.math.min(sampleSize, indexList.size)
-        val indices = (0 until indexList.size).shuffled().take(actualSampleSize)
-        
-        val sampledRows = indices.map { i ->
-            columns.associate { colName -> 
-                colName to data[colName]!![i] 
-            }
-        }
-        
-        return DataFrame(sampledRows)
+    fun sample(fraction: Double, seed: Long? = null, weights: String? = null): DataFrame {
+        return sample(SamplingEngine.countOf(fraction, shape().first), seed, weights)
     }
     
-    /**
-     * 使用原生方法进行数据采样（高性能）
-     */
-    private fun sampleNative(sampleSize: Int): DataFrame {
-        val indexList = index()
-        if (indexList.isEmpty()) {
-            return this
+    private fun sampleWeights(colName: String, k: Int): DoubleArray {
+        val series = column(colName)
+        if (!series.values().all { it == null || it is Number }) {
+            throw IllegalArgumentException("权重列必须是数值列: $colName")
         }
-        
-        // 获取所有列的数值数组
-        val arrays = columns.map { colName ->
-            val series = data[colName]!!
-            series.values()
-                .map { 
-                    if (it == null) Double.NaN 
-                    else (it as Number).toDouble() 
-                }
-                .toDoubleArray()
+        // 可能是列的底层数组，只读；NaN 在采样时与 0 一样不会被选中
+        val weights = series.doublesOrNaN()
+        var positive = 0
+        for (w in weights) {
+            if (w < 0.0 || w.isInfinite()) throw IllegalArgumentException("权重不能为负数或无穷大: $w")
+            if (w > 0.0) positive++
         }
-        
-        if (arrays.isEmpty()) {
-            return this
-        }
-        
-        // 对第一列进行采样，获取索引
-        val sampleIndices = NativeData.sample(arrays[0], sampleSize).map { it.toInt() }
-        
-        // 根据采样索引构建新的DataFrame
-        val sampledRows = sampleIndices.map { i ->
-            columns.associate { colName -> 
-                colName to data[colName]!![i] 
-            }
-        }
-        
-        return DataFrame(sampledRows)
+        if (positive < k) throw IllegalArgumentException("权重为正的行数不足: $positive < $k")
+        return weights
     }
     
     /**
@@ -1764,15 +1617,12 @@ class DataFrame {
      */
     private fun processBatchNative(colName: String, batchSize: Int = 1000): DataFrame {
         val series = data[colName] ?: throw IllegalArgumentException("列不存在: $colName")
-        val doubleArray = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = series.nonNullDoubles()
         
         val result = NativeBatch.processBatch(doubleArray, batchSize)
         
-        val newValues = result.map { it as Any? }
-        val newSeries = Series(newValues, index(), colName)
+        @Suppress("UNCHECKED_CAST")
+        val newSeries = Series.ofDoubles(result, index(), colName) as Series<Any>
         
         val newData = data.toMutableMap()
         newData[colName] = newSeries
@@ -1783,194 +1633,123 @@ class DataFrame {
     /**
      * 常用的合并操作 - 合并多个DataFrame
      */
-    fun mergeMultiple(dfs: List<DataFrame>, on: String): DataFrame {
+    fun mergeMultiple(dfs: List<DataFrame>, on: String, how: String = "inner"): DataFrame {
         var result = this
         for (df in dfs) {
-            result = result.merge(df, on)
+            result = result.merge(df, on, how)
         }
         return result
     }
     
     /**
-     * 连接操作（类似SQL JOIN）- 支持多种连接类型
+     * 连接操作（类似SQL JOIN）- 支持 inner/left/right/outer/semi/anti
      */
     fun join(other: DataFrame, on: String, how: String = "inner"): DataFrame {
-        return when (how.lowercase()) {
-            "inner" -> merge(other, on)
-            "left" -> leftJoin(other, on)
-            "right" -> rightJoin(other, on)
-            "outer" -> outerJoin(other, on)
-            else -> throw IllegalArgumentException("不支持的连接类型: $how")
-        }
+        return merge(other, on, how)
     }
     
     /**
-     * 左连接
+     * 按多列组合键连接
      */
-    private fun leftJoin(other: DataFrame, on: String): DataFrame {
-        val resultRows = mutableListOf<Map<String, Any?>>()
-        
-        val indexList = index()
-        val otherIndexList = other.index()
-        
-        for (i in indexList.indices) {
-            val thisValue = at(i, on)
-            var matched = false
-            
-            for (j in otherIndexList.indices) {
-                val otherValue = other.at(j, on)
-                if (thisValue == otherValue) {
-                    val row = mutableMapOf<String, Any?>()
-                    columns.forEach { colName ->
-                        row[colName] = at(i, colName)
-                    }
-                    other.columns().forEach { colName ->
-                        if (colName != on) {
-                            row[colName] = other.at(j, colName)
-                        }
-                    }
-                    resultRows.add(row)
-                    matched = true
-                }
-            }
-            
-            // 如果没有匹配，仍然添加左表的行，右表列为null
-            if (!matched) {
-                val row = mutableMapOf<String, Any?>()
-                columns.forEach { colName ->
-                    row[colName] = at(i, colName)
-                }
-                other.columns().forEach { colName ->
-                    if (colName != on) {
-                        row[colName] = null
-                    }
-                }
-                resultRows.add(row)
-            }
-        }
-        
-        return DataFrame(resultRows)
+    fun join(other: DataFrame, on: List<String>, how: String = "inner"): DataFrame {
+        return merge(other, on, how)
     }
     
     /**
-     * 右连接
+     * 按行索引连接（同 pandas 的 df.join(other)），结果保留标签，重名列加后缀 _x/_y
+     * 右表索引没有重复且连接类型为 left/inner/semi/anti 时，直接用右表索引的哈希表逐行查找左表标签
+     * （哈希表建一次后被之后的查找和连接复用）；否则两侧索引按连接键编码后做哈希连接
      */
-    private fun rightJoin(other: DataFrame, on: String): DataFrame {
-        val resultRows = mutableListOf<Map<String, Any?>>()
-        
-        val indexList = index()
-        val otherIndexList = other.index()
-        
-        for (j in otherIndexList.indices) {
-            val otherValue = other.at(j, on)
-            var matched = false
-            
-            for (i in indexList.indices) {
-                val thisValue = at(i, on)
-                if (thisValue == otherValue) {
-                    val row = mutableMapOf<String, Any?>()
-                    columns.forEach { colName ->
-                        row[colName] = at(i, colName)
-                    }
-                    other.columns().forEach { colName ->
-                        if (colName != on) {
-                            row[colName] = other.at(j, colName)
-                        }
-                    }
-                    resultRows.add(row)
-                    matched = true
-                }
+    fun joinOnIndex(other: DataFrame, how: String = "left"): DataFrame {
+        val joinType = JoinType.fromName(how)
+        val leftIndex = index()
+        val rightIndex = other.index()
+        val leftRows: IntArray
+        val rightRows: IntArray
+        val probe = joinType == JoinType.LEFT || joinType == JoinType.INNER ||
+            joinType == JoinType.SEMI || joinType == JoinType.ANTI
+        if (probe && rightIndex.isUnique) {
+            val found = rightIndex.lookup(leftIndex)
+            leftRows = when (joinType) {
+                JoinType.LEFT -> IntArray(found.size) { it }
+                JoinType.ANTI -> found.indices.filter { found[it] < 0 }.toIntArray()
+                else -> found.indices.filter { found[it] >= 0 }.toIntArray()
             }
-            
-            // 如果没有匹配，仍然添加右表的行，左表列为null
-            if (!matched) {
-                val row = mutableMapOf<String, Any?>()
-                columns.forEach { colName ->
-                    row[colName] = null
-                }
-                other.columns().forEach { colName ->
-                    if (colName != on) {
-                        row[colName] = other.at(j, colName)
-                    }
-                }
-                resultRows.add(row)
+            rightRows = when (joinType) {
+                JoinType.LEFT -> found
+                JoinType.INNER -> IntArray(leftRows.size) { found[leftRows[it]] }
+                else -> IntArray(0)
             }
+        } else {
+            val (leftKeys, rightKeys) = JoinKeyEncoding.encode(leftIndex, rightIndex)
+            val joined = JoinEngine.join(arrayOf(leftKeys), arrayOf(rightKeys), joinType)
+            leftRows = joined.first
+            rightRows = joined.second
         }
         
-        return DataFrame(resultRows)
-    }
-    
-    /**
-     * 全外连接
-     */
-    private fun outerJoin(other: DataFrame, on: String): DataFrame {
-        val resultRows = mutableListOf<Map<String, Any?>>()
-        val matchedLeft = mutableSetOf<Int>()
-        val matchedRight = mutableSetOf<Int>()
-        
-        val indexList = index()
-        val otherIndexList = other.index()
-        
-        // 先处理匹配的行
-        for (i in indexList.indices) {
-            val thisValue = at(i, on)
-            for (j in otherIndexList.indices) {
-                val otherValue = other.at(j, on)
-                if (thisValue == otherValue) {
-                    val row = mutableMapOf<String, Any?>()
-                    columns.forEach { colName ->
-                        row[colName] = at(i, colName)
-                    }
-                    other.columns().forEach { colName ->
-                        if (colName != on) {
-                            row[colName] = other.at(j, colName)
-                        }
-                    }
-                    resultRows.add(row)
-                    matchedLeft.add(i)
-                    matchedRight.add(j)
-                }
+        // 有左表行时取左表标签，否则取右表标签
+        val labels = if (leftRows.all { it >= 0 }) {
+            leftIndex.take(leftRows)
+        } else {
+            Index.of(List(leftRows.size) { k ->
+                if (leftRows[k] >= 0) leftIndex[leftRows[k]] else rightIndex[rightRows[k]]
+            })
+        }
+        val semiOrAnti = joinType == JoinType.SEMI || joinType == JoinType.ANTI
+        val newData = LinkedHashMap<String, Series<Any>>()
+        val gather = { series: Series<Any>, rows: IntArray, outName: String ->
+            if (outName == series.name() && rows.all { it >= 0 }) {
+                series.take(rows, labels)
+            } else {
+                Series(gatherRows(series.values(), rows), labels, outName)
             }
         }
-        
-        // 添加左表未匹配的行
-        for (i in indexList.indices) {
-            if (i !in matchedLeft) {
-                val row = mutableMapOf<String, Any?>()
-                columns.forEach { colName ->
-                    row[colName] = at(i, colName)
-                }
-                other.columns().forEach { colName ->
-                    if (colName != on) {
-                        row[colName] = null
-                    }
-                }
-                resultRows.add(row)
-            }
+        columns.forEach { colName ->
+            val outName = if (!semiOrAnti && colName in other.columns) "${colName}_x" else colName
+            newData[outName] = gather(data[colName]!!, leftRows, outName)
         }
-        
-        // 添加右表未匹配的行
-        for (j in otherIndexList.indices) {
-            if (j !in matchedRight) {
-                val row = mutableMapOf<String, Any?>()
-                columns.forEach { colName ->
-                    row[colName] = null
-                }
-                other.columns().forEach { colName ->
-                    if (colName != on) {
-                        row[colName] = other.at(j, colName)
-                    }
-                }
-                resultRows.add(row)
+        if (!semiOrAnti) {
+            other.columns.forEach { colName ->
+                val outName = if (colName in columns) "${colName}_y" else colName
+                newData[outName] = gather(other.data[colName]!!, rightRows, outName)
             }
         }
-        
-        return DataFrame(resultRows)
+        return DataFrame(newData, newData.keys.toList())
     }
     
     companion object {
+        /**
+         * 读取 toColumnar 保存的二进制列式文件
+         * 文件被内存映射，各列直接引用映射内存，加载时间与行数无关；FLOAT64 列常驻原生内存，
+         * 数值运算不经过 Java 数组。所有列都不再被引用后映射由GC释放
+         */
+        fun readColumnar(file: File): DataFrame {
+            val columnar = ColumnarFile.open(file)
+            if (columnar.columnNames.isEmpty()) {
+                columnar.close()
+                return DataFrame(emptyMap<String, List<Any?>>())
+            }
+            val defaultIndex = Index.range(columnar.rowCount)
+            val series = LinkedHashMap<String, Series<Any>>()
+            columnar.columnNames.forEachIndexed { c, colName ->
+                @Suppress("UNCHECKED_CAST")
+                series[colName] = when (columnar.types[c]) {
+                    ColumnarType.FLOAT64 -> Series.fromNative(columnar.nativeColumn(colName), defaultIndex, colName) as Series<Any>
+                    ColumnarType.BOOL -> Series.wrap(columnar.column(colName), defaultIndex, colName, AndaTypes.BOOL)
+                    ColumnarType.INT32 -> Series.wrap(columnar.column(colName), defaultIndex, colName, AndaTypes.INT32)
+                    ColumnarType.INT64 -> Series.wrap(columnar.column(colName), defaultIndex, colName, AndaTypes.INT64)
+                    ColumnarType.STRING -> Series.wrap(columnar.column(colName), defaultIndex, colName, AndaTypes.STRING)
+                }
+            }
+            return DataFrame(series, columnar.columnNames)
+        }
+
         /**
          * 从CSV文件读取数据
+         * 按块流式解析（有原生库时用 SIMD 分词并多线程解析），内存占用与结果大小相当
+         *
+         * @param sampleRows 预先推断类型的样本行数，后面出现放不下的值时整列提升类型
+         * @param categorical 字符串列按字典编码读取，原生读取器在解析时直接建字典，见 [Series.asCategorical]
          */
         fun readCSV(
             file: File, 
@@ -1980,7 +1759,9 @@ class DataFrame {
             encoding: String = "UTF-8",
             skipLines: Int = 0,
             nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-            trimValues: Boolean = true
+            trimValues: Boolean = true,
+            sampleRows: Int = 1000,
+            categorical: Boolean = false
         ): DataFrame {
             if (!file.exists()) {
                 throw IllegalArgumentException("文件不存在: ${file.absolutePath}")
@@ -1990,111 +1771,14 @@ class DataFrame {
                 throw SecurityException("无法读取文件: ${file.absolutePath}")
             }
             
-            val lines = try {
-                file.readLines(charset(encoding))
-            } catch (e: Exception) {
+            val options = DataFrameIO.csvOptions(
+                delimiter, header, autoType, encoding, skipLines, nullValues, trimValues, sampleRows, categorical
+            )
+            return try {
+                CsvReader.open(file, options).use { DataFrameIO.readCSVStream(it) }
+            } catch (e: IOException) {
                 throw RuntimeException("读取文件失败: ${e.message}", e)
             }
-            
-            if (lines.isEmpty()) {
-                return DataFrame(emptyList<Map<String, Any?>>())
-            }
-            
-            // 跳过指定行数
-            val effectiveLines = lines.drop(skipLines)
-            if (effectiveLines.isEmpty()) {
-                return DataFrame(emptyList<Map<String, Any?>>())
-            }
-            
-            val firstLine = effectiveLines.first()
-            val headers: List<String>
-            val dataLines: List<String>
-            
-            if (header) {
-                headers = parseCSVLine(firstLine, delimiter, trimValues)
-                dataLines = effectiveLines.drop(1)
-            } else {
-                // 如果没有表头，使用默认列名
-                val firstLineValues = parseCSVLine(firstLine, delimiter, trimValues)
-                headers = firstLineValues.indices.map { "col$it" }
-                dataLines = effectiveLines
-            }
-            
-            if (headers.isEmpty()) {
-                throw IllegalArgumentException("解析失败: 未找到有效的列名")
-            }
-            
-            // 预先推断每列的数据类型（只使用第一行数据）
-            val columnTypes = mutableMapOf<String, (String) -> Any?>()
-            if (autoType && dataLines.isNotEmpty()) {
-                val firstLineValues = parseCSVLine(dataLines.first(), delimiter, trimValues)
-                val adjustedFirstValues = if (firstLineValues.size < headers.size) {
-                    firstLineValues + List(headers.size - firstLineValues.size) { "" }
-                } else if (firstLineValues.size > headers.size) {
-                    firstLineValues.take(headers.size)
-                } else {
-                    firstLineValues
-                }
-                
-                headers.forEachIndexed { index, header ->
-                    val firstValue = adjustedFirstValues.getOrNull(index) ?: ""
-                    // 为每列创建一个转换函数，基于第一个值推断类型
-                    val inferredType = inferTypeFromSample(firstValue, nullValues)
-                    columnTypes[header] = { value ->
-                        if (value in nullValues) null 
-                        else convertValueWithType(value, inferredType)
-                    }
-                }
-            }
-            
-            // 解析数据行
-            val rows = dataLines.mapIndexed { lineIndex, line ->
-                try {
-                    val values = parseCSVLine(line, delimiter, trimValues)
-                    
-                    // 处理列数不匹配的情况
-                    val adjustedValues = if (values.size < headers.size) {
-                        // 补充空值
-                        values + List(headers.size - values.size) { "" }
-                    } else if (values.size > headers.size) {
-                        // 截断多余列
-                        values.take(headers.size)
-                    } else {
-                        values
-                    }
-                    
-                    val rowMap = headers.zip(adjustedValues).toMap()
-                    
-                    if (autoType) {
-                        // 使用预先推断的类型进行转换
-                        rowMap.mapValues { (key, value) ->
-                            val converter = columnTypes[key]
-                            if (converter != null) {
-                                converter(value)
-                            } else {
-                                // 如果没有推断出类型，使用原始值
-                                if (value in nullValues) null else value
-                            }
-                        }
-                    } else {
-                        // 不进行类型转换，但处理空值
-                        rowMap.mapValues { (_, value) ->
-                            if (value in nullValues) null else value
-                        }
-                    }
-                } catch (e: Exception) {
-                    throw RuntimeException("解析第 ${lineIndex + skipLines + (if (header) 2 else 1)} 行失败: $line", e)
-                }
-            }
-            
-            // 如果没有数据行但有表头，创建一个空DataFrame但保留列信息
-            if (rows.isEmpty()) {
-                // 创建空的DataFrame，但保留列名
-                val emptyData = headers.associateWith { emptyList<Any?>() }
-                return DataFrame(emptyData)
-            }
-            
-            return DataFrame(rows)
         }
         
         /**
@@ -2215,6 +1899,32 @@ class DataFrame {
         }
     }
     
+    /**
+     * 保存为二进制列式文件，逐列写出，用 readColumnar 读回时不需要解析
+     * 先写入同目录下的临时文件再替换目标文件，已映射的旧文件不受影响；不保存索引
+     */
+    fun toColumnar(file: File) {
+        val temp = File(file.path + ".tmp")
+        try {
+            ColumnarWriter(temp, index().size).use { writer ->
+                columns.forEach { colName ->
+                    val series = data[colName]!!
+                    if (series.isNativeResident()) {
+                        writer.writeColumn(colName, series.toNative())
+                    } else {
+                        writer.writeValues(colName, series.values())
+                    }
+                }
+                writer.finish()
+            }
+            if (!temp.renameTo(file)) {
+                throw IOException("无法写入文件: ${file.absolutePath}")
+            }
+        } finally {
+            temp.delete()
+        }
+    }
+
     /**
      * 导出为CSV文件
      */
@@ -2239,81 +1949,166 @@ class DataFrame {
 
 /**
  * 分组操作类
+ * 分组键和值列编码为原生数组后交给哈希分组引擎，一次遍历完成所有聚合
+ * 分组按首次出现的顺序输出，含空值键的行不参与分组
  */
 class GroupBy(
     private val df: DataFrame,
     private val groupCols: List<String>
 ) {
+    // 按行索引分组（DataFrame.groupByIndex），此时 groupCols 为空
+    private var byIndex = false
+    
+    internal constructor(df: DataFrame) : this(df, emptyList()) {
+        byIndex = true
+    }
+    
     /**
-     * 聚合操作
+     * 聚合操作：列名 -> 聚合类型（sum/mean/count/min/max/var/first/last）
+     * 结果每组一行，包含分组列和各聚合列；聚合列与分组列同名时命名为 "列名_聚合类型"
      */
     fun agg(operations: Map<String, String>): DataFrame {
-        // 获取分组键的唯一值
-        val groupKeyValues = mutableSetOf<List<Any?>>()
-        
-        val indexList = df.index()
-        for (rowIndex in indexList.indices) {
-            val key = groupCols.map { colName -> df.at(rowIndex, colName) }
-            groupKeyValues.add(key)
-        }
-        
-        // 对每个分组进行聚合
-        val resultRows = mutableListOf<Map<String, Any?>>()
-        
-        for (keyValue in groupKeyValues) {
-            // 筛选出该分组的所有行
-            val groupRows = mutableListOf<Map<String, Any?>>()
-            for (rowIndex in indexList.indices) {
-                val rowKey = groupCols.map { colName -> df.at(rowIndex, colName) }
-                if (rowKey == keyValue) {
-                    // 将 Series<Any> 转换为 Map<String, Any?>
-                    val row = df.iloc(rowIndex)
-                    val rowValues = row.mapValues { (_, series) -> series?.get(0) }
-                    groupRows.add(rowValues)
-                }
-            }
-            
-            // 创建临时DataFrame进行聚合
-            val tempDF = DataFrame(groupRows)
-            val aggResult = tempDF.agg(operations)
-            
-            // 添加分组键到结果
-            val resultRow = mutableMapOf<String, Any?>()
-            groupCols.forEachIndexed { i, colName ->
-                resultRow[colName] = keyValue[i]
-            }
-            // 添加聚合结果
-            aggResult.columns().forEach { colName ->
-                if (colName !in groupCols) {
-                    resultRow[colName] = aggResult.iloc(0)[colName]
-                }
-            }
-            
-            resultRows.add(resultRow)
-        }
-        
-        return DataFrame(resultRows)
+        return aggregate(operations.map { (colName, op) -> colName to AggOp.fromName(op) })
     }
     
     /**
-     * 求和
+     * 求和（数值列）
      */
-    fun sum(): DataFrame {
-        return agg(groupCols.associateWith { "sum" })
-    }
+    fun sum(): DataFrame = aggregateAll(AggOp.SUM, numericOnly = true)
     
     /**
-     * 平均值
+     * 平均值（数值列）
      */
-    fun mean(): DataFrame {
-        return agg(groupCols.associateWith { "mean" })
+    fun mean(): DataFrame = aggregateAll(AggOp.MEAN, numericOnly = true)
+    
+    /**
+     * 样本方差（数值列）
+     */
+    fun variance(): DataFrame = aggregateAll(AggOp.VAR, numericOnly = true)
+    
+    /**
+     * 计数（非空值个数）
+     */
+    fun count(): DataFrame = aggregateAll(AggOp.COUNT, numericOnly = false)
+    
+    /**
+     * 最小值
+     */
+    fun min(): DataFrame = aggregateAll(AggOp.MIN, numericOnly = false)
+    
+    /**
+     * 最大值
+     */
+    fun max(): DataFrame = aggregateAll(AggOp.MAX, numericOnly = false)
+    
+    /**
+     * 每组第一个非空值
+     */
+    fun first(): DataFrame = aggregateAll(AggOp.FIRST, numericOnly = false)
+    
+    /**
+     * 每组最后一个非空值
+     */
+    fun last(): DataFrame = aggregateAll(AggOp.LAST, numericOnly = false)
+    
+    /**
+     * 分层采样：每组不放回地随机取 n 行，不足 n 行的组全部取出
+     * 组按首次出现的顺序排列，组内按抽取顺序，保留原索引标签；分组键含空值的行不参与
+     *
+     * @param seed 随机种子，相同种子得到相同的样本；为 null 时随机选取
+     */
+    fun sample(n: Int, seed: Long? = null): DataFrame = stratifiedSample(maxOf(n, 0), 0.0, seed)
+    
+    /**
+     * 分层采样：每组取 round(fraction * 组大小) 行
+     */
+    fun sample(fraction: Double, seed: Long? = null): DataFrame {
+        SamplingEngine.checkFraction(fraction)
+        return stratifiedSample(-1, fraction, seed)
     }
     
     /**
-     * 计数
+     * 每组的行数
      */
-    fun count(): DataFrame {
-        return agg(groupCols.associateWith { "count" })
+    fun size(): Map<List<Any?>, Long> {
+        val (keyEncodings, result) = execute(emptyList(), emptyList())
+        return (0 until result.groupCount).associate { g ->
+            decodeKey(keyEncodings, result, g) to result.sizes[g]
+        }
+    }
+    
+    private fun stratifiedSample(count: Int, fraction: Double, seed: Long?): DataFrame {
+        val keys = keyEncodings().map { it.codes }
+        val rows = SamplingEngine.stratifiedSampleIndices(keys.toTypedArray(), count, fraction, SamplingEngine.seedOf(seed))
+        return df.takeRows(rows)
+    }
+    
+    private fun aggregateAll(op: AggOp, numericOnly: Boolean): DataFrame {
+        val valueCols = df.columns().filter { colName ->
+            colName !in groupCols &&
+                (!numericOnly || df[colName].values().all { it == null || it is Number })
+        }
+        return aggregate(valueCols.map { it to op })
+    }
+    
+    private fun aggregate(specs: List<Pair<String, AggOp>>): DataFrame {
+        specs.forEach { (colName, _) ->
+            if (colName !in df.columns()) throw IllegalArgumentException("列不存在: $colName")
+        }
+        val valueCols = specs.map { it.first }.distinct()
+        val valueEncodings = valueCols.map { GroupValueEncoding.encode(df[it].values()) }
+        val aggregations = specs.map { (colName, op) -> valueCols.indexOf(colName) to op }
+        val (keyEncodings, result) = execute(valueEncodings, aggregations)
+        
+        val resultData = LinkedHashMap<String, List<Any?>>()
+        groupCols.forEachIndexed { c, colName ->
+            val encoding = keyEncodings[c]
+            resultData[colName] = result.keys[c].map { encoding.decode(it) }
+        }
+        specs.forEachIndexed { s, (colName, op) ->
+            val encoding = valueEncodings[aggregations[s].first]
+            val values = result.aggregates[s]
+            val outName = if (colName in groupCols) "${colName}_${op.name.lowercase()}" else colName
+            resultData[outName] = when (op) {
+                AggOp.COUNT -> values.map { it.toInt() }
+                AggOp.SUM, AggOp.MEAN, AggOp.VAR ->
+                    if (encoding.numeric) values.map { if (it.isNaN()) null else it } else values.map { null }
+                AggOp.MIN, AggOp.MAX, AggOp.FIRST, AggOp.LAST -> values.map { encoding.decode(it) }
+            }
+        }
+        if (byIndex) {
+            // 分组标签作为结果的索引
+            val labels = Index.of(result.keys[0].map { keyEncodings[0].decode(it)!! })
+            val series = resultData.mapValues { (colName, values) -> Series<Any>(values, labels, colName) }
+            return DataFrame(series, resultData.keys.toList())
+        }
+        return DataFrame(resultData)
+    }
+    
+    private fun execute(
+        valueEncodings: List<GroupValueEncoding>,
+        aggregations: List<Pair<Int, AggOp>>
+    ): Pair<List<GroupKeyEncoding>, GroupByResult> {
+        val keyEncodings = keyEncodings()
+        val result = GroupByEngine.aggregate(
+            keyEncodings.map { it.codes }.toTypedArray(),
+            valueEncodings.map { it.values }.toTypedArray(),
+            aggregations
+        )
+        return keyEncodings to result
+    }
+    
+    private fun keyEncodings(): List<GroupKeyEncoding> {
+        if (byIndex) return listOf(GroupKeyEncoding.ofIndex(df.index()))
+        if (groupCols.isEmpty()) throw IllegalArgumentException("至少需要一个分组列")
+        return groupCols.map { colName ->
+            if (colName !in df.columns()) throw IllegalArgumentException("列不存在: $colName")
+            GroupKeyEncoding.encode(df[colName].values())
+        }
+    }
+    
+    private fun decodeKey(keyEncodings: List<GroupKeyEncoding>, result: GroupByResult, group: Int): List<Any?> {
+        return keyEncodings.mapIndexed { c, encoding -> encoding.decode(result.keys[c][group]) }
     }
 }
 
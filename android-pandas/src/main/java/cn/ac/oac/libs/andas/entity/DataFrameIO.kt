@@ -1,14 +1,17 @@
 package cn.ac.oac.libs.andas.entity
 
-import java.io.BufferedReader
+import cn.ac.oac.libs.andas.core.CsvColumnBuilder
+import cn.ac.oac.libs.andas.core.CsvOptions
+import cn.ac.oac.libs.andas.core.CsvReader
+import cn.ac.oac.libs.andas.core.CsvStream
 import java.io.File
+import java.io.IOException
 import java.io.InputStream
-import java.io.InputStreamReader
 
 object DataFrameIO {
 
     /**
-     * 从Assets读取CSV文件
+     * 从Assets读取CSV文件，按块流式解析，不会把整个文件读成行列表
      */
     fun readFromAssets(
         assetManager: android.content.res.AssetManager,
@@ -19,103 +22,13 @@ object DataFrameIO {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        sampleRows: Int = 1000
     ): DataFrame {
         return try {
-            val inputStream = assetManager.open(filePath)
-            val reader = BufferedReader(InputStreamReader(inputStream, encoding))
-            val lines = reader.readLines()
-            reader.close()
-
-            // 手动解析，因为File对象不可用
-            if (lines.isEmpty()) {
-                return DataFrame(emptyList<Map<String, Any?>>())
-            }
-
-            // 跳过指定行数
-            val effectiveLines = lines.drop(skipLines)
-            if (effectiveLines.isEmpty()) {
-                return DataFrame(emptyList<Map<String, Any?>>())
-            }
-
-            val firstLine = effectiveLines.first()
-            val headers: List<String>
-            val dataLines: List<String>
-
-            if (header) {
-                headers = DataFrame.parseCSVLine(firstLine, delimiter, trimValues)
-                dataLines = effectiveLines.drop(1)
-            } else {
-                val firstLineValues = DataFrame.parseCSVLine(firstLine, delimiter, trimValues)
-                headers = firstLineValues.indices.map { "col$it" }
-                dataLines = effectiveLines
-            }
-
-            if (headers.isEmpty()) {
-                throw IllegalArgumentException("解析失败: 未找到有效的列名")
-            }
-
-            // 预先推断每列的数据类型（只使用第一行数据）
-            val columnTypes = mutableMapOf<String, (String) -> Any?>()
-            if (autoType && dataLines.isNotEmpty()) {
-                val firstLineValues = DataFrame.parseCSVLine(dataLines.first(), delimiter, trimValues)
-                val adjustedFirstValues = if (firstLineValues.size < headers.size) {
-                    firstLineValues + List(headers.size - firstLineValues.size) { "" }
-                } else if (firstLineValues.size > headers.size) {
-                    firstLineValues.take(headers.size)
-                } else {
-                    firstLineValues
-                }
-
-                headers.forEachIndexed { index, header ->
-                    val firstValue = adjustedFirstValues.getOrNull(index) ?: ""
-                    // 为每列创建一个转换函数，基于第一个值推断类型
-                    val inferredType = DataFrame.inferTypeFromSample(firstValue, nullValues)
-                    columnTypes[header] = { value ->
-                        if (value in nullValues) null
-                        else DataFrame.convertValueWithType(value, inferredType)
-                    }
-                }
+            assetManager.open(filePath).use { input ->
+                readCSV(input, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues, sampleRows)
             }
-
-            val rows = dataLines.mapIndexed { lineIndex, line ->
-                try {
-                    val values = DataFrame.parseCSVLine(line, delimiter, trimValues)
-
-                    // 处理列数不匹配的情况
-                    val adjustedValues = if (values.size < headers.size) {
-                        values + List(headers.size - values.size) { "" }
-                    } else if (values.size > headers.size) {
-                        values.take(headers.size)
-                    } else {
-                        values
-                    }
-
-                    val rowMap = headers.zip(adjustedValues).toMap()
-
-                    if (autoType) {
-                        // 使用预先推断的类型进行转换
-                        rowMap.mapValues { (key, value) ->
-                            val converter = columnTypes[key]
-                            if (converter != null) {
-                                converter(value)
-                            } else {
-                                // 如果没有推断出类型，使用原始值
-                                if (value in nullValues) null else value
-                            }
-                        }
-                    } else {
-                        // 不进行类型转换，但处理空值
-                        rowMap.mapValues { (_, value) ->
-                            if (value in nullValues) null else value
-                        }
-                    }
-                } catch (e: Exception) {
-                    throw RuntimeException("解析第 ${lineIndex + skipLines + (if (header) 2 else 1)} 行失败: $line", e)
-                }
-            }
-
-            DataFrame(rows)
         } catch (e: Exception) {
             throw RuntimeException("从Assets读取文件失败: ${e.message}", e)
         }
@@ -132,13 +45,20 @@ object DataFrameIO {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        sampleRows: Int = 1000,
+        categorical: Boolean = false
     ): DataFrame {
-        return DataFrame.readCSV(file, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+        return DataFrame.readCSV(
+            file, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues, sampleRows, categorical
+        )
     }
 
     /**
-     * 从CSV数据流读取（静态方法）
+     * 从CSV数据流读取（静态方法），按块流式解析，不会关闭 inputStream
+     *
+     * @param sampleRows 预先推断类型的样本行数，后面出现放不下的值时整列提升类型
+     * @param categorical 字符串列按字典编码读取，见 [Series.asCategorical]
      */
     fun readCSV(
         inputStream: InputStream,
@@ -148,107 +68,23 @@ object DataFrameIO {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        sampleRows: Int = 1000,
+        categorical: Boolean = false
     ): DataFrame {
-        val lines = try {
-            val reader = BufferedReader(InputStreamReader(inputStream, encoding))
-            reader.readLines()
-        } catch (e: Exception) {
+        val options = csvOptions(
+            delimiter, header, autoType, encoding, skipLines, nullValues, trimValues, sampleRows, categorical
+        )
+        return try {
+            CsvReader.open(inputStream, options).use { readCSVStream(it) }
+        } catch (e: IOException) {
             throw RuntimeException("读取数据流失败: ${e.message}", e)
         }
-
-        if (lines.isEmpty()) {
-            return DataFrame(emptyList<Map<String, Any?>>())
-        }
-
-        // 跳过指定行数
-        val effectiveLines = lines.drop(skipLines)
-        if (effectiveLines.isEmpty()) {
-            return DataFrame(emptyList<Map<String, Any?>>())
-        }
-
-        // 解析表头
-        val firstLine = effectiveLines.first()
-        val headers: List<String>
-        val dataLines: List<String>
-
-        if (header) {
-            headers = DataFrame.parseCSVLine(firstLine, delimiter, trimValues)
-            dataLines = effectiveLines.drop(1)
-        } else {
-            val firstLineValues = DataFrame.parseCSVLine(firstLine, delimiter, trimValues)
-            headers = firstLineValues.indices.map { "col$it" }
-            dataLines = effectiveLines
-        }
-
-        if (headers.isEmpty()) {
-            throw IllegalArgumentException("解析失败: 未找到有效的列名")
-        }
-
-        // 预先推断每列的数据类型（只使用第一行数据）
-        val columnTypes = mutableMapOf<String, (String) -> Any?>()
-        if (autoType && dataLines.isNotEmpty()) {
-            val firstLineValues = DataFrame.parseCSVLine(dataLines.first(), delimiter, trimValues)
-            val adjustedFirstValues = if (firstLineValues.size < headers.size) {
-                firstLineValues + List(headers.size - firstLineValues.size) { "" }
-            } else if (firstLineValues.size > headers.size) {
-                firstLineValues.take(headers.size)
-            } else {
-                firstLineValues
-            }
-
-            headers.forEachIndexed { index, header ->
-                val firstValue = adjustedFirstValues.getOrNull(index) ?: ""
-                val inferredType = DataFrame.inferTypeFromSample(firstValue, nullValues)
-                columnTypes[header] = { value ->
-                    if (value in nullValues) null
-                    else DataFrame.convertValueWithType(value, inferredType)
-                }
-            }
-        }
-
-        val rows = dataLines.mapIndexed { lineIndex, line ->
-            try {
-                val values = DataFrame.parseCSVLine(line, delimiter, trimValues)
-
-                // 处理列数不匹配的情况
-                val adjustedValues = if (values.size < headers.size) {
-                    values + List(headers.size - values.size) { "" }
-                } else if (values.size > headers.size) {
-                    values.take(headers.size)
-                } else {
-                    values
-                }
-
-                val rowMap = headers.zip(adjustedValues).toMap()
-
-                if (autoType) {
-                    // 使用预先推断的类型进行转换
-                    rowMap.mapValues { (key, value) ->
-                        val converter = columnTypes[key]
-                        if (converter != null) {
-                            converter(value)
-                        } else {
-                            // 如果没有推断出类型，使用原始值
-                            if (value in nullValues) null else value
-                        }
-                    }
-                } else {
-                    // 不进行类型转换，但处理空值
-                    rowMap.mapValues { (_, value) ->
-                        if (value in nullValues) null else value
-                    }
-                }
-            } catch (e: Exception) {
-                throw RuntimeException("解析第 ${lineIndex + skipLines + (if (header) 2 else 1)} 行失败: $line", e)
-            }
-        }
-
-        return DataFrame(rows)
     }
 
     /**
      * 分批读取CSV文件（用于大数据处理）- 回调版本
+     * 流式读取，任意时刻只保留一批数据；每批的列类型不窄于之前的批次
      *
      * @param inputStream CSV数据流
      * @param batchSize 批处理大小
@@ -273,116 +109,77 @@ object DataFrameIO {
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
         trimValues: Boolean = true
     ) {
-        val lines = try {
-            val reader = BufferedReader(InputStreamReader(inputStream, encoding))
-            reader.readLines()
-        } catch (e: Exception) {
-            throw RuntimeException("读取数据流失败: ${e.message}", e)
-        }
-
-        if (lines.isEmpty()) {
-            return
-        }
-
-        // 跳过指定行数
-        val effectiveLines = lines.drop(skipLines)
-        if (effectiveLines.isEmpty()) {
-            return
-        }
-
-        // 解析表头
-        val firstLine = effectiveLines.first()
-        val headers: List<String>
-        val dataLines: List<String>
-
-        if (header) {
-            headers = DataFrame.parseCSVLine(firstLine, delimiter, trimValues)
-            dataLines = effectiveLines.drop(1)
-        } else {
-            val firstLineValues = DataFrame.parseCSVLine(firstLine, delimiter, trimValues)
-            headers = firstLineValues.indices.map { "col$it" }
-            dataLines = effectiveLines
+        if (batchSize <= 0) {
+            throw IllegalArgumentException("批大小必须为正数: $batchSize")
         }
-
-        if (headers.isEmpty()) {
-            throw IllegalArgumentException("解析失败: 未找到有效的列名")
-        }
-
-        // 预先推断每列的数据类型（只使用第一行数据）
-        val columnTypes = mutableMapOf<String, (String) -> Any?>()
-        if (autoType && dataLines.isNotEmpty()) {
-            val firstLineValues = DataFrame.parseCSVLine(dataLines.first(), delimiter, trimValues)
-            val adjustedFirstValues = if (firstLineValues.size < headers.size) {
-                firstLineValues + List(headers.size - firstLineValues.size) { "" }
-            } else if (firstLineValues.size > headers.size) {
-                firstLineValues.take(headers.size)
-            } else {
-                firstLineValues
-            }
-
-            headers.forEachIndexed { index, header ->
-                val firstValue = adjustedFirstValues.getOrNull(index) ?: ""
-                val inferredType = DataFrame.inferTypeFromSample(firstValue, nullValues)
-                columnTypes[header] = { value ->
-                    if (value in nullValues) null
-                    else DataFrame.convertValueWithType(value, inferredType)
-                }
-            }
-        }
-
-        // 分批处理数据
-        var currentBatch = mutableListOf<Map<String, Any?>>()
-
-        dataLines.forEachIndexed { lineIndex, line ->
-            try {
-                val values = DataFrame.parseCSVLine(line, delimiter, trimValues)
-
-                // 处理列数不匹配的情况
-                val adjustedValues = if (values.size < headers.size) {
-                    values + List(headers.size - values.size) { "" }
-                } else if (values.size > headers.size) {
-                    values.take(headers.size)
-                } else {
-                    values
-                }
-
-                val rowMap = headers.zip(adjustedValues).toMap()
-
-                val processedRow = if (autoType) {
-                    rowMap.mapValues { (key, value) ->
-                        val converter = columnTypes[key]
-                        if (converter != null) {
-                            converter(value)
-                        } else {
-                            if (value in nullValues) null else value
-                        }
+        val options = csvOptions(delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+        try {
+            CsvReader.open(inputStream, options).use { stream ->
+                val names = stream.columnNames
+                if (names.isEmpty()) return
+                // 原生读取器的一批可能少于 batchSize 行，凑满后再回调
+                var builder = CsvColumnBuilder(names.size)
+                while (true) {
+                    val batch = stream.nextBatch(batchSize - builder.rowCount)
+                    if (batch != null) builder.append(batch)
+                    if (builder.rowCount == batchSize || (batch == null && builder.rowCount > 0)) {
+                        callback(toDataFrame(names, builder.columns))
+                        builder = CsvColumnBuilder(names.size)
                     }
-                } else {
-                    rowMap.mapValues { (_, value) ->
-                        if (value in nullValues) null else value
-                    }
-                }
-
-                currentBatch.add(processedRow)
-
-                // 当批次达到指定大小时，调用回调函数
-                if (currentBatch.size >= batchSize) {
-                    callback(DataFrame(currentBatch))
-                    currentBatch.clear()
+                    if (batch == null) break
                 }
-            } catch (e: Exception) {
-                throw RuntimeException("解析第 ${lineIndex + skipLines + (if (header) 2 else 1)} 行失败: $line", e)
             }
+        } catch (e: IOException) {
+            throw RuntimeException("读取数据流失败: ${e.message}", e)
         }
+    }
 
-        // 处理剩余数据
-        if (currentBatch.isNotEmpty()) {
-            callback(DataFrame(currentBatch))
+    /**
+     * 由读取参数构造CSV选项，分隔符取第一个字符
+     */
+    internal fun csvOptions(
+        delimiter: String,
+        header: Boolean,
+        autoType: Boolean,
+        encoding: String,
+        skipLines: Int,
+        nullValues: List<String>,
+        trimValues: Boolean,
+        sampleRows: Int = 1000,
+        categorical: Boolean = false
+    ): CsvOptions {
+        if (delimiter.isEmpty()) {
+            throw IllegalArgumentException("分隔符不能为空")
         }
+        return CsvOptions(
+            delimiter = delimiter[0],
+            header = header,
+            skipLines = skipLines,
+            trim = trimValues,
+            autoType = autoType,
+            nullValues = nullValues,
+            encoding = encoding,
+            sampleRows = sampleRows,
+            categorical = categorical
+        )
     }
 
- 
+    /**
+     * 读完CSV流并构造DataFrame；输入中连表头都没有时返回空DataFrame
+     */
+    internal fun readCSVStream(stream: CsvStream): DataFrame {
+        val names = stream.columnNames
+        if (names.isEmpty()) {
+            return DataFrame(emptyList<Map<String, Any?>>())
+        }
+        return toDataFrame(names, CsvReader.readAll(stream))
+    }
 
+    private fun toDataFrame(names: List<String>, columns: List<List<Any?>>): DataFrame {
+        val data = LinkedHashMap<String, List<Any?>>()
+        names.forEachIndexed { i, name -> data[name] = columns[i] }
+        return DataFrame(data)
+    }
 
     /**
      * 导出到CSV文件（静态方法）
@@ -391,6 +188,41 @@ object DataFrameIO {
         df.toCSV(file)
     }
 
+    /**
+     * 保存为二进制列式文件（静态方法）
+     */
+    fun toColumnar(df: DataFrame, file: File) {
+        df.toColumnar(file)
+    }
+
+    /**
+     * 读取二进制列式文件（静态方法），文件被内存映射，不做解析
+     */
+    fun readColumnar(file: File): DataFrame {
+        return DataFrame.readColumnar(file)
+    }
+
+    /**
+     * 以二进制列式格式保存到应用私有目录，适合作为启动时需要快速重新加载的缓存
+     */
+    fun saveColumnarToPrivateStorage(
+        context: android.content.Context,
+        fileName: String,
+        df: DataFrame
+    ) {
+        df.toColumnar(File(context.filesDir, fileName))
+    }
+
+    /**
+     * 从应用私有目录读取二进制列式文件
+     */
+    fun readColumnarFromPrivateStorage(
+        context: android.content.Context,
+        fileName: String
+    ): DataFrame {
+        return DataFrame.readColumnar(File(context.filesDir, fileName))
+    }
+
     /**
      * 从应用私有目录读取CSV文件
      */
@@ -0,0 +1,352 @@
+package cn.ac.oac.libs.andas.entity
+
+import cn.ac.oac.libs.andas.core.IndexEngine
+import cn.ac.oac.libs.andas.core.LabelHashTable
+
+/**
+ * 行索引：位置到标签的只读列表，另外提供按标签查找位置和按标签区间切片，标签只能是 Int 或 String
+ * - [RangeIndex]：连续的整数标签（默认的 0 until n），不存储标签，查找是算术运算
+ * - Int 标签存为 IntArray，String（或混合）标签存为列表
+ * - 第一次按标签查找时才建哈希表（原生层），之后每次查找 O(1)；单调性第一次使用时计算，单调的索引按二分查找切片
+ *
+ * 索引不可变，同一 DataFrame 的各列以及 head/tail/筛选得到的子表共享索引，不复制
+ */
+abstract class Index internal constructor() : AbstractList<Any>(), RandomAccess {
+
+    /**
+     * 没有重复的标签
+     */
+    abstract val isUnique: Boolean
+
+    /**
+     * 标签单调不减
+     */
+    val isMonotonicIncreasing: Boolean get() = monotonic.first
+
+    /**
+     * 标签单调不增
+     */
+    val isMonotonicDecreasing: Boolean get() = monotonic.second
+
+    private val monotonic: Pair<Boolean, Boolean> by lazy { computeMonotonic() }
+
+    /**
+     * 标签第一次出现的位置，不存在时返回 -1
+     */
+    abstract fun positionOf(label: Any?): Int
+
+    /**
+     * 标签出现的全部位置（升序）
+     */
+    abstract fun positionsOf(label: Any?): IntArray
+
+    override fun indexOf(element: Any): Int = positionOf(element)
+
+    override fun lastIndexOf(element: Any): Int = positionsOf(element).lastOrNull() ?: -1
+
+    override fun contains(element: Any): Boolean = positionOf(element) >= 0
+
+    /**
+     * 标签区间 [start, end]（含两端，同 pandas 的 loc[start:end]）对应的位置区间，null 表示不限
+     * 单调的索引按二分查找，端点标签可以不存在；非单调的索引要求端点标签存在且唯一
+     *
+     * @throws NoSuchElementException 非单调索引中端点标签不存在
+     * @throws IllegalArgumentException 端点标签与索引类型不一致，或非单调索引中端点标签重复
+     */
+    fun sliceLocs(start: Any?, end: Any?): IntRange {
+        if (size == 0) return 0 until 0
+        val from: Int
+        val until: Int
+        when {
+            isMonotonicIncreasing -> {
+                from = if (start == null) 0 else bound { compareAt(it, start) >= 0 }
+                until = if (end == null) size else bound { compareAt(it, end) > 0 }
+            }
+            isMonotonicDecreasing -> {
+                from = if (start == null) 0 else bound { compareAt(it, start) <= 0 }
+                until = if (end == null) size else bound { compareAt(it, end) < 0 }
+            }
+            else -> {
+                from = if (start == null) 0 else uniquePosition(start)
+                until = if (end == null) size else uniquePosition(end) + 1
+            }
+        }
+        return from until maxOf(from, until)
+    }
+
+    /**
+     * 按位置取出子索引
+     */
+    internal abstract fun take(positions: IntArray): Index
+
+    /**
+     * 位置区间 [from, until) 的子索引，与原索引共享存储
+     */
+    internal abstract fun slice(from: Int, until: Int): Index
+
+    /**
+     * 批量查找每个标签第一次出现的位置，不存在时为 -1
+     */
+    internal abstract fun lookup(labels: List<Any?>): IntArray
+
+    /**
+     * 标签是否全部为 Int
+     */
+    internal abstract val intLabels: Boolean
+
+    /**
+     * 每个位置的分组编码，标签相同当且仅当编码相同：Int 标签为标签本身，其他为标签第一次出现的位置
+     */
+    internal abstract fun groupCodes(): LongArray
+
+    protected open fun computeMonotonic(): Pair<Boolean, Boolean> {
+        var increasing = true
+        var decreasing = true
+        for (i in 1 until size) {
+            val order = compareLabels(get(i - 1), get(i))
+            if (order > 0) increasing = false
+            if (order < 0) decreasing = false
+            if (!increasing && !decreasing) break
+        }
+        return increasing to decreasing
+    }
+
+    private fun compareAt(position: Int, label: Any): Int = compareLabels(get(position), label)
+
+    // 第一个满足 predicate 的位置，predicate 随位置单调
+    private inline fun bound(predicate: (Int) -> Boolean): Int {
+        var lo = 0
+        var hi = size
+        while (lo < hi) {
+            val mid = (lo + hi) ushr 1
+            if (predicate(mid)) hi = mid else lo = mid + 1
+        }
+        return lo
+    }
+
+    private fun uniquePosition(label: Any): Int {
+        val positions = positionsOf(label)
+        if (positions.isEmpty()) throw NoSuchElementException("未找到索引: $label")
+        if (positions.size > 1) throw IllegalArgumentException("索引不是单调的，区间端点的标签必须唯一: $label")
+        return positions[0]
+    }
+
+    companion object {
+        /**
+         * 0 until size 的默认索引
+         */
+        fun range(size: Int): Index = RangeIndex(0, size)
+
+        /**
+         * 由标签列表创建索引，已经是 Index 时直接共享；连续的整数标签存为 [RangeIndex]
+         *
+         * @throws IllegalArgumentException 标签不是 Int 或 String
+         */
+        fun of(labels: List<Any>): Index {
+            if (labels is Index) return labels
+            var allInt = true
+            for (label in labels) {
+                when (label) {
+                    is Int -> continue
+                    is String -> allInt = false
+                    else -> throw IllegalArgumentException("索引类型必须是Int或String，但得到了: ${label::class.simpleName}")
+                }
+            }
+            if (allInt) return ofInts(IntArray(labels.size) { labels[it] as Int })
+            return ObjectIndex(labels.toList())
+        }
+
+        internal fun ofInts(values: IntArray): Index {
+            val consecutive = values.indices.all { values[it] == values[0] + it }
+            if (values.isNotEmpty() && consecutive && values[0].toLong() + values.size <= Int.MAX_VALUE) {
+                return RangeIndex(values[0], values[0] + values.size)
+            }
+            return IntIndex(values, 0, values.size)
+        }
+
+        /**
+         * 两个标签的顺序，Int 与 Int、String 与 String 之间才可比较
+         */
+        internal fun compareLabels(a: Any, b: Any): Int {
+            return when {
+                a is Int && b is Int -> a.compareTo(b)
+                a is String && b is String -> a.compareTo(b)
+                else -> throw IllegalArgumentException("索引标签类型不一致: ${a::class.simpleName} 与 ${b::class.simpleName}")
+            }
+        }
+    }
+}
+
+/**
+ * 连续整数标签 [start, stop) 的索引，不存储标签
+ */
+class RangeIndex internal constructor(val start: Int, val stop: Int) : Index() {
+
+    override val size: Int get() = stop - start
+
+    override val isUnique: Boolean get() = true
+
+    override fun get(index: Int): Any {
+        if (index < 0 || index >= size) throw IndexOutOfBoundsException("索引越界: $index")
+        return start + index
+    }
+
+    override fun positionOf(label: Any?): Int {
+        return if (label is Int && label >= start && label < stop) label - start else -1
+    }
+
+    override fun positionsOf(label: Any?): IntArray {
+        val position = positionOf(label)
+        return if (position >= 0) intArrayOf(position) else IntArray(0)
+    }
+
+    override fun take(positions: IntArray): Index = ofInts(IntArray(positions.size) { start + positions[it] })
+
+    override fun slice(from: Int, until: Int): Index {
+        if (from == 0 && until == size) return this
+        return RangeIndex(start + from, start + until)
+    }
+
+    override fun lookup(labels: List<Any?>): IntArray {
+        if (labels is Index && labels.intLabels) {
+            val codes = labels.groupCodes()
+            return IntArray(codes.size) { i -> if (codes[i] >= start && codes[i] < stop) (codes[i] - start).toInt() else -1 }
+        }
+        return IntArray(labels.size) { positionOf(labels[it]) }
+    }
+
+    override val intLabels: Boolean get() = true
+
+    override fun groupCodes(): LongArray = LongArray(size) { (start + it).toLong() }
+
+    override fun computeMonotonic(): Pair<Boolean, Boolean> = true to (size <= 1)
+}
+
+/**
+ * Int 标签的索引，切片与原索引共享数组
+ */
+internal class IntIndex(
+    private val values: IntArray,
+    private val offset: Int,
+    private val length: Int
+) : Index() {
+
+    private val table: LabelHashTable by lazy { IndexEngine.build(groupCodes()) }
+
+    override val size: Int get() = length
+
+    override val isUnique: Boolean get() = table.isUnique
+
+    override fun get(index: Int): Any {
+        if (index < 0 || index >= length) throw IndexOutOfBoundsException("索引越界: $index")
+        return values[offset + index]
+    }
+
+    override fun positionOf(label: Any?): Int {
+        if (label !is Int) return -1
+        return table.first(label.toLong())
+    }
+
+    override fun positionsOf(label: Any?): IntArray {
+        val positions = ArrayList<Int>()
+        var p = positionOf(label)
+        while (p >= 0) {
+            positions.add(p)
+            p = table.next(p)
+        }
+        return positions.toIntArray()
+    }
+
+    override fun take(positions: IntArray): Index = ofInts(IntArray(positions.size) { values[offset + positions[it]] })
+
+    override fun slice(from: Int, until: Int): Index {
+        if (from == 0 && until == length) return this
+        return IntIndex(values, offset + from, until - from)
+    }
+
+    override fun lookup(labels: List<Any?>): IntArray {
+        if (labels is Index && labels.intLabels) return table.lookup(labels.groupCodes())
+        // 非 Int 标签的探测键超出 Int 范围，不会命中
+        return table.lookup(LongArray(labels.size) { (labels[it] as? Int)?.toLong() ?: Long.MIN_VALUE })
+    }
+
+    override val intLabels: Boolean get() = true
+
+    override fun groupCodes(): LongArray = LongArray(length) { values[offset + it].toLong() }
+
+    override fun computeMonotonic(): Pair<Boolean, Boolean> {
+        var increasing = true
+        var decreasing = true
+        for (i in offset + 1 until offset + length) {
+            if (values[i - 1] > values[i]) increasing = false
+            if (values[i - 1] < values[i]) decreasing = false
+        }
+        return increasing to decreasing
+    }
+}
+
+/**
+ * String（或 Int 与 String 混合）标签的索引：哈希表以标签的 64 位哈希为键，查找时核对标签本身
+ */
+internal class ObjectIndex(private val labels: List<Any>) : Index() {
+
+    private val table: LabelHashTable by lazy { IndexEngine.build(LongArray(labels.size) { keyOf(labels[it]) }) }
+
+    override val size: Int get() = labels.size
+
+    // 哈希相同的不同标签会让哈希表认为有重复，此时再按标签本身确认
+    override val isUnique: Boolean by lazy { table.isUnique || labels.toHashSet().size == labels.size }
+
+    override fun get(index: Int): Any = labels[index]
+
+    override fun positionOf(label: Any?): Int {
+        if (label !is Int && label !is String) return -1
+        var p = table.first(keyOf(label))
+        while (p >= 0 && labels[p] != label) p = table.next(p)
+        return p
+    }
+
+    override fun positionsOf(label: Any?): IntArray {
+        val positions = ArrayList<Int>()
+        var p = positionOf(label)
+        while (p >= 0) {
+            if (labels[p] == label) positions.add(p)
+            p = table.next(p)
+        }
+        return positions.toIntArray()
+    }
+
+    override fun take(positions: IntArray): Index = ObjectIndex(positions.map { labels[it] })
+
+    override fun slice(from: Int, until: Int): Index {
+        if (from == 0 && until == labels.size) return this
+        return ObjectIndex(labels.subList(from, until))
+    }
+
+    override fun lookup(labels: List<Any?>): IntArray {
+        val probes = LongArray(labels.size) { i -> labels[i]?.let { keyOf(it) } ?: 0L }
+        val found = table.lookup(probes)
+        for (i in found.indices) {
+            // 哈希命中但标签不同（碰撞或类型不同）时沿链查找
+            if (found[i] >= 0 && this.labels[found[i]] != labels[i]) found[i] = positionOf(labels[i])
+        }
+        return found
+    }
+
+    override val intLabels: Boolean get() = false
+
+    override fun groupCodes(): LongArray {
+        val firsts = table.firstPositions()
+        return LongArray(labels.size) { i ->
+            val first = firsts[i]
+            (if (labels[first] == labels[i]) first else positionOf(labels[i])).toLong()
+        }
+    }
+
+    override fun computeMonotonic(): Pair<Boolean, Boolean> {
+        if (labels.any { it !is String }) return (labels.size <= 1) to (labels.size <= 1)
+        return super.computeMonotonic()
+    }
+
+    private fun keyOf(label: Any): Long = if (label is String) IndexEngine.stringKey(label) else (label as Int).toLong()
+}
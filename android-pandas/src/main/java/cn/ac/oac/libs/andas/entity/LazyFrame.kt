@@ -0,0 +1,327 @@
+package cn.ac.oac.libs.andas.entity
+
+import cn.ac.oac.libs.andas.core.CsvBatch
+import cn.ac.oac.libs.andas.core.CsvColumnBuilder
+import cn.ac.oac.libs.andas.core.CsvOptions
+import cn.ac.oac.libs.andas.core.CsvReader
+import cn.ac.oac.libs.andas.core.CsvStream
+import cn.ac.oac.libs.andas.core.Expr
+import cn.ac.oac.libs.andas.core.ExprCompiler
+import cn.ac.oac.libs.andas.core.ExprOp
+import cn.ac.oac.libs.andas.core.ExprParser
+import cn.ac.oac.libs.andas.core.FilterEngine
+import cn.ac.oac.libs.andas.core.PipelineEngine
+import cn.ac.oac.libs.andas.core.PipelineResult
+import cn.ac.oac.libs.andas.core.PlanNode
+import cn.ac.oac.libs.andas.core.Predicate
+import cn.ac.oac.libs.andas.core.QueryOptimizer
+import cn.ac.oac.libs.andas.core.ScanSource
+import cn.ac.oac.libs.andas.core.col
+import cn.ac.oac.libs.andas.types.AndaTypes
+import java.io.File
+import java.io.IOException
+import java.io.InputStream
+
+/**
+ * 延迟执行的 DataFrame：操作只记录到逻辑查询计划中，[collect] 时优化后执行
+ *
+ * 优化包括谓词下推、投影裁剪（CSV 只解析用到的列）和逐元素运算融合；
+ * 相邻的筛选和逐元素运算在原生流水线中按缓存大小的数据块一次完成，中间结果不生成完整的列。
+ * 分组聚合是流水线的终点，交给哈希分组引擎
+ *
+ * 与对应的 DataFrame 方法不同，这里的数值运算结果与原行对齐：缺失值参与运算时结果为缺失值，
+ * [normalize] 的均值和标准差只统计非缺失值
+ *
+ * 例：`DataFrame.readCSV(file)` 可换成
+ * `LazyFrame.scanCsv(file).filterGreaterThan("price", 10.0).fillNull("qty", 0.0).groupBySum("city", "qty").collect()`
+ */
+class LazyFrame internal constructor(private val plan: PlanNode) {
+
+    /**
+     * 输出列名，数据源为未知表头的数据流时为 null
+     */
+    fun columns(): List<String>? = plan.schema()
+
+    /**
+     * 按条件表达式筛选行，保留原索引标签
+     */
+    fun filter(predicate: Predicate): LazyFrame {
+        requireColumns(predicate.columns())
+        return LazyFrame(PlanNode.Filter(plan, predicate))
+    }
+
+    fun filterGreaterThan(colName: String, threshold: Double): LazyFrame = filter(col(colName) gt threshold)
+
+    /**
+     * 数值列的缺失值填充为 value
+     */
+    fun fillNull(colName: String, value: Double): LazyFrame =
+        withColumn(colName, Expr.FillNull(Expr.Column(colName), Expr.Literal(value)))
+
+    /**
+     * 数值列标准化为 (x - 均值) / 总体标准差，统计量按这一步之前的行计算；标准差为 0 时非缺失值为 0
+     */
+    fun normalize(colName: String): LazyFrame = withColumn(colName, Expr.Normalize(Expr.Column(colName)))
+
+    fun vectorizedAdd(col1: String, col2: String, resultCol: String): LazyFrame =
+        withColumn(resultCol, Expr.Binary(ExprOp.ADD, Expr.Column(col1), Expr.Column(col2)))
+
+    fun vectorizedMultiply(col1: String, col2: String, resultCol: String): LazyFrame =
+        withColumn(resultCol, Expr.Binary(ExprOp.MUL, Expr.Column(col1), Expr.Column(col2)))
+
+    /**
+     * 按表达式字符串计算新列或替换已有列，语法见 [DataFrame.eval]，如 `withColumns("ratio" to "a / b")`
+     *
+     * 赋值依次生效，后面的表达式可以引用前面算出的列；优化器把它们融合为一次遍历
+     */
+    fun withColumns(vararg assignments: Pair<String, String>): LazyFrame =
+        assignments.fold(this) { frame, (name, expression) -> frame.withColumn(name, ExprParser.parse(expression)) }
+
+    fun selectColumns(vararg colNames: String): LazyFrame {
+        requireColumns(colNames.toList())
+        return LazyFrame(PlanNode.Select(plan, colNames.toList()))
+    }
+
+    fun groupBy(vararg groupCols: String): LazyGroupBy {
+        requireColumns(groupCols.toList())
+        return LazyGroupBy(plan, groupCols.toList())
+    }
+
+    fun groupBySum(groupCol: String, valueCol: String): LazyFrame = groupBy(groupCol).agg(mapOf(valueCol to "sum"))
+
+    /**
+     * 查询计划，子节点在下；optimized 为 true 时给出实际执行的计划
+     */
+    fun explain(optimized: Boolean = true): String =
+        (if (optimized) QueryOptimizer.optimize(plan) else plan).explain()
+
+    /**
+     * 执行查询计划；数据源是数据流时只能执行一次
+     */
+    fun collect(): DataFrame = LazyExecutor.execute(QueryOptimizer.optimize(plan))
+
+    override fun toString(): String = "LazyFrame\n${explain(optimized = false)}"
+
+    private fun withColumn(name: String, expr: Expr): LazyFrame {
+        requireColumns(expr.columns())
+        return LazyFrame(PlanNode.WithColumns(plan, linkedMapOf(name to expr)))
+    }
+
+    private fun requireColumns(names: Collection<String>) {
+        val schema = plan.schema() ?: return
+        val missing = names.filter { it !in schema }
+        if (missing.isNotEmpty()) {
+            throw IllegalArgumentException("不存在的列: $missing")
+        }
+    }
+
+    companion object {
+        /**
+         * 以已有 DataFrame 为数据源
+         */
+        fun of(df: DataFrame): LazyFrame = LazyFrame(PlanNode.Scan(DataFrameSource(df)))
+
+        /**
+         * 以 CSV 文件为数据源，立即读取表头；执行时只解析计划用到的列，筛选在读取每批时完成
+         */
+        fun scanCsv(file: File, options: CsvOptions = CsvOptions()): LazyFrame {
+            if (!file.exists()) {
+                throw IllegalArgumentException("文件不存在: ${file.absolutePath}")
+            }
+            val schema = options.columns?.takeIf { it.isNotEmpty() } ?: try {
+                CsvReader.open(file, options).use { it.columnNames }
+            } catch (e: IOException) {
+                throw RuntimeException("读取文件失败: ${e.message}", e)
+            }
+            return LazyFrame(PlanNode.Scan(CsvSource(file.name, options, schema) { CsvReader.open(file, it) }))
+        }
+
+        /**
+         * 以 CSV 数据流为数据源，表头在执行时才读取，只能执行一次，不会关闭 input
+         */
+        fun scanCsv(input: InputStream, options: CsvOptions = CsvOptions()): LazyFrame {
+            val schema = options.columns?.takeIf { it.isNotEmpty() }
+            return LazyFrame(PlanNode.Scan(CsvSource("stream", options, schema) { CsvReader.open(input, it) }))
+        }
+    }
+}
+
+/**
+ * 延迟执行的分组，结果与 [GroupBy] 相同
+ */
+class LazyGroupBy internal constructor(private val plan: PlanNode, private val groupCols: List<String>) {
+
+    /**
+     * 聚合操作：列名 -> 聚合类型（sum/mean/count/min/max/var/first/last）
+     */
+    fun agg(operations: Map<String, String>): LazyFrame {
+        val schema = plan.schema()
+        if (schema != null) {
+            val missing = operations.keys.filter { it !in schema }
+            if (missing.isNotEmpty()) {
+                throw IllegalArgumentException("不存在的列: $missing")
+            }
+        }
+        return LazyFrame(PlanNode.Aggregate(plan, groupCols, LinkedHashMap(operations)))
+    }
+
+    /**
+     * 所有数值列求和
+     */
+    fun sum(): LazyFrame = LazyFrame(PlanNode.Aggregate(plan, groupCols, null))
+}
+
+internal class DataFrameSource(val df: DataFrame) : ScanSource {
+    override val schema: List<String> get() = df.columns()
+
+    override fun describe() = "DataFrame(${df.shape().first} rows)"
+}
+
+internal class CsvSource(
+    private val label: String,
+    val options: CsvOptions,
+    override val schema: List<String>?,
+    val open: (CsvOptions) -> CsvStream
+) : ScanSource {
+    override fun describe() = "CSV($label)"
+}
+
+/**
+ * 执行优化后的查询计划
+ * 每个 WithColumns 连同它下面紧邻的 Filter 作为一段，在一次原生流水线调用中完成；
+ * CSV 数据源上的筛选在读取每批时完成，不保留未选中的行
+ */
+internal object LazyExecutor {
+
+    // 读取 CSV 时每批的最大行数
+    private const val SCAN_BATCH_ROWS = 1 shl 16
+
+    fun execute(node: PlanNode): DataFrame = when (node) {
+        is PlanNode.Scan -> scan(node, null)
+        is PlanNode.Filter -> {
+            val input = node.input
+            if (input is PlanNode.Scan && input.source is CsvSource) scan(input, node.predicate)
+            else segment(execute(input), node.predicate, emptyMap())
+        }
+        is PlanNode.WithColumns -> {
+            val input = node.input
+            val scanFilter = input is PlanNode.Filter && input.input.let { it is PlanNode.Scan && it.source is CsvSource }
+            if (input is PlanNode.Filter && !scanFilter) segment(execute(input.input), input.predicate, node.assignments)
+            else segment(execute(input), null, node.assignments)
+        }
+        is PlanNode.Select -> execute(node.input).selectColumns(*node.columns.toTypedArray())
+        is PlanNode.Aggregate -> {
+            val grouped = execute(node.input).groupBy(*node.keys.toTypedArray())
+            node.operations?.let { grouped.agg(it) } ?: grouped.sum()
+        }
+    }
+
+    private fun scan(node: PlanNode.Scan, predicate: Predicate?): DataFrame {
+        val source = node.source
+        if (source is DataFrameSource) {
+            val df = source.df[node.columns ?: source.df.columns()]
+            return if (predicate == null) df else segment(df, predicate, emptyMap())
+        }
+        source as CsvSource
+        val options = source.options.copy(columns = node.columns ?: source.options.columns)
+        return try {
+            source.open(options).use { readCsv(it, predicate) }
+        } catch (e: IOException) {
+            throw RuntimeException("读取CSV失败: ${e.message}", e)
+        }
+    }
+
+    private fun readCsv(stream: CsvStream, predicate: Predicate?): DataFrame {
+        val names = stream.columnNames
+        if (names.isEmpty()) {
+            return DataFrame(emptyList<Map<String, Any?>>())
+        }
+        val builder = CsvColumnBuilder(names.size)
+        // 筛选时记录选中行在文件中的行号作为索引标签
+        val labels = if (predicate != null) ArrayList<Any>() else null
+        var offset = 0
+        while (true) {
+            val batch = stream.nextBatch(SCAN_BATCH_ROWS) ?: break
+            if (predicate == null) {
+                builder.append(batch)
+            } else {
+                val rows = FilterEngine.selectRows(predicate, batch.rowCount) { name ->
+                    val c = names.indexOf(name)
+                    if (c < 0) throw IllegalArgumentException("列不存在: $name")
+                    batch.columns[c]
+                }
+                val selected = batch.columns.map { column ->
+                    (column as? TypedColumn<*>)?.gather(rows) ?: rows.map { column[it] }
+                }
+                builder.append(CsvBatch(rows.size, batch.types, selected))
+                for (row in rows) labels!!.add(offset + row)
+            }
+            offset += batch.rowCount
+        }
+        if (labels == null) {
+            val data = LinkedHashMap<String, List<Any?>>()
+            names.forEachIndexed { c, name -> data[name] = builder.columns[c] }
+            return DataFrame(data)
+        }
+        val data = LinkedHashMap<String, Series<Any>>()
+        names.forEachIndexed { c, name -> data[name] = Series(builder.columns[c], labels, name) }
+        return DataFrame(data, names)
+    }
+
+    /**
+     * 在 df 上筛选并计算新列
+     */
+    private fun segment(df: DataFrame, predicate: Predicate?, assignments: Map<String, Expr>): DataFrame {
+        val rowCount = df.shape().first
+        val filter = predicate?.let { p ->
+            FilterEngine.compile(p, rowCount) { name -> df[name].values() }
+        }
+        val result = compute(df, filter, assignments.values.toList())
+        val out = result.rows?.let { df.takeRows(it) } ?: df[df.columns()]
+        val index = out.index()
+        assignments.keys.forEachIndexed { i, name ->
+            @Suppress("UNCHECKED_CAST")
+            out[name] = Series.wrap(DoubleColumn.nanAsNull(result.columns[i]), index, name, AndaTypes.FLOAT64) as Series<Any>
+        }
+        return out
+    }
+
+    /**
+     * 在 df 的所有行上一次求值多个表达式，结果中缺失值为 NaN
+     */
+    fun evaluate(df: DataFrame, exprs: List<Expr>): List<DoubleArray> {
+        val missing = exprs.flatMap { it.columns() }.distinct().filter { it !in df.columns() }
+        if (missing.isNotEmpty()) {
+            throw IllegalArgumentException("不存在的列: $missing")
+        }
+        return compute(df, null, exprs).columns
+    }
+
+    // normalize 的统计量先按同样的筛选求矩，内层的先算
+    private fun compute(df: DataFrame, filter: FilterEngine.Compiled?, exprs: List<Expr>): PipelineResult {
+        val rowCount = df.shape().first
+        val stats = HashMap<Expr.Normalize, DoubleArray>()
+        val pending = exprs.flatMap { it.normalizations() }.distinct().toMutableList()
+        while (pending.isNotEmpty()) {
+            // 输入不依赖未知统计量的 normalize 在同一遍中求矩
+            val ready = pending.filter { e -> e.input.normalizations().all { it in stats } }
+            val compiler = ExprCompiler(stats)
+            ready.forEach { compiler.add(it.input) }
+            val moments = PipelineEngine.moments(rowCount, inputsOf(df, compiler), filter, compiler)
+            ready.forEachIndexed { i, e -> stats[e] = doubleArrayOf(moments[i].mean, moments[i].std(0)) }
+            pending.removeAll(ready)
+        }
+
+        val compiler = ExprCompiler(stats)
+        exprs.forEach { compiler.add(it) }
+        return PipelineEngine.run(rowCount, inputsOf(df, compiler), filter, compiler)
+    }
+
+    private fun inputsOf(df: DataFrame, compiler: ExprCompiler): List<DoubleArray> = compiler.inputs.map { name ->
+        try {
+            df[name].doublesOrNaN()
+        } catch (e: ClassCastException) {
+            throw IllegalArgumentException("列 $name 不是数值列")
+        }
+    }
+}
@@ -0,0 +1,37 @@
+package cn.ac.oac.libs.andas.entity
+
+import cn.ac.oac.libs.andas.core.RollingOp
+
+/**
+ * 滑动窗口 / 扩展窗口，由 [Series.rolling]、[Series.expanding]、[DataFrame.rolling]、[DataFrame.expanding] 创建
+ * 缺失值不计入窗口，有效值不足 minPeriods 的行结果为 null；结果保留原索引
+ *
+ * @param R 结果类型：Series<Double> 或 DataFrame
+ */
+class Rolling<R> internal constructor(
+    private val compute: (RollingOp) -> R
+) {
+    fun sum(): R = compute(RollingOp.SUM)
+
+    fun mean(): R = compute(RollingOp.MEAN)
+
+    /**
+     * 样本方差 (ddof=1)
+     */
+    fun variance(): R = compute(RollingOp.VAR)
+
+    fun std(): R = compute(RollingOp.STD)
+
+    fun min(): R = compute(RollingOp.MIN)
+
+    fun max(): R = compute(RollingOp.MAX)
+
+    /**
+     * 窗口内非缺失值个数
+     */
+    fun count(): R = compute(RollingOp.COUNT)
+
+    fun median(): R = compute(RollingOp.MEDIAN)
+
+    fun aggregate(op: RollingOp): R = compute(op)
+}
@@ -6,6 +6,24 @@ import cn.ac.oac.libs.andas.types.typeName
 import cn.ac.oac.libs.andas.core.NativeMath
 import cn.ac.oac.libs.andas.core.NativeData
 import cn.ac.oac.libs.andas.core.NativeBatch
+import cn.ac.oac.libs.andas.core.NativeColumn
+import cn.ac.oac.libs.andas.core.FilterEngine
+import cn.ac.oac.libs.andas.core.MomentAccumulator
+import cn.ac.oac.libs.andas.core.MomentOrder
+import cn.ac.oac.libs.andas.core.QuantileSketch
+import cn.ac.oac.libs.andas.core.DistinctCountSketch
+import cn.ac.oac.libs.andas.core.HeavyHitters
+import cn.ac.oac.libs.andas.core.describeOf
+import cn.ac.oac.libs.andas.core.RollingEngine
+import cn.ac.oac.libs.andas.core.SamplingEngine
+import cn.ac.oac.libs.andas.core.RollingOp
+import cn.ac.oac.libs.andas.core.WindowSpec
+import cn.ac.oac.libs.andas.core.SortEngine
+import cn.ac.oac.libs.andas.core.col
+import cn.ac.oac.libs.andas.core.SortKey
+import cn.ac.oac.libs.andas.core.SortKeyEncoding
+import cn.ac.oac.libs.andas.core.DedupEngine
+import cn.ac.oac.libs.andas.core.DedupKeyEncoding
 import java.util.*
 
 /**
@@ -15,12 +33,14 @@ import java.util.*
  * @param T 数据类型
  */
 class Series<T> {
+    // 数值和布尔数据以 TypedColumn 存储（基本类型数组 + 有效位图），字典编码的字符串为 DictionaryColumn，其他类型为普通列表
     private var data: List<T?>
-    private var index: List<Any> // 只能是 Int 或 String
+    // 标签只能是 Int 或 String；默认为不存储标签的 RangeIndex，按标签查找时才建哈希表
+    private var index: Index
     private var name: String?
     private var dtype: AndaTypes?
-    // 添加索引到位置的映射，用于快速查找
-    private var indexToPosition: Map<Any, Int>? = null
+    // 常驻原生内存的数值列，非空时原生运算直接使用，不再构造 DoubleArray
+    private var nativeColumn: NativeColumn? = null
 
     /**
      * 构造函数 - 通过列表数据创建Series
@@ -36,13 +56,9 @@ class Series<T> {
         name: String? = null,
         dtype: AndaTypes? = null
     ) {
-        this.data = data.toList()
-        val rawIndex = index ?: (0 until data.size).toList()
-        
+        this.data = storageOf(data)
         // 验证索引类型：只能是Int或String
-        validateIndexType(rawIndex)
-        
-        this.index = rawIndex
+        this.index = if (index == null) Index.range(data.size) else Index.of(index)
         this.name = name
         this.dtype = dtype ?: if (data.isNotEmpty()) guessDtype(data.first()) else null
         
@@ -51,7 +67,6 @@ class Series<T> {
             throw IllegalArgumentException("Index和Data的长度必须一致")
         }
 
-        this.indexToPosition = buildIndexToPositionMap()
     }
 
     /**
@@ -64,44 +79,131 @@ class Series<T> {
         map: Map<Any, T?>,
         name: String? = null
     ) {
-        this.data = map.values.toList()
-        val rawIndex = map.keys.toList()
-        
+        this.data = storageOf(map.values.toList())
         // 验证索引类型：只能是Int或String
-        validateIndexType(rawIndex)
-        
-        this.index = rawIndex
+        this.index = Index.of(map.keys.toList())
         this.name = name
         this.dtype = if (!this.data.isEmpty() && this.data.first() != null) guessDtype(this.data.first()) else null
-        this.indexToPosition = buildIndexToPositionMap()
     }
     
     /**
-     * 验证索引类型：只能是Int或String
+     * 构造函数 - 由原生列创建常驻原生内存的Series，数据不复制
      */
-    private fun validateIndexType(indexList: List<Any>) {
-        for (item in indexList) {
-            when (item) {
-                is Int, is String -> return
-                else -> throw IllegalArgumentException("索引类型必须是Int或String，但得到了: ${item::class.simpleName}")
+    private constructor(
+        column: NativeColumn,
+        index: List<Any>?,
+        name: String?
+    ) {
+        @Suppress("UNCHECKED_CAST")
+        this.data = column.asList() as List<T?>
+        val rowIndex = if (index == null) Index.range(column.size) else Index.of(index)
+        if (rowIndex.size != column.size) {
+            throw IllegalArgumentException("Index和Data的长度必须一致")
+        }
+        this.index = rowIndex
+        this.name = name
+        this.dtype = AndaTypes.FLOAT64
+        this.nativeColumn = column
+    }
+
+    companion object {
+        /**
+         * 按元素类型选择存储：能存为 TypedColumn 时不再保留装箱列表
+         */
+        @Suppress("UNCHECKED_CAST")
+        private fun <T> storageOf(values: List<T?>): List<T?> {
+            return (TypedColumn.of(values) ?: values.toList()) as List<T?>
+        }
+
+        /**
+         * 由 double 数组创建Series，数组不复制，调用方之后不可再修改
+         */
+        internal fun ofDoubles(values: DoubleArray, index: List<Any>, name: String?): Series<Double> {
+            return wrap(DoubleColumn(values, null), index, name, AndaTypes.FLOAT64)
+        }
+
+        /**
+         * 由原生列创建Series，Series 持有该列，后续数值运算直接在原生内存上进行
+         */
+        fun fromNative(column: NativeColumn, index: List<Any>? = null, name: String? = null): Series<Double> {
+            return Series(column, index, name)
+        }
+
+        /**
+         * 直接以给定列表作为数据，不复制（用于映射文件的列视图等只读数据）；index 为 [Index] 时共享
+         */
+        internal fun <T> wrap(data: List<T?>, index: List<Any>, name: String?, dtype: AndaTypes?): Series<T> {
+            if (index.size != data.size) {
+                throw IllegalArgumentException("Index和Data的长度必须一致")
             }
+            val series = Series<T>(emptyList(), null, name, dtype)
+            series.data = data
+            series.index = Index.of(index)
+            return series
         }
     }
-    
+
+    /**
+     * 非空数值按原顺序转为 DoubleArray；TypedColumn 存储时直接读取基本类型数组
+     */
+    internal fun nonNullDoubles(): DoubleArray {
+        (data as? NumericColumn<*>)?.let { return it.nonNullDoubles() }
+        return data
+            .filterNotNull()
+            .map { (it as Number).toDouble() }
+            .toDoubleArray()
+    }
+
+    /**
+     * 全部数值转为 DoubleArray，空值为 NaN
+     */
+    internal fun doublesOrNaN(): DoubleArray {
+        (data as? NumericColumn<*>)?.let { return it.doublesOrNaN() }
+        return data.map {
+            if (it == null) Double.NaN
+            else (it as Number).toDouble()
+        }.toDoubleArray()
+    }
+
+    /**
+     * 按位置取出子Series，保留索引标签；TypedColumn 存储时保持类型存储
+     */
+    internal fun take(positions: IntArray): Series<T> = take(positions, index.take(positions))
+
     /**
-     * 构建索引到位置的映射表
+     * 按位置取出子Series并使用给定的索引，DataFrame 的各列共享同一个子索引
      */
-    private fun buildIndexToPositionMap(): Map<Any, Int> {
-        val map = mutableMapOf<Any, Int>()
-        for ((position, label) in index.withIndex()) {
-            map[label] = position
+    internal fun take(positions: IntArray, newIndex: Index): Series<T> {
+        @Suppress("UNCHECKED_CAST")
+        val typed = data as? TypedColumn<T>
+        if (typed != null) {
+            return wrap(typed.gather(positions), newIndex, name, dtype)
         }
-        return map
+        return Series(positions.map { data[it] }, newIndex, name, dtype)
+    }
+
+    /**
+     * 同样的数据换一个索引（长度须一致），数据和原生列都不复制
+     */
+    internal fun withIndex(newIndex: Index): Series<T> {
+        val series = wrap(data, newIndex, name, dtype)
+        series.nativeColumn = nativeColumn
+        return series
+    }
+
+    /**
+     * 两侧都以数值 TypedColumn 存储时返回两列，否则返回 null 走通用路径
+     */
+    private fun numericPair(other: Series<*>): Pair<NumericColumn<*>, NumericColumn<*>>? {
+        val a = this.data as? NumericColumn<*> ?: return null
+        val b = other.data as? NumericColumn<*> ?: return null
+        return a to b
     }
+
     /**
      * 获取Series的索引
      */
-    fun index(): List<Any> = index
+    fun index(): Index = index
 
     /**
      * 获取Series的数据
@@ -132,6 +234,14 @@ class Series<T> {
 
 
     operator fun times(number: Number): Series<T> {
+        nativeColumn?.let { column ->
+            @Suppress("UNCHECKED_CAST")
+            return Series<Double>(NativeMath.multiplyDoubleArray(column, number.toDouble()), index, name) as Series<T>
+        }
+        (data as? DoubleColumn)?.let { column ->
+            @Suppress("UNCHECKED_CAST")
+            return wrap(column.times(number.toDouble()), index, name, dtype) as Series<T>
+        }
         val resultData = data.map { item ->
             when (item) {
                 is Number -> {
@@ -163,6 +273,14 @@ class Series<T> {
         if (this.size() != other.size()) {
             throw IllegalArgumentException("两个Series的大小必须相同才能进行加法运算")
         }
+        val left = this.nativeColumn
+        val right = other.nativeColumn
+        if (left != null && right != null) {
+            return Series(NativeMath.vectorizedAdd(left, right), this.index, this.name)
+        }
+        numericPair(other)?.let { (a, b) ->
+            return wrap(combineNumeric(a, b) { x, y -> x + y }, this.index, this.name, AndaTypes.FLOAT64)
+        }
 
         val resultData = this.data.zip(other.data) { a, b ->
             when {
@@ -186,6 +304,9 @@ class Series<T> {
         if (this.size() != other.size()) {
             throw IllegalArgumentException("两个Series的大小必须相同才能进行加法运算")
         }
+        numericPair(other)?.let { (a, b) ->
+            return wrap(combineNumeric(a, b) { x, y -> x - y }, this.index, this.name, AndaTypes.FLOAT64)
+        }
 
         val resultData = this.data.zip(other.data) { a, b ->
             when {
@@ -209,6 +330,14 @@ class Series<T> {
         if (this.size() != other.size()) {
             throw IllegalArgumentException("两个Series的大小必须相同才能进行加法运算")
         }
+        val left = this.nativeColumn
+        val right = other.nativeColumn
+        if (left != null && right != null) {
+            return Series(NativeMath.vectorizedMultiply(left, right), this.index, this.name)
+        }
+        numericPair(other)?.let { (a, b) ->
+            return wrap(combineNumeric(a, b) { x, y -> x * y }, this.index, this.name, AndaTypes.FLOAT64)
+        }
 
         val resultData = this.data.zip(other.data) { a, b ->
             when {
@@ -231,16 +360,15 @@ class Series<T> {
         if (this.size() != other.size()) {
             throw IllegalArgumentException("两个Series的大小必须相同才能进行点积运算")
         }
+        val left = this.nativeColumn
+        val right = other.nativeColumn
+        if (left != null && right != null) {
+            return NativeMath.dotProduct(left, right)
+        }
 
-        val doubleArray1 = this.data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray1 = this.nonNullDoubles()
 
-        val doubleArray2 = other.data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray2 = other.nonNullDoubles()
 
         return if (this.isNativeAvailable()) {
             NativeMath.dotProduct(doubleArray1, doubleArray2)
@@ -256,10 +384,8 @@ class Series<T> {
      * @return 范数值
      */
     fun norm(): Double {
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        nativeColumn?.let { return NativeMath.norm(it) }
+        val doubleArray = nonNullDoubles()
 
         return if (this.isNativeAvailable()) {
             NativeMath.norm(doubleArray)
@@ -307,9 +433,9 @@ class Series<T> {
      * @return 对应标签的元素
      */
     operator fun get(label: String): T? {
-        // label: Any 只能是 Int 和 String
-        val position = indexToPosition?.get(label)
-        if (position == null) {
+        // label: Any 只能是 Int 和 String；重复的标签取第一次出现的位置
+        val position = index.positionOf(label)
+        if (position < 0) {
             throw NoSuchElementException("未找到索引: $label")
         }
         return data[position]
@@ -335,11 +461,15 @@ class Series<T> {
      * @param n 元素个数，默认为5
      * @return 包含前n个元素的新Series
      */
+    @Suppress("UNCHECKED_CAST")
     fun head(n: Int = 5): Series<T> {
         val actualN = kotlin.math.min(n, data.size)
+        (data as? TypedColumn<T>)?.let {
+            return wrap(it.slice(0, actualN), index.slice(0, actualN), name, dtype)
+        }
         return Series(
             data.take(actualN),
-            index.take(actualN),
+            index.slice(0, actualN),
             name,
             dtype
         )
@@ -351,16 +481,40 @@ class Series<T> {
      * @param n 元素个数，默认为5
      * @return 包含后n个元素的新Series
      */
+    @Suppress("UNCHECKED_CAST")
     fun tail(n: Int = 5): Series<T> {
         val actualN = kotlin.math.min(n, data.size)
+        (data as? TypedColumn<T>)?.let {
+            return wrap(it.slice(data.size - actualN, data.size), index.slice(data.size - actualN, data.size), name, dtype)
+        }
         return Series(
             data.takeLast(actualN),
-            index.takeLast(actualN),
+            index.slice(data.size - actualN, data.size),
             name,
             dtype
         )
     }
 
+    /**
+     * 按标签区间取子Series，含两端（同 pandas 的 s.loc[start:end]），null 表示不限
+     * 单调的索引按二分查找，规则见 [Index.sliceLocs]
+     */
+    fun loc(start: Any?, end: Any?): Series<T> {
+        val range = index.sliceLocs(start, end)
+        return slice(range.first, range.last + 1)
+    }
+
+    /**
+     * 位置区间 [from, until) 的子Series，索引默认为原索引的切片（共享存储）
+     */
+    @Suppress("UNCHECKED_CAST")
+    internal fun slice(from: Int, until: Int, newIndex: Index = index.slice(from, until)): Series<T> {
+        (data as? TypedColumn<T>)?.let {
+            return wrap(it.slice(from, until), newIndex, name, dtype)
+        }
+        return wrap(data.subList(from, until).toList(), newIndex, name, dtype)
+    }
+
     /**
      * 检查哪些元素为空值
      *
@@ -382,35 +536,74 @@ class Series<T> {
     }
 
     /**
-     * 获取唯一的值
+     * 获取唯一的值，按首次出现的顺序，空值也算一个值
+     * 值编码为 int64 键后由原生哈希去重完成
      *
      * @return 去重后的值列表
      */
     fun unique(): List<T?> {
-        val seen = mutableSetOf<T?>()
-        val result = mutableListOf<T?>()
-        for (item in data) {
-            if (!seen.contains(item)) {
-                seen.add(item)
-                result.add(item)
-            }
+        (data as? DictionaryColumn)?.let { column ->
+            @Suppress("UNCHECKED_CAST")
+            return distinctCodes(column).map { if (it >= 0) column.dictionary[it] else null } as List<T?>
         }
-        return result
+        val result = DedupEngine.unique(arrayOf(DedupKeyEncoding.encode(data)))
+        return result.rows.map { data[it] }
     }
 
     /**
-     * 获取每个唯一值的出现次数
+     * 获取每个唯一值的出现次数，按次数降序排列，次数相同的按首次出现的顺序（与 pandas value_counts 一致），空值也计数
      *
      * @return 包含值和对应出现次数的Map
      */
     fun valueCounts(): Map<T?, Int> {
-        val counts = mutableMapOf<T?, Int>()
-        for (item in data) {
-            counts[item] = counts.getOrDefault(item, 0) + 1
+        val result = DedupEngine.unique(arrayOf(DedupKeyEncoding.encode(data)), sortByCount = true)
+        val counts = LinkedHashMap<T?, Int>(result.size * 2)
+        for (g in 0 until result.size) {
+            counts[data[result.rows[g]]] = result.counts[g].toInt()
         }
         return counts
     }
 
+    /**
+     * 字典编码列中出现过的编号，按首次出现的顺序，空值为 -1
+     */
+    private fun distinctCodes(column: DictionaryColumn): IntArray {
+        val seen = BooleanArray(column.dictionary.size + 1)
+        val result = ArrayList<Int>()
+        for (i in 0 until column.size) {
+            val code = column.codeAt(i)
+            val slot = if (code >= 0) code else seen.size - 1
+            if (!seen[slot]) {
+                seen[slot] = true
+                result.add(code)
+            }
+        }
+        return result.toIntArray()
+    }
+
+    /**
+     * 转为字典编码存储：每个值存为 int 编号，分组、连接、排序、筛选和去重在编号上计算
+     *
+     * @throws IllegalArgumentException 非空值不全是字符串时
+     */
+    fun asCategorical(): Series<T> {
+        if (data is DictionaryColumn) return this
+        val column = DictionaryColumn.encode(data)
+            ?: throw IllegalArgumentException("只有字符串列可以字典编码: $name")
+        @Suppress("UNCHECKED_CAST")
+        return wrap(column as List<T?>, index, name, AndaTypes.STRING)
+    }
+
+    /**
+     * 是否以字典编码存储
+     */
+    fun isCategorical(): Boolean = data is DictionaryColumn
+
+    /**
+     * 字典中的值，按编号顺序；取子集后字典可能包含本列已不再出现的值。非字典编码时返回 null
+     */
+    fun categories(): List<String>? = (data as? DictionaryColumn)?.dictionary?.values()?.toList()
+
     /**
      * 对Series中的元素应用函数
      *
@@ -461,20 +654,29 @@ class Series<T> {
      * @return 排序后的新Series
      */
     fun sortValues(descending: Boolean = false): Series<T> {
-        // 注意：这个实现仅适用于可比较的类型
-        try {
-            return sortValuesNative(descending)
-        }catch (e: Exception){
-            val sortedPairs = if (descending) {
-                index.zip(data).sortedByDescending { it.second?.toString() }
-            } else {
-                index.zip(data).sortedBy { it.second?.toString() }
-            }
-            val sortedIndex = sortedPairs.map { it.first }
-            val sortedData = sortedPairs.map { it.second }
-            return Series(sortedData, sortedIndex, name, dtype)
-        }
+        return take(sortPositions(descending, nullsFirst = false))
+    }
 
+    /**
+     * 最大的 n 个值（降序，相等时保持原顺序），缺失值不参与
+     */
+    fun nlargest(n: Int): Series<T> {
+        return take(SortEngine.topK(SortKeyEncoding.encode(data), n, largest = true))
+    }
+
+    /**
+     * 最小的 n 个值（升序，相等时保持原顺序），缺失值不参与
+     */
+    fun nsmallest(n: Int): Series<T> {
+        return take(SortEngine.topK(SortKeyEncoding.encode(data), n, largest = false))
+    }
+
+    /**
+     * 稳定排序后的位置；数值列直接作为键，其他可比较类型按字典编码
+     */
+    private fun sortPositions(descending: Boolean, nullsFirst: Boolean): IntArray {
+        if (data.isEmpty()) return IntArray(0)
+        return SortEngine.sortIndices(listOf(SortKey(SortKeyEncoding.encode(data), descending, nullsFirst)))
     }
 
     /**
@@ -521,6 +723,34 @@ class Series<T> {
      */
     fun toMap(): Map<Any, T?> = index.zip(data).toMap()
 
+    /**
+     * 滑动窗口（仅适用于数值类型），例：`series.rolling(3).mean()`
+     *
+     * @param window 窗口行数
+     * @param minPeriods 窗口内非缺失值少于该数时结果为 null，默认等于 window
+     * @param center 窗口是否居中
+     */
+    fun rolling(window: Int, minPeriods: Int? = null, center: Boolean = false): Rolling<Series<Double>> {
+        val spec = WindowSpec.fixed(window, minPeriods, center)
+        return Rolling { op -> rollingApply(op, spec) }
+    }
+
+    /**
+     * 扩展窗口（从第一行到当前行，仅适用于数值类型），例：`series.expanding().max()`
+     */
+    fun expanding(minPeriods: Int = 1): Rolling<Series<Double>> {
+        val spec = WindowSpec.expanding(minPeriods)
+        return Rolling { op -> rollingApply(op, spec) }
+    }
+
+    internal fun rollingApply(op: RollingOp, spec: WindowSpec): Series<Double> {
+        if (data !is NumericColumn<*> && data.any { it != null && it !is Number }) {
+            throw IllegalArgumentException("滑动窗口仅适用于数值类型: ${name ?: ""}")
+        }
+        val result = RollingEngine.apply(doublesOrNaN(), op, spec)
+        return wrap(DoubleColumn.nanAsNull(result), index, name, AndaTypes.FLOAT64)
+    }
+
     /**
      * 累计求和（仅适用于数值类型）
      *
@@ -531,6 +761,16 @@ class Series<T> {
             return Series<Double>(emptyList(), index, name)
         }
         
+        (data as? NumericColumn<*>)?.let { column ->
+            val sums = DoubleArray(column.size)
+            var running = 0.0
+            for (i in sums.indices) {
+                if (column.isValid(i)) running += column.doubleAt(i)
+                sums[i] = running
+            }
+            return wrap(DoubleColumn(sums, column.validity), index, if (name != null) "${name}_cumsum" else null, AndaTypes.FLOAT64)
+        }
+
         val result = mutableListOf<Double?>()
         var sum = 0.0
         
@@ -578,13 +818,35 @@ class Series<T> {
     }
     
     // ==================== JNI 原生高性能操作 ====================
+
+    /**
+     * 将数值数据转为常驻原生内存的列（null 转为 NaN），结果缓存，多次调用只转换一次
+     * 仅适用于数值类型的Series
+     */
+    fun toNative(): NativeColumn {
+        nativeColumn?.let { return it }
+        val column = if (data is NumericColumn<*>) NativeColumn.fromDoubleArray(doublesOrNaN()) else NativeColumn.fromValues(data)
+        nativeColumn = column
+        return column
+    }
+
+    /**
+     * 是否已常驻原生内存
+     */
+    fun isNativeResident(): Boolean = nativeColumn != null
+
+    /**
+     * 释放原生列。对 fromNative 创建的Series，释放后不可再访问数据
+     */
+    fun releaseNative() {
+        nativeColumn?.close()
+        nativeColumn = null
+    }
+
     fun sumKt(): Double {
         if (data.isEmpty()) return 0.0
 
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = nonNullDoubles()
 
         var sum = 0.0;
         for (d in doubleArray){
@@ -600,11 +862,9 @@ class Series<T> {
      */
     fun sum(): Double {
         if (data.isEmpty()) return 0.0
+        nativeColumn?.let { return NativeMath.sumDoubleArray(it) }
         
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = nonNullDoubles()
         
         return NativeMath.sumDoubleArray(doubleArray)
     }
@@ -615,11 +875,9 @@ class Series<T> {
      */
     fun mean(): Double {
         if (data.isEmpty()) return 0.0
+        nativeColumn?.let { return NativeMath.meanDoubleArray(it) }
         
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = nonNullDoubles()
         
         return NativeMath.meanDoubleArray(doubleArray)
     }
@@ -630,11 +888,9 @@ class Series<T> {
      */
     fun max(): Double {
         if (data.isEmpty()) return 0.0
+        nativeColumn?.let { return NativeMath.maxDoubleArray(it) }
         
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = nonNullDoubles()
         
         return NativeMath.maxDoubleArray(doubleArray)
     }
@@ -645,43 +901,108 @@ class Series<T> {
      */
     fun min(): Double {
         if (data.isEmpty()) return 0.0
+        nativeColumn?.let { return NativeMath.minDoubleArray(it) }
         
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = nonNullDoubles()
         
         return NativeMath.minDoubleArray(doubleArray)
     }
     
     /**
-     * 使用原生方法计算方差（高性能）
-     * 仅适用于数值类型的Series
+     * 计算方差（仅适用于数值类型的Series），默认为样本方差 (ddof=1)
+     * 有效值不超过 ddof 个时为 NaN
      */
-    fun variance(): Double {
+    fun variance(ddof: Int = 1): Double {
         if (data.isEmpty()) return 0.0
-        
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        return NativeMath.variance(doubleArray)
+        return moments(MomentOrder.VARIANCE).variance(ddof)
     }
     
     /**
-     * 使用原生方法计算标准差（高性能）
-     * 仅适用于数值类型的Series
+     * 计算标准差（仅适用于数值类型的Series），默认 ddof=1
      */
-    fun std(): Double {
+    fun std(ddof: Int = 1): Double {
         if (data.isEmpty()) return 0.0
-        
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        return NativeMath.std(doubleArray)
+        return moments(MomentOrder.VARIANCE).std(ddof)
+    }
+    
+    /**
+     * 无偏偏度（与 pandas 一致），有效值不足3个时为 NaN
+     */
+    fun skew(): Double = moments(MomentOrder.SHAPE).skew()
+    
+    /**
+     * 无偏超额峰度（与 pandas 一致），有效值不足4个时为 NaN
+     */
+    fun kurt(): Double = moments(MomentOrder.SHAPE).kurt()
+    
+    /**
+     * 一次扫描得到的全部矩统计量，可与其他部分的结果合并
+     */
+    fun moments(): MomentAccumulator = moments(MomentOrder.SHAPE)
+    
+    internal fun moments(order: MomentOrder): MomentAccumulator {
+        nativeColumn?.let { return MomentAccumulator.of(it, order) }
+        return MomentAccumulator.of(nonNullDoubles(), order)
+    }
+    
+    /**
+     * 分位数摘要（KLL），可与其他部分的摘要合并；有效值不超过 k 个时分位数为精确值
+     */
+    fun quantileSketch(k: Int = QuantileSketch.DEFAULT_K): QuantileSketch = QuantileSketch.of(nonNullDoubles(), k)
+    
+    /**
+     * 近似分位数，内存与数据量无关，秩误差约 0.5%；q 位于 [0, 1]，没有有效值时为 NaN
+     */
+    fun approxQuantile(q: Double): Double = quantileSketch().quantile(q)
+    
+    fun approxQuantile(qs: List<Double>): List<Double> = quantileSketch().quantiles(qs)
+    
+    /**
+     * 去重计数摘要（HyperLogLog），可与其他部分的摘要合并；null 和 NaN 不计入
+     * 数值按 double 比较，1 与 1.0 视为同一个值
+     */
+    fun distinctSketch(precision: Int = DistinctCountSketch.DEFAULT_PRECISION): DistinctCountSketch {
+        (data as? NumericColumn<*>)?.let { return DistinctCountSketch.ofDoubles(it.doublesOrNaN(), precision) }
+        return DistinctCountSketch(precision).addAll(data)
+    }
+    
+    /**
+     * 近似去重个数，默认精度下标准误差约 0.8%
+     */
+    fun approxNunique(precision: Int = DistinctCountSketch.DEFAULT_PRECISION): Long =
+        distinctSketch(precision).count()
+    
+    /**
+     * 高频项摘要（Space-Saving），可与其他部分的摘要合并；null 和 NaN 不计入
+     */
+    fun heavyHitters(capacity: Int = HeavyHitters.DEFAULT_CAPACITY): HeavyHitters<Any> = heavyHitters(capacity, null)
+    
+    /**
+     * @param decode 数值列的 double 还原为结果中的值，为 null 时还原为列的元素类型
+     */
+    internal fun heavyHitters(capacity: Int, decode: ((Double) -> Any)?): HeavyHitters<Any> {
+        val column = data as? NumericColumn<*>
+        if (column != null) {
+            val back: (Double) -> Any = decode ?: when (column) {
+                is IntColumn -> { v: Double -> v.toInt() }
+                is LongColumn -> { v: Double -> v.toLong() }
+                else -> { v: Double -> v }
+            }
+            return HeavyHitters.ofDoubles(column.doublesOrNaN(), capacity, back)
+        }
+        val sketch = HeavyHitters<Any>(capacity)
+        data.forEach { sketch.add(it) }
+        return sketch
+    }
+    
+    /**
+     * 出现次数最多的 k 个值及其估计次数（按次数降序），估计次数不小于真实次数，
+     * 高估量不超过总数 / max(1024, 4k)
+     */
+    @Suppress("UNCHECKED_CAST")
+    fun topK(k: Int): Map<T, Long> {
+        val capacity = maxOf(HeavyHitters.DEFAULT_CAPACITY, k * 4)
+        return heavyHitters(capacity).top(k).associate { (it.value as T) to it.count }
     }
     
     /**
@@ -692,11 +1013,11 @@ class Series<T> {
         if (data.isEmpty()) {
             return Series(emptyList(), index, if (name != null) "${name}_normalized" else null)
         }
+        nativeColumn?.let {
+            return Series(NativeMath.normalize(it), index, if (name != null) "${name}_normalized" else null)
+        }
         
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = nonNullDoubles()
         
         val normalized = NativeMath.normalize(doubleArray)
         
@@ -705,26 +1026,10 @@ class Series<T> {
     
     /**
      * 使用原生方法进行排序（高性能）
-     * 仅适用于数值类型的Series
+     * 稳定排序，缺失值排在最后
      */
     fun sortValuesNative(descending: Boolean = false): Series<T> {
-        if (data.isEmpty()) return this
-        
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        val indices = if (descending) {
-            NativeMath.argsort(doubleArray).reversed()
-        } else {
-            NativeMath.argsort(doubleArray).toList()
-        }
-        
-        val sortedData = indices.map { data[it] }
-        val sortedIndex = indices.map { index[it] }
-        
-        return Series(sortedData, sortedIndex, name, dtype)
+        return take(sortPositions(descending, nullsFirst = false))
     }
     
     /**
@@ -734,28 +1039,17 @@ class Series<T> {
     fun filterGreaterThan(threshold: Double): Series<T> {
         if (data.isEmpty()) return this
         
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        val mask = NativeMath.greaterThan(doubleArray, threshold)
-        val indices = NativeData.where(mask)
-        
-        val filteredData = indices.map { data[it.toInt()] }
-        val filteredIndex = indices.map { index[it.toInt()] }
+        val indices = FilterEngine.selectRows(col(name ?: "") gt threshold, data.size) { data }
         
-        return Series(filteredData, filteredIndex, name, dtype)
+        return take(indices)
     }
     
     /**
      * 使用原生方法查找空值索引（高性能）
      */
     fun findNullIndices(): List<Int> {
-        val doubleArray = data.map { 
-            if (it == null) Double.NaN 
-            else (it as Number).toDouble() 
-        }.toDoubleArray()
+        nativeColumn?.let { return NativeData.findNullIndices(it).toList() }
+        val doubleArray = doublesOrNaN()
         
         return NativeData.findNullIndices(doubleArray).map { it.toInt() }
     }
@@ -764,10 +1058,16 @@ class Series<T> {
      * 使用原生方法丢弃空值（高性能）
      */
     fun dropNullValues(): Series<T> {
-        val doubleArray = data.map { 
-            if (it == null) Double.NaN 
-            else (it as Number).toDouble() 
-        }.toDoubleArray()
+        (data as? TypedColumn<*>)?.let { column ->
+            if (column.validity == null) return copy()
+            val positions = IntArray(column.size - column.nullCount())
+            var k = 0
+            for (i in 0 until column.size) {
+                if (column.isValid(i)) positions[k++] = i
+            }
+            return take(positions)
+        }
+        val doubleArray = doublesOrNaN()
         
         val result = NativeData.dropNullValues(doubleArray)
         
@@ -789,10 +1089,10 @@ class Series<T> {
      * 使用原生方法填充空值（高性能）
      */
     fun fillNullWithConstant(value: Double): Series<Double> {
-        val doubleArray = data.map { 
-            if (it == null) Double.NaN 
-            else (it as Number).toDouble() 
-        }.toDoubleArray()
+        nativeColumn?.let {
+            return Series(NativeData.fillNullWithConstant(it, value), index, if (name != null) "${name}_filled" else null)
+        }
+        val doubleArray = doublesOrNaN()
         
         val result = NativeData.fillNullWithConstant(doubleArray, value)
         
@@ -801,72 +1101,42 @@ class Series<T> {
     
     /**
      * 使用原生方法进行排序索引（高性能）
+     * 稳定排序，缺失值排在最后
      */
     fun sortIndices(descending: Boolean = false): List<Int> {
-        if (data.isEmpty()) return emptyList()
-        
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        return NativeData.sortIndices(doubleArray, descending).toList()
+        return sortPositions(descending, nullsFirst = false).toList()
     }
     
     /**
      * 使用原生方法进行统计描述（高性能）
      * 仅适用于数值类型的Series
+     *
+     * @param percentiles 输出的分位数，键如 "25%"；由分位数摘要计算，有效值较多时为近似值
+     * @return count, mean, std, min, 各分位数, max
      */
-    fun describe(): Map<String, Double> {
+    fun describe(percentiles: List<Double> = QuantileSketch.DEFAULT_PERCENTILES): Map<String, Double> {
         if (data.isEmpty()) {
-            return mapOf(
-                "count" to 0.0,
-                "mean" to 0.0,
-                "std" to 0.0,
-                "min" to 0.0,
-                "max" to 0.0
-            )
+            return describeOf(MomentAccumulator(), QuantileSketch(), percentiles).mapValues { 0.0 }
         }
         
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
-        
-        val result = NativeData.describe(doubleArray)
-        
-        return mapOf(
-            "count" to result[0],
-            "mean" to result[1],
-            "std" to result[2],
-            "min" to result[3],
-            "max" to result[4]
-        )
+        return describeOf(moments(MomentOrder.VARIANCE), quantileSketch(), percentiles)
     }
     
     /**
-     * 使用原生方法进行数据采样（高性能）
+     * 不放回随机采样，按抽取顺序返回并保留索引标签；sampleSize 不小于长度时返回打乱顺序的全部元素
+     *
+     * @param seed 随机种子，相同种子得到相同的样本；为 null 时随机选取
      */
-    fun sample(sampleSize: Int): Series<T> {
-        if (data.isEmpty() || sampleSize <= 0) {
-            return Series(emptyList(), emptyList(), name, dtype)
-        }
-        
-        if (sampleSize >= data.size) {
-            return this.copy()
-        }
-        
-        val doubleArray = data.map { 
-            if (it == null) Double.NaN 
-            else (it as Number).toDouble() 
-        }.toDoubleArray()
-        
-        val sampleIndices = NativeData.sample(doubleArray, sampleSize).map { it.toInt() }
-        
-        val sampledData = sampleIndices.map { data[it] }
-        val sampledIndex = sampleIndices.map { index[it] }
-        
-        return Series(sampledData, sampledIndex, name, dtype)
+    fun sample(sampleSize: Int, seed: Long? = null): Series<T> {
+        val positions = SamplingEngine.sampleIndices(data.size, maxOf(sampleSize, 0), SamplingEngine.seedOf(seed))
+        return take(positions)
+    }
+    
+    /**
+     * 按比例不放回随机采样 round(fraction * 长度) 个元素
+     */
+    fun sample(fraction: Double, seed: Long? = null): Series<T> {
+        return sample(SamplingEngine.countOf(fraction, data.size), seed)
     }
     
     /**
@@ -877,10 +1147,7 @@ class Series<T> {
             return Series(emptyList(), index, if (name != null) "${name}_processed" else null)
         }
         
-        val doubleArray = data
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-            .toDoubleArray()
+        val doubleArray = nonNullDoubles()
         
         val result = NativeBatch.processBatch(doubleArray, batchSize)
         
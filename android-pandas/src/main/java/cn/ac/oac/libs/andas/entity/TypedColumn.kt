@@ -0,0 +1,390 @@
+package cn.ac.oac.libs.andas.entity
+
+import cn.ac.oac.libs.andas.types.AndaTypes
+
+/**
+ * 有效位图：第 i 位为 1 表示第 i 个值非空
+ */
+internal class ValidityBitmap(val size: Int) {
+
+    private val words = LongArray((size + 63) ushr 6)
+
+    operator fun get(index: Int): Boolean = ((words[index ushr 6] ushr (index and 63)) and 1L) != 0L
+
+    fun set(index: Int) {
+        words[index ushr 6] = words[index ushr 6] or (1L shl (index and 63))
+    }
+
+    /**
+     * 非空值个数
+     */
+    fun cardinality(): Int {
+        var count = 0
+        for (word in words) count += java.lang.Long.bitCount(word)
+        return count
+    }
+
+    companion object {
+        /**
+         * 两个位图按位与，任一为 null（没有空值）时取另一个
+         */
+        fun and(a: ValidityBitmap?, b: ValidityBitmap?): ValidityBitmap? {
+            if (a == null) return b
+            if (b == null) return a
+            val result = ValidityBitmap(a.size)
+            for (i in result.words.indices) result.words[i] = a.words[i] and b.words[i]
+            return result
+        }
+    }
+}
+
+/**
+ * 按类型存储的列：值保存在基本类型数组中，空值由单独的有效位图标记
+ * 作为 List 使用时是只读视图，按位置装箱返回，数值运算直接使用底层数组
+ *
+ * 列创建后不可修改，多个 Series 可以共享同一列
+ */
+internal sealed class TypedColumn<T> : AbstractList<T?>(), RandomAccess {
+
+    /**
+     * 有效位图，为 null 表示没有空值
+     */
+    abstract val validity: ValidityBitmap?
+
+    abstract val dtype: AndaTypes
+
+    fun isValid(index: Int): Boolean = validity?.get(index) ?: true
+
+    fun nullCount(): Int = validity?.let { size - it.cardinality() } ?: 0
+
+    /**
+     * 按位置取出新列
+     */
+    abstract fun gather(positions: IntArray): TypedColumn<T>
+
+    fun slice(from: Int, to: Int): TypedColumn<T> = gather(IntArray(to - from) { from + it })
+
+    protected fun gatherValidity(positions: IntArray): ValidityBitmap? {
+        val source = validity ?: return null
+        val result = ValidityBitmap(positions.size)
+        var allValid = true
+        for (i in positions.indices) {
+            if (source[positions[i]]) result.set(i) else allValid = false
+        }
+        return if (allValid) null else result
+    }
+
+    companion object {
+        /**
+         * 按值的类型构建列；非空值须全部为 Double、Long、Int 或 Boolean 中的同一种，
+         * 其他情况（混合类型、字符串等）返回 null，由调用方保留原列表
+         */
+        fun of(values: List<*>): TypedColumn<*>? {
+            if (values is TypedColumn<*>) return values
+            val first = values.firstOrNull { it != null } ?: return null
+            val kind = first.javaClass
+            if (kind != java.lang.Double::class.java && kind != java.lang.Long::class.java &&
+                kind != java.lang.Integer::class.java && kind != java.lang.Boolean::class.java
+            ) {
+                return null
+            }
+            val size = values.size
+            val validity = ValidityBitmap(size)
+            var hasNull = false
+            for (i in 0 until size) {
+                val value = values[i]
+                if (value == null) {
+                    hasNull = true
+                } else if (value.javaClass != kind) {
+                    return null
+                } else {
+                    validity.set(i)
+                }
+            }
+            val bitmap = if (hasNull) validity else null
+            return when (first) {
+                is Double -> DoubleColumn(DoubleArray(size) { (values[it] as Double?) ?: Double.NaN }, bitmap)
+                is Long -> LongColumn(LongArray(size) { (values[it] as Long?) ?: 0L }, bitmap)
+                is Int -> IntColumn(IntArray(size) { (values[it] as Int?) ?: 0 }, bitmap)
+                else -> BoolColumn(BooleanArray(size) { (values[it] as Boolean?) ?: false }, bitmap)
+            }
+        }
+    }
+}
+
+/**
+ * 数值列，提供不经装箱的 double 访问
+ */
+internal sealed class NumericColumn<T : Number> : TypedColumn<T>() {
+
+    abstract fun doubleAt(index: Int): Double
+
+    /**
+     * 非空值按原顺序转为 double
+     */
+    open fun nonNullDoubles(): DoubleArray {
+        val validity = validity ?: return DoubleArray(size) { doubleAt(it) }
+        val result = DoubleArray(validity.cardinality())
+        var k = 0
+        for (i in 0 until size) {
+            if (validity[i]) result[k++] = doubleAt(i)
+        }
+        return result
+    }
+
+    /**
+     * 全部值转为 double，空值为 NaN
+     */
+    open fun doublesOrNaN(): DoubleArray {
+        val validity = validity ?: return DoubleArray(size) { doubleAt(it) }
+        return DoubleArray(size) { if (validity[it]) doubleAt(it) else Double.NaN }
+    }
+}
+
+/**
+ * double 列；空值位置的值为 NaN，但空与否只看有效位图，原有的 NaN 仍是非空值
+ */
+internal class DoubleColumn(
+    private val values: DoubleArray,
+    override val validity: ValidityBitmap?
+) : NumericColumn<Double>() {
+
+    override val size: Int get() = values.size
+    override val dtype: AndaTypes get() = AndaTypes.FLOAT64
+
+    override fun get(index: Int): Double? {
+        val value = values[index]
+        return if (isValid(index)) value else null
+    }
+
+    override fun doubleAt(index: Int): Double = values[index]
+
+    // 没有空值时直接返回底层数组，调用方只读（JNI 侧均以 JNI_ABORT 释放）
+    override fun nonNullDoubles(): DoubleArray = if (validity == null) values else super.nonNullDoubles()
+
+    override fun doublesOrNaN(): DoubleArray = if (validity == null) values else super.doublesOrNaN()
+
+    override fun gather(positions: IntArray): DoubleColumn =
+        DoubleColumn(DoubleArray(positions.size) { values[positions[it]] }, gatherValidity(positions))
+
+    fun times(multiplier: Double): DoubleColumn =
+        DoubleColumn(DoubleArray(values.size) { values[it] * multiplier }, validity)
+
+    companion object {
+        /**
+         * 原生计算结果以 NaN 表示缺失时使用：NaN 位置记为空值
+         */
+        fun nanAsNull(values: DoubleArray): DoubleColumn {
+            if (values.none { it.isNaN() }) return DoubleColumn(values, null)
+            val validity = ValidityBitmap(values.size)
+            for (i in values.indices) {
+                if (!values[i].isNaN()) validity.set(i)
+            }
+            return DoubleColumn(values, validity)
+        }
+    }
+}
+
+internal class LongColumn(
+    private val values: LongArray,
+    override val validity: ValidityBitmap?
+) : NumericColumn<Long>() {
+
+    override val size: Int get() = values.size
+    override val dtype: AndaTypes get() = AndaTypes.INT64
+
+    override fun get(index: Int): Long? {
+        val value = values[index]
+        return if (isValid(index)) value else null
+    }
+
+    override fun doubleAt(index: Int): Double = values[index].toDouble()
+
+    override fun gather(positions: IntArray): LongColumn =
+        LongColumn(LongArray(positions.size) { values[positions[it]] }, gatherValidity(positions))
+
+    /**
+     * 转为 LongArray，空值为 nullValue
+     */
+    fun longsOr(nullValue: Long): LongArray = LongArray(values.size) { if (isValid(it)) values[it] else nullValue }
+}
+
+internal class IntColumn(
+    private val values: IntArray,
+    override val validity: ValidityBitmap?
+) : NumericColumn<Int>() {
+
+    override val size: Int get() = values.size
+    override val dtype: AndaTypes get() = AndaTypes.INT32
+
+    override fun get(index: Int): Int? {
+        val value = values[index]
+        return if (isValid(index)) value else null
+    }
+
+    override fun doubleAt(index: Int): Double = values[index].toDouble()
+
+    override fun gather(positions: IntArray): IntColumn =
+        IntColumn(IntArray(positions.size) { values[positions[it]] }, gatherValidity(positions))
+
+    fun longsOr(nullValue: Long): LongArray = LongArray(values.size) { if (isValid(it)) values[it].toLong() else nullValue }
+}
+
+internal class BoolColumn(
+    private val values: BooleanArray,
+    override val validity: ValidityBitmap?
+) : TypedColumn<Boolean>() {
+
+    override val size: Int get() = values.size
+    override val dtype: AndaTypes get() = AndaTypes.BOOL
+
+    override fun get(index: Int): Boolean? {
+        val value = values[index]
+        return if (isValid(index)) value else null
+    }
+
+    override fun gather(positions: IntArray): BoolColumn =
+        BoolColumn(BooleanArray(positions.size) { values[positions[it]] }, gatherValidity(positions))
+}
+
+/**
+ * 只增不减的字符串字典：编号按加入顺序分配，加入后不再改变
+ * 字典只在构建列时由单个线程写入，之后可以被多个列共享读取
+ */
+internal class StringDictionary {
+
+    private val entries = ArrayList<String>()
+    private val lookup = HashMap<String, Int>()
+    @Volatile
+    private var sortedView: Sorted? = null
+
+    val size: Int get() = entries.size
+
+    operator fun get(code: Int): String = entries[code]
+
+    /**
+     * 按编号排列的条目，只读视图
+     */
+    fun values(): List<String> = java.util.Collections.unmodifiableList(entries)
+
+    /**
+     * 值的编号，不在字典中时返回 -1
+     */
+    fun find(value: String): Int = lookup[value] ?: -1
+
+    /**
+     * 值的编号，不在字典中时加入
+     */
+    fun intern(value: String): Int {
+        return lookup.getOrPut(value) {
+            entries.add(value)
+            entries.size - 1
+        }
+    }
+
+    /**
+     * 按 String.compareTo 排序后的字典
+     *
+     * @property values 排序后的条目
+     * @property ranks ranks[code] 为编号 code 在 values 中的位置
+     * @property lookup 条目到其排序位置
+     */
+    class Sorted(val values: List<String>, val ranks: IntArray, val lookup: Map<Any, Long>)
+
+    /**
+     * 排序后的字典，字典增长后重新计算
+     */
+    fun sorted(): Sorted {
+        val cached = sortedView
+        if (cached != null && cached.ranks.size == entries.size) return cached
+        val order = (0 until entries.size).sortedWith { a, b -> entries[a].compareTo(entries[b]) }
+        val ranks = IntArray(order.size)
+        val values = ArrayList<String>(order.size)
+        val positions = HashMap<Any, Long>(order.size * 2)
+        order.forEachIndexed { rank, code ->
+            ranks[code] = rank
+            values.add(entries[code])
+            positions[entries[code]] = rank.toLong()
+        }
+        return Sorted(values, ranks, positions).also { sortedView = it }
+    }
+}
+
+/**
+ * 字典编码的字符串列：每行保存 int 编号，-1 为空值，多个列可以共享同一字典
+ * 分组、连接、排序、筛选和去重直接在编号上计算，不再比较字符串
+ *
+ * 字典可能包含本列没有出现的值（取子集或多个批次共享字典时）
+ */
+internal class DictionaryColumn(
+    private val codes: IntArray,
+    val dictionary: StringDictionary
+) : TypedColumn<String>() {
+
+    override val validity: ValidityBitmap? by lazy {
+        if (codes.none { it < 0 }) {
+            null
+        } else {
+            val bitmap = ValidityBitmap(codes.size)
+            for (i in codes.indices) {
+                if (codes[i] >= 0) bitmap.set(i)
+            }
+            bitmap
+        }
+    }
+
+    override val size: Int get() = codes.size
+    override val dtype: AndaTypes get() = AndaTypes.STRING
+
+    override fun get(index: Int): String? {
+        val code = codes[index]
+        return if (code >= 0) dictionary[code] else null
+    }
+
+    fun codeAt(index: Int): Int = codes[index]
+
+    /**
+     * 编号转为 LongArray，空值为 nullValue
+     */
+    fun codesOr(nullValue: Long): LongArray = LongArray(codes.size) { if (codes[it] >= 0) codes[it].toLong() else nullValue }
+
+    override fun gather(positions: IntArray): DictionaryColumn =
+        DictionaryColumn(IntArray(positions.size) { codes[positions[it]] }, dictionary)
+
+    /**
+     * 按位置取出新列，位置 -1 对应空值（连接结果中没有匹配的一侧）
+     */
+    fun gatherOrNull(positions: IntArray): DictionaryColumn =
+        DictionaryColumn(IntArray(positions.size) { if (positions[it] >= 0) codes[positions[it]] else -1 }, dictionary)
+
+    companion object {
+        /**
+         * 编码字符串列表；非空值不全是 String 时返回 null
+         */
+        fun encode(values: List<*>): DictionaryColumn? {
+            if (values is DictionaryColumn) return values
+            val dictionary = StringDictionary()
+            val codes = IntArray(values.size)
+            for (i in values.indices) {
+                codes[i] = when (val value = values[i]) {
+                    null -> -1
+                    is String -> dictionary.intern(value)
+                    else -> return null
+                }
+            }
+            return DictionaryColumn(codes, dictionary)
+        }
+    }
+}
+
+/**
+ * 两个数值列逐元素运算，任一侧为空时结果为空
+ */
+internal inline fun combineNumeric(
+    a: NumericColumn<*>,
+    b: NumericColumn<*>,
+    op: (Double, Double) -> Double
+): DoubleColumn {
+    val result = DoubleArray(a.size) { op(a.doubleAt(it), b.doubleAt(it)) }
+    return DoubleColumn(result, ValidityBitmap.and(a.validity, b.validity))
+}
@@ -2,15 +2,35 @@ package cn.ac.oac.libs.andas.utils
 
 import cn.ac.oac.libs.andas.entity.DataFrame
 import cn.ac.oac.libs.andas.entity.Series
+import cn.ac.oac.libs.andas.entity.DoubleColumn
 import cn.ac.oac.libs.andas.core.NativeBatch
 import cn.ac.oac.libs.andas.core.NativeData
 import cn.ac.oac.libs.andas.core.NativeMath
+import cn.ac.oac.libs.andas.core.MomentAccumulator
+import cn.ac.oac.libs.andas.core.QuantileSketch
+import cn.ac.oac.libs.andas.core.DistinctCountSketch
+import cn.ac.oac.libs.andas.core.HeavyHitters
+import cn.ac.oac.libs.andas.core.describeOf
+import cn.ac.oac.libs.andas.core.RollingAccumulator
+import cn.ac.oac.libs.andas.core.RollingOp
+import cn.ac.oac.libs.andas.core.ReservoirSampler
+import cn.ac.oac.libs.andas.core.BernoulliSampler
+import cn.ac.oac.libs.andas.core.SamplingEngine
+import cn.ac.oac.libs.andas.core.DedupEngine
+import cn.ac.oac.libs.andas.core.DistinctRowSet
+import cn.ac.oac.libs.andas.core.StableKeyEncoder
+import cn.ac.oac.libs.andas.core.SpillEngine
+import cn.ac.oac.libs.andas.core.SpillGroups
+import cn.ac.oac.libs.andas.core.RecordBuilder
+import cn.ac.oac.libs.andas.core.ValueCodec
+import cn.ac.oac.libs.andas.core.PrefetchIterator
+import cn.ac.oac.libs.andas.core.BatchPipeline
 import cn.ac.oac.libs.andas.types.AndaTypes
 import cn.ac.oac.libs.andas.entity.DataFrameIO
-import java.io.BufferedReader
+import cn.ac.oac.libs.andas.entity.LazyFrame
 import java.io.File
 import java.io.InputStream
-import java.io.InputStreamReader
+import kotlin.math.abs
 import kotlin.math.sqrt
 
 /**
@@ -24,6 +44,11 @@ object BatchCSVUtils {
      */
     const val DEFAULT_BATCH_SIZE = 1000
 
+    /**
+     * 默认预读的批数
+     */
+    const val DEFAULT_PREFETCH = 2
+
     /**
      * 检查原生批处理库是否可用
      */
@@ -34,7 +59,8 @@ object BatchCSVUtils {
     /**
      * 分批读取CSV文件（用于大数据处理）- 回调版本
      * 使用流式处理，避免一次性加载所有数据到内存
-     * 一行一行读取，达到batchSize行后返回一个DataFrame
+     * 按块解析，凑满batchSize行后回调一个DataFrame
+     * prefetch > 0 时读取和解析在后台线程进行，回调仍在调用线程上执行，处理当前批时下一批已在读取，见 [readCSVBatches]
      *
      * @param inputStream CSV数据流
      * @param batchSize 批处理大小
@@ -46,6 +72,7 @@ object BatchCSVUtils {
      * @param skipLines 跳过行数
      * @param nullValues 空值标识列表
      * @param trimValues 是否修剪值
+     * @param prefetch 预先读好的批数，0 表示在调用线程上逐批读取
      */
     fun readCSVBatch(
         inputStream: InputStream,
@@ -57,230 +84,136 @@ object BatchCSVUtils {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        prefetch: Int = DEFAULT_PREFETCH
     ) {
         if (batchSize == 0){
             throw IllegalArgumentException("Batch is Non-Zero!")
         }
-        val reader = BufferedReader(InputStreamReader(inputStream, encoding))
-        
-        try {
-            // 跳过指定行数
-            var linesSkipped = 0
-            while (linesSkipped < skipLines) {
-                val line = reader.readLine()
-                if (line == null) {
-                    return // 文件为空或跳过行数超过文件行数
-                }
-                linesSkipped++
-            }
-            
-            // 读取第一行（表头或第一行数据）
-            val firstLine = reader.readLine()
-            if (firstLine == null) {
-                return // 文件为空
-            }
-            
-            // 解析表头
-            val headers: List<String>
-            if (header) {
-                headers = DataFrame.parseCSVLine(firstLine, delimiter, trimValues)
-            } else {
-                val firstLineValues = DataFrame.parseCSVLine(firstLine, delimiter, trimValues)
-                headers = firstLineValues.indices.map { "col$it" }
-            }
-            
-            if (headers.isEmpty()) {
-                throw IllegalArgumentException("解析失败: 未找到有效的列名")
-            }
-            
-            // 推断列类型（使用第一行数据）
-            val columnTypes = mutableMapOf<String, (String) -> Any?>()
-            if (autoType) {
-                val firstDataRow = if (header) {
-                    reader.readLine()
-                } else {
-                    firstLine
-                }
-                
-                if (firstDataRow != null) {
-                    val firstLineValues = DataFrame.parseCSVLine(firstDataRow, delimiter, trimValues)
-                    val adjustedFirstValues = if (firstLineValues.size < headers.size) {
-                        firstLineValues + List(headers.size - firstLineValues.size) { "" }
-                    } else if (firstLineValues.size > headers.size) {
-                        firstLineValues.take(headers.size)
-                    } else {
-                        firstLineValues
-                    }
-                    
-                    headers.forEachIndexed { index, headerName ->
-                        val firstValue = adjustedFirstValues.getOrNull(index) ?: ""
-                        val inferredType = DataFrame.inferTypeFromSample(firstValue, nullValues)
-                        columnTypes[headerName] = { value ->
-                            if (value in nullValues) null
-                            else DataFrame.convertValueWithType(value, inferredType)
-                        }
-                    }
-                    
-                   
-                    processBatchLineByLine(reader, headers, batchSize, callback, delimiter, autoType, columnTypes, nullValues, trimValues)
-                    return
-                }
-            }
-            
-            // 如果没有启用类型推断，直接开始逐行处理
-            if (!autoType) {
-                processBatchLineByLine(reader, headers, batchSize, callback, delimiter, autoType, columnTypes, nullValues, trimValues)
-            }
-            
-        } catch (e: Exception) {
-            throw RuntimeException("读取数据流失败: ${e.message}", e)
-        } finally {
-            reader.close()
+        if (prefetch > 0) {
+            readCSVBatches(
+                inputStream, batchSize, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues, prefetch
+            ).use { batches -> batches.forEach(callback) }
+            return
+        }
+        // 流式读取由 CsvReader 完成，这里保持原有行为：读完后关闭数据流
+        inputStream.use {
+            DataFrameIO.readCSVBatch(
+                it, batchSize, callback, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues
+            )
         }
     }
 
     /**
-     * 重新创建流进行分批处理（用于类型推断场景）
+     * 分批读取CSV文件 - 迭代器版本，可用 asSequence() 转为 Sequence
+     *
+     * 后台线程读取并解析（原生读取器按块并行解析），解析好的批放进容量为 prefetch 的有界队列；
+     * 调用方处理得慢时后台线程阻塞，内存中最多有 prefetch + 1 批。读完或关闭迭代器时关闭数据流，
+     * 没有读完时须调用 close（或用 use）；读取中的异常在取到对应位置时抛出
+     *
+     * 例：`readCSVBatches(input).use { batches -> for (batch in batches) process(batch) }`
+     *
+     * @param inputStream CSV数据流
+     * @param batchSize 批处理大小
+     * @param delimiter 分隔符
+     * @param header 是否包含表头
+     * @param autoType 是否自动推断类型
+     * @param encoding 文件编码
+     * @param skipLines 跳过行数
+     * @param nullValues 空值标识列表
+     * @param trimValues 是否修剪值
+     * @param prefetch 预先读好的批数
      */
-    private fun readCSVBatchWithRecreate(
+    fun readCSVBatches(
         inputStream: InputStream,
-        batchSize: Int = 1000,
-        callback: (DataFrame) -> Unit,
+        batchSize: Int = DEFAULT_BATCH_SIZE,
         delimiter: String = ",",
         header: Boolean = true,
         autoType: Boolean = true,
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
-    ) {
-        // 重新创建reader（因为之前的reader已经关闭）
-        val reader = BufferedReader(InputStreamReader(inputStream, encoding))
-        
-        try {
-            // 跳过指定行数
-            var linesSkipped = 0
-            while (linesSkipped < skipLines) {
-                val line = reader.readLine()
-                if (line == null) return
-                linesSkipped++
-            }
-            
-            // 读取第一行
-            val firstLine = reader.readLine()
-            if (firstLine == null) return
-            
-            // 解析表头
-            val headers: List<String>
-            if (header) {
-                headers = DataFrame.parseCSVLine(firstLine, delimiter, trimValues)
-            } else {
-                val firstLineValues = DataFrame.parseCSVLine(firstLine, delimiter, trimValues)
-                headers = firstLineValues.indices.map { "col$it" }
-            }
-            
-            // 推断类型（使用第一行数据）
-            val columnTypes = mutableMapOf<String, (String) -> Any?>()
-            if (autoType) {
-                val firstDataRow = if (header) reader.readLine() else firstLine
-                if (firstDataRow != null) {
-                    val firstLineValues = DataFrame.parseCSVLine(firstDataRow, delimiter, trimValues)
-                    val adjustedFirstValues = if (firstLineValues.size < headers.size) {
-                        firstLineValues + List(headers.size - firstLineValues.size) { "" }
-                    } else if (firstLineValues.size > headers.size) {
-                        firstLineValues.take(headers.size)
-                    } else {
-                        firstLineValues
-                    }
-                    
-                    headers.forEachIndexed { index, headerName ->
-                        val firstValue = adjustedFirstValues.getOrNull(index) ?: ""
-                        val inferredType = DataFrame.inferTypeFromSample(firstValue, nullValues)
-                        columnTypes[headerName] = { value ->
-                            if (value in nullValues) null
-                            else DataFrame.convertValueWithType(value, inferredType)
-                        }
-                    }
-                }
+        trimValues: Boolean = true,
+        prefetch: Int = DEFAULT_PREFETCH
+    ): PrefetchIterator<DataFrame> {
+        if (batchSize <= 0) {
+            throw IllegalArgumentException("批大小必须为正数: $batchSize")
+        }
+        return PrefetchIterator<DataFrame>(prefetch, "andas-csv-reader") { emit ->
+            inputStream.use {
+                DataFrameIO.readCSVBatch(
+                    it, batchSize, emit, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues
+                )
             }
-            
-            // 开始逐行处理
-            processBatchLineByLine(reader, headers, batchSize, callback, delimiter, autoType, columnTypes, nullValues, trimValues)
-            
-        } catch (e: Exception) {
-            throw RuntimeException("读取数据流失败: ${e.message}", e)
-        } finally {
-            reader.close()
         }
     }
 
     /**
-     * 逐行处理批次数据 - 真正的流式处理
+     * 分批流水线处理CSV数据流：读取解析、逐批计算、交付结果三个阶段同时进行
+     *
+     * 后台线程读取解析（同 [readCSVBatches]），workers 个工作线程对各批执行 transform，
+     * 结果在调用线程上交给 consumer。各阶段之间是有界队列，consumer 跟不上时读取随之暂停，
+     * 内存中的批数与文件大小无关
+     *
+     * 例：`processCSVBatches(input, { it["price"].sum() }, { total += it })`
+     *
+     * @param inputStream CSV数据流，处理完后关闭
+     * @param transform 每批的计算，在工作线程上执行，须线程安全
+     * @param consumer 结果的处理，在调用线程上逐个执行
+     * @param batchSize 批处理大小
+     * @param workers 工作线程数
+     * @param ordered true 时按批次顺序交付结果，false 时按完成顺序交付
+     * @param delimiter 分隔符
+     * @param header 是否包含表头
+     * @param autoType 是否自动推断类型
+     * @param encoding 文件编码
+     * @param skipLines 跳过行数
+     * @param nullValues 空值标识列表
+     * @param trimValues 是否修剪值
      */
-    private fun processBatchLineByLine(
-        reader: BufferedReader,
-        headers: List<String>,
-        batchSize: Int,
-        callback: (DataFrame) -> Unit,
-        delimiter: String,
-        autoType: Boolean,
-        columnTypes: Map<String, (String) -> Any?>,
-        nullValues: List<String>,
-        trimValues: Boolean
+    fun <R> processCSVBatches(
+        inputStream: InputStream,
+        transform: (DataFrame) -> R,
+        consumer: (R) -> Unit,
+        batchSize: Int = DEFAULT_BATCH_SIZE,
+        workers: Int = Runtime.getRuntime().availableProcessors(),
+        ordered: Boolean = true,
+        delimiter: String = ",",
+        header: Boolean = true,
+        autoType: Boolean = true,
+        encoding: String = "UTF-8",
+        skipLines: Int = 0,
+        nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+        trimValues: Boolean = true
     ) {
-        var currentBatch = mutableListOf<Map<String, Any?>>()
-        
-        reader.useLines { lines ->
-            for (line in lines) {
-                try {
-                    val values = DataFrame.parseCSVLine(line, delimiter, trimValues)
-                    
-                    // 处理列数不匹配的情况
-                    val adjustedValues = if (values.size < headers.size) {
-                        values + List(headers.size - values.size) { "" }
-                    } else if (values.size > headers.size) {
-                        values.take(headers.size)
-                    } else {
-                        values
-                    }
-                    
-                    val rowMap = headers.zip(adjustedValues).toMap()
-                    
-                    val processedRow = if (autoType) {
-                        rowMap.mapValues { (key, value) ->
-                            val converter = columnTypes[key]
-                            if (converter != null) {
-                                converter(value)
-                            } else {
-                                if (value in nullValues) null else value
-                            }
-                        }
-                    } else {
-                        rowMap.mapValues { (_, value) ->
-                            if (value in nullValues) null else value
-                        }
-                    }
-                    
-                    currentBatch.add(processedRow)
-                    
-                    // 当批次达到指定大小时，调用回调函数
-                    if (currentBatch.size >= batchSize) {
-                        callback(DataFrame(currentBatch))
-                        currentBatch.clear()
-                    }
-                } catch (e: Exception) {
-                    throw RuntimeException("解析行失败: $line", e)
-                }
-            }
-        }
-        
-        // 处理剩余数据
-        if (currentBatch.isNotEmpty()) {
-            callback(DataFrame(currentBatch))
+        if (workers <= 0) throw IllegalArgumentException("工作线程数必须为正数: $workers")
+        readCSVBatches(
+            inputStream, batchSize, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues, workers
+        ).use { batches ->
+            BatchPipeline.run(batches, workers, ordered, transform, consumer)
         }
     }
 
+    /**
+     * 以CSV数据流为数据源创建延迟执行的 [LazyFrame]
+     * collect 时流式读取，只解析查询计划用到的列，筛选在读取每批时完成；只能执行一次，不会关闭数据流
+     *
+     * 例：`scanCSV(input).filterGreaterThan("price", 10.0).groupBySum("city", "qty").collect()`
+     */
+    fun scanCSV(
+        inputStream: InputStream,
+        delimiter: String = ",",
+        header: Boolean = true,
+        autoType: Boolean = true,
+        encoding: String = "UTF-8",
+        skipLines: Int = 0,
+        nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+        trimValues: Boolean = true
+    ): LazyFrame {
+        val options = DataFrameIO.csvOptions(delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+        return LazyFrame.scanCsv(inputStream, options)
+    }
+
     /**
      * 对CSV数据流的指定数值列进行分批求和
      *
@@ -308,21 +241,9 @@ object BatchCSVUtils {
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
         trimValues: Boolean = true
     ): Double {
-        var totalSum = 0.0
-
-        readCSVBatch(inputStream, batchSize, { batchDF ->
-            // 使用与batchMean相同的逻辑：手动计算，避免原生库的差异
-            val series = batchDF[colName]
-            val values = series.values()
-                .filterNotNull()
-                .map { (it as Number).toDouble() }
-            
-            if (values.isNotEmpty()) {
-                totalSum += values.sum()
-            }
-        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
-
-        return totalSum
+        return batchMoments(
+            inputStream, colName, batchSize, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues
+        ).sum
     }
 
     /**
@@ -466,23 +387,9 @@ object BatchCSVUtils {
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
         trimValues: Boolean = true
     ): Double {
-        var totalSum = 0.0
-        var totalCount = 0L
-
-        readCSVBatch(inputStream, batchSize, { batchDF ->
-            // 使用与batchSum相同的逻辑：手动计算，避免原生库的差异
-            val series = batchDF[colName]
-            val values = series.values()
-                .filterNotNull()
-                .map { (it as Number).toDouble() }
-            
-            if (values.isNotEmpty()) {
-                totalSum += values.sum()
-                totalCount += values.size
-            }
-        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
-
-        return if (totalCount > 0) totalSum / totalCount else Double.NaN
+        return batchMoments(
+            inputStream, colName, batchSize, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues
+        ).mean
     }
 
     /**
@@ -498,7 +405,8 @@ object BatchCSVUtils {
      * @param skipLines 跳过行数
      * @param nullValues 空值标识列表
      * @param trimValues 是否修剪值
-     * @return 标准差结果
+     * @param ddof 自由度修正，默认 1（样本标准差）
+     * @return 标准差结果，有效值不超过 ddof 个时为 NaN
      */
     fun batchStd(
         inputStream: InputStream,
@@ -510,33 +418,49 @@ object BatchCSVUtils {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        ddof: Int = 1
     ): Double {
-        // 使用流式处理计算标准差
-        var count = 0L
-        var sum = 0.0
-        var sumSquared = 0.0
+        return batchMoments(
+            inputStream, colName, batchSize, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues
+        ).std(ddof)
+    }
 
-        readCSVBatch(inputStream, batchSize, { batchDF ->
-            val series = batchDF[colName]
-            val values = series.values()
-                .filterNotNull()
-                .map { (it as Number).toDouble() }
+    /**
+     * 对CSV数据流的指定数值列进行分批矩统计
+     * 每批计算一个矩累加器后合并，不保留已读数据；count/sum/mean/方差/偏度/峰度/最值都可从结果得到
+     *
+     * @param inputStream CSV数据流
+     * @param colName 要统计的列名
+     * @param batchSize 批处理大小
+     * @param delimiter 分隔符
+     * @param header 是否包含表头
+     * @param autoType 是否自动推断类型
+     * @param encoding 文件编码
+     * @param skipLines 跳过行数
+     * @param nullValues 空值标识列表
+     * @param trimValues 是否修剪值
+     * @return 全部批次合并后的矩累加器
+     */
+    fun batchMoments(
+        inputStream: InputStream,
+        colName: String,
+        batchSize: Int = DEFAULT_BATCH_SIZE,
+        delimiter: String = ",",
+        header: Boolean = true,
+        autoType: Boolean = true,
+        encoding: String = "UTF-8",
+        skipLines: Int = 0,
+        nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+        trimValues: Boolean = true
+    ): MomentAccumulator {
+        val moments = MomentAccumulator()
 
-            if (values.isNotEmpty()) {
-                count += values.size
-                sum += values.sum()
-                sumSquared += values.sumOf { it * it }
-            }
+        readCSVBatch(inputStream, batchSize, { batchDF ->
+            moments.merge(batchDF[colName].moments())
         }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
 
-        if (count == 0L) {
-            return Double.NaN
-        }
-
-        val mean = sum / count
-        val variance = if (count > 1) (sumSquared - sum * sum / count) / (count - 1) else 0.0
-        return if (variance > 0) kotlin.math.sqrt(variance) else 0.0
+        return moments
     }
 
     /**
@@ -649,7 +573,8 @@ object BatchCSVUtils {
      * @param skipLines 跳过行数
      * @param nullValues 空值标识列表
      * @param trimValues 是否修剪值
-     * @return 包含count, mean, std, min, max的Map
+     * @param percentiles 输出的分位数，由各批的分位数摘要合并后计算
+     * @return 包含count, mean, std, min, 各分位数, max的Map
      */
     fun batchDescribe(
         inputStream: InputStream,
@@ -661,53 +586,19 @@ object BatchCSVUtils {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        percentiles: List<Double> = QuantileSketch.DEFAULT_PERCENTILES
     ): Map<String, Double> {
-        // 使用流式处理收集统计信息
-        var count = 0L
-        var sum = 0.0
-        var sumSquared = 0.0
-        var minValue = Double.POSITIVE_INFINITY
-        var maxValue = Double.NEGATIVE_INFINITY
-        var hasValues = false
+        val moments = MomentAccumulator()
+        val sketch = QuantileSketch()
 
         readCSVBatch(inputStream, batchSize, { batchDF ->
             val series = batchDF[colName]
-            val values = series.values()
-                .filterNotNull()
-                .map { (it as Number).toDouble() }
-
-            if (values.isNotEmpty()) {
-                hasValues = true
-                count += values.size
-                sum += values.sum()
-                sumSquared += values.sumOf { it * it }
-                minValue = minOf(minValue, values.minOrNull() ?: Double.POSITIVE_INFINITY)
-                maxValue = maxOf(maxValue, values.maxOrNull() ?: Double.NEGATIVE_INFINITY)
-            }
+            moments.merge(series.moments())
+            sketch.merge(series.quantileSketch())
         }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
 
-        if (!hasValues || count == 0L) {
-            return mapOf(
-                "count" to 0.0,
-                "mean" to Double.NaN,
-                "std" to Double.NaN,
-                "min" to Double.NaN,
-                "max" to Double.NaN
-            )
-        }
-
-        val mean = sum / count
-        val variance = if (count > 1) (sumSquared - sum * sum / count) / (count - 1) else 0.0
-        val std = if (variance > 0) kotlin.math.sqrt(variance) else 0.0
-
-        return mapOf(
-            "count" to count.toDouble(),
-            "mean" to mean,
-            "std" to std,
-            "min" to minValue,
-            "max" to maxValue
-        )
+        return describeOf(moments, sketch, percentiles)
     }
 
     /**
@@ -722,6 +613,7 @@ object BatchCSVUtils {
      * @param skipLines 跳过行数
      * @param nullValues 空值标识列表
      * @param trimValues 是否修剪值
+     * @param percentiles 输出的分位数
      * @return 所有数值列的统计描述
      */
     fun batchDescribeAll(
@@ -733,13 +625,12 @@ object BatchCSVUtils {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        percentiles: List<Double> = QuantileSketch.DEFAULT_PERCENTILES
     ): Map<String, Map<String, Double>> {
-        // 先收集所有列名和类型信息
-        val columnStats = mutableMapOf<String, MutableMap<String, Double>>()
-        val columnData = mutableMapOf<String, MutableList<Double>>()
-        
-        // 第一次遍历：收集数据和确定数值列
+        // 每列一个矩累加器和一个分位数摘要，逐批合并，不保留已读数据
+        val columnMoments = linkedMapOf<String, MomentAccumulator>()
+        val columnSketches = hashMapOf<String, QuantileSketch>()
         var numericColumns: Set<String>? = null
         
         readCSVBatch(inputStream, batchSize, { batchDF ->
@@ -751,66 +642,22 @@ object BatchCSVUtils {
                             dtype == AndaTypes.INT32 || dtype == AndaTypes.INT64 ||
                             dtype == AndaTypes.FLOAT32 || dtype == AndaTypes.FLOAT64
                 }.toSet()
-                
-                // 初始化统计容器
                 numericColumns!!.forEach { colName ->
-                    columnStats[colName] = mutableMapOf(
-                        "count" to 0.0,
-                        "mean" to 0.0,
-                        "std" to 0.0,
-                        "min" to Double.POSITIVE_INFINITY,
-                        "max" to Double.NEGATIVE_INFINITY
-                    )
-                    columnData[colName] = mutableListOf()
+                    columnMoments[colName] = MomentAccumulator()
+                    columnSketches[colName] = QuantileSketch()
                 }
             }
             
-            // 收集数据
             numericColumns!!.forEach { colName ->
                 val series = batchDF[colName]
-                val values = series.values()
-                    .filterNotNull()
-                    .map { (it as Number).toDouble() }
-                
-                if (values.isNotEmpty()) {
-                    columnData[colName]!!.addAll(values)
-                }
+                columnMoments[colName]!!.merge(series.moments())
+                columnSketches[colName]!!.merge(series.quantileSketch())
             }
         }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
         
-        // 计算统计量
-        val result = mutableMapOf<String, Map<String, Double>>()
-        numericColumns?.forEach { colName ->
-            val values = columnData[colName] ?: emptyList()
-            if (values.isEmpty()) {
-                result[colName] = mapOf(
-                    "count" to 0.0,
-                    "mean" to Double.NaN,
-                    "std" to Double.NaN,
-                    "min" to Double.NaN,
-                    "max" to Double.NaN
-                )
-            } else {
-                val count = values.size.toDouble()
-                val sum = values.sum()
-                val sumSquared = values.sumOf { it * it }
-                val mean = sum / count
-                val variance = if (count > 1) (sumSquared - sum * sum / count) / (count - 1) else 0.0
-                val std = if (variance > 0) kotlin.math.sqrt(variance) else 0.0
-                val min = values.minOrNull() ?: Double.NaN
-                val max = values.maxOrNull() ?: Double.NaN
-                
-                result[colName] = mapOf(
-                    "count" to count,
-                    "mean" to mean,
-                    "std" to std,
-                    "min" to min,
-                    "max" to max
-                )
-            }
+        return columnMoments.mapValues { (colName, moments) ->
+            describeOf(moments, columnSketches[colName]!!, percentiles)
         }
-        
-        return result
     }
 
     /**
@@ -841,26 +688,11 @@ object BatchCSVUtils {
         trimValues: Boolean = true
     ): DataFrame {
         // 使用流式处理计算均值和标准差
-        var count = 0L
-        var sum = 0.0
-        var sumSquared = 0.0
-
-        readCSVBatch(inputStream, batchSize, { batchDF ->
-            val series = batchDF[colName]
-            val values = series.values()
-                .filterNotNull()
-                .map { (it as Number).toDouble() }
-
-            if (values.isNotEmpty()) {
-                count += values.size
-                sum += values.sum()
-                sumSquared += values.sumOf { it * it }
-            }
-        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
-
-        val mean = sum / count
-        val variance = if (count > 1) (sumSquared - sum * sum / count) / (count - 1) else 0.0
-        val std = if (variance > 0) kotlin.math.sqrt(variance) else 0.0
+        val moments = batchMoments(
+            inputStream, colName, batchSize, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues
+        )
+        val mean = moments.mean
+        val std = moments.std()
 
         // 重新读取数据并进行归一化
         val allRows = mutableListOf<Map<String, Any?>>()
@@ -978,10 +810,10 @@ object BatchCSVUtils {
     }
 
     /**
-     * 对CSV数据流进行分批数据采样
+     * 对CSV数据流进行分批数据采样：蓄水池采样（Algorithm L）只读取一遍数据流，只保留 sampleSize 行
      *
      * @param inputStream CSV数据流
-     * @param sampleSize 采样大小
+     * @param sampleSize 采样大小，数据不足时返回全部行
      * @param batchSize 批处理大小
      * @param delimiter 分隔符
      * @param header 是否包含表头
@@ -990,7 +822,8 @@ object BatchCSVUtils {
      * @param skipLines 跳过行数
      * @param nullValues 空值标识列表
      * @param trimValues 是否修剪值
-     * @return 采样后的DataFrame
+     * @param seed 随机种子，相同种子和相同输入得到相同样本；为 null 时随机选取
+     * @return 采样后的DataFrame，行按在数据流中的先后排列
      */
     fun batchSample(
         inputStream: InputStream,
@@ -1002,42 +835,60 @@ object BatchCSVUtils {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        seed: Long? = null
     ): DataFrame {
-        // 先统计总行数
-        var totalRows = 0L
+        val sampler = ReservoirSampler(maxOf(sampleSize, 0), SamplingEngine.seedOf(seed))
+        // 每个槽位：(在数据流中的行号, 行)
+        val reservoir = arrayOfNulls<Pair<Long, Map<String, Any?>>>(sampler.capacity)
+
         readCSVBatch(inputStream, batchSize, { batchDF ->
-            totalRows += batchDF.shape().first
+            val start = sampler.seen
+            sampler.advance(batchDF.shape().first) { offset, slot ->
+                reservoir[slot] = (start + offset) to rowValues(batchDF, offset)
+            }
         }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
 
-        if (totalRows == 0L) {
-            return DataFrame(emptyList<Map<String, Any?>>())
-        }
-
-        // 生成随机索引
-        val randomIndices = (0 until totalRows.toLong()).shuffled().take(sampleSize).sorted().toSet()
+        return DataFrame(reservoir.filterNotNull().sortedBy { it.first }.map { it.second })
+    }
 
-        // 重新读取数据并采样
+    /**
+     * 对CSV数据流按比例采样：每行独立地以 fraction 的概率选中（伯努利采样），只读取一遍数据流，
+     * 样本行数的期望为 fraction * 总行数
+     *
+     * @param fraction 采样比例，[0, 1]
+     * @param seed 随机种子，相同种子和相同输入得到相同样本；为 null 时随机选取
+     * @return 采样后的DataFrame，行按在数据流中的先后排列
+     */
+    fun batchSampleFraction(
+        inputStream: InputStream,
+        fraction: Double,
+        batchSize: Int = DEFAULT_BATCH_SIZE,
+        delimiter: String = ",",
+        header: Boolean = true,
+        autoType: Boolean = true,
+        encoding: String = "UTF-8",
+        skipLines: Int = 0,
+        nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+        trimValues: Boolean = true,
+        seed: Long? = null
+    ): DataFrame {
+        val sampler = BernoulliSampler(fraction, SamplingEngine.seedOf(seed))
         val sampledRows = mutableListOf<Map<String, Any?>>()
-        var rowIndex = 0L
 
         readCSVBatch(inputStream, batchSize, { batchDF ->
-            val indexList = batchDF.index()
-            for (i in indexList.indices) {
-                val globalIndex = rowIndex + i.toLong()  // 将 i 转换为 Long
-                if (globalIndex in randomIndices) {
-                    val row = batchDF.iloc(i)
-                    val rowValues = row.mapValues { (_, series) -> series?.get(0) }
-                    sampledRows.add(rowValues)
-                }
+            sampler.advance(batchDF.shape().first) { offset ->
+                sampledRows.add(rowValues(batchDF, offset))
             }
-
-            rowIndex += batchDF.shape().first
         }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
 
         return DataFrame(sampledRows)
     }
 
+    private fun rowValues(batchDF: DataFrame, row: Int): Map<String, Any?> {
+        return batchDF.columns().associateWith { colName -> batchDF[colName][row] }
+    }
+
     /**
      * 对CSV数据流的指定列进行分批自定义聚合
      *
@@ -1630,10 +1481,12 @@ object BatchCSVUtils {
     }
 
     /**
-     * 对CSV数据流进行分批分组计数
+     * 对CSV数据流的指定列进行分批近似去重计数（HyperLogLog）
+     * 每批构建一个摘要后合并，内存固定为 2^precision 字节，默认精度下标准误差约 0.8%
      *
      * @param inputStream CSV数据流
-     * @param groupCol 分组列名
+     * @param colName 列名
+     * @param precision HyperLogLog 精度（4~18）
      * @param batchSize 批处理大小
      * @param delimiter 分隔符
      * @param header 是否包含表头
@@ -1642,6 +1495,129 @@ object BatchCSVUtils {
      * @param skipLines 跳过行数
      * @param nullValues 空值标识列表
      * @param trimValues 是否修剪值
+     * @return 去重个数的估计值
+     */
+    fun batchApproxNunique(
+        inputStream: InputStream,
+        colName: String,
+        precision: Int = DistinctCountSketch.DEFAULT_PRECISION,
+        batchSize: Int = DEFAULT_BATCH_SIZE,
+        delimiter: String = ",",
+        header: Boolean = true,
+        autoType: Boolean = true,
+        encoding: String = "UTF-8",
+        skipLines: Int = 0,
+        nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+        trimValues: Boolean = true
+    ): Long {
+        val sketch = DistinctCountSketch(precision)
+
+        readCSVBatch(inputStream, batchSize, { batchDF ->
+            sketch.merge(batchDF[colName].distinctSketch(sketch.precision))
+        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+
+        return sketch.count()
+    }
+
+    /**
+     * 对CSV数据流的指定数值列进行分批近似分位数计算（KLL）
+     * 每批构建一个摘要后合并，内存与数据量无关
+     *
+     * @param inputStream CSV数据流
+     * @param colName 列名
+     * @param quantiles 要计算的分位数，位于 [0, 1]
+     * @param batchSize 批处理大小
+     * @param delimiter 分隔符
+     * @param header 是否包含表头
+     * @param autoType 是否自动推断类型
+     * @param encoding 文件编码
+     * @param skipLines 跳过行数
+     * @param nullValues 空值标识列表
+     * @param trimValues 是否修剪值
+     * @return 与 quantiles 一一对应的分位数，没有有效值时为 NaN
+     */
+    fun batchApproxQuantile(
+        inputStream: InputStream,
+        colName: String,
+        quantiles: List<Double>,
+        batchSize: Int = DEFAULT_BATCH_SIZE,
+        delimiter: String = ",",
+        header: Boolean = true,
+        autoType: Boolean = true,
+        encoding: String = "UTF-8",
+        skipLines: Int = 0,
+        nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+        trimValues: Boolean = true
+    ): List<Double> {
+        val sketch = QuantileSketch()
+
+        readCSVBatch(inputStream, batchSize, { batchDF ->
+            sketch.merge(batchDF[colName].quantileSketch())
+        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+
+        return sketch.quantiles(quantiles)
+    }
+
+    /**
+     * 对CSV数据流的指定列进行分批高频项统计（Space-Saving）
+     * 每批构建一个摘要后合并；数值按值比较（各批推断的类型可以不同），整数值以 Long 返回
+     *
+     * @param inputStream CSV数据流
+     * @param colName 列名
+     * @param k 返回的项数
+     * @param batchSize 批处理大小
+     * @param delimiter 分隔符
+     * @param header 是否包含表头
+     * @param autoType 是否自动推断类型
+     * @param encoding 文件编码
+     * @param skipLines 跳过行数
+     * @param nullValues 空值标识列表
+     * @param trimValues 是否修剪值
+     * @return 出现次数最多的 k 个值及其估计次数，按次数降序
+     */
+    fun batchTopK(
+        inputStream: InputStream,
+        colName: String,
+        k: Int,
+        batchSize: Int = DEFAULT_BATCH_SIZE,
+        delimiter: String = ",",
+        header: Boolean = true,
+        autoType: Boolean = true,
+        encoding: String = "UTF-8",
+        skipLines: Int = 0,
+        nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+        trimValues: Boolean = true
+    ): Map<Any, Long> {
+        val capacity = maxOf(HeavyHitters.DEFAULT_CAPACITY, k * 4)
+        val sketch = HeavyHitters<Any>(capacity)
+
+        readCSVBatch(inputStream, batchSize, { batchDF ->
+            sketch.merge(batchDF[colName].heavyHitters(capacity, ::normalizedNumber))
+        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+
+        return sketch.top(k).associate { it.value to it.count }
+    }
+
+    // 整数值统一为 Long，使各批推断为不同数值类型时同一个值仍然合并
+    private fun normalizedNumber(value: Double): Any {
+        return if (value == Math.rint(value) && abs(value) < 9.007199254740992E15) value.toLong() else value
+    }
+
+    /**
+     * 对CSV数据流进行分批分组计数
+     * 分组数超过内存预算时把部分结果溢写到临时文件，见 [batchGroupByAggregate]
+     *
+     * @param inputStream CSV数据流
+     * @param groupCol 分组列名
+     * @param batchSize 批处理大小
+     * @param delimiter 分隔符
+     * @param header 是否包含表头
+     * @param autoType 是否自动推断类型
+     * @param encoding 文件编码
+     * @param skipLines 跳过行数
+     * @param nullValues 空值标识列表
+     * @param trimValues 是否修剪值
+     * @param memoryBudget 分组状态的内存预算（字节）
      * @return 各分组的计数
      */
     fun batchGroupByCount(
@@ -1654,24 +1630,24 @@ object BatchCSVUtils {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        memoryBudget: Long = SpillEngine.memoryBudget
     ): Map<Any?, Long> {
         val groupCounts = mutableMapOf<Any?, Long>()
 
-        readCSVBatch(inputStream, batchSize, { batchDF ->
-            val groupSeries = batchDF[groupCol]
-            groupSeries.values().forEach { value ->
-                if (value != null) {
-                    groupCounts[value] = (groupCounts[value] ?: 0L) + 1L
-                }
-            }
-        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+        spillGroupBy(
+            inputStream, groupCol, null, batchSize, delimiter, header, autoType, encoding, skipLines,
+            nullValues, trimValues, memoryBudget
+        ) { keys, groups ->
+            for (g in 0 until groups.size) groupCounts[keys[g]] = groups.rows[g]
+        }
 
         return groupCounts
     }
 
     /**
      * 对CSV数据流进行分批分组求和
+     * 分组数超过内存预算时把部分结果溢写到临时文件，见 [batchGroupByAggregate]
      *
      * @param inputStream CSV数据流
      * @param groupCol 分组列名
@@ -1684,7 +1660,8 @@ object BatchCSVUtils {
      * @param skipLines 跳过行数
      * @param nullValues 空值标识列表
      * @param trimValues 是否修剪值
-     * @return 各分组的求和结果
+     * @param memoryBudget 分组状态的内存预算（字节）
+     * @return 各分组的求和结果，只包含至少有一个非空值的分组
      */
     fun batchGroupBySum(
         inputStream: InputStream,
@@ -1697,31 +1674,26 @@ object BatchCSVUtils {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        memoryBudget: Long = SpillEngine.memoryBudget
     ): Map<Any?, Double> {
         val groupSums = mutableMapOf<Any?, Double>()
 
-        readCSVBatch(inputStream, batchSize, { batchDF ->
-            val groupSeries = batchDF[groupCol]
-            val valueSeries = batchDF[valueCol]
-
-            val indexList = batchDF.index()
-            for (i in indexList.indices) {
-                val groupKey = groupSeries[i]
-                val value = valueSeries[i]
-
-                if (groupKey != null && value != null) {
-                    val currentValue = groupSums[groupKey] ?: 0.0
-                    groupSums[groupKey] = currentValue + (value as Number).toDouble()
-                }
+        spillGroupBy(
+            inputStream, groupCol, valueCol, batchSize, delimiter, header, autoType, encoding, skipLines,
+            nullValues, trimValues, memoryBudget
+        ) { keys, groups ->
+            for (g in 0 until groups.size) {
+                if (groups.counts[g] > 0) groupSums[keys[g]] = groups.sums[g]
             }
-        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+        }
 
         return groupSums
     }
 
     /**
      * 对CSV数据流进行分批分组均值计算
+     * 分组数超过内存预算时把部分结果溢写到临时文件，见 [batchGroupByAggregate]
      *
      * @param inputStream CSV数据流
      * @param groupCol 分组列名
@@ -1734,7 +1706,8 @@ object BatchCSVUtils {
      * @param skipLines 跳过行数
      * @param nullValues 空值标识列表
      * @param trimValues 是否修剪值
-     * @return 各分组的均值结果
+     * @param memoryBudget 分组状态的内存预算（字节）
+     * @return 各分组的均值结果，只包含至少有一个非空值的分组
      */
     fun batchGroupByMean(
         inputStream: InputStream,
@@ -1747,37 +1720,132 @@ object BatchCSVUtils {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        memoryBudget: Long = SpillEngine.memoryBudget
     ): Map<Any?, Double> {
-        val groupSums = mutableMapOf<Any?, Double>()
-        val groupCounts = mutableMapOf<Any?, Long>()
+        val groupMeans = mutableMapOf<Any?, Double>()
+
+        spillGroupBy(
+            inputStream, groupCol, valueCol, batchSize, delimiter, header, autoType, encoding, skipLines,
+            nullValues, trimValues, memoryBudget
+        ) { keys, groups ->
+            for (g in 0 until groups.size) {
+                if (groups.counts[g] > 0) groupMeans[keys[g]] = groups.sums[g] / groups.counts[g]
+            }
+        }
 
-        readCSVBatch(inputStream, batchSize, { batchDF ->
-            val groupSeries = batchDF[groupCol]
-            val valueSeries = batchDF[valueCol]
+        return groupMeans
+    }
 
-            val indexList = batchDF.index()
-            for (i in indexList.indices) {
-                val groupKey = groupSeries[i]
-                val value = valueSeries[i]
+    /**
+     * 对CSV数据流进行分批分组聚合，结果逐批回调，适合分组数很多、结果本身放不进内存的场景
+     *
+     * 内存中只保存各组的部分聚合结果（与行数无关）；超过 memoryBudget 时按键的哈希分区写到临时文件，
+     * 输入结束后逐个分区读回合并并回调，一个分区仍然放不下时再分区。没有溢写时只回调一次，分组按首次出现的顺序；
+     * 溢写后每个分组只出现在其中一批，批间没有固定顺序。分组键为空的行不参与分组
+     *
+     * @param inputStream CSV数据流
+     * @param groupCol 分组列名
+     * @param valueCol 数值列名
+     * @param callback 每批分组的回调：列为分组列、size（行数）、count（非空值个数）、sum、mean、min、max，
+     *                 没有非空值的分组 sum 为 0.0，mean/min/max 为 null
+     * @param batchSize 批处理大小
+     * @param delimiter 分隔符
+     * @param header 是否包含表头
+     * @param autoType 是否自动推断类型
+     * @param encoding 文件编码
+     * @param skipLines 跳过行数
+     * @param nullValues 空值标识列表
+     * @param trimValues 是否修剪值
+     * @param memoryBudget 分组状态的内存预算（字节）
+     */
+    fun batchGroupByAggregate(
+        inputStream: InputStream,
+        groupCol: String,
+        valueCol: String,
+        callback: (DataFrame) -> Unit,
+        batchSize: Int = DEFAULT_BATCH_SIZE,
+        delimiter: String = ",",
+        header: Boolean = true,
+        autoType: Boolean = true,
+        encoding: String = "UTF-8",
+        skipLines: Int = 0,
+        nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+        trimValues: Boolean = true,
+        memoryBudget: Long = SpillEngine.memoryBudget
+    ) {
+        spillGroupBy(
+            inputStream, groupCol, valueCol, batchSize, delimiter, header, autoType, encoding, skipLines,
+            nullValues, trimValues, memoryBudget
+        ) { keys, groups ->
+            val n = groups.size
+            callback(
+                DataFrame(
+                    linkedMapOf<String, List<Any?>>(
+                        groupCol to keys,
+                        "size" to groups.rows.toList(),
+                        "count" to groups.counts.toList(),
+                        "sum" to groups.sums.toList(),
+                        "mean" to List(n) { if (groups.counts[it] == 0L) null else groups.sums[it] / groups.counts[it] },
+                        "min" to List(n) { if (groups.counts[it] == 0L) null else groups.mins[it] },
+                        "max" to List(n) { if (groups.counts[it] == 0L) null else groups.maxs[it] }
+                    )
+                )
+            )
+        }
+    }
 
-                if (groupKey != null && value != null) {
-                    val currentValue = groupSums[groupKey] ?: 0.0
-                    groupSums[groupKey] = currentValue + (value as Number).toDouble()
-                    groupCounts[groupKey] = (groupCounts[groupKey] ?: 0L) + 1L
+    /**
+     * 溢写分组：各批的分组键编码为字节串（类型不变），交给 [SpillEngine] 聚合，按分区回调解码后的键和聚合结果
+     * valueCol 为 null 时只计行数
+     */
+    private fun spillGroupBy(
+        inputStream: InputStream,
+        groupCol: String,
+        valueCol: String?,
+        batchSize: Int,
+        delimiter: String,
+        header: Boolean,
+        autoType: Boolean,
+        encoding: String,
+        skipLines: Int,
+        nullValues: List<String>,
+        trimValues: Boolean,
+        memoryBudget: Long,
+        onGroups: (keys: List<Any?>, groups: SpillGroups) -> Unit
+    ) {
+        SpillEngine.openAggregator(memoryBudget).use { aggregator ->
+            readCSVBatch(inputStream, batchSize, { batchDF ->
+                val keys = batchDF[groupCol].values()
+                val values = valueCol?.let { col ->
+                    val series = batchDF[col]
+                    if (series.values().any { it != null && it !is Number }) {
+                        throw IllegalArgumentException("列不是数值类型: $col")
+                    }
+                    series.doublesOrNaN()
                 }
-            }
-        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+                val records = RecordBuilder()
+                val kept = ArrayList<Double>()
+                for (i in keys.indices) {
+                    val key = keys[i] ?: continue
+                    ValueCodec.write(records.out, key)
+                    records.endRecord()
+                    if (values != null) kept.add(values[i])
+                }
+                aggregator.add(records.build(), if (values != null) kept.toDoubleArray() else null)
+            }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+            aggregator.finish()
 
-        // 计算均值
-        return groupSums.mapValues { (key, sum) ->
-            val count = groupCounts[key] ?: 1L
-            sum / count
+            while (true) {
+                val groups = aggregator.next() ?: break
+                onGroups(List(groups.size) { ValueCodec.read(groups.keys.input(it)) }, groups)
+            }
         }
     }
 
     /**
      * 对CSV数据流进行分批排序
+     * 只读一遍数据流，超过内存预算的部分排好序写到临时文件，最后多路归并，见 [batchSortTo]
      *
      * @param inputStream CSV数据流
      * @param colName 排序列名
@@ -1790,7 +1858,8 @@ object BatchCSVUtils {
      * @param skipLines 跳过行数
      * @param nullValues 空值标识列表
      * @param trimValues 是否修剪值
-     * @return 排序后的DataFrame
+     * @param memoryBudget 排序缓冲的内存预算（字节）
+     * @return 排序后的DataFrame，排序稳定，排序列为空的行排在最后
      */
     fun batchSort(
         inputStream: InputStream,
@@ -1803,73 +1872,106 @@ object BatchCSVUtils {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        memoryBudget: Long = SpillEngine.memoryBudget
     ): DataFrame {
-        // 先收集所有数据和索引
-        val allData = mutableListOf<Pair<Int, Double>>()
-        var rowIndex = 0
-        
-        readCSVBatch(inputStream, batchSize, { batchDF ->
-            if (batchDF.isNativeAvailable()) {
-                val series = batchDF[colName]
-                val values = series.values()
-                    .filterNotNull()
-                    .map { (it as Number).toDouble() }
-                
-                values.forEachIndexed { index, value ->
-                    allData.add(Pair(rowIndex + index, value))
-                }
-            } else {
-                val indexList = batchDF.index()
-                for (i in indexList.indices) {
-                    val value = batchDF[colName][i]
-                    if (value != null) {
-                        allData.add(Pair(rowIndex + i, (value as Number).toDouble()))
-                    }
-                }
+        val result = LinkedHashMap<String, MutableList<Any?>>()
+
+        batchSortTo(inputStream, colName, { batchDF ->
+            for (name in batchDF.columns()) {
+                result.getOrPut(name) { mutableListOf() }.addAll(batchDF[name].values())
             }
-            rowIndex += batchDF.shape().first
-        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+        }, descending, batchSize, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues, memoryBudget)
 
-        // 排序
-        val sortedData = if (descending) {
-            allData.sortedByDescending { it.second }
-        } else {
-            allData.sortedBy { it.second }
-        }
+        return DataFrame(result)
+    }
 
-        val sortedIndices = sortedData.map { it.first }.toSet()
+    /**
+     * 对CSV数据流进行外存排序，排序后的数据按 batchSize 行一批回调，整个过程的内存与文件大小无关
+     *
+     * 每行编码为字节串后连同排序键交给 [SpillEngine]：缓冲超过 memoryBudget 时稳定排序后写成一个有序段，
+     * 临时文件放在 [SpillEngine.directory]（初始化后为应用缓存目录），输入结束后多路归并；
+     * 没有超出预算时全部在内存中完成。单元格的类型保持不变
+     *
+     * @param inputStream CSV数据流
+     * @param colName 排序列名，必须是数值列
+     * @param callback 排序后每批数据的回调
+     * @param descending 是否降序
+     * @param batchSize 批处理大小（读取和回调）
+     * @param delimiter 分隔符
+     * @param header 是否包含表头
+     * @param autoType 是否自动推断类型
+     * @param encoding 文件编码
+     * @param skipLines 跳过行数
+     * @param nullValues 空值标识列表
+     * @param trimValues 是否修剪值
+     * @param memoryBudget 排序缓冲的内存预算（字节）
+     */
+    fun batchSortTo(
+        inputStream: InputStream,
+        colName: String,
+        callback: (DataFrame) -> Unit,
+        descending: Boolean = false,
+        batchSize: Int = DEFAULT_BATCH_SIZE,
+        delimiter: String = ",",
+        header: Boolean = true,
+        autoType: Boolean = true,
+        encoding: String = "UTF-8",
+        skipLines: Int = 0,
+        nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+        trimValues: Boolean = true,
+        memoryBudget: Long = SpillEngine.memoryBudget
+    ) {
+        var columns: List<String>? = null
 
-        // 重新读取数据构建结果DataFrame
-        val sortedRows = mutableListOf<Map<String, Any?>>()
-        rowIndex = 0
-        
-        readCSVBatch(inputStream, batchSize, { batchDF ->
-            val indexList = batchDF.index()
-            for (i in indexList.indices) {
-                val globalIndex = rowIndex + i
-                if (globalIndex in sortedIndices) {
-                    val row = batchDF.iloc(i)
-                    val rowValues = row.mapValues { (_, series) -> series?.get(0) }
-                    sortedRows.add(rowValues)
+        SpillEngine.openSorter(descending, memoryBudget).use { sorter ->
+            readCSVBatch(inputStream, batchSize, { batchDF ->
+                val names = columns ?: batchDF.columns().also {
+                    if (colName !in it) throw IllegalArgumentException("列不存在: $colName")
+                    columns = it
+                }
+                if (batchDF.columns() != names) {
+                    throw IllegalArgumentException("各批的列不一致: ${batchDF.columns()} != $names")
+                }
+                val series = batchDF[colName]
+                if (series.values().any { it != null && it !is Number }) {
+                    throw IllegalArgumentException("列 $colName 不是数值类型")
                 }
+                val values = names.map { batchDF[it].values() }
+                val records = RecordBuilder()
+                for (row in 0 until batchDF.shape().first) {
+                    for (column in values) ValueCodec.write(records.out, column[row])
+                    records.endRecord()
+                }
+                sorter.add(series.doublesOrNaN(), records.build())
+            }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+            sorter.finish()
+
+            val names = columns?.takeIf { it.isNotEmpty() } ?: return
+            var pending = names.map { ArrayList<Any?>(batchSize) }
+            fun flush() {
+                val batch = LinkedHashMap<String, List<Any?>>()
+                for ((c, name) in names.withIndex()) batch[name] = pending[c]
+                callback(DataFrame(batch))
+                pending = names.map { ArrayList<Any?>(batchSize) }
             }
-            rowIndex += batchDF.shape().first
-        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
-
-        // 按排序顺序重新排列
-        val indexMap = sortedRows.mapIndexed { index, row -> 
-            val globalIndex = sortedIndices.elementAt(index)
-            globalIndex to row
-        }.toMap()
-
-        val finalRows = sortedData.map { (globalIndex, _) -> indexMap[globalIndex]!! }
-
-        return DataFrame(finalRows)
+            while (true) {
+                val chunk = sorter.next() ?: break
+                for (i in 0 until chunk.size) {
+                    val input = chunk.input(i)
+                    for (column in pending) column.add(ValueCodec.read(input))
+                    if (pending[0].size == batchSize) flush()
+                }
+            }
+            if (pending[0].isNotEmpty()) flush()
+        }
     }
 
     /**
-     * 对CSV数据流进行分批去重
+     * 对CSV数据流进行分批去重，保留每个键第一次出现的行
+     *
+     * 各批的键列编码为跨批次不变的 int64 键，插入原生哈希集合（按哈希分区并行），只取出此前没有出现过的行；
+     * 集合只保存键本身，内存与不同键的个数成正比，与行宽和批数无关
      *
      * @param inputStream CSV数据流
      * @param batchSize 批处理大小
@@ -1880,6 +1982,7 @@ object BatchCSVUtils {
      * @param skipLines 跳过行数
      * @param nullValues 空值标识列表
      * @param trimValues 是否修剪值
+     * @param subset 参与比较的列，默认全部列；值按文本比较（各批推断的类型可能不同），空值与空值相等
      * @return 去重后的DataFrame
      */
     fun batchDropDuplicates(
@@ -1891,24 +1994,31 @@ object BatchCSVUtils {
         encoding: String = "UTF-8",
         skipLines: Int = 0,
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
-        trimValues: Boolean = true
+        trimValues: Boolean = true,
+        subset: List<String>? = null
     ): DataFrame {
-        val seenRows = mutableSetOf<String>()
         val uniqueRows = mutableListOf<Map<String, Any?>>()
+        var seen: DistinctRowSet? = null
+        var encoders: List<StableKeyEncoder> = emptyList()
 
-        readCSVBatch(inputStream, batchSize, { batchDF ->
-            val indexList = batchDF.index()
-            for (i in indexList.indices) {
-                val row = batchDF.iloc(i)
-                val rowString = row.values.joinToString(",") { it?.toString() ?: "" }
-
-                if (!seenRows.contains(rowString)) {
-                    seenRows.add(rowString)
-                    val rowValues = row.mapValues { (_, series) -> series?.get(0) }
-                    uniqueRows.add(rowValues)
+        try {
+            readCSVBatch(inputStream, batchSize, { batchDF ->
+                val keyCols = subset ?: batchDF.columns()
+                keyCols.forEach { colName ->
+                    if (colName !in batchDF.columns()) throw IllegalArgumentException("列不存在: $colName")
                 }
-            }
-        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+                val set = seen ?: DedupEngine.openSet(keyCols.size).also {
+                    seen = it
+                    encoders = List(keyCols.size) { StableKeyEncoder() }
+                }
+                val keys = Array(keyCols.size) { c -> encoders[c].encode(batchDF[keyCols[c]].values()) }
+                for (row in set.insert(keys)) {
+                    uniqueRows.add(rowValues(batchDF, row))
+                }
+            }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+        } finally {
+            seen?.close()
+        }
 
         return DataFrame(uniqueRows)
     }
@@ -2034,6 +2144,64 @@ object BatchCSVUtils {
         return DataFrame(resultRows)
     }
 
+    /**
+     * 对CSV数据流的指定数值列进行分批滑动窗口聚合
+     * 跨批次只保留窗口所需的末尾数据，每行增量更新，不收集整个文件；结果与整列 rolling 相同
+     *
+     * @param inputStream CSV数据流
+     * @param colName 要处理的列名
+     * @param window 窗口行数
+     * @param op 聚合类型
+     * @param minPeriods 窗口内非缺失值少于该数时结果为 null，默认等于 window
+     * @param center 窗口是否居中
+     * @param batchSize 批处理大小
+     * @param delimiter 分隔符
+     * @param header 是否包含表头
+     * @param autoType 是否自动推断类型
+     * @param encoding 文件编码
+     * @param skipLines 跳过行数
+     * @param nullValues 空值标识列表
+     * @param trimValues 是否修剪值
+     * @return 与输入行一一对应的结果，名称形如 "price_rolling_5_mean"
+     */
+    fun batchRolling(
+        inputStream: InputStream,
+        colName: String,
+        window: Int,
+        op: RollingOp,
+        minPeriods: Int? = null,
+        center: Boolean = false,
+        batchSize: Int = DEFAULT_BATCH_SIZE,
+        delimiter: String = ",",
+        header: Boolean = true,
+        autoType: Boolean = true,
+        encoding: String = "UTF-8",
+        skipLines: Int = 0,
+        nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
+        trimValues: Boolean = true
+    ): Series<Double> {
+        val accumulator = RollingAccumulator(op, window, minPeriods, center)
+        val results = mutableListOf<DoubleArray>()
+
+        readCSVBatch(inputStream, batchSize, { batchDF ->
+            val series = batchDF[colName]
+            if (series.values().any { it != null && it !is Number }) {
+                throw IllegalArgumentException("列 $colName 不是数值类型")
+            }
+            results.add(accumulator.update(series.doublesOrNaN()))
+        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
+        results.add(accumulator.finish())
+
+        val values = DoubleArray(results.sumOf { it.size })
+        var offset = 0
+        for (part in results) {
+            part.copyInto(values, offset)
+            offset += part.size
+        }
+        val name = "${colName}_rolling_${window}_${op.name.lowercase()}"
+        return Series.wrap(DoubleColumn.nanAsNull(values), (0 until values.size).toList(), name, AndaTypes.FLOAT64)
+    }
+
     /**
      * 对CSV数据流进行分批累积计算（如累积和、累积均值）
      *
@@ -2132,7 +2300,7 @@ object BatchCSVUtils {
      * 对CSV数据流进行分批数据聚合（多列多操作）
      *
      * @param inputStream CSV数据流
-     * @param operations 操作映射：列名 -> 操作类型列表
+     * @param operations 操作映射：列名 -> 操作类型列表（sum, mean, min, max, std, var, skew, kurt, count）
      * @param batchSize 批处理大小
      * @param delimiter 分隔符
      * @param header 是否包含表头
@@ -2155,41 +2323,33 @@ object BatchCSVUtils {
         nullValues: List<String> = listOf("", "null", "NULL", "NA", "N/A"),
         trimValues: Boolean = true
     ): DataFrame {
-        val results = mutableMapOf<String, List<Double>>()
         val rowLabels = mutableListOf<String>()
-
-        // 为每个列和操作组合初始化结果
         operations.forEach { (colName, ops) ->
-            ops.forEach { op ->
-                rowLabels.add("${colName}_${op}")
-                results["${colName}_${op}"] = emptyList()
-            }
+            ops.forEach { op -> rowLabels.add("${colName}_${op}") }
         }
 
-        // 分批处理
+        // 每列一个矩累加器，逐批合并；各项统计量都由合并结果得到，而不是对各批结果取平均
+        val columnMoments = operations.keys.associateWith { MomentAccumulator() }
         readCSVBatch(inputStream, batchSize, { batchDF ->
-            operations.forEach { (colName, ops) ->
-                ops.forEach { op ->
-                    val value = when (op.lowercase()) {
-                        "sum" -> batchDF.sum(colName)
-                        "mean" -> batchDF.mean(colName)
-                        "min" -> batchDF.min(colName)
-                        "max" -> batchDF.max(colName)
-                        "std" -> batchDF.std(colName)
-                        "count" -> batchDF[colName].values().count { it != null }.toDouble()
-                        else -> Double.NaN
-                    }
-                    val key = "${colName}_${op}"
-                    results[key] = results[key]!! + value
-                }
-            }
-        })
+            columnMoments.forEach { (colName, moments) -> moments.merge(batchDF[colName].moments()) }
+        }, delimiter, header, autoType, encoding, skipLines, nullValues, trimValues)
 
-        // 计算最终结果（对批次结果进行聚合）
-        val finalResults = results.mapValues { (_, values) ->
-            when {
-                values.isEmpty() -> Double.NaN
-                else -> values.average()
+        val finalResults = mutableMapOf<String, Double>()
+        operations.forEach { (colName, ops) ->
+            val moments = columnMoments[colName]!!
+            ops.forEach { op ->
+                finalResults["${colName}_${op}"] = when (op.lowercase()) {
+                    "sum" -> moments.sum
+                    "mean" -> moments.mean
+                    "min" -> moments.min
+                    "max" -> moments.max
+                    "std" -> moments.std()
+                    "var" -> moments.variance()
+                    "skew" -> moments.skew()
+                    "kurt" -> moments.kurt()
+                    "count" -> moments.count.toDouble()
+                    else -> Double.NaN
+                }
             }
         }
 
@@ -5,6 +5,7 @@ import cn.ac.oac.libs.andas.entity.Series
 import cn.ac.oac.libs.andas.core.NativeBatch
 import cn.ac.oac.libs.andas.core.NativeData
 import cn.ac.oac.libs.andas.core.NativeMath
+import cn.ac.oac.libs.andas.core.MomentAccumulator
 import cn.ac.oac.libs.andas.types.AndaTypes
 
 /**
@@ -137,15 +138,7 @@ object BatchUtils {
      * @return 均值结果
      */
     fun batchMean(dataFrame: DataFrame, colName: String, batchSize: Int = DEFAULT_BATCH_SIZE): Double {
-        val series = dataFrame[colName]
-        val values = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-        
-        if (values.isEmpty()) return Double.NaN
-        
-        val totalSum = batchSum(dataFrame, colName, batchSize)
-        return totalSum / values.size
+        return batchMoments(dataFrame, colName, batchSize).mean
     }
     
     /**
@@ -154,35 +147,29 @@ object BatchUtils {
      * @param dataFrame 要处理的DataFrame
      * @param colName 要计算标准差的列名
      * @param batchSize 批处理大小
-     * @return 标准差结果
+     * @param ddof 自由度修正，默认 1（样本标准差）
+     * @return 标准差结果，有效值不超过 ddof 个时为 NaN
      */
-    fun batchStd(dataFrame: DataFrame, colName: String, batchSize: Int = DEFAULT_BATCH_SIZE): Double {
-        if (!dataFrame.isNativeAvailable()) {
-            return dataFrame.std(colName)
-        }
-        
-        val series = dataFrame[colName]
-        val values = series.values()
-            .filterNotNull()
-            .map { (it as Number).toDouble() }
-        
-        if (values.size < 2) return Double.NaN
-        
-        // 分批计算均值
-        val mean = batchMean(dataFrame, colName, batchSize)
-        
-        // 分批计算方差
-        var sumSquaredDiff = 0.0
+    fun batchStd(dataFrame: DataFrame, colName: String, batchSize: Int = DEFAULT_BATCH_SIZE, ddof: Int = 1): Double {
+        return batchMoments(dataFrame, colName, batchSize).std(ddof)
+    }
+    
+    /**
+     * 分批计算矩统计量：每批一个矩累加器，按批合并，只扫描一遍
+     * 
+     * @param dataFrame 要处理的DataFrame
+     * @param colName 要统计的列名
+     * @param batchSize 批处理大小
+     * @return 合并后的矩累加器
+     */
+    fun batchMoments(dataFrame: DataFrame, colName: String, batchSize: Int = DEFAULT_BATCH_SIZE): MomentAccumulator {
+        if (batchSize <= 0) throw IllegalArgumentException("批处理大小必须大于0: $batchSize")
+        val values = dataFrame[colName].doublesOrNaN()
+        val moments = MomentAccumulator()
         for (i in values.indices step batchSize) {
-            val end = minOf(i + batchSize, values.size)
-            val batch = values.subList(i, end).toDoubleArray()
-            
-            // 计算批次的平方差和
-            val batchSumSquaredDiff = batch.sumOf { (it - mean) * (it - mean) }
-            sumSquaredDiff += batchSumSquaredDiff
+            moments.merge(MomentAccumulator.of(values.copyOfRange(i, minOf(i + batchSize, values.size))))
         }
-        
-        return kotlin.math.sqrt(sumSquaredDiff / (values.size - 1))
+        return moments
     }
     
     /**
@@ -633,40 +620,17 @@ object BatchUtils {
      * 
      * @param dataFrame 要处理的DataFrame
      * @param sampleSize 采样大小
-     * @param batchSize 批处理大小
+     * @param batchSize 批处理大小（采样只生成行号，不需要分批）
+     * @param seed 随机种子，相同种子得到相同的样本；为 null 时随机选取
      * @return 采样后的DataFrame
      */
     fun batchSample(
         dataFrame: DataFrame,
         sampleSize: Int,
-        batchSize: Int = DEFAULT_BATCH_SIZE
+        batchSize: Int = DEFAULT_BATCH_SIZE,
+        seed: Long? = null
     ): DataFrame {
-        if (!dataFrame.isNativeAvailable()) {
-            return dataFrame.sample(sampleSize)
-        }
-        
-        val indexList = dataFrame.index()
-        if (indexList.isEmpty()) {
-            return dataFrame
-        }
-        
-        // 使用随机采样（简单实现）
-        val totalSize = indexList.size
-        if (sampleSize >= totalSize) {
-            return dataFrame
-        }
-        
-        // 生成随机索引
-        val randomIndices = (0 until totalSize).shuffled().take(sampleSize).sorted()
-        
-        // 构建采样结果
-        val sampledRows = randomIndices.map { i ->
-            dataFrame.columns().associate { colName -> 
-                colName to dataFrame[colName][i] 
-            }
-        }
-        
-        return DataFrame(sampledRows)
+        return dataFrame.sample(sampleSize, seed)
     }
     
     /**
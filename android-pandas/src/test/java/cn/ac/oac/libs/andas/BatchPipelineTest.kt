@@ -0,0 +1,118 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.PrefetchIterator
+import cn.ac.oac.libs.andas.utils.BatchCSVUtils
+import org.junit.Test
+import org.junit.Assert.*
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * 流水线读取测试：预读迭代器的顺序、背压、提前关闭和异常传递，以及多线程逐批计算
+ */
+class BatchPipelineTest {
+
+    private val csv = "id,value\n" + (1..2500).joinToString("\n") { "$it,${it % 17}" } + "\n"
+
+    @Test
+    fun testPrefetchIterator() {
+        println("=== 测试 预读迭代器 ===")
+        // 背压：调用方不取时，后台最多领先 capacity 个元素（加上一个阻塞在 put 上的）
+        val produced = AtomicInteger()
+        val iterator = PrefetchIterator<Int>(3, "test-producer") { emit ->
+            for (i in 0 until 1000) {
+                produced.incrementAndGet()
+                emit(i)
+            }
+        }
+        iterator.use {
+            Thread.sleep(100)
+            assertTrue(produced.get() <= 4)
+            for (expected in 0 until 10) assertEquals(expected, it.next())
+            Thread.sleep(50)
+            assertTrue(produced.get() <= 14)
+        }
+        // 关闭后后台线程已退出
+        val stopped = produced.get()
+        Thread.sleep(50)
+        assertEquals(stopped, produced.get())
+
+        // 异常在之前的元素之后抛出
+        val failing = PrefetchIterator<Int>(2, "test-failing") { emit ->
+            emit(1)
+            emit(2)
+            throw IllegalStateException("读取失败")
+        }
+        failing.use {
+            assertEquals(listOf(1, 2), listOf(it.next(), it.next()))
+            assertThrows(IllegalStateException::class.java) { it.hasNext() }
+            assertFalse(it.hasNext())
+        }
+        assertThrows(IllegalArgumentException::class.java) { PrefetchIterator<Int>(0, "test") { } }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testReadBatches() {
+        println("=== 测试 预读分批读取 ===")
+        val expected = mutableListOf<Any?>()
+        BatchCSVUtils.readCSVBatch(csv.byteInputStream(), 300, { expected.addAll(it["id"].values()) }, prefetch = 0)
+        assertEquals((1..2500).toList(), expected)
+
+        val prefetched = mutableListOf<Any?>()
+        val sizes = mutableListOf<Int>()
+        BatchCSVUtils.readCSVBatch(csv.byteInputStream(), 300, { batch ->
+            sizes.add(batch.shape().first)
+            prefetched.addAll(batch["id"].values())
+        })
+        assertEquals(expected, prefetched)
+        assertEquals(List(8) { 300 } + 100, sizes)
+
+        val ids = BatchCSVUtils.readCSVBatches(csv.byteInputStream(), 1000).use { batches ->
+            batches.asSequence().flatMap { it["id"].values() }.toList()
+        }
+        assertEquals(expected, ids)
+
+        // 回调抛出异常时停止读取
+        var calls = 0
+        assertThrows(IllegalStateException::class.java) {
+            BatchCSVUtils.readCSVBatch(csv.byteInputStream(), 100, { _ ->
+                calls++
+                if (calls == 2) throw IllegalStateException("处理失败")
+            })
+        }
+        assertEquals(2, calls)
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testProcessBatches() {
+        println("=== 测试 多线程逐批计算 ===")
+        val expected = (1..2500).chunked(200).map { chunk -> chunk.sumOf { it % 17 }.toDouble() }
+        for (workers in listOf(1, 4)) {
+            val ordered = mutableListOf<Double>()
+            BatchCSVUtils.processCSVBatches(csv.byteInputStream(), { batch ->
+                batch["value"].values().sumOf { (it as Number).toDouble() }
+            }, { ordered.add(it) }, batchSize = 200, workers = workers)
+            assertEquals(expected, ordered)
+
+            val unordered = mutableListOf<Double>()
+            BatchCSVUtils.processCSVBatches(csv.byteInputStream(), { batch ->
+                // 让各批完成的先后不同
+                Thread.sleep((batch["id"].values()[0] as Int % 3).toLong() * 5)
+                batch["value"].values().sumOf { (it as Number).toDouble() }
+            }, { unordered.add(it) }, batchSize = 200, workers = workers, ordered = false)
+            assertEquals(expected.sorted(), unordered.sorted())
+        }
+
+        assertThrows(ArithmeticException::class.java) {
+            BatchCSVUtils.processCSVBatches(csv.byteInputStream(), { batch ->
+                if (batch["id"].values()[0] == 601) throw ArithmeticException("计算失败")
+                batch.shape().first
+            }, { }, batchSize = 200, workers = 3)
+        }
+        assertThrows(IllegalArgumentException::class.java) {
+            BatchCSVUtils.processCSVBatches(csv.byteInputStream(), { it }, { }, workers = 0)
+        }
+        println("✅ 测试通过\n")
+    }
+}
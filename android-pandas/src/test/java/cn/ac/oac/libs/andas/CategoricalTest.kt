@@ -0,0 +1,137 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.CsvOptions
+import cn.ac.oac.libs.andas.core.CsvReader
+import cn.ac.oac.libs.andas.core.col
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.DataFrameIO
+import cn.ac.oac.libs.andas.entity.Series
+import org.junit.Test
+import org.junit.Assert.*
+import java.io.ByteArrayInputStream
+
+/**
+ * 字典编码字符串列测试：各操作的结果与普通字符串列一致
+ */
+class CategoricalTest {
+
+    private val plain = DataFrame(
+        mapOf(
+            "city" to listOf("北京", "上海", null, "北京", "广州", "上海", "北京", null),
+            "price" to listOf(12.5, 8.0, 3.0, 20.0, 30.0, 1.0, 11.0, 7.0)
+        )
+    )
+    private val categorical = plain.asCategorical()
+
+    @Test
+    fun testEncoding() {
+        println("=== 测试 字典编码 ===")
+        val series = categorical["city"]
+        assertTrue(series.isCategorical())
+        assertFalse(plain["city"].isCategorical())
+        assertFalse(categorical["price"].isCategorical())
+        assertEquals(plain["city"].values(), series.values())
+        assertEquals(listOf("北京", "上海", "广州"), series.categories())
+        assertNull(plain["city"].categories())
+        // 取子集后字典不变，值仍然正确
+        val head = series.head(2)
+        assertTrue(head.isCategorical())
+        assertEquals(listOf("北京", "上海"), head.values())
+        assertThrows(IllegalArgumentException::class.java) { Series(listOf("a", 1)).asCategorical() }
+        assertThrows(IllegalArgumentException::class.java) { plain.asCategorical("不存在") }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testUniqueAndValueCounts() {
+        println("=== 测试 去重与计数 ===")
+        assertEquals(plain["city"].unique(), categorical["city"].unique())
+        val counts = categorical["city"].valueCounts()
+        assertEquals(plain["city"].valueCounts(), counts)
+        // 按次数降序，次数相同的按首次出现的顺序
+        assertEquals(listOf("北京", "上海", null, "广州"), counts.keys.toList())
+        assertEquals(listOf(3, 2, 2, 1), counts.values.toList())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testGroupBySortFilter() {
+        println("=== 测试 分组、排序与筛选 ===")
+        val expected = plain.groupBy("city").agg(mapOf("price" to "sum"))
+        val grouped = categorical.groupBy("city").agg(mapOf("price" to "sum"))
+        println(grouped)
+        assertEquals(expected["city"].values(), grouped["city"].values())
+        assertEquals(expected["price"].values(), grouped["price"].values())
+
+        val minCity = categorical.groupBy("price").agg(mapOf("city" to "min"))
+        assertEquals(plain.groupBy("price").agg(mapOf("city" to "min"))["city"].values(), minCity["city"].values())
+
+        for (ascending in listOf(true, false)) {
+            val sorted = categorical.sortValues(listOf("city", "price"), listOf(ascending, true))
+            val reference = plain.sortValues(listOf("city", "price"), listOf(ascending, true))
+            assertEquals(reference["city"].values(), sorted["city"].values())
+            assertEquals(reference.index(), sorted.index())
+        }
+
+        for (predicate in listOf(col("city") eq "北京", col("city") gt "北京", col("city") le "广", col("city") ne "上海")) {
+            val filtered = categorical.filter(predicate)
+            assertEquals(plain.filter(predicate).index(), filtered.index())
+            assertTrue(filtered["city"].isCategorical())
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testMerge() {
+        println("=== 测试 连接 ===")
+        val right = DataFrame(
+            mapOf(
+                "city" to listOf("广州", "北京", "深圳", null),
+                "rank" to listOf(3, 1, 4, 0)
+            )
+        )
+        for (how in listOf("inner", "left", "right", "outer")) {
+            val expected = plain.merge(right, "city", how)
+            // 两侧各自的字典，以及共享同一字典
+            val separate = categorical.merge(right.asCategorical(), "city", how)
+            assertEquals(expected["city"].values(), separate["city"].values())
+            assertEquals(expected["rank"].values(), separate["rank"].values())
+            assertEquals(expected["price"].values(), separate["price"].values())
+        }
+        val shared = categorical.merge(categorical.selectColumns("city").head(2), "city", "semi")
+        assertEquals(plain.merge(plain.selectColumns("city").head(2), "city", "semi").index(), shared.index())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testCsvRead() {
+        println("=== 测试 按字典编码读取CSV ===")
+        val rows = (0 until 3000).joinToString("\n") { i ->
+            // 前面的批次中 code 列是整数，之后出现字符串时整列提升
+            val code = if (i < 2500) "${i % 7}" else "c${i % 5}"
+            val city = if (i % 11 == 0) "" else listOf("北京", "上海", "广州", "深圳")[i % 4]
+            "$i,$city,$code"
+        }
+        val csv = "id,city,code\n$rows\n"
+        val expected = DataFrameIO.readCSV(ByteArrayInputStream(csv.toByteArray(Charsets.UTF_8)))
+        val df = DataFrameIO.readCSV(ByteArrayInputStream(csv.toByteArray(Charsets.UTF_8)), categorical = true)
+        assertTrue(df["city"].isCategorical())
+        assertTrue(df["code"].isCategorical())
+        assertFalse(df["id"].isCategorical())
+        for (name in listOf("id", "city", "code")) {
+            assertEquals(expected[name].values(), df[name].values())
+        }
+
+        // 分批读取时同一列的字典跨批次共享，编号不变
+        val options = CsvOptions(categorical = true)
+        CsvReader.open(ByteArrayInputStream(csv.toByteArray(Charsets.UTF_8)), options).use { stream ->
+            val first = stream.nextBatch(100)!!
+            val second = stream.nextBatch(100)!!
+            assertEquals("上海", first.columns[1][1])
+            assertEquals("上海", second.columns[1][1])
+            val values = first.columns[1] + second.columns[1]
+            assertEquals(expected["city"].values().take(200), values)
+        }
+        println("✅ 测试通过\n")
+    }
+}
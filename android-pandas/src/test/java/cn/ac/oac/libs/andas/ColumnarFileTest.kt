@@ -0,0 +1,114 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.ColumnarFile
+import cn.ac.oac.libs.andas.core.ColumnarType
+import cn.ac.oac.libs.andas.core.ColumnarWriter
+import cn.ac.oac.libs.andas.entity.DataFrame
+import org.junit.Test
+import org.junit.Assert.*
+import java.io.File
+
+/**
+ * 二进制列式文件测试
+ */
+class ColumnarFileTest {
+
+    private fun sampleFrame(): DataFrame {
+        return DataFrame(
+            mapOf(
+                "name" to listOf("张三", "Bob", null, "张三"),
+                "age" to listOf(25, null, 31, 40),
+                "id" to listOf(1L, 2L, 3_000_000_000L, 4L),
+                "score" to listOf(95.5, 87.0, null, 60.25),
+                "active" to listOf(true, false, null, true)
+            )
+        )
+    }
+
+    @Test
+    fun testRoundTrip() {
+        println("=== 测试 保存与加载 ===")
+        val file = File.createTempFile("andas", ".col")
+        try {
+            sampleFrame().toColumnar(file)
+            val loaded = DataFrame.readColumnar(file)
+            println(loaded)
+            assertEquals(listOf("name", "age", "id", "score", "active"), loaded.columns())
+            assertEquals(listOf("张三", "Bob", null, "张三"), loaded["name"].values())
+            assertEquals(listOf(25, null, 31, 40), loaded["age"].values())
+            assertEquals(listOf(1L, 2L, 3_000_000_000L, 4L), loaded["id"].values())
+            assertEquals(listOf(95.5, 87.0, null, 60.25), loaded["score"].values())
+            assertEquals(listOf(true, false, null, true), loaded["active"].values())
+            // FLOAT64 列直接映射为原生列
+            assertTrue(loaded["score"].isNativeResident())
+            assertEquals(242.75, loaded["score"].sum(), 1e-9)
+        } finally {
+            file.delete()
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testSchemaAndStats() {
+        println("=== 测试 类型与分块统计 ===")
+        val file = File.createTempFile("andas", ".col")
+        try {
+            ColumnarWriter(file, 5, statsChunkRows = 2).use { writer ->
+                writer.writeValues("v", listOf(3, 1, null, null, 7))
+                writer.writeValues("mixed", listOf(1, "a", 2.5, null, true))
+                writer.finish()
+            }
+            ColumnarFile.open(file).use { columnar ->
+                assertEquals(5, columnar.rowCount)
+                assertEquals(listOf(ColumnarType.INT32, ColumnarType.STRING), columnar.types)
+                assertEquals(2, columnar.nullCount("v"))
+                val stats = columnar.chunkStats("v")
+                assertEquals(3, stats.size)
+                assertEquals(1L, stats[0].min)
+                assertEquals(3L, stats[0].max)
+                assertNull(stats[1].min)
+                assertEquals(7L, stats[2].max)
+                assertEquals(listOf("1", "a", "2.5", null, "true"), columnar.column("mixed"))
+            }
+        } finally {
+            file.delete()
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testOverwriteWhileLoaded() {
+        println("=== 测试 覆盖已加载的文件 ===")
+        val file = File.createTempFile("andas", ".col")
+        try {
+            DataFrame(mapOf("x" to listOf(1.0, 2.0))).toColumnar(file)
+            val first = DataFrame.readColumnar(file)
+            // 覆盖写入通过替换文件完成，已加载的 DataFrame 仍读取旧数据
+            DataFrame(mapOf("x" to listOf(5.0, 6.0, 7.0))).toColumnar(file)
+            val second = DataFrame.readColumnar(file)
+            assertEquals(listOf(1.0, 2.0), first["x"].values())
+            assertEquals(listOf(5.0, 6.0, 7.0), second["x"].values())
+        } finally {
+            file.delete()
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testInvalidFile() {
+        println("=== 测试 无效文件 ===")
+        val file = File.createTempFile("andas", ".col")
+        try {
+            file.writeText("name,age\nAlice,25\n")
+            try {
+                DataFrame.readColumnar(file)
+                fail("应当拒绝非列式文件")
+            } catch (e: java.io.IOException) {
+                println("预期的异常: ${e.message}")
+            }
+        } finally {
+            file.delete()
+        }
+        println("✅ 测试通过\n")
+    }
+}
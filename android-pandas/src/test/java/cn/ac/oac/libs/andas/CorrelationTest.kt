@@ -0,0 +1,78 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.entity.DataFrame
+import org.junit.Test
+import org.junit.Assert.*
+
+/**
+ * 相关系数与协方差矩阵测试：缺失值按列对剔除，行保持对齐
+ */
+class CorrelationTest {
+
+    private val df = DataFrame(
+        mapOf(
+            "x" to listOf(1.0, 2.0, 3.0, 4.0, 5.0),
+            "y" to listOf(5, 6, 7, 8, 7),
+            "z" to listOf(1.0, 4.0, 9.0, 16.0, 25.0),
+            "name" to listOf("a", "b", "c", "d", "e")
+        )
+    )
+
+    private fun value(matrix: DataFrame, row: String, column: String): Double? =
+        (matrix[column][row] as Number?)?.toDouble()
+
+    @Test
+    fun testMethods() {
+        println("=== 测试 相关系数方法 ===")
+        val pearson = df.corr()
+        println(pearson)
+        assertEquals(listOf("x", "y", "z"), pearson.columns())
+        assertEquals(listOf("x", "y", "z"), pearson.index())
+        assertEquals(0.8320502943378437, value(pearson, "x", "y")!!, 1e-12)
+        assertEquals(value(pearson, "x", "y")!!, value(pearson, "y", "x")!!, 0.0)
+        assertEquals(1.0, value(pearson, "z", "z")!!, 0.0)
+
+        val spearman = df.corr("spearman")
+        assertEquals(0.8207826816681233, value(spearman, "x", "y")!!, 1e-12)
+        assertEquals(1.0, value(spearman, "x", "z")!!, 1e-12)
+
+        val kendall = df.corr("kendall")
+        assertEquals(0.7378647873726218, value(kendall, "x", "y")!!, 1e-12)
+        assertEquals(1.0, value(kendall, "x", "z")!!, 1e-12)
+
+        assertThrows(IllegalArgumentException::class.java) { df.corr("unknown") }
+        assertThrows(IllegalArgumentException::class.java) { df.selectColumns("x", "name").corr() }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testNullsStayAligned() {
+        println("=== 测试 缺失值按列对剔除 ===")
+        val withNulls = DataFrame(
+            mapOf(
+                "a" to listOf(1.0, null, 3.0, 4.0, 5.0, 6.0),
+                "b" to listOf(2.0, 100.0, 6.0, 8.0, null, 12.0),
+                "c" to listOf(7.0, 7.0, 7.0, 7.0, 7.0, 7.0)
+            )
+        )
+        val corr = withNulls.corr()
+        println(corr)
+        // 共同有效的行为 0、2、3、5，其上 b = 2a
+        assertEquals(1.0, value(corr, "a", "b")!!, 1e-12)
+        // 常数列的方差为 0，结果为空值
+        assertNull(value(corr, "a", "c"))
+        assertNull(value(corr, "c", "c"))
+        // 共同有效行数不足
+        assertNull(value(withNulls.corr(minPeriods = 5), "a", "b"))
+        assertEquals(1.0, value(withNulls.corr(minPeriods = 5), "a", "a")!!, 0.0)
+
+        val cov = withNulls.cov()
+        // a 的有效值 1, 3, 4, 5, 6 的样本方差
+        assertEquals(3.7, value(cov, "a", "a")!!, 1e-12)
+        // 行 0、2、3、5 上 cov(a, 2a) = 2 var(a)
+        assertEquals(2.0 * 13.0 / 3.0, value(cov, "a", "b")!!, 1e-12)
+        assertEquals(0.0, value(cov, "c", "c")!!, 0.0)
+        assertEquals(2.0 * 13.0 / 4.0, value(withNulls.cov(ddof = 0), "a", "b")!!, 1e-12)
+        println("✅ 测试通过\n")
+    }
+}
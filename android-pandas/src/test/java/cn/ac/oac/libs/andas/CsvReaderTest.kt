@@ -0,0 +1,123 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.CsvColumnType
+import cn.ac.oac.libs.andas.core.CsvOptions
+import cn.ac.oac.libs.andas.core.CsvReader
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.DataFrameIO
+import org.junit.Test
+import org.junit.Assert.*
+import java.io.ByteArrayInputStream
+
+/**
+ * 流式CSV读取器测试
+ */
+class CsvReaderTest {
+
+    private fun input(text: String) = ByteArrayInputStream(text.toByteArray(Charsets.UTF_8))
+
+    @Test
+    fun testQuotedFields() {
+        println("=== 测试 引号与跨行字段 ===")
+        val csv = "\uFEFFname,comment\r\n" +
+            "\"Smith, John\",\"他说 \"\"你好\"\"\"\r\n" +
+            "\r\n" +
+            "Alice,\"第一行\n第二行\"\r\n"
+        val df = DataFrameIO.readCSV(input(csv))
+        println(df)
+        assertEquals(listOf("name", "comment"), df.columns())
+        assertEquals(listOf("Smith, John", "Alice"), df["name"].values())
+        assertEquals(listOf("他说 \"你好\"", "第一行\n第二行"), df["comment"].values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testTypePromotion() {
+        println("=== 测试 整列类型提升 ===")
+        val rows = (1..2000).joinToString("\n") { i ->
+            when (i) {
+                1500 -> "$i,3000000000,x"
+                1800 -> "$i,2.5,7"
+                else -> "$i,$i,$i"
+            }
+        }
+        // 样本只有前 1000 行，后面放不下的值触发整列提升
+        val df = DataFrameIO.readCSV(input("id,amount,code\n$rows\n"))
+        assertEquals(2000, df.shape().first)
+        assertEquals(1, df["id"].values()[0])
+        assertEquals(1.0, df["amount"].values()[0])
+        assertEquals(2.5, df["amount"].values()[1799])
+        assertEquals(3.0E9, df["amount"].values()[1499])
+        // 数值列遇到字符串后整列变为字符串
+        assertEquals("1", df["code"].values()[0])
+        assertEquals("x", df["code"].values()[1499])
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testNullsAndMissingFields() {
+        println("=== 测试 空值与缺失字段 ===")
+        val df = DataFrameIO.readCSV(input("a,b,c\n1,NA,true\n,2\n3,4,false,extra\n"))
+        assertEquals(listOf(1, null, 3), df["a"].values())
+        assertEquals(listOf(null, 2, 4), df["b"].values())
+        assertEquals(listOf(true, null, false), df["c"].values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testWithoutTypeInference() {
+        println("=== 测试 关闭类型推断 ===")
+        val df = DataFrameIO.readCSV(input("a,b\n 1 ,true\n,x\n"), autoType = false, trimValues = false)
+        assertEquals(listOf(" 1 ", null), df["a"].values())
+        assertEquals(listOf("true", "x"), df["b"].values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testBatchReading() {
+        println("=== 测试 分批读取 ===")
+        val csv = "id;value\n" + (1..25).joinToString("\n") { "$it;${it * 10}" } + "\n"
+        val sizes = mutableListOf<Int>()
+        val ids = mutableListOf<Any?>()
+        DataFrameIO.readCSVBatch(input(csv), batchSize = 10, callback = { batch: DataFrame ->
+            sizes.add(batch.shape().first)
+            ids.addAll(batch["id"].values())
+        }, delimiter = ";")
+        assertEquals(listOf(10, 10, 5), sizes)
+        assertEquals((1..25).toList(), ids)
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testStreamApi() {
+        println("=== 测试 CsvStream ===")
+        val options = CsvOptions(delimiter = '\t', skipLines = 1)
+        CsvReader.open(input("# 注释\nx\ty\n1\ta\n2\tb\n"), options).use { stream ->
+            assertEquals(listOf("x", "y"), stream.columnNames)
+            val first = stream.nextBatch(1)!!
+            assertEquals(1, first.rowCount)
+            assertEquals(listOf(CsvColumnType.INT32, CsvColumnType.STRING), first.types)
+            assertEquals(listOf(listOf<Any?>(1), listOf<Any?>("a")), first.columns)
+            assertEquals(1, stream.nextBatch()!!.rowCount)
+            assertNull(stream.nextBatch())
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testColumnProjection() {
+        println("=== 测试 只读取部分列 ===")
+        val options = CsvOptions(columns = listOf("c", "a"))
+        CsvReader.open(input("a,b,c\n1,\"x,y\",2.5\n3,z,\n"), options).use { stream ->
+            // 按给出的顺序输出，未选择的列不解析
+            assertEquals(listOf("c", "a"), stream.columnNames)
+            val batch = stream.nextBatch()!!
+            assertEquals(listOf(CsvColumnType.FLOAT64, CsvColumnType.INT32), batch.types)
+            assertEquals(listOf(listOf<Any?>(2.5, null), listOf<Any?>(1, 3)), batch.columns)
+        }
+        assertThrows(java.io.IOException::class.java) {
+            CsvReader.open(input("a,b\n1,2\n"), CsvOptions(columns = listOf("a", "d"))).use { it.nextBatch() }
+        }
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,144 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.DedupEngine
+import cn.ac.oac.libs.andas.core.StableKeyEncoder
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.Series
+import cn.ac.oac.libs.andas.utils.BatchCSVUtils
+import org.junit.Test
+import org.junit.Assert.*
+import java.io.ByteArrayInputStream
+import kotlin.random.Random
+
+/**
+ * 去重测试：duplicated / drop_duplicates / unique / value_counts 与流式去重
+ */
+class DedupTest {
+
+    private val df = DataFrame(
+        mapOf(
+            "user" to listOf(1, 2, 1, null, 2, null, 1),
+            "item" to listOf("a", "a", "a", "b", "c", "b", "a"),
+            "price" to listOf(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0)
+        )
+    )
+
+    @Test
+    fun testDuplicated() {
+        println("=== 测试 duplicated ===")
+        val subset = listOf("user", "item")
+        assertEquals(listOf(false, false, true, false, false, true, true), df.duplicated(subset).values())
+        assertEquals(listOf(true, false, true, true, false, false, false), df.duplicated(subset, keep = "last").values())
+        assertEquals(listOf(true, false, true, true, false, true, true), df.duplicated(subset, keep = "none").values())
+        assertEquals(df.duplicated(subset, keep = "none").values(), df.duplicated(subset, keep = "false").values())
+        // 全部列参与比较时没有重复行
+        assertTrue(df.duplicated().values().none { it == true })
+        assertEquals(df.index(), df.duplicated(subset).index())
+
+        assertThrows(IllegalArgumentException::class.java) { df.duplicated(subset, keep = "middle") }
+        assertThrows(IllegalArgumentException::class.java) { df.duplicated(listOf("不存在")) }
+        assertThrows(IllegalArgumentException::class.java) { df.duplicated(emptyList()) }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testDropDuplicates() {
+        println("=== 测试 drop_duplicates ===")
+        val first = df.dropDuplicates(listOf("user", "item"))
+        assertEquals(listOf<Any>(0, 1, 3, 4), first.index())
+        assertEquals(listOf(1.0, 2.0, 4.0, 5.0), first["price"].values())
+
+        val last = df.dropDuplicates(listOf("user", "item"), keep = "last")
+        assertEquals(listOf<Any>(1, 4, 5, 6), last.index())
+        assertEquals(listOf(2.0, 5.0, 6.0, 7.0), last["price"].values())
+
+        val none = df.dropDuplicates(listOf("user"), keep = "none")
+        assertEquals(0, none.shape().first)
+
+        // 随机数据与按值比较的结果一致
+        val random = Random(5)
+        val n = 5000
+        val big = DataFrame(
+            mapOf(
+                "a" to List(n) { random.nextInt(30) },
+                "b" to List(n) { if (random.nextInt(10) == 0) null else "s${random.nextInt(20)}" },
+                "c" to List(n) { random.nextInt(3) * 0.5 }
+            )
+        )
+        val seen = HashSet<List<Any?>>()
+        val expected = (0 until n).filter { i -> seen.add(listOf(big["a"][i], big["b"][i], big["c"][i])) }
+        assertEquals(expected, big.dropDuplicates().index())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testUniqueAndValueCounts() {
+        println("=== 测试 unique 与 value_counts ===")
+        val series = Series(listOf("x", "y", null, "y", "z", null, "y", 1.5))
+        assertEquals(listOf("x", "y", null, "z", 1.5), series.unique())
+        val counts = series.valueCounts()
+        // 按次数降序，次数相同的按首次出现的顺序
+        assertEquals(listOf("y", null, "x", "z", 1.5), counts.keys.toList())
+        assertEquals(listOf(3, 2, 1, 1, 1), counts.values.toList())
+
+        val doubles = Series(listOf(0.0, -0.0, Double.NaN, 0.0, Double.NaN, null))
+        assertEquals(listOf(0.0, -0.0, Double.NaN, null), doubles.unique())
+        assertEquals(listOf(2, 2, 1, 1), doubles.valueCounts().values.toList())
+
+        val longs = Series(listOf(Long.MIN_VALUE, null, Long.MIN_VALUE, 7L))
+        assertEquals(listOf(Long.MIN_VALUE, null, 7L), longs.unique())
+        assertTrue(Series(emptyList<Int>()).unique().isEmpty())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testBatchDropDuplicates() {
+        println("=== 测试 流式去重 ===")
+        val csv = buildString {
+            append("user,item,ts\n")
+            append("1,a,10\n2,a,11\n1,a,12\n")
+            append("1,a,10\n3,,13\n3,,14\n")
+            append("2,a,11\nx,b,15\n1,a,10\n")
+        }
+        // 每批只有 2 行，重复行跨越多个批次；第三批起 user 列被推断为字符串，数值 1 与文本 "1" 仍相等
+        val all = BatchCSVUtils.batchDropDuplicates(ByteArrayInputStream(csv.toByteArray()), batchSize = 2)
+        assertEquals(listOf("10", "11", "12", "13", "14", "15"), all["ts"].values().map { it.toString() })
+
+        val byKey = BatchCSVUtils.batchDropDuplicates(
+            ByteArrayInputStream(csv.toByteArray()), batchSize = 2, subset = listOf("user", "item")
+        )
+        assertEquals(listOf("1", "2", "3", "x"), byKey["user"].values().map { it.toString() })
+        assertEquals(listOf("10", "11", "13", "15"), byKey["ts"].values().map { it.toString() })
+
+        assertThrows(IllegalArgumentException::class.java) {
+            BatchCSVUtils.batchDropDuplicates(ByteArrayInputStream(csv.toByteArray()), subset = listOf("不存在"))
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testDistinctRowSet() {
+        println("=== 测试 跨批次去重集合 ===")
+        val encoder = StableKeyEncoder()
+        val first = encoder.encode(listOf(1, "1", 2L, "a", null, "01"))
+        val second = encoder.encode(listOf("a", 1.0, "2", null, 1 shl 20))
+        assertEquals(first[0], first[1])
+        assertEquals(first[0], 1L)
+        assertNotEquals(first[0], first[5])
+        assertEquals(first[3], second[0])
+        assertEquals(first[2], second[2])
+        assertEquals(first[4], second[3])
+        assertNotEquals(first[0], second[1])
+
+        DedupEngine.openSet(2).use { set ->
+            assertArrayEquals(intArrayOf(0, 1, 3), set.insert(arrayOf(longArrayOf(1, 2, 1, 3), longArrayOf(5, 5, 5, 5))))
+            assertArrayEquals(intArrayOf(1), set.insert(arrayOf(longArrayOf(3, 3), longArrayOf(5, 6))))
+            assertArrayEquals(intArrayOf(), set.insert(arrayOf(longArrayOf(), longArrayOf())))
+            assertEquals(4L, set.size)
+            assertThrows(IllegalArgumentException::class.java) { set.insert(arrayOf(longArrayOf(1))) }
+            assertThrows(IllegalArgumentException::class.java) { set.insert(arrayOf(longArrayOf(1), longArrayOf())) }
+        }
+        assertThrows(IllegalArgumentException::class.java) { DedupEngine.openSet(0) }
+        println("✅ 测试通过\n")
+    }
+}
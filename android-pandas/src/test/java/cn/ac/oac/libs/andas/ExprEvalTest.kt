@@ -0,0 +1,100 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.Series
+import org.junit.Test
+import org.junit.Assert.*
+import kotlin.math.cos
+import kotlin.math.exp
+import kotlin.math.ln
+import kotlin.math.sin
+import kotlin.math.sqrt
+
+/**
+ * 表达式求值测试：DataFrame.eval / withColumns
+ */
+class ExprEvalTest {
+
+    private val df = DataFrame(
+        mapOf(
+            "a" to listOf(1.0, 2.0, 3.0, null, 5.0),
+            "b" to listOf(10, 20, 30, 40, 50),
+            "单价" to listOf(0.5, 1.5, 2.5, 3.5, 4.5),
+            "name" to listOf("x", "y", "z", "u", "v")
+        )
+    )
+
+    private fun values(series: Series<Double>): List<Double?> = series.values()
+
+    @Test
+    fun testArithmeticAndFunctions() {
+        println("=== 测试 算术与函数 ===")
+        val result = df.eval("a * 2 + log(b)")
+        println(result)
+        assertEquals(df.index(), result.index())
+        val v = values(result)
+        assertEquals(2.0 + ln(10.0), v[0]!!, 1e-12)
+        assertEquals(10.0 + ln(50.0), v[4]!!, 1e-12)
+        // 缺失值参与运算结果为缺失值
+        assertNull(v[3])
+
+        val mixed = values(df.eval("sqrt(abs(-b)) + exp(-a) * sin(a) - cos(单价) / 2"))
+        assertEquals(sqrt(20.0) + exp(-2.0) * sin(2.0) - cos(1.5) / 2, mixed[1]!!, 1e-12)
+
+        // ** 右结合，一元负号优先级低于 **
+        assertEquals(-512.0, values(df.eval("-2 ** 3 ** 2 + a * 0"))[0]!!, 0.0)
+        assertEquals(8.0, values(df.eval("pow(a, 3)"))[1]!!, 0.0)
+        assertEquals(3.0, values(df.eval("`单价` * 2 - 2"))[2]!!, 1e-12)
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testComparisonsAndConditionals() {
+        println("=== 测试 比较与条件 ===")
+        assertEquals(listOf(0.0, 0.0, 1.0, null, 1.0), values(df.eval("a >= 3")))
+        assertEquals(listOf(1.0, 0.0, 0.0, null, 0.0), values(df.eval("(a < 2) | (b == 30) & ~(a == 3)")))
+        assertEquals(listOf(1.0, 0.0, 1.0, null, 1.0), values(df.eval("not a == 2")))
+        assertEquals(listOf(2.0, 2.0, 3.0, null, 4.0), values(df.eval("clip(a, 2, 4)")))
+        assertEquals(listOf(1.0, 2.0, 3.0, null, 4.0), values(df.eval("clip(a, nan, 4)")))
+        assertEquals(listOf(10.0, 20.0, 3.0, null, 5.0), values(df.eval("where(a < 3, b, a)")))
+        assertEquals(listOf(1.0, 2.0, 3.0, 0.0, 5.0), values(df.eval("fill_null(a, 0)")))
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testWithColumns() {
+        println("=== 测试 多列赋值 ===")
+        val result = df.withColumns(
+            "total" to "a * b",
+            "log_total" to "log(total + 1)",
+            "flag" to "total > 50"
+        )
+        println(result)
+        assertEquals(listOf("a", "b", "单价", "name", "total", "log_total", "flag"), result.columns())
+        assertEquals(listOf(10.0, 40.0, 90.0, null, 250.0), result["total"].values())
+        assertEquals(ln(41.0), (result["log_total"][1] as Double), 1e-12)
+        assertEquals(listOf(0.0, 0.0, 1.0, null, 1.0), result["flag"].values())
+
+        // 延迟执行时多个赋值融合为一个运算节点
+        val plan = df.lazy().withColumns("c" to "a + 1", "d" to "c * 2").explain()
+        println(plan)
+        assertEquals(1, plan.lines().count { it.trim().startsWith("WithColumns") })
+        assertTrue(plan.contains("d = ((a + 1.0) * 2.0)"))
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testErrors() {
+        println("=== 测试 错误处理 ===")
+        val syntax = listOf("a +", "a * (b", "foo(a)", "a < b < 3", "clip(a, 1)", "a # b", "`a", "and + 1")
+        for (expression in syntax) {
+            val e = assertThrows(IllegalArgumentException::class.java) { df.eval(expression) }
+            println("$expression -> ${e.message}")
+            assertTrue(e.message!!.startsWith("表达式语法错误"))
+        }
+        assertThrows(IllegalArgumentException::class.java) { df.eval("missing * 2") }
+        val e = assertThrows(IllegalArgumentException::class.java) { df.eval("name + 1") }
+        assertEquals("列 name 不是数值列", e.message)
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,82 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.col
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.Series
+import org.junit.Test
+import org.junit.Assert.*
+
+/**
+ * 谓词筛选测试
+ */
+class FilterTest {
+
+    private val df = DataFrame(
+        mapOf(
+            "city" to listOf("北京", "上海", "广州", null, "北京", "深圳"),
+            "price" to listOf(12.5, 8.0, null, 30.0, 9.5, 10.0),
+            "qty" to listOf(3, 20, 7, 20, null, 1)
+        )
+    )
+
+    @Test
+    fun testCompound() {
+        println("=== 测试 组合条件 ===")
+        // price > 10 AND qty == 20 OR city IS NULL
+        val result = df.filter((col("price") gt 10) and (col("qty") eq 20) or col("city").isNull())
+        println(result)
+        assertEquals(listOf(3), result.index())
+
+        val notCheap = df.filter(!(col("price") lt 10))
+        // 取反时缺失值也被选中
+        assertEquals(listOf(0, 2, 3, 5), notCheap.index())
+
+        val picked = df.filter((col("city") isIn listOf("北京", "深圳")) and (col("qty").notNull()))
+        assertEquals(listOf("北京", "深圳"), picked["city"].values())
+        assertEquals(listOf(0, 5), picked.index())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testNullSemantics() {
+        println("=== 测试 缺失值语义 ===")
+        // 比较不选中缺失值，!= 选中缺失值
+        assertEquals(listOf(0, 1, 3, 4, 5), df.filter(col("price") ge 8).index())
+        assertEquals(listOf(0, 2, 4, 5), df.filter(col("qty") ne 20).index())
+        assertEquals(listOf(3), df.filter(col("city") isIn listOf(null, "杭州")).index())
+        assertEquals(listOf(2), df.filter(col("price").isNull()).index())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testConstantConversion() {
+        println("=== 测试 常量与列类型转换 ===")
+        // 整数列与小数常量比较
+        assertEquals(listOf(1, 2, 3), df.filter(col("qty") gt 3.5).index())
+        assertEquals(listOf(0, 2), df.filter(col("qty").between(2.5, 7.0)).index())
+        assertEquals(0, df.filter(col("qty") eq 3.5).index().size)
+        assertEquals(6, df.filter(col("qty") ne 3.5).index().size)
+        // 字符串列按字典序比较，常量不在列中时按插入位置比较
+        assertEquals(listOf("北京", "上海", "北京"), df.filter(col("city") lt "广州")["city"].values())
+        assertEquals(listOf("北京", "广州", "北京"), df.filter(col("city").between("北", "广州"))["city"].values())
+        assertThrows(IllegalArgumentException::class.java) { df.filter(col("city") gt 3) }
+        assertThrows(IllegalArgumentException::class.java) { df.filter(col("不存在") gt 3) }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testLegacyFilters() {
+        println("=== 测试 原有筛选接口 ===")
+        // 带缺失值的列筛选结果与行对齐
+        val result = df.filterGreaterThan("price", 9.0)
+        assertEquals(listOf(12.5, 30.0, 9.5, 10.0), result["price"].values())
+        assertEquals(listOf("北京", null, "北京", "深圳"), result["city"].values())
+
+        val byLambda = df.filter { row -> row["city"] != null && row["qty"] != null }
+        assertEquals(listOf(0, 1, 2, 5), byLambda.index())
+
+        val series = Series(listOf(5.0, null, 12.0, 7.5), listOf("a", "b", "c", "d"))
+        assertEquals(listOf("c", "d"), series.filterGreaterThan(6.0).index())
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,124 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.utils.BatchCSVUtils
+import org.junit.Test
+import org.junit.Assert.*
+
+/**
+ * 哈希分组聚合测试
+ */
+class GroupByTest {
+
+    private fun salesFrame(): DataFrame {
+        return DataFrame(
+            mapOf(
+                "region" to listOf("华东", "华北", "华东", null, "华北", "华南"),
+                "store" to listOf(1, 2, 1, 3, 2, 4),
+                "sales" to listOf(100.0, 200.0, null, 50.0, 300.0, 80.0),
+                "product" to listOf("b", "a", "c", "a", "d", "e")
+            )
+        )
+    }
+
+    @Test
+    fun testAggMultipleColumns() {
+        println("=== 测试 多列聚合 ===")
+        val result = salesFrame().groupBy("region").agg(
+            mapOf("sales" to "sum", "store" to "count", "product" to "max")
+        )
+        println(result)
+        // 空值键不参与分组，分组按首次出现顺序排列
+        assertEquals(listOf("华东", "华北", "华南"), result["region"].values())
+        assertEquals(listOf(100.0, 500.0, 80.0), result["sales"].values())
+        assertEquals(listOf(2, 2, 1), result["store"].values())
+        assertEquals(listOf("c", "d", "e"), result["product"].values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testAllAggregations() {
+        println("=== 测试 各聚合类型 ===")
+        val grouped = salesFrame().groupBy("region")
+        assertEquals(listOf(100.0, 250.0, 80.0), grouped.mean()["sales"].values())
+        assertEquals(listOf(1, 2, 1), grouped.count()["sales"].values())
+        assertEquals(listOf(100.0, 200.0, 80.0), grouped.min()["sales"].values())
+        assertEquals(listOf(100.0, 300.0, 80.0), grouped.max()["sales"].values())
+        assertEquals(listOf(null, 5000.0, null), grouped.variance()["sales"].values())
+        assertEquals(listOf("b", "a", "e"), grouped.first()["product"].values())
+        assertEquals(listOf("c", "d", "e"), grouped.last()["product"].values())
+        // 整数列保持原类型
+        assertEquals(listOf(1, 2, 4), grouped.first()["store"].values())
+        // sum 只处理数值列
+        assertFalse("product" in grouped.sum().columns())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testMultipleKeys() {
+        println("=== 测试 多列分组键 ===")
+        val df = DataFrame(
+            mapOf(
+                "city" to listOf("A", "A", "B", "A", "B"),
+                "year" to listOf(2023, 2024, 2023, 2023, 2023),
+                "value" to listOf(1.0, 2.0, 3.0, 4.0, 5.0)
+            )
+        )
+        val result = df.groupBy("city", "year").sum()
+        println(result)
+        assertEquals(listOf("A", "A", "B"), result["city"].values())
+        assertEquals(listOf(2023, 2024, 2023), result["year"].values())
+        assertEquals(listOf(5.0, 2.0, 8.0), result["value"].values())
+        assertEquals(mapOf(listOf<Any?>("A", 2023) to 2L, listOf<Any?>("A", 2024) to 1L, listOf<Any?>("B", 2023) to 2L),
+            df.groupBy("city", "year").size())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testGroupBySumLarge() {
+        println("=== 测试 大数据量分组求和 ===")
+        val size = 200_000
+        val df = DataFrame(
+            mapOf(
+                "customer" to List(size) { (it * 7919L) % 5000 },
+                "amount" to List(size) { (it % 100).toDouble() }
+            )
+        )
+        val result = df.groupBySum("customer", "amount")
+        assertEquals(5000, result.index().size)
+        val expected = mutableMapOf<Long, Double>()
+        for (i in 0 until size) {
+            val key = (i * 7919L) % 5000
+            expected[key] = (expected[key] ?: 0.0) + (i % 100)
+        }
+        val keys = result["customer"].values()
+        val sums = result["amount"].values()
+        for (i in keys.indices) {
+            assertEquals(expected[keys[i] as Long]!!, sums[i] as Double, 1e-6)
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testBatchGroupBy() {
+        println("=== 测试 分批分组聚合 ===")
+        val csv = buildString {
+            append("group,value\n")
+            for (i in 0 until 25) {
+                append(if (i % 3 == 0) "x" else "y").append(',')
+                append(if (i == 4) "" else i.toString()).append('\n')
+            }
+        }
+        val counts = BatchCSVUtils.batchGroupByCount(csv.byteInputStream(), "group", 7)
+        val sums = BatchCSVUtils.batchGroupBySum(csv.byteInputStream(), "group", "value", 7)
+        val means = BatchCSVUtils.batchGroupByMean(csv.byteInputStream(), "group", "value", 7)
+        println("计数: $counts, 求和: $sums, 均值: $means")
+        assertEquals(9L, counts["x"])
+        assertEquals(16L, counts["y"])
+        assertEquals(108.0, sums["x"]!!, 1e-9)
+        assertEquals(300.0 - 108.0 - 4.0, sums["y"]!!, 1e-9)
+        assertEquals(12.0, means["x"]!!, 1e-9)
+        assertEquals(188.0 / 15, means["y"]!!, 1e-9)
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,167 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.Index
+import cn.ac.oac.libs.andas.entity.RangeIndex
+import cn.ac.oac.libs.andas.entity.Series
+import org.junit.Test
+import org.junit.Assert.*
+import kotlin.random.Random
+
+/**
+ * 行索引测试：标签查找、区间切片、单调性、共享以及按索引连接和分组
+ */
+class IndexTest {
+
+    private val df = DataFrame(
+        mapOf(
+            "id" to listOf("c", "a", "d", "b", "a"),
+            "qty" to listOf(3, 1, 4, 1, 5),
+            "price" to listOf(9.0, 2.0, 6.0, 5.0, 3.0)
+        )
+    )
+
+    @Test
+    fun testLookup() {
+        println("=== 测试 标签查找 ===")
+        // 默认索引不存储标签
+        assertTrue(df.index() is RangeIndex)
+        assertEquals(listOf<Any>(0, 1, 2, 3, 4), df.index())
+        assertEquals(4, df.at(2, "qty"))
+        assertEquals(2, df.index().indexOf(2))
+        assertEquals(-1, df.index().positionOf(5))
+        assertEquals(-1, df.index().positionOf("0"))
+
+        val byId = df.setIndex("id")
+        assertEquals(listOf("qty", "price"), byId.columns())
+        assertEquals(listOf<Any>("c", "a", "d", "b", "a"), byId.index())
+        assertEquals(6.0, byId.at("d", "price"))
+        // 重复标签取第一次出现的位置
+        assertEquals(1, byId.at("a", "qty"))
+        assertArrayEquals(intArrayOf(1, 4), byId.index().positionsOf("a"))
+        assertEquals(4, byId.index().lastIndexOf("a"))
+        assertFalse(byId.index().isUnique)
+        assertTrue("b" in byId.index())
+        assertThrows(NoSuchElementException::class.java) { byId.loc("z") }
+        assertEquals(5.0, byId.loc("b")["price"]!!.values()[0])
+
+        // Int 标签：连续的存为 RangeIndex，否则建哈希表
+        assertTrue(Index.of(listOf(5, 6, 7)) is RangeIndex)
+        val ints = Index.of(listOf(40, 10, 30, 10))
+        assertFalse(ints is RangeIndex)
+        assertEquals(2, ints.positionOf(30))
+        assertArrayEquals(intArrayOf(1, 3), ints.positionsOf(10))
+        assertEquals(-1, ints.positionOf("10"))
+
+        val mixed = Index.of(listOf(1, "1", 2))
+        assertEquals(0, mixed.positionOf(1))
+        assertEquals(1, mixed.positionOf("1"))
+        assertEquals(-1, mixed.positionOf("2"))
+        assertThrows(IllegalArgumentException::class.java) { Index.of(listOf(1, 2.0)) }
+
+        val series = Series(listOf(1.5, 2.5), listOf("x", "y"))
+        assertEquals(2.5, series["y"])
+        assertThrows(NoSuchElementException::class.java) { series["z"] }
+
+        // 大量随机字符串标签与线性查找一致
+        val random = Random(3)
+        val labels = List(20000) { "k${random.nextInt(15000)}" }
+        val index = Index.of(labels)
+        for (probe in listOf("k0", "k7", "k14999", "missing") + labels.take(50)) {
+            assertEquals(labels.indexOf(probe), index.positionOf(probe))
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testSliceLocs() {
+        println("=== 测试 区间切片 ===")
+        val sorted = DataFrame(mapOf("t" to listOf(10, 20, 20, 30, 50), "v" to listOf(1, 2, 3, 4, 5))).setIndex("t")
+        assertTrue(sorted.index().isMonotonicIncreasing)
+        assertFalse(sorted.index().isMonotonicDecreasing)
+        // 含两端，端点标签可以不存在
+        assertEquals(listOf(2, 3, 4), sorted.loc(20, 30)["v"].values())
+        assertEquals(listOf(2, 3, 4), sorted.loc(15, 45)["v"].values())
+        assertEquals(listOf(1, 2, 3), sorted.loc(null, 25)["v"].values())
+        assertEquals(listOf(5), sorted.loc(31, null)["v"].values())
+        assertEquals(0, sorted.loc(60, 70).shape().first)
+        assertEquals(0, sorted.loc(30, 20).shape().first)
+        assertEquals(listOf<Any>(20, 20, 30), sorted.loc(20, 30).index())
+        assertThrows(IllegalArgumentException::class.java) { sorted.loc("a", "b") }
+
+        val descending = Series(listOf(1, 2, 3, 4), listOf("d", "c", "b", "a"))
+        assertTrue(descending.index().isMonotonicDecreasing)
+        assertEquals(listOf(2, 3), descending.loc("c", "b").values())
+        assertEquals(listOf(2, 3, 4), descending.loc("cc", null).values())
+
+        // 非单调：端点标签必须存在且唯一
+        val unsorted = df.setIndex("id")
+        assertFalse(unsorted.index().isMonotonicIncreasing)
+        assertEquals(listOf(4, 1), unsorted.loc("d", "b")["qty"].values())
+        assertThrows(NoSuchElementException::class.java) { unsorted.loc("c", "z") }
+        assertThrows(IllegalArgumentException::class.java) { unsorted.loc("a", "b") }
+
+        assertEquals(listOf(3, 1), df.loc(0, 1)["qty"].values())
+        assertEquals(0, DataFrame(mapOf("a" to emptyList<Int>())).loc(0, 1).shape().first)
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testSharedIndex() {
+        println("=== 测试 索引共享 ===")
+        val byId = df.setIndex("id")
+        assertSame(byId.index(), byId["qty"].index())
+        assertSame(byId["qty"].index(), byId["price"].index())
+        val head = byId.head(3)
+        assertSame(head["qty"].index(), head["price"].index())
+        assertEquals(listOf<Any>("c", "a", "d"), head.index())
+        val filtered = byId.filter(cn.ac.oac.libs.andas.core.col("qty") gt 2)
+        assertSame(filtered["qty"].index(), filtered["price"].index())
+        assertEquals(listOf<Any>("c", "d", "a"), filtered.index())
+        assertEquals(5, filtered.at("a", "qty"))
+
+        val reset = byId.resetIndex("id")
+        assertTrue(reset.index() is RangeIndex)
+        assertEquals(df["id"].values(), reset["id"].values())
+        assertThrows(IllegalArgumentException::class.java) { reset.resetIndex("qty") }
+        assertThrows(IllegalArgumentException::class.java) { df.setIndex("不存在") }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testJoinAndGroupByIndex() {
+        println("=== 测试 按索引连接和分组 ===")
+        val left = df.setIndex("id")
+        val names = DataFrame(mapOf("id" to listOf("a", "b", "c"), "name" to listOf("苹果", "香蕉", "樱桃"))).setIndex("id")
+
+        val joined = left.joinOnIndex(names)
+        assertEquals(listOf<Any>("c", "a", "d", "b", "a"), joined.index())
+        assertEquals(listOf("樱桃", "苹果", null, "香蕉", "苹果"), joined["name"].values())
+        assertEquals(listOf(3, 1, 4, 1, 5), joined["qty"].values())
+
+        val inner = left.joinOnIndex(names, "inner")
+        assertEquals(listOf<Any>("c", "a", "b", "a"), inner.index())
+        assertEquals(listOf<Any>("d"), left.joinOnIndex(names, "anti").index())
+
+        // 右表索引有重复时走哈希连接
+        val outer = names.joinOnIndex(left, "outer")
+        assertEquals(listOf<Any>("a", "a", "b", "c", "d"), outer.index())
+        assertEquals(listOf(1, 5, 1, 3, 4), outer["qty"].values())
+        assertEquals(listOf("苹果", "苹果", "香蕉", "樱桃", null), outer["name"].values())
+
+        // 重名列加后缀
+        val self = names.joinOnIndex(names)
+        assertEquals(listOf("name_x", "name_y"), self.columns())
+
+        val grouped = left.groupByIndex().agg(mapOf("qty" to "sum", "price" to "max"))
+        assertEquals(listOf<Any>("c", "a", "d", "b"), grouped.index())
+        assertEquals(listOf(3.0, 6.0, 4.0, 1.0), grouped["qty"].values())
+        assertEquals(listOf(9.0, 3.0, 6.0, 5.0), grouped["price"].values())
+        assertEquals(2L, left.groupByIndex().size()[listOf("a")])
+
+        val byInt = DataFrame(mapOf("k" to listOf(7, 3, 7), "v" to listOf(1.0, 2.0, 3.0))).setIndex("k")
+        assertEquals(listOf<Any>(7, 3), byInt.groupByIndex().sum().index())
+        assertEquals(listOf(4.0, 2.0), byInt.groupByIndex().sum()["v"].values())
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,109 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.JoinType
+import cn.ac.oac.libs.andas.core.NativeData
+import cn.ac.oac.libs.andas.entity.DataFrame
+import org.junit.Test
+import org.junit.Assert.*
+
+/**
+ * 哈希连接测试
+ */
+class JoinTest {
+
+    private val employees = DataFrame(
+        mapOf(
+            "id" to listOf(1, 2, 3, 4),
+            "name" to listOf("张三", "李四", "王五", "赵六"),
+            "dept" to listOf("研发", "销售", "研发", "财务")
+        )
+    )
+
+    private val salaries = DataFrame(
+        mapOf(
+            "id" to listOf(2, 1, 5, 2),
+            "salary" to listOf(8000.0, 12000.0, 6000.0, 9000.0),
+            "dept" to listOf("销售", "研发", "市场", "销售")
+        )
+    )
+
+    @Test
+    fun testJoinTypes() {
+        println("=== 测试 各连接类型 ===")
+        val inner = employees.merge(salaries, "id")
+        println(inner)
+        assertEquals(listOf(1, 2, 2), inner["id"].values())
+        assertEquals(listOf(12000.0, 8000.0, 9000.0), inner["salary"].values())
+        // 同名非连接列加后缀
+        assertTrue("dept_x" in inner.columns() && "dept_y" in inner.columns())
+
+        val left = employees.join(salaries, "id", "left")
+        assertEquals(listOf(1, 2, 2, 3, 4), left["id"].values())
+        assertEquals(listOf(12000.0, 8000.0, 9000.0, null, null), left["salary"].values())
+
+        val right = employees.join(salaries, "id", "right")
+        assertEquals(listOf(2, 1, 5, 2), right["id"].values())
+        assertEquals(listOf("李四", "张三", null, "李四"), right["name"].values())
+
+        val outer = employees.join(salaries, "id", "outer")
+        assertEquals(listOf(1, 2, 2, 3, 4, 5), outer["id"].values())
+
+        assertEquals(listOf(1, 2), employees.join(salaries, "id", "semi")["id"].values())
+        assertEquals(listOf(3, 4), employees.join(salaries, "id", "anti")["id"].values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testCompositeKeys() {
+        println("=== 测试 组合键连接 ===")
+        val result = employees.merge(salaries, listOf("id", "dept"), "inner")
+        println(result)
+        assertEquals(listOf(1, 2, 2), result["id"].values())
+        assertEquals(listOf("研发", "销售", "销售"), result["dept"].values())
+        assertEquals(listOf(12000.0, 8000.0, 9000.0), result["salary"].values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testNativeJoinIndices() {
+        println("=== 测试 原生连接行号 ===")
+        val left = arrayOf(longArrayOf(1, 2, 2, 3))
+        val right = arrayOf(longArrayOf(2, 4, 1, 2))
+        val (l, r) = NativeData.joinIndices(left, right, JoinType.OUTER)
+        assertArrayEquals(intArrayOf(0, 1, 1, 2, 2, 3, -1), l)
+        assertArrayEquals(intArrayOf(2, 0, 3, 0, 3, -1, 1), r)
+
+        // 旧接口：浮点键按精确相等匹配
+        val pairs = NativeData.mergeIndices(doubleArrayOf(1.0, 1.0 + 1e-12, -0.0), doubleArrayOf(0.0, 1.0))
+        assertArrayEquals(intArrayOf(0, 1, 2, 0), pairs)
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testLargeJoin() {
+        println("=== 测试 大表连接维度表 ===")
+        val events = 100_000
+        val dims = 10_000
+        val eventDf = DataFrame(
+            mapOf(
+                "user" to List(events) { "u${(it * 31) % (dims + 500)}" },
+                "amount" to List(events) { it.toDouble() }
+            )
+        )
+        val dimDf = DataFrame(
+            mapOf(
+                "user" to List(dims) { "u$it" },
+                "level" to List(dims) { it % 5 }
+            )
+        )
+        val joined = eventDf.merge(dimDf, "user", "left")
+        assertEquals(events, joined.index().size)
+        val users = joined["user"].values()
+        val levels = joined["level"].values()
+        for (i in users.indices) {
+            val id = (users[i] as String).substring(1).toInt()
+            assertEquals(if (id < dims) id % 5 else null, levels[i])
+        }
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,120 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.col
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.LazyFrame
+import cn.ac.oac.libs.andas.utils.BatchCSVUtils
+import org.junit.Test
+import org.junit.Assert.*
+import java.io.ByteArrayInputStream
+import java.io.File
+
+/**
+ * 延迟执行查询计划测试
+ */
+class LazyFrameTest {
+
+    private val df = DataFrame(
+        mapOf(
+            "city" to listOf("北京", "上海", "北京", "广州", "上海", "北京"),
+            "price" to listOf(12.5, 8.0, 20.0, 30.0, null, 11.0),
+            "qty" to listOf(3, null, 7, 2, 5, 1),
+            "note" to listOf("a", "b", "c", "d", "e", "f")
+        )
+    )
+
+    @Test
+    fun testOptimizedPlan() {
+        println("=== 测试 查询计划优化 ===")
+        val lazy = df.lazy()
+            .fillNull("qty", 0.0)
+            .vectorizedAdd("price", "qty", "total")
+            .filterGreaterThan("price", 10.0)
+            .selectColumns("city", "total")
+        val plan = lazy.explain()
+        println(lazy.explain(optimized = false))
+        println(plan)
+        // 两个逐元素运算融合为一个，筛选下推到运算之下，note 列不读取
+        val lines = plan.lines().map { it.trim() }
+        assertEquals(4, lines.size)
+        assertTrue(lines[0].startsWith("Select [city, total]"))
+        assertEquals("WithColumns [total = (price + fill_null(qty, 0.0))]", lines[1])
+        assertEquals("Filter price > 10.0", lines[2])
+        assertTrue(lines[3].endsWith("columns=[city, price, qty]"))
+        assertEquals(listOf("city", "total"), lazy.columns())
+        assertThrows(IllegalArgumentException::class.java) { df.lazy().selectColumns("不存在") }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testMatchesEager() {
+        println("=== 测试 与立即执行结果一致 ===")
+        val result = df.lazy()
+            .filter(col("price") gt 10)
+            .fillNull("qty", 0.0)
+            .vectorizedAdd("price", "qty", "total")
+            .collect()
+        println(result)
+        assertEquals(listOf(0, 2, 3, 5), result.index())
+        assertEquals(listOf(15.5, 27.0, 32.0, 12.0), result["total"].values())
+        assertEquals(listOf("city", "price", "qty", "note", "total"), result.columns())
+
+        val grouped = df.lazy().filterGreaterThan("price", 10.0).groupBySum("city", "price").collect()
+        val expected = df.filterGreaterThan("price", 10.0).groupBySum("city", "price")
+        assertEquals(expected["city"].values(), grouped["city"].values())
+        assertEquals(expected["price"].values(), grouped["price"].values())
+        // 缺失值参与运算时结果为缺失值，行保持对齐
+        val added = df.lazy().vectorizedAdd("price", "qty", "total").collect()
+        assertEquals(listOf(15.5, null, 27.0, 32.0, null, 12.0), added["total"].values())
+        assertThrows(IllegalArgumentException::class.java) {
+            df.lazy().vectorizedAdd("price", "note", "x").collect()
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testNormalizeAfterFilter() {
+        println("=== 测试 筛选后标准化 ===")
+        val lazy = df.lazy().filterGreaterThan("price", 10.0).normalize("price")
+        // 标准化的统计量依赖行集合，其上的筛选不会下推
+        val filtered = lazy.filter(col("price") gt 0).explain().lines().map { it.trim() }
+        assertEquals("Filter price > 0", filtered[0])
+        val result = lazy.collect()
+        val values = result["price"].values().map { (it as Number).toDouble() }
+        // 12.5, 20, 30, 11 的总体标准化
+        val mean = values.average()
+        val variance = values.sumOf { it * it } / values.size
+        assertEquals(0.0, mean, 1e-12)
+        assertEquals(1.0, variance, 1e-12)
+        assertEquals(listOf(0, 2, 3, 5), result.index())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testCsvScan() {
+        println("=== 测试 CSV扫描 ===")
+        val file = File.createTempFile("lazy", ".csv")
+        try {
+            file.writeText("id,city,price,comment\n1,北京,12.5,\"x,y\"\n2,上海,8,z\n3,北京,,w\n4,广州,30,v\n")
+            val lazy = LazyFrame.scanCsv(file)
+                .filter(col("price") ge 10)
+                .vectorizedAdd("id", "price", "score")
+                .selectColumns("city", "score")
+            assertTrue(lazy.explain().lines().last().endsWith("columns=[id, city, price]"))
+            val result = lazy.collect()
+            println(result)
+            // 索引标签为文件中的行号
+            assertEquals(listOf(0, 3), result.index())
+            assertEquals(listOf("北京", "广州"), result["city"].values())
+            assertEquals(listOf(13.5, 34.0), result["score"].values())
+        } finally {
+            file.delete()
+        }
+
+        val input = ByteArrayInputStream("k,v,w\na,1,x\nb,2,y\na,3,z\n".toByteArray(Charsets.UTF_8))
+        val sums = BatchCSVUtils.scanCSV(input).groupBy("k").agg(mapOf("v" to "sum")).collect()
+        assertEquals(listOf("a", "b"), sums["k"].values())
+        assertEquals(listOf(4.0, 2.0), sums["v"].values().map { (it as Number).toDouble() })
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,106 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.MomentAccumulator
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.Series
+import cn.ac.oac.libs.andas.utils.BatchCSVUtils
+import cn.ac.oac.libs.andas.utils.BatchUtils
+import org.junit.Test
+import org.junit.Assert.*
+import kotlin.random.Random
+
+/**
+ * 矩累加器与统计量一致性测试
+ */
+class MomentsTest {
+
+    @Test
+    fun testSeriesStatistics() {
+        println("=== 测试 方差/偏度/峰度 ===")
+        val series = Series(listOf(1.0, 2.0, 3.0, 4.0, 10.0, null))
+        // 与 pandas 一致：默认样本方差，缺失值不计入
+        assertEquals(12.5, series.variance(), 1e-12)
+        assertEquals(10.0, series.variance(ddof = 0), 1e-12)
+        assertEquals(1.6970562748477143, series.skew(), 1e-12)
+        assertEquals(3.152, series.kurt(), 1e-12)
+        // describe 与 std() 使用同一个累加器
+        assertEquals(series.std(), series.describe()["std"]!!, 0.0)
+        assertEquals(5.0, series.describe()["count"]!!, 0.0)
+
+        assertTrue(Series(listOf(5.0)).variance().isNaN())
+        assertTrue(Series(listOf(1.0, 2.0)).skew().isNaN())
+        assertEquals(0.0, Series(listOf(3.0, 3.0, 3.0, 3.0)).kurt(), 0.0)
+
+        val df = DataFrame(mapOf("v" to listOf(1, 2, 3, 4, 10)))
+        assertEquals(12.5, df.variance("v"), 1e-12)
+        assertEquals(series.describe(), df.describe("v"))
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testCancellation() {
+        println("=== 测试 大均值数据的数值稳定性 ===")
+        // sumSq/n - mean^2 在这组数据上失效，真实总体方差为 22.5
+        val pattern = doubleArrayOf(4.0, 7.0, 13.0, 16.0)
+        val values = DoubleArray(100000) { 1e9 + pattern[it % 4] }
+        val moments = MomentAccumulator.of(values)
+        println(moments)
+        assertEquals(22.5, moments.variance(ddof = 0), 1e-6)
+        assertEquals(1e9 + 10.0, moments.mean, 1e-6)
+        assertEquals(values.size * (1e9 + 10.0), moments.sum, 1e-3)
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testMerge() {
+        println("=== 测试 分块合并 ===")
+        val random = Random(42)
+        val values = DoubleArray(5000) { if (random.nextInt(20) == 0) Double.NaN else random.nextDouble() * 100 - 20 }
+        val whole = MomentAccumulator.of(values)
+
+        val merged = MomentAccumulator()
+        var from = 0
+        while (from < values.size) {
+            val to = minOf(values.size, from + 1 + random.nextInt(700))
+            merged.merge(MomentAccumulator.of(values.copyOfRange(from, to)))
+            from = to
+        }
+        val single = MomentAccumulator()
+        values.forEach { single.add(it) }
+
+        for (m in listOf(merged, single)) {
+            assertEquals(whole.count, m.count)
+            assertEquals(whole.mean, m.mean, 1e-10)
+            assertEquals(whole.variance(), m.variance(), 1e-8)
+            assertEquals(whole.skew(), m.skew(), 1e-10)
+            assertEquals(whole.kurt(), m.kurt(), 1e-10)
+            assertEquals(whole.min, m.min, 0.0)
+            assertEquals(whole.max, m.max, 0.0)
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testBatchPaths() {
+        println("=== 测试 分批统计与整体统计一致 ===")
+        val random = Random(3)
+        val values = List(997) { if (it % 31 == 0) null else random.nextInt(1000) + 1e6 }
+        val expected = Series(values)
+        val csv = "v\n" + values.joinToString("\n") { it?.toString() ?: "" } + "\n"
+
+        val streamed = BatchCSVUtils.batchMoments(csv.byteInputStream(), "v", batchSize = 64)
+        assertEquals(expected.moments().count, streamed.count)
+        assertEquals(expected.std(), BatchCSVUtils.batchStd(csv.byteInputStream(), "v", batchSize = 64), 1e-9)
+        val described = BatchCSVUtils.batchDescribe(csv.byteInputStream(), "v", batchSize = 64)
+        // 分位数来自各自的摘要，这里只比较矩统计量
+        for (key in listOf("count", "mean", "std", "min", "max")) {
+            assertEquals(key, expected.describe()[key]!!, described[key]!!, 1e-6)
+        }
+        assertEquals(expected.skew(), streamed.skew(), 1e-9)
+
+        val df = DataFrame(mapOf("v" to values))
+        assertEquals(expected.std(), BatchUtils.batchStd(df, "v", batchSize = 100), 1e-9)
+        assertEquals(expected.moments().mean, BatchUtils.batchMean(df, "v", batchSize = 100), 1e-6)
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,69 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.NativeColumn
+import cn.ac.oac.libs.andas.core.NativeData
+import cn.ac.oac.libs.andas.core.NativeMath
+import cn.ac.oac.libs.andas.entity.Series
+import org.junit.Test
+import org.junit.Assert.*
+
+/**
+ * 原生列（DirectByteBuffer）测试
+ */
+class NativeColumnTest {
+
+    @Test
+    fun testColumnMatchesArrayKernels() {
+        println("=== 测试 原生列与数组版本结果一致 ===")
+        val array = doubleArrayOf(582567.03, -86165.50, 619267.93, -261499.41, -368748.13)
+        NativeColumn.fromDoubleArray(array).use { column ->
+            assertTrue(column.buffer.isDirect)
+            assertEquals(NativeMath.sumDoubleArray(array), NativeMath.sumDoubleArray(column), 1e-6)
+            assertEquals(NativeMath.meanDoubleArray(array), NativeMath.meanDoubleArray(column), 1e-6)
+            assertEquals(NativeMath.maxDoubleArray(array), NativeMath.maxDoubleArray(column), 0.0)
+            assertEquals(NativeMath.minDoubleArray(array), NativeMath.minDoubleArray(column), 0.0)
+            assertEquals(NativeMath.variance(array), NativeMath.variance(column), 1e-3)
+            assertArrayEquals(NativeMath.argsort(array), NativeMath.argsort(column))
+            assertArrayEquals(NativeData.describe(array), NativeData.describe(column), 1e-6)
+            println("求和: ${NativeMath.sumDoubleArray(column)}")
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testInPlaceOperation() {
+        println("=== 测试 原地运算 ===")
+        NativeColumn.fromDoubleArray(doubleArrayOf(1.0, 2.0, Double.NaN, 4.0)).use { column ->
+            NativeMath.multiplyDoubleArray(column, 2.0, column)
+            NativeData.fillNullWithConstant(column, 0.0, column)
+            println("结果: ${column.toDoubleArray().joinToString()}")
+            assertArrayEquals(doubleArrayOf(2.0, 4.0, 0.0, 8.0), column.toDoubleArray(), 0.0)
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testResidentSeries() {
+        println("=== 测试 常驻原生内存的Series ===")
+        val series = Series(listOf(1.0, null, 3.0, 4.0), name = "value")
+        series.toNative()
+        assertTrue(series.isNativeResident())
+        assertEquals(8.0, series.sum(), 1e-9)
+        assertEquals(listOf(1), series.findNullIndices())
+
+        val doubled = series * 2
+        assertTrue(doubled.isNativeResident())
+        assertEquals(listOf(2.0, null, 6.0, 8.0), doubled.values())
+
+        val added = series + doubled
+        assertEquals(24.0, added.sum(), 1e-9)
+        println("结果: ${added.values()}")
+
+        added.releaseNative()
+        doubled.releaseNative()
+        series.releaseNative()
+        assertFalse(series.isNativeResident())
+        assertEquals(8.0, series.sum(), 1e-9)
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,114 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.NativeColumn
+import cn.ac.oac.libs.andas.core.NativeData
+import cn.ac.oac.libs.andas.core.NativeMath
+import cn.ac.oac.libs.andas.core.NativeRuntime
+import org.junit.Test
+import org.junit.Assert.*
+
+/**
+ * 原生并行运行时测试
+ * 验证不同线程数下的计算结果一致，以及原生内存预算
+ */
+class NativeRuntimeTest {
+
+    private fun largeArray(size: Int): DoubleArray {
+        return DoubleArray(size) { i -> if (i % 97 == 0) Double.NaN else (i % 1000) * 0.5 - 200.0 }
+    }
+
+    @Test
+    fun testThreadCountControl() {
+        println("=== 测试 线程数控制 ===")
+        val original = NativeRuntime.getNumThreads()
+        try {
+            NativeRuntime.setNumThreads(3)
+            assertEquals(3, NativeRuntime.getNumThreads())
+            NativeRuntime.setNumThreads(0)
+            assertTrue(NativeRuntime.getNumThreads() >= 1)
+        } finally {
+            NativeRuntime.setNumThreads(original)
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testParallelResultsMatchSerial() {
+        println("=== 测试 并行与串行结果一致 ===")
+        val array = largeArray(1_000_000)
+        val originalThreads = NativeRuntime.getNumThreads()
+        val originalThreshold = NativeRuntime.getParallelThreshold()
+        try {
+            NativeRuntime.setNumThreads(1)
+            val serialMax = NativeMath.maxDoubleArray(array)
+            val serialNulls = NativeData.findNullIndices(array)
+            val serialSorted = NativeData.sortIndices(array.map { if (it.isNaN()) 0.0 else it }.toDoubleArray(), false)
+
+            NativeRuntime.setNumThreads(4)
+            NativeRuntime.setParallelThreshold(1024)
+            val parallelMax = NativeMath.maxDoubleArray(array)
+            val parallelNulls = NativeData.findNullIndices(array)
+            val parallelSorted = NativeData.sortIndices(array.map { if (it.isNaN()) 0.0 else it }.toDoubleArray(), false)
+
+            println("串行最大值: $serialMax, 并行最大值: $parallelMax")
+            println("空值数量: ${parallelNulls.size}")
+            assertEquals(serialMax, parallelMax, 0.0)
+            assertArrayEquals(serialNulls, parallelNulls)
+            assertEquals(serialSorted.size, parallelSorted.size)
+            for (i in 1 until parallelSorted.size) {
+                val prev = array[parallelSorted[i - 1]].let { if (it.isNaN()) 0.0 else it }
+                val curr = array[parallelSorted[i]].let { if (it.isNaN()) 0.0 else it }
+                assertTrue(prev <= curr)
+            }
+        } finally {
+            NativeRuntime.setNumThreads(originalThreads)
+            NativeRuntime.setParallelThreshold(originalThreshold)
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testMemoryLimit() {
+        println("=== 测试 原生内存预算 ===")
+        val originalLimit = NativeRuntime.getMemoryLimit()
+        try {
+            NativeRuntime.trimMemory()
+            val before = NativeRuntime.memoryStats()
+            NativeColumn.allocate(100_000).use { column ->
+                column[99_999] = 1.0
+                assertTrue(NativeRuntime.memoryStats().current > before.current)
+            }
+            // 释放的列缓冲区留在池中，同样大小的列直接复用
+            NativeColumn.allocate(100_000).use { }
+            assertTrue(NativeRuntime.memoryStats().poolHits > before.poolHits)
+
+            // 超出预算时抛出 OutOfMemoryError，而不是让进程终止
+            NativeRuntime.setMemoryLimit(NativeRuntime.memoryStats().current + 1024 * 1024)
+            var error: Throwable? = null
+            try {
+                NativeColumn.allocate(10_000_000).close()
+            } catch (e: OutOfMemoryError) {
+                error = e
+            }
+            println("超出预算: ${error?.message}")
+            assertNotNull(error)
+            assertTrue(NativeRuntime.memoryStats().failures > before.failures)
+            // 内核的临时内存同样受预算约束
+            error = null
+            try {
+                NativeData.sortIndices(largeArray(1_000_000), false)
+            } catch (e: OutOfMemoryError) {
+                error = e
+            }
+            assertNotNull(error)
+
+            NativeRuntime.setMemoryLimit(0)
+            val stats = NativeRuntime.memoryStats()
+            println("原生内存: ${stats.toMap()}")
+            assertTrue(stats.peak >= stats.current)
+        } finally {
+            NativeRuntime.setMemoryLimit(originalLimit)
+        }
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,72 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.NativeStats
+import org.junit.Test
+import org.junit.Assert.*
+
+/**
+ * 原生埋点测试：快照的派生指标；原生库不可用时各接口退化为空操作
+ */
+class NativeStatsTest {
+
+    private fun stats(histogram: LongArray) = NativeStats.KernelStats(
+        name = "NativeData.sortIndices",
+        calls = histogram.sum(),
+        totalNanos = 5_000_000,
+        marshalNanos = 1_500_000,
+        bytesIn = 8000,
+        bytesOut = 4000,
+        pinnedArrays = 3,
+        copiedArrays = 1,
+        copiedBytes = 4000,
+        directBuffers = 0,
+        latencyHistogram = histogram
+    )
+
+    @Test
+    fun testKernelStats() {
+        println("=== 测试 内核统计 ===")
+        val histogram = LongArray(40)
+        histogram[10] = 98    // [1024, 2048) ns
+        histogram[20] = 2     // [1M, 2M) ns
+        val kernel = stats(histogram)
+        assertEquals(3_500_000L, kernel.computeNanos)
+        assertEquals(50_000.0, kernel.meanNanos, 0.0)
+        assertEquals(2047L, kernel.latencyPercentile(0.5))
+        assertEquals(2047L, kernel.latencyPercentile(0.98))
+        assertEquals((1L shl 21) - 1, kernel.latencyPercentile(0.99))
+        assertEquals(0L, stats(LongArray(40)).latencyPercentile(0.5))
+        try {
+            kernel.latencyPercentile(1.5)
+            fail("分位数超出 [0, 1] 应抛出异常")
+        } catch (e: IllegalArgumentException) {
+            println("预期异常: ${e.message}")
+        }
+
+        val other = stats(LongArray(40).also { it[5] = 1 }).copy(name = "NativeMath.sumDoubleArray", totalNanos = 100)
+        val snapshot = NativeStats.Snapshot(listOf(other, kernel))
+        println(snapshot)
+        assertEquals(listOf(kernel), snapshot.slowest(1))
+        assertEquals(kernel, snapshot["NativeData.sortIndices"])
+        assertEquals(5_000_100L, snapshot.totalNanos)
+        assertEquals(2L, snapshot.copiedArrays)
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testWithoutNative() {
+        println("=== 测试 无原生库时的埋点接口 ===")
+        // 单元测试环境没有原生库：快照为空，追踪导出空事件列表
+        NativeStats.reset()
+        NativeStats.startTrace()
+        assertTrue(NativeStats.stopTrace().startsWith("{\"traceEvents\":"))
+        println(NativeStats.snapshot().toMap())
+        try {
+            NativeStats.startTrace(0)
+            fail("事件数为 0 应抛出异常")
+        } catch (e: IllegalArgumentException) {
+            println("预期异常: ${e.message}")
+        }
+        println("✅ 测试通过\n")
+    }
+}
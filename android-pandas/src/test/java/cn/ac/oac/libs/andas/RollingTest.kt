@@ -0,0 +1,123 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.RollingAccumulator
+import cn.ac.oac.libs.andas.core.RollingOp
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.Series
+import cn.ac.oac.libs.andas.utils.BatchCSVUtils
+import org.junit.Test
+import org.junit.Assert.*
+import kotlin.random.Random
+
+/**
+ * 滑动窗口测试
+ */
+class RollingTest {
+
+    @Test
+    fun testSeriesRolling() {
+        println("=== 测试 Series 滑动窗口 ===")
+        val series = Series(listOf(1.0, 2.0, null, 4.0, 5.0, 6.0), listOf("a", "b", "c", "d", "e", "f"), "v")
+        val mean = series.rolling(3).mean()
+        println(mean)
+        // 默认 minPeriods 等于窗口大小，窗口内有缺失值时结果为 null
+        assertEquals(listOf(null, null, null, null, null, 5.0), mean.values())
+        assertEquals(series.index(), mean.index())
+        assertEquals(listOf(1.0, 1.5, 1.5, 3.0, 4.5, 5.0), series.rolling(3, minPeriods = 1).mean().values())
+        assertEquals(listOf(1.0, 2.0, 1.0, 1.0, 2.0, 3.0), series.rolling(3, minPeriods = 0).count().values())
+        assertEquals(listOf(1.0, 2.0, 2.0, 4.0, 5.0, 6.0), series.rolling(2, minPeriods = 1).max().values())
+
+        // 居中窗口：window=3 时为 [i-1, i+1]
+        val ints = Series(listOf(1, 2, 3, 4, 5))
+        assertEquals(listOf(null, 6.0, 9.0, 12.0, null), ints.rolling(3, center = true).sum().values())
+        assertEquals(listOf(3.0, 6.0, 9.0, 12.0, 9.0), ints.rolling(3, minPeriods = 1, center = true).sum().values())
+        assertEquals(listOf(null, 2.0, 3.0, 4.0, null), ints.rolling(3, center = true).median().values())
+
+        // 全部相等的窗口方差为 0
+        val flat = Series(listOf(1e6 + 0.1, 1e6 + 0.1, 1e6 + 0.1, 7.0))
+        assertEquals(listOf(null, 0.0, 0.0), flat.rolling(2).std().values().take(3))
+        assertEquals(0.0, flat.rolling(2).variance().values()[2]!!, 0.0)
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testExpanding() {
+        println("=== 测试 扩展窗口 ===")
+        val series = Series(listOf(3.0, 1.0, null, 4.0, 1.0, 5.0))
+        assertEquals(listOf(3.0, 3.0, 3.0, 4.0, 4.0, 5.0), series.expanding().max().values())
+        assertEquals(listOf(3.0, 4.0, 4.0, 8.0, 9.0, 14.0), series.expanding().sum().values())
+        assertEquals(listOf(null, 2.0, 2.0, 3.0, 2.0, 3.0), series.expanding(minPeriods = 2).median().values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testDataFrameRolling() {
+        println("=== 测试 DataFrame 滑动窗口 ===")
+        val df = DataFrame(
+            mapOf(
+                "city" to listOf("北京", "上海", "广州", "深圳"),
+                "price" to listOf(10.0, 12.0, null, 16.0),
+                "qty" to listOf(1, 2, 3, 4)
+            )
+        )
+        val result = df.rolling(2, minPeriods = 1).sum()
+        println(result)
+        // 非数值列不出现在结果中
+        assertEquals(listOf("price", "qty"), result.columns())
+        assertEquals(listOf(10.0, 22.0, 12.0, 16.0), result["price"].values())
+        assertEquals(listOf(1.0, 3.0, 5.0, 7.0), result["qty"].values())
+        assertEquals(listOf(1.0, 1.5, 2.0, 2.5), df.expanding().mean()["qty"].values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testAccumulatorMatchesWhole() {
+        println("=== 测试 分批滑动窗口 ===")
+        val random = Random(7)
+        val values = DoubleArray(1000) { if (random.nextInt(10) == 0) Double.NaN else random.nextInt(50).toDouble() }
+        val whole = Series(values.map { if (it.isNaN()) null else it })
+        for (op in RollingOp.values()) {
+            for (center in listOf(false, true)) {
+                for (window in listOf(1, 4, 25)) {
+                    val expected = whole.rolling(window, minPeriods = 1, center = center).aggregate(op).values()
+                    val accumulator = RollingAccumulator(op, window, 1, center)
+                    val parts = mutableListOf<Double?>()
+                    var from = 0
+                    // 批大小不一，包括小于窗口的批
+                    while (from < values.size) {
+                        val to = minOf(values.size, from + 1 + random.nextInt(40))
+                        accumulator.update(values.copyOfRange(from, to)).forEach { parts.add(if (it.isNaN()) null else it) }
+                        from = to
+                    }
+                    accumulator.finish().forEach { parts.add(if (it.isNaN()) null else it) }
+                    assertEquals(expected.size, parts.size)
+                    for (i in parts.indices) {
+                        if (expected[i] == null) assertNull(parts[i]) else assertEquals(expected[i]!!, parts[i]!!, 1e-9)
+                    }
+                }
+            }
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testBatchRolling() {
+        println("=== 测试 CSV 分批滑动窗口 ===")
+        val csv = "id,price\n1,10\n2,20\n3,\n4,40\n5,50\n6,60\n7,70\n"
+        val result = BatchCSVUtils.batchRolling(csv.byteInputStream(), "price", 3, RollingOp.MEAN, minPeriods = 2, batchSize = 2)
+        println(result)
+        assertEquals("price_rolling_3_mean", result.name())
+        assertEquals(listOf(null, 15.0, 15.0, 30.0, 45.0, 50.0, 60.0), result.values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testInvalidArguments() {
+        println("=== 测试 参数检查 ===")
+        val series = Series(listOf(1.0, 2.0))
+        assertThrows(IllegalArgumentException::class.java) { series.rolling(0) }
+        assertThrows(IllegalArgumentException::class.java) { series.rolling(2, minPeriods = 3) }
+        assertThrows(IllegalArgumentException::class.java) { Series(listOf("a", "b")).rolling(1).sum() }
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,173 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.BernoulliSampler
+import cn.ac.oac.libs.andas.core.ReservoirSampler
+import cn.ac.oac.libs.andas.core.SamplingEngine
+import cn.ac.oac.libs.andas.core.Xoshiro256
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.Series
+import cn.ac.oac.libs.andas.utils.BatchCSVUtils
+import org.junit.Test
+import org.junit.Assert.*
+import kotlin.math.abs
+
+/**
+ * 随机采样测试：可复现的种子、简单/加权/分层采样和数据流采样
+ */
+class SamplingTest {
+
+    @Test
+    fun testGenerator() {
+        println("=== 测试 随机数生成器 ===")
+        // 与原生测试 test_sampling.cpp 使用相同的参考值
+        val random = Xoshiro256(42)
+        assertEquals(1546998764402558742L, random.next())
+        assertEquals(6990951692964543102L, random.next())
+        assertEquals(12544586762248559009UL.toLong(), random.next())
+        assertEquals(4340728156303693306L, Xoshiro256.deriveSeed(42, 0))
+
+        assertArrayEquals(intArrayOf(475994, 515067, 406320, 994628, 453924), SamplingEngine.sampleIndices(1000000, 5, 7))
+        assertArrayEquals(intArrayOf(4, 6, 8, 0, 1, 3, 5, 2, 7, 9), SamplingEngine.sampleIndices(10, 10, 7))
+        assertArrayEquals(
+            intArrayOf(5, 3, 1),
+            SamplingEngine.weightedSampleIndices(doubleArrayOf(1.0, 2.0, 0.0, 3.0, -1.0, 4.0), 3, 11)
+        )
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testSample() {
+        println("=== 测试 DataFrame/Series 采样 ===")
+        val df = DataFrame(mapOf(
+            "id" to (0 until 1000).toList(),
+            "value" to (0 until 1000).map { it * 0.5 }
+        ))
+        val a = df.sample(50, seed = 42L)
+        val b = df.sample(50, seed = 42L)
+        println(a.head(3))
+        assertEquals(a.index(), b.index())
+        assertEquals(50, a.index().toSet().size)
+        // 所有列使用同一组行号，索引标签保留原行号
+        for (i in 0 until 50) {
+            val id = a["id"][i] as Int
+            assertEquals(id, a.index()[i])
+            assertEquals(id * 0.5, a["value"][i] as Double, 0.0)
+        }
+        assertNotEquals(a.index(), df.sample(50, seed = 43L).index())
+        assertEquals(10, df.sample(0.01, seed = 1L).shape().first)
+        assertEquals(1000, df.sample(5000, seed = 1L).index().toSet().size)
+
+        val series = Series((0 until 100).toList())
+        assertEquals(series.sample(10, seed = 3L).values(), series.sample(10, seed = 3L).values())
+        assertEquals(25, series.sample(0.25, seed = 3L).size())
+        try {
+            series.sample(1.5)
+            fail("采样比例超出 [0, 1] 应抛出异常")
+        } catch (e: IllegalArgumentException) {
+            println("预期异常: ${e.message}")
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testWeightedSample() {
+        println("=== 测试 加权采样 ===")
+        val df = DataFrame(mapOf(
+            "name" to listOf("a", "b", "c", "d", "e"),
+            "w" to listOf(1.0, 0.0, null, 5.0, 2.0)
+        ))
+        val sampled = df.sample(3, seed = 7L, weights = "w")
+        assertEquals(setOf("a", "d", "e"), sampled["name"].values().toSet())
+
+        // 取 1 行时被选中的概率与权重成正比
+        val hits = IntArray(5)
+        repeat(4000) { seed -> hits[df.sample(1, seed = seed.toLong(), weights = "w").index()[0] as Int]++ }
+        println("命中次数: ${hits.toList()}")
+        assertEquals(0, hits[1] + hits[2])
+        assertEquals(5.0 / 8, hits[3] / 4000.0, 0.03)
+
+        try {
+            df.sample(4, seed = 7L, weights = "w")
+            fail("权重为正的行数不足时应抛出异常")
+        } catch (e: IllegalArgumentException) {
+            println("预期异常: ${e.message}")
+        }
+        try {
+            DataFrame(mapOf("w" to listOf(1.0, -1.0))).sample(1, weights = "w")
+            fail("负权重应抛出异常")
+        } catch (e: IllegalArgumentException) {
+            println("预期异常: ${e.message}")
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testStratifiedSample() {
+        println("=== 测试 分层采样 ===")
+        val groups = List(1000) { if (it % 100 == 0) null else "g${it % 4}" }
+        val df = DataFrame(mapOf("group" to groups, "id" to (0 until 1000).toList()))
+        val sampled = df.groupBy("group").sample(0.1, seed = 5L)
+        val counts = sampled["group"].values().groupingBy { it }.eachCount()
+        println(counts)
+        // 每组 250 行，其中 g0 有 10 行键为空
+        assertEquals(mapOf("g0" to 24, "g1" to 25, "g2" to 25, "g3" to 25), counts)
+        assertEquals(sampled.index(), df.groupBy("group").sample(0.1, seed = 5L).index())
+        // 组按首次出现的顺序：第 0 行的键为空，g0 首次出现在第 4 行
+        assertEquals(listOf("g1", "g2", "g3", "g0"), sampled["group"].values().distinct())
+
+        val two = df.groupBy("group").sample(2, seed = 5L)
+        assertEquals(8, two.shape().first)
+        for (i in 0 until 8) assertEquals(groups[two.index()[i] as Int], two["group"][i])
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testStreamSamplers() {
+        println("=== 测试 数据流采样 ===")
+        // 蓄水池：分批方式不影响结果，每个元素进入样本的概率为 k / n
+        fun reservoirOf(seed: Long, batches: List<Int>): List<Int> {
+            val sampler = ReservoirSampler(5, seed)
+            val reservoir = IntArray(5)
+            var start = 0
+            for (batch in batches) {
+                sampler.advance(batch) { offset, slot -> reservoir[slot] = start + offset }
+                start += batch
+            }
+            return reservoir.toList()
+        }
+        val hits = IntArray(40)
+        repeat(5000) { seed ->
+            val reservoir = reservoirOf(seed.toLong(), listOf(3, 7, 1, 19, 10))
+            assertEquals(reservoirOf(seed.toLong(), listOf(40)), reservoir)
+            assertEquals(5, reservoir.toSet().size)
+            reservoir.forEach { hits[it]++ }
+        }
+        for (h in hits) assertEquals(0.125, h / 5000.0, 0.02)
+
+        val bernoulli = BernoulliSampler(0.01, 9)
+        var selected = 0
+        repeat(100) { bernoulli.advance(10000) { selected++ } }
+        println("伯努利采样: $selected / 1000000")
+        assertTrue(abs(selected - 10000) < 400)
+        var none = 0
+        BernoulliSampler(0.0, 9).advance(1000) { none++ }
+        assertEquals(0, none)
+        var all = 0
+        BernoulliSampler(1.0, 9).advance(1000) { all++ }
+        assertEquals(1000, all)
+
+        val csv = "id,v\n" + (0 until 5000).joinToString("\n") { "$it,${it % 7}" } + "\n"
+        val sample = BatchCSVUtils.batchSample(csv.byteInputStream(), 100, batchSize = 128, seed = 11L)
+        val ids = sample["id"].values().map { (it as Number).toInt() }
+        assertEquals(100, ids.toSet().size)
+        assertEquals(ids.sorted(), ids)
+        val again = BatchCSVUtils.batchSample(csv.byteInputStream(), 100, batchSize = 512, seed = 11L)
+        assertEquals(ids, again["id"].values().map { (it as Number).toInt() })
+        assertEquals(5000, BatchCSVUtils.batchSample(csv.byteInputStream(), 10000, seed = 11L).shape().first)
+
+        val fraction = BatchCSVUtils.batchSampleFraction(csv.byteInputStream(), 0.1, batchSize = 100, seed = 11L)
+        println("按比例采样: ${fraction.shape().first} 行")
+        assertTrue(abs(fraction.shape().first - 500) < 70)
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,165 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.DistinctCountSketch
+import cn.ac.oac.libs.andas.core.HeavyHitters
+import cn.ac.oac.libs.andas.core.QuantileSketch
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.Series
+import cn.ac.oac.libs.andas.utils.BatchCSVUtils
+import org.junit.Test
+import org.junit.Assert.*
+import kotlin.math.abs
+import kotlin.random.Random
+
+/**
+ * 分位数 / 去重计数 / 高频项摘要测试
+ */
+class SketchTest {
+
+    @Test
+    fun testQuantileSketch() {
+        println("=== 测试 分位数摘要 ===")
+        // 数据量不超过摘要容量时与 pandas 的线性插值一致
+        val series = Series(listOf(1.0, 2.0, 3.0, 4.0, 10.0, null))
+        assertEquals(3.0, series.approxQuantile(0.5), 0.0)
+        val quantiles = series.approxQuantile(listOf(0.25, 0.9))
+        assertEquals(2.0, quantiles[0], 0.0)
+        assertEquals(7.6, quantiles[1], 1e-12)
+        assertTrue(Series(listOf<Double?>(null)).approxQuantile(0.5).isNaN())
+
+        // 大数据量：秩误差在 1% 以内，分批构建的摘要合并后同样满足
+        val random = Random(17)
+        val values = DoubleArray(200000) { random.nextDouble() * random.nextDouble() * 1000 }
+        val sorted = values.sortedArray()
+        val whole = QuantileSketch.of(values)
+        val merged = QuantileSketch()
+        var from = 0
+        while (from < values.size) {
+            val to = minOf(values.size, from + 1 + random.nextInt(15000))
+            merged.merge(QuantileSketch.of(values.copyOfRange(from, to)))
+            from = to
+        }
+        println(whole)
+        assertFalse(whole.isExact)
+        assertEquals(values.size.toLong(), merged.count)
+        for (q in listOf(0.01, 0.25, 0.5, 0.75, 0.99)) {
+            for (sketch in listOf(whole, merged)) {
+                val rank = sorted.binarySearch(sketch.quantile(q)).let { if (it < 0) -it - 1 else it }
+                assertTrue("q=$q", abs(rank.toDouble() / values.size - q) < 0.01)
+            }
+        }
+        assertEquals(sorted.first(), merged.quantile(0.0), 0.0)
+        assertEquals(sorted.last(), merged.quantile(1.0), 0.0)
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testDescribePercentiles() {
+        println("=== 测试 describe 分位数 ===")
+        val series = Series(listOf(1, 2, 3, 4, 10))
+        val described = series.describe()
+        println(described)
+        assertEquals(listOf("count", "mean", "std", "min", "25%", "50%", "75%", "max"), described.keys.toList())
+        assertEquals(2.0, described["25%"]!!, 0.0)
+        assertEquals(3.0, described["50%"]!!, 0.0)
+        assertEquals(4.0, described["75%"]!!, 0.0)
+
+        val custom = series.describe(listOf(0.025, 0.9))
+        assertEquals(listOf("count", "mean", "std", "min", "2.5%", "90%", "max"), custom.keys.toList())
+        assertEquals(1.1, custom["2.5%"]!!, 1e-12)
+
+        val df = DataFrame(mapOf("v" to listOf(1, 2, 3, 4, 10)))
+        assertEquals(described, df.describe("v"))
+        assertEquals(3.0, df.approxQuantile("v", 0.5), 0.0)
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testDistinctCount() {
+        println("=== 测试 HyperLogLog 去重计数 ===")
+        val strings = Series(List(120000) { if (it % 7 == 0) null else "user-${it % 40000}" })
+        val estimate = strings.approxNunique()
+        println("估计: $estimate, 精确: 40000")
+        assertTrue(abs(estimate - 40000.0) / 40000 < 0.025)
+
+        // 数值按 double 比较：1 与 1.0 是同一个值，NaN 不计入
+        assertEquals(3L, Series(listOf(1, 2, 2, 3, null)).approxNunique())
+        assertEquals(
+            Series(listOf(1, 2, 3)).distinctSketch().estimate(),
+            Series(listOf(1.0, 2.0, 3.0, Double.NaN)).distinctSketch().estimate(),
+            0.0
+        )
+
+        // 分两部分合并与整体构建的寄存器相同
+        val a = Series(List(30000) { it }).distinctSketch()
+        val b = Series(List(30000) { it + 20000 }).distinctSketch()
+        val all = Series(List(50000) { it }).distinctSketch()
+        assertEquals(all.estimate(), a.merge(b).estimate(), 0.0)
+        try {
+            a.merge(DistinctCountSketch(10))
+            fail("精度不同的摘要不能合并")
+        } catch (e: IllegalArgumentException) {
+            println("预期异常: ${e.message}")
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testTopK() {
+        println("=== 测试 高频项 ===")
+        val series = Series(listOf("a", "b", "a", "c", "a", "b", null, "d"))
+        assertEquals(linkedMapOf("a" to 3L, "b" to 2L), series.topK(2))
+
+        // 容量小于不同值个数时：估计次数不小于真实次数，高估量不超过 total / capacity
+        val random = Random(9)
+        val values = List(50000) { if (random.nextInt(4) == 0) random.nextInt(10) else 100 + random.nextInt(20000) }
+        val truth = values.groupingBy { it }.eachCount()
+        val sketch = HeavyHitters<Int>(64)
+        values.forEach { sketch.add(it) }
+        val top = sketch.top(10)
+        println(top.take(3))
+        assertEquals((0 until 10).toSet(), top.map { it.value }.toSet())
+        for (entry in top) {
+            val actual = truth[entry.value]!!.toLong()
+            assertTrue(entry.count >= actual)
+            assertTrue(entry.count - entry.error <= actual)
+            assertTrue(entry.count - actual <= sketch.total / 64)
+        }
+
+        // 数值列保留元素类型
+        val ints = Series(listOf(5, 7, 5, 5, 7, 1))
+        assertEquals(linkedMapOf(5 to 3L, 7 to 2L), ints.topK(2))
+        val df = DataFrame(mapOf("k" to listOf("x", "y", "x")))
+        assertEquals(mapOf<Any, Long>("x" to 2L), df.topK("k", 1))
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testBatchSketches() {
+        println("=== 测试 分批摘要合并 ===")
+        val random = Random(21)
+        val rows = List(5000) { random.nextInt(200) }
+        // 第一批全部为整数，后面的批次混有小数，类型推断不同时同一个值仍合并
+        val cells = rows.mapIndexed { i, v -> if (i >= 100 && i % 7 == 0) "$v.5" else "$v" }
+        val csv = "v\n" + cells.joinToString("\n") + "\n"
+        val exactDistinct = cells.toSet().size
+
+        val nunique = BatchCSVUtils.batchApproxNunique(csv.byteInputStream(), "v", batchSize = 100)
+        println("估计: $nunique, 精确: $exactDistinct")
+        assertTrue(abs(nunique - exactDistinct).toDouble() / exactDistinct < 0.025)
+
+        val numbers = cells.map { it.toDouble() }.sorted()
+        val median = BatchCSVUtils.batchApproxQuantile(csv.byteInputStream(), "v", listOf(0.5), batchSize = 100)[0]
+        assertTrue(median >= numbers[(numbers.size * 0.49).toInt()] && median <= numbers[(numbers.size * 0.51).toInt()])
+
+        val top = BatchCSVUtils.batchTopK(csv.byteInputStream(), "v", 3, batchSize = 100)
+        val truth = cells.groupingBy { it.toDouble() }.eachCount()
+        for ((value, count) in top) {
+            assertEquals(truth[(value as Number).toDouble()]!!.toLong(), count)
+        }
+
+        val described = BatchCSVUtils.batchDescribe(csv.byteInputStream(), "v", batchSize = 100, percentiles = listOf(0.5))
+        assertEquals(median, described["50%"]!!, 0.0)
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,75 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.Series
+import org.junit.Test
+import org.junit.Assert.*
+
+/**
+ * 排序与 top-k 测试
+ */
+class SortTest {
+
+    private val df = DataFrame(
+        mapOf(
+            "dept" to listOf("研发", "销售", "研发", null, "销售", "研发"),
+            "salary" to listOf(8000.0, 12000.0, null, 6000.0, 9000.0, 8000.0),
+            "age" to listOf(30, 25, 41, 35, 25, 28)
+        )
+    )
+
+    @Test
+    fun testSeriesSort() {
+        println("=== 测试 Series 稳定排序 ===")
+        val series = Series(listOf(3.0, null, 1.0, 3.0, -0.0, 0.0), listOf("a", "b", "c", "d", "e", "f"))
+        val asc = series.sortValues()
+        assertEquals(listOf(-0.0, 0.0, 1.0, 3.0, 3.0, null), asc.values())
+        assertEquals(listOf("e", "f", "c", "a", "d", "b"), asc.index())
+        // 降序时相等的值仍保持原顺序，缺失值在最后
+        assertEquals(listOf("a", "d", "c", "e", "f", "b"), series.sortValues(descending = true).index())
+        assertEquals(listOf(4, 5, 2, 0, 3, 1), series.sortIndices())
+        // 字符串按字典编码排序
+        assertEquals(listOf("a", "b", "c", null), Series(listOf("c", null, "a", "b")).sortValues().values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testMultiColumnSort() {
+        println("=== 测试 DataFrame 多列排序 ===")
+        val sorted = df.sortValues(listOf("dept", "salary"), listOf(true, false))
+        println(sorted)
+        assertEquals(listOf("研发", "研发", "研发", "销售", "销售", null), sorted["dept"].values())
+        assertEquals(listOf(8000.0, 8000.0, null, 12000.0, 9000.0, 6000.0), sorted["salary"].values())
+        // 保留原索引标签
+        assertEquals(listOf(0, 5, 2, 1, 4, 3), sorted.index())
+
+        val nullsFirst = df.sortValues(listOf("salary"), naPosition = "first")
+        assertEquals(listOf(null, 6000.0, 8000.0, 8000.0, 9000.0, 12000.0), nullsFirst["salary"].values())
+        assertEquals(listOf(2, 3, 0, 5, 4, 1), nullsFirst.index())
+
+        assertEquals(listOf(1, 4, 5, 0, 3, 2), df.sortIndices("age"))
+        assertEquals(listOf(41, 35, 30, 28, 25, 25), df.sortValues("age", descending = true)["age"].values())
+
+        assertThrows(IllegalArgumentException::class.java) { df.sortValues(listOf("不存在")) }
+        assertThrows(IllegalArgumentException::class.java) { df.sortValues(listOf("age"), naPosition = "middle") }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testTopK() {
+        println("=== 测试 nlargest / nsmallest ===")
+        val largest = df.nlargest(3, "salary")
+        assertEquals(listOf(12000.0, 9000.0, 8000.0), largest["salary"].values())
+        assertEquals(listOf(1, 4, 0), largest.index())
+        assertEquals(listOf(25, 25), df.nsmallest(2, "age")["age"].values())
+        assertEquals(listOf(1, 4), df.nsmallest(2, "age").index())
+        // 缺失值不参与，n 超过行数时返回全部非缺失行
+        assertEquals(5, df.nsmallest(10, "salary")["salary"].values().size)
+
+        val series = Series(listOf(5, null, 7, 1, 7))
+        assertEquals(listOf(7, 7), series.nlargest(2).values())
+        assertEquals(listOf(2, 4), series.nlargest(2).index())
+        assertEquals(listOf(1, 5, 7, 7), series.nsmallest(10).values())
+        println("✅ 测试通过\n")
+    }
+}
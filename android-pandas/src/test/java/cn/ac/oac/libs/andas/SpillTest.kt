@@ -0,0 +1,158 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.core.RecordBuilder
+import cn.ac.oac.libs.andas.core.SpillEngine
+import cn.ac.oac.libs.andas.core.ValueCodec
+import cn.ac.oac.libs.andas.entity.DataFrame
+import cn.ac.oac.libs.andas.entity.DataFrameIO
+import cn.ac.oac.libs.andas.utils.BatchCSVUtils
+import org.junit.Test
+import org.junit.Assert.*
+import java.io.File
+import java.nio.file.Files
+import kotlin.random.Random
+
+/**
+ * 外存排序与溢写分组测试：内存预算远小于数据量时结果与内存中计算一致，临时文件用完即删除
+ */
+class SpillTest {
+
+    // 很小的预算，保证会写临时文件
+    private val tinyBudget = 4096L
+
+    private fun <T> withSpillDirectory(block: (File) -> T): T {
+        val dir = Files.createTempDirectory("andas-spill-test").toFile()
+        val previous = SpillEngine.directory
+        SpillEngine.directory = dir
+        try {
+            val result = block(dir)
+            assertEquals("临时文件没有删除", 0, dir.listFiles()?.size ?: 0)
+            return result
+        } finally {
+            SpillEngine.directory = previous
+            dir.deleteRecursively()
+        }
+    }
+
+    private fun buildCsv(rows: Int, seed: Int): String {
+        val random = Random(seed)
+        return buildString {
+            append("id,score,city\n")
+            for (i in 0 until rows) {
+                append(i).append(',')
+                append(if (random.nextInt(20) == 0) "" else (random.nextInt(200) - 100) / 4.0).append(',')
+                append("city").append(random.nextInt(800)).append('\n')
+            }
+        }
+    }
+
+    @Test
+    fun testExternalSort() {
+        println("=== 测试 外存排序 ===")
+        val csv = buildCsv(3000, 7)
+        val all = DataFrameIO.readCSV(csv.byteInputStream())
+        val ids = all["id"].values()
+        val scores = all["score"].values().map { (it as Number?)?.toDouble() }
+
+        for (descending in listOf(false, true)) {
+            // 参考结果：稳定排序，空值排在最后
+            val present = ids.indices.filter { scores[it] != null }
+            val sorted = if (descending) present.sortedByDescending { scores[it]!! } else present.sortedBy { scores[it]!! }
+            val expected = (sorted + ids.indices.filter { scores[it] == null }).map { ids[it] }
+
+            val result = withSpillDirectory {
+                BatchCSVUtils.batchSort(csv.byteInputStream(), "score", descending, 256, memoryBudget = tinyBudget)
+            }
+            assertEquals(listOf("id", "score", "city"), result.columns())
+            assertEquals(expected, result["id"].values())
+            assertEquals(3000, result["city"].values().size)
+
+            // 流式版本：每批不超过 batchSize 行
+            val streamed = mutableListOf<Any?>()
+            withSpillDirectory {
+                BatchCSVUtils.batchSortTo(csv.byteInputStream(), "score", { batch ->
+                    assertTrue(batch.shape().first <= 500)
+                    streamed.addAll(batch["id"].values())
+                }, descending, 500, memoryBudget = tinyBudget)
+            }
+            assertEquals(expected, streamed)
+        }
+
+        // 确认确实写了临时文件，并且类型保持不变
+        withSpillDirectory {
+            SpillEngine.openSorter(false, tinyBudget).use { sorter ->
+                val random = Random(3)
+                val keys = DoubleArray(2000) { random.nextInt(100).toDouble() }
+                val records = RecordBuilder()
+                for (i in keys.indices) {
+                    ValueCodec.write(records.out, i)
+                    ValueCodec.write(records.out, "行$i")
+                    records.endRecord()
+                }
+                sorter.add(keys, records.build())
+                sorter.finish()
+                assertTrue(sorter.spilledBytes > 0)
+                val rows = mutableListOf<Int>()
+                while (true) {
+                    val chunk = sorter.next(1024) ?: break
+                    for (i in 0 until chunk.size) {
+                        val input = chunk.input(i)
+                        val row = ValueCodec.read(input) as Int
+                        assertEquals("行$row", ValueCodec.read(input))
+                        rows.add(row)
+                    }
+                }
+                assertEquals(keys.indices.sortedBy { keys[it] }, rows)
+            }
+        }
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testSpillGroupBy() {
+        println("=== 测试 溢写分组 ===")
+        val csv = buildCsv(5000, 11)
+        val all = DataFrameIO.readCSV(csv.byteInputStream())
+        val cities = all["city"].values()
+        val scores = all["score"].values().map { (it as Number?)?.toDouble() }
+        val expectedCounts = cities.groupingBy { it }.eachCount().mapValues { it.value.toLong() }
+        val expectedSums = cities.indices.filter { scores[it] != null }
+            .groupBy { cities[it] }.mapValues { (_, rows) -> rows.sumOf { scores[it]!! } }
+
+        withSpillDirectory {
+            val counts = BatchCSVUtils.batchGroupByCount(csv.byteInputStream(), "city", 300, memoryBudget = tinyBudget)
+            assertEquals(expectedCounts, counts)
+
+            val sums = BatchCSVUtils.batchGroupBySum(csv.byteInputStream(), "city", "score", 300, memoryBudget = tinyBudget)
+            assertEquals(expectedSums.keys, sums.keys)
+            for ((city, sum) in expectedSums) assertEquals(sum, sums[city]!!, 1e-9)
+
+            // 分区逐批回调，每个分组只出现一次
+            var batches = 0
+            val seen = HashSet<Any?>()
+            BatchCSVUtils.batchGroupByAggregate(csv.byteInputStream(), "city", "score", { batch ->
+                batches++
+                val keys = batch["city"].values()
+                val sizes = batch["size"].values()
+                for (g in keys.indices) {
+                    assertTrue(seen.add(keys[g]))
+                    assertEquals(expectedCounts[keys[g]], sizes[g])
+                }
+            }, 300, memoryBudget = tinyBudget)
+            assertTrue(batches > 1)
+            assertEquals(expectedCounts.keys, seen)
+        }
+
+        // 没有溢写时只回调一次，按首次出现的顺序
+        val batches = mutableListOf<DataFrame>()
+        BatchCSVUtils.batchGroupByAggregate(
+            "k,v\nb,1\na,\nb,3\n,5\n".byteInputStream(), "k", "v", { batches.add(it) }, 2
+        )
+        assertEquals(1, batches.size)
+        assertEquals(listOf("b", "a"), batches[0]["k"].values())
+        assertEquals(listOf(2L, 1L), batches[0]["size"].values())
+        assertEquals(listOf(2.0, null), batches[0]["mean"].values())
+        assertEquals(listOf(4.0, 0.0), batches[0]["sum"].values())
+        println("✅ 测试通过\n")
+    }
+}
@@ -0,0 +1,63 @@
+package cn.ac.oac.libs.andas
+
+import cn.ac.oac.libs.andas.entity.Series
+import org.junit.Test
+import org.junit.Assert.*
+
+/**
+ * Series 类型化存储测试
+ */
+class TypedSeriesTest {
+
+    @Test
+    fun testValuesView() {
+        println("=== 测试 类型化存储的列表视图 ===")
+        val doubles = Series(listOf(1.5, null, Double.NaN, 4.0))
+        val longs = Series(listOf(1L, null, 3_000_000_000L))
+        val ints = Series(listOf(null, 2, 3))
+        val bools = Series(listOf(true, null, false))
+        assertEquals(listOf(1.5, null, Double.NaN, 4.0), doubles.values())
+        assertEquals(listOf(1L, null, 3_000_000_000L), longs.values())
+        assertEquals(listOf(null, 2, 3), ints.values())
+        assertEquals(listOf(true, null, false), bools.values())
+        // 原有的 NaN 仍是非空值
+        assertEquals(listOf(false, true, false, false), doubles.isnull().values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testMixedFallback() {
+        println("=== 测试 混合类型保留普通列表 ===")
+        val mixed = Series(listOf(1, 2L, "a", null))
+        assertEquals(listOf(1, 2L, "a", null), mixed.values())
+        assertEquals(2L, mixed[1])
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testArithmetic() {
+        println("=== 测试 基本类型数组上的运算 ===")
+        val a = Series(listOf(1, null, 3, 4))
+        val b = Series(listOf(10L, 20L, null, 40L))
+        assertEquals(listOf(11.0, null, null, 44.0), (a + b).values())
+        assertEquals(listOf(-9.0, null, null, -36.0), (a - b).values())
+        assertEquals(listOf(10.0, null, null, 160.0), (a * b).values())
+        assertEquals(listOf(2.0, null, 6.0), (Series(listOf(1.0, null, 3.0)) * 2).values())
+        assertEquals(listOf(1.0, null, 4.0, 8.0), a.cumsum().values())
+        println("✅ 测试通过\n")
+    }
+
+    @Test
+    fun testSelection() {
+        println("=== 测试 切片与去空值 ===")
+        val series = Series(listOf(1.0, null, 3.0, 4.0, null), listOf("a", "b", "c", "d", "e"), "v")
+        assertEquals(listOf(1.0, null), series.head(2).values())
+        assertEquals(listOf("d", "e"), series.tail(2).index())
+        val clean = series.dropNullValues()
+        assertEquals(listOf(1.0, 3.0, 4.0), clean.values())
+        assertEquals(listOf("a", "c", "d"), clean.index())
+        assertEquals(3.0, clean["c"])
+        assertEquals(listOf(1.0, 0.0, 3.0, 4.0, 0.0), series.fillna(0.0).values())
+        println("✅ 测试通过\n")
+    }
+}